@@ -0,0 +1,214 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <time.h>
+#include <arastorage/arastorage.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_ARASTORAGE_BENCH_ROWS
+#define CONFIG_EXAMPLES_ARASTORAGE_BENCH_ROWS 200
+#endif
+
+#define BENCH_ROWS       CONFIG_EXAMPLES_ARASTORAGE_BENCH_ROWS
+#define BENCH_RELATION   "bench"
+#define BENCH_RANGE      4
+#define QUERY_LENGTH     128
+
+/* There is no CPU time clock, so the elapsed time is measured. The
+   monotonic clock does not jump when the time of day is set. */
+#ifdef CONFIG_CLOCK_MONOTONIC
+#define BENCH_CLOCK      CLOCK_MONOTONIC
+#else
+#define BENCH_CLOCK      CLOCK_REALTIME
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static long bench_elapsed_us(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(BENCH_CLOCK, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_nsec - start->tv_nsec) / 1000L;
+}
+
+static int bench_create(void)
+{
+	const char *statements[] = {
+		"REMOVE RELATION " BENCH_RELATION ";",
+		"CREATE RELATION " BENCH_RELATION ";",
+		"CREATE ATTRIBUTE id DOMAIN INT IN " BENCH_RELATION ";",
+		"CREATE ATTRIBUTE value DOMAIN LONG IN " BENCH_RELATION ";",
+		"CREATE ATTRIBUTE name DOMAIN STRING(16) IN " BENCH_RELATION ";",
+		"CREATE INDEX " BENCH_RELATION ".value TYPE BPLUSTREE;"
+	};
+	int i;
+
+	for (i = 0; i < sizeof(statements) / sizeof(statements[0]); i++) {
+		if (DB_ERROR(db_exec((char *)statements[i]))) {
+			printf("Failed to run \"%s\"\n", statements[i]);
+			return ERROR;
+		}
+	}
+	return OK;
+}
+
+static int bench_count(db_cursor_t *cursor)
+{
+	int rows;
+
+	if (cursor == NULL) {
+		return ERROR;
+	}
+	rows = cursor_get_count(cursor);
+	db_cursor_free(cursor);
+	return rows;
+}
+
+/* Every statement is parsed again from its text. */
+static int bench_text(long *insert_us, long *select_us)
+{
+	struct timespec start;
+	char query[QUERY_LENGTH];
+	int i;
+
+	clock_gettime(BENCH_CLOCK, &start);
+	for (i = 0; i < BENCH_ROWS; i++) {
+		snprintf(query, QUERY_LENGTH, "INSERT (%d, %d, 'name%d') INTO %s;", i, i * 2, i % 10, BENCH_RELATION);
+		if (DB_ERROR(db_exec(query))) {
+			printf("Failed to run \"%s\"\n", query);
+			return ERROR;
+		}
+	}
+	*insert_us = bench_elapsed_us(&start);
+
+	clock_gettime(BENCH_CLOCK, &start);
+	for (i = 0; i < BENCH_ROWS; i++) {
+		snprintf(query, QUERY_LENGTH, "SELECT id, value FROM %s WHERE value >= %d AND value <= %d;", BENCH_RELATION, i, i + BENCH_RANGE);
+		if (bench_count(db_query(query)) < 0) {
+			printf("Failed to run \"%s\"\n", query);
+			return ERROR;
+		}
+	}
+	*select_us = bench_elapsed_us(&start);
+
+	return OK;
+}
+
+/* The statements are compiled once and run with new parameters. */
+static int bench_prepared(long *insert_us, long *select_us)
+{
+	struct timespec start;
+	db_stmt_t *stmt;
+	db_cursor_t *cursor;
+	char name[16];
+	int ret;
+	int i;
+
+	ret = ERROR;
+	clock_gettime(BENCH_CLOCK, &start);
+	stmt = db_prepare("INSERT (?, ?, ?) INTO " BENCH_RELATION ";");
+	if (stmt == NULL) {
+		printf("Failed to prepare the INSERT\n");
+		return ERROR;
+	}
+	for (i = 0; i < BENCH_ROWS; i++) {
+		snprintf(name, sizeof(name), "name%d", i % 10);
+		db_bind_int(stmt, 0, BENCH_ROWS + i);
+		db_bind_long(stmt, 1, i * 2 + 1);
+		db_bind_string(stmt, 2, name);
+		if (DB_ERROR(db_step(stmt, NULL))) {
+			printf("Failed to insert row %d\n", i);
+			goto errout;
+		}
+	}
+	db_finalize(stmt);
+	*insert_us = bench_elapsed_us(&start);
+
+	clock_gettime(BENCH_CLOCK, &start);
+	stmt = db_prepare("SELECT id, value FROM " BENCH_RELATION " WHERE value >= ? AND value <= ?;");
+	if (stmt == NULL) {
+		printf("Failed to prepare the SELECT\n");
+		return ERROR;
+	}
+	for (i = 0; i < BENCH_ROWS; i++) {
+		db_bind_long(stmt, 0, i);
+		db_bind_long(stmt, 1, i + BENCH_RANGE);
+		if (DB_ERROR(db_step(stmt, &cursor)) || bench_count(cursor) < 0) {
+			printf("Failed to select range %d\n", i);
+			goto errout;
+		}
+	}
+	*select_us = bench_elapsed_us(&start);
+	ret = OK;
+
+errout:
+	db_finalize(stmt);
+	return ret;
+}
+
+/****************************************************************************
+ * arastorage_bench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int arastorage_bench_main(int argc, char *argv[])
+#endif
+{
+	long text_insert_us;
+	long text_select_us;
+	long prepared_insert_us;
+	long prepared_select_us;
+	int ret;
+
+	if (DB_ERROR(db_init())) {
+		printf("Failed to initialize the database\n");
+		return ERROR;
+	}
+
+	ret = bench_create();
+	if (ret == OK) {
+		ret = bench_text(&text_insert_us, &text_select_us);
+	}
+	if (ret == OK) {
+		ret = bench_prepared(&prepared_insert_us, &prepared_select_us);
+	}
+	if (ret == OK) {
+		printf("Time per statement, %d statements     text   prepared\n", BENCH_ROWS);
+		printf("  INSERT                          %6ld us  %6ld us\n", text_insert_us / BENCH_ROWS, prepared_insert_us / BENCH_ROWS);
+		printf("  SELECT                          %6ld us  %6ld us\n", text_select_us / BENCH_ROWS, prepared_select_us / BENCH_ROWS);
+	}
+
+	db_exec("REMOVE RELATION " BENCH_RELATION ";");
+	db_deinit();
+
+	return ret;
+}
@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <net/lwip/sys.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_LWIP_MBOX_BENCH_MESSAGES
+#define CONFIG_EXAMPLES_LWIP_MBOX_BENCH_MESSAGES 100000
+#endif
+
+#ifndef CONFIG_EXAMPLES_LWIP_MBOX_BENCH_SIZE
+#define CONFIG_EXAMPLES_LWIP_MBOX_BENCH_SIZE 64
+#endif
+
+#define BENCH_MESSAGES   CONFIG_EXAMPLES_LWIP_MBOX_BENCH_MESSAGES
+#define BENCH_ROUNDTRIPS (BENCH_MESSAGES / 10)
+#define BENCH_SIZE       CONFIG_EXAMPLES_LWIP_MBOX_BENCH_SIZE
+#define BENCH_BATCH      16
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static sys_mbox_t g_ping;
+static sys_mbox_t g_pong;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static long bench_elapsed_us(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_nsec - start->tv_nsec) / 1000L;
+}
+
+/* Posts BENCH_MESSAGES messages, waiting whenever the mailbox is full. */
+static void *bench_producer(void *arg)
+{
+	uintptr_t i;
+
+	for (i = 1; i <= BENCH_MESSAGES; i++) {
+		sys_mbox_post(&g_ping, (void *)i);
+	}
+	return NULL;
+}
+
+/* Sends every message of g_ping back through g_pong, until a NULL message. */
+static void *bench_echo(void *arg)
+{
+	void *msg;
+
+	for (;;) {
+		sys_arch_mbox_fetch(&g_ping, &msg, 0);
+		if (msg == NULL) {
+			break;
+		}
+		sys_mbox_post(&g_pong, msg);
+	}
+	return NULL;
+}
+
+/* Fetches the messages of the producer, one at a time or in batches like
+ * the tcpip thread, and checks they come in order.
+ */
+static int bench_throughput(int batch)
+{
+	struct timespec start;
+	pthread_t producer;
+	void *msgs[BENCH_BATCH];
+	uintptr_t expect = 1;
+	long elapsed;
+	u32_t n;
+	u32_t i;
+
+	clock_gettime(CLOCK_REALTIME, &start);
+	if (pthread_create(&producer, NULL, bench_producer, NULL) != 0) {
+		printf("Failed to create the producer\n");
+		return ERROR;
+	}
+
+	while (expect <= BENCH_MESSAGES) {
+		sys_arch_mbox_fetch(&g_ping, &msgs[0], 0);
+		n = 1;
+		if (batch > 1) {
+			n += sys_arch_mbox_tryfetch_batch(&g_ping, &msgs[1], batch - 1);
+		}
+		for (i = 0; i < n; i++) {
+			if ((uintptr_t)msgs[i] != expect++) {
+				printf("Message %lu out of order\n", (unsigned long)(expect - 1));
+				pthread_join(producer, NULL);
+				return ERROR;
+			}
+		}
+	}
+	elapsed = bench_elapsed_us(&start);
+	pthread_join(producer, NULL);
+
+	if (elapsed <= 0) {
+		elapsed = 1;
+	}
+	printf("  batch %2d  %10lld msg/s\n", batch, (long long)BENCH_MESSAGES * 1000000LL / elapsed);
+	return OK;
+}
+
+/* Times the round trips of one message through g_ping and g_pong. */
+static int bench_latency(void)
+{
+	struct timespec start;
+	pthread_t echo;
+	void *msg;
+	long elapsed;
+	uintptr_t i;
+
+	if (pthread_create(&echo, NULL, bench_echo, NULL) != 0) {
+		printf("Failed to create the echo thread\n");
+		return ERROR;
+	}
+
+	clock_gettime(CLOCK_REALTIME, &start);
+	for (i = 1; i <= BENCH_ROUNDTRIPS; i++) {
+		sys_mbox_post(&g_ping, (void *)i);
+		sys_arch_mbox_fetch(&g_pong, &msg, 0);
+	}
+	elapsed = bench_elapsed_us(&start);
+
+	sys_mbox_post(&g_ping, NULL);
+	pthread_join(echo, NULL);
+
+	printf("  latency   %10ld ns\n", (long)((long long)elapsed * 1000LL / BENCH_ROUNDTRIPS / 2));
+	return OK;
+}
+
+/****************************************************************************
+ * lwip_mbox_bench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int lwip_mbox_bench_main(int argc, char *argv[])
+#endif
+{
+	int ret;
+
+	if (sys_mbox_new(&g_ping, BENCH_SIZE) != ERR_OK) {
+		printf("Failed to create the mailboxes\n");
+		return ERROR;
+	}
+	if (sys_mbox_new(&g_pong, BENCH_SIZE) != ERR_OK) {
+		printf("Failed to create the mailboxes\n");
+		sys_mbox_free(&g_ping);
+		return ERROR;
+	}
+
+	printf("lwIP mailbox, %d messages, size %d\n", BENCH_MESSAGES, BENCH_SIZE);
+	ret = bench_throughput(1);
+	if (ret == OK) {
+		ret = bench_throughput(BENCH_BATCH);
+	}
+	if (ret == OK) {
+		ret = bench_latency();
+	}
+
+	sys_mbox_free(&g_pong);
+	sys_mbox_free(&g_ping);
+	return ret;
+}
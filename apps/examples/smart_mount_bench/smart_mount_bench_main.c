@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+#include <sys/mount.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <tinyara/fs/mtd.h>
+#include <tinyara/fs/mksmartfs.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_SMART_MOUNT_BENCH_MINOR
+#define CONFIG_EXAMPLES_SMART_MOUNT_BENCH_MINOR 8
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMART_MOUNT_BENCH_FILES
+#define CONFIG_EXAMPLES_SMART_MOUNT_BENCH_FILES 32
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMART_MOUNT_BENCH_MOUNTS
+#define CONFIG_EXAMPLES_SMART_MOUNT_BENCH_MOUNTS 4
+#endif
+
+#define BENCH_FILES      CONFIG_EXAMPLES_SMART_MOUNT_BENCH_FILES
+#define BENCH_MOUNTS     CONFIG_EXAMPLES_SMART_MOUNT_BENCH_MOUNTS
+#define BENCH_MOUNTPT    "/mnt/mountbench"
+#define BENCH_FILESIZE   4096
+#define BENCH_PATHLEN    32
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const int g_sizes[] = { 4, 16, 64 };	/* MiB */
+static int g_minor = CONFIG_EXAMPLES_SMART_MOUNT_BENCH_MINOR;
+static char g_buffer[BENCH_FILESIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static long bench_elapsed_us(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_nsec - start->tv_nsec) / 1000L;
+}
+
+/* Registers a SMART device on the RAM and mounts it, as done at boot. */
+static int bench_mount(FAR uint8_t *ram, size_t size, bool format)
+{
+	FAR struct mtd_dev_s *mtd;
+	char devname[BENCH_PATHLEN];
+	int ret;
+
+	mtd = rammtd_initialize(ram, size);
+	if (mtd == NULL) {
+		printf("Failed to create the RAM MTD device\n");
+		return ERROR;
+	}
+
+	ret = smart_initialize(g_minor, mtd, NULL);
+	if (ret < 0) {
+		printf("smart_initialize failed: %d\n", ret);
+		return ERROR;
+	}
+
+	snprintf(devname, BENCH_PATHLEN, "/dev/smart%d", g_minor++);
+	if (format) {
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+		ret = mksmartfs(devname, 1, true);
+#else
+		ret = mksmartfs(devname, true);
+#endif
+		if (ret < 0) {
+			printf("mksmartfs %s failed: %d\n", devname, ret);
+			return ERROR;
+		}
+	}
+
+	ret = mount(devname, BENCH_MOUNTPT, "smartfs", 0, NULL);
+	if (ret < 0) {
+		printf("Failed to mount %s\n", devname);
+		return ERROR;
+	}
+	return OK;
+}
+
+static int bench_write(const char *path)
+{
+	int fd;
+	ssize_t nwritten;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+	if (fd < 0) {
+		printf("Failed to open %s\n", path);
+		return ERROR;
+	}
+	nwritten = write(fd, g_buffer, BENCH_FILESIZE);
+	close(fd);
+	if (nwritten != BENCH_FILESIZE) {
+		printf("Failed to write %s\n", path);
+		return ERROR;
+	}
+	return OK;
+}
+
+/* Files are written and half of them rewritten, which releases sectors. */
+static int bench_fill(void)
+{
+	char path[BENCH_PATHLEN];
+	int i;
+
+	for (i = 0; i < BENCH_FILES + BENCH_FILES / 2; i++) {
+		memset(g_buffer, i, BENCH_FILESIZE);
+		snprintf(path, BENCH_PATHLEN, BENCH_MOUNTPT "/f%d", i % BENCH_FILES);
+		if (bench_write(path) != OK) {
+			return ERROR;
+		}
+	}
+	return OK;
+}
+
+static int bench_volume(int mib)
+{
+	struct timespec start;
+	FAR uint8_t *ram;
+	size_t size;
+	long total_us;
+	long max_us;
+	long us;
+	int ret;
+	int i;
+
+	size = (size_t)mib << 20;
+	ram = (FAR uint8_t *)malloc(size);
+	if (ram == NULL) {
+		printf("  %2d MiB   skipped, not enough memory\n", mib);
+		return OK;
+	}
+
+	ret = bench_mount(ram, size, true);
+	if (ret == OK) {
+		ret = bench_fill();
+		umount(BENCH_MOUNTPT);
+	}
+
+	total_us = 0;
+	max_us = 0;
+	for (i = 0; i < BENCH_MOUNTS && ret == OK; i++) {
+		clock_gettime(CLOCK_REALTIME, &start);
+		ret = bench_mount(ram, size, false);
+		us = bench_elapsed_us(&start);
+		if (ret == OK) {
+			umount(BENCH_MOUNTPT);
+		}
+		total_us += us;
+		if (us > max_us) {
+			max_us = us;
+		}
+	}
+
+	if (ret == OK) {
+		printf("  %2d MiB   %8ld us  %8ld us\n", mib, total_us / BENCH_MOUNTS, max_us);
+	}
+
+	/* The RAM is not freed, the SMART devices registered on it still use it */
+
+	return ret;
+}
+
+/****************************************************************************
+ * smart_mount_bench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int smart_mount_bench_main(int argc, char *argv[])
+#endif
+{
+	int ret = OK;
+	int i;
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	printf("Initialization and mount time, checkpointed, %d files\n", BENCH_FILES);
+#else
+	printf("Initialization and mount time, full scan, %d files\n", BENCH_FILES);
+#endif
+	printf("  Volume    average       worst\n");
+	for (i = 0; i < sizeof(g_sizes) / sizeof(g_sizes[0]) && ret == OK; i++) {
+		ret = bench_volume(g_sizes[i]);
+	}
+
+	return ret;
+}
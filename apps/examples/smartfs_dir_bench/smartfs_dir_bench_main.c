@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <tinyara/fs/mtd.h>
+#include <tinyara/fs/mksmartfs.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_MINOR
+#define CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_MINOR 9
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_VOLUME
+#define CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_VOLUME 2048
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_LOOKUPS
+#define CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_LOOKUPS 200
+#endif
+
+#define BENCH_LOOKUPS    CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_LOOKUPS
+#define BENCH_VOLUME     ((size_t)CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_VOLUME << 10)
+#define BENCH_MOUNTPT    "/mnt/dirbench"
+#define BENCH_DIR        BENCH_MOUNTPT "/log"
+#define BENCH_PATHLEN    48
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const int g_counts[] = { 16, 64, 256, 512 };
+static FAR uint8_t *g_ram;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static long bench_elapsed_us(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_nsec - start->tv_nsec) / 1000L;
+}
+
+static void bench_path(char *path, int i)
+{
+	snprintf(path, BENCH_PATHLEN, BENCH_DIR "/log%04d.txt", i);
+}
+
+/* Registers a SMART device on the RAM, formats and mounts it. */
+static int bench_mount(void)
+{
+	FAR struct mtd_dev_s *mtd;
+	char devname[BENCH_PATHLEN];
+	int ret;
+
+	g_ram = (FAR uint8_t *)malloc(BENCH_VOLUME);
+	if (g_ram == NULL) {
+		printf("Not enough memory for a %d KiB volume\n", CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_VOLUME);
+		return ERROR;
+	}
+
+	mtd = rammtd_initialize(g_ram, BENCH_VOLUME);
+	if (mtd == NULL) {
+		printf("Failed to create the RAM MTD device\n");
+		return ERROR;
+	}
+
+	ret = smart_initialize(CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_MINOR, mtd, NULL);
+	if (ret < 0) {
+		printf("smart_initialize failed: %d\n", ret);
+		return ERROR;
+	}
+
+	snprintf(devname, BENCH_PATHLEN, "/dev/smart%d", CONFIG_EXAMPLES_SMARTFS_DIR_BENCH_MINOR);
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+	ret = mksmartfs(devname, 1, true);
+#else
+	ret = mksmartfs(devname, true);
+#endif
+	if (ret < 0) {
+		printf("mksmartfs %s failed: %d\n", devname, ret);
+		return ERROR;
+	}
+
+	ret = mount(devname, BENCH_MOUNTPT, "smartfs", 0, NULL);
+	if (ret < 0) {
+		printf("Failed to mount %s\n", devname);
+		return ERROR;
+	}
+
+	ret = mkdir(BENCH_DIR, 0777);
+	if (ret < 0) {
+		printf("Failed to create %s\n", BENCH_DIR);
+		umount(BENCH_MOUNTPT);
+		return ERROR;
+	}
+	return OK;
+}
+
+/* Creates the files first to count - 1, with a short line each. */
+static int bench_create(int first, int count)
+{
+	char path[BENCH_PATHLEN];
+	int fd;
+	int i;
+
+	for (i = first; i < count; i++) {
+		bench_path(path, i);
+		fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+		if (fd < 0) {
+			printf("Failed to create %s\n", path);
+			return ERROR;
+		}
+		if (write(fd, path, strlen(path)) < 0) {
+			printf("Failed to write %s\n", path);
+			close(fd);
+			return ERROR;
+		}
+		close(fd);
+	}
+	return OK;
+}
+
+/* Times open() and stat() of files picked at random among count files. */
+static int bench_lookup(int count)
+{
+	struct timespec start;
+	struct stat st;
+	char path[BENCH_PATHLEN];
+	long open_us = 0;
+	long stat_us = 0;
+	long miss_us = 0;
+	int fd;
+	int i;
+
+	for (i = 0; i < BENCH_LOOKUPS; i++) {
+		bench_path(path, rand() % count);
+		clock_gettime(CLOCK_REALTIME, &start);
+		fd = open(path, O_RDONLY);
+		open_us += bench_elapsed_us(&start);
+		if (fd < 0) {
+			printf("Failed to open %s\n", path);
+			return ERROR;
+		}
+		close(fd);
+
+		bench_path(path, rand() % count);
+		clock_gettime(CLOCK_REALTIME, &start);
+		if (stat(path, &st) < 0) {
+			printf("Failed to stat %s\n", path);
+			return ERROR;
+		}
+		stat_us += bench_elapsed_us(&start);
+
+		/* A missing name is searched in the whole directory */
+
+		bench_path(path, count + i);
+		clock_gettime(CLOCK_REALTIME, &start);
+		(void)stat(path, &st);
+		miss_us += bench_elapsed_us(&start);
+	}
+
+	printf("  %5d  %8ld us  %8ld us  %8ld us\n", count, open_us / BENCH_LOOKUPS, stat_us / BENCH_LOOKUPS, miss_us / BENCH_LOOKUPS);
+	return OK;
+}
+
+/****************************************************************************
+ * smartfs_dir_bench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int smartfs_dir_bench_main(int argc, char *argv[])
+#endif
+{
+	int created = 0;
+	int ret;
+	int i;
+
+	ret = bench_mount();
+	if (ret != OK) {
+		return ret;
+	}
+
+#ifdef CONFIG_SMARTFS_DIRCACHE
+	printf("Directory lookup latency, cache of %d entries\n", CONFIG_SMARTFS_DIRCACHE_ENTRIES);
+#else
+	printf("Directory lookup latency, no cache\n");
+#endif
+	printf("  Files       open()      stat()   stat() missing\n");
+	for (i = 0; i < sizeof(g_counts) / sizeof(g_counts[0]) && ret == OK; i++) {
+		ret = bench_create(created, g_counts[i]);
+		if (ret == OK) {
+			created = g_counts[i];
+			ret = bench_lookup(created);
+		}
+	}
+
+	umount(BENCH_MOUNTPT);
+
+	/* The RAM is not freed, the SMART device registered on it still uses it */
+
+	return ret;
+}
@@ -95,6 +95,14 @@
 
 #define LONG_FILE_LOOP_COUNT 24
 
+#if defined(CONFIG_FS_SMARTFS) && defined(CONFIG_MTD_SMART_PACKED_MAP)
+#define SMART_MAP_FILE_PATH MOUNT_DIR"map%d"
+
+#define SMART_MAP_FILE_COUNT 4
+
+#define SMART_MAP_CHUNK_SIZE CONFIG_MTD_SMART_SECTOR_SIZE
+#endif
+
 #if defined(CONFIG_PIPES) && (CONFIG_DEV_PIPE_SIZE > 11)
 #define FIFO_FILE_PATH "/dev/fifo_test"
 
@@ -932,6 +940,113 @@ static void fs_vfs_statfs_tc(void)
 	TC_SUCCESS_RESULT();
 }
 
+#if defined(CONFIG_FS_SMARTFS) && defined(CONFIG_MTD_SMART_PACKED_MAP)
+static void smart_map_fill(char *buf, int file, int chunk)
+{
+	int i;
+
+	for (i = 0; i < SMART_MAP_CHUNK_SIZE; i++) {
+		buf[i] = (char)(file * 31 + chunk * 7 + i);
+	}
+}
+
+/**
+* @testcase         fs_smart_packed_map_tc
+* @brief            Map logical sectors of smartfs through the packed sector map
+* @scenario         Write files in turns of one sector, so that each new sector is allocated before
+*                   the sector of another file is written, over half of the free space. Read them
+*                   back before and after a remount, which rebuilds the map from the sector headers
+* @apicovered       open, write, read, umount, mount, unlink
+* @precondition     File system should be mounted.
+* @postcondition    NA
+*/
+static void fs_smart_packed_map_tc(void)
+{
+	struct statfs fs;
+	char path[CONFIG_PATH_MAX];
+	char *buf;
+	char *ref;
+	int fd[SMART_MAP_FILE_COUNT];
+	int chunks;
+	int pass;
+	int ret;
+	int i;
+	int j;
+
+	for (i = 0; i < SMART_MAP_FILE_COUNT; i++) {
+		fd[i] = -1;
+	}
+
+	ret = statfs(MOUNT_DIR, &fs);
+	TC_ASSERT_EQ("statfs", ret, OK);
+	chunks = (fs.f_bfree * fs.f_bsize / 2) / (SMART_MAP_CHUNK_SIZE * SMART_MAP_FILE_COUNT);
+	TC_ASSERT_GT("statfs", chunks, 0);
+
+	buf = (char *)malloc(SMART_MAP_CHUNK_SIZE * 2);
+	TC_ASSERT_NOT_NULL("malloc", buf);
+	ref = buf + SMART_MAP_CHUNK_SIZE;
+
+	for (i = 0; i < SMART_MAP_FILE_COUNT; i++) {
+		snprintf(path, CONFIG_PATH_MAX, SMART_MAP_FILE_PATH, i);
+		fd[i] = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+		TC_ASSERT_GEQ_CLEANUP("open", fd[i], 0, goto cleanup);
+	}
+	for (j = 0; j < chunks; j++) {
+		for (i = 0; i < SMART_MAP_FILE_COUNT; i++) {
+			smart_map_fill(buf, i, j);
+			ret = write(fd[i], buf, SMART_MAP_CHUNK_SIZE);
+			TC_ASSERT_EQ_CLEANUP("write", ret, SMART_MAP_CHUNK_SIZE, goto cleanup);
+		}
+	}
+	for (i = 0; i < SMART_MAP_FILE_COUNT; i++) {
+		close(fd[i]);
+		fd[i] = -1;
+	}
+
+	for (pass = 0; pass < 2; pass++) {
+		if (pass > 0) {
+			ret = umount(CONFIG_MOUNT_POINT);
+			TC_ASSERT_EQ_CLEANUP("umount", ret, OK, goto cleanup);
+			ret = mount(MOUNT_DEV_DIR, CONFIG_MOUNT_POINT, TARGET_FS_NAME, 0, NULL);
+			TC_ASSERT_EQ_CLEANUP("mount", ret, OK, goto cleanup);
+		}
+		for (i = 0; i < SMART_MAP_FILE_COUNT; i++) {
+			snprintf(path, CONFIG_PATH_MAX, SMART_MAP_FILE_PATH, i);
+			fd[i] = open(path, O_RDONLY);
+			TC_ASSERT_GEQ_CLEANUP("open", fd[i], 0, goto cleanup);
+			for (j = 0; j < chunks; j++) {
+				smart_map_fill(ref, i, j);
+				ret = read(fd[i], buf, SMART_MAP_CHUNK_SIZE);
+				TC_ASSERT_EQ_CLEANUP("read", ret, SMART_MAP_CHUNK_SIZE, goto cleanup);
+				TC_ASSERT_EQ_CLEANUP("read", memcmp(buf, ref, SMART_MAP_CHUNK_SIZE), 0, goto cleanup);
+			}
+			close(fd[i]);
+			fd[i] = -1;
+		}
+	}
+
+	for (i = 0; i < SMART_MAP_FILE_COUNT; i++) {
+		snprintf(path, CONFIG_PATH_MAX, SMART_MAP_FILE_PATH, i);
+		ret = unlink(path);
+		TC_ASSERT_EQ_CLEANUP("unlink", ret, OK, goto cleanup);
+	}
+	free(buf);
+
+	TC_SUCCESS_RESULT();
+	return;
+
+cleanup:
+	for (i = 0; i < SMART_MAP_FILE_COUNT; i++) {
+		if (fd[i] >= 0) {
+			close(fd[i]);
+		}
+		snprintf(path, CONFIG_PATH_MAX, SMART_MAP_FILE_PATH, i);
+		unlink(path);
+	}
+	free(buf);
+}
+#endif
+
 #if defined(CONFIG_PIPES) && (CONFIG_DEV_PIPE_SIZE > 11)
 /**
 * @testcase         fs_vfs_mkfifo_tc
@@ -1844,6 +1959,9 @@ static int fs_sample_launcher(int argc, char **args)
 	fs_vfs_unlink_tc();
 	fs_vfs_stat_tc();
 	fs_vfs_statfs_tc();
+#if defined(CONFIG_FS_SMARTFS) && defined(CONFIG_MTD_SMART_PACKED_MAP)
+	fs_smart_packed_map_tc();
+#endif
 #if defined(CONFIG_PIPES) && (CONFIG_DEV_PIPE_SIZE > 11)
 	fs_vfs_mkfifo_tc();
 #endif
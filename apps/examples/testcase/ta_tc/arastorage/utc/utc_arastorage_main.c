@@ -22,7 +22,11 @@
 
 #include <tinyara/config.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <arastorage/arastorage.h>
 #include <apps/shell/tash.h>
 #include <tinyara/fs/fs_utils.h>
@@ -37,12 +41,15 @@
 
 #define RELATION_NAME1 "rel1"
 #define RELATION_NAME2 "rel2"
+#define RELATION_NAME3 "rel3"
+#define RELATION_NAME4 "rel4"
 #define INDEX_BPLUS "bplustree"
 #define INDEX_INLINE "inline"
 #define QUERY_LENGTH 128
 
 #define DATA_SET_NUM 10
 #define DATA_SET_MULTIPLIER 80
+#define FILE_BUFFER_SIZE 4096
 /****************************************************************************
  *  Global Variables
  ****************************************************************************/
@@ -51,6 +58,8 @@ static db_cursor_t *g_cursor;
 
 const static char *g_attribute_set[] = {"id", "date", "fruit", "value", "weight"};
 
+const static char *g_device_attribute_set[] = {"name", "device", "time"};
+
 struct arastorage_data_type_s {
 	long long_value;
 	char *string_value;
@@ -222,73 +231,986 @@ void utc_arastorage_db_exec_tc_p(void)
 	res = db_exec(query);
 	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
-
-	for (i = 0; i < DATA_SET_NUM * 10; i++) {
-		memset(query, 0, QUERY_LENGTH);
-		snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld) INTO %s;", i, rand()%10000, RELATION_NAME2);
-		res = db_exec(query);
-		TC_ASSERT("db_exec", DB_SUCCESS(res));
-	}
-
-#ifdef CONFIG_ARCH_FLOAT_H
-	memset(query, 0, QUERY_LENGTH);
-	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN double IN %s;", g_attribute_set[4], RELATION_NAME1);
+
+	for (i = 0; i < DATA_SET_NUM * 10; i++) {
+		memset(query, 0, QUERY_LENGTH);
+		snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld) INTO %s;", i, rand()%10000, RELATION_NAME2);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
+
+#ifdef CONFIG_ARCH_FLOAT_H
+	memset(query, 0, QUERY_LENGTH);
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN double IN %s;", g_attribute_set[4], RELATION_NAME1);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	for (i = 0; i < DATA_SET_NUM; i++) {
+		memset(query, 0, QUERY_LENGTH);
+		snprintf(query, "INSERT (%d, %ld, \'%s\', %d, %f) INTO %s;", QUERY_LENGTH,
+				 i, g_arastorage_data_set[i].long_value,
+				 g_arastorage_data_set[i].string_value, 1000 - i,
+				 g_arastorage_data_set[i].double_value, RELATION_NAME1);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
+#else
+	for (i = 0; i < DATA_SET_NUM; i++) {
+		memset(query, 0, QUERY_LENGTH);
+		snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld, \'%s\', %d) INTO %s;",
+				 i, g_arastorage_data_set[i].long_value,
+				 g_arastorage_data_set[i].string_value, 1000 - i, RELATION_NAME1);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
+#endif
+	memset(query, 0, QUERY_LENGTH);
+	sprintf(query, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME1, g_attribute_set[3], INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+
+#ifdef CONFIG_ARCH_FLOAT_H
+
+	for (; i < DATA_SET_NUM * DATA_SET_MULTIPLIER; i++) {
+		memset(query, 0, QUERY_LENGTH);
+		snprintf(query, "INSERT (%d, %ld, \'%s\', %d, %f) INTO %s;", QUERY_LENGTH,
+				 i, g_arastorage_data_set[i % DATA_SET_NUM].long_value,
+				 g_arastorage_data_set[i % DATA_SET_NUM].string_value, 1000 - i,
+				 g_arastorage_data_set[i % DATA_SET_NUM].double_value, RELATION_NAME1);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
+#else
+	for (; i < DATA_SET_NUM * DATA_SET_MULTIPLIER; i++) {
+		memset(query, 0, QUERY_LENGTH);
+		snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld, \'%s\', %d) INTO %s;",
+				 i, g_arastorage_data_set[i % DATA_SET_NUM].long_value,
+				 g_arastorage_data_set[i % DATA_SET_NUM].string_value, 1000 - i, RELATION_NAME1);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
+#endif
+	memset(query, 0, QUERY_LENGTH);
+	sprintf(query, "REMOVE INDEX %s.%s ;", RELATION_NAME1, g_attribute_set[0]);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	memset(query, 0, QUERY_LENGTH);
+	sprintf(query, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME1, g_attribute_set[0], INDEX_INLINE);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_exec_tc_n
+* @brief            Excute database operations with invalid argument
+* @scenario         Create exiting relation, attribute and excute db with NULL value
+* @apicovered       db_exec
+* @precondition     none
+* @postcondition    none
+*/
+void utc_arastorage_db_exec_tc_n(void)
+{
+	db_result_t res;
+	char query[QUERY_LENGTH];
+	char *name = "BAD_RELATION";
+	char *attr_name = "attr";
+	/* Try to create existing relation */
+	memset(query, 0, QUERY_LENGTH);
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME1);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	/* Try to create existing attribute */
+	memset(query, 0, QUERY_LENGTH);
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], RELATION_NAME1);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	/* Try to excute db with NULL value */
+	res = db_exec(NULL);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	/* Try to parse mis-spelt query */
+	memset(query, 0, QUERY_LENGTH);
+	snprintf(query, QUERY_LENGTH, "CRAETE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], RELATION_NAME1);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	/* Create duplicate attribute */
+	memset(query, 0, QUERY_LENGTH);
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], name);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	/* Index on non-existent attribute */
+	memset(query, 0, QUERY_LENGTH);
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME1, attr_name, INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	/* execute un-implemented operation */
+	memset(query, 0, QUERY_LENGTH);
+	snprintf(query, QUERY_LENGTH, "REMOVE ATTRIBUTE %s.%s;", RELATION_NAME1, g_attribute_set[0]);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_query_tc_p
+* @brief            Query a database
+* @scenario         Select data and get returned cursor
+* @apicovered       db_query
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_tc_p(void)
+{
+	db_result_t res;
+	char query[QUERY_LENGTH];
+
+	/* Select over bplus-tree index */
+#ifdef CONFIG_ARCH_FLOAT_H
+	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit, value, weight FROM %s WHERE value < 990;", RELATION_NAME1);
+
+#else
+	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit, value FROM %s WHERE value < 990;", RELATION_NAME1);
+#endif
+	g_cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", g_cursor);
+
+	res = db_cursor_free(g_cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+	g_cursor = NULL;
+
+	/* Select with AND condition */
+	snprintf(query, QUERY_LENGTH, "SELECT id, date FROM %s WHERE id < 25 AND id > 10;", RELATION_NAME2);
+	check_query_result(query);
+
+	/* Count aggregation operation */
+	snprintf(query, QUERY_LENGTH, "SELECT COUNT(id) FROM %s WHERE id = 5 OR id = 85;", RELATION_NAME2);
+	check_query_result(query);
+
+	/* Mean aggregation operation */
+	snprintf(query, QUERY_LENGTH, "SELECT MEAN(id) FROM %s;", RELATION_NAME2);
+	check_query_result(query);
+
+	/* Sum aggregation operation */
+	snprintf(query, QUERY_LENGTH, "SELECT SUM(id) FROM %s;", RELATION_NAME2);
+	check_query_result(query);
+
+	/* Max aggregation operation */
+	snprintf(query, QUERY_LENGTH, "SELECT MAX(id) FROM %s;", RELATION_NAME2);
+	check_query_result(query);
+
+	/* Min aggregation operation */
+	snprintf(query, QUERY_LENGTH, "SELECT MIN(id) FROM %s;", RELATION_NAME2);
+	check_query_result(query);
+
+	/* Remove operation */
+	snprintf(query, QUERY_LENGTH, "REMOVE FROM %s WHERE date > 2000 AND date < 8000;", RELATION_NAME2);
+	check_query_result(query);
+
+	/* Select over inline index */
+#ifdef CONFIG_ARCH_FLOAT_H
+	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit, weight FROM %s WHERE id > 0;", RELATION_NAME1);
+
+#else
+	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit FROM %s WHERE id > 0;", RELATION_NAME1);
+#endif
+	g_cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", g_cursor);
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_query_snapshot_tc_p
+* @brief            Read a snapshot of a relation while it is modified
+* @scenario         Select all tuples, insert a tuple and check that the cursor still
+*                   holds the tuples of the snapshot while a new query sees the new one.
+*                   Removing the relation fails until the cursor is freed.
+* @apicovered       db_query, db_exec, db_cursor_free
+* @precondition     utc_arastorage_db_query_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_snapshot_tc_p(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	db_cursor_t *latest;
+	cursor_row_t count;
+	char query[QUERY_LENGTH];
+
+	snprintf(query, QUERY_LENGTH, "SELECT id, date FROM %s;", RELATION_NAME2);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	count = cursor_get_count(cursor);
+	TC_ASSERT_GT("cursor_get_count", count, 0);
+
+	snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld) INTO %s;", DATA_SET_NUM * DATA_SET_MULTIPLIER, 1L, RELATION_NAME2);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	/* The cursor keeps reading the tuples it was created with */
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), count);
+	res = cursor_move_last(cursor);
+	TC_ASSERT("cursor_move_last", DB_SUCCESS(res));
+	TC_ASSERT_NEQ("cursor_get_int_value", cursor_get_int_value(cursor, 0), DATA_SET_NUM * DATA_SET_MULTIPLIER);
+
+	snprintf(query, QUERY_LENGTH, "SELECT id, date FROM %s;", RELATION_NAME2);
+	latest = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", latest);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(latest), count + 1);
+	res = db_cursor_free(latest);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	/* The relation can not be removed while it is read by a cursor */
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME2);
+	res = db_exec(query);
+	TC_ASSERT_EQ("db_exec", res, DB_BUSY_ERROR);
+
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_query_stream_tc_p
+* @brief            Query a database with a streaming cursor
+* @scenario         Read the rows selected by a streaming cursor and check they are the
+*                   rows of the same query with db_query, and that LIMIT ends the scan
+* @apicovered       db_query_stream
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_stream_tc_p(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	db_cursor_t *stream;
+	cursor_row_t count;
+	char query[QUERY_LENGTH];
+
+	snprintf(query, QUERY_LENGTH, "SELECT id, date FROM %s WHERE id > 10;", RELATION_NAME2);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	stream = db_query_stream(query);
+	TC_ASSERT_NOT_NULL("db_query_stream", stream);
+
+	count = 0;
+	if (DB_SUCCESS(cursor_move_first(cursor))) {
+		res = cursor_move_first(stream);
+		while (DB_SUCCESS(res)) {
+			TC_ASSERT_EQ("cursor_get_int_value", cursor_get_int_value(stream, 0), cursor_get_int_value(cursor, 0));
+			TC_ASSERT_EQ("cursor_get_long_value", cursor_get_long_value(stream, 1), cursor_get_long_value(cursor, 1));
+			count++;
+			res = cursor_move_next(cursor);
+			TC_ASSERT_EQ("cursor_move_next", DB_SUCCESS(cursor_move_next(stream)), DB_SUCCESS(res));
+		}
+	}
+	TC_ASSERT_EQ("cursor_get_count", count, cursor_get_count(cursor));
+	TC_ASSERT("cursor_is_last_row", cursor_is_last_row(stream));
+
+	res = db_cursor_free(stream);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	/* LIMIT ends the scan */
+	snprintf(query, QUERY_LENGTH, "SELECT id FROM %s LIMIT 3;", RELATION_NAME2);
+	stream = db_query_stream(query);
+	TC_ASSERT_NOT_NULL("db_query_stream", stream);
+	count = 0;
+	if (DB_SUCCESS(cursor_move_first(stream))) {
+		do {
+			count++;
+		} while (DB_SUCCESS(cursor_move_next(stream)));
+	}
+	TC_ASSERT_EQ("cursor_get_count", count, 3);
+	res = db_cursor_free(stream);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_query_stream_tc_n
+* @brief            Query a database with a streaming cursor with invalid argument
+* @scenario         Stream a query which is not a selection, and move a streaming cursor back
+* @apicovered       db_query_stream
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_stream_tc_n(void)
+{
+	db_result_t res;
+	db_cursor_t *stream;
+	char query[QUERY_LENGTH];
+
+	stream = db_query_stream(NULL);
+	TC_ASSERT_EQ("db_query_stream", stream, NULL);
+
+	snprintf(query, QUERY_LENGTH, "REMOVE FROM %s WHERE id > 10;", RELATION_NAME2);
+	stream = db_query_stream(query);
+	TC_ASSERT_EQ("db_query_stream", stream, NULL);
+
+	snprintf(query, QUERY_LENGTH, "SELECT id FROM %s LIMIT 0;", RELATION_NAME2);
+	stream = db_query_stream(query);
+	TC_ASSERT_EQ("db_query_stream", stream, NULL);
+
+	snprintf(query, QUERY_LENGTH, "SELECT id FROM %s;", RELATION_NAME2);
+	stream = db_query_stream(query);
+	TC_ASSERT_NOT_NULL("db_query_stream", stream);
+	res = cursor_move_first(stream);
+	TC_ASSERT("cursor_move_first", DB_SUCCESS(res));
+	res = cursor_move_next(stream);
+	TC_ASSERT("cursor_move_next", DB_SUCCESS(res));
+	res = cursor_move_prev(stream);
+	TC_ASSERT("cursor_move_prev", DB_ERROR(res));
+	res = cursor_move_last(stream);
+	TC_ASSERT("cursor_move_last", DB_ERROR(res));
+	res = db_cursor_free(stream);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_query_index_tc_p
+* @brief            Query a database over string and composite indexes
+* @scenario         Create B+tree indexes on a string attribute and on two attributes,
+*                   select by string, by range and by BETWEEN, and select an attribute
+*                   which is read from its index only
+* @apicovered       db_exec, db_query
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_index_tc_p(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+	int value;
+	int i;
+
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN string(16) IN %s;", g_device_attribute_set[0], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[1], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[2], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME3, g_device_attribute_set[0], INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.(%s, %s) TYPE %s;", RELATION_NAME3, g_device_attribute_set[1],
+			 g_device_attribute_set[2], INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	for (i = 0; i < DATA_SET_NUM * 10; i++) {
+		snprintf(query, QUERY_LENGTH, "INSERT (\'dev%d\', %d, %d) INTO %s;", i % DATA_SET_NUM, i % 4, i, RELATION_NAME3);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
+
+	/* Select by a string key */
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s = \'dev3\';", g_device_attribute_set[2], RELATION_NAME3,
+			 g_device_attribute_set[0]);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), 10);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	/* Select by a range of strings, the prefix "dev7" itself is not selected */
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s > \'dev7\';", g_device_attribute_set[2], RELATION_NAME3,
+			 g_device_attribute_set[0]);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), 20);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	/* Select by both attributes of a composite key */
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s = 2 AND %s BETWEEN 10 AND 29;", g_device_attribute_set[0],
+			 RELATION_NAME3, g_device_attribute_set[1], g_device_attribute_set[2]);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), 5);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	/* The selected attribute is read from the index only */
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s BETWEEN 300 AND 309;", g_attribute_set[3], RELATION_NAME1,
+			 g_attribute_set[3]);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), 10);
+	res = cursor_move_first(cursor);
+	while (DB_SUCCESS(res)) {
+		value = cursor_get_int_value(cursor, 0);
+		TC_ASSERT("cursor_get_int_value", value >= 300 && value <= 309);
+		res = cursor_move_next(cursor);
+	}
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_query_index_tc_n
+* @brief            Create indexes and query with invalid arguments
+* @scenario         Create an inline index on a string attribute, a composite index with
+*                   too many attributes, and query with an incomplete BETWEEN
+* @apicovered       db_exec, db_query
+* @precondition     none
+* @postcondition    none
+*/
+void utc_arastorage_db_query_index_tc_n(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME1, g_attribute_set[2], INDEX_INLINE);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.(%s, %s, %s) TYPE %s;", RELATION_NAME1, g_attribute_set[1],
+			 g_attribute_set[2], g_attribute_set[3], INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s BETWEEN 300;", g_attribute_set[3], RELATION_NAME1,
+			 g_attribute_set[3]);
+	cursor = db_query(query);
+	TC_ASSERT_EQ("db_query", cursor, NULL);
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_insert_batch_tc_p
+* @brief            Insert rows into a relation in batches
+* @scenario         Insert a batch which builds a B+tree index and a smaller one which
+*                   extends it, then select by ranges of the indexed attribute
+* @apicovered       db_insert_batch, db_query
+* @precondition     none
+* @postcondition    none
+*/
+void utc_arastorage_db_insert_batch_tc_p(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+	char names[DATA_SET_NUM][16];
+	char *name_values[DATA_SET_NUM * 10];
+	int device_values[DATA_SET_NUM * 10];
+	int time_values[DATA_SET_NUM * 10];
+	db_column_t columns[3] = {
+		{DOMAIN_STRING, name_values},
+		{DOMAIN_INT, device_values},
+		{DOMAIN_INT, time_values}
+	};
+	int i;
+
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN string(16) IN %s;", g_device_attribute_set[0], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[1], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[2], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME3, g_device_attribute_set[2], INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	for (i = 0; i < DATA_SET_NUM; i++) {
+		snprintf(names[i], sizeof(names[i]), "dev%d", i);
+	}
+	for (i = 0; i < DATA_SET_NUM * 10; i++) {
+		name_values[i] = names[i % DATA_SET_NUM];
+		device_values[i] = i % 4;
+		/* The batch is not sorted by the indexed attribute */
+		time_values[i] = (i * 7) % (DATA_SET_NUM * 10);
+	}
+
+	res = db_insert_batch(RELATION_NAME3, columns, 3, DATA_SET_NUM * 10);
+	TC_ASSERT("db_insert_batch", DB_SUCCESS(res));
+
+	for (i = 0; i < DATA_SET_NUM; i++) {
+		time_values[i] = DATA_SET_NUM * 10 + i;
+	}
+
+	res = db_insert_batch(RELATION_NAME3, columns, 3, DATA_SET_NUM);
+	TC_ASSERT("db_insert_batch", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s BETWEEN 10 AND 29;", g_device_attribute_set[2],
+			 RELATION_NAME3, g_device_attribute_set[2]);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), 20);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s BETWEEN %d AND %d;", g_device_attribute_set[2],
+			 RELATION_NAME3, g_device_attribute_set[2], DATA_SET_NUM * 10, DATA_SET_NUM * 11 - 1);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), DATA_SET_NUM);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_insert_batch_tc_n
+* @brief            Insert rows in a batch with invalid arguments
+* @scenario         Insert into a relation which does not exist, with a missing column
+*                   and with a column of the wrong domain
+* @apicovered       db_insert_batch
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_insert_batch_tc_n(void)
+{
+	db_result_t res;
+	int id_values[1] = { 0 };
+	char *date_values[1] = { "2017-01-01" };
+	db_column_t columns[2] = {
+		{DOMAIN_INT, id_values},
+		{DOMAIN_STRING, date_values}
+	};
+
+	res = db_insert_batch(NULL, columns, 2, 1);
+	TC_ASSERT("db_insert_batch", DB_ERROR(res));
+
+	res = db_insert_batch("none", columns, 2, 1);
+	TC_ASSERT("db_insert_batch", DB_ERROR(res));
+
+	/* The relation has more attributes than the given columns */
+	res = db_insert_batch(RELATION_NAME1, columns, 2, 1);
+	TC_ASSERT("db_insert_batch", DB_ERROR(res));
+
+	/* The second attribute of the relation is a long */
+	res = db_insert_batch(RELATION_NAME2, columns, 2, 1);
+	TC_ASSERT("db_insert_batch", DB_ERROR(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_prepare_tc_p
+* @brief            Run prepared statements with parameters
+* @scenario         Insert rows with a prepared INSERT, then run a prepared SELECT
+*                   for several ranges of the indexed attribute and a string
+* @apicovered       db_prepare, db_bind_int, db_bind_string, db_step, db_finalize
+* @precondition     none
+* @postcondition    none
+*/
+void utc_arastorage_db_prepare_tc_p(void)
+{
+	db_result_t res;
+	db_stmt_t *stmt;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+	char name[16];
+	int i;
+
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN string(16) IN %s;", g_device_attribute_set[0], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[1], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[2], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME3, g_device_attribute_set[2], INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "INSERT (?, ?, ?) INTO %s;", RELATION_NAME3);
+	stmt = db_prepare(query);
+	TC_ASSERT_NOT_NULL("db_prepare", stmt);
+	for (i = 0; i < DATA_SET_NUM * 10; i++) {
+		snprintf(name, sizeof(name), "dev%d", i % DATA_SET_NUM);
+		res = db_bind_string(stmt, 0, name);
+		TC_ASSERT("db_bind_string", DB_SUCCESS(res));
+		res = db_bind_int(stmt, 1, i % 4);
+		TC_ASSERT("db_bind_int", DB_SUCCESS(res));
+		res = db_bind_int(stmt, 2, i);
+		TC_ASSERT("db_bind_int", DB_SUCCESS(res));
+		res = db_step(stmt, NULL);
+		TC_ASSERT("db_step", DB_SUCCESS(res));
+	}
+	res = db_finalize(stmt);
+	TC_ASSERT("db_finalize", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s BETWEEN ? AND ?;", g_device_attribute_set[2],
+			 RELATION_NAME3, g_device_attribute_set[2]);
+	stmt = db_prepare(query);
+	TC_ASSERT_NOT_NULL("db_prepare", stmt);
+	for (i = 0; i < DATA_SET_NUM; i++) {
+		res = db_bind_int(stmt, 0, i * 10);
+		TC_ASSERT("db_bind_int", DB_SUCCESS(res));
+		res = db_bind_int(stmt, 1, i * 10 + i);
+		TC_ASSERT("db_bind_int", DB_SUCCESS(res));
+		res = db_step(stmt, &cursor);
+		TC_ASSERT("db_step", DB_SUCCESS(res));
+		TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), i + 1);
+		res = db_cursor_free(cursor);
+		TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+	}
+	res = db_finalize(stmt);
+	TC_ASSERT("db_finalize", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s, %s FROM %s WHERE %s = ? AND %s < ?;", g_device_attribute_set[0],
+			 g_device_attribute_set[2], RELATION_NAME3, g_device_attribute_set[0], g_device_attribute_set[2]);
+	stmt = db_prepare(query);
+	TC_ASSERT_NOT_NULL("db_prepare", stmt);
+	res = db_bind_string(stmt, 0, "dev3");
+	TC_ASSERT("db_bind_string", DB_SUCCESS(res));
+	res = db_bind_int(stmt, 1, 50);
+	TC_ASSERT("db_bind_int", DB_SUCCESS(res));
+	res = db_step(stmt, &cursor);
+	TC_ASSERT("db_step", DB_SUCCESS(res));
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), 5);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+	res = db_finalize(stmt);
+	TC_ASSERT("db_finalize", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_prepare_tc_n
+* @brief            Prepare and run statements with invalid arguments
+* @scenario         Prepare an invalid query, bind a parameter which does not exist,
+*                   run a statement whose parameters are not bound and run a query
+*                   with parameters without preparing it
+* @apicovered       db_prepare, db_bind_int, db_bind_string, db_step, db_finalize, db_query
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_prepare_tc_n(void)
+{
+	db_result_t res;
+	db_stmt_t *stmt;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+
+	stmt = db_prepare(NULL);
+	TC_ASSERT_EQ("db_prepare", stmt, NULL);
+
+	stmt = db_prepare("SELECT FROM;");
+	TC_ASSERT_EQ("db_prepare", stmt, NULL);
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s = ?;", g_attribute_set[0], RELATION_NAME1,
+			 g_attribute_set[0]);
+	cursor = db_query(query);
+	TC_ASSERT_EQ("db_query", cursor, NULL);
+
+	stmt = db_prepare(query);
+	TC_ASSERT_NOT_NULL("db_prepare", stmt);
+
+	res = db_bind_int(stmt, 1, 0);
+	TC_ASSERT("db_bind_int", DB_ERROR(res));
+
+	res = db_bind_string(stmt, 0, NULL);
+	TC_ASSERT("db_bind_string", DB_ERROR(res));
+
+	res = db_step(stmt, &cursor);
+	TC_ASSERT("db_step", DB_ERROR(res));
+
+	res = db_bind_int(stmt, 0, 0);
+	TC_ASSERT("db_bind_int", DB_SUCCESS(res));
+
+	res = db_step(stmt, NULL);
+	TC_ASSERT("db_step", DB_ERROR(res));
+
+	res = db_finalize(stmt);
+	TC_ASSERT("db_finalize", DB_SUCCESS(res));
+
+	res = db_finalize(NULL);
+	TC_ASSERT("db_finalize", DB_ERROR(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_explain_tc_p
+* @brief            Explain the plans of queries and run them
+* @scenario         Insert rows into a relation with a B+tree index, explain a narrow and
+*                   a wide range of the indexed attribute, and check that both queries,
+*                   which read the index and the whole relation, find the right rows
+* @apicovered       db_exec, db_query
+* @precondition     none
+* @postcondition    none
+*/
+void utc_arastorage_db_explain_tc_p(void)
+{
+	db_result_t res;
+	db_stmt_t *stmt;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+	int i;
+
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[1], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[2], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME3, g_device_attribute_set[2], INDEX_BPLUS);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "INSERT (?, ?) INTO %s;", RELATION_NAME3);
+	stmt = db_prepare(query);
+	TC_ASSERT_NOT_NULL("db_prepare", stmt);
+	for (i = 0; i < DATA_SET_NUM * 10; i++) {
+		db_bind_int(stmt, 0, i % 4);
+		db_bind_int(stmt, 1, i);
+		res = db_step(stmt, NULL);
+		TC_ASSERT("db_step", DB_SUCCESS(res));
+	}
+	res = db_finalize(stmt);
+	TC_ASSERT("db_finalize", DB_SUCCESS(res));
+
+	/* A narrow range is read from the index */
+	snprintf(query, QUERY_LENGTH, "EXPLAIN SELECT %s, %s FROM %s WHERE %s BETWEEN 10 AND 12;", g_device_attribute_set[1],
+			 g_device_attribute_set[2], RELATION_NAME3, g_device_attribute_set[2]);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	cursor = db_query(query + strlen("EXPLAIN "));
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), 3);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	/* A wide range is cheaper to find by reading the whole relation */
+	snprintf(query, QUERY_LENGTH, "EXPLAIN SELECT %s, %s FROM %s WHERE %s BETWEEN 0 AND %d;", g_device_attribute_set[1],
+			 g_device_attribute_set[2], RELATION_NAME3, g_device_attribute_set[2], DATA_SET_NUM * 9 - 1);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	cursor = db_query(query + strlen("EXPLAIN "));
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), DATA_SET_NUM * 9);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "EXPLAIN SELECT %s FROM %s;", g_device_attribute_set[1], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_explain_tc_n
+* @brief            Explain statements which are not queries
+* @scenario         Explain an INSERT, a query of a relation which does not exist, and
+*                   run an EXPLAIN statement with db_query
+* @apicovered       db_exec, db_query
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_explain_tc_n(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+
+	snprintf(query, QUERY_LENGTH, "EXPLAIN INSERT (1, 2) INTO %s;", RELATION_NAME1);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	res = db_exec("EXPLAIN SELECT a FROM not_exist;");
+	TC_ASSERT("db_exec", DB_ERROR(res));
+
+	snprintf(query, QUERY_LENGTH, "EXPLAIN SELECT %s FROM %s;", g_attribute_set[0], RELATION_NAME1);
+	cursor = db_query(query);
+	TC_ASSERT_EQ("db_query", cursor, NULL);
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_query_join_tc_p
+* @brief            Join two relations and sort the joined tuples
+* @scenario         Join a relation of 40 tuples with a relation of 4 tuples on an int
+*                   attribute, select part of the result in descending order of an attribute
+* @apicovered       db_query, db_query_stream
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_join_tc_p(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+	int i;
+
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[1], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_device_attribute_set[2], RELATION_NAME3);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME4);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], RELATION_NAME4);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN long IN %s;", g_attribute_set[3], RELATION_NAME4);
 	res = db_exec(query);
 	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
-	for (i = 0; i < DATA_SET_NUM; i++) {
-		memset(query, 0, QUERY_LENGTH);
-		snprintf(query, "INSERT (%d, %ld, \'%s\', %d, %f) INTO %s;", QUERY_LENGTH,
-				 i, g_arastorage_data_set[i].long_value,
-				 g_arastorage_data_set[i].string_value, 1000 - i,
-				 g_arastorage_data_set[i].double_value, RELATION_NAME1);
+	for (i = 0; i < DATA_SET_NUM * 4; i++) {
+		snprintf(query, QUERY_LENGTH, "INSERT (%d, %d) INTO %s;", i % 4, i, RELATION_NAME3);
 		res = db_exec(query);
 		TC_ASSERT("db_exec", DB_SUCCESS(res));
 	}
-#else
-	for (i = 0; i < DATA_SET_NUM; i++) {
-		memset(query, 0, QUERY_LENGTH);
-		snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld, \'%s\', %d) INTO %s;",
-				 i, g_arastorage_data_set[i].long_value,
-				 g_arastorage_data_set[i].string_value, 1000 - i, RELATION_NAME1);
+	for (i = 0; i < 4; i++) {
+		snprintf(query, QUERY_LENGTH, "INSERT (%d, %d) INTO %s;", i, i * 10, RELATION_NAME4);
 		res = db_exec(query);
 		TC_ASSERT("db_exec", DB_SUCCESS(res));
 	}
-#endif
-	memset(query, 0, QUERY_LENGTH);
-	sprintf(query, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME1, g_attribute_set[3], INDEX_BPLUS);
+
+	/* Every tuple of the larger relation matches one tuple of the smaller one */
+	snprintf(query, QUERY_LENGTH, "SELECT %s, %s FROM %s JOIN %s ON %s = %s WHERE %s >= 0;", g_device_attribute_set[2], g_attribute_set[3],
+			 RELATION_NAME3, RELATION_NAME4, g_device_attribute_set[1], g_attribute_set[0], g_device_attribute_set[2]);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ("cursor_get_count", cursor_get_count(cursor), DATA_SET_NUM * 4);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s, %s FROM %s JOIN %s ON %s = %s WHERE %s < 20 ORDER BY %s DESC;", g_device_attribute_set[2],
+			 g_attribute_set[3], RELATION_NAME3, RELATION_NAME4, g_device_attribute_set[1], g_attribute_set[0], g_device_attribute_set[2],
+			 g_device_attribute_set[2]);
+	cursor = db_query_stream(query);
+	TC_ASSERT_NOT_NULL("db_query_stream", cursor);
+	res = cursor_move_first(cursor);
+	TC_ASSERT_EQ_CLEANUP("cursor_move_first", res, DB_OK, db_cursor_free(cursor));
+	for (i = 19; i >= 0; i--) {
+		TC_ASSERT_EQ_CLEANUP("cursor_get_int_value", cursor_get_int_value(cursor, 0), i, db_cursor_free(cursor));
+		TC_ASSERT_EQ_CLEANUP("cursor_get_long_value", cursor_get_long_value(cursor, 1), (i % 4) * 10, db_cursor_free(cursor));
+		res = cursor_move_next(cursor);
+	}
+	TC_ASSERT_CLEANUP("cursor_move_next", DB_ERROR(res), db_cursor_free(cursor));
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME4);
 	res = db_exec(query);
 	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
+	TC_SUCCESS_RESULT();
+}
 
-#ifdef CONFIG_ARCH_FLOAT_H
+/**
+* @testcase         utc_arastorage_db_query_order_tc_p
+* @brief            Sort the selected tuples of a relation
+* @scenario         Select the first tuples in ascending order of an attribute which is
+*                   not the order of insertion
+* @apicovered       db_query
+* @precondition     utc_arastorage_db_query_join_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_order_tc_p(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+	int i;
 
-	for (; i < DATA_SET_NUM * DATA_SET_MULTIPLIER; i++) {
-		memset(query, 0, QUERY_LENGTH);
-		snprintf(query, "INSERT (%d, %ld, \'%s\', %d, %f) INTO %s;", QUERY_LENGTH,
-				 i, g_arastorage_data_set[i % DATA_SET_NUM].long_value,
-				 g_arastorage_data_set[i % DATA_SET_NUM].string_value, 1000 - i,
-				 g_arastorage_data_set[i % DATA_SET_NUM].double_value, RELATION_NAME1);
-		res = db_exec(query);
-		TC_ASSERT("db_exec", DB_SUCCESS(res));
-	}
-#else
-	for (; i < DATA_SET_NUM * DATA_SET_MULTIPLIER; i++) {
-		memset(query, 0, QUERY_LENGTH);
-		snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld, \'%s\', %d) INTO %s;",
-				 i, g_arastorage_data_set[i % DATA_SET_NUM].long_value,
-				 g_arastorage_data_set[i % DATA_SET_NUM].string_value, 1000 - i, RELATION_NAME1);
-		res = db_exec(query);
-		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	snprintf(query, QUERY_LENGTH, "SELECT %s, %s FROM %s WHERE %s >= 0 ORDER BY %s ASC LIMIT %d;", g_device_attribute_set[1],
+			 g_device_attribute_set[2], RELATION_NAME3, g_device_attribute_set[2], g_device_attribute_set[1], DATA_SET_NUM);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ_CLEANUP("cursor_get_count", cursor_get_count(cursor), DATA_SET_NUM, db_cursor_free(cursor));
+	res = cursor_move_first(cursor);
+	TC_ASSERT_EQ_CLEANUP("cursor_move_first", res, DB_OK, db_cursor_free(cursor));
+	for (i = 0; i < DATA_SET_NUM; i++) {
+		TC_ASSERT_EQ_CLEANUP("cursor_get_int_value", cursor_get_int_value(cursor, 0), 0, db_cursor_free(cursor));
+		cursor_move_next(cursor);
 	}
-#endif
-	memset(query, 0, QUERY_LENGTH);
-	sprintf(query, "REMOVE INDEX %s.%s ;", RELATION_NAME1, g_attribute_set[0]);
-	res = db_exec(query);
-	TC_ASSERT("db_exec", DB_SUCCESS(res));
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
 
-	memset(query, 0, QUERY_LENGTH);
-	sprintf(query, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME1, g_attribute_set[0], INDEX_INLINE);
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME3);
 	res = db_exec(query);
 	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
@@ -296,129 +1218,321 @@ void utc_arastorage_db_exec_tc_p(void)
 }
 
 /**
-* @testcase         utc_arastorage_db_exec_tc_n
-* @brief            Excute database operations with invalid argument
-* @scenario         Create exiting relation, attribute and excute db with NULL value
-* @apicovered       db_exec
+* @testcase         utc_arastorage_db_query_join_tc_n
+* @brief            Join and sort with invalid attributes
+* @scenario         Join on an attribute which does not exist and on attributes of
+*                   different domains, and sort on an attribute which does not exist
+* @apicovered       db_query
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_query_join_tc_n(void)
+{
+	db_cursor_t *cursor;
+	char query[QUERY_LENGTH];
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s JOIN %s ON not_exist = %s WHERE %s >= 0;", g_attribute_set[0], RELATION_NAME1,
+			 RELATION_NAME2, g_attribute_set[0], g_attribute_set[0]);
+	cursor = db_query(query);
+	TC_ASSERT_EQ("db_query", cursor, NULL);
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s JOIN %s ON %s = %s WHERE %s >= 0;", g_attribute_set[0], RELATION_NAME1,
+			 RELATION_NAME2, g_attribute_set[2], g_attribute_set[0], g_attribute_set[0]);
+	cursor = db_query(query);
+	TC_ASSERT_EQ("db_query", cursor, NULL);
+
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s WHERE %s >= 0 ORDER BY not_exist;", g_attribute_set[0], RELATION_NAME1,
+			 g_attribute_set[0]);
+	cursor = db_query(query);
+	TC_ASSERT_EQ("db_query", cursor, NULL);
+
+	TC_SUCCESS_RESULT();
+}
+
+#ifdef CONFIG_ARASTORAGE_BUFFER_POOL
+/**
+* @testcase         utc_arastorage_db_get_buffer_pool_stats_tc_p
+* @brief            Get the statistics of the buffer pool
+* @scenario         Run the same selection twice, the second one reads the pages cached by the first
+* @apicovered       db_get_buffer_pool_stats
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_get_buffer_pool_stats_tc_p(void)
+{
+	db_result_t res;
+	db_cursor_t *cursor;
+	db_buffer_pool_stats_t before;
+	db_buffer_pool_stats_t after;
+	char query[QUERY_LENGTH];
+
+	snprintf(query, QUERY_LENGTH, "SELECT id FROM %s;", RELATION_NAME1);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	res = db_get_buffer_pool_stats(&before);
+	TC_ASSERT("db_get_buffer_pool_stats", DB_SUCCESS(res));
+
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
+
+	res = db_get_buffer_pool_stats(&after);
+	TC_ASSERT("db_get_buffer_pool_stats", DB_SUCCESS(res));
+	TC_ASSERT_GT("db_get_buffer_pool_stats", after.hits, before.hits);
+	TC_ASSERT_GEQ("db_get_buffer_pool_stats", after.misses, before.misses);
+
+	TC_SUCCESS_RESULT();
+}
+
+/**
+* @testcase         utc_arastorage_db_get_buffer_pool_stats_tc_n
+* @brief            Get the statistics of the buffer pool with invalid argument
+* @scenario         Get the statistics into NULL
+* @apicovered       db_get_buffer_pool_stats
 * @precondition     none
 * @postcondition    none
 */
-void utc_arastorage_db_exec_tc_n(void)
+void utc_arastorage_db_get_buffer_pool_stats_tc_n(void)
+{
+	db_result_t res;
+
+	res = db_get_buffer_pool_stats(NULL);
+	TC_ASSERT_EQ("db_get_buffer_pool_stats", res, DB_ARGUMENT_ERROR);
+
+	TC_SUCCESS_RESULT();
+}
+#endif
+
+#ifdef CONFIG_ARASTORAGE_WAL
+static off_t get_wal_size(void)
+{
+	struct stat st;
+	char path[QUERY_LENGTH];
+
+	snprintf(path, QUERY_LENGTH, "%s%s", CONFIG_MOUNT_POINT, "db.wal");
+	if (stat(path, &st) != 0) {
+		return -1;
+	}
+	return st.st_size;
+}
+
+/**
+* @testcase         utc_arastorage_db_get_wal_stats_tc_p
+* @brief            Get the statistics of the write-ahead log
+* @scenario         Insert a row, its statement is committed to the log and synced.
+*                   Removing a relation checkpoints the log, which is emptied
+* @apicovered       db_get_wal_stats
+* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_get_wal_stats_tc_p(void)
 {
 	db_result_t res;
+	db_wal_stats_t before;
+	db_wal_stats_t after;
 	char query[QUERY_LENGTH];
-	char *name = "BAD_RELATION";
-	char *attr_name = "attr";
-	/* Try to create existing relation */
-	memset(query, 0, QUERY_LENGTH);
-	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME1);
-	res = db_exec(query);
-	TC_ASSERT("db_exec", DB_ERROR(res));
+	off_t wal_size;
+	off_t size;
 
-	/* Try to create existing attribute */
-	memset(query, 0, QUERY_LENGTH);
-	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], RELATION_NAME1);
+	res = db_get_wal_stats(&before);
+	TC_ASSERT("db_get_wal_stats", DB_SUCCESS(res));
+
+	snprintf(query, QUERY_LENGTH, "INSERT (%d, %ld) INTO %s;", DATA_SET_NUM * DATA_SET_MULTIPLIER + 1, 1L, RELATION_NAME2);
 	res = db_exec(query);
-	TC_ASSERT("db_exec", DB_ERROR(res));
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
-	/* Try to excute db with NULL value */
-	res = db_exec(NULL);
-	TC_ASSERT("db_exec", DB_ERROR(res));
+	res = db_get_wal_stats(&after);
+	TC_ASSERT("db_get_wal_stats", DB_SUCCESS(res));
+	TC_ASSERT_GT("db_get_wal_stats", after.commits, before.commits);
+	TC_ASSERT_GT("db_get_wal_stats", after.syncs, before.syncs);
 
-	/* Try to parse mis-spelt query */
-	memset(query, 0, QUERY_LENGTH);
-	snprintf(query, QUERY_LENGTH, "CRAETE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], RELATION_NAME1);
-	res = db_exec(query);
-	TC_ASSERT("db_exec", DB_ERROR(res));
+	wal_size = get_wal_size();
+	TC_ASSERT_GT("stat", wal_size, 0);
 
-	/* Create duplicate attribute */
-	memset(query, 0, QUERY_LENGTH);
-	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], name);
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME4);
 	res = db_exec(query);
-	TC_ASSERT("db_exec", DB_ERROR(res));
-
-	/* Index on non-existent attribute */
-	memset(query, 0, QUERY_LENGTH);
-	snprintf(query, QUERY_LENGTH, "CREATE INDEX %s.%s TYPE %s;", RELATION_NAME1, attr_name, INDEX_BPLUS);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME4);
 	res = db_exec(query);
-	TC_ASSERT("db_exec", DB_ERROR(res));
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
-	/* execute un-implemented operation */
-	memset(query, 0, QUERY_LENGTH);
-	snprintf(query, QUERY_LENGTH, "REMOVE ATTRIBUTE %s.%s;", RELATION_NAME1, g_attribute_set[0]);
-	res = db_exec(query);
-	TC_ASSERT("db_exec", DB_ERROR(res));
+	before = after;
+	res = db_get_wal_stats(&after);
+	TC_ASSERT("db_get_wal_stats", DB_SUCCESS(res));
+	TC_ASSERT_GT("db_get_wal_stats", after.checkpoints, before.checkpoints);
+	size = get_wal_size();
+	TC_ASSERT("stat", size >= 0 && size < wal_size);
 
 	TC_SUCCESS_RESULT();
 }
 
 /**
-* @testcase         utc_arastorage_db_query_tc_p
-* @brief            Query a database
-* @scenario         Select data and get returned cursor
-* @apicovered       db_query
-* @precondition     utc_arastorage_db_exec_tc_p should be passed
+* @testcase         utc_arastorage_db_get_wal_stats_tc_n
+* @brief            Get the statistics of the write-ahead log with invalid argument
+* @scenario         Get the statistics into NULL
+* @apicovered       db_get_wal_stats
+* @precondition     none
 * @postcondition    none
 */
-void utc_arastorage_db_query_tc_p(void)
+void utc_arastorage_db_get_wal_stats_tc_n(void)
+{
+	db_result_t res;
+
+	res = db_get_wal_stats(NULL);
+	TC_ASSERT_EQ("db_get_wal_stats", res, DB_ARGUMENT_ERROR);
+
+	TC_SUCCESS_RESULT();
+}
+
+static ssize_t read_file(const char *path, char *buf, size_t size)
+{
+	ssize_t r;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return -1;
+	}
+	r = read(fd, buf, size);
+	close(fd);
+	return r;
+}
+
+static ssize_t write_file(const char *path, const char *buf, size_t size)
+{
+	ssize_t r;
+	int fd;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+	if (fd < 0) {
+		return -1;
+	}
+	r = write(fd, buf, size);
+	close(fd);
+	return r;
+}
+
+/**
+* @testcase         utc_arastorage_db_wal_recovery_tc_p
+* @brief            Recover the write-ahead log when the database is initialized
+* @scenario         Insert rows and keep the log of a crash, lose the rows which were not checkpointed
+*                   and leave rows of an uncommitted statement in the tuple file, db_init redoes the
+*                   committed rows and cuts the others
+* @apicovered       db_init
+* @precondition     utc_arastorage_db_init_tc_p should be passed
+* @postcondition    none
+*/
+void utc_arastorage_db_wal_recovery_tc_p(void)
 {
 	db_result_t res;
+	db_cursor_t *cursor;
 	char query[QUERY_LENGTH];
+	char path[QUERY_LENGTH];
+	char tuple_path[QUERY_LENGTH];
+	char name[32];
+	char *tuples;
+	char *wal;
+	ssize_t tuple_size;
+	ssize_t wal_size;
+	ssize_t row_size;
+	off_t size;
+	int i;
 
-	/* Select over bplus-tree index */
-#ifdef CONFIG_ARCH_FLOAT_H
-	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit, value, weight FROM %s WHERE value < 990;", RELATION_NAME1);
+	snprintf(query, QUERY_LENGTH, "CREATE RELATION %s;", RELATION_NAME4);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
-#else
-	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit, value FROM %s WHERE value < 990;", RELATION_NAME1);
-#endif
-	g_cursor = db_query(query);
-	TC_ASSERT_NOT_NULL("db_query", g_cursor);
+	snprintf(query, QUERY_LENGTH, "CREATE ATTRIBUTE %s DOMAIN int IN %s;", g_attribute_set[0], RELATION_NAME4);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
-	res = db_cursor_free(g_cursor);
-	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
-	g_cursor = NULL;
+	for (i = 0; i < DATA_SET_NUM; i++) {
+		snprintf(query, QUERY_LENGTH, "INSERT (%d) INTO %s;", i, RELATION_NAME4);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
 
-	/* Select with AND condition */
-	snprintf(query, QUERY_LENGTH, "SELECT id, date FROM %s WHERE id < 25 AND id > 10;", RELATION_NAME2);
-	check_query_result(query);
+	/* Checkpoint the first rows, the log starts empty */
+	size = get_wal_size();
+	TC_ASSERT_GT("stat", size, 0);
+	res = db_deinit();
+	TC_ASSERT("db_deinit", DB_SUCCESS(res));
+	res = db_init();
+	TC_ASSERT("db_init", DB_SUCCESS(res));
+	wal_size = get_wal_size();
+	TC_ASSERT("stat", wal_size >= 0 && wal_size < size);
 
-	/* Count aggregation operation */
-	snprintf(query, QUERY_LENGTH, "SELECT COUNT(id) FROM %s WHERE id = 5 OR id = 85;", RELATION_NAME2);
-	check_query_result(query);
+	/* The relation file starts with the name of its tuple file */
+	snprintf(path, QUERY_LENGTH, "%s%s", CONFIG_MOUNT_POINT, RELATION_NAME4);
+	memset(name, 0, sizeof(name));
+	TC_ASSERT_GT("read", read_file(path, name, sizeof(name) - 1), 0);
+	snprintf(tuple_path, QUERY_LENGTH, "%s%s", CONFIG_MOUNT_POINT, name);
 
-	/* Mean aggregation operation */
-	snprintf(query, QUERY_LENGTH, "SELECT MEAN(id) FROM %s;", RELATION_NAME2);
-	check_query_result(query);
+	for (i = DATA_SET_NUM; i < DATA_SET_NUM * 2; i++) {
+		snprintf(query, QUERY_LENGTH, "INSERT (%d) INTO %s;", i, RELATION_NAME4);
+		res = db_exec(query);
+		TC_ASSERT("db_exec", DB_SUCCESS(res));
+	}
 
-	/* Sum aggregation operation */
-	snprintf(query, QUERY_LENGTH, "SELECT SUM(id) FROM %s;", RELATION_NAME2);
-	check_query_result(query);
+	/* A query flushes the insert buffer, the tuple file logs its size before it grows */
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s;", g_attribute_set[0], RELATION_NAME4);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ_CLEANUP("cursor_get_count", cursor_get_count(cursor), DATA_SET_NUM * 2, db_cursor_free(cursor));
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
 
-	/* Max aggregation operation */
-	snprintf(query, QUERY_LENGTH, "SELECT MAX(id) FROM %s;", RELATION_NAME2);
-	check_query_result(query);
+	/* Keep the log as it was before the crash */
+	wal =(char *)malloc(FILE_BUFFER_SIZE);
+	TC_ASSERT_NOT_NULL("malloc", wal);
+	snprintf(path, QUERY_LENGTH, "%s%s", CONFIG_MOUNT_POINT, "db.wal");
+	wal_size = read_file(path, wal, FILE_BUFFER_SIZE);
+	TC_ASSERT_CLEANUP("read", wal_size > 0 && wal_size < FILE_BUFFER_SIZE, free(wal));
 
-	/* Min aggregation operation */
-	snprintf(query, QUERY_LENGTH, "SELECT MIN(id) FROM %s;", RELATION_NAME2);
-	check_query_result(query);
+	res = db_deinit();
+	TC_ASSERT_CLEANUP("db_deinit", DB_SUCCESS(res), free(wal));
+	TC_ASSERT_EQ_CLEANUP("write", write_file(path, wal, wal_size), wal_size, free(wal));
+	free(wal);
+
+	/* The rows inserted after the checkpoint are lost, and two rows of an
+	 * uncommitted statement follow them */
+	tuples = (char *)malloc(FILE_BUFFER_SIZE);
+	TC_ASSERT_NOT_NULL("malloc", tuples);
+	tuple_size = read_file(tuple_path, tuples, FILE_BUFFER_SIZE);
+	row_size = tuple_size / (DATA_SET_NUM * 2);
+	TC_ASSERT_CLEANUP("read", row_size > 0 && row_size * (DATA_SET_NUM * 2 + 2) <= FILE_BUFFER_SIZE, free(tuples));
+	memset(tuples + row_size * DATA_SET_NUM, 0xff, row_size * (DATA_SET_NUM + 2));
+	TC_ASSERT_EQ_CLEANUP("write", write_file(tuple_path, tuples, row_size * (DATA_SET_NUM * 2 + 2)), row_size * (DATA_SET_NUM * 2 + 2), free(tuples));
+	free(tuples);
 
-	/* Remove operation */
-	snprintf(query, QUERY_LENGTH, "REMOVE FROM %s WHERE date > 2000 AND date < 8000;", RELATION_NAME2);
-	check_query_result(query);
+	res = db_init();
+	TC_ASSERT("db_init", DB_SUCCESS(res));
 
-	/* Select over inline index */
-#ifdef CONFIG_ARCH_FLOAT_H
-	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit, weight FROM %s WHERE id > 0;", RELATION_NAME1);
+	snprintf(query, QUERY_LENGTH, "SELECT %s FROM %s;", g_attribute_set[0], RELATION_NAME4);
+	cursor = db_query(query);
+	TC_ASSERT_NOT_NULL("db_query", cursor);
+	TC_ASSERT_EQ_CLEANUP("cursor_get_count", cursor_get_count(cursor), DATA_SET_NUM * 2, db_cursor_free(cursor));
+	i = 0;
+	res = cursor_move_first(cursor);
+	while (DB_SUCCESS(res)) {
+		TC_ASSERT_EQ_CLEANUP("cursor_get_int_value", cursor_get_int_value(cursor, 0), i, db_cursor_free(cursor));
+		i++;
+		res = cursor_move_next(cursor);
+	}
+	res = db_cursor_free(cursor);
+	TC_ASSERT("db_cursor_free", DB_SUCCESS(res));
 
-#else
-	snprintf(query, QUERY_LENGTH, "SELECT id, date, fruit FROM %s WHERE id > 0;", RELATION_NAME1);
-#endif
-	g_cursor = db_query(query);
-	TC_ASSERT_NOT_NULL("db_query", g_cursor);
+	snprintf(query, QUERY_LENGTH, "REMOVE RELATION %s;", RELATION_NAME4);
+	res = db_exec(query);
+	TC_ASSERT("db_exec", DB_SUCCESS(res));
 
 	TC_SUCCESS_RESULT();
 }
+#endif
 
 /**
 * @testcase         utc_arastorage_db_query_tc_n
@@ -1140,28 +2254,28 @@ void utc_arastorage_cursor_get_attr_name_tc_n(void)
 
 	attr_name = cursor_get_attr_name(NULL, 0);
 	printf("attr name index 0 : %s\n", attr_name);
-	TC_ASSERT_NEQ("cursor_get_attr_name", strcmp((const char *)attr_name, g_attribute_set[0]), 0);
+	TC_ASSERT("cursor_get_attr_name", attr_name == NULL || strcmp((const char *)attr_name, g_attribute_set[0]) != 0);
 
 	attr_name = cursor_get_attr_name(NULL, 1);
 	printf("attr name index 1 : %s\n", attr_name);
-	TC_ASSERT_NEQ("cursor_get_attr_name", strcmp((const char *)attr_name, g_attribute_set[1]), 0);
+	TC_ASSERT("cursor_get_attr_name", attr_name == NULL || strcmp((const char *)attr_name, g_attribute_set[1]) != 0);
 
 	attr_name = cursor_get_attr_name(NULL, 2);
 	printf("attr name index 2 : %s\n", attr_name);
-	TC_ASSERT_NEQ("cursor_get_attr_name", strcmp((const char *)attr_name, g_attribute_set[2]), 0);
+	TC_ASSERT("cursor_get_attr_name", attr_name == NULL || strcmp((const char *)attr_name, g_attribute_set[2]) != 0);
 
 	attr_name = cursor_get_attr_name(g_cursor, 3);
 	printf("attr name index 3 : %s\n", attr_name);
-	TC_ASSERT_NEQ("cursor_get_attr_name", strcmp((const char *)attr_name, g_attribute_set[3]), 0);
+	TC_ASSERT("cursor_get_attr_name", attr_name == NULL || strcmp((const char *)attr_name, g_attribute_set[3]) != 0);
 
 #ifdef CONFIG_ARCH_FLOAT_H
 	attr_name = cursor_get_attr_name(NULL, 3);
 	printf("attr name index 3 : %s\n", attr_name);
-	TC_ASSERT_NEQ("cursor_get_attr_name", strcmp((const char *)attr_name, g_attribute_set[3]), 0);
+	TC_ASSERT("cursor_get_attr_name", attr_name == NULL || strcmp((const char *)attr_name, g_attribute_set[3]) != 0);
 
 	attr_name = cursor_get_attr_name(g_cursor, 4);
 	printf("attr name index 3 : %s\n", attr_name);
-	TC_ASSERT_NEQ("cursor_get_attr_name", strcmp((const char *)attr_name, g_attribute_set[3]), 0);
+	TC_ASSERT("cursor_get_attr_name", attr_name == NULL || strcmp((const char *)attr_name, g_attribute_set[3]) != 0);
 #endif
 
 	TC_SUCCESS_RESULT();
@@ -1423,6 +2537,21 @@ int arastorage_sample_launcher(int argc, FAR char *argv[])
 	utc_arastorage_db_init_tc_p();
 	utc_arastorage_db_exec_tc_p();
 	utc_arastorage_db_query_tc_p();
+	utc_arastorage_db_query_snapshot_tc_p();
+	utc_arastorage_db_query_stream_tc_p();
+	utc_arastorage_db_query_index_tc_p();
+	utc_arastorage_db_insert_batch_tc_p();
+	utc_arastorage_db_prepare_tc_p();
+	utc_arastorage_db_explain_tc_p();
+	utc_arastorage_db_query_join_tc_p();
+	utc_arastorage_db_query_order_tc_p();
+#ifdef CONFIG_ARASTORAGE_BUFFER_POOL
+	utc_arastorage_db_get_buffer_pool_stats_tc_p();
+#endif
+#ifdef CONFIG_ARASTORAGE_WAL
+	utc_arastorage_db_get_wal_stats_tc_p();
+	utc_arastorage_db_wal_recovery_tc_p();
+#endif
 	utc_arastorage_db_get_result_message_tc_p();
 	utc_arastorage_db_print_header_tc_p();
 	utc_arastorage_db_print_tuple_tc_p();
@@ -1459,6 +2588,18 @@ int arastorage_sample_launcher(int argc, FAR char *argv[])
 	db_init();
 	utc_arastorage_db_exec_tc_n();
 	utc_arastorage_db_query_tc_n();
+	utc_arastorage_db_query_stream_tc_n();
+	utc_arastorage_db_query_index_tc_n();
+	utc_arastorage_db_insert_batch_tc_n();
+	utc_arastorage_db_prepare_tc_n();
+	utc_arastorage_db_explain_tc_n();
+	utc_arastorage_db_query_join_tc_n();
+#ifdef CONFIG_ARASTORAGE_BUFFER_POOL
+	utc_arastorage_db_get_buffer_pool_stats_tc_n();
+#endif
+#ifdef CONFIG_ARASTORAGE_WAL
+	utc_arastorage_db_get_wal_stats_tc_n();
+#endif
 	utc_arastorage_db_get_result_message_tc_n();
 	utc_arastorage_db_print_header_tc_n();
 	utc_arastorage_db_print_tuple_tc_n();
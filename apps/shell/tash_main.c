@@ -46,7 +46,11 @@ enum tash_input_state_e {
 #define SELECT_TIMEOUT_SECS   (6)
 #define SELECT_TIMEOUT_USECS  (0)
 #endif
+#ifdef CONFIG_TASH_TASK_STACKSIZE
+#define TASH_TASK_STACKSIZE   CONFIG_TASH_TASK_STACKSIZE
+#else
 #define TASH_TASK_STACKSIZE   (4096)
+#endif
 #define TASH_TASK_PRIORITY    (125)
 
 const char tash_prompt[] = "TASH>>";
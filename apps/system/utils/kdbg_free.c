@@ -72,6 +72,9 @@ int kdbg_free(int argc, char **args)
 
 	printf("              total       used       free    largest\n");
 	printf("Data:   %11d%11d%11d%11d\n", data.arena, data.uordblks, data.fordblks, data.mxordblk);
+#ifdef CONFIG_MM_FASTBINS
+	printf("Fast bins: %d chunks, %d bytes, %d hits, %d misses\n", data.smblks, data.fsmblks, data.fbhits, data.fbmisses);
+#endif
 
 	return OK;
 }
@@ -161,6 +161,9 @@ typedef struct _db_handle_s db_handle_t;
 struct _db_cursor_s;
 typedef struct _db_cursor_s db_cursor_t;
 
+struct db_stmt_s;
+typedef struct db_stmt_s db_stmt_t;
+
 typedef int db_storage_id_t;
 
 typedef uint32_t cursor_row_t;
@@ -169,6 +172,34 @@ typedef uint32_t tuple_id_t;
 
 typedef uint8_t attribute_id_t;
 
+/* A column of db_insert_batch(): values points to an array of int for
+   DOMAIN_INT, of long for DOMAIN_LONG and of char * for DOMAIN_STRING. */
+struct db_column_s {
+	domain_t domain;
+	const void *values;
+};
+typedef struct db_column_s db_column_t;
+
+#ifdef CONFIG_ARASTORAGE_BUFFER_POOL
+struct db_buffer_pool_stats_s {
+	uint32_t hits;				/* pages found in the pool */
+	uint32_t misses;			/* pages read from storage */
+	uint32_t evictions;			/* pages replaced by other pages */
+	uint32_t writebacks;		/* modified pages written to storage */
+};
+typedef struct db_buffer_pool_stats_s db_buffer_pool_stats_t;
+#endif
+
+#ifdef CONFIG_ARASTORAGE_WAL
+struct db_wal_stats_s {
+	uint32_t commits;			/* statements which wrote to the log */
+	uint32_t syncs;				/* times the log was synced to storage */
+	uint32_t checkpoints;		/* times the log was emptied into the files */
+	uint32_t log_bytes;			/* bytes written to the log */
+};
+typedef struct db_wal_stats_s db_wal_stats_t;
+#endif
+
 /****************************************************************************
 * Public Variables
 ****************************************************************************/
@@ -182,6 +213,8 @@ static db_output_function_t output = printf;
 
 /**
 * @brief initialize database's resouces, it must be called when user arastorage
+* @details With CONFIG_ARASTORAGE_WAL, the statements which were committed to the
+* write-ahead log before a crash are redone here.
 * @param none
 * @return On success, 1 is returned. On failure, a negative value is returned.
 * @since Tizen RT v1.0
@@ -200,6 +233,14 @@ db_result_t db_deinit(void);
 /**
 * @brief Create Component of Arastorage.
 *
+* @details "EXPLAIN SELECT ..." does not run the query but prints, with the output
+* function, the access paths considered for it: a full scan and a search of each
+* index of an attribute in the WHERE condition, with their estimated rows and cost.
+* The chosen path is marked with '*'.
+*
+* With CONFIG_ARASTORAGE_WAL, a statement which returns successfully is on storage.
+* Statements which other tasks commit at the same time are synced together.
+*
 * @param[in] handle of database
 * @param[in] query sentence
 * @return On success, positive value is returned. On failure, a negative value is returned.
@@ -208,9 +249,41 @@ db_result_t db_deinit(void);
 */
 db_result_t db_exec(char *format);
 
+/**
+* @brief Insert many tuples into a relation without parsing an AQL statement for each
+*
+* @details The tuples are given column by column: columns[i] holds the values of the
+* i:th attribute of the relation for all tuples, so column_count must be the number of
+* attributes.  An int column may be given for a long attribute.  The rows are appended
+* to the tuple file in chunks of CONFIG_ARASTORAGE_BATCH_BUFFER_SIZE bytes, and the
+* indexes of the relation are updated once with the sorted keys of the whole batch.
+*
+* @param[in] name of the relation
+* @param[in] array of column_count columns
+* @param[in] number of columns
+* @param[in] number of tuples in each column
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_insert_batch(char *relation_name, db_column_t *columns, uint8_t column_count, uint32_t row_count);
+
 /**
 * @brief Arastorage basic query API
 *
+* @details A SELECT reads a snapshot of the relation, taken when the query starts.
+* Tuples inserted while the query runs or while the cursor is used are not part
+* of the result.  The relation can not be removed and its tuples can not be
+* removed (DB_BUSY_ERROR) until the cursor is freed with db_cursor_free().
+*
+* "SELECT a, c FROM r JOIN s ON b = d WHERE ..." joins the tuples of r and s
+* whose attributes b and d are equal.  The smaller relation is hashed in
+* CONFIG_ARASTORAGE_JOIN_MEMORY bytes, or split into partitions on storage when
+* it does not fit, and the condition is checked on the joined tuples.
+* "ORDER BY a [ASC|DESC]" sorts the result by one attribute in
+* CONFIG_ARASTORAGE_SORT_MEMORY bytes, merging sorted runs on storage when the
+* result does not fit.  Both keep their result in a temporary relation until the
+* cursor is freed.
+*
 * @param[in] handle of database
 * @param[in] query sentence
 * @return On success, pointer of db_handle_t returned. On failure, a NULL is returned.
@@ -218,9 +291,99 @@ db_result_t db_exec(char *format);
 */
 db_cursor_t *db_query(char *format);
 
+/**
+* @brief Arastorage streaming query API
+*
+* @details Unlike db_query(), the query is not processed before the cursor is returned.
+* Each cursor_move_next() reads the relation until the next tuple which fulfils the
+* condition, so the first row is available at once and no result is built in memory
+* or on storage.  A LIMIT clause ends the scan after the given number of rows.
+* The cursor only moves forward: cursor_move_first() is allowed only before the first
+* row has been read, and cursor_move_prev() and cursor_move_last() fail.
+* cursor_get_count() returns the number of rows read so far.  The relation is read
+* sequentially, through a snapshot as with db_query().
+*
+* @param[in] query sentence, a SELECT
+* @return On success, pointer of db_cursor_t returned. On failure, a NULL is returned.
+* @since Tizen RT v1.0
+*/
+db_cursor_t *db_query_stream(char *format);
+
+/**
+* @brief Arastorage prepared statement API
+*
+* @details The query is compiled once and can be run many times with db_step().
+* A '?' in the query is a parameter, in place of a value of an INSERT or of a
+* constant of the WHERE condition, and is numbered from 0 in the order of the query.
+* Compiled queries are cached by their text (CONFIG_ARASTORAGE_QUERY_CACHE_SIZE),
+* so preparing the same query again does not parse it again.
+*
+* @param[in] query sentence, which may have parameters
+* @return On success, pointer of db_stmt_t returned. On failure, a NULL is returned.
+* @since Tizen RT v1.0
+*/
+db_stmt_t *db_prepare(char *format);
+
+/**
+* @brief Bind an int value to a parameter of a prepared statement
+*
+* @param[in] prepared statement
+* @param[in] index of the parameter
+* @param[in] value
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_bind_int(db_stmt_t *stmt, uint8_t index, int value);
+
+/**
+* @brief Bind a long value to a parameter of a prepared statement
+*
+* @param[in] prepared statement
+* @param[in] index of the parameter
+* @param[in] value
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_bind_long(db_stmt_t *stmt, uint8_t index, long value);
+
+/**
+* @brief Bind a string to a parameter of a prepared statement. The string is copied.
+*
+* @param[in] prepared statement
+* @param[in] index of the parameter
+* @param[in] value, shorter than DB_MAX_ELEMENT_SIZE
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_bind_string(db_stmt_t *stmt, uint8_t index, const char *value);
+
+/**
+* @brief Run a prepared statement with the values bound to its parameters
+*
+* @details Every parameter must be bound.  The values stay bound after the step,
+* so only the changed ones have to be bound again before the next step.
+* A SELECT returns its cursor as db_query() does, which is freed with db_cursor_free().
+*
+* @param[in] prepared statement
+* @param[out] cursor of a SELECT, or NULL for other statements
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_step(db_stmt_t *stmt, db_cursor_t **cursor);
+
+/**
+* @brief free a prepared statement
+*
+* @param[in] prepared statement
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_finalize(db_stmt_t *stmt);
+
 
 /**
-* @brief free allocated cursor data. This should be called before application terminated.
+* @brief free allocated cursor data. This should be called before application terminated
+*        and before db_deinit().
 *
 * @param[out] cursor of current tuple's selected data
 * @return On success, positive value is returned. On failure, a negative value is returned.
@@ -228,6 +391,30 @@ db_cursor_t *db_query(char *format);
 */
 db_result_t db_cursor_free(db_cursor_t *cursor);
 
+#ifdef CONFIG_ARASTORAGE_BUFFER_POOL
+/**
+* @brief Get the statistics of the buffer pool which caches the pages of tuple
+*        and index files, counted since db_init().
+*
+* @param[out] statistics of the buffer pool
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_get_buffer_pool_stats(db_buffer_pool_stats_t *stats);
+#endif
+
+#ifdef CONFIG_ARASTORAGE_WAL
+/**
+* @brief Get the statistics of the write-ahead log, counted since db_init().
+*        Statements of several tasks which commit together share one sync.
+*
+* @param[out] statistics of the write-ahead log
+* @return On success, positive value is returned. On failure, a negative value is returned.
+* @since Tizen RT v1.0
+*/
+db_result_t db_get_wal_stats(db_wal_stats_t *stats);
+#endif
+
 /**
 * @brief get string of each API's result based on value of db_result_t
 *
@@ -96,6 +96,10 @@
 #define AQL_FLAG_AGGREGATE              1
 #define AQL_FLAG_SELECT_ALL             2
 #define AQL_FLAG_ASSIGN                 4
+#define AQL_FLAG_EXPLAIN                8
+#define AQL_FLAG_JOIN                   16
+#define AQL_FLAG_ORDER                  32
+#define AQL_FLAG_DESCENDING             64
 
 #define AQL_CLEAR(adt)                  aql_clear(adt)
 #define AQL_SET_TYPE(adt, type)  (((adt))->optype = (type))
@@ -124,8 +128,18 @@
 	aql_add_operand_value((adt), (value))
 #define AQL_ATTRIBUTE_COUNT(adt)        ((adt)->attribute_count)
 #define AQL_SET_CONDITION(adt, cond)    ((adt)->lvm_instance = (cond))
+#define AQL_SET_JOIN(adt, left, right)  aql_set_join((adt), (left), (right))
+#define AQL_SET_ORDER(adt, attr)        aql_set_order((adt), (attr))
+#define AQL_SET_LIMIT(adt, rows)        ((adt)->limit = (rows))
+#define AQL_GET_LIMIT(adt)              ((adt)->limit)
 #define AQL_ADD_VALUE(adt, domain, value)                               \
 	aql_add_value((adt), (domain), (value))
+#define AQL_ADD_PARAMETER(adt, in_values)                               \
+	aql_add_parameter((adt), (in_values))
+#define AQL_PARAMETER_COUNT(adt)        ((adt)->parameter_count)
+
+/* The parameter is an operand of the condition and not an inserted value. */
+#define AQL_PARAMETER_CONDITION         0xFF
 
 /****************************************************************************
 * Public Type Definitions
@@ -193,6 +207,14 @@ enum token_e {
 
 	ATTRIBUTE,
 	BPLUSTREE,					/* 48 */
+	LIMIT,
+	BETWEEN,
+	PARAMETER,
+	EXPLAIN,
+	ORDER,
+	BY,
+	ASC,
+	DESC,
 
 	INTEGER_VALUE = 251,
 	FLOAT_VALUE = 252,
@@ -244,10 +266,35 @@ struct aql_adt_s {
 	uint8_t value_count;
 	uint32_t optype;
 	uint8_t flags;
+	tuple_id_t limit;
+	/* The attributes of the first and of the second relation of a JOIN
+	   whose values are equal in a joined row */
+	char join_attributes[2][ATTRIBUTE_NAME_LENGTH + 1];
+	char order_attribute[ATTRIBUTE_NAME_LENGTH + 1];
 	void *lvm_instance;
+	/* The value index of each '?' in order, or AQL_PARAMETER_CONDITION */
+	uint8_t parameters[AQL_PARAMETER_LIMIT];
+	uint8_t parameter_count;
 };
 typedef struct aql_adt_s aql_adt_t;
 
+/* A statement compiled by aql_statement_get(). It is shared by all the
+   prepared statements of the same query text. */
+struct aql_statement_s {
+	struct aql_statement_s *next;
+	char *query;
+	aql_adt_t adt;
+	uint16_t users;
+	uint8_t cached;
+};
+typedef struct aql_statement_s aql_statement_t;
+
+struct db_stmt_s {
+	aql_statement_t *statement;
+	attribute_value_t values[AQL_PARAMETER_LIMIT];
+	value_t strings[AQL_PARAMETER_LIMIT];
+};
+
 /****************************************************************************
 * Global Function Prototypes
 ****************************************************************************/
@@ -257,8 +304,18 @@ void lexer_rewind(lexer_t *);
 
 void aql_clear(aql_adt_t *adt);
 void aql_add_relation(aql_adt_t *adt, char *rel);
+db_result_t aql_set_join(aql_adt_t *adt, char *left, char *right);
+db_result_t aql_set_order(aql_adt_t *adt, char *name);
 aql_status_t aql_parse(aql_adt_t *adt, char *query_string);
+db_result_t aql_deinit_handle(db_handle_t **handle);
 db_result_t aql_add_attribute(aql_adt_t *adt, char *name, domain_t domain, unsigned element_size, int processed_only);
 db_result_t aql_add_value(aql_adt_t *adt, domain_t domain, void *value);
+db_result_t aql_add_parameter(aql_adt_t *adt, int in_values);
+void aql_free(aql_adt_t *adt);
+
+db_result_t aql_statement_init(void);
+void aql_statement_deinit(void);
+aql_statement_t *aql_statement_get(char *query);
+void aql_statement_put(aql_statement_t *statement);
 
 #endif							/* !AQL_H */
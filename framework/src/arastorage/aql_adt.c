@@ -85,9 +85,29 @@ void aql_clear(aql_adt_t *adt)
 	adt->attribute_count = 0;
 	adt->value_count = 0;
 	adt->flags = 0;
+	adt->limit = 0;
+	adt->parameter_count = 0;
 	memset(adt->aggregators, 0, sizeof(adt->aggregators));
 }
 
+/* Releases the memory that the parser allocated for the statement. */
+void aql_free(aql_adt_t *adt)
+{
+	int i;
+
+	for (i = 0; i < adt->value_count; i++) {
+		if (adt->values[i].domain == DOMAIN_STRING) {
+			free(VALUE_STRING(&adt->values[i]));
+		}
+	}
+	adt->value_count = 0;
+
+	if (adt->lvm_instance != NULL) {
+		free(adt->lvm_instance);
+		adt->lvm_instance = NULL;
+	}
+}
+
 void aql_add_relation(aql_adt_t *adt, char *rel)
 {
 	if (adt->relation_count < AQL_RELATION_LIMIT - 1) {
@@ -97,6 +117,38 @@ void aql_add_relation(aql_adt_t *adt, char *rel)
 	}
 }
 
+db_result_t aql_set_join(aql_adt_t *adt, char *left, char *right)
+{
+	if (strlen(left) + 1 > sizeof(adt->join_attributes[0]) || strlen(right) + 1 > sizeof(adt->join_attributes[1])) {
+		return DB_LIMIT_ERROR;
+	}
+
+	strncpy(adt->join_attributes[0], left, sizeof(adt->join_attributes[0]));
+	strncpy(adt->join_attributes[1], right, sizeof(adt->join_attributes[1]));
+	adt->flags |= AQL_FLAG_JOIN;
+
+	return DB_OK;
+}
+
+/* The rows are sorted by the attribute, which is read by the selection
+   even if it is not projected. */
+db_result_t aql_set_order(aql_adt_t *adt, char *name)
+{
+	if (adt->flags & AQL_FLAG_AGGREGATE) {
+		/* An aggregation results in a single row. */
+		return DB_OK;
+	}
+
+	if (strlen(name) + 1 > sizeof(adt->order_attribute)) {
+		return DB_LIMIT_ERROR;
+	}
+
+	strncpy(adt->order_attribute, name, sizeof(adt->order_attribute));
+	adt->flags |= AQL_FLAG_ORDER;
+
+	return aql_add_attribute(adt, name, DOMAIN_UNSPECIFIED, 0, 1);
+}
+
 db_result_t aql_add_attribute(aql_adt_t *adt, char *name, domain_t domain, unsigned element_size, int processed_only)
 {
 	aql_attribute_t *attr;
@@ -160,3 +212,25 @@ db_result_t aql_add_value(aql_adt_t *adt, domain_t domain, void *value_ptr)
 
 	return DB_OK;
 }
+
+db_result_t aql_add_parameter(aql_adt_t *adt, int in_values)
+{
+	if (adt->parameter_count == AQL_PARAMETER_LIMIT) {
+		return DB_LIMIT_ERROR;
+	}
+
+	if (!in_values) {
+		adt->parameters[adt->parameter_count++] = AQL_PARAMETER_CONDITION;
+		return DB_OK;
+	}
+
+	if (adt->value_count == AQL_ATTRIBUTE_LIMIT) {
+		return DB_LIMIT_ERROR;
+	}
+
+	/* The value is filled in from the bound parameter for each run. */
+	adt->values[adt->value_count].domain = DOMAIN_UNSPECIFIED;
+	adt->parameters[adt->parameter_count++] = adt->value_count++;
+
+	return DB_OK;
+}
@@ -65,9 +65,13 @@
 
 #include "db_debug.h"
 #include "storage.h"
+#include "buffer_pool.h"
+#include "wal.h"
 #include "relation.h"
 #include "result.h"
 #include "aql.h"
+#include "lvm.h"
+#include "rw_locks.h"
 
 /****************************************************************************
 * Private Functions
@@ -146,30 +150,198 @@ relation_t *aql_get_relation(aql_adt_t *adt)
 	return relation_load(adt->relations[first_rel_arg]);
 }
 
-db_result_t db_exec(char *format)
+/* Join the relations of the query into a temporary relation. */
+static relation_t *aql_join(aql_adt_t *adt)
+{
+	relation_t *left;
+	relation_t *right;
+	relation_t *rel;
+
+	rel = NULL;
+	left = relation_load(adt->relations[0]);
+	right = relation_load(adt->relations[1]);
+	if (left != NULL && right != NULL) {
+		rel = relation_join(left, right, adt);
+	}
+
+	if (left != NULL) {
+		relation_release(left);
+	}
+	if (right != NULL) {
+		relation_release(right);
+	}
+	return rel;
+}
+
+/*
+ * Sort the rows which the query selects from rel into a temporary relation,
+ * which takes the place of rel in adt.  The rows are read with a streaming
+ * cursor, so that the sort keeps only a few of them in memory, and the
+ * cursor releases rel and the condition of the query.
+ */
+static relation_t *aql_sort(aql_adt_t *adt, relation_t *rel)
+{
+	db_handle_t *handler;
+	db_cursor_t *cursor;
+	relation_t *sorted;
+	tuple_id_t limit;
+	uint8_t flags;
+
+	if (DB_ERROR(aql_init_handle(&handler))) {
+		DB_LOG_E("DB: Init handle failed\n");
+		relation_release(rel);
+		return NULL;
+	}
+	handler->flags |= DB_HANDLE_FLAG_STREAM;
+
+	/* The handle takes the relation and the condition */
+	if (DB_ERROR(relation_select(&handler, rel, adt))) {
+		DB_LOG_E("DB: Failed relation_select\n");
+		adt->lvm_instance = NULL;
+		aql_deinit_handle(&handler);
+		return NULL;
+	}
+	adt->lvm_instance = NULL;
+
+	/* The sort keeps the first rows, so every row has to be read */
+	limit = handler->limit;
+	handler->limit = 0;
+	cursor = relation_process_stream(handler);
+	if (cursor == NULL) {
+		DB_LOG_E("DB: Failed to create streaming cursor\n");
+		aql_deinit_handle(&handler);
+		return NULL;
+	}
+
+	sorted = relation_sort(cursor, adt->order_attribute, AQL_GET_FLAGS(adt) & AQL_FLAG_DESCENDING, limit);
+	cursor_deinit(cursor);
+	if (sorted == NULL) {
+		return NULL;
+	}
+
+	/* The sorted rows hold the attributes of the result, and are selected
+	   in the order in which they are stored. */
+	flags = AQL_GET_FLAGS(adt);
+	AQL_CLEAR(adt);
+	AQL_SET_TYPE(adt, AQL_TYPE_SELECT);
+	AQL_ADD_RELATION(adt, sorted->name);
+	AQL_SET_FLAG(adt, AQL_FLAG_SELECT_ALL | (flags & AQL_FLAG_EXPLAIN));
+
+	return sorted;
+}
+
+/* Plan the selection from rel, which the handle releases. */
+static db_result_t aql_explain_select(aql_adt_t *adt, relation_t *rel)
+{
+	db_handle_t *handler;
+	db_plan_t plans[DB_PLAN_LIMIT];
+	db_result_t res;
+
+	if (DB_ERROR(aql_init_handle(&handler))) {
+		DB_LOG_E("DB: Init handle failed\n");
+		relation_release(rel);
+		return DB_ALLOCATION_ERROR;
+	}
+	handler->plans = plans;
+
+	/* The handle releases the relation and frees the condition. */
+	res = relation_select(&handler, rel, adt);
+	adt->lvm_instance = NULL;
+	if (DB_SUCCESS(res)) {
+		res = db_print_plan(handler);
+	} else {
+		DB_LOG_E("DB: Failed relation_select\n");
+	}
+	aql_deinit_handle(&handler);
+
+	return res;
+}
+
+/* Plan the join of the relations of the query. */
+static db_result_t aql_explain_join(aql_adt_t *adt)
+{
+	relation_t *left;
+	relation_t *right;
+	db_join_plan_t plan;
+	db_result_t res;
+
+	res = DB_RELATIONAL_ERROR;
+	left = relation_load(adt->relations[0]);
+	right = relation_load(adt->relations[1]);
+	if (left != NULL && right != NULL) {
+		res = relation_join_plan(left, right, adt, &plan);
+		if (DB_SUCCESS(res)) {
+			res = db_print_join_plan(&plan, adt->join_attributes[0], adt->join_attributes[1]);
+		}
+	}
+
+	if (left != NULL) {
+		relation_release(left);
+	}
+	if (right != NULL) {
+		relation_release(right);
+	}
+
+	/* The condition is not planned, as it is checked on the joined rows. */
+	free(adt->lvm_instance);
+	adt->lvm_instance = NULL;
+	return res;
+}
+
+/* Plan a query as aql_query_adt() does, and print the plan instead of running it. */
+static db_result_t aql_explain_adt(aql_adt_t *adt)
+{
+	relation_t *rel;
+	db_result_t res;
+
+#ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
+	if (DB_SUCCESS(storage_flush_insert_buffer())) {
+		DB_LOG_D("DB : flush insert buffer!!\n");
+	}
+#endif
+
+	if (AQL_GET_FLAGS(adt) & AQL_FLAG_JOIN) {
+		/* The joined rows are scanned, as they are not indexed. */
+		res = aql_explain_join(adt);
+	} else {
+		rel = aql_get_relation(adt);
+		if (rel == NULL) {
+			DB_LOG_E("DB : get relation Failed\n");
+			return DB_RELATIONAL_ERROR;
+		}
+		res = aql_explain_select(adt, rel);
+	}
+
+	if (DB_SUCCESS(res) && (AQL_GET_FLAGS(adt) & AQL_FLAG_ORDER)) {
+		res = db_print_sort_plan(adt->order_attribute, AQL_GET_FLAGS(adt) & AQL_FLAG_DESCENDING, AQL_GET_LIMIT(adt));
+	}
+
+	return res;
+}
+
+static db_result_t aql_exec_adt(aql_adt_t *adt)
 {
 	db_result_t res;
-	aql_adt_t adt;
 	relation_t *rel = NULL;
 	aql_attribute_t *attr;
 	attribute_t *relattr = NULL;
+	attribute_t *keyattrs[DB_MAX_INDEX_KEY_ATTRIBUTES];
 	uint32_t optype;
-	res = aql_get_parse_result(format, &adt);
+	int i;
 
-	if (DB_ERROR(res)) {
-		DB_LOG_E("DB : Parsing Error in db_create : %d\n", res);
-		return DB_PARSING_ERROR;
+	if (AQL_GET_FLAGS(adt) & AQL_FLAG_EXPLAIN) {
+		return aql_explain_adt(adt);
 	}
 
-	optype = AQL_GET_OP_TYPE(AQL_GET_TYPE(&adt));
+	optype = AQL_GET_OP_TYPE(AQL_GET_TYPE(adt));
 	if (optype == AQL_OP_TYPE_QUERY) {
 		DB_LOG_E("DB : AQL OP TYPE Error \n");
 		return DB_ARGUMENT_ERROR;
 	}
 
-	optype = AQL_GET_EXEC_TYPE(AQL_GET_TYPE(&adt));
+	optype = AQL_GET_EXEC_TYPE(AQL_GET_TYPE(adt));
 	if (optype != AQL_TYPE_CREATE_RELATION && optype != AQL_TYPE_REMOVE_RELATION) {
-		rel = aql_get_relation(&adt);
+		rel = aql_get_relation(adt);
 		if (rel == NULL) {
 			DB_LOG_E("DB : get relation Failed\n");
 			return DB_RELATIONAL_ERROR;
@@ -180,27 +352,33 @@ db_result_t db_exec(char *format)
 
 	switch (optype) {
 	case AQL_TYPE_CREATE_ATTRIBUTE:
-		attr = &(adt.attributes[0]);
+		attr = &(adt->attributes[0]);
 		if (relation_attribute_add(rel, DB_STORAGE, attr->name, attr->domain, attr->element_size) != NULL) {
 			res = DB_OK;
 		}
 		break;
 	case AQL_TYPE_CREATE_INDEX:
-		relattr = relation_attribute_get(rel, adt.attributes[0].name);
-		if (relattr == NULL) {
-			res = DB_NAME_ERROR;
+		res = DB_OK;
+		for (i = 0; i < AQL_ATTRIBUTE_COUNT(adt) && i < DB_MAX_INDEX_KEY_ATTRIBUTES; i++) {
+			keyattrs[i] = relation_attribute_get(rel, adt->attributes[i].name);
+			if (keyattrs[i] == NULL) {
+				res = DB_NAME_ERROR;
+				break;
+			}
+		}
+		if (DB_ERROR(res)) {
 			break;
 		}
-		res = index_create(AQL_GET_INDEX_TYPE(&adt), rel, relattr);
+		res = index_create(AQL_GET_INDEX_TYPE(adt), rel, keyattrs, i);
 		break;
 	case AQL_TYPE_CREATE_RELATION:
-		if (relation_create(adt.relations[0], DB_STORAGE) != NULL) {
+		if (relation_create(adt->relations[0], DB_STORAGE) != NULL) {
 			res = DB_OK;
 		}
 		break;
 	case AQL_TYPE_INSERT:
 		if (relation_cardinality(rel) < DB_TUPLE_LIMIT) {
-			res = relation_insert(rel, adt.values);
+			res = relation_insert(rel, adt->values);
 			if (DB_SUCCESS(res)) {
 				res = DB_OK;
 			}
@@ -209,10 +387,10 @@ db_result_t db_exec(char *format)
 		}
 		break;
 	case AQL_TYPE_REMOVE_ATTRIBUTE:
-		res = relation_attribute_remove(rel, adt.attributes[0].name);
+		res = relation_attribute_remove(rel, adt->attributes[0].name);
 		break;
 	case AQL_TYPE_REMOVE_INDEX:
-		relattr = relation_attribute_get(rel, adt.attributes[0].name);
+		relattr = relation_attribute_get(rel, adt->attributes[0].name);
 		if (relattr != NULL) {
 			index_load(rel, relattr);
 			if (relattr->index != NULL) {
@@ -225,7 +403,7 @@ db_result_t db_exec(char *format)
 		}
 		break;
 	case AQL_TYPE_REMOVE_RELATION:
-		res = relation_remove(adt.relations[0], 1);
+		res = relation_remove(adt->relations[0], 1);
 		break;
 	default:
 		break;
@@ -236,9 +414,31 @@ db_result_t db_exec(char *format)
 	return res;
 }
 
-db_cursor_t *db_query(char *format)
+static db_result_t aql_exec(char *format)
 {
+	db_result_t res;
 	aql_adt_t adt;
+
+	res = aql_get_parse_result(format, &adt);
+	if (DB_ERROR(res)) {
+		DB_LOG_E("DB : Parsing Error in db_create : %d\n", res);
+		return DB_PARSING_ERROR;
+	}
+
+	if (AQL_PARAMETER_COUNT(&adt) > 0) {
+		DB_LOG_E("DB : Parameters need db_prepare\n");
+		res = DB_ARGUMENT_ERROR;
+	} else {
+		res = aql_exec_adt(&adt);
+	}
+	aql_free(&adt);
+
+	return res;
+}
+
+/* The handle takes the condition of the adt, it is freed here otherwise. */
+static db_cursor_t *aql_query_adt(aql_adt_t *adt, bool stream)
+{
 	relation_t *rel;
 	uint32_t optype;
 	db_handle_t *handler;
@@ -247,15 +447,13 @@ db_cursor_t *db_query(char *format)
 
 	handler = NULL;
 	cursor = NULL;
+	rel = NULL;
 
-	if (DB_ERROR(aql_get_parse_result(format, &adt))) {
-		DB_LOG_E("DB : Parsing Error in db_create : %d\n");
-		return NULL;
-	}
-	optype = AQL_GET_OP_TYPE(AQL_GET_TYPE(&adt));
-	if (optype != AQL_OP_TYPE_QUERY) {
+	/* EXPLAIN prints the plan of a query with db_exec(). */
+	optype = AQL_GET_OP_TYPE(AQL_GET_TYPE(adt));
+	if (optype != AQL_OP_TYPE_QUERY || (AQL_GET_FLAGS(adt) & AQL_FLAG_EXPLAIN)) {
 		DB_LOG_E("DB : AQL OP TYPE Error \n");
-		return NULL;
+		goto errout;
 	}
 #ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
 	if (DB_SUCCESS(storage_flush_insert_buffer())) {
@@ -263,19 +461,38 @@ db_cursor_t *db_query(char *format)
 	}
 #endif
 
-	rel = aql_get_relation(&adt);
+	if (AQL_GET_FLAGS(adt) & AQL_FLAG_JOIN) {
+		/* The condition and the rest of the query apply to the joined rows. */
+		rel = aql_join(adt);
+	} else {
+		rel = aql_get_relation(adt);
+	}
 	if (rel == NULL) {
-		return NULL;
+		goto errout;
 	}
 
-	optype = AQL_GET_EXEC_TYPE(AQL_GET_TYPE(&adt));
+	if (AQL_GET_FLAGS(adt) & AQL_FLAG_ORDER) {
+		/* The query selects all the sorted rows from now on. */
+		rel = aql_sort(adt, rel);
+		if (rel == NULL) {
+			goto errout;
+		}
+	}
+
+	optype = AQL_GET_EXEC_TYPE(AQL_GET_TYPE(adt));
 	switch (optype) {
 	case AQL_TYPE_REMOVE_TUPLES:
+		/* Removing tuples rewrites the tuple file, which is not possible
+		   while cursors still read a snapshot of it. */
+		if (rel->snapshots > 0) {
+			DB_LOG_E("DB: Relation %s is read by a cursor\n", rel->name);
+			goto errout;
+		}
 		/* Overwrite the attribute array with a full copy of the original
 		   relation's attributes. */
-		adt.attribute_count = 0;
+		adt->attribute_count = 0;
 		for (attr_ptr = list_head(rel->attributes); attr_ptr != NULL; attr_ptr = attr_ptr->next) {
-			AQL_ADD_ATTRIBUTE(&adt, attr_ptr->name, DOMAIN_UNSPECIFIED, 0);
+			AQL_ADD_ATTRIBUTE(adt, attr_ptr->name, DOMAIN_UNSPECIFIED, 0);
 		}
 	/* FALLTHROUGH */
 	case AQL_TYPE_SELECT:
@@ -283,10 +500,23 @@ db_cursor_t *db_query(char *format)
 			DB_LOG_E("DB: Init handle failed\n");
 			goto errout;
 		}
-		if (DB_ERROR(relation_select(&handler, rel, &adt))) {
+		if (stream) {
+			handler->flags |= DB_HANDLE_FLAG_STREAM;
+		}
+		if (DB_ERROR(relation_select(&handler, rel, adt))) {
 			DB_LOG_E("DB: Failed relation_select\n");
 			goto errout;
 		}
+		adt->lvm_instance = NULL;
+		if (stream) {
+			cursor = relation_process_stream(handler);
+			if (cursor == NULL) {
+				DB_LOG_E("DB: Failed to create streaming cursor\n");
+				goto errout;
+			}
+			/* The cursor owns the handle and the relation from now on. */
+			return cursor;
+		}
 		cursor = relation_process_result(handler);
 		if (cursor == NULL) {
 			DB_LOG_E("DB: Failed to process cursor tuples\n");
@@ -304,6 +534,10 @@ db_cursor_t *db_query(char *format)
 			relation_release(rel);
 		}
 	}
+	if (adt->lvm_instance != NULL) {
+		free(adt->lvm_instance);
+		adt->lvm_instance = NULL;
+	}
 	aql_deinit_handle(&handler);
 
 	return cursor;
@@ -317,7 +551,305 @@ errout:
 		cursor_deinit(cursor);
 	}
 
+	if (handler == NULL || handler->lvm_instance != adt->lvm_instance) {
+		free(adt->lvm_instance);
+	}
+	adt->lvm_instance = NULL;
 	aql_deinit_handle(&handler);
 
 	return NULL;
 }
+
+static db_cursor_t *aql_query(char *format, bool stream)
+{
+	aql_adt_t adt;
+	db_cursor_t *cursor;
+
+	if (DB_ERROR(aql_get_parse_result(format, &adt))) {
+		DB_LOG_E("DB : Parsing Error in db_create : %d\n");
+		return NULL;
+	}
+
+	if (AQL_PARAMETER_COUNT(&adt) > 0) {
+		DB_LOG_E("DB : Parameters need db_prepare\n");
+		aql_free(&adt);
+		return NULL;
+	}
+	cursor = aql_query_adt(&adt, stream);
+	aql_free(&adt);
+
+	return cursor;
+}
+
+/*
+ * Copy the compiled statement to adt with the bound values in place of its
+ * parameters. The condition is cloned, as the query handle owns and
+ * changes it.
+ */
+static db_result_t aql_bind(db_stmt_t *stmt, aql_adt_t *adt)
+{
+	aql_statement_t *statement;
+	operand_t operands[AQL_PARAMETER_LIMIT];
+	attribute_value_t *value;
+	lvm_instance_t *lvm;
+	int i;
+
+	statement = stmt->statement;
+	memcpy(adt, &statement->adt, sizeof(aql_adt_t));
+	adt->lvm_instance = NULL;
+
+	for (i = 0; i < AQL_PARAMETER_COUNT(adt); i++) {
+		value = &stmt->values[i];
+		if (value->domain == DOMAIN_UNSPECIFIED) {
+			DB_LOG_E("DB : Parameter %d is not bound\n", i);
+			return DB_ARGUMENT_ERROR;
+		}
+		if (adt->parameters[i] != AQL_PARAMETER_CONDITION) {
+			adt->values[adt->parameters[i]] = *value;
+			continue;
+		}
+		if (value->domain == DOMAIN_STRING) {
+			operands[i].type = LVM_STRING;
+			operands[i].value.s = (const char *)VALUE_STRING(value);
+		} else {
+			operands[i].type = LVM_LONG;
+			operands[i].value.l = VALUE_LONG(value);
+		}
+	}
+
+	if (statement->adt.lvm_instance == NULL) {
+		return DB_OK;
+	}
+
+	lvm = (lvm_instance_t *)malloc(sizeof(lvm_instance_t));
+	if (lvm == NULL) {
+		return DB_ALLOCATION_ERROR;
+	}
+	if (LVM_ERROR(lvm_bind_parameters(lvm, statement->adt.lvm_instance, operands, AQL_PARAMETER_COUNT(adt)))) {
+		DB_LOG_E("DB : Failed to bind the condition\n");
+		free(lvm);
+		return DB_LIMIT_ERROR;
+	}
+	adt->lvm_instance = lvm;
+
+	return DB_OK;
+}
+
+db_result_t db_exec(char *format)
+{
+	db_result_t res;
+	wal_lsn_t lsn;
+
+	db_lock();
+	res = aql_exec(format);
+	/* Modified pages of the index files are written, or logged, once per statement */
+	if (DB_ERROR(wal_commit(&lsn)) && DB_SUCCESS(res)) {
+		res = DB_STORAGE_ERROR;
+	}
+	db_unlock();
+
+	/* Statements which other tasks commit meanwhile are synced together */
+	if (DB_ERROR(wal_sync(lsn)) && DB_SUCCESS(res)) {
+		res = DB_STORAGE_ERROR;
+	}
+
+	return res;
+}
+
+db_result_t db_insert_batch(char *relation_name, db_column_t *columns, uint8_t column_count, uint32_t row_count)
+{
+	relation_t *rel;
+	db_result_t res;
+	wal_lsn_t lsn;
+
+	if (relation_name == NULL || columns == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	db_lock();
+	rel = relation_load(relation_name);
+	if (rel == NULL) {
+		DB_LOG_E("DB : get relation Failed\n");
+		res = DB_RELATIONAL_ERROR;
+	} else {
+		res = relation_insert_batch(rel, columns, column_count, row_count);
+		relation_release(rel);
+	}
+	if (DB_ERROR(wal_commit(&lsn)) && DB_SUCCESS(res)) {
+		res = DB_STORAGE_ERROR;
+	}
+	db_unlock();
+
+	if (DB_ERROR(wal_sync(lsn)) && DB_SUCCESS(res)) {
+		res = DB_STORAGE_ERROR;
+	}
+
+	return res;
+}
+
+/* The database is locked for the whole query. */
+db_cursor_t *db_query(char *format)
+{
+	db_cursor_t *cursor;
+	wal_lsn_t lsn;
+
+	db_lock();
+	cursor = aql_query(format, false);
+	wal_commit(&lsn);
+	db_unlock();
+
+	return cursor;
+}
+
+db_cursor_t *db_query_stream(char *format)
+{
+	db_cursor_t *cursor;
+
+	db_lock();
+	cursor = aql_query(format, true);
+	db_unlock();
+
+	return cursor;
+}
+
+db_stmt_t *db_prepare(char *format)
+{
+	db_stmt_t *stmt;
+
+	if (format == NULL) {
+		return NULL;
+	}
+
+	stmt = (db_stmt_t *)malloc(sizeof(db_stmt_t));
+	if (stmt == NULL) {
+		return NULL;
+	}
+	memset(stmt, 0, sizeof(db_stmt_t));
+
+	db_lock();
+	stmt->statement = aql_statement_get(format);
+	db_unlock();
+
+	if (stmt->statement == NULL) {
+		DB_LOG_E("DB : Parsing Error in db_prepare\n");
+		free(stmt);
+		return NULL;
+	}
+
+	return stmt;
+}
+
+static attribute_value_t *db_bind_value(db_stmt_t *stmt, uint8_t index)
+{
+	if (stmt == NULL || index >= AQL_PARAMETER_COUNT(&stmt->statement->adt)) {
+		return NULL;
+	}
+	return &stmt->values[index];
+}
+
+db_result_t db_bind_int(db_stmt_t *stmt, uint8_t index, int value)
+{
+	attribute_value_t *bound;
+
+	bound = db_bind_value(stmt, index);
+	if (bound == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+	/* Integer literals of a query are parsed as DOMAIN_INT longs too. */
+	VALUE_LONG(bound) = value;
+	bound->domain = DOMAIN_INT;
+
+	return DB_OK;
+}
+
+db_result_t db_bind_long(db_stmt_t *stmt, uint8_t index, long value)
+{
+	attribute_value_t *bound;
+
+	bound = db_bind_value(stmt, index);
+	if (bound == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+	VALUE_LONG(bound) = value;
+	bound->domain = DOMAIN_LONG;
+
+	return DB_OK;
+}
+
+db_result_t db_bind_string(db_stmt_t *stmt, uint8_t index, const char *value)
+{
+	attribute_value_t *bound;
+	size_t length;
+
+	bound = db_bind_value(stmt, index);
+	if (bound == NULL || value == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+	length = strlen(value);
+	if (length >= sizeof(value_t)) {
+		return DB_LIMIT_ERROR;
+	}
+	memcpy(stmt->strings[index], value, length + 1);
+	VALUE_STRING(bound) = (unsigned char *)stmt->strings[index];
+	bound->domain = DOMAIN_STRING;
+
+	return DB_OK;
+}
+
+/* The bound values are kept, so a step can rebind some of them only. */
+db_result_t db_step(db_stmt_t *stmt, db_cursor_t **cursor)
+{
+	db_result_t res;
+	aql_adt_t adt;
+	uint32_t optype;
+	wal_lsn_t lsn;
+
+	if (stmt == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+	optype = AQL_GET_OP_TYPE(AQL_GET_TYPE(&stmt->statement->adt));
+	if (AQL_GET_FLAGS(&stmt->statement->adt) & AQL_FLAG_EXPLAIN) {
+		/* The plan is printed as by db_exec(). */
+		optype = AQL_OP_TYPE_EXEC;
+	}
+	if (optype == AQL_OP_TYPE_QUERY && cursor == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	db_lock();
+	res = aql_bind(stmt, &adt);
+	if (DB_SUCCESS(res)) {
+		if (optype == AQL_OP_TYPE_QUERY) {
+			*cursor = aql_query_adt(&adt, false);
+			if (*cursor == NULL) {
+				res = DB_RELATIONAL_ERROR;
+			}
+		} else {
+			res = aql_exec_adt(&adt);
+		}
+	}
+	if (DB_ERROR(wal_commit(&lsn)) && DB_SUCCESS(res)) {
+		res = DB_STORAGE_ERROR;
+	}
+	db_unlock();
+
+	if (DB_ERROR(wal_sync(lsn)) && DB_SUCCESS(res)) {
+		res = DB_STORAGE_ERROR;
+	}
+
+	return res;
+}
+
+db_result_t db_finalize(db_stmt_t *stmt)
+{
+	if (stmt == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	db_lock();
+	aql_statement_put(stmt->statement);
+	db_unlock();
+	free(stmt);
+
+	return DB_OK;
+}
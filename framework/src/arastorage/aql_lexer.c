@@ -86,8 +86,9 @@ static const struct keyword keywords[] = {
 	{"*", MUL},
 	{"/", DIV},
 	{"#", COMMENT},
+	{"?", PARAMETER},
 
-	{">=", GEQ},				/* 13 */
+	{">=", GEQ},				/* 14 */
 	{"<=", LEQ},
 	{"<>", NOT_EQUAL},
 	{"<-", ASSIGN},
@@ -95,27 +96,32 @@ static const struct keyword keywords[] = {
 	{"IS", IS},
 	{"ON", ON},
 	{"IN", IN},
+	{"BY", BY},
 
-	{"ALL", ALL},				/* 21 */
+	{"ALL", ALL},				/* 23 */
 	{"AND", AND},
 	{"NOT", NOT},
 	{"SUM", SUM},
 	{"MAX", MAX},
 	{"MIN", MIN},
 	{"INT", INT},
+	{"ASC", ASC},
 
-	{"INTO", INTO},				/* 28 */
+	{"INTO", INTO},				/* 31 */
 	{"FROM", FROM},
 	{"MEAN", MEAN},
 	{"JOIN", JOIN},
 	{"LONG", LONG},
 	{"TYPE", TYPE},
+	{"DESC", DESC},
 
-	{"WHERE", WHERE},			/* 34 */
+	{"WHERE", WHERE},			/* 38 */
 	{"COUNT", COUNT},
 	{"INDEX", INDEX},
+	{"LIMIT", LIMIT},
+	{"ORDER", ORDER},
 
-	{"INSERT", INSERT},			/* 37 */
+	{"INSERT", INSERT},			/* 43 */
 	{"SELECT", SELECT},
 	{"REMOVE", REMOVE},
 	{"CREATE", CREATE},
@@ -125,16 +131,18 @@ static const struct keyword keywords[] = {
 	{"INLINE", INLINE},
 	{"REMAIN", REMAIN},
 
-	{"PROJECT", PROJECT},		/* 46 */
+	{"PROJECT", PROJECT},		/* 52 */
+	{"BETWEEN", BETWEEN},
+	{"EXPLAIN", EXPLAIN},
 
-	{"RELATION", RELATION},		/* 47 */
+	{"RELATION", RELATION},		/* 55 */
 
-	{"ATTRIBUTE", ATTRIBUTE},	/* 48 */
+	{"ATTRIBUTE", ATTRIBUTE},	/* 56 */
 	{"BPLUSTREE", BPLUSTREE}
 };
 
 /* Provides a pointer to the first keyword of a specific length. */
-static const int8_t skip_hint[] = { 0, 13, 21, 28, 34, 37, 46, 47, 48 };
+static const int8_t skip_hint[] = { 0, 14, 23, 31, 38, 43, 52, 55, 56 };
 
 static char separators[] = "#.;,() \t\n";
 
@@ -260,6 +260,11 @@ PARSER(values)
 	case INTEGER_VALUE:
 		AQL_ADD_VALUE(adt, DOMAIN_INT, VALUE);
 		break;
+	case PARAMETER:
+		if (DB_ERROR(AQL_ADD_PARAMETER(adt, 1))) {
+			RETURN(SYNTAX_ERROR);
+		}
+		break;
 	default:
 		RETURN(SYNTAX_ERROR);
 	}
@@ -288,12 +293,20 @@ PARSER(operand)
 		AQL_ADD_PROCESSING_ATTRIBUTE(adt, VALUE);
 		break;
 	case STRING_VALUE:
+		lvm_set_string(p, VALUE);
 		break;
 	case FLOAT_VALUE:
 		break;
 	case INTEGER_VALUE:
 		lvm_set_long(p, *(long *)lexer->value);
 		break;
+	case PARAMETER:
+		/* The bound value replaces the parameter when the statement is run */
+		lvm_set_parameter(p, AQL_PARAMETER_COUNT(adt));
+		if (DB_ERROR(AQL_ADD_PARAMETER(adt, 0))) {
+			RETURN(SYNTAX_ERROR);
+		}
+		break;
 	default:
 		RETURN(SYNTAX_ERROR);
 	}
@@ -367,6 +380,8 @@ PARSER(comparison)
 {
 	token_t token;
 	size_t saved_end;
+	size_t start;
+	size_t left_start;
 	operator_t rel;
 	lvm_instance_t *p;
 
@@ -381,6 +396,35 @@ PARSER(comparison)
 	saved_end = lvm_set_end(p, saved_end);
 
 	token = PARSE_TOKEN(cmp);
+	if (token == NONE && TOKEN == BETWEEN) {
+		/* "x BETWEEN a AND b" is compiled as "x >= a AND x <= b". The slot
+		   reserved for the relation takes the first comparison, and the
+		   connective is inserted in front of it when both are complete. */
+		start = lvm_get_end(p);
+		lvm_set_relation(p, LVM_GEQ);
+		left_start = lvm_get_end(p);
+		lvm_set_end(p, saved_end);
+
+		if (!PARSE(expr)) {
+			RETURN(SYNTAX_ERROR);
+		}
+
+		CONSUME(AND);
+
+		lvm_set_relation(p, LVM_LEQ);
+		lvm_copy_code(p, left_start, saved_end);
+
+		if (!PARSE(expr)) {
+			RETURN(SYNTAX_ERROR);
+		}
+
+		saved_end = lvm_shift_for_operator(p, start);
+		lvm_set_relation(p, LVM_AND);
+		lvm_set_end(p, saved_end);
+
+		RETURN(STATUS_OK);
+	}
+
 	if (token == NONE) {
 		RETURN(SYNTAX_ERROR);
 	}
@@ -465,9 +509,70 @@ PARSER(where)
 
 	lvm_print_code(p);
 
+	if (p->error != 0) {
+		/* The predicate does not fit in the bytecode of the LVM. */
+		RETURN(SYNTAX_ERROR);
+	}
+
 	return STATUS_OK;
 }
 
+PARSER(limit)
+{
+	long rows;
+
+	CONSUME(INTEGER_VALUE);
+	memcpy(&rows, VALUE, sizeof(rows));
+	if (rows <= 0) {
+		RETURN(SYNTAX_ERROR);
+	}
+	AQL_SET_LIMIT(adt, (tuple_id_t)rows);
+
+	return STATUS_OK;
+}
+
+/* An equi-join of the relation in FROM with a second relation. */
+PARSER(join)
+{
+	value_t left;
+
+	if (AQL_RELATION_COUNT(adt) != 1) {
+		RETURN(SYNTAX_ERROR);
+	}
+
+	CONSUME(IDENTIFIER);
+	AQL_ADD_RELATION(adt, VALUE);
+
+	CONSUME(ON);
+	CONSUME(IDENTIFIER);
+	memcpy(left, VALUE, sizeof(left));
+	CONSUME(EQUAL);
+	CONSUME(IDENTIFIER);
+	if (DB_ERROR(AQL_SET_JOIN(adt, left, VALUE))) {
+		RETURN(SYNTAX_ERROR);
+	}
+
+	RETURN(STATUS_OK);
+}
+
+PARSER(order)
+{
+	CONSUME(BY);
+	CONSUME(IDENTIFIER);
+	if (DB_ERROR(AQL_SET_ORDER(adt, VALUE))) {
+		RETURN(SYNTAX_ERROR);
+	}
+
+	NEXT;
+	if (TOKEN == DESC) {
+		AQL_SET_FLAG(adt, AQL_FLAG_DESCENDING);
+	} else if (TOKEN != ASC) {
+		REWIND;
+	}
+
+	RETURN(STATUS_OK);
+}
+
 PARSER(select)
 {
 	lvm_instance_t *lvm;
@@ -492,6 +597,13 @@ PARSER(select)
 	}
 
 	NEXT;
+	if (TOKEN == JOIN) {
+		if (!PARSE(join)) {
+			RETURN(SYNTAX_ERROR);
+		}
+		NEXT;
+	}
+
 	if (TOKEN == WHERE) {
 		lvm = (lvm_instance_t *)malloc(sizeof(lvm_instance_t));
 		if (lvm == NULL) {
@@ -507,9 +619,29 @@ PARSER(select)
 			AQL_SET_CONDITION(adt, NULL);
 			RETURN(SYNTAX_ERROR);
 		}
+		NEXT;
+	}
+
+	if (TOKEN == ORDER) {
+		if (!PARSE(order)) {
+			free(adt->lvm_instance);
+			AQL_SET_CONDITION(adt, NULL);
+			RETURN(SYNTAX_ERROR);
+		}
+		NEXT;
+	}
+
+	if (TOKEN == LIMIT) {
+		if (!PARSE(limit)) {
+			free(adt->lvm_instance);
+			AQL_SET_CONDITION(adt, NULL);
+			RETURN(SYNTAX_ERROR);
+		}
 	} else {
 		REWIND;
-		RETURN(STATUS_OK);
+		if (adt->lvm_instance == NULL) {
+			RETURN(STATUS_OK);
+		}
 	}
 
 	CONSUME(END);
@@ -621,6 +753,7 @@ PARSER(remove_from)
 
 	if (!PARSE(where)) {
 		free(lvm);
+		AQL_SET_CONDITION(adt, NULL);
 		RETURN(SYNTAX_ERROR);
 	}
 
@@ -708,10 +841,32 @@ PARSER(create_index)
 	AQL_ADD_RELATION(adt, VALUE);
 
 	CONSUME(DOT);
-	CONSUME(IDENTIFIER);
 
-	DB_LOG_V("Creating an index for the attribute %s\n", VALUE);
-	AQL_ADD_ATTRIBUTE(adt, VALUE, DOMAIN_UNSPECIFIED, 0);
+	NEXT;
+	if (TOKEN == LEFT_PAREN) {
+		/* A composite key: rel.(attr1, attr2, ...) */
+		for (;;) {
+			CONSUME(IDENTIFIER);
+
+			DB_LOG_V("Creating an index for the attribute %s\n", VALUE);
+			if (AQL_ATTRIBUTE_COUNT(adt) == DB_MAX_INDEX_KEY_ATTRIBUTES) {
+				RETURN(SYNTAX_ERROR);
+			}
+			AQL_ADD_ATTRIBUTE(adt, VALUE, DOMAIN_UNSPECIFIED, 0);
+
+			NEXT;
+			if (TOKEN == RIGHT_PAREN) {
+				break;
+			} else if (TOKEN != COMMA) {
+				RETURN(SYNTAX_ERROR);
+			}
+		}
+	} else if (TOKEN == IDENTIFIER) {
+		DB_LOG_V("Creating an index for the attribute %s\n", VALUE);
+		AQL_ADD_ATTRIBUTE(adt, VALUE, DOMAIN_UNSPECIFIED, 0);
+	} else {
+		RETURN(SYNTAX_ERROR);
+	}
 
 	CONSUME(TYPE);
 
@@ -898,6 +1053,14 @@ aql_status_t aql_parse(aql_adt_t *adt, char *input_string)
 		case SELECT:
 			result = parse_select(adt, &lex);
 			break;
+		case EXPLAIN:
+			if (AQL_ERROR(lexer_next(&lex)) || *lex.token != SELECT) {
+				result = SYNTAX_ERROR;
+				break;
+			}
+			result = parse_select(adt, &lex);
+			AQL_SET_FLAG(adt, AQL_FLAG_EXPLAIN);
+			break;
 		case REMAIN:
 			result = parse_remain(adt, &lex);
 
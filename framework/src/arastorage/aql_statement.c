@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <stdlib.h>
+#include <string.h>
+#include "db_options.h"
+#include "db_debug.h"
+#include "list.h"
+#include "aql.h"
+
+/****************************************************************************
+* Private Data
+****************************************************************************/
+/* The cached statements, the most recently used first. The list is
+ * protected by the database lock. */
+LIST(statements);
+static int g_statement_count;
+
+/****************************************************************************
+* Private Functions
+****************************************************************************/
+static void statement_free(aql_statement_t *statement)
+{
+	aql_free(&statement->adt);
+	free(statement->query);
+	free(statement);
+}
+
+/* Removes the least recently used statement which is not in use. */
+static int statement_evict(void)
+{
+	aql_statement_t *statement;
+	aql_statement_t *victim;
+
+	victim = NULL;
+	for (statement = list_head(statements); statement != NULL; statement = statement->next) {
+		if (statement->users == 0) {
+			victim = statement;
+		}
+	}
+	if (victim == NULL) {
+		return 0;
+	}
+
+	DB_LOG_D("DB: Evicting the compiled statement \"%s\"\n", victim->query);
+	list_remove(statements, victim);
+	g_statement_count--;
+	statement_free(victim);
+	return 1;
+}
+
+/****************************************************************************
+* Public Functions
+****************************************************************************/
+db_result_t aql_statement_init(void)
+{
+	list_init(statements);
+	g_statement_count = 0;
+	return DB_OK;
+}
+
+void aql_statement_deinit(void)
+{
+	aql_statement_t *statement;
+
+	while ((statement = list_pop(statements)) != NULL) {
+		if (statement->users == 0) {
+			statement_free(statement);
+		} else {
+			/* The last aql_statement_put() frees it. */
+			statement->cached = 0;
+		}
+	}
+	g_statement_count = 0;
+}
+
+/*
+ * Returns the compiled statement of a query, which is parsed only if it
+ * is not in the cache. The statement is used until aql_statement_put().
+ */
+aql_statement_t *aql_statement_get(char *query)
+{
+	aql_statement_t *statement;
+	size_t length;
+
+	for (statement = list_head(statements); statement != NULL; statement = statement->next) {
+		if (strcmp(statement->query, query) == 0) {
+			list_remove(statements, statement);
+			list_push(statements, statement);
+			statement->users++;
+			return statement;
+		}
+	}
+
+	statement = (aql_statement_t *)malloc(sizeof(aql_statement_t));
+	if (statement == NULL) {
+		return NULL;
+	}
+	memset(statement, 0, sizeof(aql_statement_t));
+
+	length = strlen(query) + 1;
+	statement->query = (char *)malloc(length);
+	if (statement->query == NULL) {
+		free(statement);
+		return NULL;
+	}
+	memcpy(statement->query, query, length);
+
+	if (AQL_ERROR(aql_parse(&statement->adt, query))) {
+		DB_LOG_E("DB: Failed to compile \"%s\"\n", query);
+		statement_free(statement);
+		return NULL;
+	}
+	statement->users = 1;
+
+	/* When every cached statement is in use, the new one is not cached. */
+	if (DB_QUERY_CACHE_SIZE > 0 && (g_statement_count < DB_QUERY_CACHE_SIZE || statement_evict())) {
+		list_push(statements, statement);
+		statement->cached = 1;
+		g_statement_count++;
+	}
+
+	return statement;
+}
+
+void aql_statement_put(aql_statement_t *statement)
+{
+	statement->users--;
+	if (statement->users == 0 && !statement->cached) {
+		statement_free(statement);
+	}
+}
@@ -66,6 +66,9 @@
 #include "db_debug.h"
 #include "result.h"
 #include "aql.h"
+#include "rw_locks.h"
+#include "buffer_pool.h"
+#include "wal.h"
 #include <arastorage/arastorage.h>
 
 /****************************************************************************
@@ -74,30 +77,52 @@
 db_result_t db_init(void)
 {
 	db_result_t res;
+	db_lock();
+	res = buffer_pool_init();
+	if (res != DB_OK) {
+		goto errout;
+	}
 	res = relation_init();
 	if (res != DB_OK) {
-		return res;
+		goto errout;
 	}
 	res = index_init();
 	if (res != DB_OK) {
-		return res;
+		goto errout;
+	}
+	res = aql_statement_init();
+	if (res != DB_OK) {
+		goto errout;
 	}
 #ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
 	res = storage_write_buffer_init();
 	if (res != DB_OK) {
-		return res;
+		goto errout;
 	}
 #endif
+	/* Statements which committed before a crash are redone */
+	res = wal_init();
+errout:
+	db_unlock();
 	return res;
 }
 
 db_result_t db_deinit()
 {
+	/* The checkpointer takes the database lock */
+	wal_stop();
+	db_lock();
+	/* The rows in the insert buffer are logged, and written here */
+	wal_deinit();
 #ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
 	storage_write_buffer_deinit();
 #endif
+	aql_statement_deinit();
 	relation_deinit();
 	index_deinit();
+	buffer_pool_flush(NULL);
+	buffer_pool_deinit();
+	db_unlock();
 	return DB_OK;
 }
 
@@ -167,9 +192,39 @@ db_result_t db_print_header(db_cursor_t *cursor)
 
 db_result_t db_cursor_free(db_cursor_t *cursor)
 {
-	return cursor_deinit(cursor);
+	db_result_t res;
+
+	/* Freeing the cursor unpins the relation of its snapshot. */
+	db_lock();
+	res = cursor_deinit(cursor);
+	db_unlock();
+
+	return res;
+}
+
+#ifdef CONFIG_ARASTORAGE_BUFFER_POOL
+db_result_t db_get_buffer_pool_stats(db_buffer_pool_stats_t *stats)
+{
+	if (stats == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	buffer_pool_get_stats(stats);
+	return DB_OK;
 }
+#endif
 
+#ifdef CONFIG_ARASTORAGE_WAL
+db_result_t db_get_wal_stats(db_wal_stats_t *stats)
+{
+	if (stats == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	wal_get_stats(stats);
+	return DB_OK;
+}
+#endif
 
 /* Print tuple value */
 db_result_t db_print_tuple(db_cursor_t *cursor)
@@ -255,3 +310,83 @@ db_result_t db_print_value(db_cursor_t *cursor, int attr_index)
 	output("\n");
 	return DB_OK;
 }
+
+/* Print the access paths considered for a query by EXPLAIN; the chosen one is marked with '*' */
+db_result_t db_print_plan(db_handle_t *handle)
+{
+	db_plan_t *plan;
+	index_stats_t *stats;
+	tuple_id_t cardinality;
+	uint8_t i;
+	uint8_t j;
+
+	if (handle == NULL || handle->rel == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	cardinality = relation_cardinality(handle->rel);
+	if (cardinality == INVALID_TUPLE) {
+		return DB_STORAGE_ERROR;
+	}
+
+	output("[relation = %s, rows = %lu]\n", handle->rel->name, (unsigned long)cardinality);
+	if (handle->plan_count == 0) {
+		/* Without a condition on an indexed attribute, there is no choice. */
+		output("* full scan: rows = %lu\n", (unsigned long)cardinality);
+		return DB_OK;
+	}
+
+	for (i = 0; i < handle->plan_count; i++) {
+		plan = &handle->plans[i];
+		output("%c ", plan->chosen ? '*' : ' ');
+		if (plan->index == NULL) {
+			output("full scan");
+		} else {
+			output("%s on %s", plan->index->type == INDEX_INLINE ? "INLINE binary search" : "BPLUSTREE range scan", plan->index->attr->name);
+			for (j = 1; j < plan->index->key_count; j++) {
+				output(", %s", plan->index->key_attributes[j - 1]);
+			}
+			output(" for keys %ld to %ld%s", plan->min, plan->max, plan->index_only ? ", index only" : "");
+		}
+		output(": rows = %lu, cost = %lu\n", (unsigned long)plan->rows, plan->cost);
+
+		if (plan->index != NULL) {
+			stats = index_get_stats(plan->index);
+			if (stats != NULL && stats->rows > 0) {
+				output("    index keys = %lu, distinct = %lu, min = %ld, max = %ld\n", (unsigned long)stats->rows, (unsigned long)stats->distinct, stats->min, stats->max);
+			}
+		}
+	}
+	return DB_OK;
+}
+
+/* Print how EXPLAIN joins two relations, of which the smaller one is hashed */
+db_result_t db_print_join_plan(db_join_plan_t *plan, char *left, char *right)
+{
+	if (plan == NULL || plan->build == NULL || plan->probe == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	output("* HASH JOIN on %s = %s: build = %s (rows = %lu), probe = %s (rows = %lu)\n", left, right, plan->build->name, (unsigned long)plan->build_rows, plan->probe->name, (unsigned long)plan->probe_rows);
+	if (plan->partitions > 1) {
+		output("    record = %u bytes, memory = %u bytes, partitions = %u\n", plan->record_length, DB_JOIN_MEMORY, plan->partitions);
+	} else {
+		output("    record = %u bytes, memory = %u bytes, in memory\n", plan->record_length, DB_JOIN_MEMORY);
+	}
+	return DB_OK;
+}
+
+/* Print how EXPLAIN sorts the selected rows of a query */
+db_result_t db_print_sort_plan(char *attribute, int descending, tuple_id_t limit)
+{
+	if (attribute == NULL) {
+		return DB_ARGUMENT_ERROR;
+	}
+
+	output("* SORT on %s %s: memory = %u bytes, fan-in = %u", attribute, descending ? "DESC" : "ASC", DB_SORT_MEMORY, DB_SORT_FANIN);
+	if (limit > 0) {
+		output(", first rows = %lu", (unsigned long)limit);
+	}
+	output("\n");
+	return DB_OK;
+}
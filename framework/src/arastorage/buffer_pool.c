@@ -0,0 +1,500 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include "db_options.h"
+#include "db_debug.h"
+#include "storage.h"
+#include "buffer_pool.h"
+#include "wal.h"
+
+/****************************************************************************
+* Pre-processor Definitions
+****************************************************************************/
+#define BUFFER_PAGES CONFIG_ARASTORAGE_BUFFER_POOL_PAGES
+#define BUFFER_PAGE_SIZE CONFIG_ARASTORAGE_BUFFER_POOL_PAGE_SIZE
+
+#define FRAME_VALID      0x01
+#define FRAME_REFERENCED 0x02
+
+#define FRAME_IS_DIRTY(frame) ((frame)->dirty_start < (frame)->dirty_end)
+
+/****************************************************************************
+* Private Types
+****************************************************************************/
+struct buffer_frame_s {
+	char file_name[DB_MAX_FILENAME_LENGTH];
+	unsigned long page;
+	uint16_t length;			/* bytes of the page which are in the file */
+	uint16_t dirty_start;		/* modified bytes are [dirty_start, dirty_end) */
+	uint16_t dirty_end;
+#ifdef CONFIG_ARASTORAGE_WAL
+	uint16_t log_start;			/* bytes which are not logged are [log_start, log_end) */
+	uint16_t log_end;
+	wal_lsn_t lsn;				/* the log is synced up to lsn before the page is written */
+#endif
+	uint8_t flags;
+	unsigned char *data;
+};
+
+/****************************************************************************
+* Private Data
+****************************************************************************/
+static struct buffer_frame_s g_frames[BUFFER_PAGES];
+static unsigned char *g_pages;
+static int g_clock_hand;
+static db_buffer_pool_stats_t g_stats;
+
+/* Cursors read their snapshots without the database lock, so the pool has
+ * a lock of its own. */
+static pthread_mutex_t g_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+* Private Functions
+****************************************************************************/
+static struct buffer_frame_s *buffer_find(const char *filename, unsigned long page)
+{
+	int i;
+
+	for (i = 0; i < BUFFER_PAGES; i++) {
+		if ((g_frames[i].flags & FRAME_VALID) && g_frames[i].page == page && strncmp(g_frames[i].file_name, filename, DB_MAX_FILENAME_LENGTH) == 0) {
+			return &g_frames[i];
+		}
+	}
+	return NULL;
+}
+
+#ifdef CONFIG_ARASTORAGE_WAL
+/* A page is written to its file only after the log which holds it.  Bytes
+ * of the running statement which are not logged yet are logged with the
+ * bytes they replace, which recovery restores if the statement does not
+ * commit. */
+static db_result_t buffer_log_page(struct buffer_frame_s *frame, db_storage_id_t fd)
+{
+	unsigned long offset;
+	unsigned length;
+	unsigned char *old;
+	ssize_t r;
+
+	if (frame->log_start < frame->log_end) {
+		offset = frame->page * BUFFER_PAGE_SIZE + frame->log_start;
+		length = frame->log_end - frame->log_start;
+		old = (unsigned char *)malloc(length);
+		if (old == NULL) {
+			return DB_ALLOCATION_ERROR;
+		}
+		/* Bytes past the end of the file have nothing to restore */
+		r = 0;
+		if (storage_seek(fd, offset, SEEK_SET) != (off_t)-1) {
+			r = storage_read(fd, old, length);
+		}
+		if (r > 0 && DB_ERROR(wal_log(WAL_RECORD_UNDO, frame->file_name, offset, old, r, &frame->lsn))) {
+			free(old);
+			return DB_STORAGE_ERROR;
+		}
+		free(old);
+		if (DB_ERROR(wal_log(WAL_RECORD_WRITE, frame->file_name, offset, frame->data + frame->log_start, length, &frame->lsn))) {
+			return DB_STORAGE_ERROR;
+		}
+		frame->log_start = frame->log_end = 0;
+	}
+	return wal_sync(frame->lsn);
+}
+#endif
+
+/* Write all modified pages of a file through one descriptor */
+static db_result_t buffer_write_back(const char *filename)
+{
+	db_storage_id_t fd;
+	db_result_t res = DB_OK;
+	struct buffer_frame_s *frame;
+	int i;
+
+	fd = storage_open(filename, O_RDWR);
+	if (fd < 0) {
+		DB_LOG_E("DB: Failed to open %s to write back pages\n", filename);
+		return DB_STORAGE_ERROR;
+	}
+
+	for (i = 0; i < BUFFER_PAGES; i++) {
+		frame = &g_frames[i];
+		if (!(frame->flags & FRAME_VALID) || !FRAME_IS_DIRTY(frame) || strncmp(frame->file_name, filename, DB_MAX_FILENAME_LENGTH) != 0) {
+			continue;
+		}
+#ifdef CONFIG_ARASTORAGE_WAL
+		if (DB_ERROR(buffer_log_page(frame, fd))) {
+			DB_LOG_E("DB: Failed to log page %lu of %s\n", frame->page, filename);
+			res = DB_STORAGE_ERROR;
+			continue;
+		}
+#endif
+		if (DB_ERROR(storage_write_to(fd, frame->data + frame->dirty_start, frame->page * BUFFER_PAGE_SIZE + frame->dirty_start, frame->dirty_end - frame->dirty_start))) {
+			DB_LOG_E("DB: Failed to write back page %lu of %s\n", frame->page, filename);
+			res = DB_STORAGE_ERROR;
+			continue;
+		}
+		frame->dirty_start = frame->dirty_end = 0;
+		g_stats.writebacks++;
+	}
+
+#ifdef CONFIG_ARASTORAGE_WAL
+	/* A checkpoint empties the log once the pages are on storage */
+	storage_sync(fd);
+#endif
+	storage_close(fd);
+	return res;
+}
+
+/* Pick a frame for a new page with the clock algorithm.  A referenced page
+ * gets a second chance, a modified page is written back before it is reused. */
+static struct buffer_frame_s *buffer_victim(void)
+{
+	struct buffer_frame_s *frame;
+	char filename[DB_MAX_FILENAME_LENGTH];
+	int i;
+
+	for (i = 0; i < 2 * BUFFER_PAGES; i++) {
+		frame = &g_frames[g_clock_hand];
+		g_clock_hand = (g_clock_hand + 1) % BUFFER_PAGES;
+
+		if (!(frame->flags & FRAME_VALID)) {
+			return frame;
+		}
+		if (frame->flags & FRAME_REFERENCED) {
+			frame->flags &= ~FRAME_REFERENCED;
+			continue;
+		}
+		if (FRAME_IS_DIRTY(frame)) {
+			memcpy(filename, frame->file_name, sizeof(filename));
+			if (DB_ERROR(buffer_write_back(filename))) {
+				continue;
+			}
+		}
+		g_stats.evictions++;
+		frame->flags = 0;
+		return frame;
+	}
+
+	DB_LOG_E("DB: No page can be evicted from the buffer pool\n");
+	return NULL;
+}
+
+static void buffer_assign(struct buffer_frame_s *frame, const char *filename, unsigned long page)
+{
+	strncpy(frame->file_name, filename, DB_MAX_FILENAME_LENGTH - 1);
+	frame->file_name[DB_MAX_FILENAME_LENGTH - 1] = '\0';
+	frame->page = page;
+	frame->length = 0;
+	frame->dirty_start = frame->dirty_end = 0;
+#ifdef CONFIG_ARASTORAGE_WAL
+	frame->log_start = frame->log_end = 0;
+#endif
+	frame->flags = FRAME_VALID | FRAME_REFERENCED;
+}
+
+/* Read the page from the file.  Bytes which are modified in memory are kept. */
+static db_result_t buffer_load(struct buffer_frame_s *frame, db_storage_id_t fd)
+{
+	ssize_t r;
+	unsigned length = 0;
+
+	if (FRAME_IS_DIRTY(frame) && DB_ERROR(buffer_write_back(frame->file_name))) {
+		return DB_STORAGE_ERROR;
+	}
+
+	if (storage_seek(fd, frame->page * BUFFER_PAGE_SIZE, SEEK_SET) == (off_t)-1) {
+		return DB_STORAGE_ERROR;
+	}
+
+	while (length < BUFFER_PAGE_SIZE) {
+		r = storage_read(fd, frame->data + length, BUFFER_PAGE_SIZE - length);
+		if (r < 0) {
+			return DB_STORAGE_ERROR;
+		} else if (r == 0) {
+			break;
+		}
+		length += r;
+	}
+
+	frame->length = length;
+	g_stats.misses++;
+	return DB_OK;
+}
+
+/****************************************************************************
+* Public Functions
+****************************************************************************/
+db_result_t buffer_pool_init(void)
+{
+	int i;
+
+	pthread_mutex_lock(&g_pool_lock);
+	if (g_pages == NULL) {
+		g_pages = (unsigned char *)malloc(BUFFER_PAGES * BUFFER_PAGE_SIZE);
+		if (g_pages == NULL) {
+			pthread_mutex_unlock(&g_pool_lock);
+			DB_LOG_E("DB: Failed to allocate the buffer pool\n");
+			return DB_ALLOCATION_ERROR;
+		}
+	}
+
+	memset(g_frames, 0, sizeof(g_frames));
+	for (i = 0; i < BUFFER_PAGES; i++) {
+		g_frames[i].data = g_pages + i * BUFFER_PAGE_SIZE;
+	}
+	g_clock_hand = 0;
+	memset(&g_stats, 0, sizeof(g_stats));
+	pthread_mutex_unlock(&g_pool_lock);
+
+	return DB_OK;
+}
+
+void buffer_pool_deinit(void)
+{
+	pthread_mutex_lock(&g_pool_lock);
+	memset(g_frames, 0, sizeof(g_frames));
+	if (g_pages != NULL) {
+		free(g_pages);
+		g_pages = NULL;
+	}
+	pthread_mutex_unlock(&g_pool_lock);
+}
+
+db_result_t buffer_pool_read(const char *filename, db_storage_id_t fd, void *buffer, unsigned long offset, unsigned length)
+{
+	struct buffer_frame_s *frame;
+	unsigned char *dest = (unsigned char *)buffer;
+	unsigned long page;
+	unsigned pos;
+	unsigned n;
+	db_result_t res = DB_OK;
+
+	pthread_mutex_lock(&g_pool_lock);
+	if (g_pages == NULL) {
+		pthread_mutex_unlock(&g_pool_lock);
+		return storage_read_from(fd, buffer, offset, length);
+	}
+
+	while (length > 0) {
+		page = offset / BUFFER_PAGE_SIZE;
+		pos = offset % BUFFER_PAGE_SIZE;
+		n = BUFFER_PAGE_SIZE - pos;
+		if (n > length) {
+			n = length;
+		}
+
+		frame = buffer_find(filename, page);
+		if (frame != NULL && pos + n <= frame->length) {
+			frame->flags |= FRAME_REFERENCED;
+			g_stats.hits++;
+		} else {
+			/* The page is not cached, or rows were appended to the file
+			 * after it was read. */
+			if (frame == NULL) {
+				frame = buffer_victim();
+				if (frame == NULL) {
+					res = DB_STORAGE_ERROR;
+					break;
+				}
+				buffer_assign(frame, filename, page);
+			}
+			if (DB_ERROR(buffer_load(frame, fd))) {
+				if (!FRAME_IS_DIRTY(frame)) {
+					frame->flags = 0;
+				}
+				res = DB_STORAGE_ERROR;
+				break;
+			}
+			if (pos + n > frame->length) {
+				res = DB_STORAGE_ERROR;
+				break;
+			}
+		}
+
+		memcpy(dest, frame->data + pos, n);
+		dest += n;
+		offset += n;
+		length -= n;
+	}
+
+	pthread_mutex_unlock(&g_pool_lock);
+	return res;
+}
+
+db_result_t buffer_pool_write(const char *filename, db_storage_id_t fd, void *buffer, unsigned long offset, unsigned length)
+{
+	struct buffer_frame_s *frame;
+	unsigned char *src = (unsigned char *)buffer;
+	unsigned long page;
+	unsigned pos;
+	unsigned n;
+	db_result_t res = DB_OK;
+
+	pthread_mutex_lock(&g_pool_lock);
+	if (g_pages == NULL) {
+		pthread_mutex_unlock(&g_pool_lock);
+		return storage_write_to(fd, buffer, offset, length);
+	}
+
+	while (length > 0) {
+		page = offset / BUFFER_PAGE_SIZE;
+		pos = offset % BUFFER_PAGE_SIZE;
+		n = BUFFER_PAGE_SIZE - pos;
+		if (n > length) {
+			n = length;
+		}
+
+		frame = buffer_find(filename, page);
+		if (frame != NULL) {
+			frame->flags |= FRAME_REFERENCED;
+			g_stats.hits++;
+		} else {
+			frame = buffer_victim();
+			if (frame == NULL) {
+				res = DB_STORAGE_ERROR;
+				break;
+			}
+			buffer_assign(frame, filename, page);
+			/* A page which is overwritten entirely need not be read */
+			if (n < BUFFER_PAGE_SIZE && DB_ERROR(buffer_load(frame, fd))) {
+				frame->flags = 0;
+				res = DB_STORAGE_ERROR;
+				break;
+			}
+		}
+
+		if (pos > frame->length) {
+			memset(frame->data + frame->length, 0, pos - frame->length);
+		}
+		memcpy(frame->data + pos, src, n);
+		if (pos + n > frame->length) {
+			frame->length = pos + n;
+		}
+		if (!FRAME_IS_DIRTY(frame)) {
+			frame->dirty_start = pos;
+			frame->dirty_end = pos + n;
+		} else {
+			if (pos < frame->dirty_start) {
+				frame->dirty_start = pos;
+			}
+			if (pos + n > frame->dirty_end) {
+				frame->dirty_end = pos + n;
+			}
+		}
+#ifdef CONFIG_ARASTORAGE_WAL
+		if (frame->log_start >= frame->log_end) {
+			frame->log_start = pos;
+			frame->log_end = pos + n;
+		} else {
+			if (pos < frame->log_start) {
+				frame->log_start = pos;
+			}
+			if (pos + n > frame->log_end) {
+				frame->log_end = pos + n;
+			}
+		}
+#endif
+
+		src += n;
+		offset += n;
+		length -= n;
+	}
+
+	pthread_mutex_unlock(&g_pool_lock);
+	return res;
+}
+
+db_result_t buffer_pool_flush(const char *filename)
+{
+	char name[DB_MAX_FILENAME_LENGTH];
+	db_result_t res = DB_OK;
+	int i;
+
+	pthread_mutex_lock(&g_pool_lock);
+	for (i = 0; i < BUFFER_PAGES; i++) {
+		if (!(g_frames[i].flags & FRAME_VALID) || !FRAME_IS_DIRTY(&g_frames[i])) {
+			continue;
+		}
+		if (filename != NULL && strncmp(g_frames[i].file_name, filename, DB_MAX_FILENAME_LENGTH) != 0) {
+			continue;
+		}
+		memcpy(name, g_frames[i].file_name, sizeof(name));
+		if (DB_ERROR(buffer_write_back(name))) {
+			res = DB_STORAGE_ERROR;
+		}
+	}
+	pthread_mutex_unlock(&g_pool_lock);
+
+	return res;
+}
+
+#ifdef CONFIG_ARASTORAGE_WAL
+db_result_t buffer_pool_log(void)
+{
+	struct buffer_frame_s *frame;
+	db_result_t res = DB_OK;
+	int i;
+
+	pthread_mutex_lock(&g_pool_lock);
+	for (i = 0; i < BUFFER_PAGES; i++) {
+		frame = &g_frames[i];
+		if (!(frame->flags & FRAME_VALID) || frame->log_start >= frame->log_end) {
+			continue;
+		}
+		if (DB_ERROR(wal_log(WAL_RECORD_WRITE, frame->file_name, frame->page * BUFFER_PAGE_SIZE + frame->log_start, frame->data + frame->log_start, frame->log_end - frame->log_start, &frame->lsn))) {
+			res = DB_STORAGE_ERROR;
+			break;
+		}
+		frame->log_start = frame->log_end = 0;
+	}
+	pthread_mutex_unlock(&g_pool_lock);
+
+	return res;
+}
+#endif
+
+void buffer_pool_invalidate(const char *filename)
+{
+	int i;
+
+	pthread_mutex_lock(&g_pool_lock);
+	for (i = 0; i < BUFFER_PAGES; i++) {
+		if ((g_frames[i].flags & FRAME_VALID) && strncmp(g_frames[i].file_name, filename, DB_MAX_FILENAME_LENGTH) == 0) {
+			g_frames[i].flags = 0;
+			g_frames[i].dirty_start = g_frames[i].dirty_end = 0;
+#ifdef CONFIG_ARASTORAGE_WAL
+			g_frames[i].log_start = g_frames[i].log_end = 0;
+#endif
+		}
+	}
+	pthread_mutex_unlock(&g_pool_lock);
+}
+
+void buffer_pool_get_stats(db_buffer_pool_stats_t *stats)
+{
+	pthread_mutex_lock(&g_pool_lock);
+	memcpy(stats, &g_stats, sizeof(*stats));
+	pthread_mutex_unlock(&g_pool_lock);
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/**
+ * \file
+ *      A page buffer pool shared by the tuple files and the index files.
+ *
+ *      Files are cached in fixed-size pages, identified by the name of the
+ *      file and the page number, so that a page read through one descriptor
+ *      is found again through any other descriptor of the same file.
+ *      Modified pages stay in memory until they are evicted or the pool is
+ *      flushed, which happens when each query completes, or with the
+ *      write-ahead log at checkpoints.
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <arastorage/arastorage.h>
+
+/****************************************************************************
+* Global Function Prototypes
+****************************************************************************/
+#ifdef CONFIG_ARASTORAGE_BUFFER_POOL
+db_result_t buffer_pool_init(void);
+void buffer_pool_deinit(void);
+
+/* Read or write len bytes at offset of the file.  fd is a descriptor of the
+ * file which the pool reads missing pages from.  A read fails unless all of
+ * the bytes are in the file. */
+db_result_t buffer_pool_read(const char *filename, db_storage_id_t fd, void *buffer, unsigned long offset, unsigned length);
+db_result_t buffer_pool_write(const char *filename, db_storage_id_t fd, void *buffer, unsigned long offset, unsigned length);
+
+/* Write the modified pages of a file, or of all files if filename is NULL */
+db_result_t buffer_pool_flush(const char *filename);
+
+#ifdef CONFIG_ARASTORAGE_WAL
+/* Log the bytes which were modified since they were last logged */
+db_result_t buffer_pool_log(void);
+#endif
+
+/* Drop the pages of a file which is removed or truncated, without writing them */
+void buffer_pool_invalidate(const char *filename);
+
+void buffer_pool_get_stats(db_buffer_pool_stats_t *stats);
+#else
+#define buffer_pool_init() DB_OK
+#define buffer_pool_deinit()
+#define buffer_pool_read(filename, fd, buffer, offset, length) storage_read_from(fd, buffer, offset, length)
+#define buffer_pool_write(filename, fd, buffer, offset, length) storage_write_to(fd, buffer, offset, length)
+#define buffer_pool_flush(filename) DB_OK
+#define buffer_pool_invalidate(filename)
+#endif
+
+#endif							/* BUFFER_POOL_H */
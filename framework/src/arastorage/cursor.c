@@ -27,16 +27,49 @@
 #include "result.h"
 #include "db_debug.h"
 #include "storage.h"
+#include "buffer_pool.h"
+#include "rw_locks.h"
 #include "memb.h"
 #include "relation.h"
+#include "aql.h"
 
 /****************************************************************************
 * Public Functions
 ****************************************************************************/
 
+/* A streaming cursor only moves forward, one row at a time. */
+static db_result_t cursor_stream_move_to(db_cursor_t *cursor, tuple_id_t row_id)
+{
+	db_result_t res;
+
+	if (cursor->cursor_rows > 0 && row_id == cursor->current_cursor_row) {
+		return DB_OK;
+	}
+
+	if (row_id != cursor->cursor_rows) {
+		DB_LOG_E("streaming cursor can not move back\n");
+		return DB_CURSOR_ERROR;
+	}
+
+	/* Each fetch step reads the shared relation, as db_query() does. */
+	db_lock();
+	res = relation_process_next(cursor);
+	db_unlock();
+	if (res != DB_OK) {
+		return DB_CURSOR_ERROR;
+	}
+
+	DB_LOG_D("set current cursor id = %d, storage id = %d\n", cursor->current_cursor_row, cursor->current_storage_row);
+	return DB_OK;
+}
+
 /* Update current cursor id and storage id. */
 db_result_t cursor_move_to(db_cursor_t *cursor, tuple_id_t row_id)
 {
+	if (cursor != NULL && IS_STREAM_CURSOR(cursor)) {
+		return cursor_stream_move_to(cursor, row_id);
+	}
+
 	if (IS_EMPTY_CURSOR(cursor)) {
 		DB_LOG_E("Empty Cursor\n");
 		return DB_CURSOR_ERROR;
@@ -77,18 +110,31 @@ db_result_t cursor_move_first(db_cursor_t *cursor)
 /* Search the last set tuple id and update storage id corresponding it. */
 db_result_t cursor_move_last(db_cursor_t *cursor)
 {
+	if (cursor == NULL) {
+		return DB_CURSOR_ERROR;
+	}
+	if (IS_STREAM_CURSOR(cursor)) {
+		/* The last row is not known before the scan ends. */
+		return DB_CURSOR_ERROR;
+	}
 	return cursor_move_to(cursor, cursor->cursor_rows - 1);
 }
 
 /* Search next set tuple id and update storage id corresponding it. */
 db_result_t cursor_move_next(db_cursor_t *cursor)
 {
+	if (cursor == NULL) {
+		return DB_CURSOR_ERROR;
+	}
 	return cursor_move_to(cursor, cursor->current_cursor_row + 1);
 }
 
 /* Search previous set tuple id and update storage id corresponding it. */
 db_result_t cursor_move_prev(db_cursor_t *cursor)
 {
+	if (cursor == NULL) {
+		return DB_CURSOR_ERROR;
+	}
 	return cursor_move_to(cursor, cursor->current_cursor_row - 1);
 }
 
@@ -113,6 +159,9 @@ bool cursor_is_first_row(db_cursor_t *cursor)
 	if (cursor->current_cursor_row != 0) {
 		return false;
 	}
+	if (IS_STREAM_CURSOR(cursor)) {
+		return cursor->cursor_rows > 0;
+	}
 	//check whether pointing storage row id is true
 	for (i = 0; i < cursor->total_rows; i++) {
 		index = GET_INDEX(i);
@@ -138,6 +187,10 @@ bool cursor_is_last_row(db_cursor_t *cursor)
 	if (cursor->current_cursor_row != cursor->cursor_rows - 1) {
 		return false;
 	}
+	if (IS_STREAM_CURSOR(cursor)) {
+		/* Known only once the scan has found no more rows. */
+		return cursor->cursor_rows > 0 && !db_processing_status(cursor->handle);
+	}
 	//check whether pointing storage row id is true
 	int i, index, pos;
 
@@ -162,6 +215,13 @@ db_result_t cursor_data_add(db_cursor_t *cursor, tuple_id_t tuple_id)
 		return DB_CURSOR_ERROR;
 	}
 
+	if (IS_STREAM_CURSOR(cursor)) {
+		/* A streaming cursor only keeps the row it is positioned on. */
+		cursor->current_storage_row = tuple_id;
+		cursor->current_cursor_row = cursor->cursor_rows++;
+		return DB_OK;
+	}
+
 	if (tuple_id >= DB_CURSOR_RESULT_ENTRY || tuple_id >= cursor->total_rows) {
 		DB_LOG_E("invalid tuple id error\n");
 		return DB_CURSOR_ERROR;
@@ -264,13 +324,20 @@ db_result_t cursor_get_value_storage(attribute_value_t *value, db_cursor_t *curs
 	} else {
 		/* Otherwise, Read tuple value from storage. */
 		offset = cursor->current_storage_row * cursor->storage_row_length + cursor->attr_map[col].offset;
-		fd = storage_open(cursor->name, O_RDONLY);
-		if (fd < 0) {
-			DB_LOG_E("failed to open storage %s\n", cursor->name);
-			return DB_CURSOR_ERROR;
+		if (cursor->rel != NULL) {
+			/* The snapshot keeps the tuple file open for the cursor. */
+			if (DB_ERROR(buffer_pool_read(cursor->snapshot.filename, cursor->snapshot.fd, buf, offset, attr.element_size))) {
+				return DB_CURSOR_ERROR;
+			}
+		} else {
+			fd = storage_open(cursor->name, O_RDONLY);
+			if (fd < 0) {
+				DB_LOG_E("failed to open storage %s\n", cursor->name);
+				return DB_CURSOR_ERROR;
+			}
+			buffer_pool_read(cursor->name, fd, buf, offset, attr.element_size);
+			storage_close(fd);
 		}
-		storage_read_from(fd, buf, offset, attr.element_size);
-		storage_close(fd);
 	}
 
 	return db_phy_to_value(value, &attr, buf);
@@ -400,6 +467,9 @@ void cursor_clean_data(db_cursor_t *cursor)
 		free(cursor->row_arr);
 	}
 	cursor->row_arr = NULL;
+	cursor->handle = NULL;
+	cursor->rel = NULL;
+	cursor->snapshot.fd = INVALID_STORAGE_ID;
 }
 
 db_result_t cursor_init(db_cursor_t **cursor, relation_t *rel)
@@ -430,11 +500,40 @@ db_result_t cursor_init(db_cursor_t **cursor, relation_t *rel)
 	return DB_OK;
 }
 
+/* Take a snapshot of rel for the cursor.  The relation stays pinned, and
+   cannot be removed or rewritten, until the cursor is freed. */
+db_result_t cursor_snapshot_open(db_cursor_t *cursor, relation_t *rel)
+{
+	if (cursor == NULL || cursor->rel != NULL) {
+		return DB_CURSOR_ERROR;
+	}
+
+	if (DB_ERROR(storage_snapshot_open(rel, &cursor->snapshot))) {
+		return DB_STORAGE_ERROR;
+	}
+
+	if (cursor->snapshot.nrows < cursor->total_rows) {
+		cursor->total_rows = cursor->snapshot.nrows;
+	}
+	cursor->rel = rel;
+	rel->snapshots++;
+
+	return DB_OK;
+}
+
 db_result_t cursor_deinit(db_cursor_t *cursor)
 {
 	if (cursor == NULL) {
 		return DB_CURSOR_ERROR;
 	}
+	if (cursor->rel != NULL) {
+		storage_snapshot_close(&cursor->snapshot);
+		relation_snapshot_close(cursor->rel);
+		cursor->rel = NULL;
+	}
+	if (cursor->handle != NULL) {
+		aql_deinit_handle(&cursor->handle);
+	}
 	if (cursor->row_arr) {
 		free(cursor->row_arr);
 		cursor->row_arr = NULL;
@@ -73,9 +73,11 @@
 #define DB_ERROR_BUF_SIZE               50
 #endif							/* DB_ERROR_BUF_SIZE */
 
-/* The maximum number of indexes in use by all relations loaded in memory. */
+/* The maximum number of indexes in use by all relations loaded in memory.
+   A string or composite key takes an index of its own besides the numeric
+   ones. */
 #ifndef DB_INDEX_POOL_SIZE
-#define DB_INDEX_POOL_SIZE              3
+#define DB_INDEX_POOL_SIZE              5
 #endif							/* DB_INDEX_POOL_SIZE */
 
 /* The maximum number of relations loaded in memory. */
@@ -101,7 +103,7 @@
 /* The maximum size of the LVM bytecode compiled from a
    single database query. */
 #ifndef DB_VM_BYTECODE_SIZE
-#define DB_VM_BYTECODE_SIZE             128
+#define DB_VM_BYTECODE_SIZE             256
 #endif							/* DB_VM_BYTECODE_SIZE */
 
 /*----------------------------------------------------------------------------*/
@@ -127,6 +129,11 @@
 #define AQL_ATTRIBUTE_LIMIT             6
 #endif							/* AQL_ATTRIBUTE_LIMIT */
 
+/* The maximum number of parameters ('?') in a single query. */
+#ifndef AQL_PARAMETER_LIMIT
+#define AQL_PARAMETER_LIMIT             AQL_ATTRIBUTE_LIMIT
+#endif							/* AQL_PARAMETER_LIMIT */
+
 /*----------------------------------------------------------------------------*/
 
 /*
@@ -163,6 +170,106 @@
 #define CONFIG_MOUNT_POINT "/mnt/"
 #endif
 
+/* The size of the buffer in which db_insert_batch() builds rows. */
+#ifndef DB_BATCH_BUFFER_SIZE
+#ifdef CONFIG_ARASTORAGE_BATCH_BUFFER_SIZE
+#define DB_BATCH_BUFFER_SIZE            CONFIG_ARASTORAGE_BATCH_BUFFER_SIZE
+#else
+#define DB_BATCH_BUFFER_SIZE            2048
+#endif
+#endif							/* DB_BATCH_BUFFER_SIZE */
+
+/* The number of compiled statements kept by db_prepare(). */
+#ifndef DB_QUERY_CACHE_SIZE
+#ifdef CONFIG_ARASTORAGE_QUERY_CACHE_SIZE
+#define DB_QUERY_CACHE_SIZE             CONFIG_ARASTORAGE_QUERY_CACHE_SIZE
+#else
+#define DB_QUERY_CACHE_SIZE             4
+#endif
+#endif							/* DB_QUERY_CACHE_SIZE */
+
+/* The memory in which a JOIN hashes the rows of the smaller relation.
+   Relations which do not fit are partitioned into scratch files first. */
+#ifndef DB_JOIN_MEMORY
+#ifdef CONFIG_ARASTORAGE_JOIN_MEMORY
+#define DB_JOIN_MEMORY                  CONFIG_ARASTORAGE_JOIN_MEMORY
+#else
+#define DB_JOIN_MEMORY                  4096
+#endif
+#endif							/* DB_JOIN_MEMORY */
+
+/* The maximum number of partitions of a relation in a JOIN. */
+#ifndef DB_JOIN_PARTITIONS
+#define DB_JOIN_PARTITIONS              4
+#endif							/* DB_JOIN_PARTITIONS */
+
+/* The memory in which ORDER BY sorts runs of rows before merging them. */
+#ifndef DB_SORT_MEMORY
+#ifdef CONFIG_ARASTORAGE_SORT_MEMORY
+#define DB_SORT_MEMORY                  CONFIG_ARASTORAGE_SORT_MEMORY
+#else
+#define DB_SORT_MEMORY                  4096
+#endif
+#endif							/* DB_SORT_MEMORY */
+
+/* The number of sorted runs that are merged at once. */
+#ifndef DB_SORT_FANIN
+#define DB_SORT_FANIN                   4
+#endif							/* DB_SORT_FANIN */
+
+/* The scratch files of a JOIN partition, named after the side of the join
+   and the partition, and the files of the sorted runs. */
+#ifndef DB_JOIN_FILE
+#define DB_JOIN_FILE                    "db-j%c%d"
+#endif							/* DB_JOIN_FILE */
+
+#ifndef DB_SORT_FILE
+#define DB_SORT_FILE                    "db-s%d"
+#endif							/* DB_SORT_FILE */
+
+/* The write-ahead log, see wal.h. */
+#ifndef DB_WAL_FILE
+#define DB_WAL_FILE                     "db.wal"
+#endif							/* DB_WAL_FILE */
+
+/* The file into which recovery copies a tuple file that it shortens. */
+#ifndef DB_WAL_TEMP_FILE
+#define DB_WAL_TEMP_FILE                "wal.tmp"
+#endif							/* DB_WAL_TEMP_FILE */
+
+#ifndef DB_WAL_BUFFER_SIZE
+#ifdef CONFIG_ARASTORAGE_WAL_BUFFER_SIZE
+#define DB_WAL_BUFFER_SIZE              CONFIG_ARASTORAGE_WAL_BUFFER_SIZE
+#else
+#define DB_WAL_BUFFER_SIZE              1024
+#endif
+#endif							/* DB_WAL_BUFFER_SIZE */
+
+#ifndef DB_WAL_CHECKPOINT_SIZE
+#ifdef CONFIG_ARASTORAGE_WAL_CHECKPOINT_SIZE
+#define DB_WAL_CHECKPOINT_SIZE          CONFIG_ARASTORAGE_WAL_CHECKPOINT_SIZE
+#else
+#define DB_WAL_CHECKPOINT_SIZE          16384
+#endif
+#endif							/* DB_WAL_CHECKPOINT_SIZE */
+
+#ifndef DB_WAL_CHECKPOINT_INTERVAL
+#ifdef CONFIG_ARASTORAGE_WAL_CHECKPOINT_INTERVAL
+#define DB_WAL_CHECKPOINT_INTERVAL      CONFIG_ARASTORAGE_WAL_CHECKPOINT_INTERVAL
+#else
+#define DB_WAL_CHECKPOINT_INTERVAL      10
+#endif
+#endif							/* DB_WAL_CHECKPOINT_INTERVAL */
+
+/* The number of tuple files whose size is logged once per checkpoint. */
+#ifndef DB_WAL_FILE_LIMIT
+#define DB_WAL_FILE_LIMIT               8
+#endif							/* DB_WAL_FILE_LIMIT */
+
+#ifndef DB_WAL_STACK_SIZE
+#define DB_WAL_STACK_SIZE               4096
+#endif							/* DB_WAL_STACK_SIZE */
+
 /* The maximum number of tuples in a relation. */
 #ifndef DB_TUPLE_LIMIT
 #define DB_TUPLE_LIMIT          2000
@@ -184,6 +291,12 @@
 #define RESULT_RELATION "db-res"
 #endif							/* RESULT_RELATION */
 
+/* The prefix of the relations which hold the joined or the sorted rows
+   of a query until its cursor is freed. */
+#ifndef TEMP_RELATION
+#define TEMP_RELATION "db-t"
+#endif							/* TEMP_RELATION */
+
 /* The name of the relation used for processing a REMOVE query. */
 #ifndef REMOVE_RELATION
 #define REMOVE_RELATION "db-rem"
@@ -216,6 +329,43 @@
 #define DB_INDEX_COST                   64
 #endif							/* DB_INDEX_COST */
 
+/* The number of key hashes that estimate the distinct keys of an index. */
+#ifndef DB_INDEX_STATS_HASHES
+#define DB_INDEX_STATS_HASHES           16
+#endif							/* DB_INDEX_STATS_HASHES */
+
+/*
+ * The costs of the access paths of a query, relative to reading the next
+ * row of a full scan. A row that is found through an index is fetched
+ * from an arbitrary position of the tuple file, and a B+tree lookup
+ * descends from the root to a leaf.
+ */
+#ifndef DB_COST_ROW_SCAN
+#define DB_COST_ROW_SCAN                1
+#endif							/* DB_COST_ROW_SCAN */
+
+#ifndef DB_COST_ROW_FETCH
+#define DB_COST_ROW_FETCH               4
+#endif							/* DB_COST_ROW_FETCH */
+
+#ifndef DB_COST_INDEX_LOOKUP
+#define DB_COST_INDEX_LOOKUP            16
+#endif							/* DB_COST_INDEX_LOOKUP */
+
+#ifndef DB_COST_INDEX_KEY
+#define DB_COST_INDEX_KEY               1
+#endif							/* DB_COST_INDEX_KEY */
+
+/* The maximum number of access paths that EXPLAIN lists for a query. */
+#ifndef DB_PLAN_LIMIT
+#define DB_PLAN_LIMIT                   (DB_INDEX_POOL_SIZE + 1)
+#endif							/* DB_PLAN_LIMIT */
+
+/* The maximum number of attributes in a composite index key. */
+#ifndef DB_MAX_INDEX_KEY_ATTRIBUTES
+#define DB_MAX_INDEX_KEY_ATTRIBUTES     2
+#endif							/* DB_MAX_INDEX_KEY_ATTRIBUTES */
+
 /* The maximum number of Maxheap indexes. */
 #ifndef DB_HEAP_INDEX_LIMIT
 #define DB_HEAP_INDEX_LIMIT             1
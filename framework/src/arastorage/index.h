@@ -68,6 +68,15 @@
 #define INDEX_API_INLINE        0x04
 #define INDEX_API_COMPLETE      0x08
 #define INDEX_API_RANGE_QUERIES 0x10
+#define INDEX_API_KEYS          0x20
+
+/*
+ * String and composite keys are packed into the integer key of the index,
+ * which only keeps a prefix of them. The index then returns a superset of
+ * the matching tuples, which the predicate of the query has to filter.
+ */
+#define INDEX_KEY_IS_PACKED(index) \
+	((index)->key_count > 1 || (index)->attr->domain == DOMAIN_STRING)
 
 /****************************************************************************
 * Public Type Definitions
@@ -87,15 +96,34 @@ enum index_state_e {
 };
 typedef enum index_state_e index_state_t;
 
+/*
+ * The statistics of the keys of an index, which are kept up to date on
+ * every insertion. The number of distinct keys is estimated from the
+ * smallest hashes of the keys, so that it needs a fixed amount of memory.
+ */
+struct index_stats_s {
+	tuple_id_t rows;
+	tuple_id_t distinct;
+	long min;
+	long max;
+	uint32_t hashes[DB_INDEX_STATS_HASHES];
+	uint8_t hash_count;
+	uint8_t valid;
+};
+typedef struct index_stats_s index_stats_t;
+
 struct index_s {
 	struct index_s *next;
 	char descriptor_file[DB_MAX_FILENAME_LENGTH];
 	relation_t *rel;
 	attribute_t *attr;
+	char key_attributes[DB_MAX_INDEX_KEY_ATTRIBUTES - 1][ATTRIBUTE_NAME_LENGTH + 1];
+	uint8_t key_count;
 	struct index_api_s *api;
 	void *opaque_data;
 	index_type_t type;
 	index_state_t state;
+	index_stats_t stats;
 };
 typedef struct index_s index_t;
 
@@ -106,9 +134,17 @@ struct index_iterator_s {
 	attribute_value_t max_value;
 	tuple_id_t next_item_no;
 	tuple_id_t found_items;
+	long key;
 };
 typedef struct index_iterator_s index_iterator_t;
 
+/* An index entry of a batch, see index_insert_batch(). */
+struct index_pair_s {
+	long key;
+	tuple_id_t tuple_id;
+};
+typedef struct index_pair_s index_pair_t;
+
 struct index_api_s {
 	index_type_t type;
 	uint8_t flags;
@@ -119,6 +155,10 @@ struct index_api_s {
 	db_result_t(*insert)(index_t *, attribute_value_t *, tuple_id_t);
 	db_result_t(*delete)(index_t *, attribute_value_t *);
 	tuple_id_t(*get_next)(index_iterator_t *, uint8_t);
+	/* Inserts entries sorted by key, or NULL to insert them one by one */
+	db_result_t(*insert_batch)(index_t *, index_pair_t *, tuple_id_t);
+	/* Writes the entries cached in RAM to storage, or NULL if none are */
+	db_result_t(*sync)(index_t *);
 };
 
 typedef struct index_api_s index_api_t;
@@ -133,13 +173,20 @@ extern index_api_t index_bplustree;
  * Internal function prototypes
  ****************************************************************************/
 db_result_t index_init(void);
-db_result_t index_create(index_type_t, relation_t *, attribute_t *);
+db_result_t index_create(index_type_t, relation_t *, attribute_t **, uint8_t);
 db_result_t index_destroy(index_t *);
 db_result_t index_load(relation_t *, attribute_t *);
 db_result_t index_release(index_t *);
+db_result_t index_sync(void);
 db_result_t index_insert(index_t *, attribute_value_t *, tuple_id_t);
+db_result_t index_insert_row(index_t *, unsigned char *, tuple_id_t);
+db_result_t index_get_row_key(index_t *, unsigned char *, long *);
+db_result_t index_insert_batch(index_t *, index_pair_t *, tuple_id_t);
+db_result_t index_get_key_range(index_t *, long *, long *, uint8_t, attribute_value_t *, attribute_value_t *);
 db_result_t index_delete(index_t *, attribute_value_t *);
 db_result_t index_get_iterator(index_iterator_t *, index_t *, attribute_value_t *, attribute_value_t *);
+index_stats_t *index_get_stats(index_t *);
+tuple_id_t index_estimate_rows(index_t *, long, long);
 tuple_id_t index_get_next(index_iterator_t *, uint8_t);
 int index_exists(attribute_t *);
 db_result_t index_deinit(void);
@@ -60,6 +60,7 @@
 #include "db_options.h"
 #include "db_debug.h"
 #include "storage.h"
+#include "buffer_pool.h"
 #include "memb.h"
 #include "random.h"
 #include "rw_locks.h"
@@ -246,6 +247,8 @@ struct tree_s {
 	pthread_mutex_t buck_cache_lock;	/*  Maintains concurrency control over Bucket Cache  */
 	pthread_mutex_t bucket_lock;	/*  Maintains serialisability over in RAM Tree Structure  */
 	struct rw_lock_s tree_lock;	/*  A Reader Writer Lock used to maintain consistency in tree structure */
+	char tree_file[DB_MAX_FILENAME_LENGTH];	/*  Name of the tree storage file, which identifies its pages in the buffer pool */
+	char bucket_file[DB_MAX_FILENAME_LENGTH];	/*  Name of the bucket storage file */
 };
 typedef struct tree_s tree_t;
 
@@ -278,9 +281,12 @@ static db_result_t create(index_t *);
 static db_result_t destroy(index_t *);
 static db_result_t load(index_t *);
 static db_result_t release(index_t *);
+static db_result_t sync_cache(index_t *);
 static db_result_t insert(index_t *, attribute_value_t *, tuple_id_t);
 static db_result_t delete(index_t *, attribute_value_t *);
 static tuple_id_t get_next(index_iterator_t *, uint8_t);
+static db_result_t insert_batch(index_t *, index_pair_t *, tuple_id_t);
+static db_result_t tree_build(tree_t *, pair_t *, int);
 
 #ifdef DB_WIP
 static db_result_t vacuum(tree_t *, relation_t *);
@@ -294,14 +300,16 @@ static int db_flush(tree_t *, relation_t *);
 
 index_api_t index_bplustree = {
 	INDEX_BPLUSTREE,
-	INDEX_API_EXTERNAL | INDEX_API_RANGE_QUERIES,
+	INDEX_API_EXTERNAL | INDEX_API_RANGE_QUERIES | INDEX_API_KEYS,
 	create,
 	destroy,
 	load,
 	release,
 	insert,
 	delete,
-	get_next
+	get_next,
+	insert_batch,
+	sync_cache
 };
 
 /****************************************************************************
@@ -339,10 +347,14 @@ static db_result_t create(index_t *index)
 	int offset = 0;
 	db_result_t result;
 	uint8_t success = 0;
-	int curtime;
+	static bool seeded = false;
 
-	curtime = time(NULL);
-	random_init(curtime);
+	/* Seed once only: the indexes which are created within the same
+	   second would get the same file names again. */
+	if (!seeded) {
+		random_init(time(NULL));
+		seeded = true;
+	}
 	tree_t *tree = malloc(sizeof(tree_t));
 	if (tree == NULL) {
 		DB_LOG_E("DB: Failed to allocate a tree\n");
@@ -395,17 +407,19 @@ static db_result_t create(index_t *index)
 		return result;
 
 	}
-	storage_write_to(tree->tree_storage, tree, offset, sizeof(tree_t));
+	memcpy(tree->tree_file, tree_filename, sizeof(tree->tree_file));
+	memcpy(tree->bucket_file, bucket_filename, sizeof(tree->bucket_file));
+	buffer_pool_write(tree->tree_file, tree->tree_storage, tree, offset, sizeof(tree_t));
 	offset += sizeof(tree_t);
-	storage_write_to(tree->tree_storage, bucket_filename, offset, sizeof(bucket_filename));
+	buffer_pool_write(tree->tree_file, tree->tree_storage, bucket_filename, offset, sizeof(bucket_filename));
 	offset += sizeof(bucket_filename);
 	base_offset = offset;
-	storage_write_to(tree->tree_storage, &tree_node, offset, sizeof(tree_node_t));
+	buffer_pool_write(tree->tree_file, tree->tree_storage, &tree_node, offset, sizeof(tree_node_t));
 	buck.next_free_slot = 0;
 	buck.info[0] = CONFIG_BUCKETS_LIMIT - 1;
 	buck.info[1] = KEY_MAX;
 	buck.info[2] = 0;
-	storage_write_to(tree->bucket_storage, &buck, 0, sizeof(bucket_t));
+	buffer_pool_write(tree->bucket_file, tree->bucket_storage, &buck, 0, sizeof(bucket_t));
 
 	/* One is the root node and one is the bucket layer */
 	tree->levels = 2;
@@ -522,7 +536,7 @@ static db_result_t destroy(index_t *index)
 	if (fd < 0) {
 		return DB_STORAGE_ERROR;
 	}
-	if (DB_ERROR(storage_read_from(fd, bucket_file, sizeof(tree_t), sizeof(bucket_file)))) {
+	if (DB_ERROR(buffer_pool_read(index->descriptor_file, fd, bucket_file, sizeof(tree_t), sizeof(bucket_file)))) {
 		return DB_STORAGE_ERROR;
 	}
 	storage_close(fd);
@@ -553,17 +567,19 @@ static db_result_t load(index_t *index)
 		DB_LOG_E("Failed opening index descriptor file\n");
 		goto storage_error;
 	}
-	if (DB_ERROR(storage_read_from(fd, bucket_file, sizeof(tree_t), sizeof(bucket_file)))) {
+	if (DB_ERROR(buffer_pool_read(index->descriptor_file, fd, bucket_file, sizeof(tree_t), sizeof(bucket_file)))) {
 		DB_LOG_E("Failed reading bucket file\n");
 		storage_close(fd);
 		goto storage_error;
 	}
-	if (DB_ERROR(storage_read_from(fd, tree, 0, sizeof(tree_t)))) {
+	if (DB_ERROR(buffer_pool_read(index->descriptor_file, fd, tree, 0, sizeof(tree_t)))) {
 		DB_LOG_E("Failed  reading tree structure from descriptor file\n");
 		storage_close(fd);
 		goto storage_error;
 	}
 	storage_close(fd);
+	memcpy(tree->tree_file, index->descriptor_file, sizeof(tree->tree_file));
+	memcpy(tree->bucket_file, bucket_file, sizeof(tree->bucket_file));
 
 	tree->node_cache = malloc(sizeof(tree_cache_t));
 	if (tree->node_cache != NULL) {
@@ -673,7 +689,7 @@ static db_result_t release(index_t *index)
 	if ((tree->buck_cache->in_cache.tail == NULL) || (tree->buck_cache->in_cache.head == NULL)) {
 		return DB_ALLOCATION_ERROR;
 	}
-	storage_write_to(tree->tree_storage, tree, 0, sizeof(tree_t));
+	buffer_pool_write(tree->tree_file, tree->tree_storage, tree, 0, sizeof(tree_t));
 
 	/* Bucket Cache being flushed */
 	tmp_node = tree->buck_cache->in_cache.head->next;
@@ -709,6 +725,60 @@ static db_result_t release(index_t *index)
 	return DB_OK;
 }
 
+/****************************************************************************
+ * Name: sync_cache
+ *
+ * Description: Writes the tree descriptor and the dirty nodes and buckets of
+ *              the caches to storage, and keeps them cached.
+ *
+ ****************************************************************************/
+static db_result_t sync_cache(index_t *index)
+{
+	tree_t *tree;
+	qnode_t *tmp_node;
+	db_result_t result;
+
+	tree = index->opaque_data;
+	if (tree == NULL || tree->node_cache == NULL || tree->buck_cache == NULL) {
+		return DB_ALLOCATION_ERROR;
+	}
+	if (DB_ERROR(buffer_pool_write(tree->tree_file, tree->tree_storage, tree, 0, sizeof(tree_t)))) {
+		return DB_STORAGE_ERROR;
+	}
+
+	/* A node which failed to be written stays dirty, so that the next
+	   sync writes it again. */
+	result = DB_OK;
+	pthread_mutex_lock(&(tree->buck_cache_lock));
+	tmp_node = tree->buck_cache->in_cache.head->next;
+	while (tmp_node != tree->buck_cache->in_cache.tail) {
+		if ((tmp_node->node_state & NODE_STATE_DIRTY) && (tmp_node->node_state & NODE_STATE_VALID)) {
+			if (bucket_write(tree, tmp_node->id, &(tree->buck_cache->cache_t[tmp_node->pos].bucket))) {
+				UNSET_NODE_STATE(tmp_node, NODE_STATE_DIRTY);
+			} else {
+				result = DB_STORAGE_ERROR;
+			}
+		}
+		tmp_node = tmp_node->next;
+	}
+	pthread_mutex_unlock(&(tree->buck_cache_lock));
+
+	pthread_mutex_lock(&(tree->node_cache_lock));
+	tmp_node = tree->node_cache->in_cache.head->next;
+	while (tmp_node != tree->node_cache->in_cache.tail) {
+		if ((tmp_node->node_state & NODE_STATE_DIRTY) && (tmp_node->node_state & NODE_STATE_VALID)) {
+			if (tree_write(tree, tmp_node->id, &(tree->node_cache->cache_t[tmp_node->pos].node))) {
+				UNSET_NODE_STATE(tmp_node, NODE_STATE_DIRTY);
+			} else {
+				result = DB_STORAGE_ERROR;
+			}
+		}
+		tmp_node = tmp_node->next;
+	}
+	pthread_mutex_unlock(&(tree->node_cache_lock));
+	return result;
+}
+
 /****************************************************************************
  * Name: insert
  *
@@ -743,7 +813,7 @@ static db_result_t insert(index_t *index, attribute_value_t *key, tuple_id_t val
 	 ***************************************************************************************/
 #ifdef DB_WIP
 	qnode_t *tmp_node;
-	storage_write_to(tree->tree_storage, tree, 0, sizeof(tree_t));
+	buffer_pool_write(tree->tree_file, tree->tree_storage, tree, 0, sizeof(tree_t));
 
 	/* Bucket Cache being flushed */
 
@@ -767,6 +837,93 @@ static db_result_t insert(index_t *index, attribute_value_t *key, tuple_id_t val
 	return DB_OK;
 }
 
+/****************************************************************************
+ * Name: insert_batch
+ *
+ * Description: Inserts index entries which are sorted by key.
+ *              When the batch is at least as large as the tree, the entries
+ *              of the tree are merged with the batch and the whole tree is
+ *              rebuilt bottom-up with full buckets. A smaller batch is
+ *              inserted key by key, which is cheaper than rewriting the tree.
+ *
+ ****************************************************************************/
+static db_result_t insert_batch(index_t *index, index_pair_t *pairs, tuple_id_t count)
+{
+	attribute_value_t value;
+	tuple_id_t n;
+	/* With flushing, insert() drops old tuples, so the tree is not rebuilt */
+#ifndef CONFIG_ARASTORAGE_ENABLE_FLUSHING
+	tree_t *tree;
+	bucket_t *bucket;
+	pair_t *entries;
+	int existing;
+	int total;
+	int i;
+	db_result_t result;
+
+	tree = (tree_t *)index->opaque_data;
+	rw_lock_write(&(tree->tree_lock));
+
+	existing = 0;
+	for (i = 0; i < tree->off_buckets; i++) {
+		bucket = bucket_read(tree, i);
+		if (bucket == NULL) {
+			rw_unlock_write(&(tree->tree_lock));
+			return DB_INDEX_ERROR;
+		}
+		existing += bucket->next_free_slot;
+		modify_cache(tree, i, BUCKET, UNLOCK);
+	}
+
+	if ((int)count >= existing) {
+		total = existing + count;
+		entries = malloc(sizeof(pair_t) * total);
+		if (entries != NULL) {
+			total = 0;
+			for (i = 0; i < tree->off_buckets; i++) {
+				bucket = bucket_read(tree, i);
+				if (bucket == NULL) {
+					break;
+				}
+				memcpy(&entries[total], bucket->pairs, sizeof(pair_t) * bucket->next_free_slot);
+				total += bucket->next_free_slot;
+				modify_cache(tree, i, BUCKET, UNLOCK);
+			}
+			if (i == tree->off_buckets) {
+				for (n = 0; n < count; n++) {
+					entries[total].key = (int)pairs[n].key;
+					entries[total].value = (uint16_t)pairs[n].tuple_id;
+					total++;
+				}
+				if (existing > 0) {
+					qsort(entries, total, sizeof(pair_t), compare);
+				}
+				result = tree_build(tree, entries, total);
+			} else {
+				result = DB_INDEX_ERROR;
+			}
+			free(entries);
+			rw_unlock_write(&(tree->tree_lock));
+			if (DB_ERROR(result)) {
+				DB_LOG_E("DB: Failed to build a bplus-tree index of %d keys\n", total);
+			}
+			return result;
+		}
+	}
+	rw_unlock_write(&(tree->tree_lock));
+#endif
+
+	/* The sorted keys at least go to the same bucket one after another */
+	value.domain = DOMAIN_LONG;
+	for (n = 0; n < count; n++) {
+		VALUE_LONG(&value) = pairs[n].key;
+		if (DB_ERROR(insert(index, &value, pairs[n].tuple_id))) {
+			return DB_INDEX_ERROR;
+		}
+	}
+	return DB_OK;
+}
+
 static db_result_t delete(index_t *index, attribute_value_t *value)
 {
 	return DB_INDEX_ERROR;
@@ -790,6 +947,28 @@ static uint16_t next_bucket(tree_t *tree, bucket_t *bucket)
 	return next_bucket;
 }
 
+/****************************************************************************
+ * Name: index_key_bound
+ *
+ * Description: Helper function for get_next.
+ *              Clamps a bound of the range of an iterator to the keys of
+ *              the tree
+ *
+ ****************************************************************************/
+static int index_key_bound(attribute_value_t *value)
+{
+	long bound;
+
+	bound = db_value_to_long(value);
+	if (bound < INT_MIN) {
+		return INT_MIN;
+	}
+	if (bound > INT_MAX) {
+		return INT_MAX;
+	}
+	return (int)bound;
+}
+
 /****************************************************************************
  * Name: get_next
  *
@@ -816,8 +995,9 @@ static tuple_id_t get_next(index_iterator_t *iterator, uint8_t matched_condition
 	int key_max;
 	int key_min;
 	tree_t *tree;
-	key_min = *(int *)&iterator->min_value;
-	key_max = *(int *)&iterator->max_value;
+	/* The keys are ints, while the bounds of an open range are longs. */
+	key_min = index_key_bound(&iterator->min_value);
+	key_max = index_key_bound(&iterator->max_value);
 	tree = (tree_t *)iterator->index->opaque_data;
 
 	/* To initialize the iterator_cache */
@@ -846,6 +1026,8 @@ static tuple_id_t get_next(index_iterator_t *iterator, uint8_t matched_condition
 			iterator->found_items++;
 			iterator->next_item_no = iterator->found_items;
 
+			iterator->key = cache.bucket->pairs[i].key;
+
 			/* matched condition is FALSE when the query is for remove tuples */
 			if (matched_condition == FALSE) {
 				tuple_id_t tmp = cache.bucket->pairs[i].value;
@@ -910,13 +1092,12 @@ static tuple_id_t get_next(index_iterator_t *iterator, uint8_t matched_condition
 	tree->lock_buckets[cache.bucket_id] = 1;
 	pthread_mutex_unlock(&(tree->bucket_lock));
 
-	cache.start = 0;
-	cache.end = cache.bucket->next_free_slot;
-
 	/* TODO
 	 * Absent of non-cast return handling, should be taken care in the definition
 	 */
 	cache.bucket = bucket_read(tree, cache.bucket_id);
+	cache.start = 0;
+	cache.end = cache.bucket->next_free_slot;
 	if (cache.bucket->info[1] > key_max) {
 		modify_cache(tree, cache.bucket_id, BUCKET, UNLOCK);
 		if (iterator->found_items == 0) {
@@ -924,6 +1105,8 @@ static tuple_id_t get_next(index_iterator_t *iterator, uint8_t matched_condition
 		} else {
 			iterator->next_item_no = 1;
 		}
+		pthread_mutex_lock(&(tree->bucket_lock));
+		tree->lock_buckets[cache.bucket_id] = 0;
 		pthread_mutex_unlock(&(tree->bucket_lock));
 		rw_unlock_write(&(tree->tree_lock));
 		return INVALID_TUPLE;
@@ -1093,7 +1276,7 @@ static cache_result_t cache_write_node(tree_t *tree, int id, tree_node_t *node)
 	} else {
 		qnode_t *iter_node;
 		iter_node = tree->node_cache->in_cache.head->next;
-		while ((iter_node->node_state | NODE_STATE_LOCK) && iter_node != tree->node_cache->in_cache.tail) {
+		while ((iter_node->node_state & NODE_STATE_LOCK) && iter_node != tree->node_cache->in_cache.tail) {
 			iter_node = iter_node->next;
 		}
 		if (iter_node == tree->node_cache->in_cache.tail) {
@@ -1213,8 +1396,8 @@ static cache_result_t cache_write_bucket(tree_t *tree, int id, bucket_t *bucket)
  * Name: transform_key
  *
  * Description: Routine to tranform key to a type acceptable by index.
- *              Different data types of keys can be supported.
- *              some codes will be added in future.
+ *              Strings and composite keys are already packed into an int
+ *              by the index manager (see index_insert_row()).
  *
  ****************************************************************************/
 static int transform_key(int key)
@@ -1286,7 +1469,7 @@ static tree_node_t *tree_read(tree_t *tree, int bucket_id)
 		SET_NODE_STATE(new_node, NODE_STATE_LOCK | NODE_STATE_VALID | NODE_STATE_DIRTY);
 
 		/* Reading from flash */
-		if (DB_ERROR(storage_read_from(tree->tree_storage, &(tree->node_cache->cache_t[new_node->pos].node), base_offset + (unsigned long)bucket_id * sizeof(tree_node_t), sizeof(tree_node_t)))) {
+		if (DB_ERROR(buffer_pool_read(tree->tree_file, tree->tree_storage, &(tree->node_cache->cache_t[new_node->pos].node), base_offset + (unsigned long)bucket_id * sizeof(tree_node_t), sizeof(tree_node_t)))) {
 			DB_LOG_E("PANIC TREE READ FAILED AT NODE ID %d\n", new_node->id);
 			UNSET_NODE_STATE(new_node, NODE_STATE_LOCK | NODE_STATE_VALID);
 			pthread_mutex_unlock(&(tree->node_cache_lock));
@@ -1308,7 +1491,7 @@ static tree_node_t *tree_read(tree_t *tree, int bucket_id)
  ****************************************************************************/
 static int tree_write(tree_t *tree, int offset, tree_node_t *node)
 {
-	if (DB_ERROR(storage_write_to(tree->tree_storage, node, base_offset + (unsigned long)offset * sizeof(*node), sizeof(*node)))) {
+	if (DB_ERROR(buffer_pool_write(tree->tree_file, tree->tree_storage, node, base_offset + (unsigned long)offset * sizeof(*node), sizeof(*node)))) {
 		DB_LOG_E("TREE WRITE FAILED AT NODE ID %d\n", offset);
 		return 0;
 	}
@@ -1324,7 +1507,7 @@ static int tree_write(tree_t *tree, int offset, tree_node_t *node)
  ****************************************************************************/
 static int bucket_write(tree_t *tree, int pos, bucket_t *bucket)
 {
-	if (DB_ERROR(storage_write_to(tree->bucket_storage, bucket, (unsigned long)pos * sizeof(bucket_t), sizeof(bucket_t)))) {
+	if (DB_ERROR(buffer_pool_write(tree->bucket_file, tree->bucket_storage, bucket, (unsigned long)pos * sizeof(bucket_t), sizeof(bucket_t)))) {
 		DB_LOG_E("BUCKET WRITE FAILED AT BUCKET ID %d\n", pos);
 		return 0;
 	}
@@ -1364,6 +1547,140 @@ static tree_result_t tree_insert(tree_t *tree, int max)
 	return TREE_OK;
 }
 
+/****************************************************************************
+ * Name: tree_build
+ *
+ * Description: Replaces the contents of the tree by the given entries,
+ *              which must be sorted by key. The buckets are filled in key
+ *              order and chained, then each level of nodes is made from
+ *              the level below, until a level has a single node, the root.
+ *              The separator of a child is the largest key below it.
+ *              The caller holds the write lock of the tree.
+ *
+ ****************************************************************************/
+static db_result_t tree_build(tree_t *tree, pair_t *entries, int count)
+{
+	tree_node_t node;
+	bucket_t bucket;
+	qnode_t *iter;
+	int ids[CONFIG_BUCKETS_LIMIT];
+	int keys[CONFIG_BUCKETS_LIMIT];
+	int buckets;
+	int nodes;
+	int width;
+	int first;
+	int next;
+	int size;
+	int i;
+	int j;
+	uint8_t levels;
+
+	/* Check that the tree has room for the entries before changing it */
+	buckets = (count + BUCKET_SIZE - 1) / BUCKET_SIZE;
+	if (buckets == 0) {
+		buckets = 1;
+	}
+	if (buckets > CONFIG_BUCKETS_LIMIT - 1) {
+		DB_LOG_E("TREE FULL !");
+		return DB_INDEX_ERROR;
+	}
+	nodes = 0;
+	for (width = buckets; ; width = (width + BRANCH_FACTOR - 1) / BRANCH_FACTOR) {
+		nodes += (width + BRANCH_FACTOR - 1) / BRANCH_FACTOR;
+		if (width <= BRANCH_FACTOR) {
+			break;
+		}
+	}
+	if (nodes > CONFIG_NODE_LIMIT) {
+		DB_LOG_E("TREE FULL !");
+		return DB_INDEX_ERROR;
+	}
+
+	/* Every node and bucket is rewritten, so both caches are emptied */
+	pthread_mutex_lock(&(tree->node_cache_lock));
+	while ((iter = tree->node_cache->in_cache.head->next) != tree->node_cache->in_cache.tail) {
+		REMOVE_ENTRY(iter);
+		free(iter);
+	}
+	tree->node_cache->num = 0;
+	pthread_mutex_unlock(&(tree->node_cache_lock));
+	pthread_mutex_lock(&(tree->buck_cache_lock));
+	while ((iter = tree->buck_cache->in_cache.head->next) != tree->buck_cache->in_cache.tail) {
+		REMOVE_ENTRY(iter);
+		free(iter);
+	}
+	tree->buck_cache->num = 0;
+	pthread_mutex_unlock(&(tree->buck_cache_lock));
+
+	/* The bucket layer */
+	for (i = 0; i < buckets; i++) {
+		first = i * BUCKET_SIZE;
+		size = min(count - first, BUCKET_SIZE);
+		memset(&bucket, 0, sizeof(bucket_t));
+		if (size > 0) {
+			memcpy(bucket.pairs, &entries[first], sizeof(pair_t) * size);
+			bucket.next_free_slot = size;
+			bucket.info[1] = entries[first].key;
+			bucket.info[2] = entries[first + size - 1].key;
+			keys[i] = entries[first + size - 1].key;
+		} else {
+			bucket.info[1] = KEY_MAX;
+			bucket.info[2] = 0;
+			keys[i] = KEY_MAX;
+		}
+		bucket.info[0] = (i == buckets - 1) ? CONFIG_BUCKETS_LIMIT - 1 : i + 1;
+		if (!bucket_write(tree, i, &bucket)) {
+			return DB_STORAGE_ERROR;
+		}
+		ids[i] = i;
+	}
+
+	/* The node levels, from the leaves up to the root */
+	next = 0;
+	levels = 1;
+	width = buckets;
+	do {
+		nodes = (width + BRANCH_FACTOR - 1) / BRANCH_FACTOR;
+		first = 0;
+		for (i = 0; i < nodes; i++) {
+			/* Spread the children evenly, so that no node has a single child */
+			size = width / nodes + (i < width % nodes ? 1 : 0);
+			memset(&node, 0, sizeof(tree_node_t));
+			node.is_leaf = (levels == 1);
+			node.val[BRANCH_FACTOR - 1] = size - 1;
+			for (j = 0; j < size; j++) {
+				node.id[j] = ids[first + j];
+				if (j < size - 1) {
+					node.val[j] = keys[first + j];
+				}
+			}
+			if (!tree_write(tree, next, &node)) {
+				return DB_STORAGE_ERROR;
+			}
+			ids[i] = next++;
+			keys[i] = keys[first + size - 1];
+			first += size;
+		}
+		width = nodes;
+		levels++;
+	} while (width > 1);
+
+	tree->root = ids[0];
+	tree->levels = levels;
+	tree->off_nodes = next;
+	tree->off_buckets = buckets;
+	tree->inserted = count;
+	tree->deleted = 0;
+	memset(&tree->lock_buckets, 0, sizeof(tree->lock_buckets));
+
+	if (DB_ERROR(buffer_pool_write(tree->tree_file, tree->tree_storage, tree, 0, sizeof(tree_t)))) {
+		return DB_STORAGE_ERROR;
+	}
+
+	DB_LOG_D("DB: Built a bplus-tree of %d keys in %d buckets and %d nodes\n", count, buckets, next);
+	return DB_OK;
+}
+
 /****************************************************************************
  * Name: tree_find
  *
@@ -1557,7 +1874,7 @@ static bucket_t *bucket_read(tree_t *tree, int bucket_id)
 		UNSET_NODE_STATE(new_node, NODE_STATE_DIRTY);
 
 		/* Read from flash */
-		if (DB_ERROR(storage_read_from(tree->bucket_storage, (void *)&(tree->buck_cache->cache_t[new_node->pos].bucket), (unsigned long)bucket_id * sizeof(bucket_t), sizeof(bucket_t)))) {
+		if (DB_ERROR(buffer_pool_read(tree->bucket_file, tree->bucket_storage, (void *)&(tree->buck_cache->cache_t[new_node->pos].bucket), (unsigned long)bucket_id * sizeof(bucket_t), sizeof(bucket_t)))) {
 			DB_LOG_E("PANIC BUCKET READ FAILED AT ID %d\n", bucket_id);
 			UNSET_NODE_STATE(new_node, (NODE_STATE_LOCK | NODE_STATE_VALID));
 			pthread_mutex_unlock(&(tree->buck_cache_lock));
@@ -55,6 +55,8 @@
 /****************************************************************************
  * Included Files
  ****************************************************************************/
+#include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <pthread.h>
@@ -68,6 +70,12 @@
 #include "index.h"
 #include "result.h"
 
+/****************************************************************************
+* Pre-processor Definitions
+****************************************************************************/
+/* The number of bytes of a packed key that fit in the key of an index. */
+#define INDEX_KEY_SIZE 4
+
 /****************************************************************************
 * Private Types
 ****************************************************************************/
@@ -81,6 +89,13 @@ pthread_attr_t g_attr;
  * Private function prototypes
  ****************************************************************************/
 static index_api_t *find_index_api(index_type_t index_type);
+static attribute_t *find_key_attribute(index_t *index, uint8_t i, int *offset);
+static long key_to_long(unsigned char *key);
+static void bound_to_key(attribute_t *attr, long bound, unsigned char *key);
+static int compare_pairs(const void *p1, const void *p2);
+static void stats_clear(index_stats_t *stats);
+static void stats_add(index_stats_t *stats, long key);
+static db_result_t stats_load(index_t *index);
 db_result_t db_indexing(relation_t*);
 LIST(indices);
 MEMB(index_memb, index_t, DB_INDEX_POOL_SIZE);
@@ -122,11 +137,20 @@ db_result_t index_deinit(void)
 	return DB_OK;
 }
 
-db_result_t index_create(index_type_t index_type, relation_t *rel, attribute_t *attr)
+db_result_t index_create(index_type_t index_type, relation_t *rel, attribute_t **attrs, uint8_t count)
 {
 	tuple_id_t cardinality;
 	index_t *index;
 	index_api_t *api;
+	attribute_t *attr;
+	uint8_t i;
+
+	if (count < 1 || count > DB_MAX_INDEX_KEY_ATTRIBUTES) {
+		DB_LOG_E("DB: An index key cannot have %d attributes\n", count);
+		return DB_INDEX_ERROR;
+	}
+
+	attr = attrs[0];
 
 	cardinality = relation_cardinality(rel);
 	if (cardinality == INVALID_TUPLE) {
@@ -139,8 +163,21 @@ db_result_t index_create(index_type_t index_type, relation_t *rel, attribute_t *
 		return DB_INDEX_ERROR;
 	}
 
-	if (attr->domain != DOMAIN_INT && attr->domain != DOMAIN_LONG) {
-		DB_LOG_E("DB: Cannot create an index for a non-number attribute!\n");
+	/* Only the B+tree index can pack strings and composite keys into
+	   its keys; the inline index searches the numbers in the rows. */
+	for (i = 0; i < count; i++) {
+		if (attrs[i]->domain == DOMAIN_INT || attrs[i]->domain == DOMAIN_LONG) {
+			continue;
+		}
+		if (attrs[i]->domain == DOMAIN_STRING && index_type == INDEX_BPLUSTREE) {
+			continue;
+		}
+		DB_LOG_E("DB: Cannot create an index of type %d for the attribute %s!\n", (int)index_type, attrs[i]->name);
+		return DB_INDEX_ERROR;
+	}
+
+	if (count > 1 && index_type != INDEX_BPLUSTREE) {
+		DB_LOG_E("DB: Cannot create a composite index of type %d!\n", (int)index_type);
 		return DB_INDEX_ERROR;
 	}
 
@@ -158,14 +195,20 @@ db_result_t index_create(index_type_t index_type, relation_t *rel, attribute_t *
 
 	index->rel = rel;
 	index->attr = attr;
+	index->key_count = count;
+	for (i = 1; i < count; i++) {
+		memset(index->key_attributes[i - 1], 0, sizeof(index->key_attributes[i - 1]));
+		strncpy(index->key_attributes[i - 1], attrs[i]->name, ATTRIBUTE_NAME_LENGTH);
+	}
 	index->api = api;
 	index->state = INDEX_LOAD_NEEDED;
 	index->opaque_data = NULL;
 	index->descriptor_file[0] = '\0';
 	index->type = index_type;
+	stats_clear(&index->stats);
 
 	if (DB_ERROR(api->create(index))) {
-		index_release(index);
+		memb_free(&index_memb, index);
 		DB_LOG_E("DB: Index-specific creation failed for attribute %s\n", attr->name);
 		return DB_INDEX_ERROR;
 	}
@@ -201,7 +244,7 @@ db_result_t index_destroy(index_t *index)
 	db_result_t res;
 	int i;
 	index_t *index_iter;
-	if (DB_ERROR(index_release(index)) || DB_ERROR(index->api->destroy(index))) {
+	if (DB_ERROR(index->api->destroy(index))) {
 		return DB_INDEX_ERROR;
 	}
 	for (i = 0; i < index_memb.num; ++i) {
@@ -237,6 +280,12 @@ db_result_t index_load(relation_t *rel, attribute_t *attr)
 
 	DB_LOG_D("DB: Attempting to load an index over %s.%s\n", rel->name, attr->name);
 
+	/* The attribute holds one reference until it is freed, so an index
+	   which is loaded already is not counted again. */
+	if (attr->index != NULL) {
+		return DB_OK;
+	}
+
 	int i;
 	bool found = false;
 	for (i = 0; i < index_memb.num; ++i) {
@@ -275,6 +324,9 @@ db_result_t index_load(relation_t *rel, attribute_t *attr)
 		index->attr = attr;
 		index->opaque_data = NULL;
 
+		/* The statistics are gathered when a query first needs them. */
+		memset(&index->stats, 0, sizeof(index->stats));
+
 		api = find_index_api(index->type);
 		if (api == NULL) {
 			DB_LOG_E("DB: No API for index type %d\n", index->type);
@@ -299,14 +351,203 @@ db_result_t index_load(relation_t *rel, attribute_t *attr)
 
 db_result_t index_release(index_t *index)
 {
-	memb_free(&index_memb, index);
+	/* The index is unloaded when the last attribute which uses it is freed. */
+	if (memb_free(&index_memb, index) == 0) {
+		list_remove(indices, index);
+		if (DB_ERROR(index->api->release(index))) {
+			return DB_INDEX_ERROR;
+		}
+	}
+
+	return DB_OK;
+}
+
+/* Write the caches of the loaded indexes, so that the pages of a statement
+ * which the buffer pool logs hold all of its index entries. */
+db_result_t index_sync(void)
+{
+	index_t *index;
+
+	for (index = list_head(indices); index != NULL; index = index->next) {
+		if (index->state == INDEX_READY && index->api->sync != NULL && DB_ERROR(index->api->sync(index))) {
+			return DB_INDEX_ERROR;
+		}
+	}
 
 	return DB_OK;
 }
 
 db_result_t index_insert(index_t *index, attribute_value_t *value, tuple_id_t tuple_id)
 {
-	return index->api->insert(index, value, tuple_id);
+	if (DB_ERROR(index->api->insert(index, value, tuple_id))) {
+		return DB_INDEX_ERROR;
+	}
+	stats_add(&index->stats, db_value_to_long(value));
+
+	return DB_OK;
+}
+
+db_result_t index_get_row_key(index_t *index, unsigned char *row, long *key_value)
+{
+	attribute_value_t value;
+	attribute_t *attr;
+	unsigned char key[INDEX_KEY_SIZE];
+	unsigned char *ptr;
+	uint8_t i;
+	int offset;
+	int width;
+	int pos;
+	int j;
+
+	if (!INDEX_KEY_IS_PACKED(index)) {
+		if (find_key_attribute(index, 0, &offset) == NULL) {
+			return DB_INDEX_ERROR;
+		}
+		if (DB_ERROR(db_phy_to_value(&value, index->attr, row + offset))) {
+			return DB_INDEX_ERROR;
+		}
+		*key_value = db_value_to_long(&value);
+		return DB_OK;
+	}
+
+	/*
+	 * Concatenate the key attributes in a form whose byte order is the
+	 * order of the values: numbers are big-endian with the sign bit
+	 * flipped, and strings are padded with zeros to the attribute size.
+	 */
+	memset(key, 0, sizeof(key));
+	pos = 0;
+	for (i = 0; i < index->key_count && pos < INDEX_KEY_SIZE; i++) {
+		attr = find_key_attribute(index, i, &offset);
+		if (attr == NULL) {
+			return DB_INDEX_ERROR;
+		}
+
+		ptr = row + offset;
+		if (attr->domain == DOMAIN_STRING) {
+			width = attr->element_size - 1;
+			for (j = 0; j < width && pos + j < INDEX_KEY_SIZE && ptr[j] != '\0'; j++) {
+				key[pos + j] = ptr[j];
+			}
+		} else {
+			width = attr->domain == DOMAIN_INT ? 2 : 4;
+			for (j = 0; j < width && pos + j < INDEX_KEY_SIZE; j++) {
+				key[pos + j] = ptr[j];
+			}
+			key[pos] ^= 0x80;
+		}
+		pos += width;
+	}
+
+	*key_value = key_to_long(key);
+
+	return DB_OK;
+}
+
+db_result_t index_insert_row(index_t *index, unsigned char *row, tuple_id_t tuple_id)
+{
+	attribute_value_t value;
+
+	value.domain = DOMAIN_LONG;
+	if (DB_ERROR(index_get_row_key(index, row, &VALUE_LONG(&value)))) {
+		return DB_INDEX_ERROR;
+	}
+
+	return index_insert(index, &value, tuple_id);
+}
+
+/*
+ * Insert the keys of many tuples at once. The pairs are sorted here, so
+ * that an index which supports it can build its structure from the
+ * sorted keys instead of inserting them one by one.
+ */
+db_result_t index_insert_batch(index_t *index, index_pair_t *pairs, tuple_id_t count)
+{
+	attribute_value_t value;
+	tuple_id_t i;
+
+	if (count == 0) {
+		return DB_OK;
+	}
+
+	qsort(pairs, count, sizeof(index_pair_t), compare_pairs);
+
+	if (index->api->insert_batch != NULL) {
+		if (DB_ERROR(index->api->insert_batch(index, pairs, count))) {
+			return DB_INDEX_ERROR;
+		}
+		for (i = 0; i < count; i++) {
+			stats_add(&index->stats, pairs[i].key);
+		}
+		return DB_OK;
+	}
+
+	value.domain = DOMAIN_LONG;
+	for (i = 0; i < count; i++) {
+		VALUE_LONG(&value) = pairs[i].key;
+		if (DB_ERROR(index_insert(index, &value, pairs[i].tuple_id))) {
+			return DB_INDEX_ERROR;
+		}
+	}
+
+	return DB_OK;
+}
+
+db_result_t index_get_key_range(index_t *index, long *min, long *max, uint8_t count, attribute_value_t *min_value, attribute_value_t *max_value)
+{
+	attribute_t *attr;
+	unsigned char min_key[INDEX_KEY_SIZE];
+	unsigned char max_key[INDEX_KEY_SIZE];
+	unsigned char min_bound[INDEX_KEY_SIZE];
+	unsigned char max_bound[INDEX_KEY_SIZE];
+	uint8_t i;
+	int width;
+	int pos;
+	int n;
+
+	min_value->domain = max_value->domain = DOMAIN_LONG;
+
+	if (!INDEX_KEY_IS_PACKED(index)) {
+		VALUE_LONG(min_value) = min[0];
+		VALUE_LONG(max_value) = max[0];
+		return DB_OK;
+	}
+
+	/*
+	 * The ranges of the key attributes are given in the order of the key.
+	 * A range narrows the key only as long as the attributes before it
+	 * are known exactly; the rest of the key is left open.
+	 */
+	memset(min_key, 0, sizeof(min_key));
+	memset(max_key, 0xff, sizeof(max_key));
+	pos = 0;
+	for (i = 0; i < count && pos < INDEX_KEY_SIZE; i++) {
+		attr = find_key_attribute(index, i, NULL);
+		if (attr == NULL) {
+			return DB_INDEX_ERROR;
+		}
+
+		bound_to_key(attr, min[i], min_bound);
+		bound_to_key(attr, max[i], max_bound);
+
+		width = attr->domain == DOMAIN_STRING ? attr->element_size - 1 : (attr->domain == DOMAIN_INT ? 2 : 4);
+		n = INDEX_KEY_SIZE - pos;
+		if (n > width) {
+			n = width;
+		}
+		memcpy(min_key + pos, min_bound, n);
+		memcpy(max_key + pos, max_bound, n);
+		pos += n;
+
+		if (n < width || memcmp(min_bound, max_bound, n) != 0) {
+			break;
+		}
+	}
+
+	VALUE_LONG(min_value) = key_to_long(min_key);
+	VALUE_LONG(max_value) = key_to_long(max_key);
+
+	return DB_OK;
 }
 
 db_result_t index_delete(index_t *index, attribute_value_t *value)
@@ -315,6 +556,9 @@ db_result_t index_delete(index_t *index, attribute_value_t *value)
 		return DB_INDEX_ERROR;
 	}
 
+	/* The bounds of the keys cannot be narrowed without a new scan. */
+	index->stats.valid = 0;
+
 	return index->api->delete(index, value);
 }
 
@@ -368,6 +612,8 @@ db_result_t index_get_iterator(index_iterator_t *iterator, index_t *index, attri
 	iterator->min_value = *min_value;
 	iterator->max_value = *max_value;
 	iterator->next_item_no = 0;
+	iterator->found_items = 0;
+	iterator->key = 0;
 
 	DB_LOG_D("DB: Acquired an index iterator for %s.%s over the range (%ld,%ld)\n", index->rel->name, index->attr->name, min_value->u.long_value, max_value->u.long_value);
 
@@ -384,7 +630,7 @@ tuple_id_t index_get_next(index_iterator_t *iterator, uint8_t matched_condition)
 		return INVALID_TUPLE;
 	}
 
-	if ((iterator->index->attr->flags & ATTRIBUTE_FLAG_UNIQUE) && iterator->next_item_no == 1) {
+	if ((iterator->index->attr->flags & ATTRIBUTE_FLAG_UNIQUE) && !INDEX_KEY_IS_PACKED(iterator->index) && iterator->next_item_no == 1) {
 		min = db_value_to_long(&iterator->min_value);
 		max = db_value_to_long(&iterator->max_value);
 		if (min == max) {
@@ -400,6 +646,65 @@ tuple_id_t index_get_next(index_iterator_t *iterator, uint8_t matched_condition)
 	return iterator->index->api->get_next(iterator, matched_condition);
 }
 
+/* Returns the statistics of an index, which are gathered on first use. */
+index_stats_t *index_get_stats(index_t *index)
+{
+	index_stats_t *stats;
+	uint64_t distinct;
+
+	stats = &index->stats;
+	if (!stats->valid && DB_ERROR(stats_load(index))) {
+		return NULL;
+	}
+
+	/*
+	 * When the hashes of all keys did not fit, the distinct keys are
+	 * estimated from how densely the smallest hashes fill the hash space.
+	 */
+	if (stats->hash_count < DB_INDEX_STATS_HASHES) {
+		stats->distinct = stats->hash_count;
+	} else {
+		distinct = ((uint64_t)(DB_INDEX_STATS_HASHES - 1) << 32) / ((uint64_t)stats->hashes[DB_INDEX_STATS_HASHES - 1] + 1);
+		stats->distinct = distinct < stats->rows ? (tuple_id_t)distinct : stats->rows;
+	}
+
+	return stats;
+}
+
+/*
+ * Estimate the number of rows whose keys are in a range, assuming that
+ * the keys are spread evenly between the smallest and the largest key.
+ */
+tuple_id_t index_estimate_rows(index_t *index, long min, long max)
+{
+	index_stats_t *stats;
+	uint64_t span;
+	uint64_t rows;
+
+	stats = index_get_stats(index);
+	if (stats == NULL) {
+		return INVALID_TUPLE;
+	}
+
+	if (min < stats->min) {
+		min = stats->min;
+	}
+	if (max > stats->max) {
+		max = stats->max;
+	}
+	if (stats->rows == 0 || min > max) {
+		return 0;
+	}
+
+	if (min == max) {
+		return (stats->rows + stats->distinct - 1) / stats->distinct;
+	}
+
+	span = (uint64_t)((int64_t)stats->max - stats->min) + 1;
+	rows = ((uint64_t)((int64_t)max - min) + 1) * stats->rows;
+	return (tuple_id_t)((rows + span - 1) / span);
+}
+
 /****************************************************************************
 * Private Functions
 ****************************************************************************/
@@ -416,6 +721,184 @@ static index_api_t *find_index_api(index_type_t index_type)
 	return NULL;
 }
 
+/* Find the i:th attribute of the key, and its offset in a row. */
+static attribute_t *find_key_attribute(index_t *index, uint8_t i, int *offset)
+{
+	attribute_t *attr;
+	char *name;
+	int attr_offset;
+
+	name = i == 0 ? index->attr->name : index->key_attributes[i - 1];
+
+	attr_offset = 0;
+	for (attr = list_head(index->rel->attributes); attr != NULL; attr = attr->next) {
+		if (strcmp(attr->name, name) == 0) {
+			if (offset != NULL) {
+				*offset = attr_offset;
+			}
+			return attr;
+		}
+		attr_offset += attr->element_size;
+	}
+
+	DB_LOG_E("DB: Failed to find the key attribute %s in %s\n", name, index->rel->name);
+	return NULL;
+}
+
+/* Convert the first bytes of a packed key to the key of the index. */
+static long key_to_long(unsigned char *key)
+{
+	uint32_t u;
+	long l;
+
+	u = (uint32_t)key[0] << 24 | (uint32_t)key[1] << 16 | (uint32_t)key[2] << 8 | key[3];
+	l = (long)(int32_t)(u ^ 0x80000000);
+
+	/* INT_MAX marks the end of the B+tree, so it cannot be a key. */
+	if (l == INT_MAX) {
+		l--;
+	}
+
+	return l;
+}
+
+/*
+ * Convert a bound of a derived range to packed key bytes. The bounds of
+ * strings are made by lvm_string_to_long(), which flips the sign bit of
+ * the prefix in the same way as for a long.
+ */
+static void bound_to_key(attribute_t *attr, long bound, unsigned char *key)
+{
+	uint32_t u;
+
+	if (attr->domain == DOMAIN_INT) {
+		if (bound < SHRT_MIN) {
+			bound = SHRT_MIN;
+		} else if (bound > SHRT_MAX) {
+			bound = SHRT_MAX;
+		}
+		u = (uint32_t)((uint16_t)bound ^ 0x8000) << 16;
+	} else if (bound <= DB_LONG_MIN) {
+		u = 0;
+	} else {
+		u = (uint32_t)bound ^ 0x80000000;
+	}
+
+	key[0] = u >> 24;
+	key[1] = u >> 16;
+	key[2] = u >> 8;
+	key[3] = u;
+}
+
+/* Order index pairs by key, and pairs with equal keys by tuple id. */
+static int compare_pairs(const void *p1, const void *p2)
+{
+	long key1 = ((const index_pair_t *)p1)->key;
+	long key2 = ((const index_pair_t *)p2)->key;
+
+	if (key1 != key2) {
+		return key1 < key2 ? -1 : 1;
+	}
+	return ((const index_pair_t *)p1)->tuple_id < ((const index_pair_t *)p2)->tuple_id ? -1 : 1;
+}
+
+static void stats_clear(index_stats_t *stats)
+{
+	memset(stats, 0, sizeof(index_stats_t));
+	stats->min = LONG_MAX;
+	stats->max = LONG_MIN;
+	stats->valid = 1;
+}
+
+/* Hash a key so that the hashes of the keys are spread evenly. */
+static uint32_t hash_key(long key)
+{
+	uint32_t hash;
+
+	hash = (uint32_t)key;
+	hash ^= hash >> 16;
+	hash *= 0x7feb352d;
+	hash ^= hash >> 15;
+	hash *= 0x846ca68b;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+static void stats_add(index_stats_t *stats, long key)
+{
+	uint32_t hash;
+	uint8_t i;
+
+	if (!stats->valid) {
+		return;
+	}
+
+	stats->rows++;
+	if (key < stats->min) {
+		stats->min = key;
+	}
+	if (key > stats->max) {
+		stats->max = key;
+	}
+
+	/* Keep the smallest hashes in ascending order, each only once. */
+	hash = hash_key(key);
+	if (stats->hash_count == DB_INDEX_STATS_HASHES && hash >= stats->hashes[DB_INDEX_STATS_HASHES - 1]) {
+		return;
+	}
+	for (i = 0; i < stats->hash_count && stats->hashes[i] < hash; i++) {
+	}
+	if (i < stats->hash_count && stats->hashes[i] == hash) {
+		return;
+	}
+	if (stats->hash_count < DB_INDEX_STATS_HASHES) {
+		stats->hash_count++;
+	}
+	memmove(&stats->hashes[i + 1], &stats->hashes[i], (stats->hash_count - 1 - i) * sizeof(uint32_t));
+	stats->hashes[i] = hash;
+}
+
+/* Gather the statistics of an index which was loaded from storage. */
+static db_result_t stats_load(index_t *index)
+{
+	relation_t *rel;
+	tuple_id_t tuple_id;
+	tuple_id_t cardinality;
+	storage_row_t row;
+	long key;
+
+	rel = index->rel;
+	cardinality = relation_cardinality(rel);
+	if (cardinality == INVALID_TUPLE) {
+		return DB_STORAGE_ERROR;
+	}
+
+	row = (storage_row_t)malloc(sizeof(char) * rel->row_length + 1);
+	if (row == NULL) {
+		DB_LOG_E("DB: Failed to allocate row\n");
+		return DB_ALLOCATION_ERROR;
+	}
+#ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
+	storage_flush_insert_buffer();
+#endif
+
+	stats_clear(&index->stats);
+	for (tuple_id = 0; tuple_id < cardinality; tuple_id++) {
+		if (DB_ERROR(storage_get_row(rel, &tuple_id, row)) || DB_ERROR(index_get_row_key(index, row, &key))) {
+			DB_LOG_E("DB: Failed to read the keys of %s.%s\n", rel->name, index->attr->name);
+			index->stats.valid = 0;
+			free(row);
+			return DB_STORAGE_ERROR;
+		}
+		stats_add(&index->stats, key);
+	}
+	free(row);
+
+	DB_LOG_D("DB: Gathered the statistics of %lu keys of %s.%s\n", (unsigned long)cardinality, rel->name, index->attr->name);
+	return DB_OK;
+}
+
 static index_t *get_next_index_to_load(void)
 {
 	index_t *index;
@@ -435,11 +918,8 @@ db_result_t db_indexing(relation_t *rel)
 	tuple_id_t tuple_id;
 	tuple_id_t cardinality;
 	storage_row_t row;
-	attribute_value_t value;
-	attribute_t *attr;
+	index_pair_t *pairs;
 	db_result_t result;
-	int offset;
-	bool isfound;
 
 	index = get_next_index_to_load();
 	if (index == NULL) {
@@ -458,27 +938,15 @@ db_result_t db_indexing(relation_t *rel)
 #endif
 	DB_LOG_D("DB: Loading the index for %s.%s...\n", index->rel->name, index->attr->name);
 
-	offset  = 0;
-	isfound = false;
-
-	attr = list_head(rel->attributes);
-	while (attr != NULL) {
-		if (strcmp(attr->name, index->attr->name) == 0) {
-			DB_LOG_D("DB: Found attribute %s in %s\n", index->attr->name, rel->name);
-			isfound = true;
-			break;
-		}
-		offset += attr->element_size;
-		attr = attr->next;
-	}
+	cardinality = relation_cardinality(rel);
 
-	if (!isfound) {
-		DB_LOG_E("DB: Failed to find attribute %s in %s\n", index->attr->name, rel->name);
-		goto errout;
+	/* Collect the keys of all rows, so that the index can be built from
+	   the sorted keys. Without memory for them, insert the rows one by one. */
+	pairs = NULL;
+	if (cardinality > 0) {
+		pairs = (index_pair_t *)malloc(sizeof(index_pair_t) * cardinality);
 	}
 
-	cardinality = relation_cardinality(rel);
-
 	for (tuple_id = 0; tuple_id < cardinality; tuple_id++) {
 		memset(row, 0, sizeof(row));
 		DB_LOG_V("DB: Indexing Tuple id %d\n", tuple_id);
@@ -488,16 +956,24 @@ db_result_t db_indexing(relation_t *rel)
 			goto errout;
 		}
 
-		result = db_phy_to_value(&value, index->attr, row + offset);
+		if (pairs != NULL) {
+			pairs[tuple_id].tuple_id = tuple_id;
+			result = index_get_row_key(index, row, &pairs[tuple_id].key);
+		} else {
+			result = index_insert_row(index, row, tuple_id);
+		}
 		if (DB_ERROR(result)) {
-			DB_LOG_E("DB: Failed to get value from row\n");
+			DB_LOG_E("DB: Failed to get a row in relation %s!\n", rel->name);
 			goto errout;
 		}
+	}
 
-		if (DB_ERROR(index_insert(index, &value, tuple_id))) {
-			DB_LOG_E("DB: Failed to get a row in relation %s!\n", rel->name);
+	if (pairs != NULL) {
+		if (DB_ERROR(index_insert_batch(index, pairs, cardinality))) {
+			DB_LOG_E("DB: Failed to insert the keys of relation %s!\n", rel->name);
 			goto errout;
 		}
+		free(pairs);
 	}
 
 	free(row);
@@ -506,6 +982,9 @@ db_result_t db_indexing(relation_t *rel)
 	return DB_OK;
 
 errout:
+	if (pairs != NULL) {
+		free(pairs);
+	}
 	if (row != NULL) {
 		free(row);
 	}
@@ -112,6 +112,15 @@ static void get_operand(lvm_instance_t *p, operand_t *operand)
 {
 	memcpy(operand, &p->code[p->ip], sizeof(*operand));
 	p->ip += sizeof(*operand);
+
+	/* A string literal follows its operand in the code, and the operand
+	   holds the length of the string including the terminating NUL. */
+	if (operand->type == LVM_STRING) {
+		lvm_ip_t length = (lvm_ip_t)operand->value.l;
+
+		operand->value.s = (const char *)&p->code[p->ip];
+		p->ip += length;
+	}
 }
 
 static node_type_t get_type(lvm_instance_t *p)
@@ -141,6 +150,21 @@ static long operand_to_long(lvm_instance_t *p, operand_t *operand)
 	}
 }
 
+static const char *operand_to_string(lvm_instance_t *p, operand_t *operand)
+{
+	switch (operand->type) {
+	case LVM_STRING:
+		return operand->value.s;
+	case LVM_VARIABLE:
+		if (p->variables[operand->value.id].type == LVM_STRING) {
+			return p->variables[operand->value.id].value.s;
+		}
+		return NULL;
+	default:
+		return NULL;
+	}
+}
+
 static lvm_status_t eval_expr(lvm_instance_t *p, operator_t op, operand_t *result)
 {
 	int i;
@@ -167,6 +191,9 @@ static lvm_status_t eval_expr(lvm_instance_t *p, operator_t op, operand_t *resul
 		default:
 			return SEMANTIC_ERROR;
 		}
+		if (operand_to_string(p, &operand[i]) != NULL) {
+			return TYPE_ERROR;
+		}
 		value[i] = operand_to_long(p, &operand[i]);
 	}
 
@@ -202,6 +229,7 @@ static int eval_logic(lvm_instance_t *p, operator_t *op)
 	int r;
 	operand_t operand;
 	long result[2];
+	const char *string[2];
 	node_type_t type;
 	operator_t *operator;
 	long l1, l2;
@@ -248,6 +276,16 @@ static int eval_logic(lvm_instance_t *p, operator_t *op)
 			return SEMANTIC_ERROR;
 		}
 		result[i] = operand_to_long(p, &operand);
+		string[i] = operand_to_string(p, &operand);
+	}
+
+	if (string[0] != NULL || string[1] != NULL) {
+		/* Strings can only be compared with strings. */
+		if (string[0] == NULL || string[1] == NULL) {
+			return TYPE_ERROR;
+		}
+		result[0] = strcmp(string[0], string[1]);
+		result[1] = 0;
 	}
 
 	l1 = result[0];
@@ -274,6 +312,11 @@ static int eval_logic(lvm_instance_t *p, operator_t *op)
 	return EXECUTION_ERROR;
 }
 
+void lvm_clone(lvm_instance_t *dst, lvm_instance_t *src)
+{
+	memcpy(dst, src, sizeof(*dst));
+}
+
 void lvm_reset(lvm_instance_t *p)
 {
 	p->end = 0;
@@ -372,6 +415,11 @@ lvm_status_t lvm_execute(lvm_instance_t *p)
 
 void lvm_set_op(lvm_instance_t *p, operator_t op)
 {
+	if (p->end + sizeof(node_type_t) + sizeof(op) > DB_VM_BYTECODE_SIZE) {
+		p->error = __LINE__;
+		return;
+	}
+
 	lvm_set_type(p, LVM_ARITH_OP);
 	memcpy(&p->code[p->end], &op, sizeof(op));
 	p->end += sizeof(op);
@@ -379,6 +427,11 @@ void lvm_set_op(lvm_instance_t *p, operator_t op)
 
 void lvm_set_relation(lvm_instance_t *p, operator_t op)
 {
+	if (p->end + sizeof(node_type_t) + sizeof(op) > DB_VM_BYTECODE_SIZE) {
+		p->error = __LINE__;
+		return;
+	}
+
 	lvm_set_type(p, LVM_CMP_OP);
 	memcpy(&p->code[p->end], &op, sizeof(op));
 	p->end += sizeof(op);
@@ -386,6 +439,11 @@ void lvm_set_relation(lvm_instance_t *p, operator_t op)
 
 void lvm_set_operand(lvm_instance_t *p, operand_t *op)
 {
+	if (p->end + sizeof(node_type_t) + sizeof(*op) > DB_VM_BYTECODE_SIZE) {
+		p->error = __LINE__;
+		return;
+	}
+
 	lvm_set_type(p, LVM_OPERAND);
 	memcpy(&p->code[p->end], op, sizeof(*op));
 	p->end += sizeof(*op);
@@ -394,12 +452,20 @@ void lvm_set_operand(lvm_instance_t *p, operand_t *op)
 void lvm_set_operand_value(lvm_instance_t *p, attribute_t *attr, unsigned char *value)
 {
 	operand_value_t operand_value;
+	variable_id_t id;
 
 	/* Update the internal state of the PLE. */
 	if (attr->domain == DOMAIN_INT) {
 		operand_value.l = value[0] << 8 | value[1];
 	} else if (attr->domain == DOMAIN_LONG) {
 		operand_value.l = (uint32_t)value[0] << 24 | (uint32_t)value[1] << 16 | (uint32_t)value[2] << 8 | value[3];
+	} else if (attr->domain == DOMAIN_STRING) {
+		/* The variable refers to the NUL-terminated string in the row. */
+		id = lookup(p, attr->name);
+		if (id < LVM_MAX_VARIABLE_ID) {
+			p->variables[id].type = LVM_STRING;
+		}
+		operand_value.s = (const char *)value;
 	}
 
 	lvm_set_variable_value(p, attr->name, operand_value);
@@ -415,6 +481,129 @@ void lvm_set_long(lvm_instance_t *p, long l)
 	lvm_set_operand(p, &op);
 }
 
+void lvm_set_string(lvm_instance_t *p, const char *s)
+{
+	operand_t op;
+	size_t length;
+
+	length = strlen(s) + 1;
+	if (p->end + sizeof(node_type_t) + sizeof(op) + length > DB_VM_BYTECODE_SIZE) {
+		p->error = __LINE__;
+		return;
+	}
+
+	op.type = LVM_STRING;
+	op.value.l = (long)length;
+
+	lvm_set_operand(p, &op);
+	memcpy(&p->code[p->end], s, length);
+	p->end += length;
+}
+
+/* A placeholder for the value of parameter n, see lvm_bind_parameters(). */
+void lvm_set_parameter(lvm_instance_t *p, uint8_t n)
+{
+	operand_t op;
+
+	op.type = LVM_PARAMETER;
+	op.value.l = n;
+
+	lvm_set_operand(p, &op);
+}
+
+/*
+ * Copy src to dst and replace each parameter in the code by the operand
+ * values[n], which is a long or a string. A string takes more code than
+ * the placeholder, so the code is copied node by node instead of being
+ * patched in place.
+ */
+lvm_status_t lvm_bind_parameters(lvm_instance_t *dst, lvm_instance_t *src, operand_t *values, int count)
+{
+	operand_t operand;
+	lvm_ip_t ip;
+	lvm_ip_t next;
+
+	lvm_clone(dst, src);
+	dst->end = 0;
+
+	for (ip = 0; ip < src->end; ip = next) {
+		next = ip + sizeof(node_type_t);
+		switch (*(node_type_t *)(src->code + ip)) {
+		case LVM_CMP_OP:
+		case LVM_ARITH_OP:
+			next += sizeof(operator_t);
+			break;
+		case LVM_OPERAND:
+			memcpy(&operand, src->code + next, sizeof(operand));
+			next += sizeof(operand);
+			if (operand.type == LVM_STRING) {
+				next += (lvm_ip_t)operand.value.l;
+			} else if (operand.type == LVM_PARAMETER) {
+				if (operand.value.l >= count) {
+					return SEMANTIC_ERROR;
+				}
+				if (values[operand.value.l].type == LVM_STRING) {
+					lvm_set_string(dst, values[operand.value.l].value.s);
+				} else {
+					lvm_set_operand(dst, &values[operand.value.l]);
+				}
+				if (dst->error != 0) {
+					return STACK_OVERFLOW;
+				}
+				continue;
+			}
+			break;
+		default:
+			return EXECUTION_ERROR;
+		}
+
+		if (dst->end + (next - ip) > DB_VM_BYTECODE_SIZE) {
+			return STACK_OVERFLOW;
+		}
+		memcpy(dst->code + dst->end, src->code + ip, next - ip);
+		dst->end += next - ip;
+	}
+
+	return LVM_TRUE;
+}
+
+lvm_ip_t lvm_copy_code(lvm_instance_t *p, lvm_ip_t start, lvm_ip_t end)
+{
+	lvm_ip_t old_end;
+
+	old_end = p->end;
+	if (start > end || end > old_end || old_end + (end - start) > DB_VM_BYTECODE_SIZE) {
+		p->error = __LINE__;
+		return old_end;
+	}
+
+	memcpy(&p->code[old_end], &p->code[start], end - start);
+	p->end += end - start;
+
+	return old_end;
+}
+
+/*
+ * Map a string to a number whose order is the order of the first four
+ * characters of the string. Strings that share this prefix get the same
+ * number, so the number can only bound a range of strings.
+ */
+long lvm_string_to_long(const char *s)
+{
+	uint32_t prefix;
+	int i;
+
+	prefix = 0;
+	for (i = 0; i < sizeof(prefix); i++) {
+		prefix <<= 8;
+		if (*s != '\0') {
+			prefix |= (unsigned char)*s++;
+		}
+	}
+
+	return (long)(int32_t)(prefix ^ 0x80000000);
+}
+
 lvm_status_t lvm_register_variable(lvm_instance_t *p, char *name, operand_type_t type)
 {
 	variable_id_t id;
@@ -536,7 +725,9 @@ static int derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
 	int i;
 	int variable_id;
 	operand_value_t *value;
+	operand_value_t prefix;
 	derivation_t *derivation;
+	uint8_t strict;
 
 	type = get_type(p);
 	operator = get_operator(p);
@@ -605,6 +796,15 @@ static int derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
 		return DERIVATION_ERROR;
 	}
 
+	/* A string only bounds the range by its prefix, so a strict
+	   comparison cannot exclude the prefix itself. */
+	strict = 1;
+	if (operand[0].type == LVM_STRING || operand[1].type == LVM_STRING) {
+		prefix.l = lvm_string_to_long(value->s);
+		value = &prefix;
+		strict = 0;
+	}
+
 	DB_LOG_D("variable id %d, value %ld\n", variable_id, *(long *)value);
 
 	derivation = local_derivations + variable_id;
@@ -618,13 +818,13 @@ static int derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
 		derivation->min = *value;
 		break;
 	case LVM_GE:
-		derivation->min.l = value->l + 1;
+		derivation->min.l = value->l + strict;
 		break;
 	case LVM_GEQ:
 		derivation->min.l = value->l;
 		break;
 	case LVM_LE:
-		derivation->max.l = value->l - 1;
+		derivation->max.l = value->l - strict;
 		break;
 	case LVM_LEQ:
 		derivation->max.l = value->l;
@@ -715,6 +915,12 @@ static lvm_ip_t print_operand(lvm_instance_t *p, lvm_ip_t index)
 	case LVM_LONG:
 		DB_LOG_D("long:%ld ", operand.value.l);
 		break;
+	case LVM_STRING:
+		DB_LOG_D("string:'%s' ", (char *)p->code + index + sizeof(operand_t));
+		return index + sizeof(operand_t) + operand.value.l;
+	case LVM_PARAMETER:
+		DB_LOG_D("param:%ld ", operand.value.l);
+		break;
 	default:
 		DB_LOG_D("?? ");
 		break;
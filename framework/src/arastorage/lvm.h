@@ -118,13 +118,16 @@ typedef enum lvm_operator_e operator_t;
 enum operand_type_e {
 	LVM_VARIABLE,
 	LVM_FLOAT,
-	LVM_LONG
+	LVM_LONG,
+	LVM_STRING,
+	LVM_PARAMETER
 };
 typedef enum operand_type_e operand_type_t;
 
 union operand_value_u {
 	long l;
 	double d;
+	const char *s;
 #if LVM_USE_FLOATS
 	float f;
 #endif
@@ -183,6 +186,11 @@ void lvm_set_relation(lvm_instance_t *p, operator_t op);
 void lvm_set_operand(lvm_instance_t *p, operand_t *op);
 void lvm_set_operand_value(lvm_instance_t *p, attribute_t *attr, unsigned char *value);
 void lvm_set_long(lvm_instance_t *p, long l);
+void lvm_set_string(lvm_instance_t *p, const char *s);
+void lvm_set_parameter(lvm_instance_t *p, uint8_t n);
+lvm_status_t lvm_bind_parameters(lvm_instance_t *dst, lvm_instance_t *src, operand_t *values, int count);
+lvm_ip_t lvm_copy_code(lvm_instance_t *p, lvm_ip_t start, lvm_ip_t end);
+long lvm_string_to_long(const char *s);
 void lvm_set_variable(lvm_instance_t *p, char *name);
 
 #endif							/* LVM_H */
@@ -68,6 +68,7 @@
 #include "memb.h"
 #include "aql.h"
 #include "relation.h"
+#include "rw_locks.h"
 
 /****************************************************************************
 * Global Function Prototypes
@@ -85,6 +86,7 @@ static void purge_relations(void);
 static void relation_clear(relation_t *);
 static relation_t *relation_allocate(void);
 static void relation_free(relation_t *);
+static db_result_t relation_drop(relation_t *);
 
 /****************************************************************************
 * Public Functions
@@ -149,7 +151,7 @@ static void purge_relations(void)
 
 	while (rel != NULL) {
 		next = rel->next;
-		if (rel->references == 0) {
+		if (rel->references == 0 && rel->snapshots == 0) {
 			relation_free(rel);
 		}
 		rel = next;
@@ -198,6 +200,20 @@ static void relation_free(relation_t *rel)
 	memb_free(&relations_memb, rel);
 }
 
+/* Remove a temporary relation, which is neither loaded nor read by a cursor. */
+static db_result_t relation_drop(relation_t *rel)
+{
+	db_result_t result;
+
+	DB_LOG_D("DB: Drop temporary relation %s\n", rel->name);
+	result = storage_remove(rel->tuple_filename);
+	if (DB_ERROR(storage_remove(rel->name))) {
+		result = DB_STORAGE_ERROR;
+	}
+	relation_free(rel);
+	return result;
+}
+
 db_result_t relation_init(void)
 {
 	list_init(relations);
@@ -272,15 +288,50 @@ db_result_t relation_release(relation_t *rel)
 		if (DB_ERROR(res)) {
 			return res;
 		}
+		if (rel->dir == DB_MEMORY) {
+			/* A result relation belongs to a single query. */
+			relation_free(rel);
+		} else if ((rel->flags & RELATION_FLAG_TEMPORARY) && rel->snapshots == 0) {
+			return relation_drop(rel);
+		}
 	}
 	return DB_OK;
 }
 
+/* Called when a cursor does not read the snapshot of rel any more. */
+void relation_snapshot_close(relation_t *rel)
+{
+	if (rel->snapshots > 0) {
+		rel->snapshots--;
+	}
+
+	if ((rel->flags & RELATION_FLAG_TEMPORARY) && rel->references == 0 && rel->snapshots == 0) {
+		relation_drop(rel);
+	}
+}
+
 relation_t *relation_create(char *name, db_direction_t dir)
 {
 	relation_t old_rel;
 	relation_t *rel;
 	if (*name != '\0') {
+		if (dir == DB_MEMORY) {
+			/* A relation in memory is private to its creator, so queries
+			   running at the same time do not share their results.  It is
+			   not added to the list of relations, and it is freed when the
+			   creator releases it. */
+			rel = relation_allocate();
+			if (rel == NULL) {
+				return NULL;
+			}
+			rel->cardinality = 0;
+			strncpy(rel->name, name, sizeof(rel->name) - 1);
+			rel->name[sizeof(rel->name) - 1] = '\0';
+			rel->dir = dir;
+			rel->references = 1;
+			return rel;
+		}
+
 		relation_clear(&old_rel);
 
 		if (storage_get_relation(&old_rel, name) == DB_OK) {
@@ -299,21 +350,55 @@ relation_t *relation_create(char *name, db_direction_t dir)
 
 		rel->name[sizeof(rel->name) - 1] = '\0';
 		rel->dir = dir;
-		if (dir == DB_STORAGE) {
-			storage_drop_relation(rel, 1);
-			if (storage_put_relation(rel) == DB_OK) {
-				list_add(relations, rel);
-				return rel;
-			}
-			memb_free(&relations_memb, rel);
-		} else {
+		storage_drop_relation(rel, 1);
+		if (storage_put_relation(rel) == DB_OK) {
 			list_add(relations, rel);
 			return rel;
 		}
+		memb_free(&relations_memb, rel);
 	}
 	return NULL;
 }
 
+/*
+ * Create a relation for the rows which an operator of a query produces.
+ * It is stored like any other relation, so that it is selected from as
+ * one, and it is removed when it is released and no cursor reads it.
+ */
+relation_t *relation_create_temporary(void)
+{
+	static uint8_t temporary_id;
+	char name[RELATION_NAME_LENGTH + 1];
+	relation_t *rel;
+	int i;
+
+	for (i = 0; i < DB_RELATION_POOL_SIZE; i++) {
+		snprintf(name, sizeof(name), "%s%x", TEMP_RELATION, (unsigned)(temporary_id++ % DB_RELATION_POOL_SIZE));
+		if (relation_find(name) != NULL) {
+			/* Read by the cursor of another query */
+			continue;
+		}
+
+		/* The relation may be left over from a query which was running
+		   when the system stopped. */
+		if (DB_ERROR(relation_remove(name, 1))) {
+			continue;
+		}
+
+		if (relation_create(name, DB_STORAGE) == NULL) {
+			return NULL;
+		}
+		rel = relation_load(name);
+		if (rel != NULL) {
+			rel->flags |= RELATION_FLAG_TEMPORARY;
+		}
+		return rel;
+	}
+
+	DB_LOG_E("DB: No temporary relation is available\n");
+	return NULL;
+}
+
 db_result_t relation_rename(char *old_name, char *new_name)
 {
 
@@ -341,6 +426,12 @@ attribute_t *relation_attribute_add(relation_t *rel, db_direction_t dir, char *n
 	}
 
 	attribute = memb_alloc(&attributes_memb);
+	if (attribute == NULL) {
+		/* The attributes of relations which are not used any more, such as
+		   the relations of a join, are freed. */
+		purge_relations();
+		attribute = memb_alloc(&attributes_memb);
+	}
 	if (attribute == NULL) {
 		DB_LOG_E("DB: Failed to allocate attribute \"%s\"!\n", name);
 		return NULL;
@@ -420,6 +511,7 @@ db_result_t relation_set_primary_key(relation_t *rel, char *name)
 db_result_t relation_remove(char *name, int remove_tuples)
 {
 	relation_t *rel;
+	attribute_t *attr;
 	db_result_t result;
 
 	rel = relation_load(name);
@@ -432,9 +524,21 @@ db_result_t relation_remove(char *name, int remove_tuples)
 		return DB_OK;
 	}
 
-	if (rel->references > 1) {
+	/* The relation is still used by another query or read by a cursor. */
+	if (rel->references > 1 || rel->snapshots > 0) {
+		relation_release(rel);
 		return DB_BUSY_ERROR;
 	}
+
+	/* The indexes go with the relation, or a new relation of the same
+	   name would load them again. */
+	for (attr = list_head(rel->attributes); attr != NULL; attr = attr->next) {
+		index_load(rel, attr);
+		if (attr->index != NULL && DB_ERROR(index_destroy(attr->index))) {
+			relation_release(rel);
+			return DB_INDEX_ERROR;
+		}
+	}
 #ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
 	/* Flush insert buffer to make sure of writing tuples before removing relation */
 	if (DB_SUCCESS(storage_flush_insert_buffer())) {
@@ -505,20 +609,193 @@ db_result_t relation_insert(relation_t *rel, attribute_value_t *values)
 			index_load(rel, attr);
 		}
 		ptr += attr->element_size;
-		if (attr->index != NULL) {
-			if (DB_ERROR(index_insert(attr->index, value, rel->next_row))) {
-				return DB_INDEX_ERROR;
-			}
-		}
 		attr = attr->next;
 		value++;
 	}
 
 	DB_LOG_V(")\n");
 
+	/* The key of a composite index is taken from several attributes,
+	   so the indexes are updated once the whole record is built. */
+	for (attr = list_head(rel->attributes); attr != NULL; attr = attr->next) {
+		if (attr->index != NULL && !(attr->flags & ATTRIBUTE_FLAG_INVALID)) {
+			if (DB_ERROR(index_insert_row(attr->index, record, rel->next_row))) {
+				return DB_INDEX_ERROR;
+			}
+		}
+	}
+
 	return storage_put_row(rel, record, FALSE);
 }
 
+/*
+ * Insert tuples which are given column by column. The rows are built in a
+ * buffer of DB_BATCH_BUFFER_SIZE bytes which is appended to the tuple file
+ * when it is full, and the keys of the rows are collected so that each
+ * index is updated once, with sorted keys, at the end of the batch.
+ */
+db_result_t relation_insert_batch(relation_t *rel, db_column_t *columns, uint8_t column_count, tuple_id_t count)
+{
+	attribute_t *attr;
+	attribute_value_t value;
+	db_column_t *column;
+	index_t *indexes[DB_MAX_ATTRIBUTES_PER_RELATION];
+	index_pair_t *pairs[DB_MAX_ATTRIBUTES_PER_RELATION];
+	unsigned char *buffer;
+	unsigned char *ptr;
+	const char *string;
+	tuple_id_t first;
+	tuple_id_t stored;
+	tuple_id_t buffered;
+	tuple_id_t chunk;
+	tuple_id_t row;
+	db_result_t result;
+	uint8_t index_count;
+	uint8_t i;
+
+	if (column_count != rel->attribute_count) {
+		DB_LOG_E("DB: %u columns given for the %u attributes of %s\n", column_count, rel->attribute_count, rel->name);
+		return DB_ARGUMENT_ERROR;
+	}
+
+	/* Verify the domains of all columns before anything is stored. As with
+	   relation_insert(), INT may be promoted to LONG. */
+	index_count = 0;
+	column = columns;
+	for (attr = list_head(rel->attributes); attr != NULL; attr = attr->next, column++) {
+		if (column->values == NULL) {
+			return DB_ARGUMENT_ERROR;
+		}
+		if (attr->domain != column->domain && !(attr->domain == DOMAIN_LONG && column->domain == DOMAIN_INT)) {
+			DB_LOG_E("DB: The value domain %d does not match the domain %d of attribute %s\n", column->domain, attr->domain, attr->name);
+			return DB_RELATIONAL_ERROR;
+		}
+		if (attr->index == NULL) {
+			index_load(rel, attr);
+		}
+		if (attr->index != NULL && !(attr->flags & ATTRIBUTE_FLAG_INVALID)) {
+			indexes[index_count++] = attr->index;
+		}
+	}
+
+	if (count == 0) {
+		return DB_OK;
+	}
+
+	first = relation_cardinality(rel);
+	if (first == INVALID_TUPLE) {
+		return DB_STORAGE_ERROR;
+	}
+	if (first + count > DB_TUPLE_LIMIT) {
+		return DB_LIMIT_ERROR;
+	}
+
+	chunk = DB_BATCH_BUFFER_SIZE / rel->row_length;
+	if (chunk == 0) {
+		chunk = 1;
+	}
+	if (chunk > count) {
+		chunk = count;
+	}
+
+	buffer = (unsigned char *)malloc(chunk * rel->row_length);
+	for (i = 0; i < index_count; i++) {
+		pairs[i] = (index_pair_t *)malloc(sizeof(index_pair_t) * count);
+		if (pairs[i] == NULL) {
+			break;
+		}
+	}
+	if (buffer == NULL || i < index_count) {
+		DB_LOG_E("DB: Failed to allocate a batch of %lu rows\n", (unsigned long)count);
+		while (i > 0) {
+			free(pairs[--i]);
+		}
+		if (buffer != NULL) {
+			free(buffer);
+		}
+		return DB_ALLOCATION_ERROR;
+	}
+
+	result = DB_OK;
+	stored = 0;
+	buffered = 0;
+	for (row = 0; row < count; row++) {
+		ptr = buffer + buffered * rel->row_length;
+		column = columns;
+		for (attr = list_head(rel->attributes); attr != NULL; attr = attr->next, column++) {
+			if (attr->flags & ATTRIBUTE_FLAG_INVALID) {
+				memset(ptr, 0, attr->element_size);
+			} else if (attr->domain == DOMAIN_STRING) {
+				/* The strings of a column may be shorter than the attribute */
+				string = ((char * const *)column->values)[row];
+				memset(ptr, 0, attr->element_size);
+				if (string != NULL) {
+					strncpy((char *)ptr, string, attr->element_size - 1);
+				}
+			} else {
+				value.domain = attr->domain;
+				if (column->domain == DOMAIN_INT) {
+					if (attr->domain == DOMAIN_INT) {
+						VALUE_INT(&value) = ((const int *)column->values)[row];
+					} else {
+						VALUE_LONG(&value) = ((const int *)column->values)[row];
+					}
+				} else {
+					VALUE_LONG(&value) = ((const long *)column->values)[row];
+				}
+				result = db_value_to_phy(ptr, attr, &value);
+				if (DB_ERROR(result)) {
+					break;
+				}
+			}
+			ptr += attr->element_size;
+		}
+		if (DB_ERROR(result)) {
+			break;
+		}
+
+		ptr = buffer + buffered * rel->row_length;
+		for (i = 0; i < index_count; i++) {
+			pairs[i][row].tuple_id = first + row;
+			if (DB_ERROR(index_get_row_key(indexes[i], ptr, &pairs[i][row].key))) {
+				result = DB_INDEX_ERROR;
+				break;
+			}
+		}
+		if (DB_ERROR(result)) {
+			break;
+		}
+
+		if (++buffered == chunk) {
+			result = storage_put_rows(rel, buffer, buffered);
+			if (DB_ERROR(result)) {
+				break;
+			}
+			stored += buffered;
+			buffered = 0;
+		}
+	}
+	if (DB_SUCCESS(result) && buffered > 0) {
+		result = storage_put_rows(rel, buffer, buffered);
+		if (DB_SUCCESS(result)) {
+			stored += buffered;
+		}
+	}
+	free(buffer);
+
+	/* Index the rows which have been stored, even if the batch failed */
+	for (i = 0; i < index_count; i++) {
+		if (DB_ERROR(index_insert_batch(indexes[i], pairs[i], stored)) && DB_SUCCESS(result)) {
+			result = DB_INDEX_ERROR;
+		}
+		free(pairs[i]);
+	}
+
+	DB_LOG_D("DB: Inserted %lu of %lu rows into %s\n", (unsigned long)stored, (unsigned long)count, rel->name);
+
+	return DB_ERROR(result) ? result : DB_OK;
+}
+
 /*
  * Update aggregation value whenever each tuple is read.
  */
@@ -616,43 +893,159 @@ static db_result_t generate_attribute_map(source_dest_map_t *attr_map, unsigned
 	return DB_OK;
 }
 
+/* Returns whether the key of an index holds every attribute that the query reads. */
+static int index_covers_query(db_handle_t *handle, index_t *index)
+{
+	source_dest_map_t *attr_map_ptr;
+	source_dest_map_t *attr_map_end;
+
+	if (!(index->api->flags & INDEX_API_KEYS) || INDEX_KEY_IS_PACKED(index)) {
+		return 0;
+	}
+
+	attr_map_end = handle->attr_map + handle->result_rel->attribute_count;
+	for (attr_map_ptr = handle->attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
+		if (strcmp(attr_map_ptr->from_attr->name, index->attr->name) != 0) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/* Estimate the rows and the cost of reading the key range of a plan from its index. */
+static void estimate_index_cost(db_handle_t *handle, db_plan_t *plan, tuple_id_t cardinality)
+{
+	unsigned long range;
+	unsigned long steps;
+	tuple_id_t n;
+
+	plan->index_only = index_covers_query(handle, plan->index);
+	plan->rows = index_estimate_rows(plan->index, plan->min, plan->max);
+	if (plan->rows == INVALID_TUPLE) {
+		/* Without statistics, every key in the range may be present. */
+		range = (unsigned long)plan->max - (unsigned long)plan->min;
+		plan->rows = range < cardinality ? range + 1 : cardinality;
+	}
+
+	if (plan->index->type == INDEX_INLINE) {
+		/* Two binary searches over the sorted tuples find the first and
+		   the last row of the range, which are then read in order. */
+		for (steps = 1, n = cardinality; n > 1; n >>= 1) {
+			steps++;
+		}
+		plan->cost = 2 * steps * DB_COST_ROW_FETCH + plan->rows * DB_COST_ROW_SCAN;
+	} else {
+		plan->cost = DB_COST_INDEX_LOOKUP + plan->rows * DB_COST_INDEX_KEY;
+		if (!plan->index_only) {
+			plan->cost += plan->rows * DB_COST_ROW_FETCH;
+		}
+	}
+}
+
+/* Keep an access path that was considered for the query, for EXPLAIN. */
+static void record_plan(db_handle_t *handle, db_plan_t *plan)
+{
+	if (handle->plans != NULL && handle->plan_count < DB_PLAN_LIMIT) {
+		handle->plans[handle->plan_count++] = *plan;
+	}
+}
+
+static void mark_chosen_plan(db_handle_t *handle, index_t *index)
+{
+	uint8_t i;
+
+	for (i = 0; handle->plans != NULL && i < handle->plan_count; i++) {
+		handle->plans[i].chosen = handle->plans[i].index == index;
+	}
+}
+
 static void select_index(db_handle_t **handle)
 {
-	index_t *index;
+	index_t *candidate;
 	attribute_t *attr;
 	operand_value_t min;
 	operand_value_t max;
 	attribute_value_t av_min;
 	attribute_value_t av_max;
-	long range;
-	unsigned long min_range;
-	index = NULL;
-	min_range = ULONG_MAX;
+	long key_min[DB_MAX_INDEX_KEY_ATTRIBUTES];
+	long key_max[DB_MAX_INDEX_KEY_ATTRIBUTES];
+	tuple_id_t cardinality;
+	db_plan_t plan;
+	db_plan_t best;
+	uint8_t count;
 
-	/* Find all indexed and derived attributes, and select the index of
-	   the attribute with the smallest range. */
+	cardinality = relation_cardinality((*handle)->rel);
+	if (cardinality == INVALID_TUPLE) {
+		(*handle)->flags = DB_HANDLE_FLAG_INVALID;
+		return;
+	}
+
+	/* A full scan reads every row once. The removal of tuples reads all
+	   of them anyway, so it takes an index whenever there is one. */
+	memset(&best, 0, sizeof(best));
+	best.rows = cardinality;
+	best.cost = (unsigned long)cardinality * DB_COST_ROW_SCAN;
+	record_plan(*handle, &best);
+	if (AQL_GET_EXEC_TYPE((*handle)->optype) == AQL_TYPE_REMOVE_TUPLES) {
+		best.cost = ULONG_MAX;
+	}
+
+	/* Find all indexed and derived attributes, and select the access
+	   path with the smallest estimated cost. A composite index is used
+	   when its leading attribute is derived. */
 	attr = list_head((*handle)->rel->attributes);
 	while (attr != NULL) {
-		if (attr->index != NULL && !LVM_ERROR(lvm_get_derived_range((*handle)->lvm_instance, attr->name, &min, &max))) {
-			range = (unsigned long)max.l - (unsigned long)min.l;
-			DB_LOG_D("DB: The search range for attribute \"%s\" comprises %ld values\n", attr->name, range + 1);
-			if (range <= min_range) {
-				index = attr->index;
-				av_min.domain = av_max.domain = DOMAIN_INT;
-				VALUE_LONG(&av_min) = min.l;
-				VALUE_LONG(&av_max) = max.l;
+		candidate = attr->index;
+		if (candidate != NULL && !LVM_ERROR(lvm_get_derived_range((*handle)->lvm_instance, attr->name, &min, &max))) {
+			key_min[0] = min.l;
+			key_max[0] = max.l;
+			for (count = 1; count < candidate->key_count; count++) {
+				if (LVM_ERROR(lvm_get_derived_range((*handle)->lvm_instance, candidate->key_attributes[count - 1], &min, &max))) {
+					break;
+				}
+				key_min[count] = min.l;
+				key_max[count] = max.l;
+			}
+
+			if (DB_SUCCESS(index_get_key_range(candidate, key_min, key_max, count, &av_min, &av_max))) {
+				memset(&plan, 0, sizeof(plan));
+				plan.index = candidate;
+				plan.min = VALUE_LONG(&av_min);
+				plan.max = VALUE_LONG(&av_max);
+				estimate_index_cost(*handle, &plan, cardinality);
+				record_plan(*handle, &plan);
+				DB_LOG_D("DB: The index on \"%s\" reads about %lu rows at cost %lu\n", attr->name, (unsigned long)plan.rows, plan.cost);
+				if (plan.cost < best.cost) {
+					best = plan;
+				}
 			}
 		}
 		attr = attr->next;
 	}
 
-	if (index != NULL) {
-		/* We found a suitable index; get an iterator for it. */
-		if (index_get_iterator(&((*handle)->index_iterator), index, &av_min, &av_max) == DB_OK) {
-			(*handle)->flags |= DB_HANDLE_FLAG_SEARCH_INDEX;
-		}
-	} else {
+	if (best.index == NULL) {
+		mark_chosen_plan(*handle, NULL);
 		(*handle)->flags = DB_HANDLE_FLAG_INVALID;
+		return;
+	}
+
+	/* We found a suitable index; get an iterator for it. */
+	av_min.domain = av_max.domain = DOMAIN_LONG;
+	VALUE_LONG(&av_min) = best.min;
+	VALUE_LONG(&av_max) = best.max;
+	if (index_get_iterator(&((*handle)->index_iterator), best.index, &av_min, &av_max) != DB_OK) {
+		mark_chosen_plan(*handle, NULL);
+		return;
+	}
+	mark_chosen_plan(*handle, best.index);
+	(*handle)->flags |= DB_HANDLE_FLAG_SEARCH_INDEX;
+
+	/* When the index returns its keys, and the key holds every attribute
+	   that the query reads, the rows need not be read at all. */
+	if (best.index_only) {
+		DB_LOG_D("DB: The index on %s covers the query\n", best.index->attr->name);
+		(*handle)->flags |= DB_HANDLE_FLAG_INDEX_ONLY;
 	}
 }
 
@@ -712,7 +1105,9 @@ static db_result_t generate_selection_result(db_handle_t **handle, relation_t *r
 		return DB_IMPLEMENTATION_ERROR;
 	}
 
-	if ((*handle)->lvm_instance != NULL) {
+	/* A streaming cursor scans sequentially; an index iterator would have
+	   to be shared with other tasks between two reads of the cursor. */
+	if ((*handle)->lvm_instance != NULL && !((*handle)->flags & DB_HANDLE_FLAG_STREAM)) {
 		/* Try to establish acceptable ranges for the attribute values. */
 		if (!LVM_ERROR(lvm_derive((*handle)->lvm_instance))) {
 			select_index(handle);
@@ -782,6 +1177,11 @@ db_result_t relation_process_select(db_handle_t **handle, db_cursor_t *cursor)
 	attribute_count = (*handle)->result_rel->attribute_count;
 	attr_map_end = (*handle)->attr_map + attribute_count;
 
+	/* Stop reading tuples once LIMIT rows have been selected. */
+	if ((*handle)->limit > 0 && cursor->cursor_rows >= (*handle)->limit && !((*handle)->adt_flags & AQL_FLAG_AGGREGATE)) {
+		return DB_FINISHED;
+	}
+
 	if ((*handle)->flags & DB_HANDLE_FLAG_SEARCH_INDEX) {
 		(*handle)->tuple_id = index_get_next(&((*handle)->index_iterator), TRUE);
 		if ((*handle)->tuple_id == INVALID_TUPLE) {
@@ -799,15 +1199,32 @@ db_result_t relation_process_select(db_handle_t **handle, db_cursor_t *cursor)
 		(*handle)->tuple_id++;
 	}
 
-	row = (storage_row_t)malloc(sizeof(char) * (*handle)->rel->row_length + 1);
+	row = (storage_row_t)malloc(sizeof(char) * cursor->snapshot.row_length + 1);
 	if (row == NULL) {
 		DB_LOG_E("DB: Failed to allocate row\n");
 		return DB_ALLOCATION_ERROR;
 	}
 
-	/* Put the tuples fulfilling the- given condition into a new relation.
-	   The tuples may be projected. */
-	result = storage_get_row((*handle)->rel, &((*handle)->tuple_id), row);
+	if ((*handle)->flags & DB_HANDLE_FLAG_INDEX_ONLY) {
+		/* The query only reads the key of the index, so the row is
+		   rebuilt from the key instead of being read from storage. */
+		if ((*handle)->tuple_id >= cursor->snapshot.nrows) {
+			free(row);
+			return DB_OK;
+		}
+		from_attr = (*handle)->attr_map->from_attr;
+		value.domain = from_attr->domain;
+		if (from_attr->domain == DOMAIN_INT) {
+			VALUE_INT(&value) = (int)(*handle)->index_iterator.key;
+		} else {
+			VALUE_LONG(&value) = (*handle)->index_iterator.key;
+		}
+		result = db_value_to_phy(row + (*handle)->attr_map->from_offset, from_attr, &value);
+	} else {
+		/* Read the tuples from the snapshot of the cursor, so that rows which
+		   are inserted while the relation is scanned are not selected. */
+		result = storage_snapshot_get_row(&cursor->snapshot, (*handle)->tuple_id, row);
+	}
 	if (DB_ERROR(result)) {
 		DB_LOG_E("DB: Failed to get a row in relation %s!\n", (*handle)->rel->name);
 		goto errout;
@@ -826,7 +1243,7 @@ db_result_t relation_process_select(db_handle_t **handle, db_cursor_t *cursor)
 		from_ptr = row + attr_map_ptr->from_offset;
 		from_attr = attr_map_ptr->from_attr;
 
-		if (from_attr->domain == DOMAIN_INT || from_attr->domain == DOMAIN_LONG) {
+		if ((*handle)->lvm_instance != NULL && (from_attr->domain == DOMAIN_INT || from_attr->domain == DOMAIN_LONG || from_attr->domain == DOMAIN_STRING)) {
 			lvm_set_operand_value((*handle)->lvm_instance, from_attr, from_ptr);
 		}
 
@@ -952,7 +1369,7 @@ db_result_t relation_process_remove(db_handle_t **handle, db_cursor_t *cursor)
 		from_ptr = row + attr_map_ptr->from_offset;
 		from_attr = attr_map_ptr->from_attr;
 
-		if (from_attr->domain == DOMAIN_INT || from_attr->domain == DOMAIN_LONG) {
+		if ((*handle)->lvm_instance != NULL && (from_attr->domain == DOMAIN_INT || from_attr->domain == DOMAIN_LONG || from_attr->domain == DOMAIN_STRING)) {
 			lvm_set_operand_value((*handle)->lvm_instance, from_attr, from_ptr);
 		}
 
@@ -988,6 +1405,13 @@ db_result_t relation_process_remove(db_handle_t **handle, db_cursor_t *cursor)
 end_removal:
 	DB_LOG_E("DB: Finished removing tuples. Result relation has %d tuples\n", (*handle)->result_rel->cardinality);
 
+	/* Destory exsting index for old relation, before the rename frees
+	   the old relation and unloads its indexes. */
+	index = (*handle)->index_iterator.index;
+	if (index != NULL) {
+		index_destroy(index);
+	}
+
 	relation_release((*handle)->rel);
 
 	/* Rename the name of new relation to old relation */
@@ -998,10 +1422,7 @@ end_removal:
 	}
 	memcpy((*handle)->result_rel->name, (*handle)->rel->name, sizeof((*handle)->result_rel->name));
 
-	/* Destory exsting index for old relation */
-	index = (*handle)->index_iterator.index;
 	if (index != NULL) {
-		index_destroy(index);
 		relation_index_clear((*handle)->result_rel);
 	}
 
@@ -1052,7 +1473,7 @@ db_cursor_t *relation_process_result(db_handle_t *handler)
 	/* when SELECT, cursor row data is set in processing tuple by tuple.
 	   So we need to initialize cursor and make cursor data before processing tuples */
 	if (handler->optype == AQL_TYPE_SELECT) {
-		if (DB_ERROR(cursor_init(&cursor, handler->rel)) || DB_ERROR(cursor_data_set(cursor, handler->attr_map, handler->result_rel->attribute_count))) {
+		if (DB_ERROR(cursor_init(&cursor, handler->rel)) || DB_ERROR(cursor_data_set(cursor, handler->attr_map, handler->result_rel->attribute_count)) || DB_ERROR(cursor_snapshot_open(cursor, handler->rel))) {
 			DB_LOG_E("DB: Failed to init cursor and set cursor data\n");
 			cursor_deinit(cursor);
 			return NULL;
@@ -1064,25 +1485,81 @@ db_cursor_t *relation_process_result(db_handle_t *handler)
 		res = relation_process(&handler, cursor);
 		if (DB_ERROR(res)) {
 			DB_LOG_E("DB: Failed to process tuples : %d\n", res);
-			cursor_deinit(cursor);
-			return NULL;
+			break;
 		}
-		switch (res) {
-		case DB_FINISHED:
+		if (res == DB_FINISHED) {
 			DB_LOG_V("DB: Processing tuples is done!\n");
 			return cursor;
-		case DB_OK:
-			continue;
-		case DB_GOT_ROW:
-			break;
-		default:
+		}
+		if (res != DB_OK && res != DB_GOT_ROW) {
 			DB_LOG_E("[%d]\n", res);
-			break;
 		}
 	}
+
+	cursor_deinit(cursor);
 	return NULL;
 }
 
+/* Create a cursor which selects its tuples one at a time, when it is moved.
+   The cursor takes over the handle and frees it with the cursor. */
+db_cursor_t *relation_process_stream(db_handle_t *handler)
+{
+	db_cursor_t *cursor;
+
+	if (handler->optype != AQL_TYPE_SELECT) {
+		DB_LOG_E("DB: Only a selection can be streamed\n");
+		return NULL;
+	}
+
+	cursor = (db_cursor_t *)malloc(sizeof(db_cursor_t));
+	if (cursor == NULL) {
+		DB_LOG_E("DB: Failed to malloc cursor\n");
+		return NULL;
+	}
+	memset(cursor, 0, sizeof(db_cursor_t));
+	cursor_clean_data(cursor);
+
+	cursor->storage_row_length = handler->rel->row_length;
+	memcpy(cursor->name, handler->rel->tuple_filename, sizeof(handler->rel->tuple_filename));
+	memcpy(cursor->rel_name, handler->rel->name, sizeof(handler->rel->name));
+	cursor->total_rows = INVALID_TUPLE;
+
+	if (DB_ERROR(cursor_data_set(cursor, handler->attr_map, handler->result_rel->attribute_count)) || DB_ERROR(cursor_snapshot_open(cursor, handler->rel))) {
+		DB_LOG_E("DB: Failed to init cursor and set cursor data\n");
+		cursor_deinit(cursor);
+		return NULL;
+	}
+
+	cursor->handle = handler;
+	return cursor;
+}
+
+/* Select the next tuple of a streaming cursor. The caller holds the database lock. */
+db_result_t relation_process_next(db_cursor_t *cursor)
+{
+	db_result_t res;
+	db_handle_t *handle;
+	tuple_id_t rows;
+
+	handle = cursor->handle;
+	rows = cursor->cursor_rows;
+	while (db_processing_status(handle)) {
+		res = relation_process_select(&handle, cursor);
+		if (DB_ERROR(res)) {
+			DB_LOG_E("DB: Failed to process tuples : %d\n", res);
+			handle->flags &= ~DB_HANDLE_FLAG_PROCESSING;
+			return res;
+		}
+		if (res == DB_FINISHED) {
+			handle->flags &= ~DB_HANDLE_FLAG_PROCESSING;
+		}
+		if (cursor->cursor_rows != rows) {
+			return DB_OK;
+		}
+	}
+	return DB_FINISHED;
+}
+
 db_result_t relation_select(db_handle_t **handle, relation_t *rel, void *adt_ptr)
 {
 	aql_adt_t *adt;
@@ -1092,25 +1569,27 @@ db_result_t relation_select(db_handle_t **handle, relation_t *rel, void *adt_ptr
 	attribute_t *attr, *attr_ptr;
 	int i;
 	int normal_attributes = 0;
+	int aggregated_attributes = 0;
 	adt = (aql_adt_t *)adt_ptr;
 	(*handle)->rel = rel;
 	(*handle)->optype = AQL_GET_TYPE(adt);
 	DB_LOG_D("relation_select... optype = %d\n", (*handle)->optype);
 	(*handle)->adt_flags = AQL_GET_FLAGS(adt);
+	(*handle)->limit = AQL_GET_LIMIT(adt);
 	(*handle)->lvm_instance = (lvm_instance_t *)adt->lvm_instance;
 
 	if (AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
 		name = adt->relations[0];
 		dir = DB_STORAGE;
+		relation_remove(name, 1);
+		relation_create(name, dir);
+		(*handle)->result_rel = relation_load(name);
 	} else {
 		name = RESULT_RELATION;
 		dir = DB_MEMORY;
+		(*handle)->result_rel = relation_create(name, dir);
 	}
 
-	relation_remove(name, 1);
-	relation_create(name, dir);
-	(*handle)->result_rel = relation_load(name);
-
 	if ((*handle)->result_rel == NULL) {
 		DB_LOG_E("DB: Failed to load a relation for the query result\n");
 		return DB_ALLOCATION_ERROR;
@@ -1121,7 +1600,6 @@ db_result_t relation_select(db_handle_t **handle, relation_t *rel, void *adt_ptr
 		while (attr_ptr != NULL) {
 			if (attr_ptr->flags & ATTRIBUTE_FLAG_INVALID) {
 				DB_LOG_E("DB: Failed to add a result attribute\n");
-				relation_release((*handle)->result_rel);
 				return DB_ALLOCATION_ERROR;
 			} else {
 				index_load(rel, attr_ptr);
@@ -1130,7 +1608,6 @@ db_result_t relation_select(db_handle_t **handle, relation_t *rel, void *adt_ptr
 			attr = relation_attribute_add((*handle)->result_rel, dir, attr_ptr->name, attr_ptr->domain, attr_ptr->element_size);
 			if (attr == NULL) {
 				DB_LOG_E("DB: Failed to add a result attribute\n");
-				relation_release((*handle)->result_rel);
 				return DB_ALLOCATION_ERROR;
 			}
 			attr_ptr = attr_ptr->next;
@@ -1153,7 +1630,6 @@ db_result_t relation_select(db_handle_t **handle, relation_t *rel, void *adt_ptr
 
 			if (attr == NULL) {
 				DB_LOG_E("DB: Failed to add a result attribute\n");
-				relation_release((*handle)->result_rel);
 				return DB_ALLOCATION_ERROR;
 			}
 			attr->aggregator = adt->aggregators[i];
@@ -1166,20 +1642,24 @@ db_result_t relation_select(db_handle_t **handle, relation_t *rel, void *adt_ptr
 				break;
 			case AQL_MAX:
 				attr->aggregation_value = LONG_MIN;
+				aggregated_attributes++;
 				break;
 			case AQL_MIN:
 				attr->aggregation_value = LONG_MAX;
+				aggregated_attributes++;
 				break;
 			default:
 				attr->aggregation_value = 0;
+				aggregated_attributes++;
 				break;
 			}
 			attr->flags = adt->attributes[i].flags;
 		}
 	}
 	/* Preclude mixes of normal attributes and aggregated ones in
-	   selection results. */
-	if (normal_attributes > 0 && (*handle)->result_rel->attribute_count > normal_attributes) {
+	   selection results. Attributes which are only processed by the
+	   condition are neither. */
+	if (normal_attributes > 0 && aggregated_attributes > 0) {
 		return DB_RELATIONAL_ERROR;
 	}
 
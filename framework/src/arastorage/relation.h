@@ -96,10 +96,16 @@
 #define IS_INVALID_CURSOR_ROW(a) ((a) == NULL || ((a)->current_cursor_row >= (a)->cursor_rows))
 
 /* check current storage row is valid or invalid*/
-#define IS_INVALID_STORAGE_ROW(a) ((a) == NULL || ((a)->current_storage_row >= (a)->total_rows) || (a)->current_storage_row >= DB_CURSOR_RESULT_ENTRY)
+#define IS_INVALID_STORAGE_ROW(a) ((a) == NULL || ((a)->current_storage_row >= (a)->total_rows) || (!IS_STREAM_CURSOR(a) && (a)->current_storage_row >= DB_CURSOR_RESULT_ENTRY))
+
+/* Check cursor reads its rows on demand instead of from a bitmap */
+#define IS_STREAM_CURSOR(a) ((a)->handle != NULL)
 
 #define RELATION_HAS_TUPLES(rel) ((rel)->tuple_storage >= 0)
 
+/* The relation holds intermediate rows of a query, see relation_create_temporary() */
+#define RELATION_FLAG_TEMPORARY 0x01
+
 /* Specific API will return Below if cursor value is something wrong */
 #define INVALID_CURSOR_VALUE -1
 
@@ -133,12 +139,38 @@ struct relation_s {
 	db_storage_id_t tuple_storage;
 	db_direction_t dir;
 	uint8_t references;
+	uint8_t snapshots;
+	uint8_t flags;
 	char name[RELATION_NAME_LENGTH + 1];
 	char tuple_filename[TUPLE_NAME_LENGTH + 1];
 };
 
 typedef struct relation_s relation_t;
 
+/*
+ * A snapshot is a consistent view of the tuples of a relation.  Tuple files
+ * are append-only, so the view is the prefix of nrows rows that existed when
+ * the snapshot was taken, read through a descriptor of its own.
+ */
+struct db_snapshot_s {
+	char filename[TUPLE_NAME_LENGTH + 1];
+	db_storage_id_t fd;
+	tuple_id_t nrows;
+	size_t row_length;
+};
+typedef struct db_snapshot_s db_snapshot_t;
+
+/* How relation_join() joins two relations, for EXPLAIN. */
+struct db_join_plan_s {
+	relation_t *build;			/* The relation which is hashed in memory */
+	relation_t *probe;
+	tuple_id_t build_rows;
+	tuple_id_t probe_rows;
+	unsigned record_length;		/* The bytes of a hashed row */
+	uint8_t partitions;			/* 1 if the hashed rows fit in memory */
+};
+typedef struct db_join_plan_s db_join_plan_t;
+
 /* A structure for reading data from storage */
 struct cursor_data_map_s {
 	char name[ATTRIBUTE_NAME_LENGTH + 1];
@@ -158,6 +190,9 @@ struct _db_cursor_s {
 	attribute_id_t attribute_count;
 	size_t storage_row_length;
 	uint32_t *row_arr;
+	db_handle_t *handle;
+	relation_t *rel;
+	db_snapshot_t snapshot;
 	unsigned char tuple[DB_MAX_ELEMENT_SIZE + 1];
 	char name[TUPLE_NAME_LENGTH + 1];
 	char rel_name[RELATION_NAME_LENGTH + 1];
@@ -171,6 +206,8 @@ struct _db_cursor_s {
 db_result_t cursor_init(db_cursor_t **cursor, relation_t *rel);
 db_result_t cursor_load(db_cursor_t **target, db_cursor_t *src);
 db_result_t cursor_data_add(db_cursor_t *cursor, tuple_id_t tuple_id);
+db_result_t cursor_snapshot_open(db_cursor_t *cursor, relation_t *rel);
+void cursor_clean_data(db_cursor_t *cursor);
 db_result_t cursor_deinit(db_cursor_t *cursor);
 
 
@@ -179,10 +216,15 @@ db_result_t relation_init(void);
 db_result_t relation_deinit(void);
 db_result_t relation_process_remove(db_handle_t **, db_cursor_t *);
 db_result_t relation_process_select(db_handle_t **, db_cursor_t *);
+int db_processing_status(db_handle_t *);
 db_cursor_t *relation_process_result(db_handle_t *);
+db_cursor_t *relation_process_stream(db_handle_t *);
+db_result_t relation_process_next(db_cursor_t *);
 relation_t *relation_load(char *);
 db_result_t relation_release(relation_t *);
+void relation_snapshot_close(relation_t *);
 relation_t *relation_create(char *, db_direction_t);
+relation_t *relation_create_temporary(void);
 db_result_t relation_rename(char *, char *);
 attribute_t *relation_attribute_add(relation_t *, db_direction_t, char *, domain_t, size_t);
 attribute_t *relation_attribute_get(relation_t *, char *);
@@ -191,7 +233,13 @@ db_result_t relation_attribute_remove(relation_t *, char *);
 db_result_t relation_set_primary_key(relation_t *, char *);
 db_result_t relation_remove(char *, int);
 db_result_t relation_insert(relation_t *, attribute_value_t *);
+db_result_t relation_insert_batch(relation_t *, db_column_t *, uint8_t, tuple_id_t);
 db_result_t relation_select(db_handle_t **, relation_t *, void *);
 tuple_id_t relation_cardinality(relation_t *);
 
+/* Operators which store their result in a temporary relation. */
+relation_t *relation_join(relation_t *, relation_t *, void *);
+db_result_t relation_join_plan(relation_t *, relation_t *, void *, db_join_plan_t *);
+relation_t *relation_sort(db_cursor_t *, char *, int, tuple_id_t);
+
 #endif              /* RELATION_H */
@@ -0,0 +1,1086 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/**
+ * \file
+ *      Relational operators which store their result in a temporary
+ *      relation: the equi-join of JOIN and the sort of ORDER BY.
+ *
+ *      A join hashes the rows of the smaller relation in DB_JOIN_MEMORY
+ *      bytes and probes the table with the rows of the other relation.
+ *      When the smaller relation does not fit, both relations are first
+ *      partitioned by the hash of the join attribute into scratch files,
+ *      and each pair of partitions is joined on its own.  Rows which still
+ *      do not fit are hashed in parts, and the probe rows are read once
+ *      for each part.
+ *
+ *      A sort cuts its input into runs which fit in DB_SORT_MEMORY bytes,
+ *      sorts each run in memory and merges DB_SORT_FANIN runs at a time
+ *      until a single run is left.  With a LIMIT, a run and a merge keep
+ *      no more rows than the limit.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "db_options.h"
+#include "db_debug.h"
+#include "aql.h"
+#include "relation.h"
+#include "result.h"
+#include "storage.h"
+
+/****************************************************************************
+* Pre-processor Definitions
+****************************************************************************/
+#define JOIN_BUILD 0			/* The side which is hashed */
+#define JOIN_PROBE 1
+
+/* The record of a hashed row follows its entry */
+#define JOIN_RECORD(entry) ((unsigned char *)((entry) + 1))
+
+#define SCRATCH_NAME_LENGTH 8
+
+/****************************************************************************
+* Private Types
+****************************************************************************/
+/* Rows of a fixed length, which are read from offset to end of a file */
+struct block_reader_s {
+	db_storage_id_t fd;
+	unsigned char *buffer;
+	unsigned size;				/* a multiple of length */
+	unsigned length;
+	unsigned fill;
+	unsigned pos;
+	unsigned long begin;
+	unsigned long offset;		/* of the first row after the buffer */
+	unsigned long end;
+};
+
+struct block_writer_s {
+	db_storage_id_t fd;
+	unsigned char *buffer;
+	unsigned size;
+	unsigned fill;
+};
+
+/* A value of a joined row, which is taken from a row of one relation */
+struct join_column_s {
+	attribute_t *attr;
+	unsigned from_offset;
+	unsigned to_offset;
+};
+
+/* A relation of a join.  Its rows are hashed and partitioned as records,
+   which hold the key and then the values of the joined row. */
+struct join_side_s {
+	relation_t *rel;
+	attribute_t *key;
+	unsigned key_offset;
+	struct join_column_s columns[AQL_ATTRIBUTE_LIMIT];
+	uint8_t column_count;
+	unsigned record_length;
+};
+
+struct join_s {
+	struct join_side_s sides[2];
+	/* The attributes of a joined row in order */
+	attribute_t *attributes[AQL_ATTRIBUTE_LIMIT];
+	uint8_t attribute_count;
+	unsigned row_length;
+	/* Numbers are keyed as long, strings by their bytes up to the terminator */
+	unsigned key_length;
+	uint8_t string_key;
+	uint8_t partitions;
+	unsigned char *row;
+	unsigned char *record;		/* of a row which is read from a relation */
+	tuple_id_t rows;
+};
+
+struct join_entry_s {
+	struct join_entry_s *next;
+	uint32_t hash;
+};
+typedef struct join_entry_s join_entry_t;
+
+/* The key of the rows which sort_compare() compares.  A sort runs with the
+   database locked, so a single one is set at a time. */
+struct sort_key_s {
+	attribute_t attr;
+	unsigned offset;
+	int descending;
+};
+
+/****************************************************************************
+* Private Variables
+****************************************************************************/
+static struct sort_key_s g_sort_key;
+
+/****************************************************************************
+* Private Functions
+****************************************************************************/
+/* The size of a buffer for rows of length, which holds one row at least */
+static unsigned block_size(unsigned size, unsigned length)
+{
+	if (size < length) {
+		return length;
+	}
+	return size / length * length;
+}
+
+static void block_reader_init(struct block_reader_s *reader, db_storage_id_t fd, unsigned char *buffer, unsigned size, unsigned length, unsigned long begin, unsigned long end)
+{
+	reader->fd = fd;
+	reader->buffer = buffer;
+	reader->size = size / length * length;
+	reader->length = length;
+	reader->fill = 0;
+	reader->pos = 0;
+	reader->begin = begin;
+	reader->offset = begin;
+	reader->end = end;
+}
+
+static void block_rewind(struct block_reader_s *reader)
+{
+	reader->fill = 0;
+	reader->pos = 0;
+	reader->offset = reader->begin;
+}
+
+/* Point row to the next row in the buffer, DB_FINISHED after the last one */
+static db_result_t block_read(struct block_reader_s *reader, unsigned char **row)
+{
+	unsigned long length;
+	ssize_t r;
+
+	if (reader->pos + reader->length > reader->fill) {
+		if (reader->offset >= reader->end) {
+			return DB_FINISHED;
+		}
+		length = reader->end - reader->offset;
+		if (length > reader->size) {
+			length = reader->size;
+		}
+		if (storage_seek(reader->fd, reader->offset, SEEK_SET) == (off_t)-1) {
+			return DB_STORAGE_ERROR;
+		}
+		r = storage_read(reader->fd, reader->buffer, length);
+		if (r < 0) {
+			return DB_STORAGE_ERROR;
+		}
+		/* A row which is cut short at the end of the file is not read */
+		reader->fill = (unsigned)r / reader->length * reader->length;
+		reader->pos = 0;
+		reader->offset += reader->fill;
+		if (reader->fill == 0) {
+			reader->end = reader->offset;
+			return DB_FINISHED;
+		}
+	}
+
+	*row = reader->buffer + reader->pos;
+	reader->pos += reader->length;
+	return DB_OK;
+}
+
+static db_result_t block_flush(struct block_writer_s *writer)
+{
+	ssize_t r;
+
+	if (writer->fill == 0) {
+		return DB_OK;
+	}
+	r = storage_write(writer->fd, writer->buffer, writer->fill);
+	if (r < 0 || (unsigned)r != writer->fill) {
+		DB_LOG_E("DB: Failed to write %u bytes of rows\n", writer->fill);
+		return DB_STORAGE_ERROR;
+	}
+	writer->fill = 0;
+	return DB_OK;
+}
+
+static db_result_t block_write(struct block_writer_s *writer, const unsigned char *row, unsigned length)
+{
+	if (writer->fill + length > writer->size && DB_ERROR(block_flush(writer))) {
+		return DB_STORAGE_ERROR;
+	}
+	memcpy(writer->buffer + writer->fill, row, length);
+	writer->fill += length;
+	return DB_OK;
+}
+
+static int row_offset(relation_t *rel, attribute_t *attr)
+{
+	attribute_t *ptr;
+	int offset;
+
+	offset = 0;
+	for (ptr = list_head(rel->attributes); ptr != NULL; ptr = ptr->next) {
+		if (ptr == attr) {
+			return offset;
+		}
+		offset += ptr->element_size;
+	}
+	return -1;
+}
+
+static uint32_t join_hash(const unsigned char *key, unsigned length)
+{
+	uint32_t hash;
+
+	hash = 2166136261u;
+	while (length-- > 0) {
+		hash = (hash ^ *key++) * 16777619u;
+	}
+	return hash;
+}
+
+static db_result_t join_add_column(struct join_s *join, struct join_side_s *side, attribute_t *attr)
+{
+	struct join_column_s *column;
+	int offset;
+	int i;
+
+	for (i = 0; i < join->attribute_count; i++) {
+		if (strcmp(join->attributes[i]->name, attr->name) == 0) {
+			/* Such as the join attribute of both relations with SELECT ALL */
+			return DB_OK;
+		}
+	}
+
+	if (join->attribute_count == AQL_ATTRIBUTE_LIMIT) {
+		DB_LOG_E("DB: A joined row has more than %d attributes\n", AQL_ATTRIBUTE_LIMIT);
+		return DB_LIMIT_ERROR;
+	}
+
+	offset = row_offset(side->rel, attr);
+	if (offset < 0) {
+		return DB_IMPLEMENTATION_ERROR;
+	}
+
+	column = &side->columns[side->column_count++];
+	column->attr = attr;
+	column->from_offset = offset;
+	column->to_offset = join->row_length;
+	join->attributes[join->attribute_count++] = attr;
+	join->row_length += attr->element_size;
+	side->record_length += attr->element_size;
+
+	return DB_OK;
+}
+
+/* Find the join attributes, and the attributes of the query in the relations */
+static db_result_t join_init(struct join_s *join, relation_t *left, relation_t *right, aql_adt_t *adt)
+{
+	struct join_side_s *sides[2];
+	struct join_side_s *side;
+	attribute_t *attr;
+	db_result_t res;
+	unsigned length;
+	unsigned long memory;
+	int i;
+
+	memset(join, 0, sizeof(*join));
+
+	/* The smaller relation is hashed */
+	if (relation_cardinality(right) < relation_cardinality(left)) {
+		sides[0] = &join->sides[JOIN_PROBE];
+		sides[1] = &join->sides[JOIN_BUILD];
+	} else {
+		sides[0] = &join->sides[JOIN_BUILD];
+		sides[1] = &join->sides[JOIN_PROBE];
+	}
+	sides[0]->rel = left;
+	sides[1]->rel = right;
+
+	for (i = 0; i < 2; i++) {
+		side = sides[i];
+		side->key = relation_attribute_get(side->rel, adt->join_attributes[i]);
+		if (side->key == NULL) {
+			DB_LOG_E("DB: Join on invalid attribute %s in relation %s\n", adt->join_attributes[i], side->rel->name);
+			return DB_NAME_ERROR;
+		}
+		side->key_offset = row_offset(side->rel, side->key);
+	}
+
+	if (sides[0]->key->domain == DOMAIN_STRING && sides[1]->key->domain == DOMAIN_STRING) {
+		join->string_key = 1;
+		join->key_length = sides[0]->key->element_size > sides[1]->key->element_size ? sides[0]->key->element_size : sides[1]->key->element_size;
+	} else if ((sides[0]->key->domain == DOMAIN_INT || sides[0]->key->domain == DOMAIN_LONG) && (sides[1]->key->domain == DOMAIN_INT || sides[1]->key->domain == DOMAIN_LONG)) {
+		join->key_length = sizeof(long);
+	} else {
+		DB_LOG_E("DB: Join of %s and %s in different domains\n", sides[0]->key->name, sides[1]->key->name);
+		return DB_TYPE_ERROR;
+	}
+	sides[0]->record_length = join->key_length;
+	sides[1]->record_length = join->key_length;
+
+	res = DB_OK;
+	if (AQL_GET_FLAGS(adt) & AQL_FLAG_SELECT_ALL) {
+		for (i = 0; i < 2 && DB_SUCCESS(res); i++) {
+			for (attr = list_head(sides[i]->rel->attributes); attr != NULL && DB_SUCCESS(res); attr = attr->next) {
+				if (!(attr->flags & ATTRIBUTE_FLAG_INVALID)) {
+					res = join_add_column(join, sides[i], attr);
+				}
+			}
+		}
+	} else {
+		/* A name which is in both relations is taken from the first one */
+		for (i = 0; i < AQL_ATTRIBUTE_COUNT(adt) && DB_SUCCESS(res); i++) {
+			side = sides[0];
+			attr = relation_attribute_get(side->rel, adt->attributes[i].name);
+			if (attr == NULL) {
+				side = sides[1];
+				attr = relation_attribute_get(side->rel, adt->attributes[i].name);
+			}
+			if (attr == NULL) {
+				DB_LOG_E("DB: Select for invalid attribute %s in a join\n", adt->attributes[i].name);
+				return DB_NAME_ERROR;
+			}
+			res = join_add_column(join, side, attr);
+		}
+	}
+	if (DB_ERROR(res)) {
+		return res;
+	}
+
+	/* Partition the relations when the hashed rows do not fit in memory,
+	   and keep a buffer of rows for each partition. */
+	side = &join->sides[JOIN_BUILD];
+	length = (sizeof(join_entry_t) + side->record_length + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *) + sizeof(join_entry_t *);
+	memory = (unsigned long)relation_cardinality(side->rel) * length;
+	join->partitions = 1;
+	if (memory > DB_JOIN_MEMORY) {
+		join->partitions = memory / DB_JOIN_MEMORY + 1;
+		length = join->sides[JOIN_BUILD].record_length > join->sides[JOIN_PROBE].record_length ? join->sides[JOIN_BUILD].record_length : join->sides[JOIN_PROBE].record_length;
+		if (join->partitions > DB_JOIN_MEMORY / length) {
+			join->partitions = DB_JOIN_MEMORY / length;
+		}
+		if (join->partitions > DB_JOIN_PARTITIONS) {
+			join->partitions = DB_JOIN_PARTITIONS;
+		}
+		if (join->partitions < 1) {
+			join->partitions = 1;
+		}
+	}
+
+	return DB_OK;
+}
+
+static void join_key(struct join_s *join, struct join_side_s *side, unsigned char *row, unsigned char *key)
+{
+	attribute_value_t value;
+	long long_value;
+	unsigned char *ptr;
+	unsigned i;
+
+	memset(key, 0, join->key_length);
+	ptr = row + side->key_offset;
+	if (join->string_key) {
+		for (i = 0; i < side->key->element_size && ptr[i] != '\0'; i++) {
+			key[i] = ptr[i];
+		}
+		return;
+	}
+
+	/* An INT and a LONG which are equal have the same key */
+	db_phy_to_value(&value, side->key, ptr);
+	long_value = db_value_to_long(&value);
+	memcpy(key, &long_value, sizeof(long_value));
+}
+
+/* The next record of a side, which is converted from a row of the relation
+   unless it is read from a partition. */
+static db_result_t join_next(struct join_s *join, struct join_side_s *side, struct block_reader_s *reader, int records, unsigned char **record)
+{
+	struct join_column_s *column;
+	unsigned char *row;
+	unsigned char *ptr;
+	db_result_t res;
+	int i;
+
+	res = block_read(reader, &row);
+	if (res != DB_OK) {
+		return res;
+	}
+	if (records) {
+		*record = row;
+		return DB_OK;
+	}
+
+	ptr = join->record;
+	join_key(join, side, row, ptr);
+	ptr += join->key_length;
+	for (i = 0; i < side->column_count; i++) {
+		column = &side->columns[i];
+		memcpy(ptr, row + column->from_offset, column->attr->element_size);
+		ptr += column->attr->element_size;
+	}
+	*record = join->record;
+	return DB_OK;
+}
+
+static db_result_t join_emit(struct join_s *join, struct block_writer_s *out, unsigned char *build, unsigned char *probe)
+{
+	struct join_side_s *side;
+	struct join_column_s *column;
+	unsigned char *ptr;
+	int i;
+	int j;
+
+	for (i = 0; i < 2; i++) {
+		side = &join->sides[i];
+		ptr = (i == JOIN_BUILD ? build : probe) + join->key_length;
+		for (j = 0; j < side->column_count; j++) {
+			column = &side->columns[j];
+			memcpy(join->row + column->to_offset, ptr, column->attr->element_size);
+			ptr += column->attr->element_size;
+		}
+	}
+
+	join->rows++;
+	return block_write(out, join->row, join->row_length);
+}
+
+/* Join the rows of two inputs.  As many build rows as fit in memory are
+   hashed at a time, and all the probe rows are read for each of them. */
+static db_result_t join_inputs(struct join_s *join, struct block_reader_s *build, struct block_reader_s *probe, int records, unsigned char *memory, struct block_writer_s *out)
+{
+	struct join_side_s *side;
+	join_entry_t **buckets;
+	join_entry_t *entry;
+	unsigned char *entries;
+	unsigned char *record;
+	unsigned entry_length;
+	unsigned capacity;
+	unsigned count;
+	uint32_t hash;
+	db_result_t res;
+
+	side = &join->sides[JOIN_BUILD];
+	entry_length = (sizeof(join_entry_t) + side->record_length + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+	capacity = DB_JOIN_MEMORY / (entry_length + sizeof(join_entry_t *));
+	if (capacity == 0) {
+		DB_LOG_E("DB: A joined row of %u bytes does not fit in memory\n", side->record_length);
+		return DB_LIMIT_ERROR;
+	}
+	buckets = (join_entry_t **)memory;
+	entries = memory + capacity * sizeof(join_entry_t *);
+
+	do {
+		memset(buckets, 0, capacity * sizeof(join_entry_t *));
+		for (count = 0; count < capacity; count++) {
+			res = join_next(join, side, build, records, &record);
+			if (res == DB_FINISHED) {
+				break;
+			} else if (DB_ERROR(res)) {
+				return res;
+			}
+			entry = (join_entry_t *)(entries + count * entry_length);
+			memcpy(JOIN_RECORD(entry), record, side->record_length);
+			/* The rows of a partition have the same hash modulo the partitions */
+			entry->hash = join_hash(record, join->key_length);
+			entry->next = buckets[(entry->hash / join->partitions) % capacity];
+			buckets[(entry->hash / join->partitions) % capacity] = entry;
+		}
+		if (count == 0) {
+			break;
+		}
+
+		block_rewind(probe);
+		while ((res = join_next(join, &join->sides[JOIN_PROBE], probe, records, &record)) == DB_OK) {
+			hash = join_hash(record, join->key_length);
+			for (entry = buckets[(hash / join->partitions) % capacity]; entry != NULL; entry = entry->next) {
+				if (entry->hash == hash && memcmp(JOIN_RECORD(entry), record, join->key_length) == 0) {
+					if (DB_ERROR(join_emit(join, out, JOIN_RECORD(entry), record))) {
+						return DB_STORAGE_ERROR;
+					}
+				}
+			}
+		}
+		if (DB_ERROR(res)) {
+			return res;
+		}
+	} while (count == capacity);
+
+	return DB_OK;
+}
+
+static void join_file_name(char *name, int side, int partition)
+{
+	snprintf(name, SCRATCH_NAME_LENGTH, DB_JOIN_FILE, side == JOIN_BUILD ? 'b' : 'p', partition);
+}
+
+/* Write the records of a side into one scratch file for each partition */
+static db_result_t join_partition(struct join_s *join, int s, unsigned char *memory, unsigned char *buffer, unsigned size)
+{
+	struct join_side_s *side;
+	struct block_writer_s writers[DB_JOIN_PARTITIONS];
+	struct block_reader_s reader;
+	char name[SCRATCH_NAME_LENGTH];
+	unsigned char *record;
+	db_storage_id_t fd;
+	db_result_t res;
+	unsigned length;
+	int i;
+
+	side = &join->sides[s];
+	length = block_size(DB_JOIN_MEMORY / join->partitions, side->record_length);
+	for (i = 0; i < join->partitions; i++) {
+		join_file_name(name, s, i);
+		writers[i].fd = storage_open(name, O_RDWR | O_CREAT | O_TRUNC);
+		writers[i].buffer = memory + i * length;
+		writers[i].size = length;
+		writers[i].fill = 0;
+	}
+
+	res = DB_OK;
+	fd = storage_open(side->rel->tuple_filename, O_RDONLY);
+	if (fd < 0) {
+		res = DB_STORAGE_ERROR;
+	}
+	for (i = 0; i < join->partitions; i++) {
+		if (writers[i].fd < 0) {
+			res = DB_STORAGE_ERROR;
+		}
+	}
+
+	if (DB_SUCCESS(res)) {
+		block_reader_init(&reader, fd, buffer, size, side->rel->row_length, 0, ULONG_MAX);
+		while ((res = join_next(join, side, &reader, 0, &record)) == DB_OK) {
+			i = join_hash(record, join->key_length) % join->partitions;
+			if (DB_ERROR(block_write(&writers[i], record, side->record_length))) {
+				res = DB_STORAGE_ERROR;
+				break;
+			}
+		}
+		if (res == DB_FINISHED) {
+			res = DB_OK;
+		}
+	}
+
+	for (i = 0; i < join->partitions; i++) {
+		if (writers[i].fd >= 0) {
+			if (DB_SUCCESS(res)) {
+				res = block_flush(&writers[i]);
+			}
+			storage_close(writers[i].fd);
+		}
+	}
+	if (fd >= 0) {
+		storage_close(fd);
+	}
+
+	return res;
+}
+
+static db_result_t join_run(struct join_s *join, relation_t *result)
+{
+	struct block_reader_s build;
+	struct block_reader_s probe;
+	struct block_writer_s out;
+	char name[SCRATCH_NAME_LENGTH];
+	unsigned char *memory;
+	unsigned char *buffers;
+	db_storage_id_t fds[2];
+	db_result_t res;
+	unsigned length;
+	unsigned size;
+	int records;
+	int i;
+	int j;
+
+	/* The rows of the relations and the records of the partitions are
+	   read through two buffers of the same size. */
+	length = join->row_length;
+	for (i = 0; i < 2; i++) {
+		if (join->sides[i].rel->row_length > length) {
+			length = join->sides[i].rel->row_length;
+		}
+		if (join->sides[i].record_length > length) {
+			length = join->sides[i].record_length;
+		}
+	}
+	size = block_size(DB_JOIN_MEMORY / 8, length);
+
+	memory = (unsigned char *)malloc(DB_JOIN_MEMORY);
+	buffers = (unsigned char *)malloc(3 * size + join->row_length + length);
+	if (memory == NULL || buffers == NULL) {
+		DB_LOG_E("DB: Failed to allocate the memory of a join\n");
+		free(memory);
+		free(buffers);
+		return DB_ALLOCATION_ERROR;
+	}
+	join->row = buffers + 3 * size;
+	join->record = join->row + join->row_length;
+
+	out.fd = result->tuple_storage;
+	out.buffer = buffers + 2 * size;
+	out.size = block_size(size, join->row_length);
+	out.fill = 0;
+
+	res = DB_OK;
+	records = join->partitions > 1;
+	if (records) {
+		res = join_partition(join, JOIN_BUILD, memory, buffers, size);
+		if (DB_SUCCESS(res)) {
+			res = join_partition(join, JOIN_PROBE, memory, buffers, size);
+		}
+	}
+
+	for (i = 0; i < join->partitions && DB_SUCCESS(res); i++) {
+		for (j = 0; j < 2; j++) {
+			if (records) {
+				join_file_name(name, j, i);
+				fds[j] = storage_open(name, O_RDONLY);
+			} else {
+				fds[j] = storage_open(join->sides[j].rel->tuple_filename, O_RDONLY);
+			}
+			if (fds[j] < 0) {
+				res = DB_STORAGE_ERROR;
+			}
+		}
+
+		if (DB_SUCCESS(res)) {
+			block_reader_init(&build, fds[JOIN_BUILD], buffers, size, records ? join->sides[JOIN_BUILD].record_length : join->sides[JOIN_BUILD].rel->row_length, 0, ULONG_MAX);
+			block_reader_init(&probe, fds[JOIN_PROBE], buffers + size, size, records ? join->sides[JOIN_PROBE].record_length : join->sides[JOIN_PROBE].rel->row_length, 0, ULONG_MAX);
+			res = join_inputs(join, &build, &probe, records, memory, &out);
+		}
+
+		for (j = 0; j < 2; j++) {
+			if (fds[j] >= 0) {
+				storage_close(fds[j]);
+			}
+		}
+	}
+
+	/* The rows are read through other opens of the file */
+	if (DB_SUCCESS(res)) {
+		res = block_flush(&out);
+	}
+	if (DB_SUCCESS(res) && storage_sync(result->tuple_storage) != OK) {
+		res = DB_STORAGE_ERROR;
+	}
+
+	if (records) {
+		for (i = 0; i < join->partitions; i++) {
+			for (j = 0; j < 2; j++) {
+				join_file_name(name, j, i);
+				storage_remove(name);
+			}
+		}
+	}
+
+	free(memory);
+	free(buffers);
+	return res;
+}
+
+static int sort_compare(const void *a, const void *b)
+{
+	attribute_value_t value;
+	unsigned char *x;
+	unsigned char *y;
+	long long_x;
+	long long_y;
+	int result;
+
+	x = (unsigned char *)a + g_sort_key.offset;
+	y = (unsigned char *)b + g_sort_key.offset;
+	if (g_sort_key.attr.domain == DOMAIN_STRING) {
+		result = strncmp((const char *)x, (const char *)y, g_sort_key.attr.element_size);
+	} else {
+		db_phy_to_value(&value, &g_sort_key.attr, x);
+		long_x = db_value_to_long(&value);
+		db_phy_to_value(&value, &g_sort_key.attr, y);
+		long_y = db_value_to_long(&value);
+		result = long_x < long_y ? -1 : long_x > long_y;
+	}
+
+	return g_sort_key.descending ? -result : result;
+}
+
+static void sort_file_name(char *name, int file)
+{
+	snprintf(name, SCRATCH_NAME_LENGTH, DB_SORT_FILE, file);
+}
+
+/* Merge count runs of the file, from run first on, into out.  The runs have
+   run_rows rows each, except for the last run of the file. */
+static db_result_t sort_merge(db_storage_id_t fd, tuple_id_t rows, tuple_id_t run_rows, tuple_id_t first, unsigned count, unsigned length, unsigned char *buffers, unsigned size, struct block_writer_s *out, tuple_id_t limit, tuple_id_t *merged)
+{
+	struct block_reader_s readers[DB_SORT_FANIN];
+	unsigned char *rows_in[DB_SORT_FANIN];
+	unsigned long begin;
+	unsigned long end;
+	db_result_t res;
+	unsigned i;
+	int min;
+
+	for (i = 0; i < count; i++) {
+		begin = (unsigned long)(first + i) * run_rows;
+		end = begin + run_rows < rows ? begin + run_rows : rows;
+		block_reader_init(&readers[i], fd, buffers + i * size, size, length, begin * length, end * length);
+		res = block_read(&readers[i], &rows_in[i]);
+		if (DB_ERROR(res)) {
+			return res;
+		} else if (res == DB_FINISHED) {
+			rows_in[i] = NULL;
+		}
+	}
+
+	*merged = 0;
+	while (*merged < limit) {
+		min = -1;
+		for (i = 0; i < count; i++) {
+			if (rows_in[i] != NULL && (min < 0 || sort_compare(rows_in[i], rows_in[min]) < 0)) {
+				min = i;
+			}
+		}
+		if (min < 0) {
+			break;
+		}
+
+		if (DB_ERROR(block_write(out, rows_in[min], length))) {
+			return DB_STORAGE_ERROR;
+		}
+		(*merged)++;
+
+		res = block_read(&readers[min], &rows_in[min]);
+		if (DB_ERROR(res)) {
+			return res;
+		} else if (res == DB_FINISHED) {
+			rows_in[min] = NULL;
+		}
+	}
+
+	return DB_OK;
+}
+
+/* Sort the rows of the cursor into result. */
+static db_result_t sort_run(db_cursor_t *cursor, relation_t *result, tuple_id_t limit)
+{
+	struct block_writer_s out;
+	char name[SCRATCH_NAME_LENGTH];
+	cursor_data_map_t *map;
+	unsigned char *memory;
+	unsigned char *row;
+	unsigned char *ptr;
+	db_storage_id_t fds[2];
+	db_result_t res;
+	tuple_id_t rows;
+	tuple_id_t run_rows;
+	tuple_id_t runs;
+	tuple_id_t merged;
+	tuple_id_t group;
+	unsigned capacity;
+	unsigned length;
+	unsigned count;
+	unsigned size;
+	unsigned i;
+	ssize_t r;
+	int file;
+
+	length = result->row_length;
+	capacity = DB_SORT_MEMORY / length;
+	if (capacity == 0) {
+		DB_LOG_E("DB: A sorted row of %u bytes does not fit in memory\n", length);
+		return DB_LIMIT_ERROR;
+	}
+
+	memory = (unsigned char *)malloc(capacity * length);
+	row = (unsigned char *)malloc(cursor->snapshot.row_length + 1);
+	if (memory == NULL || row == NULL) {
+		free(memory);
+		free(row);
+		return DB_ALLOCATION_ERROR;
+	}
+
+	/* A run keeps no more rows than the result does */
+	run_rows = limit < capacity ? limit : capacity;
+	fds[0] = INVALID_STORAGE_ID;
+	fds[1] = INVALID_STORAGE_ID;
+	rows = 0;
+	runs = 0;
+	count = 0;
+	for (;;) {
+		res = relation_process_next(cursor);
+		if (res == DB_OK) {
+			res = storage_snapshot_get_row(&cursor->snapshot, cursor->current_storage_row, row);
+			if (DB_ERROR(res)) {
+				break;
+			}
+			ptr = memory + count * length;
+			for (i = 0; i < cursor->attribute_count; i++) {
+				map = &cursor->attr_map[i];
+				memcpy(ptr, row + map->offset, map->data_size);
+				ptr += map->data_size;
+			}
+			if (++count < capacity) {
+				continue;
+			}
+		} else if (res != DB_FINISHED) {
+			break;
+		}
+
+		if (res == DB_FINISHED && runs == 0) {
+			/* All the rows are sorted in memory */
+			qsort(memory, count, length, sort_compare);
+			out.fd = result->tuple_storage;
+			out.buffer = memory;
+			out.size = count * length;
+			out.fill = (count < run_rows ? count : run_rows) * length;
+			rows = out.fill / length;
+			res = block_flush(&out);
+			goto out;
+		}
+
+		if (count > 0) {
+			qsort(memory, count, length, sort_compare);
+			if (fds[0] < 0) {
+				sort_file_name(name, 0);
+				fds[0] = storage_open(name, O_RDWR | O_CREAT | O_TRUNC);
+				if (fds[0] < 0) {
+					res = DB_STORAGE_ERROR;
+					break;
+				}
+			}
+			count = count < run_rows ? count : run_rows;
+			r = storage_write(fds[0], memory, count * length);
+			if (r < 0 || (unsigned)r != count * length) {
+				res = DB_STORAGE_ERROR;
+				break;
+			}
+			rows += count;
+			runs++;
+			count = 0;
+		}
+		if (res == DB_FINISHED) {
+			res = DB_OK;
+			break;
+		}
+	}
+	free(memory);
+	memory = NULL;
+	if (DB_ERROR(res)) {
+		goto out;
+	}
+
+	/* Merge the runs of one file into the other one, until the runs
+	   are few enough to be merged into the result. */
+	size = block_size(DB_SORT_MEMORY / (DB_SORT_FANIN + 1), length);
+	memory = (unsigned char *)malloc((DB_SORT_FANIN + 1) * size);
+	if (memory == NULL) {
+		res = DB_ALLOCATION_ERROR;
+		goto out;
+	}
+	out.buffer = memory + DB_SORT_FANIN * size;
+	out.size = size;
+	out.fill = 0;
+
+	file = 0;
+	while (DB_SUCCESS(res)) {
+		if (runs <= DB_SORT_FANIN) {
+			out.fd = result->tuple_storage;
+			res = sort_merge(fds[file], rows, run_rows, 0, runs, length, memory, size, &out, limit, &merged);
+			if (DB_SUCCESS(res)) {
+				res = block_flush(&out);
+			}
+			rows = merged;
+			break;
+		}
+
+		sort_file_name(name, !file);
+		fds[!file] = storage_open(name, O_RDWR | O_CREAT | O_TRUNC);
+		if (fds[!file] < 0) {
+			res = DB_STORAGE_ERROR;
+			break;
+		}
+		out.fd = fds[!file];
+		count = 0;
+		merged = 0;
+		for (group = 0; group < runs && DB_SUCCESS(res); group += DB_SORT_FANIN) {
+			res = sort_merge(fds[file], rows, run_rows, group, runs - group < DB_SORT_FANIN ? runs - group : DB_SORT_FANIN, length, memory, size, &out, limit, &merged);
+			count += merged;
+		}
+		if (DB_SUCCESS(res)) {
+			res = block_flush(&out);
+		}
+
+		storage_close(fds[file]);
+		fds[file] = INVALID_STORAGE_ID;
+		rows = count;
+		runs = (runs + DB_SORT_FANIN - 1) / DB_SORT_FANIN;
+		run_rows = run_rows > limit / DB_SORT_FANIN ? limit : run_rows * DB_SORT_FANIN;
+		file = !file;
+	}
+
+out:
+	if (DB_SUCCESS(res) && storage_sync(result->tuple_storage) != OK) {
+		res = DB_STORAGE_ERROR;
+	}
+	for (i = 0; i < 2; i++) {
+		if (fds[i] >= 0) {
+			storage_close(fds[i]);
+		}
+		if (runs > 0) {
+			sort_file_name(name, i);
+			storage_remove(name);
+		}
+	}
+	free(memory);
+	free(row);
+
+	if (DB_SUCCESS(res)) {
+		result->cardinality += rows;
+		result->next_row += rows;
+	}
+	return res;
+}
+
+/****************************************************************************
+* Public Functions
+****************************************************************************/
+db_result_t relation_join_plan(relation_t *left, relation_t *right, void *adt_ptr, db_join_plan_t *plan)
+{
+	struct join_s join;
+	db_result_t res;
+
+	res = join_init(&join, left, right, (aql_adt_t *)adt_ptr);
+	if (DB_ERROR(res)) {
+		return res;
+	}
+
+	plan->build = join.sides[JOIN_BUILD].rel;
+	plan->probe = join.sides[JOIN_PROBE].rel;
+	plan->build_rows = relation_cardinality(plan->build);
+	plan->probe_rows = relation_cardinality(plan->probe);
+	plan->record_length = join.sides[JOIN_BUILD].record_length;
+	plan->partitions = join.partitions;
+
+	return DB_OK;
+}
+
+/*
+ * Join the rows of left and right in which the join attributes of the adt
+ * are equal.  The joined rows hold the attributes which the query reads,
+ * and are stored in a temporary relation, which is returned loaded.
+ */
+relation_t *relation_join(relation_t *left, relation_t *right, void *adt_ptr)
+{
+	struct join_s join;
+	relation_t *result;
+	attribute_t *attr;
+	int i;
+
+	if (DB_ERROR(join_init(&join, left, right, (aql_adt_t *)adt_ptr))) {
+		return NULL;
+	}
+
+	result = relation_create_temporary();
+	if (result == NULL) {
+		return NULL;
+	}
+
+	for (i = 0; i < join.attribute_count; i++) {
+		attr = join.attributes[i];
+		if (relation_attribute_add(result, DB_STORAGE, attr->name, attr->domain, attr->element_size) == NULL) {
+			goto errout;
+		}
+	}
+
+	DB_LOG_D("DB: Join %s with %s in %d partitions\n", join.sides[JOIN_BUILD].rel->name, join.sides[JOIN_PROBE].rel->name, join.partitions);
+	if (DB_ERROR(join_run(&join, result))) {
+		DB_LOG_E("DB: Failed to join %s and %s\n", left->name, right->name);
+		goto errout;
+	}
+
+	result->cardinality += join.rows;
+	result->next_row += join.rows;
+	return result;
+
+errout:
+	relation_release(result);
+	return NULL;
+}
+
+/*
+ * Sort the rows which a streaming cursor selects by the attribute name,
+ * and keep the first limit rows, or all of them if limit is 0.  The rows
+ * are stored with the attributes of the cursor in a temporary relation,
+ * which is returned loaded.
+ */
+relation_t *relation_sort(db_cursor_t *cursor, char *name, int descending, tuple_id_t limit)
+{
+	relation_t *result;
+	cursor_data_map_t *map;
+	db_result_t res;
+	int i;
+
+	if (cursor == NULL || !IS_STREAM_CURSOR(cursor)) {
+		return NULL;
+	}
+
+	result = relation_create_temporary();
+	if (result == NULL) {
+		return NULL;
+	}
+
+	res = DB_NAME_ERROR;
+	memset(&g_sort_key, 0, sizeof(g_sort_key));
+	for (i = 0; i < cursor->attribute_count; i++) {
+		map = &cursor->attr_map[i];
+		if (res == DB_NAME_ERROR && strcmp(map->name, name) == 0) {
+			g_sort_key.attr.domain = map->domain;
+			g_sort_key.attr.element_size = map->data_size;
+			g_sort_key.offset = result->row_length;
+			g_sort_key.descending = descending;
+			res = DB_OK;
+		}
+		if (relation_attribute_add(result, DB_STORAGE, map->name, map->domain, map->data_size) == NULL) {
+			goto errout;
+		}
+	}
+
+	if (DB_ERROR(res)) {
+		DB_LOG_E("DB: Order by invalid attribute %s\n", name);
+		goto errout;
+	}
+	if (g_sort_key.attr.domain != DOMAIN_INT && g_sort_key.attr.domain != DOMAIN_LONG && g_sort_key.attr.domain != DOMAIN_STRING) {
+		DB_LOG_E("DB: Order by %s of domain %d\n", name, g_sort_key.attr.domain);
+		goto errout;
+	}
+
+	if (DB_ERROR(sort_run(cursor, result, limit > 0 ? limit : INVALID_TUPLE))) {
+		DB_LOG_E("DB: Failed to sort by %s\n", name);
+		goto errout;
+	}
+
+	return result;
+
+errout:
+	relation_release(result);
+	return NULL;
+}
@@ -71,6 +71,8 @@
 #define DB_HANDLE_FLAG_INDEX_STEP       0x01
 #define DB_HANDLE_FLAG_SEARCH_INDEX     0x02
 #define DB_HANDLE_FLAG_PROCESSING       0x04
+#define DB_HANDLE_FLAG_STREAM           0x08
+#define DB_HANDLE_FLAG_INDEX_ONLY       0x10
 #define DB_HANDLE_FLAG_INVALID          0x00
 
 /****************************************************************************
@@ -94,10 +96,23 @@ struct source_dest_map_s {
 };
 typedef struct source_dest_map_s source_dest_map_t;
 
+/* An access path that was considered for a query, see select_index(). */
+struct db_plan_s {
+	index_t *index;				/* NULL for a full scan */
+	long min;					/* The range of keys read from the index */
+	long max;
+	tuple_id_t rows;			/* The estimated number of rows read */
+	unsigned long cost;
+	uint8_t chosen;
+	uint8_t index_only;
+};
+typedef struct db_plan_s db_plan_t;
+
 struct _db_handle_s {
 	index_iterator_t index_iterator;
 	tuple_id_t tuple_id;
 	tuple_id_t current_row;
+	tuple_id_t limit;
 	relation_t *rel;
 	relation_t *result_rel;
 	tuple_t tuple;
@@ -107,6 +122,9 @@ struct _db_handle_s {
 	uint8_t ncolumns;
 	void *lvm_instance;
 	source_dest_map_t *attr_map;
+	/* Filled with the considered access paths for EXPLAIN, or NULL */
+	db_plan_t *plans;
+	uint8_t plan_count;
 };
 
 /****************************************************************************
@@ -115,6 +133,10 @@ struct _db_handle_s {
 db_result_t db_get_value(attribute_value_t *value, db_handle_t *handle, unsigned col);
 db_result_t db_phy_to_value(attribute_value_t *value, attribute_t *attr, unsigned char *ptr);
 db_result_t db_value_to_phy(unsigned char *ptr, attribute_t *attr, attribute_value_t *value);
+db_result_t cursor_data_set(db_cursor_t *cursor, source_dest_map_t *attr_map, attribute_id_t attribute_count);
+db_result_t db_print_plan(db_handle_t *handle);
+db_result_t db_print_join_plan(db_join_plan_t *plan, char *left, char *right);
+db_result_t db_print_sort_plan(char *attribute, int descending, tuple_id_t limit);
 
 #endif              /* !RESULT_H */
 long db_value_to_long(attribute_value_t *value);
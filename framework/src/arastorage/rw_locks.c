@@ -23,9 +23,24 @@
 
 #include <pthread.h>
 
+/****************************************************************************
+* Private Data
+****************************************************************************/
+static pthread_mutex_t g_db_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /****************************************************************************
 * Public Functions
 ****************************************************************************/
+void db_lock(void)
+{
+	pthread_mutex_lock(&g_db_lock);
+}
+
+void db_unlock(void)
+{
+	pthread_mutex_unlock(&g_db_lock);
+}
+
 void rw_init(struct rw_lock_s *rwLock)
 {
 	pthread_mutex_init(&rwLock->mutex, NULL);
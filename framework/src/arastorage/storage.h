@@ -96,7 +96,11 @@ db_result_t storage_get_index(index_t *, relation_t *, attribute_t *);
 db_result_t storage_put_index(index_t *);
 db_result_t storage_remove_index(relation_t *rel, attribute_t *attr);
 db_result_t storage_get_row(relation_t *, tuple_id_t *, storage_row_t);
+db_result_t storage_snapshot_open(relation_t *, db_snapshot_t *);
+db_result_t storage_snapshot_get_row(db_snapshot_t *, tuple_id_t, storage_row_t);
+void storage_snapshot_close(db_snapshot_t *);
 db_result_t storage_put_row(relation_t *, storage_row_t, uint8_t);
+db_result_t storage_put_rows(relation_t *, storage_row_t, tuple_id_t);
 db_result_t storage_write_row(db_storage_id_t, storage_row_t, unsigned, char *);
 db_result_t storage_get_row_amount(relation_t *, tuple_id_t *);
 db_result_t storage_read_from(db_storage_id_t, void *, unsigned long, unsigned);
@@ -115,6 +119,7 @@ db_result_t storage_rename(const char *, const char *);
 off_t storage_seek(db_storage_id_t, unsigned long, int);
 ssize_t storage_read(db_storage_id_t, void *, unsigned);
 ssize_t storage_write(db_storage_id_t, void *, unsigned);
+int storage_sync(db_storage_id_t);
 #ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
 ssize_t storage_get_availbyte_size(void);
 #endif
@@ -28,6 +28,8 @@
 #endif
 #include "db_debug.h"
 #include "storage.h"
+#include "buffer_pool.h"
+#include "wal.h"
 
 /****************************************************************************
 * Public Functions
@@ -69,6 +71,9 @@ db_result_t storage_remove(const char *filename)
 		return DB_STORAGE_ERROR;
 	}
 	snprintf(rel_path, DB_MAX_FILENAME_LENGTH, "%s%s\0", CONFIG_MOUNT_POINT, filename);
+	/* The log must not refer to a file which is removed */
+	wal_checkpoint();
+	buffer_pool_invalidate(filename);
 	if (unlink(rel_path) == OK) {
 		res = DB_OK;
 	}
@@ -96,6 +101,12 @@ db_result_t storage_rename(const char *old_name, const char *new_name)
 	snprintf(old_path, DB_MAX_FILENAME_LENGTH, "%s%s\0", CONFIG_MOUNT_POINT, old_name);
 	snprintf(new_path, DB_MAX_FILENAME_LENGTH, "%s%s\0", CONFIG_MOUNT_POINT, new_name);
 
+	/* Cached pages and the log are named after the file, so they do not follow it */
+	wal_checkpoint();
+	buffer_pool_flush(old_name);
+	buffer_pool_invalidate(old_name);
+	buffer_pool_invalidate(new_name);
+
 	if (rename(old_path, new_path) == OK) {
 		res = DB_OK;
 	}
@@ -122,6 +133,12 @@ ssize_t storage_write(db_storage_id_t fd, void *buffer, unsigned length)
 	return write(fd, buffer, length);
 }
 
+/* It mapped with fsync function in specific file system */
+int storage_sync(db_storage_id_t fd)
+{
+	return fsync(fd);
+}
+
 #ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
 ssize_t storage_get_availbyte_size(void)
 {
@@ -66,6 +66,8 @@
 #include "db_debug.h"
 #include "random.h"
 #include "storage.h"
+#include "buffer_pool.h"
+#include "wal.h"
 
 /****************************************************************************
 * Private Types
@@ -80,6 +82,7 @@ struct index_record_s {
 	char attribute_name[ATTRIBUTE_NAME_LENGTH];
 	char file_name[DB_MAX_FILENAME_LENGTH];
 	uint8_t type;
+	char key_attributes[DB_MAX_INDEX_KEY_ATTRIBUTES - 1][ATTRIBUTE_NAME_LENGTH];
 };
 
 /****************************************************************************
@@ -132,6 +135,8 @@ void storage_write_buffer_deinit()
 db_result_t storage_generate_file(char *filename)
 {
 	int fd;
+	wal_checkpoint();
+	buffer_pool_invalidate(filename);
 	fd = storage_open(filename, O_RDWR | O_APPEND | O_CREAT | O_TRUNC);
 	if (fd < 0) {
 		DB_LOG_E("[storage_generate_file] open error!! \n");
@@ -318,6 +323,7 @@ db_result_t storage_get_index(index_t *index, relation_t *rel, attribute_t *attr
 	struct index_record_s record;
 	db_result_t result;
 	int len;
+	int i;
 
 	len = strlen(rel->name) + strlen(INDEX_NAME_SUFFIX) + 1;
 	filename = (char *)malloc(sizeof(char) * len);
@@ -341,6 +347,12 @@ db_result_t storage_get_index(index_t *index, relation_t *rel, attribute_t *attr
 			index->type = record.type;
 			memcpy(index->descriptor_file, record.file_name, sizeof(index->descriptor_file));
 			index->descriptor_file[sizeof(index->descriptor_file) - 1] = '\0';
+			index->key_count = 1;
+			for (i = 0; i < DB_MAX_INDEX_KEY_ATTRIBUTES - 1 && record.key_attributes[i][0] != '\0'; i++) {
+				memcpy(index->key_attributes[i], record.key_attributes[i], ATTRIBUTE_NAME_LENGTH);
+				index->key_attributes[i][ATTRIBUTE_NAME_LENGTH] = '\0';
+				index->key_count++;
+			}
 			result = DB_OK;
 		}
 	}
@@ -356,6 +368,7 @@ db_result_t storage_put_index(index_t *index)
 	ssize_t r;
 	struct index_record_s record;
 	int len;
+	int i;
 
 	len = strlen(index->rel->name) + strlen(INDEX_NAME_SUFFIX) + 1;
 
@@ -370,10 +383,13 @@ db_result_t storage_put_index(index_t *index)
 		return DB_STORAGE_ERROR;
 	}
 
-	memset(&record.attribute_name, 0, sizeof(record.attribute_name));
+	memset(&record, 0, sizeof(record));
 	memcpy(record.attribute_name, index->attr->name, sizeof(record.attribute_name));
 	memcpy(record.file_name, index->descriptor_file, sizeof(record.file_name));
 	record.type = index->type;
+	for (i = 0; i < index->key_count - 1; i++) {
+		memcpy(record.key_attributes[i], index->key_attributes[i], sizeof(record.key_attributes[i]));
+	}
 
 	r = storage_write(fd, &record, sizeof(record));
 	free(filename);
@@ -489,7 +505,6 @@ db_result_t storage_remove_index(relation_t *rel, attribute_t *attr)
 
 db_result_t storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
 {
-	ssize_t r;
 	tuple_id_t nrows;
 
 	if (DB_ERROR(storage_get_row_amount(rel, &nrows))) {
@@ -501,28 +516,81 @@ db_result_t storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t
 		return DB_FINISHED;
 	}
 
-	if (storage_seek(rel->tuple_storage, *tuple_id * rel->row_length, SEEK_SET) == (off_t)-1) {
+	if (DB_ERROR(buffer_pool_read(rel->tuple_filename, rel->tuple_storage, row, (unsigned long)*tuple_id * rel->row_length, rel->row_length))) {
+		DB_LOG_E("DB: Reading failed on fd %d\n", rel->tuple_storage);
 		return DB_STORAGE_ERROR;
 	}
+	DB_LOG_V("read row = %s\n", row);
 
-	r = storage_read(rel->tuple_storage, row, rel->row_length);
-	DB_LOG_V("read row = %s, r = %d\n", row, r);
+	DB_LOG_D("DB: Read %d bytes from relation %s\n", rel->row_length, rel->name);
+	return DB_OK;
+}
 
-	if (r == 0) {
-		DB_LOG_E("%DB : read 0 bytes\n");
-		return DB_FINISHED;
-	} else if (r < 0) {
-		DB_LOG_E("DB: Reading failed on fd %d\n", rel->tuple_storage);
-		return DB_STORAGE_ERROR;
-	} else if (r < rel->row_length) {
-		DB_LOG_E("DB: Incomplete record: %d < %d\n", r, rel->row_length);
+db_result_t storage_snapshot_open(relation_t *rel, db_snapshot_t *snap)
+{
+	off_t offset;
+
+	snap->nrows = 0;
+	snap->row_length = rel->row_length;
+	memcpy(snap->filename, rel->tuple_filename, sizeof(snap->filename));
+	snap->fd = storage_open(rel->tuple_filename, O_RDONLY);
+	if (snap->fd < 0) {
+		DB_LOG_E("DB: Failed to open the tuple file %s\n", rel->tuple_filename);
 		return DB_STORAGE_ERROR;
 	}
 
-	DB_LOG_D("DB: Read %d bytes from relation %s\n", rel->row_length, rel->name);
+	/* Rows are only ever appended, so the rows stored now stay unchanged
+	   for as long as the tuple file exists. */
+	if (snap->row_length > 0) {
+		offset = storage_seek(snap->fd, 0, SEEK_END);
+		if (offset == (off_t)-1) {
+			storage_snapshot_close(snap);
+			return DB_STORAGE_ERROR;
+		}
+		snap->nrows = (tuple_id_t)(offset / snap->row_length);
+	}
+
+	DB_LOG_D("DB: Snapshot of relation %s has %d rows\n", rel->name, snap->nrows);
 	return DB_OK;
 }
 
+db_result_t storage_snapshot_get_row(db_snapshot_t *snap, tuple_id_t tuple_id, storage_row_t row)
+{
+	if (tuple_id >= snap->nrows) {
+		return DB_FINISHED;
+	}
+
+	return buffer_pool_read(snap->filename, snap->fd, row, (unsigned long)tuple_id * snap->row_length, snap->row_length);
+}
+
+void storage_snapshot_close(db_snapshot_t *snap)
+{
+	if (snap->fd >= 0) {
+		storage_close(snap->fd);
+		snap->fd = INVALID_STORAGE_ID;
+	}
+}
+
+#ifdef CONFIG_ARASTORAGE_WAL
+/* Log rows which are appended to a tuple file after pending bytes that are
+ * not in the file yet. The rows are still written in place as well: readers,
+ * snapshots and indexes address rows by their offset in the tuple file, and
+ * the cardinality is its size. The log is the durable copy until the next
+ * checkpoint syncs the tuple file, so recovery can redo appends which never
+ * reached the flash. */
+static db_result_t storage_log_rows(db_storage_id_t fd, const char *filename, unsigned long pending, void *rows, unsigned length)
+{
+	off_t size;
+	wal_lsn_t lsn;
+
+	size = storage_seek(fd, 0, SEEK_END);
+	if (size == (off_t)-1) {
+		return DB_STORAGE_ERROR;
+	}
+	return wal_log(WAL_RECORD_WRITE, filename, size + pending, rows, length, &lsn);
+}
+#endif
+
 db_result_t storage_put_row(relation_t *rel, storage_row_t row, uint8_t flag)
 {
 	db_result_t result;
@@ -541,6 +609,36 @@ db_result_t storage_put_row(relation_t *rel, storage_row_t row, uint8_t flag)
 	return result;
 }
 
+/* Append consecutive rows to the tuple file with a single write. */
+db_result_t storage_put_rows(relation_t *rel, storage_row_t rows, tuple_id_t count)
+{
+	unsigned length;
+	ssize_t r;
+
+	length = rel->row_length * count;
+#ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
+	/* Rows which wait in the insert buffer precede these rows */
+	if (DB_ERROR(storage_flush_insert_buffer())) {
+		return DB_STORAGE_ERROR;
+	}
+#endif
+#ifdef CONFIG_ARASTORAGE_WAL
+	if (DB_ERROR(storage_log_rows(rel->tuple_storage, rel->tuple_filename, 0, rows, length)) || DB_ERROR(wal_log_size(rel->tuple_filename, rel->tuple_storage))) {
+		return DB_STORAGE_ERROR;
+	}
+#endif
+	r = storage_write(rel->tuple_storage, rows, length);
+	if (r < 0 || (unsigned)r != length) {
+		DB_LOG_E("DB: Failed to store %u rows\n", (unsigned)count);
+		return DB_STORAGE_ERROR;
+	}
+	DB_LOG_D("DB: Stored %u rows of %u bytes\n", (unsigned)count, length);
+
+	rel->cardinality += count;
+	rel->next_row += count;
+	return DB_OK;
+}
+
 db_result_t storage_write_row(db_storage_id_t fd, storage_row_t row, unsigned length, char *filename)
 {
 #ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
@@ -550,10 +648,21 @@ db_result_t storage_write_row(db_storage_id_t fd, storage_row_t row, unsigned le
 	if ((g_storage_write_buffer.data_size + length) >= storage_get_write_buffer_size()) {
 		storage_flush_insert_buffer();
 	}
+#ifdef CONFIG_ARASTORAGE_WAL
+	/* The row is logged where the insert buffer will append it */
+	if (DB_ERROR(storage_log_rows(fd, filename, g_storage_write_buffer.data_size, row, length))) {
+		return DB_STORAGE_ERROR;
+	}
+#endif
 	memcpy(g_storage_write_buffer.buffer + g_storage_write_buffer.data_size, row, length);
 	g_storage_write_buffer.data_size += length;
 	memcpy(g_storage_write_buffer.file_name, filename, strlen(filename));
 #else
+#ifdef CONFIG_ARASTORAGE_WAL
+	if (DB_ERROR(storage_log_rows(fd, filename, 0, row, length)) || DB_ERROR(wal_log_size(filename, fd))) {
+		return DB_STORAGE_ERROR;
+	}
+#endif
 	if (storage_write(fd, row, length) < 0) {
 		DB_LOG_D("DB: Failed to store %u bytes\n", length);
 		return DB_STORAGE_ERROR;
@@ -580,6 +689,12 @@ db_result_t storage_flush_insert_buffer()
 		DB_LOG_D("Failed to open %s\n", g_storage_write_buffer.file_name);
 		return DB_STORAGE_ERROR;
 	}
+#ifdef CONFIG_ARASTORAGE_WAL
+	if (DB_ERROR(wal_log_size(g_storage_write_buffer.file_name, fd))) {
+		storage_close(fd);
+		return DB_STORAGE_ERROR;
+	}
+#endif
 
 	r = storage_write(fd, g_storage_write_buffer.buffer, g_storage_write_buffer.data_size);
 	if (r < 0) {
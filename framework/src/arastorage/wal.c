@@ -0,0 +1,829 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <crc32.h>
+#include "db_options.h"
+#include "db_debug.h"
+#include "rw_locks.h"
+#include "storage.h"
+#include "buffer_pool.h"
+#include "index.h"
+#include "wal.h"
+
+/****************************************************************************
+* Pre-processor Definitions
+****************************************************************************/
+/* Longer data is split into several records */
+#define WAL_DATA_LIMIT CONFIG_ARASTORAGE_BUFFER_POOL_PAGE_SIZE
+
+#define WAL_CHECKSUM_SEED 0xffffffff
+
+/* An lsn is before another one also when the counter wraps around */
+#define WAL_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+/****************************************************************************
+* Private Types
+****************************************************************************/
+struct wal_record_s {
+	uint32_t checksum;			/* of the rest of the record and of its data */
+	uint16_t length;			/* bytes of data which follow the record */
+	uint8_t type;
+	uint8_t reserved;
+	uint32_t offset;			/* of the data in the file, or the size of the file */
+	char file_name[DB_MAX_FILENAME_LENGTH];
+};
+
+/* A file which is written by the log, found by recovery */
+struct wal_file_s {
+	char file_name[DB_MAX_FILENAME_LENGTH];
+	unsigned long size;			/* the first size logged, if has_size */
+	unsigned long end;			/* end of the committed writes */
+	uint8_t has_size;
+};
+
+struct wal_s {
+	db_storage_id_t fd;
+	unsigned char *buffers;
+	unsigned char *buffer;		/* records are appended here */
+	unsigned char *io_buffer;	/* while these are written */
+	unsigned fill;
+	wal_lsn_t lsn;				/* end of the last record */
+	wal_lsn_t start_lsn;		/* start of the log file */
+	wal_lsn_t durable_lsn;		/* end of the synced records */
+	wal_lsn_t commit_lsn;		/* end of the last commit */
+	uint8_t started;
+	uint8_t io;					/* io_buffer is being written */
+	uint8_t appending;			/* a record is partly appended */
+	uint8_t checkpointer;		/* the checkpointer runs */
+	uint8_t checkpoint;			/* the checkpointer is asked to run */
+	uint8_t stop;
+	pthread_t thread;
+	/* Tuple files which logged their size since the checkpoint */
+	char files[DB_WAL_FILE_LIMIT][DB_MAX_FILENAME_LENGTH];
+	int file_count;
+	db_wal_stats_t stats;
+};
+
+/****************************************************************************
+* Private Data
+****************************************************************************/
+static struct wal_s g_wal;
+
+/* Records are appended with the database lock, but cursors log the pages
+ * which they evict without it, and the log is synced without it. */
+static pthread_mutex_t g_wal_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_wal_cond;
+static pthread_cond_t g_checkpoint_cond;
+
+/****************************************************************************
+* Private Functions
+****************************************************************************/
+static uint32_t wal_checksum(struct wal_record_s *record, const void *data, unsigned length)
+{
+	uint32_t crc;
+
+	crc = crc32part((const uint8_t *)record + sizeof(record->checksum), sizeof(*record) - sizeof(record->checksum), WAL_CHECKSUM_SEED);
+	return crc32part((const uint8_t *)data, length, crc);
+}
+
+/* Empty the log and start it with a checkpoint record.  smartfs does not
+ * truncate a file which is opened for appending, so it is truncated first and
+ * opened again.  Recovery starts after the last checkpoint record, so the
+ * records before it are ignored also if the log could not be emptied. */
+static db_storage_id_t wal_open_empty(wal_lsn_t start_lsn)
+{
+	struct wal_record_s record;
+	db_storage_id_t fd;
+
+	fd = storage_open(DB_WAL_FILE, O_WRONLY | O_CREAT | O_TRUNC);
+	if (fd < 0) {
+		return INVALID_STORAGE_ID;
+	}
+	storage_close(fd);
+	fd = storage_open(DB_WAL_FILE, O_WRONLY | O_APPEND);
+	if (fd < 0) {
+		return INVALID_STORAGE_ID;
+	}
+
+	memset(&record, 0, sizeof(record));
+	record.type = WAL_RECORD_CHECKPOINT;
+	record.offset = start_lsn;
+	record.checksum = wal_checksum(&record, NULL, 0);
+	if (storage_write(fd, &record, sizeof(record)) != (ssize_t)sizeof(record) || storage_sync(fd) != OK) {
+		storage_close(fd);
+		return INVALID_STORAGE_ID;
+	}
+	return fd;
+}
+
+/* Write the records appended so far, and sync them if sync is set.  The
+ * lock is released meanwhile, so that records are appended to the other
+ * buffer. */
+static db_result_t wal_write_out(bool sync)
+{
+	unsigned char *data;
+	unsigned length;
+	wal_lsn_t lsn;
+	ssize_t r;
+	db_result_t res = DB_OK;
+
+	/* The checkpoint failed to reopen the log, which only holds records
+	 * that are in the files */
+	if (g_wal.fd < 0) {
+		g_wal.fd = wal_open_empty(g_wal.start_lsn);
+		if (g_wal.fd < 0) {
+			DB_LOG_E("DB: Failed to reopen the log\n");
+			return DB_STORAGE_ERROR;
+		}
+	}
+
+	data = g_wal.buffer;
+	length = g_wal.fill;
+	lsn = g_wal.lsn;
+	g_wal.buffer = g_wal.io_buffer;
+	g_wal.io_buffer = data;
+	g_wal.fill = 0;
+	g_wal.io = 1;
+	pthread_mutex_unlock(&g_wal_lock);
+
+	if (length > 0) {
+		r = storage_write(g_wal.fd, data, length);
+		if (r < 0 || (unsigned)r != length) {
+			res = DB_STORAGE_ERROR;
+		}
+	}
+	if (sync && DB_SUCCESS(res) && storage_sync(g_wal.fd) != OK) {
+		res = DB_STORAGE_ERROR;
+	}
+
+	pthread_mutex_lock(&g_wal_lock);
+	g_wal.io = 0;
+	if (DB_SUCCESS(res)) {
+		g_wal.stats.log_bytes += length;
+		if (sync) {
+			g_wal.durable_lsn = lsn;
+			g_wal.stats.syncs++;
+		}
+	} else {
+		DB_LOG_E("DB: Failed to write %u bytes to the log\n", length);
+	}
+	pthread_cond_broadcast(&g_wal_cond);
+	return res;
+}
+
+/* Copy bytes of a record to the buffer, with the lock held */
+static db_result_t wal_put(const void *src, unsigned length)
+{
+	const unsigned char *ptr = (const unsigned char *)src;
+	unsigned n;
+
+	while (length > 0) {
+		if (g_wal.fill == DB_WAL_BUFFER_SIZE) {
+			if (g_wal.io) {
+				pthread_cond_wait(&g_wal_cond, &g_wal_lock);
+			} else if (DB_ERROR(wal_write_out(false))) {
+				return DB_STORAGE_ERROR;
+			}
+			continue;
+		}
+		n = DB_WAL_BUFFER_SIZE - g_wal.fill;
+		if (n > length) {
+			n = length;
+		}
+		memcpy(g_wal.buffer + g_wal.fill, ptr, n);
+		g_wal.fill += n;
+		g_wal.lsn += n;
+		ptr += n;
+		length -= n;
+	}
+	return DB_OK;
+}
+
+/* Sync a file which was written since the checkpoint */
+static void wal_sync_file(const char *filename)
+{
+	db_storage_id_t fd;
+
+	fd = storage_open(filename, O_RDWR);
+	if (fd < 0) {
+		return;
+	}
+	storage_sync(fd);
+	storage_close(fd);
+}
+
+static db_result_t wal_read(db_storage_id_t fd, unsigned long pos, struct wal_record_s *record, unsigned char *data)
+{
+	if (storage_seek(fd, pos, SEEK_SET) == (off_t)-1) {
+		return DB_STORAGE_ERROR;
+	}
+	if (storage_read(fd, record, sizeof(*record)) != (ssize_t)sizeof(*record)) {
+		return DB_STORAGE_ERROR;
+	}
+	if (record->type < WAL_RECORD_WRITE || record->type > WAL_RECORD_CHECKPOINT || record->length > WAL_DATA_LIMIT) {
+		return DB_STORAGE_ERROR;
+	}
+	if (record->length > 0 && storage_read(fd, data, record->length) != (ssize_t)record->length) {
+		return DB_STORAGE_ERROR;
+	}
+	/* The end of a record which was written partly before a crash */
+	if (wal_checksum(record, data, record->length) != record->checksum) {
+		return DB_STORAGE_ERROR;
+	}
+	record->file_name[DB_MAX_FILENAME_LENGTH - 1] = '\0';
+	return DB_OK;
+}
+
+/* Write the data of a record into its file */
+static db_result_t wal_apply(struct wal_record_s *record, unsigned char *data)
+{
+	db_storage_id_t fd;
+	db_result_t res;
+
+	fd = storage_open(record->file_name, O_RDWR);
+	if (fd < 0) {
+		DB_LOG_E("DB: Failed to open %s to recover it\n", record->file_name);
+		return DB_STORAGE_ERROR;
+	}
+	res = storage_write_to(fd, data, record->offset, record->length);
+	storage_sync(fd);
+	storage_close(fd);
+	return res;
+}
+
+static struct wal_file_s *wal_find_file(struct wal_file_s **files, int *count, const char *filename)
+{
+	struct wal_file_s *file;
+	int i;
+
+	for (i = 0; i < *count; i++) {
+		if (strncmp((*files)[i].file_name, filename, DB_MAX_FILENAME_LENGTH) == 0) {
+			return &(*files)[i];
+		}
+	}
+
+	file = (struct wal_file_s *)realloc(*files, (*count + 1) * sizeof(struct wal_file_s));
+	if (file == NULL) {
+		return NULL;
+	}
+	*files = file;
+	file = &file[(*count)++];
+	memset(file, 0, sizeof(*file));
+	strncpy(file->file_name, filename, DB_MAX_FILENAME_LENGTH - 1);
+	return file;
+}
+
+/* Cut the rows which a statement that did not commit appended to a tuple
+ * file.  The file system cannot truncate, so the rows before them are copied. */
+static db_result_t wal_cut(const char *filename, unsigned long size, unsigned char *data)
+{
+	db_storage_id_t fd;
+	db_storage_id_t fd_tmp;
+	off_t length;
+	unsigned n;
+	db_result_t res = DB_OK;
+
+	fd = storage_open(filename, O_RDONLY);
+	if (fd < 0) {
+		return DB_OK;
+	}
+	length = storage_seek(fd, 0, SEEK_END);
+	if (length == (off_t)-1 || (unsigned long)length <= size) {
+		storage_close(fd);
+		return DB_OK;
+	}
+	DB_LOG_D("DB: Cutting %s from %lu to %lu bytes\n", filename, (unsigned long)length, size);
+
+	/* Rows copied by a cut which did not finish are not kept */
+	storage_remove(DB_WAL_TEMP_FILE);
+	if (DB_ERROR(storage_generate_file(DB_WAL_TEMP_FILE))) {
+		storage_close(fd);
+		return DB_STORAGE_ERROR;
+	}
+	fd_tmp = storage_open(DB_WAL_TEMP_FILE, O_RDWR | O_APPEND);
+	if (fd_tmp < 0 || storage_seek(fd, 0, SEEK_SET) == (off_t)-1) {
+		res = DB_STORAGE_ERROR;
+	}
+	while (DB_SUCCESS(res) && size > 0) {
+		n = size > WAL_DATA_LIMIT ? WAL_DATA_LIMIT : size;
+		if (storage_read(fd, data, n) != (ssize_t)n || storage_write(fd_tmp, data, n) != (ssize_t)n) {
+			res = DB_STORAGE_ERROR;
+		}
+		size -= n;
+	}
+	if (fd_tmp >= 0) {
+		storage_sync(fd_tmp);
+		storage_close(fd_tmp);
+	}
+	storage_close(fd);
+
+	if (DB_SUCCESS(res)) {
+		res = storage_remove(filename);
+	}
+	if (DB_SUCCESS(res)) {
+		res = storage_rename(DB_WAL_TEMP_FILE, filename);
+	}
+	if (DB_ERROR(res)) {
+		DB_LOG_E("DB: Failed to cut %s\n", filename);
+		storage_remove(DB_WAL_TEMP_FILE);
+	}
+	return res;
+}
+
+/*
+ * Only the records after the last checkpoint record are recovered, the ones
+ * before it are in the files.  The records after the last commit are of a
+ * statement which did not commit.  What it wrote into the files is undone
+ * first: the bytes which it overwrote are restored, latest first, and the
+ * rows which it appended to the tuple files are cut.  Then the committed
+ * records are redone.
+ */
+static db_result_t wal_recover(void)
+{
+	struct wal_record_s record;
+	struct wal_file_s *files;
+	struct wal_file_s *file;
+	unsigned long *undo;
+	unsigned char *data;
+	unsigned long pos;
+	unsigned long start;
+	unsigned long commit_end;
+	unsigned long end;
+	int file_count;
+	int undo_count;
+	int i;
+	db_storage_id_t fd;
+	db_result_t res = DB_OK;
+
+	fd = storage_open(DB_WAL_FILE, O_RDONLY);
+	if (fd < 0) {
+		return DB_OK;
+	}
+
+	data = (unsigned char *)malloc(WAL_DATA_LIMIT);
+	if (data == NULL) {
+		storage_close(fd);
+		return DB_ALLOCATION_ERROR;
+	}
+	files = NULL;
+	file_count = 0;
+	undo = NULL;
+	undo_count = 0;
+
+	pos = start = commit_end = 0;
+	while (DB_SUCCESS(wal_read(fd, pos, &record, data))) {
+		pos += sizeof(record) + record.length;
+		if (record.type == WAL_RECORD_CHECKPOINT) {
+			start = commit_end = pos;
+			undo_count = 0;
+		} else if (record.type == WAL_RECORD_COMMIT) {
+			commit_end = pos;
+			undo_count = 0;
+		} else if (record.type == WAL_RECORD_UNDO) {
+			undo_count++;
+		}
+	}
+	end = pos;
+	if (end == start) {
+		goto out;
+	}
+	DB_LOG_D("DB: Recovering %lu bytes of the log, %lu of them committed\n", end - start, commit_end - start);
+
+	if (undo_count > 0) {
+		undo = (unsigned long *)malloc(undo_count * sizeof(unsigned long));
+		if (undo == NULL) {
+			res = DB_ALLOCATION_ERROR;
+			goto out;
+		}
+		i = 0;
+		for (pos = commit_end; pos < end; pos += sizeof(record) + record.length) {
+			wal_read(fd, pos, &record, data);
+			if (record.type == WAL_RECORD_UNDO) {
+				undo[i++] = pos;
+			}
+		}
+		while (--i >= 0) {
+			wal_read(fd, undo[i], &record, data);
+			wal_apply(&record, data);
+		}
+	}
+
+	/* The first size which a tuple file logged is its size at the
+	 * checkpoint, the committed rows follow it. */
+	for (pos = start; pos < end; pos += sizeof(record) + record.length) {
+		wal_read(fd, pos, &record, data);
+		if (record.type == WAL_RECORD_SIZE || (record.type == WAL_RECORD_WRITE && pos < commit_end)) {
+			file = wal_find_file(&files, &file_count, record.file_name);
+			if (file == NULL) {
+				res = DB_ALLOCATION_ERROR;
+				goto out;
+			}
+			if (record.type == WAL_RECORD_SIZE && !file->has_size) {
+				file->size = record.offset;
+				file->has_size = 1;
+			} else if (record.type == WAL_RECORD_WRITE && record.offset + record.length > file->end) {
+				file->end = record.offset + record.length;
+			}
+		}
+	}
+	for (i = 0; i < file_count; i++) {
+		if (files[i].has_size) {
+			wal_cut(files[i].file_name, files[i].size > files[i].end ? files[i].size : files[i].end, data);
+		}
+	}
+
+	for (pos = start; pos < commit_end; pos += sizeof(record) + record.length) {
+		wal_read(fd, pos, &record, data);
+		if (record.type == WAL_RECORD_WRITE) {
+			wal_apply(&record, data);
+		}
+	}
+
+out:
+	storage_close(fd);
+	free(files);
+	free(undo);
+	free(data);
+	return res;
+}
+
+static void *wal_checkpointer(void *arg)
+{
+	struct timespec deadline;
+
+	pthread_mutex_lock(&g_wal_lock);
+	while (!g_wal.stop) {
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += DB_WAL_CHECKPOINT_INTERVAL;
+		while (!g_wal.stop && !g_wal.checkpoint) {
+			if (pthread_cond_timedwait(&g_checkpoint_cond, &g_wal_lock, &deadline) == ETIMEDOUT) {
+				break;
+			}
+		}
+		if (g_wal.stop) {
+			break;
+		}
+		g_wal.checkpoint = 0;
+		pthread_mutex_unlock(&g_wal_lock);
+
+		db_lock();
+		if (DB_ERROR(wal_checkpoint())) {
+			DB_LOG_E("DB: Failed to checkpoint the log\n");
+		}
+		db_unlock();
+
+		pthread_mutex_lock(&g_wal_lock);
+	}
+	pthread_mutex_unlock(&g_wal_lock);
+
+	return NULL;
+}
+
+/****************************************************************************
+* Public Functions
+****************************************************************************/
+db_result_t wal_init(void)
+{
+	pthread_attr_t attr;
+	db_result_t res;
+
+	if (g_wal.started) {
+		return DB_OK;
+	}
+
+	res = wal_recover();
+	if (DB_ERROR(res)) {
+		DB_LOG_E("DB: Failed to recover from the log\n");
+		return res;
+	}
+
+	g_wal.buffers = (unsigned char *)malloc(2 * DB_WAL_BUFFER_SIZE);
+	if (g_wal.buffers == NULL) {
+		DB_LOG_E("DB: Failed to allocate the log buffers\n");
+		return DB_ALLOCATION_ERROR;
+	}
+	g_wal.fd = wal_open_empty(0);
+	if (g_wal.fd < 0) {
+		DB_LOG_E("DB: Failed to open the log\n");
+		free(g_wal.buffers);
+		g_wal.buffers = NULL;
+		return DB_STORAGE_ERROR;
+	}
+
+	pthread_cond_init(&g_wal_cond, NULL);
+	pthread_cond_init(&g_checkpoint_cond, NULL);
+	g_wal.buffer = g_wal.buffers;
+	g_wal.io_buffer = g_wal.buffers + DB_WAL_BUFFER_SIZE;
+	g_wal.fill = 0;
+	g_wal.lsn = g_wal.start_lsn = g_wal.durable_lsn = g_wal.commit_lsn = 0;
+	g_wal.io = g_wal.appending = 0;
+	g_wal.checkpoint = g_wal.stop = 0;
+	g_wal.file_count = 0;
+	memset(&g_wal.stats, 0, sizeof(g_wal.stats));
+	g_wal.started = 1;
+
+#if DB_WAL_CHECKPOINT_INTERVAL > 0
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, DB_WAL_STACK_SIZE);
+	if (pthread_create(&g_wal.thread, &attr, wal_checkpointer, NULL) == 0) {
+		pthread_setname_np(g_wal.thread, "arastorage_wal");
+		g_wal.checkpointer = 1;
+	} else {
+		/* The statements which fill the log checkpoint it */
+		DB_LOG_E("DB: Failed to start the checkpointer\n");
+	}
+	pthread_attr_destroy(&attr);
+#endif
+
+	return DB_OK;
+}
+
+void wal_stop(void)
+{
+	pthread_mutex_lock(&g_wal_lock);
+	if (!g_wal.checkpointer) {
+		pthread_mutex_unlock(&g_wal_lock);
+		return;
+	}
+	g_wal.stop = 1;
+	pthread_cond_signal(&g_checkpoint_cond);
+	pthread_mutex_unlock(&g_wal_lock);
+
+	pthread_join(g_wal.thread, NULL);
+	g_wal.checkpointer = 0;
+	g_wal.stop = 0;
+}
+
+void wal_deinit(void)
+{
+	if (!g_wal.started) {
+		return;
+	}
+	wal_checkpoint();
+
+	pthread_mutex_lock(&g_wal_lock);
+	while (g_wal.io || g_wal.appending) {
+		pthread_cond_wait(&g_wal_cond, &g_wal_lock);
+	}
+	g_wal.started = 0;
+	if (g_wal.fd >= 0) {
+		storage_close(g_wal.fd);
+	}
+	g_wal.fd = INVALID_STORAGE_ID;
+	free(g_wal.buffers);
+	g_wal.buffers = g_wal.buffer = g_wal.io_buffer = NULL;
+	pthread_cond_broadcast(&g_wal_cond);
+	pthread_mutex_unlock(&g_wal_lock);
+}
+
+db_result_t wal_log(uint8_t type, const char *filename, unsigned long offset, const void *data, unsigned length, wal_lsn_t *lsn)
+{
+	struct wal_record_s record;
+	const unsigned char *ptr = (const unsigned char *)data;
+	unsigned n;
+	db_result_t res = DB_OK;
+
+	pthread_mutex_lock(&g_wal_lock);
+	if (!g_wal.started) {
+		pthread_mutex_unlock(&g_wal_lock);
+		*lsn = 0;
+		return DB_OK;
+	}
+	/* The bytes of a record are not mixed with those of another task */
+	while (g_wal.appending) {
+		pthread_cond_wait(&g_wal_cond, &g_wal_lock);
+	}
+	g_wal.appending = 1;
+
+	do {
+		n = length > WAL_DATA_LIMIT ? WAL_DATA_LIMIT : length;
+		memset(&record, 0, sizeof(record));
+		record.length = n;
+		record.type = type;
+		record.offset = offset;
+		if (filename != NULL) {
+			strncpy(record.file_name, filename, DB_MAX_FILENAME_LENGTH - 1);
+		}
+		record.checksum = wal_checksum(&record, ptr, n);
+		res = wal_put(&record, sizeof(record));
+		if (DB_SUCCESS(res) && n > 0) {
+			res = wal_put(ptr, n);
+		}
+		ptr += n;
+		offset += n;
+		length -= n;
+	} while (DB_SUCCESS(res) && length > 0);
+
+	g_wal.appending = 0;
+	*lsn = g_wal.lsn;
+	pthread_cond_broadcast(&g_wal_cond);
+	pthread_mutex_unlock(&g_wal_lock);
+
+	return res;
+}
+
+/* Recovery cuts the rows which a statement that did not commit appended to
+ * a tuple file, so the file logs its size before it first grows. */
+db_result_t wal_log_size(const char *filename, db_storage_id_t fd)
+{
+	off_t size;
+	wal_lsn_t lsn;
+	db_result_t res;
+	int i;
+
+	if (!g_wal.started) {
+		return DB_OK;
+	}
+	for (i = 0; i < g_wal.file_count; i++) {
+		if (strncmp(g_wal.files[i], filename, DB_MAX_FILENAME_LENGTH) == 0) {
+			return DB_OK;
+		}
+	}
+
+	size = storage_seek(fd, 0, SEEK_END);
+	if (size == (off_t)-1) {
+		return DB_STORAGE_ERROR;
+	}
+	res = wal_log(WAL_RECORD_SIZE, filename, size, NULL, 0, &lsn);
+	if (DB_SUCCESS(res)) {
+		res = wal_sync(lsn);
+	}
+	if (DB_ERROR(res)) {
+		return res;
+	}
+
+	/* A file which is dropped from the list is synced, as the checkpoint
+	 * syncs only the files in the list. */
+	if (g_wal.file_count == DB_WAL_FILE_LIMIT) {
+		wal_sync_file(g_wal.files[0]);
+		memmove(g_wal.files[0], g_wal.files[1], (DB_WAL_FILE_LIMIT - 1) * DB_MAX_FILENAME_LENGTH);
+		g_wal.file_count--;
+	}
+	strncpy(g_wal.files[g_wal.file_count], filename, DB_MAX_FILENAME_LENGTH - 1);
+	g_wal.files[g_wal.file_count][DB_MAX_FILENAME_LENGTH - 1] = '\0';
+	g_wal.file_count++;
+
+	return DB_OK;
+}
+
+db_result_t wal_commit(wal_lsn_t *lsn)
+{
+	wal_lsn_t size;
+	db_result_t res;
+
+	if (!g_wal.started) {
+		*lsn = 0;
+		return buffer_pool_flush(NULL);
+	}
+
+	/* The pages stay in the pool, only the modified bytes are logged.  The
+	 * index entries which are cached outside of the pool are written first. */
+	res = index_sync();
+	if (DB_SUCCESS(res)) {
+		res = buffer_pool_log();
+	}
+
+	pthread_mutex_lock(&g_wal_lock);
+	*lsn = g_wal.lsn;
+	size = g_wal.lsn - g_wal.start_lsn;
+	pthread_mutex_unlock(&g_wal_lock);
+	if (*lsn != g_wal.commit_lsn && DB_SUCCESS(res)) {
+		res = wal_log(WAL_RECORD_COMMIT, NULL, 0, NULL, 0, lsn);
+		if (DB_SUCCESS(res)) {
+			g_wal.commit_lsn = *lsn;
+			g_wal.stats.commits++;
+		}
+	}
+
+	if (size >= DB_WAL_CHECKPOINT_SIZE) {
+		pthread_mutex_lock(&g_wal_lock);
+		g_wal.checkpoint = 1;
+		pthread_cond_signal(&g_checkpoint_cond);
+		pthread_mutex_unlock(&g_wal_lock);
+		/* The log is emptied here if the checkpointer does not keep up */
+		if (!g_wal.checkpointer || size >= 2 * DB_WAL_CHECKPOINT_SIZE) {
+			if (DB_ERROR(wal_checkpoint()) && DB_SUCCESS(res)) {
+				res = DB_STORAGE_ERROR;
+			}
+		}
+	}
+
+	return res;
+}
+
+/* The first task which waits writes and syncs the records of all tasks, the
+ * others wait for it.  Records which are appended meanwhile are synced by
+ * the next one. */
+db_result_t wal_sync(wal_lsn_t lsn)
+{
+	db_result_t res = DB_OK;
+
+	pthread_mutex_lock(&g_wal_lock);
+	while (g_wal.started && WAL_BEFORE(g_wal.durable_lsn, lsn)) {
+		if (g_wal.io) {
+			pthread_cond_wait(&g_wal_cond, &g_wal_lock);
+			continue;
+		}
+		res = wal_write_out(true);
+		if (DB_ERROR(res)) {
+			break;
+		}
+	}
+	pthread_mutex_unlock(&g_wal_lock);
+
+	return res;
+}
+
+/* Called with the database lock.  A checkpoint in the middle of a statement
+ * commits what the statement wrote so far. */
+db_result_t wal_checkpoint(void)
+{
+	wal_lsn_t lsn;
+	db_result_t res = DB_OK;
+	int i;
+
+	if (!g_wal.started) {
+		return DB_OK;
+	}
+#ifdef CONFIG_ARASTORAGE_ENABLE_WRITE_BUFFER
+	if (DB_ERROR(storage_flush_insert_buffer())) {
+		res = DB_STORAGE_ERROR;
+	}
+#endif
+
+	pthread_mutex_lock(&g_wal_lock);
+	lsn = g_wal.lsn;
+	pthread_mutex_unlock(&g_wal_lock);
+	if (lsn == g_wal.start_lsn) {
+		return res;
+	}
+
+	/* The pages are written after the records which hold them */
+	if (DB_ERROR(wal_sync(lsn))) {
+		return DB_STORAGE_ERROR;
+	}
+	if (DB_ERROR(buffer_pool_flush(NULL))) {
+		res = DB_STORAGE_ERROR;
+	}
+	for (i = 0; i < g_wal.file_count; i++) {
+		wal_sync_file(g_wal.files[i]);
+	}
+	if (DB_ERROR(res)) {
+		/* The log is kept for recovery */
+		return res;
+	}
+
+	pthread_mutex_lock(&g_wal_lock);
+	while (g_wal.io || g_wal.appending) {
+		pthread_cond_wait(&g_wal_cond, &g_wal_lock);
+	}
+	if (g_wal.fd >= 0) {
+		storage_close(g_wal.fd);
+	}
+	g_wal.fd = wal_open_empty(g_wal.lsn);
+	if (g_wal.fd < 0) {
+		/* The next write of the log opens it again */
+		DB_LOG_E("DB: Failed to empty the log\n");
+	}
+	/* The records in the buffer are in the files too */
+	g_wal.fill = 0;
+	g_wal.start_lsn = g_wal.durable_lsn = g_wal.commit_lsn = g_wal.lsn;
+	g_wal.file_count = 0;
+	g_wal.stats.checkpoints++;
+	pthread_cond_broadcast(&g_wal_cond);
+	pthread_mutex_unlock(&g_wal_lock);
+
+	return res;
+}
+
+void wal_get_stats(db_wal_stats_t *stats)
+{
+	pthread_mutex_lock(&g_wal_lock);
+	memcpy(stats, &g_wal.stats, sizeof(*stats));
+	pthread_mutex_unlock(&g_wal_lock);
+}
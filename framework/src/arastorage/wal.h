@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/**
+ * \file
+ *      A write-ahead log of the tuple files and the index files.
+ *
+ *      Rows are logged when they are inserted, and modified pages of the
+ *      buffer pool when a statement commits.  The log is appended
+ *      sequentially and synced once for all statements which commit while
+ *      the previous sync runs, and the pages stay in the pool until a
+ *      checkpoint writes them into their files and empties the log.
+ *
+ *      A page is written to its file only after the log which holds it is
+ *      synced.  When a page of the running statement has to be evicted, the
+ *      bytes which it replaces are logged too, and a tuple file logs its
+ *      size before it first grows after a checkpoint.  db_init() undoes
+ *      what a statement which did not commit wrote, and redoes the
+ *      statements which committed.
+ */
+
+#ifndef WAL_H
+#define WAL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <arastorage/arastorage.h>
+#include "buffer_pool.h"
+
+/****************************************************************************
+* Public Type Definitions
+****************************************************************************/
+/* The number of bytes appended to the log before a record, since db_init() */
+typedef uint32_t wal_lsn_t;
+
+#define WAL_RECORD_WRITE  1		/* bytes written to a file */
+#define WAL_RECORD_UNDO   2		/* bytes of a file before a statement wrote them */
+#define WAL_RECORD_SIZE   3		/* size of a tuple file before it grows */
+#define WAL_RECORD_COMMIT 4
+#define WAL_RECORD_CHECKPOINT 5	/* the records before it are in the files */
+
+/****************************************************************************
+* Global Function Prototypes
+****************************************************************************/
+#ifdef CONFIG_ARASTORAGE_WAL
+/* Recover from the log and start the checkpointer */
+db_result_t wal_init(void);
+/* Stop the checkpointer, which takes the database lock */
+void wal_stop(void);
+void wal_deinit(void);
+
+/* Append a record, lsn is set to its end */
+db_result_t wal_log(uint8_t type, const char *filename, unsigned long offset, const void *data, unsigned length, wal_lsn_t *lsn);
+
+/* Called before the tuple file of fd grows */
+db_result_t wal_log_size(const char *filename, db_storage_id_t fd);
+
+/* Log the pages modified by the statement and commit it.  The statement is
+ * on storage once wal_sync(lsn) returns, which is called without the
+ * database lock so that other statements commit in the meantime. */
+db_result_t wal_commit(wal_lsn_t *lsn);
+db_result_t wal_sync(wal_lsn_t lsn);
+
+/* Write everything into the files and empty the log */
+db_result_t wal_checkpoint(void);
+
+void wal_get_stats(db_wal_stats_t *stats);
+#else
+#define wal_init() DB_OK
+#define wal_stop()
+#define wal_deinit()
+#define wal_commit(lsn) (*(lsn) = 0, buffer_pool_flush(NULL))
+#define wal_sync(lsn) ((void)(lsn), DB_OK)
+#define wal_checkpoint()
+#endif
+
+#endif							/* WAL_H */
@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/include/irq.h
+ ****************************************************************************/
+
+/* This file should never be included directed but, rather,
+ * only indirectly through tinyara/irq.h
+ */
+
+#ifndef __ARCH_SIM_INCLUDE_IRQ_H
+#define __ARCH_SIM_INCLUDE_IRQ_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/irq.h>
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* The simulation has no interrupt controller.  The system timer tick and
+ * the host devices are serviced synchronously from the IDLE loop, so there
+ * are no IRQ numbers to attach to.
+ */
+
+#define NR_IRQS 0
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+
+/* This struct defines the way the registers are stored.  The processor
+ * state itself is kept in a host ucontext that is allocated and managed
+ * by the host-side part of the port (up_hostcontext.c); TinyAra only
+ * carries an opaque reference to it.
+ */
+
+struct xcptcontext {
+	/* Opaque reference to the host ucontext of this thread */
+
+	void *ctx;
+
+	/* The following function pointer is non-zero if there are pending
+	 * signals to be processed.  Signals are delivered the next time that
+	 * the thread is resumed.
+	 */
+
+	void *sigdeliver;
+};
+#endif
+
+/****************************************************************************
+ * Inline functions
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+
+/* There are no asynchronous interrupts in the simulation:  every event that
+ * would be an interrupt on real hardware is dispatched from the IDLE loop.
+ * Disabling interrupts is therefore a no-op.
+ */
+
+static inline irqstate_t irqsave(void)
+{
+	return 0;
+}
+
+static inline void irqrestore(irqstate_t flags)
+{
+}
+
+#endif
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+#endif							/* __ARCH_SIM_INCLUDE_IRQ_H */
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/sim/include/board.h
+ ****************************************************************************/
+
+#ifndef __ARCH_SIM_SRC_SIM_INCLUDE_BOARD_H__
+#define __ARCH_SIM_SRC_SIM_INCLUDE_BOARD_H__
+
+/* The simulation has no LEDs; these values exist only so that common code
+ * that references them still compiles.
+ */
+
+#define LED_STARTED       0
+#define LED_HEAPALLOCATE  1
+#define LED_IRQSENABLED   2
+#define LED_STACKCREATED  3
+#define LED_INIRQ         4
+#define LED_SIGNAL        5
+#define LED_ASSERTION     6
+#define LED_PANIC         7
+
+#endif /* __ARCH_SIM_SRC_SIM_INCLUDE_BOARD_H__ */
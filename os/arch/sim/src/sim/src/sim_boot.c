@@ -0,0 +1,147 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/sim/src/sim_boot.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/mount.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/board.h>
+#include <tinyara/fs/mtd.h>
+#ifdef CONFIG_FS_SMARTFS
+#include <tinyara/fs/mksmartfs.h>
+#endif
+
+#include "up_internal.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SIM_PROCFS_MOUNTPOINT "/proc"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_mount_flash
+ *
+ * Description:
+ *   Put smartfs on the file-backed flash and mount it.  The flash keeps
+ *   its contents between runs, so it is only formatted the first time.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_AUTOMOUNT_FLASH
+static void sim_mount_flash(void)
+{
+	FAR struct mtd_dev_s *mtd;
+	int ret;
+
+	mtd = up_mtdinitialize();
+	if (!mtd) {
+		lldbg("ERROR: Failed to create the simulated flash\n");
+		return;
+	}
+
+	ret = smart_initialize(CONFIG_SIM_FLASH_DEV_NUMBER, mtd, NULL);
+	if (ret < 0) {
+		lldbg("ERROR: smart_initialize failed: %d\n", ret);
+		return;
+	}
+
+	ret = mount(CONFIG_SIM_FLASH_DEV_POINT, CONFIG_SIM_FLASH_MOUNT_POINT, "smartfs", 0, NULL);
+	if (ret < 0) {
+		/* No file system yet; create one and try again */
+
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+		(void)mksmartfs(CONFIG_SIM_FLASH_DEV_POINT, 1, false);
+#else
+		(void)mksmartfs(CONFIG_SIM_FLASH_DEV_POINT, false);
+#endif
+		ret = mount(CONFIG_SIM_FLASH_DEV_POINT, CONFIG_SIM_FLASH_MOUNT_POINT, "smartfs", 0, NULL);
+		if (ret < 0) {
+			lldbg("ERROR: Failed to mount %s: %d\n", CONFIG_SIM_FLASH_DEV_POINT, errno);
+		}
+	}
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: board_app_initialize
+ *
+ * Description:
+ *   Perform architecture specific initialization
+ *
+ ****************************************************************************/
+
+int board_app_initialize(void)
+{
+#ifdef CONFIG_SIM_AUTOMOUNT_PROCFS
+	int ret;
+
+	/* Mount the procfs file system */
+
+	ret = mount(NULL, SIM_PROCFS_MOUNTPOINT, "procfs", 0, NULL);
+	if (ret < 0) {
+		lldbg("Failed to mount procfs at %s: %d\n", SIM_PROCFS_MOUNTPOINT, ret);
+	}
+#endif
+
+#ifdef CONFIG_SIM_AUTOMOUNT_FLASH
+	sim_mount_flash();
+#endif
+
+	return OK;
+}
+
+#ifdef CONFIG_BOARD_INITIALIZE
+/****************************************************************************
+ * Name: board_initialize
+ *
+ * Description:
+ *   If CONFIG_BOARD_INITIALIZE is selected, then an additional
+ *   initialization call will be performed in the boot-up sequence to a
+ *   function called board_initialize().  board_initialize() will be
+ *   called immediately after up_initialize() is called and just before the
+ *   initial application is started.  This additional initialization phase
+ *   may be used, for example, to initialize board-specific device drivers.
+ *
+ ****************************************************************************/
+
+void board_initialize(void)
+{
+	/* Perform app-specific initialization here instead of from the TASH. */
+
+	board_app_initialize();
+}
+#endif							/* CONFIG_BOARD_INITIALIZE */
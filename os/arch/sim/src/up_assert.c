@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_assert.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+
+#include "sched/sched.h"
+#include "up_internal.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: _up_assert
+ ****************************************************************************/
+
+static void _up_assert(int errorcode) noreturn_function;
+static void _up_assert(int errorcode)
+{
+	/* Are we in an interrupt handler or the idle task?  Then there is
+	 * nothing to return to; stop the whole simulation so that the host
+	 * can collect a core dump.
+	 */
+
+	if (g_sim_inirq || (this_task())->pid == 0) {
+		host_abort(errorcode);
+	} else {
+		exit(errorcode);
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_assert
+ ****************************************************************************/
+
+#ifdef CONFIG_HAVE_FILENAME
+void up_assert(const uint8_t *filename, int lineno)
+#else
+void up_assert(void)
+#endif
+{
+#ifdef CONFIG_PRINT_TASKNAME
+	struct tcb_s *rtcb = this_task();
+#endif
+
+#ifdef CONFIG_HAVE_FILENAME
+#ifdef CONFIG_PRINT_TASKNAME
+	lldbg("Assertion failed at file:%s line: %d task: %s\n", filename, lineno, rtcb->name);
+#else
+	lldbg("Assertion failed at file:%s line: %d\n", filename, lineno);
+#endif
+#else
+#ifdef CONFIG_PRINT_TASKNAME
+	lldbg("Assertion failed: task: %s\n", rtcb->name);
+#else
+	lldbg("Assertion failed\n");
+#endif
+#endif
+
+	_up_assert(EXIT_FAILURE);
+}
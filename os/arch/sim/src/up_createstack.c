@@ -0,0 +1,128 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_createstack.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <sched.h>
+#include <debug.h>
+#include <errno.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/arch.h>
+
+#include "up_internal.h"
+
+/****************************************************************************
+ * Pre-processor Macros
+ ****************************************************************************/
+
+/* Stack alignment macros */
+
+#define STACK_ALIGN_MASK    (SIM_STACK_ALIGNMENT - 1)
+#define STACK_ALIGN_DOWN(a) ((a) & ~STACK_ALIGN_MASK)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_create_stack
+ *
+ * Description:
+ *   Allocate a stack for a new thread and setup up stack-related information
+ *   in the TCB.
+ *
+ *   The following TCB fields must be initialized by this function:
+ *
+ *   - adj_stack_size: Stack size after adjustment for hardware, processor,
+ *     etc.  This value is retained only for debug purposes.
+ *   - stack_alloc_ptr: Pointer to allocated stack
+ *   - adj_stack_ptr: Adjusted stack_alloc_ptr for HW.  The initial value of
+ *     the stack pointer.
+ *
+ * Inputs:
+ *   - tcb: The TCB of new task
+ *   - stack_size:  The requested stack size.  At least this much
+ *     must be allocated.
+ *   - ttype:  The thread type.  This may be one of following (defined in
+ *     include/tinyara/sched.h):
+ *
+ *       TCB_FLAG_TTYPE_TASK     Normal user task
+ *       TCB_FLAG_TTYPE_PTHREAD  User pthread
+ *       TCB_FLAG_TTYPE_KERNEL   Kernel thread
+ *
+ ****************************************************************************/
+
+int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
+{
+	/* Is there already a stack allocated of a different size? */
+
+	if (tcb->stack_alloc_ptr && tcb->adj_stack_size != stack_size) {
+		/* Yes.. Release the old stack */
+
+		up_release_stack(tcb, ttype);
+	}
+
+	/* Do we need to allocate a new stack? */
+
+	if (!tcb->stack_alloc_ptr) {
+		/* The simulation is always a flat build, so every thread type uses
+		 * the single user heap.  Host stacks must be 16-byte aligned.
+		 */
+
+		tcb->stack_alloc_ptr = (uint32_t *)kumm_memalign(SIM_STACK_ALIGNMENT, stack_size);
+
+#ifdef CONFIG_DEBUG
+		if (!tcb->stack_alloc_ptr) {
+			sdbg("ERROR: Failed to allocate stack, size %d\n", stack_size);
+		}
+#endif
+	}
+
+	/* Did we successfully allocate a stack? */
+
+	if (tcb->stack_alloc_ptr) {
+		uintptr_t top_of_stack;
+
+		/* The x86 uses a push-down stack.  adj_stack_ptr holds the initial
+		 * stack pointer, i.e. the aligned address just past the end of the
+		 * allocation.
+		 */
+
+		top_of_stack = STACK_ALIGN_DOWN((uintptr_t)tcb->stack_alloc_ptr + stack_size);
+
+		tcb->adj_stack_ptr = (FAR void *)top_of_stack;
+		tcb->adj_stack_size = top_of_stack - (uintptr_t)tcb->stack_alloc_ptr;
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+		heapinfo_exclude_stacksize(tcb->stack_alloc_ptr);
+#endif
+		return OK;
+	}
+
+	return -ENOMEM;
+}
@@ -0,0 +1,257 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_devconsole.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/fs/fs.h>
+#include <tinyara/arch.h>
+
+#include "up_internal.h"
+
+#ifdef CONFIG_SIM_CONSOLE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Maximum number of threads than can be waiting for POLL events */
+
+#define CONSOLE_NPOLLWAITERS 2
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct up_console_s {
+	sem_t rxsem;				/* Wakes up readers when input arrives */
+	int nwaiters;				/* Number of readers waiting on rxsem */
+#ifndef CONFIG_DISABLE_POLL
+	FAR struct pollfd *fds[CONSOLE_NPOLLWAITERS];
+#endif
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static ssize_t devconsole_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+static ssize_t devconsole_write(FAR struct file *filep, FAR const char *buffer, size_t buflen);
+#ifndef CONFIG_DISABLE_POLL
+static int devconsole_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct file_operations devconsole_fops = {
+	0,							/* open */
+	0,							/* close */
+	devconsole_read,			/* read */
+	devconsole_write,			/* write */
+	0,							/* seek */
+	0							/* ioctl */
+#ifndef CONFIG_DISABLE_POLL
+	, devconsole_poll			/* poll */
+#endif
+};
+
+static struct up_console_s g_console;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: devconsole_read
+ ****************************************************************************/
+
+static ssize_t devconsole_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	irqstate_t flags;
+	size_t nread = 0;
+
+	if (buflen == 0) {
+		return 0;
+	}
+
+	/* Wait for the first character.  The host console is only polled from
+	 * the IDLE loop, so block here rather than spin.
+	 */
+
+	flags = irqsave();
+	while (!host_console_avail()) {
+		if ((filep->f_oflags & O_NONBLOCK) != 0) {
+			irqrestore(flags);
+			return -EAGAIN;
+		}
+
+		g_console.nwaiters++;
+		if (sem_wait(&g_console.rxsem) < 0) {
+			g_console.nwaiters--;
+			irqrestore(flags);
+			return -get_errno();
+		}
+	}
+	irqrestore(flags);
+
+	/* Then return whatever else is already buffered */
+
+	do {
+		buffer[nread++] = (char)host_console_getc();
+	} while (nread < buflen && host_console_avail());
+
+	return nread;
+}
+
+/****************************************************************************
+ * Name: devconsole_write
+ ****************************************************************************/
+
+static ssize_t devconsole_write(FAR struct file *filep, FAR const char *buffer, size_t buflen)
+{
+	size_t i;
+
+	for (i = 0; i < buflen; i++) {
+		up_putc(buffer[i]);
+	}
+
+	return buflen;
+}
+
+/****************************************************************************
+ * Name: devconsole_poll
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_POLL
+static int devconsole_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
+{
+	irqstate_t flags;
+	int i;
+
+	flags = irqsave();
+
+	if (setup) {
+		/* Find an available slot for the poll structure reference */
+
+		for (i = 0; i < CONSOLE_NPOLLWAITERS; i++) {
+			if (!g_console.fds[i]) {
+				g_console.fds[i] = fds;
+				fds->priv = &g_console.fds[i];
+				break;
+			}
+		}
+
+		if (i >= CONSOLE_NPOLLWAITERS) {
+			fds->priv = NULL;
+			irqrestore(flags);
+			return -EBUSY;
+		}
+
+		/* Output never blocks; input is ready if the host has some */
+
+		fds->revents |= (fds->events & POLLOUT);
+		if (host_console_avail()) {
+			fds->revents |= (fds->events & POLLIN);
+		}
+
+		if (fds->revents != 0) {
+			sem_post(fds->sem);
+		}
+	} else if (fds->priv) {
+		/* This is a request to tear down the poll. */
+
+		*(FAR struct pollfd **)fds->priv = NULL;
+		fds->priv = NULL;
+	}
+
+	irqrestore(flags);
+	return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_devconsole
+ *
+ * Description:
+ *   Register /dev/console
+ *
+ ****************************************************************************/
+
+void up_devconsole(void)
+{
+	sem_init(&g_console.rxsem, 0, 0);
+	host_console_initialize();
+	(void)register_driver("/dev/console", &devconsole_fops, 0666, NULL);
+}
+
+/****************************************************************************
+ * Name: up_devconsole_poll
+ *
+ * Description:
+ *   Called from the IDLE loop.  If the host has console input pending,
+ *   wake up any waiting readers and pollers.
+ *
+ ****************************************************************************/
+
+void up_devconsole_poll(void)
+{
+#ifndef CONFIG_DISABLE_POLL
+	int i;
+#endif
+
+	if (!host_console_avail()) {
+		return;
+	}
+
+	while (g_console.nwaiters > 0) {
+		g_console.nwaiters--;
+		sem_post(&g_console.rxsem);
+	}
+
+#ifndef CONFIG_DISABLE_POLL
+	for (i = 0; i < CONSOLE_NPOLLWAITERS; i++) {
+		FAR struct pollfd *fds = g_console.fds[i];
+		if (fds && (fds->events & POLLIN) != 0) {
+			fds->revents |= POLLIN;
+			sem_post(fds->sem);
+		}
+	}
+#endif
+}
+
+#endif							/* CONFIG_SIM_CONSOLE */
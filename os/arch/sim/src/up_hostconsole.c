@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_hostconsole.c
+ *
+ * NOTE: This file is compiled against the host C library, not against the
+ * TinyAra headers.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct termios g_cooked;
+static int g_raw;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_console_restore
+ *
+ * Description:
+ *   Put the terminal back the way we found it when the simulation exits.
+ *
+ ****************************************************************************/
+
+static void host_console_restore(void)
+{
+	if (g_raw) {
+		tcsetattr(0, TCSANOW, &g_cooked);
+		g_raw = 0;
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_console_initialize
+ *
+ * Description:
+ *   Put the host terminal (if stdin is one) into raw mode so that TinyAra
+ *   sees every key stroke, including control characters.  ISIG is left on
+ *   so that Ctrl-C still terminates the simulation.
+ *
+ ****************************************************************************/
+
+void host_console_initialize(void)
+{
+	struct termios raw;
+
+	if (!isatty(0) || tcgetattr(0, &g_cooked) < 0) {
+		return;
+	}
+
+	raw = g_cooked;
+	raw.c_iflag &= ~(ICRNL | IXON);
+	raw.c_lflag &= ~(ICANON | ECHO);
+	raw.c_oflag &= ~OPOST;
+
+	if (tcsetattr(0, TCSANOW, &raw) == 0) {
+		g_raw = 1;
+		atexit(host_console_restore);
+	}
+}
+
+/****************************************************************************
+ * Name: host_console_avail
+ *
+ * Description:
+ *   Return non-zero if a character can be read without blocking.
+ *
+ ****************************************************************************/
+
+int host_console_avail(void)
+{
+	struct pollfd fd;
+
+	fd.fd = 0;
+	fd.events = POLLIN;
+	fd.revents = 0;
+
+	return poll(&fd, 1, 0) > 0 && (fd.revents & POLLIN) != 0;
+}
+
+/****************************************************************************
+ * Name: host_console_getc
+ ****************************************************************************/
+
+int host_console_getc(void)
+{
+	unsigned char ch;
+
+	if (read(0, &ch, 1) != 1) {
+		return -1;
+	}
+
+	return ch;
+}
+
+/****************************************************************************
+ * Name: host_console_putc
+ ****************************************************************************/
+
+void host_console_putc(int ch)
+{
+	unsigned char c = (unsigned char)ch;
+
+	(void)write(1, &c, 1);
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_hostcontext.c
+ *
+ * NOTE: This file is compiled against the host C library, not against the
+ * TinyAra headers.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_context_create
+ *
+ * Description:
+ *   Allocate a host execution context.  If entry is NULL, the context is
+ *   left empty; it is filled in the first time the current thread of
+ *   execution is switched out (this is how the IDLE thread adopts the
+ *   host's main stack).  Otherwise the context will begin execution at
+ *   entry() on the supplied stack.
+ *
+ ****************************************************************************/
+
+void *host_context_create(void (*entry)(void), void *stack, size_t size)
+{
+	ucontext_t *uc;
+
+	uc = (ucontext_t *)calloc(1, sizeof(ucontext_t));
+	if (!uc) {
+		return NULL;
+	}
+
+	if (entry) {
+		if (getcontext(uc) < 0) {
+			free(uc);
+			return NULL;
+		}
+
+		uc->uc_stack.ss_sp = stack;
+		uc->uc_stack.ss_size = size;
+		uc->uc_link = NULL;
+		makecontext(uc, entry, 0);
+	}
+
+	return uc;
+}
+
+/****************************************************************************
+ * Name: host_context_destroy
+ ****************************************************************************/
+
+void host_context_destroy(void *ctx)
+{
+	free(ctx);
+}
+
+/****************************************************************************
+ * Name: host_context_switch
+ *
+ * Description:
+ *   Save the current context in prev and resume next.  Returns when prev is
+ *   resumed.
+ *
+ ****************************************************************************/
+
+void host_context_switch(void *prev, void *next)
+{
+	swapcontext((ucontext_t *)prev, (const ucontext_t *)next);
+}
+
+/****************************************************************************
+ * Name: host_context_restore
+ *
+ * Description:
+ *   Resume next without saving the current context.
+ *
+ ****************************************************************************/
+
+void host_context_restore(void *next)
+{
+	setcontext((const ucontext_t *)next);
+	abort();
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_hostmmap.c
+ *
+ * NOTE: This file is compiled against the host C library, not against the
+ * TinyAra headers.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_mapfile
+ *
+ * Description:
+ *   Map size bytes of the host file at path, shared, read-write.  If the
+ *   file does not exist or has a different size, it is (re)created and
+ *   filled with the erased flash value 0xff and *created is set.
+ *
+ ****************************************************************************/
+
+void *host_mapfile(const char *path, size_t size, int *created)
+{
+	struct stat st;
+	void *mem;
+	int fd;
+
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		return NULL;
+	}
+
+	*created = (fstat(fd, &st) < 0 || (size_t)st.st_size != size);
+	if (*created && ftruncate(fd, size) < 0) {
+		close(fd);
+		return NULL;
+	}
+
+	mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mem == MAP_FAILED) {
+		return NULL;
+	}
+
+	if (*created) {
+		memset(mem, 0xff, size);
+	}
+
+	return mem;
+}
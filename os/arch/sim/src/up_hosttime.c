@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_hosttime.c
+ *
+ * NOTE: This file is compiled against the host C library, not against the
+ * TinyAra headers.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_gettime_usec
+ *
+ * Description:
+ *   Return the host monotonic clock in microseconds.
+ *
+ ****************************************************************************/
+
+uint64_t host_gettime_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: host_sleep_until
+ *
+ * Description:
+ *   Sleep until the host monotonic clock reaches usec.
+ *
+ ****************************************************************************/
+
+void host_sleep_until(uint64_t usec)
+{
+	struct timespec ts;
+
+	ts.tv_sec = usec / 1000000;
+	ts.tv_nsec = (usec % 1000000) * 1000;
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) ;
+}
+
+/****************************************************************************
+ * Name: host_abort
+ *
+ * Description:
+ *   Terminate the simulation.  A non-zero status raises SIGABRT so that
+ *   the host leaves a core dump to inspect.
+ *
+ ****************************************************************************/
+
+void host_abort(int status)
+{
+	if (status != 0) {
+		abort();
+	}
+
+	exit(0);
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_idle.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <tinyara/arch.h>
+
+#include "sched/sched.h"
+#include "up_internal.h"
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* True while the IDLE loop is processing a simulated timer interrupt.
+ * Context switches requested by the scheduler in that window are deferred
+ * until the tick processing has completed.
+ */
+
+volatile bool g_sim_inirq;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_idle
+ *
+ * Description:
+ *   up_idle() is the logic that will be executed when their is no other
+ *   ready-to-run task.  This is processor idle time and will continue until
+ *   some interrupt occurs to cause a context switch from the idle task.
+ *
+ *   The simulation has no asynchronous interrupts; this is where they are
+ *   emulated.  Each pass services the system timer and polls the host
+ *   console and network device.  If any of that readied a task, switch to
+ *   it now.
+ *
+ ****************************************************************************/
+
+void up_idle(void)
+{
+	FAR struct tcb_s *rtcb = this_task();
+
+	g_sim_inirq = true;
+
+	/* Run the system timer */
+
+	up_timer_tick();
+
+#ifdef CONFIG_SIM_CONSOLE
+	/* Check for pending console input */
+
+	up_devconsole_poll();
+#endif
+
+#ifdef CONFIG_SIM_NETDEV
+	/* Receive frames and run the network timers */
+
+	up_netdriver_poll();
+#endif
+
+	g_sim_inirq = false;
+
+	/* Perform the context switch that was deferred while in "interrupt"
+	 * context, or deliver any signal that was queued for the IDLE thread.
+	 */
+
+	if (rtcb != this_task()) {
+		up_switchcontext(rtcb, this_task());
+	} else {
+		up_sigdeliver(rtcb);
+	}
+}
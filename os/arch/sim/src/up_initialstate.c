@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_initialstate.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sched.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/sched.h>
+
+#include "sched/sched.h"
+#include "up_internal.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_start
+ *
+ * Description:
+ *   Every new thread begins execution here, on its own stack.  Deliver any
+ *   signals that were queued before the thread first ran, then enter the
+ *   TinyAra start-up function (task_start() or pthread_start()).  Those
+ *   never return.
+ *
+ ****************************************************************************/
+
+static void up_start(void)
+{
+	FAR struct tcb_s *rtcb = this_task();
+
+	up_sigdeliver(rtcb);
+	rtcb->start();
+
+	PANIC();
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_initial_state
+ *
+ * Description:
+ *   A new thread is being started and a new TCB
+ *   has been created. This function is called to initialize
+ *   the processor specific portions of the new TCB.
+ *
+ *   This function must setup the intial architecture registers
+ *   and/or  stack so that execution will begin at tcb->start
+ *   on the next context switch.
+ *
+ ****************************************************************************/
+
+void up_initial_state(struct tcb_s *tcb)
+{
+	/* Discard any context that was built for a previous stack layout */
+
+	if (tcb->xcp.ctx) {
+		host_context_destroy(tcb->xcp.ctx);
+	}
+
+	tcb->xcp.sigdeliver = NULL;
+
+	if (tcb->pid == 0) {
+		/* The IDLE thread runs on the host's main stack.  Its context is
+		 * captured the first time that it is switched out.
+		 */
+
+		tcb->xcp.ctx = host_context_create(NULL, NULL, 0);
+	} else {
+		tcb->xcp.ctx = host_context_create(up_start, tcb->stack_alloc_ptr, tcb->adj_stack_size);
+	}
+
+	DEBUGASSERT(tcb->xcp.ctx != NULL);
+}
@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_internal.h
+ ****************************************************************************/
+
+#ifndef __ARCH_SIM_SRC_UP_INTERNAL_H
+#define __ARCH_SIM_SRC_UP_INTERNAL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#ifndef __ASSEMBLY__
+#include <tinyara/compiler.h>
+#include <tinyara/sched.h>
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Determine which (if any) console driver to use */
+
+#if CONFIG_NFILE_DESCRIPTORS == 0 || !defined(CONFIG_DEV_CONSOLE)
+#undef CONFIG_SIM_CONSOLE
+#endif
+
+/* Determine which device to use as the system logging device */
+
+#ifndef CONFIG_SYSLOG
+#undef CONFIG_SYSLOG_CHAR
+#undef CONFIG_RAMLOG_SYSLOG
+#endif
+
+/* This is the value used to mark the stack for subsequent stack monitoring
+ * logic.
+ */
+
+#define STACK_COLOR    0xdeadbeef
+#define HEAP_COLOR     'h'
+
+/* Host stacks must be 16-byte aligned for the x86 ABIs */
+
+#define SIM_STACK_ALIGNMENT 16
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/* This is non-zero while the IDLE loop is dispatching a simulated interrupt
+ * (the system timer tick or a host device event).  Context switches that
+ * are requested while it is set are deferred until the dispatch completes,
+ * exactly as they would be on exit from a real interrupt handler.
+ */
+
+EXTERN volatile bool g_sim_inirq;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* up_switchcontext.c *******************************************************/
+
+void up_sigdeliver(FAR struct tcb_s *rtcb);
+void up_switchcontext(FAR struct tcb_s *prev, FAR struct tcb_s *next);
+void up_restorecontext(FAR struct tcb_s *next) noreturn_function;
+
+/* up_timer.c ***************************************************************/
+
+void up_timer_initialize(void);
+void up_timer_tick(void);
+
+/* up_devconsole.c **********************************************************/
+
+#ifdef CONFIG_SIM_CONSOLE
+void up_devconsole(void);
+void up_devconsole_poll(void);
+#endif
+
+/* up_mtd.c *****************************************************************/
+
+#ifdef CONFIG_SIM_MTD
+struct mtd_dev_s;
+FAR struct mtd_dev_s *up_mtdinitialize(void);
+#endif
+
+/* up_netdev.c **************************************************************/
+
+#ifdef CONFIG_SIM_NETDEV
+void up_netinitialize(void);
+void up_netdriver_poll(void);
+#else
+#define up_netinitialize()
+#endif
+
+/* Host interfaces **********************************************************/
+
+/* These functions are implemented in the host-side files (up_host*.c,
+ * up_tapdev.c).  Those are compiled against the host C library rather than
+ * the TinyAra headers, so only plain C types may cross this boundary.
+ */
+
+/* up_hostcontext.c */
+
+void *host_context_create(void (*entry)(void), void *stack, size_t size);
+void host_context_destroy(void *ctx);
+void host_context_switch(void *prev, void *next);
+void host_context_restore(void *next) noreturn_function;
+
+/* up_hosttime.c */
+
+uint64_t host_gettime_usec(void);
+void host_sleep_until(uint64_t usec);
+void host_abort(int status) noreturn_function;
+
+/* up_hostconsole.c */
+
+void host_console_initialize(void);
+int host_console_avail(void);
+int host_console_getc(void);
+void host_console_putc(int ch);
+
+/* up_hostmmap.c */
+
+void *host_mapfile(const char *path, size_t size, int *created);
+
+/* up_tapdev.c */
+
+#ifdef CONFIG_SIM_NET_TAP
+int tapdev_init(const char *ifname);
+int tapdev_read(unsigned char *buf, unsigned int buflen);
+void tapdev_send(const unsigned char *buf, unsigned int buflen);
+void tapdev_sendv(const unsigned char **bufs, const unsigned int *lens, int nbufs);
+#endif
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+#endif							/* __ASSEMBLY__ */
+
+#endif							/* __ARCH_SIM_SRC_UP_INTERNAL_H */
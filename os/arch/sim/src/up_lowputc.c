@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_lowputc.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <tinyara/arch.h>
+
+#include "up_internal.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_putc
+ *
+ * Description:
+ *   Provide priority, low-level access to support OS debug writes.  The
+ *   host terminal is in raw mode, so expand LF to CR-LF here.
+ *
+ ****************************************************************************/
+
+int up_putc(int ch)
+{
+	if (ch == '\n') {
+		host_console_putc('\r');
+	}
+
+	host_console_putc(ch);
+	return ch;
+}
+
+/****************************************************************************
+ * Name: up_getc
+ *
+ * Description:
+ *   Read one character from the host console, waiting if none is available.
+ *
+ ****************************************************************************/
+
+int up_getc(void)
+{
+	return host_console_getc();
+}
+
+/****************************************************************************
+ * Name: up_puts
+ *
+ * Description:
+ *   Output a string on the host console.
+ *
+ ****************************************************************************/
+
+void up_puts(FAR const char *str)
+{
+	while (*str) {
+		up_putc(*str++);
+	}
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_mtd.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <debug.h>
+
+#include <tinyara/fs/mtd.h>
+
+#include "up_internal.h"
+
+#ifdef CONFIG_SIM_MTD
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_RAMMTD_ERASESIZE
+#define CONFIG_RAMMTD_ERASESIZE 4096
+#endif
+
+#if (CONFIG_SIM_MTD_SIZE % CONFIG_RAMMTD_ERASESIZE) != 0
+#error "CONFIG_SIM_MTD_SIZE must be a multiple of CONFIG_RAMMTD_ERASESIZE"
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_mtdinitialize
+ *
+ * Description:
+ *   Map CONFIG_SIM_MTD_FILE into memory and return an MTD device instance
+ *   for it.  The RAM MTD driver does not touch the media on initialization,
+ *   so whatever was written during the previous run is still there.
+ *
+ ****************************************************************************/
+
+FAR struct mtd_dev_s *up_mtdinitialize(void)
+{
+	FAR uint8_t *start;
+	int created;
+
+	start = (FAR uint8_t *)host_mapfile(CONFIG_SIM_MTD_FILE, CONFIG_SIM_MTD_SIZE, &created);
+	if (!start) {
+		fdbg("ERROR: Failed to map %s\n", CONFIG_SIM_MTD_FILE);
+		return NULL;
+	}
+
+	fvdbg("%s %s, %d bytes\n", created ? "Created" : "Mapped", CONFIG_SIM_MTD_FILE, CONFIG_SIM_MTD_SIZE);
+
+	return rammtd_initialize(start, CONFIG_SIM_MTD_SIZE);
+}
+
+#endif							/* CONFIG_SIM_MTD */
@@ -0,0 +1,449 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_netdev.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arpa/inet.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/net/ethernet.h>
+
+#include <net/lwip/netif.h>
+#include <net/lwip/tcpip.h>
+
+#include "up_internal.h"
+
+#ifdef CONFIG_SIM_NETDEV
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Number of frames that the loopback backend can hold between polls */
+
+#define SIM_NET_NLOOP 4
+
+#define SIM_NET_BUFSIZE (MAX_NET_DEV_MTU + CONFIG_NET_GUARDSIZE)
+
+/* Longest pbuf chain sent to the TAP device without gathering it first */
+
+#define SIM_NET_NIOV 8
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ZEROCOPY
+struct sim_rxbuf_s {
+	struct pbuf_custom pbuf;	/* Handed to lwIP, must be first */
+	bool busy;					/* Held by the backend or by lwIP */
+	uint16_t len;
+	uint8_t buf[SIM_NET_BUFSIZE];
+};
+#elif defined(CONFIG_SIM_NET_LOOPBACK)
+struct sim_loopframe_s {
+	uint16_t len;
+	uint8_t buf[SIM_NET_BUFSIZE];
+};
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct netif g_sim_dev;
+
+#ifdef CONFIG_NET_MULTIBUFFER
+static uint8_t g_sim_pktbuf[SIM_NET_BUFSIZE];
+#endif
+
+#ifdef CONFIG_NET_ZEROCOPY
+static struct sim_rxbuf_s g_sim_rxbuf[CONFIG_SIM_NET_NRXBUF];
+#endif
+
+#ifdef CONFIG_SIM_NET_LOOPBACK
+#ifdef CONFIG_NET_ZEROCOPY
+static struct sim_rxbuf_s *g_sim_loop[SIM_NET_NLOOP];
+#else
+static struct sim_loopframe_s g_sim_loop[SIM_NET_NLOOP];
+#endif
+static unsigned int g_sim_loophead;
+static unsigned int g_sim_looptail;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: netdev_ifup
+ *
+ * Description:
+ *   TinyAra Callback: Bring up the interface.
+ *
+ ****************************************************************************/
+
+static int netdev_ifup(struct netif *dev)
+{
+	netif_set_link_up(dev);
+	netif_set_up(dev);
+	return OK;
+}
+
+/****************************************************************************
+ * Function: netdev_ifdown
+ *
+ * Description:
+ *   TinyAra Callback: Stop the interface.
+ *
+ ****************************************************************************/
+
+static int netdev_ifdown(struct netif *dev)
+{
+	netif_set_down(dev);
+	netif_set_link_down(dev);
+	return OK;
+}
+
+#ifdef CONFIG_NET_ZEROCOPY
+/****************************************************************************
+ * Function: netdev_rxbuf_alloc
+ *
+ * Description:
+ *   Take a receive buffer which is not held by lwIP.
+ *
+ ****************************************************************************/
+
+static struct sim_rxbuf_s *netdev_rxbuf_alloc(void)
+{
+	irqstate_t flags;
+	int i;
+
+	flags = irqsave();
+	for (i = 0; i < CONFIG_SIM_NET_NRXBUF; i++) {
+		if (!g_sim_rxbuf[i].busy) {
+			g_sim_rxbuf[i].busy = true;
+			irqrestore(flags);
+			return &g_sim_rxbuf[i];
+		}
+	}
+	irqrestore(flags);
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Function: netdev_rxbuf_free
+ *
+ * Description:
+ *   lwIP callback: lwIP no longer references the frame of a receive buffer.
+ *
+ ****************************************************************************/
+
+static void netdev_rxbuf_free(struct pbuf *p)
+{
+	((struct sim_rxbuf_s *)p)->busy = false;
+}
+
+/****************************************************************************
+ * Function: netdev_txpbuf
+ *
+ * Description:
+ *   lwIP has a frame to send.  Hand its pbuf chain to the host backend.
+ *   A frame which does not fit in a frame buffer is refused with
+ *   -EMSGSIZE.
+ *
+ ****************************************************************************/
+
+static int netdev_txpbuf(struct netif *dev, struct pbuf *p)
+{
+#ifdef CONFIG_SIM_NET_TAP
+	const unsigned char *bufs[SIM_NET_NIOV];
+	unsigned int lens[SIM_NET_NIOV];
+	struct pbuf *q;
+	int n = 0;
+#else
+	irqstate_t flags;
+	struct sim_rxbuf_s *rxbuf;
+#endif
+
+	if (p->tot_len > SIM_NET_BUFSIZE) {
+		return -EMSGSIZE;
+	}
+
+#ifdef CONFIG_SIM_NET_TAP
+	for (q = p; q != NULL && n < SIM_NET_NIOV; q = q->next) {
+		bufs[n] = q->payload;
+		lens[n++] = q->len;
+	}
+
+	if (q == NULL) {
+		tapdev_sendv(bufs, lens, n);
+		return OK;
+	}
+
+	/* Longer chains are gathered into d_buf */
+
+	dev->d_len = pbuf_copy_partial(p, dev->d_buf, p->tot_len, 0);
+	tapdev_send(dev->d_buf, dev->d_len);
+	dev->d_len = 0;
+#else
+	/* The chain is gathered straight into the buffer it will be received in */
+
+	rxbuf = netdev_rxbuf_alloc();
+	flags = irqsave();
+	if (rxbuf != NULL && g_sim_loophead - g_sim_looptail < SIM_NET_NLOOP) {
+		rxbuf->len = pbuf_copy_partial(p, rxbuf->buf, p->tot_len, 0);
+		g_sim_loop[g_sim_loophead % SIM_NET_NLOOP] = rxbuf;
+		g_sim_loophead++;
+	} else {
+		if (rxbuf != NULL) {
+			rxbuf->busy = false;
+		}
+
+		nlldbg("Loopback full, frame dropped\n");
+	}
+	irqrestore(flags);
+#endif
+
+	return OK;
+}
+
+/****************************************************************************
+ * Function: netdev_receive_rxbuf
+ *
+ * Description:
+ *   Fetch one frame from the host backend into a receive buffer.  Returns
+ *   NULL if nothing is pending or if every receive buffer is held by lwIP.
+ *
+ ****************************************************************************/
+
+static struct sim_rxbuf_s *netdev_receive_rxbuf(void)
+{
+	struct sim_rxbuf_s *rxbuf;
+#ifdef CONFIG_SIM_NET_TAP
+	int len;
+
+	rxbuf = netdev_rxbuf_alloc();
+	if (rxbuf == NULL) {
+		return NULL;
+	}
+
+	len = tapdev_read(rxbuf->buf, SIM_NET_BUFSIZE);
+	if (len == 0) {
+		rxbuf->busy = false;
+		return NULL;
+	}
+
+	rxbuf->len = len;
+#else
+	irqstate_t flags;
+
+	flags = irqsave();
+	if (g_sim_looptail == g_sim_loophead) {
+		irqrestore(flags);
+		return NULL;
+	}
+
+	rxbuf = g_sim_loop[g_sim_looptail % SIM_NET_NLOOP];
+	g_sim_looptail++;
+	irqrestore(flags);
+#endif
+
+	return rxbuf;
+}
+
+#else
+/****************************************************************************
+ * Function: netdev_txavail
+ *
+ * Description:
+ *   lwIP has placed a frame in d_buf.  Hand it to the host backend.
+ *
+ ****************************************************************************/
+
+static int netdev_txavail(struct netif *dev)
+{
+#ifdef CONFIG_SIM_NET_TAP
+	tapdev_send(dev->d_buf, dev->d_len);
+#else
+	irqstate_t flags;
+	struct sim_loopframe_s *frame;
+
+	flags = irqsave();
+	if (g_sim_loophead - g_sim_looptail < SIM_NET_NLOOP) {
+		frame = &g_sim_loop[g_sim_loophead % SIM_NET_NLOOP];
+		memcpy(frame->buf, dev->d_buf, dev->d_len);
+		frame->len = dev->d_len;
+		g_sim_loophead++;
+	} else {
+		nlldbg("Loopback full, frame dropped\n");
+	}
+	irqrestore(flags);
+#endif
+
+	dev->d_len = 0;
+	return OK;
+}
+
+/****************************************************************************
+ * Function: netdev_receive
+ *
+ * Description:
+ *   Fetch one frame from the host backend into d_buf.  Returns the frame
+ *   length, or zero if nothing is pending.
+ *
+ ****************************************************************************/
+
+static int netdev_receive(struct netif *dev)
+{
+#ifdef CONFIG_SIM_NET_TAP
+	return tapdev_read(dev->d_buf, SIM_NET_BUFSIZE);
+#else
+	struct sim_loopframe_s *frame;
+
+	if (g_sim_looptail == g_sim_loophead) {
+		return 0;
+	}
+
+	frame = &g_sim_loop[g_sim_looptail % SIM_NET_NLOOP];
+	memcpy(dev->d_buf, frame->buf, frame->len);
+	g_sim_looptail++;
+
+	return frame->len;
+#endif
+}
+#endif							/* CONFIG_NET_ZEROCOPY */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: up_netdriver_poll
+ *
+ * Description:
+ *   Called from the IDLE loop.  Pass every frame that the host backend has
+ *   pending up to lwIP.
+ *
+ ****************************************************************************/
+
+void up_netdriver_poll(void)
+{
+	struct netif *dev = &g_sim_dev;
+#ifdef CONFIG_NET_ZEROCOPY
+	struct sim_rxbuf_s *rxbuf;
+
+	while ((rxbuf = netdev_receive_rxbuf()) != NULL) {
+		if (rxbuf->len <= ETH_HDRLEN || rxbuf->len > MAX_NET_DEV_MTU) {
+			nlldbg("Bad frame size dropped (%d)\n", rxbuf->len);
+			rxbuf->busy = false;
+			continue;
+		}
+
+		rxbuf->pbuf.custom_free_function = netdev_rxbuf_free;
+		if (ethernetif_input_pbuf(dev, &rxbuf->pbuf, rxbuf->buf, rxbuf->len, SIM_NET_BUFSIZE) != 0) {
+			rxbuf->busy = false;
+			break;
+		}
+	}
+#else
+	int len;
+
+	while ((len = netdev_receive(dev)) > 0) {
+		if (len <= ETH_HDRLEN || len > MAX_NET_DEV_MTU) {
+			nlldbg("Bad frame size dropped (%d)\n", len);
+			continue;
+		}
+
+		dev->d_len = len;
+		if (ethernetif_input(dev) != 0) {
+			/* Out of pbufs; leave the rest for the next pass */
+
+			break;
+		}
+	}
+
+	dev->d_len = 0;
+#endif
+}
+
+/****************************************************************************
+ * Function: up_netinitialize
+ *
+ * Description:
+ *   Register the simulated Ethernet interface with lwIP.
+ *
+ ****************************************************************************/
+
+void up_netinitialize(void)
+{
+	struct netif *dev = &g_sim_dev;
+	ip_addr_t ipaddr;
+	ip_addr_t netmask;
+	ip_addr_t gw;
+
+#ifdef CONFIG_SIM_NET_TAP
+	if (tapdev_init(CONFIG_SIM_NET_TAPDEV) < 0) {
+		ndbg("ERROR: Cannot attach to %s, no network\n", CONFIG_SIM_NET_TAPDEV);
+		return;
+	}
+#endif
+
+	memset(dev, 0, sizeof(struct netif));
+
+#ifdef CONFIG_NET_MULTIBUFFER
+	dev->d_buf = g_sim_pktbuf;
+#endif
+	dev->d_ifup = netdev_ifup;
+	dev->d_ifdown = netdev_ifdown;
+#ifdef CONFIG_NET_ZEROCOPY
+	dev->d_txpbuf = netdev_txpbuf;
+#else
+	dev->d_txavail = netdev_txavail;
+#endif
+	dev->d_private = dev;
+
+	netif_register_with_initial_ip(dev, ethernetif_init);
+
+	/* Replace the lwIP default address with the configured one */
+
+	ipaddr.addr = htonl(CONFIG_SIM_NET_IPADDR);
+	netmask.addr = htonl(CONFIG_SIM_NET_NETMASK);
+	gw.addr = htonl(CONFIG_SIM_NET_DRIPADDR);
+	netif_set_addr(dev, &ipaddr, &netmask, &gw);
+
+	dev->d_ipaddr = dev->ip_addr.addr;
+	dev->d_draddr = dev->gw.addr;
+	dev->d_netmask = dev->netmask.addr;
+}
+
+#endif							/* CONFIG_SIM_NETDEV */
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_releasestack.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sched.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/kmalloc.h>
+
+#include "up_internal.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_release_stack
+ *
+ * Description:
+ *   A task has been stopped. Free all stack related resources retained in
+ *   the defunct TCB.
+ *
+ *   The host context of the thread lives on that stack and is released
+ *   with it.  This may be the context of the running thread when it is
+ *   exiting; that is safe because _exit() resumes the next thread without
+ *   saving the current one.
+ *
+ * Input Parmeters
+ *   - dtcb:  The TCB containing information about the stack to be released
+ *   - ttype:  The thread type.  This may be one of following (defined in
+ *     include/tinyara/sched.h):
+ *
+ *       TCB_FLAG_TTYPE_TASK     Normal user task
+ *       TCB_FLAG_TTYPE_PTHREAD  User pthread
+ *       TCB_FLAG_TTYPE_KERNEL   Kernel thread
+ *
+ ****************************************************************************/
+
+void up_release_stack(FAR struct tcb_s *dtcb, uint8_t ttype)
+{
+	/* Release the host context that runs on this stack */
+
+	if (dtcb->xcp.ctx) {
+		host_context_destroy(dtcb->xcp.ctx);
+		dtcb->xcp.ctx = NULL;
+	}
+
+	/* Is there a stack allocated? */
+
+	if (dtcb->stack_alloc_ptr) {
+		sched_ufree(dtcb->stack_alloc_ptr);
+
+		/* Mark the stack freed */
+
+		dtcb->stack_alloc_ptr = NULL;
+	}
+
+	/* The size of the allocated stack is now zero */
+
+	dtcb->adj_stack_size = 0;
+}
@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_switchcontext.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sched.h>
+#include <debug.h>
+#include <ttrace.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/sched.h>
+
+#include "sched/sched.h"
+#include "up_internal.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_sigdeliver
+ *
+ * Description:
+ *   Deliver any signals that were queued by up_schedule_sigaction() while
+ *   the thread was not running.  This runs in the context of the thread
+ *   that receives the signals, just after it has been resumed.
+ *
+ ****************************************************************************/
+
+void up_sigdeliver(FAR struct tcb_s *rtcb)
+{
+	sig_deliver_t sigdeliver = (sig_deliver_t)rtcb->xcp.sigdeliver;
+
+	if (sigdeliver) {
+		rtcb->xcp.sigdeliver = NULL;
+		sigdeliver(rtcb);
+	}
+}
+
+/****************************************************************************
+ * Name: up_switchcontext
+ *
+ * Description:
+ *   Save the host context of 'prev' and resume 'next'.  This returns when
+ *   'prev' is next selected to run.
+ *
+ *   If the switch is requested while a simulated interrupt is being
+ *   dispatched, nothing is done here:  the IDLE loop performs a single
+ *   switch to whatever task is at the head of the ready-to-run list when
+ *   the dispatch completes.
+ *
+ ****************************************************************************/
+
+void up_switchcontext(FAR struct tcb_s *prev, FAR struct tcb_s *next)
+{
+	if (g_sim_inirq || prev == next) {
+		return;
+	}
+
+	sllvdbg("Switch from %d to %d\n", prev->pid, next->pid);
+	trace_sched(prev, next);
+
+	host_context_switch(prev->xcp.ctx, next->xcp.ctx);
+
+	/* We are back in 'prev'.  Handle any signals that arrived meanwhile. */
+
+	up_sigdeliver(this_task());
+}
+
+/****************************************************************************
+ * Name: up_restorecontext
+ *
+ * Description:
+ *   Resume 'next' without saving the current context.  This is used when
+ *   the running thread has exited and its context will never be resumed.
+ *
+ ****************************************************************************/
+
+void up_restorecontext(FAR struct tcb_s *next)
+{
+	host_context_restore(next->xcp.ctx);
+}
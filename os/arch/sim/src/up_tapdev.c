@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_tapdev.c
+ *
+ * NOTE: This file is compiled against the host C library, not against the
+ * TinyAra headers.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include <linux/if.h>
+#include <linux/if_tun.h>
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int g_tapfd = -1;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tapdev_init
+ *
+ * Description:
+ *   Attach to the host TAP interface ifname, creating it if necessary.
+ *   Configure its address and bring it up from the host, e.g.
+ *
+ *     ip addr add 192.168.0.1/24 dev tap0 && ip link set tap0 up
+ *
+ ****************************************************************************/
+
+int tapdev_init(const char *ifname)
+{
+	struct ifreq ifr;
+
+	g_tapfd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+	if (g_tapfd < 0) {
+		perror("tapdev: open /dev/net/tun");
+		return -1;
+	}
+
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+	strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+
+	if (ioctl(g_tapfd, TUNSETIFF, (unsigned long)&ifr) < 0) {
+		perror("tapdev: TUNSETIFF");
+		close(g_tapfd);
+		g_tapfd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/****************************************************************************
+ * Name: tapdev_read
+ *
+ * Description:
+ *   Return one Ethernet frame if one is waiting, otherwise zero.
+ *
+ ****************************************************************************/
+
+int tapdev_read(unsigned char *buf, unsigned int buflen)
+{
+	ssize_t ret;
+
+	if (g_tapfd < 0) {
+		return 0;
+	}
+
+	ret = read(g_tapfd, buf, buflen);
+	return ret < 0 ? 0 : (int)ret;
+}
+
+/****************************************************************************
+ * Name: tapdev_send
+ ****************************************************************************/
+
+void tapdev_send(const unsigned char *buf, unsigned int buflen)
+{
+	if (g_tapfd >= 0) {
+		(void)write(g_tapfd, buf, buflen);
+	}
+}
+
+/****************************************************************************
+ * Name: tapdev_sendv
+ *
+ * Description:
+ *   Send one Ethernet frame made of nbufs pieces.
+ *
+ ****************************************************************************/
+
+void tapdev_sendv(const unsigned char **bufs, const unsigned int *lens, int nbufs)
+{
+	struct iovec iov[nbufs];
+	int i;
+
+	if (g_tapfd >= 0) {
+		for (i = 0; i < nbufs; i++) {
+			iov[i].iov_base = (void *)bufs[i];
+			iov[i].iov_len = lens[i];
+		}
+
+		(void)writev(g_tapfd, iov, nbufs);
+	}
+}
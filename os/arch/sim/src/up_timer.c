@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_timer.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <tinyara/arch.h>
+#include <tinyara/clock.h>
+
+#include "up_internal.h"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_WALLTIME
+/* Host time (in microseconds) at which the next tick is due */
+
+static uint64_t g_next_tick;
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_timer_initialize
+ *
+ * Description:
+ *   Start the simulated system timer.  The first tick is due one tick
+ *   interval from now.
+ *
+ ****************************************************************************/
+
+void up_timer_initialize(void)
+{
+#ifdef CONFIG_SIM_WALLTIME
+	g_next_tick = host_gettime_usec() + USEC_PER_TICK;
+#endif
+}
+
+/****************************************************************************
+ * Name: up_timer_tick
+ *
+ * Description:
+ *   Called from the IDLE loop in simulated interrupt context.  With
+ *   CONFIG_SIM_WALLTIME, sleep until the next tick is due and then announce
+ *   every tick that has elapsed on the host clock, so that a host that was
+ *   busy elsewhere does not make the simulated clock drift.  Otherwise,
+ *   announce exactly one tick.
+ *
+ ****************************************************************************/
+
+void up_timer_tick(void)
+{
+#ifdef CONFIG_SIM_WALLTIME
+	uint64_t now;
+
+	host_sleep_until(g_next_tick);
+
+	now = host_gettime_usec();
+	while (now >= g_next_tick) {
+		sched_process_timer();
+		g_next_tick += USEC_PER_TICK;
+	}
+#else
+	sched_process_timer();
+#endif
+}
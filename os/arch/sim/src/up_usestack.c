@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/sim/src/up_usestack.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <sched.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+
+#include "up_internal.h"
+
+/****************************************************************************
+ * Pre-processor Macros
+ ****************************************************************************/
+
+/* Stack alignment macros */
+
+#define STACK_ALIGN_MASK    (SIM_STACK_ALIGNMENT - 1)
+#define STACK_ALIGN_DOWN(a) ((a) & ~STACK_ALIGN_MASK)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_use_stack
+ *
+ * Description:
+ *   Setup up stack-related information in the TCB using pre-allocated stack
+ *   memory.  This function is called only from task_init() when a task or
+ *   kernel thread is started (never for pthreads).
+ *
+ *   The following TCB fields must be initialized:
+ *
+ *   - adj_stack_size: Stack size after adjustment for hardware,
+ *     processor, etc.  This value is retained only for debug
+ *     purposes.
+ *   - stack_alloc_ptr: Pointer to allocated stack
+ *   - adj_stack_ptr: Adjusted stack_alloc_ptr for HW.  The
+ *     initial value of the stack pointer.
+ *
+ * Inputs:
+ *   - tcb: The TCB of new task
+ *   - stack_size:  The allocated stack size.
+ *
+ ****************************************************************************/
+
+int up_use_stack(FAR struct tcb_s *tcb, FAR void *stack, size_t stack_size)
+{
+	uintptr_t top_of_stack;
+
+	/* Is there already a stack allocated? */
+
+	if (tcb->stack_alloc_ptr) {
+		/* Yes... Release the old stack allocation */
+
+		up_release_stack(tcb, tcb->flags & TCB_FLAG_TTYPE_MASK);
+	}
+
+	/* Save the new stack allocation */
+
+	tcb->stack_alloc_ptr = stack;
+
+	/* Align the initial stack pointer as required by the host ABI */
+
+	top_of_stack = STACK_ALIGN_DOWN((uintptr_t)stack + stack_size);
+
+	tcb->adj_stack_ptr = (FAR void *)top_of_stack;
+	tcb->adj_stack_size = top_of_stack - (uintptr_t)stack;
+
+	return OK;
+}
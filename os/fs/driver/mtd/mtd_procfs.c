@@ -104,6 +104,10 @@ static int mtd_dup(FAR const struct file *oldp, FAR struct file *newp);
 
 static int mtd_stat(FAR const char *relpath, FAR struct stat *buf);
 
+#ifdef CONFIG_MTD_WRITE_LATENCY
+static int mtd_latency_print(FAR struct mtd_dev_s *mtd, FAR char *buffer, size_t buflen);
+#endif
+
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
@@ -232,6 +236,11 @@ static ssize_t mtd_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
 
 		do {
 			ret = snprintf(&buffer[total], buflen - total, "%-5d%s\n", priv->pnextmtd->mtdno, priv->pnextmtd->name);
+#ifdef CONFIG_MTD_WRITE_LATENCY
+			if (ret + total < buflen) {
+				ret += mtd_latency_print(priv->pnextmtd, &buffer[total + ret], buflen - total - ret);
+			}
+#endif
 
 			if (ret + total < buflen) {
 				total += ret;
@@ -252,6 +261,41 @@ static ssize_t mtd_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
 	return total;
 }
 
+/****************************************************************************
+ * Name: mtd_latency_print
+ *
+ * Description:
+ *   Print the write latency histogram of an MTD device on one line.  The
+ *   counts are labeled with the upper bound of their bucket in milliseconds.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_WRITE_LATENCY
+static int mtd_latency_print(FAR struct mtd_dev_s *mtd, FAR char *buffer, size_t buflen)
+{
+	int total;
+	int ret;
+	int x;
+
+	total = snprintf(buffer, buflen, "     Write ms");
+	for (x = 0; x < MTD_WRITE_LATENCY_BUCKETS && total < buflen; x++) {
+		if (x < MTD_WRITE_LATENCY_BUCKETS - 1) {
+			ret = snprintf(&buffer[total], buflen - total, " <%d:%u", 1 << x, mtd->wrlatency[x]);
+		} else {
+			ret = snprintf(&buffer[total], buflen - total, " >=%d:%u", 1 << (x - 1), mtd->wrlatency[x]);
+		}
+
+		total += ret;
+	}
+
+	if (total < buflen) {
+		total += snprintf(&buffer[total], buflen - total, "\n");
+	}
+
+	return total;
+}
+#endif
+
 /****************************************************************************
  * Name: mtd_dup
  *
@@ -334,6 +378,9 @@ int mtd_register(FAR struct mtd_dev_s *mtd, FAR const char *name)
 	mtd->mtdno = g_nextmtdno++;
 	mtd->name = name;
 	mtd->pnext = NULL;
+#ifdef CONFIG_MTD_WRITE_LATENCY
+	memset(mtd->wrlatency, 0, sizeof(mtd->wrlatency));
+#endif
 
 	/* Add to the list of registered devices */
 
@@ -357,4 +404,24 @@ int mtd_register(FAR struct mtd_dev_s *mtd, FAR const char *name)
 	return OK;
 }
 
+/****************************************************************************
+ * Name: mtd_write_latency
+ *
+ * Description:
+ *   Adds the latency of one write to the histogram of an MTD device.  Bucket
+ *   n counts the writes which took less than 2^n milliseconds.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_WRITE_LATENCY
+void mtd_write_latency(FAR struct mtd_dev_s *mtd, uint32_t msec)
+{
+	int bucket;
+
+	for (bucket = 0; bucket < MTD_WRITE_LATENCY_BUCKETS - 1 && msec >= (1 << bucket); bucket++) ;
+
+	mtd->wrlatency[bucket]++;
+}
+#endif
+
 #endif							/* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -79,6 +79,13 @@
 #include <tinyara/fs/mtd.h>
 #include <tinyara/fs/smart_procfs.h>
 #include <tinyara/fs/smart.h>
+#if defined(CONFIG_MTD_SMART_BACKGROUND_GC) || defined(CONFIG_MTD_WRITE_LATENCY)
+#include <tinyara/clock.h>
+#endif
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+#include <semaphore.h>
+#include <tinyara/wqueue.h>
+#endif
 
 /****************************************************************************
  * Private Definitions
@@ -126,6 +133,7 @@
 #define SMART_FMT_VERSION_POS     (SMART_FMT_POS1 + 4)
 #define SMART_FMT_NAMESIZE_POS    (SMART_FMT_POS1 + 5)
 #define SMART_FMT_ROOTDIRS_POS    (SMART_FMT_POS1 + 6)
+#define SMART_FMT_CKPT_POS        (SMART_FMT_POS1 + 7)	/* Erase blocks of a checkpoint slot */
 #define SMARTFS_FMT_WEAR_POS      36
 #define SMART_WEAR_LEVEL_FORMAT_SIG 32
 #define SMART_PARTNAME_SIZE         4
@@ -154,9 +162,45 @@
 #define offsetof(type, member) ((size_t)&(((type *)0)->member))
 #endif
 
-#define SMART_MAX_ALLOCS        6
+#define SMART_MAX_ALLOCS        8
+
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+#define SMART_MAP_PAGE_SECTORS  256		/* Logical sectors per page of the packed map */
+#define SMART_MAP_NO_SLOT       0xFF
+#define SMART_MAP_NO_PAGE       0xFFFF
+#endif
 //#define CONFIG_MTD_SMART_PACK_COUNTS
 
+/* Erase blocks with released sectors are kept in lists by their release
+ * count, so that garbage collection does not have to scan all of them.
+ */
+
+#define SMART_GC_BUCKETS        16
+#define SMART_GC_END            0xFFFF
+#define SMART_GC_NO_BUCKET      0xFF
+
+/* Background garbage collection only collects blocks with at least a
+ * quarter of released sectors.
+ */
+
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+#define SMART_GC_MIN_RELEASE(d) ((d)->availSectPerBlk >= 4 ? (d)->availSectPerBlk >> 2 : 1)
+#endif
+
+/* The checkpoint of the volume metadata is kept in two slots of erase blocks
+ * at the end of the device.  A log entry holds an erase block number plus
+ * one, the overflow entry marks a log which was full.
+ */
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+#define SMART_CKPT_MAGIC        "SMCP"
+#define SMART_CKPT_COMMITTED    ((uint8_t)~CONFIG_SMARTFS_ERASEDSTATE)
+#define SMART_CKPT_LOG_EMPTY    ((CONFIG_SMARTFS_ERASEDSTATE << 8) | CONFIG_SMARTFS_ERASEDSTATE)
+#define SMART_CKPT_LOG_OVERFLOW ((uint16_t)~SMART_CKPT_LOG_EMPTY)
+#define SMART_CKPT_TEST(m, b)   ((m)[(b) >> 3] & (1 << ((b) & 0x07)))
+#define SMART_CKPT_SET(m, b)    ((m)[(b) >> 3] |= 1 << ((b) & 0x07))
+#endif
+
 #ifndef CONFIG_MTD_SMART_ALLOC_DEBUG
 #define smart_malloc(d, b, n)   kmm_malloc(b)
 #define smart_free(d, p)        kmm_free(p)
@@ -216,12 +260,43 @@ static const uint8_t gWearBitToLevelMap4[] = {
  ****************************************************************************/
 
 #ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+/* The packed map keeps the physical sector of each logical sector in
+ * mapbits bits.  It is divided into pages of SMART_MAP_PAGE_SECTORS logical
+ * sectors, and the pages which do not fit in the RAM budget share slots.
+ */
+
+struct smart_mapslot_s {
+	uint16_t page;				/* Map page held by this slot */
+	uint16_t birth;				/* The "birthday" of the last access */
+};
+#else
 struct smart_cache_s {
 	uint16_t logical;			/* Logical sector number */
 	uint16_t physical;			/* Associated physical sector */
 	uint16_t birth;				/* The "birthday" of this entry */
 };
 #endif
+#endif
+
+/* Header of a checkpoint.  It is followed, one sector later, by the sector
+ * map and the release and free counts, and then by the log of the erase
+ * blocks changed since the checkpoint.
+ */
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+struct smart_ckpt_header_s {
+	uint8_t magic[4];			/* SMART_CKPT_MAGIC */
+	uint32_t seq;				/* Incremented by each checkpoint */
+	uint16_t totalsectors;		/* Geometry the checkpoint was written for */
+	uint16_t neraseblocks;
+	uint16_t sectorsize;
+	uint16_t freesectors;		/* Total number of free sectors */
+	uint16_t releasesectors;	/* Total number of released sectors */
+	uint16_t crc;				/* CRC-16 of the map and the counts */
+	uint8_t commit;				/* Written last: SMART_CKPT_COMMITTED */
+};
+#endif
 
 /* When CRC is enabled, we allocate sectors in memory only and only write
  * to the device when an actual writesector is performed.  If during the
@@ -258,6 +333,10 @@ struct smart_struct_s {
 	uint32_t erasesize;			/* Size of an erase block */
 	FAR uint8_t *releasecount;	/* Count of released sectors per erase block */
 	FAR uint8_t *freecount;	/* Count of free sectors per erase block */
+	FAR uint16_t *gcnext;		/* Next erase block in the same GC bucket */
+	FAR uint16_t *gcprev;		/* Previous erase block in the same GC bucket */
+	FAR uint8_t *gcbucket;		/* GC bucket of each erase block */
+	uint16_t gchead[SMART_GC_BUCKETS];	/* First erase block of each GC bucket */
 	FAR char *rwbuffer;			/* Our sector read/write buffer */
 	FAR uint8_t *bytebuffer;	/* Array of bytes to be used in smart_bytewrite */
 	char
@@ -290,12 +369,24 @@ struct smart_struct_s {
 	FAR uint16_t *sMap;			/* Virtual to physical sector map */
 #else
 	FAR uint8_t *sBitMap;		/* Virtual sector used bit-map */
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	FAR struct smart_mapslot_s *mapslots;	/* Map page held by each slot */
+	FAR uint8_t *mapdata;		/* Packed map entries of the slots */
+	FAR uint8_t *mapslotof;		/* Slot of each map page or SMART_MAP_NO_SLOT */
+	uint16_t mappages;			/* Number of map pages */
+	uint16_t mappagesize;		/* Bytes in a map page */
+	uint16_t map_nextbirth;		/* Map page aging value */
+	uint8_t mapslotcount;		/* Number of map pages kept in RAM */
+	uint8_t mapbits;			/* Bits in a map entry */
+	uint32_t mapmisses;			/* Map pages rebuilt from the sector headers */
+#else
 	FAR struct smart_cache_s *sCache;	/* Sector cache */
 	uint16_t cache_entries;	/* Number of valid entries in the cache */
 	uint16_t cache_lastlog;	/* Keep track of the last sector accessed */
 	uint16_t cache_lastphys;	/* Keep the physical sector number also */
 	uint16_t cache_nextbirth;	/* Sector cache aging value */
 #endif
+#endif
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 	FAR uint8_t *erasecounts;	/* Number of erases for each erase block */
 #endif
@@ -304,6 +395,23 @@ struct smart_struct_s {
 	struct smart_alloc_s
 			alloc[SMART_MAX_ALLOCS];	/* Array of memory allocations */
 #endif
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	FAR uint8_t *ckptdirty;		/* Erase blocks logged since the checkpoint */
+	uint32_t ckptseq;			/* Sequence number of the last checkpoint */
+	uint32_t ckptlogaddr;		/* Address of the log of the checkpoint */
+	uint16_t ckptfirst;			/* First erase block of the checkpoint slots */
+	uint16_t ckptblocks;		/* Erase blocks in a checkpoint slot */
+	uint16_t ckptlogcount;		/* Entries in the log */
+	uint16_t ckptlogmax;		/* Entries which fit in the log */
+	uint8_t ckptslot;			/* Slot of the last checkpoint */
+	bool ckptvalid;				/* The checkpoint and its log are up to date */
+	bool ckptneeded;			/* A new checkpoint must be written */
+#endif
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+	sem_t exclsem;				/* Serializes the accesses to the device */
+	struct work_s gcwork;		/* Background garbage collection work */
+	systime_t lastaccess;		/* Time of the last access to the device */
+#endif
 };
 
 #define SMART_WEARFLAGS_FORCE_REORG    0x01
@@ -409,6 +517,11 @@ static int smart_relocate_static_data(FAR struct smart_struct_s *dev, uint16_t b
 
 static int smart_relocate_sector(FAR struct smart_struct_s *dev, uint16_t oldsector, uint16_t newsector);
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+static void smart_ckpt_dirty(FAR struct smart_struct_s *dev, uint16_t block);
+static void smart_ckpt_invalidate(FAR struct smart_struct_s *dev);
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -616,6 +729,119 @@ static void smart_add_count(struct smart_struct_s *dev, uint8_t *pCount, uint16_
 }
 #endif
 
+/****************************************************************************
+ * Name: smart_semtake
+ *
+ * Description: Take the semaphore which serializes the accesses to the
+ *              device with the background garbage collection.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+static void smart_semtake(FAR struct smart_struct_s *dev)
+{
+	/* Take the semaphore (perhaps waiting) */
+
+	while (sem_wait(&dev->exclsem) != 0) {
+		/* The only case that an error should occur here is if the wait
+		 * was awakened by a signal.
+		 */
+
+		DEBUGASSERT(errno == EINTR);
+	}
+}
+
+#define smart_semgive(d) sem_post(&(d)->exclsem)
+#else
+#define smart_semtake(d)
+#define smart_semgive(d)
+#endif
+
+/****************************************************************************
+ * Name: smart_gc_update
+ *
+ * Description: Move an erase block to the garbage collection bucket of its
+ *              current release count.  Must be called whenever the release
+ *              count of the block changes.  Blocks without released sectors
+ *              are not in any bucket.
+ *
+ ****************************************************************************/
+
+static void smart_gc_update(FAR struct smart_struct_s *dev, uint16_t block)
+{
+	uint16_t count;
+	uint8_t bucket;
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	count = smart_get_count(dev, dev->releasecount, block);
+#else
+	count = dev->releasecount[block];
+#endif
+
+	if (count == 0) {
+		bucket = SMART_GC_NO_BUCKET;
+	} else {
+		bucket = (count * SMART_GC_BUCKETS) / (dev->availSectPerBlk + 1);
+	}
+
+	if (bucket == dev->gcbucket[block]) {
+		return;
+	}
+
+	/* Unlink the block from its old bucket */
+
+	if (dev->gcbucket[block] != SMART_GC_NO_BUCKET) {
+		if (dev->gcprev[block] == SMART_GC_END) {
+			dev->gchead[dev->gcbucket[block]] = dev->gcnext[block];
+		} else {
+			dev->gcnext[dev->gcprev[block]] = dev->gcnext[block];
+		}
+
+		if (dev->gcnext[block] != SMART_GC_END) {
+			dev->gcprev[dev->gcnext[block]] = dev->gcprev[block];
+		}
+	}
+
+	/* And add it to the head of the new one */
+
+	dev->gcbucket[block] = bucket;
+	if (bucket != SMART_GC_NO_BUCKET) {
+		dev->gcprev[block] = SMART_GC_END;
+		dev->gcnext[block] = dev->gchead[bucket];
+		if (dev->gchead[bucket] != SMART_GC_END) {
+			dev->gcprev[dev->gchead[bucket]] = block;
+		}
+
+		dev->gchead[bucket] = block;
+	}
+}
+
+/****************************************************************************
+ * Name: smart_gc_rebuild
+ *
+ * Description: Empty the garbage collection buckets and, if the release
+ *              counts are valid, put every erase block in its bucket.
+ *
+ ****************************************************************************/
+
+static void smart_gc_rebuild(FAR struct smart_struct_s *dev, bool valid)
+{
+	uint16_t block;
+	int x;
+
+	for (x = 0; x < SMART_GC_BUCKETS; x++) {
+		dev->gchead[x] = SMART_GC_END;
+	}
+
+	memset(dev->gcbucket, SMART_GC_NO_BUCKET, dev->neraseblocks);
+
+	if (valid) {
+		for (block = 0; block < dev->neraseblocks; block++) {
+			smart_gc_update(dev, block);
+		}
+	}
+}
+
 /****************************************************************************
  * Name: smart_checkfree
  *
@@ -754,6 +980,7 @@ static ssize_t smart_reload(struct smart_struct_s *dev, FAR uint8_t *buffer, off
 static ssize_t smart_read(FAR struct inode *inode, unsigned char *buffer, size_t start_sector, unsigned int nsectors)
 {
 	struct smart_struct_s *dev;
+	ssize_t ret;
 
 	fvdbg("SMART: sector: %d nsectors: %d\n", start_sector, nsectors);
 
@@ -763,7 +990,10 @@ static ssize_t smart_read(FAR struct inode *inode, unsigned char *buffer, size_t
 #else
 	dev = (struct smart_struct_s *)inode->i_private;
 #endif
-	return smart_reload(dev, buffer, start_sector, nsectors);
+	smart_semtake(dev);
+	ret = smart_reload(dev, buffer, start_sector, nsectors);
+	smart_semgive(dev);
+	return ret;
 }
 
 /****************************************************************************
@@ -798,7 +1028,15 @@ static ssize_t smart_write(FAR struct inode *inode, FAR const unsigned char *buf
 	dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
-	/* I think maybe we need to lock on a mutex here */
+	smart_semtake(dev);
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	/* Raw writes bypass the sector map, the checkpoint can't follow them */
+
+	if (dev->ckptvalid) {
+		smart_ckpt_invalidate(dev);
+	}
+#endif
 
 	/* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
 	 * per erase block is a power of 2, and (2) the erase begins with that same
@@ -835,8 +1073,7 @@ static ssize_t smart_write(FAR struct inode *inode, FAR const unsigned char *buf
 			if (ret < 0) {
 				fdbg("Erase block=%d failed: %d\n", eraseblock, ret);
 
-				/* Unlock the mutex if we add one */
-
+				smart_semgive(dev);
 				return ret;
 			}
 		}
@@ -861,8 +1098,7 @@ static ssize_t smart_write(FAR struct inode *inode, FAR const unsigned char *buf
 
 			fdbg("Write block %d failed: %d.\n", nextblock, nxfrd);
 
-			/* Unlock the mutex if we add one */
-
+			smart_semgive(dev);
 			return -EIO;
 		}
 
@@ -874,6 +1110,7 @@ static ssize_t smart_write(FAR struct inode *inode, FAR const unsigned char *buf
 		alignedblock += mtdBlksPerErase;
 	}
 
+	smart_semgive(dev);
 	return nsectors;
 }
 #endif							/* CONFIG_FS_WRITABLE */
@@ -937,6 +1174,9 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	uint32_t erasesize;
 	uint32_t totalsectors;
 	uint32_t allocsize;
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	uint32_t mapslots;
+#endif
 
 #ifdef CONFIG_SMARTFS_BAD_SECTOR
 	int sector;
@@ -1002,9 +1242,20 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		dev->sBitMap = NULL;
 	}
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	/* The size of the map depends on the number of sectors */
+
+	if (dev->mapslots != NULL) {
+		smart_free(dev, dev->mapslots);
+		dev->mapslots = NULL;
+	}
+
+	dev->mapmisses = 0;
+#else
 	dev->cache_entries = 0;
 	dev->cache_lastlog = 0xFFFF;
 	dev->cache_nextbirth = 0;
+#endif
 #endif
 
 	if (dev->rwbuffer != NULL) {
@@ -1021,6 +1272,20 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		dev->wearstatus = NULL;
 	}
 #endif
+	if (dev->gcnext != NULL) {
+		smart_free(dev, dev->gcnext);
+		dev->gcnext = NULL;
+	}
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	if (dev->ckptdirty != NULL) {
+		smart_free(dev, dev->ckptdirty);
+		dev->ckptdirty = NULL;
+	}
+
+	/* The checkpoint no longer matches the geometry */
+
+	dev->ckptvalid = false;
+#endif
 
 #ifdef CONFIG_SMARTFS_BAD_SECTOR
 
@@ -1105,6 +1370,38 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	allocsize = dev->neraseblocks << 1;
 #endif
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	/* Allocate the packed map.  An entry has enough bits for every physical
+	 * sector and for the all ones value of an unmapped sector.  As many
+	 * pages as fit in CONFIG_MTD_SMART_MAP_RAM are kept in RAM.
+	 */
+
+	for (dev->mapbits = 1; (1UL << dev->mapbits) - 1 < totalsectors; dev->mapbits++) ;
+
+	dev->mappagesize = (SMART_MAP_PAGE_SECTORS >> 3) * dev->mapbits;
+	dev->mappages = (totalsectors + SMART_MAP_PAGE_SECTORS - 1) / SMART_MAP_PAGE_SECTORS;
+	mapslots = CONFIG_MTD_SMART_MAP_RAM / dev->mappagesize;
+	if (mapslots > dev->mappages) {
+		mapslots = dev->mappages;
+	}
+
+	if (mapslots > SMART_MAP_NO_SLOT - 1) {
+		mapslots = SMART_MAP_NO_SLOT - 1;
+	} else if (mapslots == 0) {
+		mapslots = 1;
+	}
+
+	dev->mapslotcount = (uint8_t)mapslots;
+	dev->mapslots = (FAR struct smart_mapslot_s *)smart_malloc(dev, mapslots * (sizeof(struct smart_mapslot_s) + dev->mappagesize) + dev->mappages + allocsize, "Sector map");
+	if (!dev->mapslots) {
+		fdbg("Error allocating SMART sector map\n");
+		goto errexit;
+	}
+
+	dev->mapdata = (FAR uint8_t *)&dev->mapslots[mapslots];
+	dev->mapslotof = dev->mapdata + mapslots * dev->mappagesize;
+	dev->releasecount = dev->mapslotof + dev->mappages;
+#else
 	/* Allocate the sector cache */
 
 	if (dev->sCache == NULL) {
@@ -1117,6 +1414,7 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	}
 
 	dev->releasecount = (FAR uint8_t *)dev->sCache + (CONFIG_MTD_SMART_SECTOR_CACHE_SIZE * sizeof(struct smart_cache_s));
+#endif
 
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
 	if (dev->sectorsPerBlk > 16) {
@@ -1162,6 +1460,32 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	dev->uneven_wearcount = 0;
 #endif
 
+	/* Allocate the garbage collection bucket lists.  They are filled when the
+	 * release counts are known.
+	 */
+
+	dev->gcnext = (FAR uint16_t *)smart_malloc(dev, dev->neraseblocks * (sizeof(uint16_t) * 2 + 1), "GC buckets");
+	if (!dev->gcnext) {
+		fdbg("Error allocating garbage collection buckets\n");
+		goto errexit;
+	}
+
+	dev->gcprev = dev->gcnext + dev->neraseblocks;
+	dev->gcbucket = (FAR uint8_t *)(dev->gcprev + dev->neraseblocks);
+	smart_gc_rebuild(dev, false);
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	/* Allocate the bitmap of the erase blocks logged since the checkpoint */
+
+	dev->ckptdirty = (FAR uint8_t *)smart_malloc(dev, (dev->neraseblocks + 7) >> 3, "Checkpoint");
+	if (!dev->ckptdirty) {
+		fdbg("Error allocating checkpoint bitmap\n");
+		goto errexit;
+	}
+
+	memset(dev->ckptdirty, 0, (dev->neraseblocks + 7) >> 3);
+#endif
+
 	/* Allocate a read/write buffer */
 
 	dev->rwbuffer = (FAR char *)smart_malloc(dev, size, "RW Buffer");
@@ -1202,10 +1526,17 @@ errexit:
 		smart_free(dev, dev->sBitMap);
 	}
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	if (dev->mapslots) {
+		smart_free(dev, dev->mapslots);
+		dev->mapslots = NULL;
+	}
+#else
 	if (dev->sCache) {
 		smart_free(dev, dev->sCache);
 	}
 #endif
+#endif
 
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 	if (dev->wearstatus) {
@@ -1219,6 +1550,15 @@ errexit:
 	}
 #endif
 
+	if (dev->gcnext) {
+		smart_free(dev, dev->gcnext);
+	}
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	if (dev->ckptdirty) {
+		smart_free(dev, dev->ckptdirty);
+	}
+#endif
+
 	kmm_free(dev);
 	return -ENOMEM;
 }
@@ -1237,6 +1577,12 @@ errexit:
 static ssize_t smart_bytewrite(FAR struct smart_struct_s *dev, size_t offset, int nbytes, FAR const uint8_t *buffer)
 {
 	ssize_t ret;
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	if (dev->ckptvalid) {
+		smart_ckpt_dirty(dev, offset / dev->erasesize);
+	}
+#endif
 #ifdef CONFIG_MTD_BYTE_WRITE
 	/* Check if the underlying MTD device supports write */
 
@@ -1297,7 +1643,7 @@ errout:
  *
  ****************************************************************************/
 
-#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+#if defined(CONFIG_MTD_SMART_MINIMIZE_RAM) && !defined(CONFIG_MTD_SMART_PACKED_MAP)
 static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical, int line)
 {
 	uint16_t index, x;
@@ -1364,7 +1710,7 @@ static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t lo
  *
  ****************************************************************************/
 
-#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+#if defined(CONFIG_MTD_SMART_MINIMIZE_RAM) && !defined(CONFIG_MTD_SMART_PACKED_MAP)
 static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logical)
 {
 	int ret;
@@ -1436,7 +1782,7 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 
 				/* Test if this sector has been release and skip it if it has */
 
-				if (SECOR_IS_RELEASED(header)) {
+				if (SECTOR_IS_RELEASED(header)) {
 					continue;
 				}
 
@@ -1476,7 +1822,7 @@ err_out:
  *
  ****************************************************************************/
 
-#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+#if defined(CONFIG_MTD_SMART_MINIMIZE_RAM) && !defined(CONFIG_MTD_SMART_PACKED_MAP)
 static void smart_update_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical)
 {
 	uint16_t x;
@@ -1514,124 +1860,458 @@ static void smart_update_cache(FAR struct smart_struct_s *dev, uint16_t logical,
 #endif
 
 /****************************************************************************
- * Name: smart_get_wear_level
+ * Name: smart_map_get_entry
  *
- * Description: Gets the wear level of the specified block.  Wear levels are
- *              encoded to minimize the number of zero to one transitions,
- *              possibly allowing updates to made on NOR devices that have
- *              no CRC enabled.
+ * Description: Get the physical sector of a logical sector from a page of
+ *              the packed map.  Entries are mapbits wide and packed LSB
+ *              first, so an entry spans at most three bytes.
  *
  ****************************************************************************/
 
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-static uint8_t smart_get_wear_level(FAR struct smart_struct_s *dev, uint16_t block)
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+static uint16_t smart_map_get_entry(FAR struct smart_struct_s *dev, FAR const uint8_t *page, uint16_t index)
 {
-	uint8_t bits;
-
-	bits = dev->wearstatus[block >> SMART_WEAR_BIT_DIVIDE];
-	if (block & 0x01) {
-		/* Use the upper nibble */
+	uint32_t bit;
+	uint32_t value;
+	uint8_t shift;
+	uint8_t x;
 
-		bits >>= 4;
-	} else {
-		/* Use the lower nibble */
+	bit = (uint32_t)index * dev->mapbits;
+	page += bit >> 3;
+	shift = bit & 0x07;
 
-		bits &= 0x0F;
+	value = 0;
+	for (x = 0; x < shift + dev->mapbits; x += 8) {
+		value |= (uint32_t)*page++ << x;
 	}
 
-	/* Lookup and return the level using the BitToLevel map */
+	value = (value >> shift) & ((1UL << dev->mapbits) - 1);
 
-	return gWearBitToLevelMap4[bits];
+	/* All ones is an unmapped sector */
+
+	if (value == (1UL << dev->mapbits) - 1) {
+		return 0xFFFF;
+	}
+
+	return (uint16_t)value;
 }
-#endif
 
 /****************************************************************************
- * Name: smart_find_wear_minmax
+ * Name: smart_map_set_entry
  *
- * Description: Find the minimum and maximum wear levels.  This is used when
- *              we increment the wear level of a minimum value block so that
- *              we can detect if a new minimum exists and perform normalization
- *              of the wear-levels.
+ * Description: Set the physical sector of a logical sector in a page of
+ *              the packed map.  0xFFFF unmaps the logical sector.
  *
  ****************************************************************************/
 
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-static void smart_find_wear_minmax(FAR struct smart_struct_s *dev)
+static void smart_map_set_entry(FAR struct smart_struct_s *dev, FAR uint8_t *page, uint16_t index, uint16_t physical)
 {
-	uint16_t x;
-	unsigned char level;
+	uint32_t bit;
+	uint32_t mask;
+	uint32_t value;
+	uint8_t shift;
+	uint8_t x;
 
-	dev->minwearlevel = 15;
-	dev->maxwearlevel = 0;
+	bit = (uint32_t)index * dev->mapbits;
+	page += bit >> 3;
+	shift = bit & 0x07;
 
-	/* Loop through all erase blocks and find min / max level */
+	mask = ((1UL << dev->mapbits) - 1) << shift;
+	value = ((uint32_t)physical << shift) & mask;
 
-	for (x = 0; x < dev->geo.neraseblocks; x++) {
-		/* Find wear level of the minimum worn block */
+	for (x = 0; x < shift + dev->mapbits; x += 8) {
+		*page = (*page & ~(mask >> x)) | (value >> x);
+		page++;
+	}
+}
 
-		level = smart_get_wear_level(dev, x);
-		if (level < dev->minwearlevel) {
-			dev->minwearlevel = level;
-		}
+/****************************************************************************
+ * Name: smart_map_reset
+ *
+ * Description: Unmap all logical sectors and give the slots to the first
+ *              pages of the map.  Page 0 holds the format and root
+ *              directory sectors, which are used the most.
+ *
+ ****************************************************************************/
 
-		/* Find wear level of the maximum worn block */
+static void smart_map_reset(FAR struct smart_struct_s *dev)
+{
+	uint16_t x;
 
-		if (level > dev->maxwearlevel) {
-			dev->maxwearlevel = level;
-		}
-	}
+	memset(dev->mapdata, 0xFF, dev->mapslotcount * dev->mappagesize);
+	memset(dev->mapslotof, SMART_MAP_NO_SLOT, dev->mappages);
 
-#ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
-	/* Also adjust the erase counts */
-	level = 255;
-	for (x = 0; x < dev->geo.neraseblocks; x++) {
-		if (dev->erasecounts[x] < level) {
-			level = dev->erasecounts[x];
-		}
+	for (x = 0; x < dev->mapslotcount; x++) {
+		dev->mapslots[x].page = x;
+		dev->mapslots[x].birth = 0;
+		dev->mapslotof[x] = x;
 	}
 
-	if (level != 0) {
-		for (x = 0; x < dev->geo.neraseblocks; x++) {
-			dev->erasecounts[x] -= level;
-		}
-	}
-#endif
+	dev->map_nextbirth = 0;
 }
-#endif
 
 /****************************************************************************
- * Name: smart_set_wear_level
+ * Name: smart_map_load
  *
- * Description: Sets the wear level of the specified block.  The wear level
- *              is a 4-bit field packed 2 entries per byte and is mapped to
- *              a bit field which minimizes the number of 0 to 1 transitions
- *              such that entries can be updated on a NOR flash withough the
- *              need to relocated the format sector (assuming CRC is not
- *              enabled, in which case a relocated is needed for ANY change).
+ * Description: Load a page of the map which is not kept in RAM into the
+ *              slot of the least recently used page.  The page is rebuilt
+ *              from the headers of all physical sectors, so a single scan
+ *              of the volume maps SMART_MAP_PAGE_SECTORS logical sectors.
+ *              Returns the slot or SMART_MAP_NO_SLOT.
  *
  ****************************************************************************/
 
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-static int smart_set_wear_level(FAR struct smart_struct_s *dev, uint16_t block, uint8_t level)
+static uint8_t smart_map_load(FAR struct smart_struct_s *dev, uint16_t page)
 {
-	uint8_t bits, oldlevel;
+	int ret;
+	uint8_t slot;
+	uint8_t x;
+	uint16_t age;
+	uint16_t oldest;
+	uint16_t first;
+	uint16_t sector;
+	uint16_t logicalsector;
+	uint32_t readaddress;
+	FAR uint8_t *data;
+	struct smart_sect_header_s header;
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+	FAR struct smart_allocsector_s *allocsect;
+#endif
 
-	/* Get the old wear level to test if we need to update min / max */
+	/* Choose a free slot or the least recently used page.  Page 0 is kept
+	 * unless it is the only one in RAM.
+	 */
 
-	oldlevel = smart_get_wear_level(dev, block);
+	slot = 0;
+	oldest = 0;
+	for (x = 0; x < dev->mapslotcount; x++) {
+		if (dev->mapslots[x].page == SMART_MAP_NO_PAGE) {
+			slot = x;
+			break;
+		}
 
-	/* Get the bit map for this wear level from the static map array */
+		if (dev->mapslots[x].page == 0 && dev->mapslotcount > 1) {
+			continue;
+		}
 
-	if (level > 15) {
-		dbg("Fatal Design Error!  Wear level > 15, block=%d\n", block);
+		age = dev->map_nextbirth - dev->mapslots[x].birth;
+		if (age >= oldest) {
+			oldest = age;
+			slot = x;
+		}
+	}
 
-		/* This is a design flaw, but we still allow processing, otherwise we
-		 * will corrupt the volume.  It's better to have a few blocks that are
-		 * worn a bit more than to create an error condition on the volume.
-		 *
-		 * Set the level to the maximum value and add to the un-even wear count
-		 * to keep track of the number of times this has happened.
-		 */
+	if (dev->mapslots[slot].page != SMART_MAP_NO_PAGE) {
+		dev->mapslotof[dev->mapslots[slot].page] = SMART_MAP_NO_SLOT;
+	}
+
+	data = dev->mapdata + slot * dev->mappagesize;
+	memset(data, 0xFF, dev->mappagesize);
+	dev->mapslots[slot].page = SMART_MAP_NO_PAGE;
+	dev->mapmisses++;
+
+	first = page * SMART_MAP_PAGE_SECTORS;
+	for (sector = 0; sector < dev->totalsectors; sector++) {
+		/* Read the header for this sector */
+
+		readaddress = sector * dev->mtdBlksPerSector * dev->geo.blocksize;
+		ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
+		if (ret != sizeof(struct smart_sect_header_s)) {
+			fdbg("Error reading physical sector %d.\n", sector);
+			return SMART_MAP_NO_SLOT;
+		}
+
+		logicalsector = UINT8TOUINT16(header.logicalsector);
+#if CONFIG_SMARTFS_ERASEDSTATE == 0x00
+		if (logicalsector == 0) {
+			continue;
+		}
+#endif
+
+		if (logicalsector < first || logicalsector - first >= SMART_MAP_PAGE_SECTORS) {
+			continue;
+		}
+
+		/* A sector is mapped whether or not it is committed.  The mount
+		 * scan releases the uncommitted sectors which a reset left behind,
+		 * so any other one belongs to a write in progress.
+		 */
+
+		if (SECTOR_IS_RELEASED(header)) {
+			continue;
+		}
+
+		if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION) {
+			continue;
+		}
+
+		smart_map_set_entry(dev, data, logicalsector - first, sector);
+	}
+
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+	/* With CRC, an allocated sector has no header until its first write */
+
+	for (allocsect = dev->allocsector; allocsect != NULL; allocsect = allocsect->next) {
+		if (allocsect->logical >= first && allocsect->logical - first < SMART_MAP_PAGE_SECTORS) {
+			smart_map_set_entry(dev, data, allocsect->logical - first, allocsect->physical);
+		}
+	}
+#endif
+
+	dev->mapslots[slot].page = page;
+	dev->mapslotof[page] = slot;
+
+	if (dev->debuglevel > 1) {
+		dbg("Load map page %d into slot %d\n", page, slot);
+	}
+
+	return slot;
+}
+
+/****************************************************************************
+ * Name: smart_map_page
+ *
+ * Description: Return the page of the map which holds a logical sector,
+ *              loading it if requested, or NULL.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *smart_map_page(FAR struct smart_struct_s *dev, uint16_t logical, bool load)
+{
+	uint16_t page;
+	uint8_t slot;
+
+	if (logical >= dev->totalsectors) {
+		return NULL;
+	}
+
+	page = logical / SMART_MAP_PAGE_SECTORS;
+	slot = dev->mapslotof[page];
+	if (slot == SMART_MAP_NO_SLOT) {
+		if (!load) {
+			return NULL;
+		}
+
+		slot = smart_map_load(dev, page);
+		if (slot == SMART_MAP_NO_SLOT) {
+			return NULL;
+		}
+	}
+
+	dev->mapslots[slot].birth = dev->map_nextbirth++;
+	return dev->mapdata + slot * dev->mappagesize;
+}
+
+/****************************************************************************
+ * Name: smart_map_update
+ *
+ * Description: Update the mapping of a logical sector.  A page which is not
+ *              in RAM is only loaded if requested, as it is rebuilt from
+ *              the sector headers anyway.
+ *
+ ****************************************************************************/
+
+static void smart_map_update(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical, bool load)
+{
+	FAR uint8_t *page;
+
+	page = smart_map_page(dev, logical, load);
+	if (page != NULL) {
+		smart_map_set_entry(dev, page, logical % SMART_MAP_PAGE_SECTORS, physical);
+	}
+}
+
+/****************************************************************************
+ * Name: smart_map_find
+ *
+ * Description: Return the physical sector of a logical sector if its page
+ *              of the map is in RAM, or 0xFFFF.
+ *
+ ****************************************************************************/
+
+static uint16_t smart_map_find(FAR struct smart_struct_s *dev, uint16_t logical)
+{
+	FAR uint8_t *page;
+
+	page = smart_map_page(dev, logical, false);
+	if (page == NULL) {
+		return 0xFFFF;
+	}
+
+	return smart_map_get_entry(dev, page, logical % SMART_MAP_PAGE_SECTORS);
+}
+
+/****************************************************************************
+ * Name: smart_add_sector_to_cache
+ *
+ * Description: Map a newly allocated logical sector.  Its page is loaded,
+ *              as the sector may not have been written yet.
+ *
+ ****************************************************************************/
+
+static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical, int line)
+{
+	smart_map_update(dev, logical, physical, true);
+	if (dev->debuglevel > 1) {
+		dbg("Add map sector:  Log=%d, Phys=%d from line %d\n", logical, physical, line);
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: smart_cache_lookup
+ *
+ * Description: Look up the physical sector of a logical sector in the
+ *              packed map, loading its page if it is not in RAM.
+ *
+ ****************************************************************************/
+
+static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logical)
+{
+	FAR uint8_t *page;
+
+	page = smart_map_page(dev, logical, true);
+	if (page == NULL) {
+		return 0xFFFF;
+	}
+
+	return smart_map_get_entry(dev, page, logical % SMART_MAP_PAGE_SECTORS);
+}
+
+/****************************************************************************
+ * Name: smart_update_cache
+ *
+ * Description: Replace the physical sector of a logical sector, which has
+ *              been written to the device, in the packed map.
+ *
+ ****************************************************************************/
+
+static void smart_update_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical)
+{
+	smart_map_update(dev, logical, physical, false);
+}
+#endif							/* CONFIG_MTD_SMART_PACKED_MAP */
+
+/****************************************************************************
+ * Name: smart_get_wear_level
+ *
+ * Description: Gets the wear level of the specified block.  Wear levels are
+ *              encoded to minimize the number of zero to one transitions,
+ *              possibly allowing updates to made on NOR devices that have
+ *              no CRC enabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+static uint8_t smart_get_wear_level(FAR struct smart_struct_s *dev, uint16_t block)
+{
+	uint8_t bits;
+
+	bits = dev->wearstatus[block >> SMART_WEAR_BIT_DIVIDE];
+	if (block & 0x01) {
+		/* Use the upper nibble */
+
+		bits >>= 4;
+	} else {
+		/* Use the lower nibble */
+
+		bits &= 0x0F;
+	}
+
+	/* Lookup and return the level using the BitToLevel map */
+
+	return gWearBitToLevelMap4[bits];
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_find_wear_minmax
+ *
+ * Description: Find the minimum and maximum wear levels.  This is used when
+ *              we increment the wear level of a minimum value block so that
+ *              we can detect if a new minimum exists and perform normalization
+ *              of the wear-levels.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+static void smart_find_wear_minmax(FAR struct smart_struct_s *dev)
+{
+	uint16_t x;
+	unsigned char level;
+
+	dev->minwearlevel = 15;
+	dev->maxwearlevel = 0;
+
+	/* Loop through all erase blocks and find min / max level */
+
+	for (x = 0; x < dev->geo.neraseblocks; x++) {
+		/* Find wear level of the minimum worn block */
+
+		level = smart_get_wear_level(dev, x);
+		if (level < dev->minwearlevel) {
+			dev->minwearlevel = level;
+		}
+
+		/* Find wear level of the maximum worn block */
+
+		if (level > dev->maxwearlevel) {
+			dev->maxwearlevel = level;
+		}
+	}
+
+#ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
+	/* Also adjust the erase counts */
+	level = 255;
+	for (x = 0; x < dev->geo.neraseblocks; x++) {
+		if (dev->erasecounts[x] < level) {
+			level = dev->erasecounts[x];
+		}
+	}
+
+	if (level != 0) {
+		for (x = 0; x < dev->geo.neraseblocks; x++) {
+			dev->erasecounts[x] -= level;
+		}
+	}
+#endif
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_set_wear_level
+ *
+ * Description: Sets the wear level of the specified block.  The wear level
+ *              is a 4-bit field packed 2 entries per byte and is mapped to
+ *              a bit field which minimizes the number of 0 to 1 transitions
+ *              such that entries can be updated on a NOR flash withough the
+ *              need to relocated the format sector (assuming CRC is not
+ *              enabled, in which case a relocated is needed for ANY change).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+static int smart_set_wear_level(FAR struct smart_struct_s *dev, uint16_t block, uint8_t level)
+{
+	uint8_t bits, oldlevel;
+
+	/* Get the old wear level to test if we need to update min / max */
+
+	oldlevel = smart_get_wear_level(dev, block);
+
+	/* Get the bit map for this wear level from the static map array */
+
+	if (level > 15) {
+		dbg("Fatal Design Error!  Wear level > 15, block=%d\n", block);
+
+		/* This is a design flaw, but we still allow processing, otherwise we
+		 * will corrupt the volume.  It's better to have a few blocks that are
+		 * worn a bit more than to create an error condition on the volume.
+		 *
+		 * Set the level to the maximum value and add to the un-even wear count
+		 * to keep track of the number of times this has happened.
+		 */
 
 		level = 15;
 		dev->uneven_wearcount++;
@@ -1660,25 +2340,550 @@ static int smart_set_wear_level(FAR struct smart_struct_s *dev, uint16_t block,
 	if (oldlevel + 1 == level) {
 		/* Test if max needs to be updated */
 
-		if (level > dev->maxwearlevel) {
-			dev->maxwearlevel = level;
+		if (level > dev->maxwearlevel) {
+			dev->maxwearlevel = level;
+		}
+
+		/* Test if this was the min level.  If it was, then
+		   we need to rescan for min. */
+
+		if (oldlevel == dev->minwearlevel) {
+			smart_find_wear_minmax(dev);
+
+			if (oldlevel != dev->minwearlevel) {
+				fvdbg("##### New min wear level = %d\n", dev->minwearlevel);
+			}
+		}
+	}
+
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+/****************************************************************************
+ * Name: smart_ckpt_reserve
+ *
+ * Description: Takes the erase blocks of two slots of the given size off
+ *              the end of the geometry.  The arrays sized by the number of
+ *              erase blocks are allocated again by the next call to
+ *              smart_setsectorsize().
+ *
+ ****************************************************************************/
+
+static void smart_ckpt_reserve(FAR struct smart_struct_s *dev, uint16_t blocks)
+{
+	dev->geo.neraseblocks -= blocks << 1;
+	dev->ckptfirst = dev->geo.neraseblocks;
+	dev->ckptblocks = blocks;
+	dev->sectorsize = 0;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_initialize
+ *
+ * Description: Reserves the erase blocks of the two checkpoint slots at
+ *              the end of the device.  The slots are hidden from the rest
+ *              of the driver by reducing the number of erase blocks in the
+ *              geometry.
+ *
+ ****************************************************************************/
+
+static void smart_ckpt_initialize(FAR struct smart_struct_s *dev)
+{
+	uint32_t totalsectors;
+	uint32_t size;
+	uint16_t blocks;
+
+	dev->ckptblocks = 0;
+	dev->ckptslot = 1;
+	dev->ckptlogcount = 0;
+	dev->ckptvalid = false;
+	dev->ckptneeded = false;
+
+	if (dev->geo.erasesize == 0 || dev->geo.erasesize < CONFIG_MTD_SMART_SECTOR_SIZE) {
+		return;
+	}
+
+	/* A slot holds the header sector, the sector map with the release and
+	 * free counts, and the log.
+	 */
+
+	totalsectors = dev->geo.neraseblocks * (dev->geo.erasesize / CONFIG_MTD_SMART_SECTOR_SIZE);
+	if (totalsectors > 65536) {
+		totalsectors = 65536;
+	}
+
+	size = CONFIG_MTD_SMART_SECTOR_SIZE + totalsectors * sizeof(uint16_t) + (dev->geo.neraseblocks << 1) + dev->geo.blocksize + (CONFIG_MTD_SMART_CHECKPOINT_LOG + 1) * sizeof(uint16_t);
+	blocks = (size + dev->geo.erasesize - 1) / dev->geo.erasesize;
+
+	/* Don't give more than a quarter of the device to the checkpoint.  The
+	 * size of a slot is recorded in one byte of the format sector.
+	 */
+
+	if ((uint32_t)blocks * 4 > dev->geo.neraseblocks || blocks >= 0xFF) {
+		fdbg("Device too small for the checkpoint\n");
+		return;
+	}
+
+	smart_ckpt_reserve(dev, blocks);
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_release
+ *
+ * Description: Gives the erase blocks of the checkpoint slots back to the
+ *              geometry, for a volume which was formatted without them or
+ *              with slots of another size.
+ *
+ ****************************************************************************/
+
+static void smart_ckpt_release(FAR struct smart_struct_s *dev)
+{
+	if (dev->ckptblocks > 0) {
+		dev->geo.neraseblocks = dev->ckptfirst + (dev->ckptblocks << 1);
+		dev->sectorsize = 0;
+	}
+
+	dev->ckptblocks = 0;
+	dev->ckptvalid = false;
+	dev->ckptneeded = false;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_layout
+ *
+ * Description: Computes the address of a checkpoint slot and of its log
+ *              for the current sector size.  Returns false if the
+ *              checkpoint does not fit in the slot.
+ *
+ ****************************************************************************/
+
+static bool smart_ckpt_layout(FAR struct smart_struct_s *dev, uint8_t slot, FAR uint32_t *slotaddr)
+{
+	uint32_t datasize;
+	uint32_t end;
+	uint32_t logmax;
+
+	if (dev->ckptblocks == 0 || dev->erasesize != dev->geo.erasesize) {
+		return false;
+	}
+
+	*slotaddr = (dev->ckptfirst + slot * dev->ckptblocks) * dev->erasesize;
+	end = *slotaddr + dev->ckptblocks * dev->erasesize;
+
+	datasize = dev->totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+	dev->ckptlogaddr = *slotaddr + dev->sectorsize + (datasize + dev->geo.blocksize - 1) / dev->geo.blocksize * dev->geo.blocksize;
+
+	/* Room is kept for at least one entry and the overflow entry */
+
+	if (dev->ckptlogaddr + 2 * sizeof(uint16_t) > end) {
+		return false;
+	}
+
+	logmax = (end - dev->ckptlogaddr) / sizeof(uint16_t) - 1;
+	if (logmax > CONFIG_MTD_SMART_CHECKPOINT_LOG) {
+		logmax = CONFIG_MTD_SMART_CHECKPOINT_LOG;
+	}
+
+	dev->ckptlogmax = logmax;
+	return true;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_invalidate
+ *
+ * Description: Erases the header of both checkpoint slots, so that the
+ *              next initialization scans the whole device.
+ *
+ ****************************************************************************/
+
+static void smart_ckpt_invalidate(FAR struct smart_struct_s *dev)
+{
+	int slot;
+
+	dev->ckptvalid = false;
+	for (slot = 0; slot < 2 && dev->ckptblocks > 0; slot++) {
+		MTD_ERASE(dev->mtd, dev->ckptfirst + slot * dev->ckptblocks, 1);
+	}
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_dirty
+ *
+ * Description: Adds an erase block to the log of the checkpoint before it
+ *              is written or erased.  When the log is full, it is marked
+ *              as overflowed and a new checkpoint is requested.
+ *
+ ****************************************************************************/
+
+static void smart_ckpt_dirty(FAR struct smart_struct_s *dev, uint16_t block)
+{
+	uint16_t entry;
+	uint8_t buffer[2];
+	ssize_t ret;
+
+	if (!dev->ckptvalid || block >= dev->neraseblocks || SMART_CKPT_TEST(dev->ckptdirty, block)) {
+		return;
+	}
+
+	if (dev->ckptlogcount >= dev->ckptlogmax) {
+		entry = SMART_CKPT_LOG_OVERFLOW;
+		dev->ckptvalid = false;
+		dev->ckptneeded = true;
+	} else {
+		entry = block + 1;
+	}
+
+	buffer[0] = (uint8_t)entry;
+	buffer[1] = (uint8_t)(entry >> 8);
+	ret = smart_bytewrite(dev, dev->ckptlogaddr + dev->ckptlogcount * sizeof(uint16_t), sizeof(buffer), buffer);
+	if (ret < 0) {
+		fdbg("Error %d writing checkpoint log\n", -ret);
+		smart_ckpt_invalidate(dev);
+		dev->ckptneeded = true;
+		return;
+	}
+
+	if (dev->ckptvalid) {
+		SMART_CKPT_SET(dev->ckptdirty, block);
+		dev->ckptlogcount++;
+	}
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_write
+ *
+ * Description: Writes a checkpoint of the sector map and of the counts to
+ *              the unused slot, then retires the previous checkpoint and
+ *              starts an empty log.
+ *
+ ****************************************************************************/
+
+static int smart_ckpt_write(FAR struct smart_struct_s *dev)
+{
+	struct smart_ckpt_header_s header;
+	FAR const uint8_t *data;
+	uint32_t slotaddr;
+	uint32_t datasize;
+	uint32_t startblock;
+	uint32_t nblocks;
+	uint32_t remaining;
+	uint8_t commit;
+	uint8_t slot;
+	int ret;
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+	FAR struct smart_allocsector_s *allocsector;
+#endif
+
+	dev->ckptneeded = false;
+	if (dev->formatstatus != SMART_FMT_STAT_FORMATTED) {
+		return OK;
+	}
+
+	slot = dev->ckptslot ^ 1;
+	dev->ckptvalid = false;
+	if (!smart_ckpt_layout(dev, slot, &slotaddr)) {
+		return -ENOSPC;
+	}
+
+	ret = MTD_ERASE(dev->mtd, slotaddr / dev->erasesize, dev->ckptblocks);
+	if (ret < 0) {
+		goto errout;
+	}
+
+	/* The sector map is followed by the release and free counts in the same
+	 * allocation.  Write the whole blocks directly and the tail through the
+	 * read/write buffer.
+	 */
+
+	data = (FAR const uint8_t *)dev->sMap;
+	datasize = dev->totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+	startblock = (slotaddr + dev->sectorsize) / dev->geo.blocksize;
+	nblocks = datasize / dev->geo.blocksize;
+	remaining = datasize - nblocks * dev->geo.blocksize;
+
+	if (nblocks > 0) {
+		ret = MTD_BWRITE(dev->mtd, startblock, nblocks, data);
+		if (ret != nblocks) {
+			ret = -EIO;
+			goto errout;
+		}
+	}
+
+	if (remaining > 0) {
+		memset(dev->rwbuffer, CONFIG_SMARTFS_ERASEDSTATE, dev->geo.blocksize);
+		memcpy(dev->rwbuffer, &data[nblocks * dev->geo.blocksize], remaining);
+		ret = MTD_BWRITE(dev->mtd, startblock + nblocks, 1, (FAR uint8_t *)dev->rwbuffer);
+		if (ret != 1) {
+			ret = -EIO;
+			goto errout;
+		}
+	}
+
+	/* Write the header, then commit it */
+
+	memcpy(header.magic, SMART_CKPT_MAGIC, sizeof(header.magic));
+	header.seq = dev->ckptseq + 1;
+	header.totalsectors = dev->totalsectors;
+	header.neraseblocks = dev->neraseblocks;
+	header.sectorsize = dev->sectorsize;
+	header.freesectors = dev->freesectors;
+	header.releasesectors = dev->releasesectors;
+	header.crc = crc16(data, datasize);
+	header.commit = CONFIG_SMARTFS_ERASEDSTATE;
+
+	memset(dev->rwbuffer, CONFIG_SMARTFS_ERASEDSTATE, dev->geo.blocksize);
+	memcpy(dev->rwbuffer, &header, sizeof(header));
+	ret = MTD_BWRITE(dev->mtd, slotaddr / dev->geo.blocksize, 1, (FAR uint8_t *)dev->rwbuffer);
+	if (ret != 1) {
+		ret = -EIO;
+		goto errout;
+	}
+
+	commit = SMART_CKPT_COMMITTED;
+	ret = smart_bytewrite(dev, slotaddr + offsetof(struct smart_ckpt_header_s, commit), 1, &commit);
+	if (ret < 0) {
+		goto errout;
+	}
+
+	/* Retire the previous checkpoint.  If this fails, the sequence number
+	 * still selects the new one.
+	 */
+
+	MTD_ERASE(dev->mtd, dev->ckptfirst + dev->ckptslot * dev->ckptblocks, 1);
+
+	dev->ckptseq++;
+	dev->ckptslot = slot;
+	dev->ckptlogcount = 0;
+	memset(dev->ckptdirty, 0, (dev->neraseblocks + 7) >> 3);
+	dev->ckptvalid = true;
+
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+	/* Allocated sectors are only written with their data, but are already
+	 * counted in the free counts.  Log their erase blocks so that they are
+	 * scanned again.
+	 */
+
+	for (allocsector = dev->allocsector; allocsector != NULL; allocsector = allocsector->next) {
+		smart_ckpt_dirty(dev, allocsector->physical / dev->sectorsPerBlk);
+	}
+#endif
+
+	return OK;
+
+errout:
+	fdbg("Error %d writing checkpoint\n", -ret);
+	return ret;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_load
+ *
+ * Description: Loads the sector map and the counts from the last valid
+ *              checkpoint and forgets what it knows of the erase blocks in
+ *              its log.  Returns a bitmap of the erase blocks which must be
+ *              scanned, or NULL if the whole device must be scanned.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *smart_ckpt_load(FAR struct smart_struct_s *dev)
+{
+	struct smart_ckpt_header_s header;
+	FAR uint8_t *replay;
+	uint32_t slotaddr;
+	uint32_t datasize;
+	uint32_t nentries;
+	uint32_t first;
+	uint32_t x;
+	uint16_t entry;
+	uint16_t block;
+	uint16_t count;
+	uint16_t prerelease;
+	uint8_t slot;
+	bool found;
+	int ret;
+
+	if (dev->ckptblocks == 0) {
+		return NULL;
+	}
+
+	/* Find the committed checkpoint with the highest sequence number */
+
+	found = false;
+	for (slot = 0; slot < 2; slot++) {
+		ret = MTD_READ(dev->mtd, (dev->ckptfirst + slot * dev->ckptblocks) * dev->geo.erasesize, sizeof(header), (FAR uint8_t *)&header);
+		if (ret != sizeof(header) || memcmp(header.magic, SMART_CKPT_MAGIC, sizeof(header.magic)) != 0 || header.commit != SMART_CKPT_COMMITTED) {
+			continue;
+		}
+
+		if (!found || header.seq > dev->ckptseq) {
+			dev->ckptseq = header.seq;
+			dev->ckptslot = slot;
+			found = true;
+		}
+	}
+
+	if (!found || !smart_ckpt_layout(dev, dev->ckptslot, &slotaddr)) {
+		return NULL;
+	}
+
+	ret = MTD_READ(dev->mtd, slotaddr, sizeof(header), (FAR uint8_t *)&header);
+	if (ret != sizeof(header) || header.totalsectors != dev->totalsectors || header.neraseblocks != dev->neraseblocks || header.sectorsize != dev->sectorsize) {
+		return NULL;
+	}
+
+	/* Read the sector map and the counts */
+
+	datasize = dev->totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+	ret = MTD_READ(dev->mtd, slotaddr + dev->sectorsize, datasize, (FAR uint8_t *)dev->sMap);
+	if (ret != datasize || crc16((FAR const uint8_t *)dev->sMap, datasize) != header.crc) {
+		fdbg("Invalid checkpoint %d\n", header.seq);
+		return NULL;
+	}
+
+	replay = (FAR uint8_t *)kmm_zalloc((dev->neraseblocks + 7) >> 3);
+	if (replay == NULL) {
+		return NULL;
+	}
+
+	/* Read the log up to its first empty entry */
+
+	memset(dev->ckptdirty, 0, (dev->neraseblocks + 7) >> 3);
+	count = 0;
+	first = 0;
+	nentries = 0;
+	for (x = 0; x <= dev->ckptlogmax; x++) {
+		if (x == nentries) {
+			first = x;
+			nentries = dev->ckptlogmax + 1 - x;
+			if (nentries > dev->sectorsize / sizeof(uint16_t)) {
+				nentries = dev->sectorsize / sizeof(uint16_t);
+			}
+
+			ret = MTD_READ(dev->mtd, dev->ckptlogaddr + x * sizeof(uint16_t), nentries * sizeof(uint16_t), (FAR uint8_t *)dev->rwbuffer);
+			if (ret != nentries * sizeof(uint16_t)) {
+				goto errout;
+			}
+
+			nentries += x;
+		}
+
+		entry = (uint8_t)dev->rwbuffer[(x - first) << 1] | ((uint8_t)dev->rwbuffer[((x - first) << 1) + 1] << 8);
+		if (entry == SMART_CKPT_LOG_EMPTY) {
+			break;
+		}
+
+		/* A full log doesn't know all the changed erase blocks */
+
+		if (entry == SMART_CKPT_LOG_OVERFLOW || entry > dev->neraseblocks) {
+			fdbg("Checkpoint log overflowed\n");
+			goto errout;
+		}
+
+		SMART_CKPT_SET(dev->ckptdirty, entry - 1);
+		SMART_CKPT_SET(replay, entry - 1);
+		count++;
+	}
+
+	/* Scan the erase block of the format sector, which holds the format
+	 * information.
+	 */
+
+	if (dev->sMap[0] == 0xFFFF) {
+		goto errout;
+	}
+
+	SMART_CKPT_SET(replay, dev->sMap[0] / dev->sectorsPerBlk);
+
+	/* Forget the mappings and the counts of the erase blocks to scan */
+
+	for (x = 0; x < dev->totalsectors; x++) {
+		if (dev->sMap[x] != 0xFFFF && SMART_CKPT_TEST(replay, dev->sMap[x] / dev->sectorsPerBlk)) {
+			dev->sMap[x] = 0xFFFF;
+		}
+	}
+
+	dev->freesectors = header.freesectors;
+	dev->releasesectors = header.releasesectors;
+	for (block = 0; block < dev->neraseblocks; block++) {
+		if (!SMART_CKPT_TEST(replay, block)) {
+			continue;
+		}
+
+		if (block == dev->neraseblocks - 1 && dev->totalsectors == 65534) {
+			prerelease = 2;
+		} else {
+			prerelease = 0;
+		}
+
+		dev->freesectors += dev->availSectPerBlk - prerelease - dev->freecount[block];
+		dev->releasesectors -= dev->releasecount[block] - prerelease;
+		dev->freecount[block] = dev->availSectPerBlk - prerelease;
+		dev->releasecount[block] = prerelease;
+	}
+
+	fvdbg("Checkpoint %d, %d erase blocks logged\n", dev->ckptseq, count);
+
+	dev->ckptlogcount = count;
+	dev->ckptvalid = true;
+	return replay;
+
+errout:
+	kmm_free(replay);
+	return NULL;
+}
+#endif							/* CONFIG_MTD_SMART_FAST_MOUNT */
+
+/****************************************************************************
+ * Name: smart_scan_reset
+ *
+ * Description: Sets the free and release counts and the logical to physical
+ *              sector map of an empty device before it is scanned.
+ *
+ ****************************************************************************/
+
+static void smart_scan_reset(FAR struct smart_struct_s *dev)
+{
+	int sector;
+	uint16_t prerelease;
+
+	dev->freesectors = dev->availSectPerBlk * dev->geo.neraseblocks;
+	dev->releasesectors = 0;
+
+	/* Initialize the freecount and releasecount arrays */
+
+	for (sector = 0; sector < dev->neraseblocks; sector++) {
+		if (sector == dev->neraseblocks - 1 && dev->totalsectors == 65534) {
+			prerelease = 2;
+		} else {
+			prerelease = 0;
 		}
 
-		/* Test if this was the min level.  If it was, then
-		   we need to rescan for min. */
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+		smart_set_count(dev, dev->freecount, sector, dev->availSectPerBlk - prerelease);
+		smart_set_count(dev, dev->releasecount, sector, prerelease);
+#else
+		dev->freecount[sector] = dev->availSectPerBlk - prerelease;
+		dev->releasecount[sector] = prerelease;
+#endif
+	}
 
-		if (oldlevel == dev->minwearlevel) {
-			smart_find_wear_minmax(dev);
+	/* Initialize the sector map */
 
-			if (oldlevel != dev->minwearlevel) {
-				fvdbg("##### New min wear level = %d\n", dev->minwearlevel);
-			}
-		}
+#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+	for (sector = 0; sector < dev->totalsectors; sector++) {
+		dev->sMap[sector] = -1;
 	}
+#else
+	/* Clear all logical sector used bits */
 
-	return 0;
-}
+	memset(dev->sBitMap, 0, (dev->totalsectors + 7) >> 3);
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	smart_map_reset(dev);
+#endif
 #endif
+}
 
 /****************************************************************************
  * Name: smart_scan
@@ -1694,7 +2899,7 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	int sector;
 	int ret;
 	uint16_t totalsectors;
-	uint16_t sectorsize, prerelease;
+	uint16_t sectorsize;
 	uint16_t logicalsector;
 	uint16_t loser;
 	uint32_t readaddress;
@@ -1704,6 +2909,10 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	struct smart_sect_header_s header;
 	uint8_t *sector_seq_log = NULL;
 	bool status_released, status_committed;
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	FAR uint8_t *replay = NULL;
+	uint8_t ckptformat;
+#endif
 #ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
 	int dupsector;
 	uint16_t duplogsector;
@@ -1716,6 +2925,10 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 
 	fvdbg("Entry\n");
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+restart:
+	ckptformat = CONFIG_SMARTFS_ERASEDSTATE;
+#endif
 	/* Find the sector size on the volume by reading headers from
 	 * sectors of decreasing size.  On a formatted volume, the sector
 	 * size is saved in the header status byte of seach sector, so
@@ -1771,39 +2984,19 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 #endif
 
 	dev->formatstatus = SMART_FMT_STAT_NOFMT;
-	dev->freesectors = dev->availSectPerBlk * dev->geo.neraseblocks;
-	dev->releasesectors = 0;
-
-	/* Initialize the freecount and releasecount arrays */
 
-	for (sector = 0; sector < dev->neraseblocks; sector++) {
-		if (sector == dev->neraseblocks - 1 && dev->totalsectors == 65534) {
-			prerelease = 2;
-		} else {
-			prerelease = 0;
-		}
+	/* Start from the last checkpoint if it is valid, only the erase blocks
+	 * changed since are scanned.
+	 */
 
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-		smart_set_count(dev, dev->freecount, sector, dev->availSectPerBlk - prerelease);
-		smart_set_count(dev, dev->releasecount, sector, prerelease);
-#else
-		dev->freecount[sector] = dev->availSectPerBlk - prerelease;
-		dev->releasecount[sector] = prerelease;
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	replay = smart_ckpt_load(dev);
+	if (replay == NULL)
 #endif
+	{
+		smart_scan_reset(dev);
 	}
 
-	/* Initialize the sector map */
-
-#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-	for (sector = 0; sector < totalsectors; sector++) {
-		dev->sMap[sector] = -1;
-	}
-#else
-	/* Clear all logical sector used bits */
-
-	memset(dev->sBitMap, 0, (dev->totalsectors + 7) >> 3);
-#endif
-
 	/* Now scan the MTD device */
 	sector_seq_log = (uint8_t *)kmm_zalloc(sizeof(uint8_t) * totalsectors);
 
@@ -1813,6 +3006,12 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	}
 
 	for (sector = 0; sector < totalsectors; sector++) {
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+		if (replay != NULL && !SMART_CKPT_TEST(replay, sector / dev->sectorsPerBlk)) {
+			continue;
+		}
+#endif
+
 		fvdbg("Scan sector %d\n", sector);
 
 		/* Calculate the read address for this sector */
@@ -1965,6 +3164,18 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 				fdbg("Error reading physical sector %d.\n", sector);
 				goto err_out;
 			}
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+			/* A volume formatted without the checkpoint slots may have
+			 * sectors in their erase blocks.  Never write a checkpoint
+			 * over them, scan the whole device instead.
+			 */
+
+			ckptformat = dev->rwbuffer[SMART_FMT_CKPT_POS];
+			if (dev->ckptblocks > 0 && ckptformat != dev->ckptblocks) {
+				fdbg("Volume formatted with checkpoint slots of %d erase blocks\n", ckptformat);
+				break;
+			}
+#endif
 
 			dev->formatstatus = SMART_FMT_STAT_FORMATTED;
 			dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
@@ -2038,9 +3249,15 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 			readaddress = dev->sMap[logicalsector] * dev->mtdBlksPerSector * dev->geo.blocksize;
 #else
 			/* For minimize RAM, we have to rescan to find the 1st sector claiming to
-			 * be this logical sector.
+			 * be this logical sector, unless the packed map holds its page.
 			 */
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+			dupsector = smart_map_find(dev, logicalsector);
+			if (dupsector != 0xFFFF) {
+				readaddress = dupsector * dev->mtdBlksPerSector * dev->geo.blocksize;
+			} else
+#endif
 			for (dupsector = 0; dupsector < sector; dupsector++) {
 				/* Calculate the read address for this sector */
 
@@ -2135,6 +3352,21 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 				fdbg("Error %d releasing duplicate sector\n", -ret);
 				goto err_out;
 			}
+
+			/* The loser was counted as committed, count it as released */
+
+			dev->releasesectors++;
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+			smart_add_count(dev, dev->releasecount, loser / dev->sectorsPerBlk, 1);
+#else
+			dev->releasecount[loser / dev->sectorsPerBlk]++;
+#endif
+
+			/* The original mapping is kept if this sector lost */
+
+			if (loser == sector) {
+				continue;
+			}
 		}
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
 		/* Update the logical to physical sector map */
@@ -2144,11 +3376,39 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 		/* Mark the logical sector as used in the bitmap */
 		dev->sBitMap[logicalsector >> 3] |= 1 << (logicalsector & 0x07);
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+		/* Pages which are not in RAM are rebuilt when they are used */
+
+		smart_map_update(dev, logicalsector, sector, false);
+#else
 		if (logicalsector < dev->reservedsector) {
 			smart_add_sector_to_cache(dev, logicalsector, sector, __LINE__);
 		}
 #endif
+#endif
+	}
+
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	/* Scan a volume formatted without the checkpoint slots again with their
+	 * erase blocks, which may also hold its format sector.  A volume whose
+	 * slots have another size keeps them.
+	 */
+
+	if (dev->formatstatus != SMART_FMT_STAT_FORMATTED && dev->ckptblocks > 0) {
+		smart_ckpt_release(dev);
+		if (ckptformat != CONFIG_SMARTFS_ERASEDSTATE && (uint32_t)ckptformat * 4 <= dev->geo.neraseblocks) {
+			smart_ckpt_reserve(dev, ckptformat);
+		}
+		kmm_free(sector_seq_log);
+		sector_seq_log = NULL;
+		if (replay != NULL) {
+			kmm_free(replay);
+			replay = NULL;
+		}
+
+		goto restart;
 	}
+#endif
 
 #if defined(CONFIG_MTD_SMART_WEAR_LEVEL) && (SMART_STATUS_VERSION == 1)
 #ifdef CONFIG_MTD_SMART_CONVERT_WEAR_FORMAT
@@ -2214,6 +3474,10 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 #endif							/* CONFIG_MTD_SMART_CONVERT_WEAR_FORMAT */
 #endif							/* CONFIG_MTD_SMART_WEAR_LEVEL && SMART_STATUS_VERSION == 1 */
 
+	/* Sort the erase blocks into the garbage collection buckets */
+
+	smart_gc_rebuild(dev, true);
+
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 	/* Read the wear leveling status bits */
 
@@ -2234,12 +3498,25 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	}
 #endif
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	/* Checkpoint the result of a full scan */
+
+	if (replay == NULL) {
+		smart_ckpt_write(dev);
+	}
+#endif
+
 	ret = OK;
 
 err_out:
 	if (sector_seq_log != NULL) {
 		kmm_free(sector_seq_log);
 	}
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	if (replay != NULL) {
+		kmm_free(replay);
+	}
+#endif
 	return ret;
 }
 
@@ -2335,6 +3612,9 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 		dev->unusedsectors += freecount;
 		dev->blockerases++;
+#endif
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+		smart_ckpt_dirty(dev, block);
 #endif
 		MTD_ERASE(dev->mtd, block, 1);
 
@@ -2370,6 +3650,7 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t
 		dev->releasecount[block] = prerelease;
 		dev->freecount[block] = dev->availSectPerBlk - prerelease;
 #endif							/* CONFIG_MTD_SMART_PACK_COUNTS */
+		smart_gc_update(dev, block);
 
 		/* Now that we have erased this block and updated the release / free counts,
 		 * if we are in WEAR LEVELING enabled mode, we must check if this erase block's
@@ -2752,6 +4033,15 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 
 	fvdbg("Entry\n");
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	/* The whole device is erased, so the checkpoint slots are reserved again
+	 * and the previous checkpoint with its log is forgotten.
+	 */
+
+	smart_ckpt_release(dev);
+	smart_ckpt_initialize(dev);
+#endif
+
 	ret = smart_setsectorsize(dev, CONFIG_MTD_SMART_SECTOR_SIZE);
 	if (ret != OK) {
 		return ret;
@@ -2837,6 +4127,14 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 
 	dev->rwbuffer[SMART_FMT_ROOTDIRS_POS] = (uint8_t)arg;
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	/* Record the checkpoint slots which the volume is formatted with */
+
+	if (dev->ckptblocks > 0) {
+		dev->rwbuffer[SMART_FMT_CKPT_POS] = (uint8_t)dev->ckptblocks;
+	}
+#endif
+
 #ifdef CONFIG_SMART_CRC_8
 	sectorheader->crc8 = smart_calc_sector_crc(dev);
 #elif defined(CONFIG_SMART_CRC_16)
@@ -2865,6 +4163,8 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 		return ret;
 	}
 
+	/* The scan which reads the new format writes the first checkpoint */
+
 	dev->formatstatus = SMART_FMT_STAT_UNKNOWN;
 	dev->freesectors = dev->availSectPerBlk * dev->geo.neraseblocks - 1;
 	dev->releasesectors = 0;
@@ -2900,6 +4200,7 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 #else
 	dev->freecount[0]--;
 #endif
+	smart_gc_rebuild(dev, true);
 
 	/* Now initialize the logical to physical sector map */
 
@@ -2910,6 +4211,9 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 
 		dev->sMap[x] = -1;
 	}
+#elif defined(CONFIG_MTD_SMART_PACKED_MAP)
+	smart_map_reset(dev);
+	smart_map_update(dev, 0, 0, false);
 #endif
 
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
@@ -2996,6 +4300,9 @@ static int smart_relocate_sector(FAR struct smart_struct_s *dev, uint16_t oldsec
 
 	/* Write the data to the new physical sector location */
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	smart_ckpt_dirty(dev, newsector / dev->sectorsPerBlk);
+#endif
 	ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
 
 #else							/* CONFIG_MTD_SMART_ENABLE_CRC */
@@ -3008,6 +4315,9 @@ static int smart_relocate_sector(FAR struct smart_struct_s *dev, uint16_t oldsec
 
 	/* Write the data to the new physical sector location */
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	smart_ckpt_dirty(dev, newsector / dev->sectorsPerBlk);
+#endif
 	ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
 
 	/* Commit the sector */
@@ -3220,6 +4530,9 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 
 	/* Now erase the erase block */
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	smart_ckpt_dirty(dev, block);
+#endif
 	MTD_ERASE(dev->mtd, block, 1);
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 	dev->unusedsectors += freecount;
@@ -3264,6 +4577,7 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 	dev->freecount[block] = dev->availSectPerBlk - prerelease;
 	dev->releasecount[block] = prerelease;
 #endif
+	smart_gc_update(dev, block);
 
 #ifdef CONFIG_SMART_LOCAL_CHECKFREE
 	if (smart_checkfree(dev, __LINE__) != OK) {
@@ -3505,6 +4819,52 @@ retry:
 	return physicalsector;
 }
 
+/****************************************************************************
+ * Name: smart_gc_findblock
+ *
+ * Description:  Find the erase block with the most released sectors, by
+ *               searching the garbage collection buckets from the highest
+ *               release counts down.  Returns 0xFFFF if no block can be
+ *               collected.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static uint16_t smart_gc_findblock(FAR struct smart_struct_s *dev, FAR uint16_t *releasemax)
+{
+	uint16_t collectblock;
+	uint16_t block;
+	uint16_t count;
+	int bucket;
+
+	collectblock = 0xFFFF;
+	*releasemax = 0;
+	for (bucket = SMART_GC_BUCKETS - 1; bucket >= 0 && collectblock == 0xFFFF; bucket--) {
+		for (block = dev->gchead[bucket]; block != SMART_GC_END; block = dev->gcnext[block]) {
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+			/* Don't collect blocks that have been worn completely */
+
+			if (smart_get_wear_level(dev, block) >= SMART_WEAR_REORG_THRESHOLD) {
+				continue;
+			}
+#endif
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+			count = smart_get_count(dev, dev->releasecount, block);
+#else
+			count = dev->releasecount[block];
+#endif
+			if (count > *releasemax) {
+				*releasemax = count;
+				collectblock = block;
+			}
+		}
+	}
+
+	return collectblock;
+}
+#endif							/* CONFIG_FS_WRITABLE */
+
 /****************************************************************************
  * Name: smart_garbagecollect
  *
@@ -3520,11 +4880,7 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 	uint16_t collectblock;
 	uint16_t releasemax;
 	bool collect = TRUE;
-	int x;
 	int ret;
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-	uint8_t count;
-#endif
 
 	while (collect) {
 		collect = FALSE;
@@ -3548,31 +4904,7 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 		if (collect) {
 			/* Find the block with the most released sectors */
 
-			collectblock = 0xFFFF;
-			releasemax = 0;
-			for (x = 0; x < dev->neraseblocks; x++) {
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-				/* Don't collect blocks that have been worn completely */
-
-				if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD) {
-					continue;
-				}
-#endif
-
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-				count = smart_get_count(dev, dev->releasecount, x);
-				if (count > releasemax) {
-					releasemax = count;
-					collectblock = x;
-				}
-#else
-				if (dev->releasecount[x] > releasemax) {
-					releasemax = dev->releasecount[x];
-					collectblock = x;
-				}
-#endif
-			}
-			//releasemax = smart_get_count(dev, dev->releasecount, collectblock);
+			collectblock = smart_gc_findblock(dev, &releasemax);
 
 			if (collectblock == 0xFFFF) {
 				/* Need to collect, but no sectors with released blocks! */
@@ -3888,6 +5220,9 @@ static int smart_write_alloc_sector(FAR struct smart_struct_s *dev, uint16_t log
 
 #ifndef CONFIG_MTD_SMART_ENABLE_CRC
 	fvdbg("Write MTD block %d\n", physical * dev->mtdBlksPerSector);
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	smart_ckpt_dirty(dev, physical / dev->sectorsPerBlk);
+#endif
 	ret = MTD_BWRITE(dev->mtd, physical * dev->mtdBlksPerSector, 1, (FAR uint8_t *)dev->rwbuffer);
 	if (ret != 1) {
 		/* The block is not empty!!  What to do? */
@@ -4216,6 +5551,9 @@ relocate_good_sector:
 	if (needsrelocate) {
 		/* Write the entire sector to the new physical location, uncommitted. */
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+		smart_ckpt_dirty(dev, physsector / dev->sectorsPerBlk);
+#endif
 		ret = MTD_BWRITE(dev->mtd, physsector * dev->mtdBlksPerSector, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
 		if (ret != dev->mtdBlksPerSector) {
 			fdbg("Error writing to physical sector %d\n", physsector);
@@ -4285,6 +5623,7 @@ relocate_good_sector:
 		dev->releasecount[block]++;
 		dev->freecount[physsector / dev->sectorsPerBlk]--;
 #endif
+		smart_gc_update(dev, block);
 		dev->freesectors--;
 		dev->releasesectors++;
 
@@ -4315,6 +5654,9 @@ relocate_good_sector:
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
 		/* Write the entire sector to FLASH when CRC enabled */
 
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+		smart_ckpt_dirty(dev, physsector / dev->sectorsPerBlk);
+#endif
 		ret = MTD_BWRITE(dev->mtd, physsector * dev->mtdBlksPerSector, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
 		if (ret != dev->mtdBlksPerSector) {
 			fdbg("Error writing to physical sector %d\n", physsector);
@@ -4405,6 +5747,7 @@ errout:
 		dev->releasecount[block]++;
 		dev->freecount[physsector / dev->sectorsPerBlk]--;
 #endif
+		smart_gc_update(dev, block);
 		dev->freesectors--;
 		dev->releasesectors++;
 
@@ -4871,6 +6214,7 @@ static inline int smart_freesector(FAR struct smart_struct_s *dev, unsigned long
 #else
 	dev->releasecount[block]++;
 #endif
+	smart_gc_update(dev, block);
 
 	/* Unmap this logical sector */
 
@@ -4891,6 +6235,118 @@ errout:
 }
 #endif							/* CONFIG_FS_WRITABLE */
 
+/****************************************************************************
+ * Name: smart_gc_wanted
+ *
+ * Description:  Test if the background garbage collection should collect
+ *               a block, and find the block to collect.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+static bool smart_gc_wanted(FAR struct smart_struct_s *dev, FAR uint16_t *block)
+{
+	uint16_t releasemax;
+
+	if (dev->formatstatus != SMART_FMT_STAT_FORMATTED) {
+		return false;
+	}
+
+	/* Nothing to do while enough sectors are free */
+
+	if ((uint32_t)dev->freesectors * 100 >= (uint32_t)dev->totalsectors * CONFIG_MTD_SMART_BACKGROUND_GC_FREE) {
+		return false;
+	}
+
+	/* Relocating a block with only a few released sectors would cost an
+	 * erase for little space.  Leave those to the write path.
+	 */
+
+	*block = smart_gc_findblock(dev, &releasemax);
+	return *block != 0xFFFF && releasemax >= SMART_GC_MIN_RELEASE(dev);
+}
+
+/****************************************************************************
+ * Name: smart_gc_worker
+ *
+ * Description:  The background garbage collection, run on the low priority
+ *               work queue.  Collects one erase block each time the device
+ *               has been idle for CONFIG_MTD_SMART_BACKGROUND_GC_IDLE msec,
+ *               so that the accesses wait for at most one block relocation.
+ *
+ ****************************************************************************/
+
+static void smart_gc_worker(FAR void *arg)
+{
+	FAR struct smart_struct_s *dev = (FAR struct smart_struct_s *)arg;
+	systime_t idle = MSEC2TICK(CONFIG_MTD_SMART_BACKGROUND_GC_IDLE);
+	systime_t elapsed;
+	uint16_t block;
+	int ret;
+
+	/* The work is only queued with the semaphore held, so that it is never
+	 * queued twice.
+	 */
+
+	smart_semtake(dev);
+
+	/* Wait some more if the device has been accessed in the meantime */
+
+	elapsed = clock_systimer() - dev->lastaccess;
+	if (elapsed < idle) {
+		work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, idle - elapsed);
+		smart_semgive(dev);
+		return;
+	}
+
+	if (smart_gc_wanted(dev, &block)) {
+		fvdbg("Background collecting block %d\n", block);
+		ret = smart_relocate_block(dev, block);
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+		if (dev->wearflags & SMART_WEARFLAGS_WRITE_NEEDED) {
+			/* Write new wear status bits to the device */
+
+			smart_write_wearstatus(dev);
+		}
+#endif
+
+		/* Continue with the next block after another idle period */
+
+		if (ret == OK && smart_gc_wanted(dev, &block)) {
+			work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, idle);
+		} else if (ret != OK) {
+			fdbg("Error %d collecting block %d\n", ret, block);
+		}
+	}
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	if (dev->ckptneeded) {
+		smart_ckpt_write(dev);
+	}
+#endif
+
+	smart_semgive(dev);
+}
+
+/****************************************************************************
+ * Name: smart_gc_schedule
+ *
+ * Description:  Called with the semaphore held after each access which can
+ *               release sectors.  Schedules the background garbage collection
+ *               if it is needed.
+ *
+ ****************************************************************************/
+
+static void smart_gc_schedule(FAR struct smart_struct_s *dev)
+{
+	uint16_t block;
+
+	if (work_available(&dev->gcwork) && smart_gc_wanted(dev, &block)) {
+		work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, MSEC2TICK(CONFIG_MTD_SMART_BACKGROUND_GC_IDLE));
+	}
+}
+#endif							/* CONFIG_MTD_SMART_BACKGROUND_GC */
+
 /****************************************************************************
  * Name: smart_ioctl
  *
@@ -4905,6 +6361,9 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 	FAR struct mtd_smart_procfs_data_s *procfs_data;
 	FAR struct mtd_smart_debug_data_s *debug_data;
+#endif
+#ifdef CONFIG_MTD_WRITE_LATENCY
+	systime_t start = clock_systimer();
 #endif
 	fvdbg("Entry cmd : %08x\n", cmd);
 	DEBUGASSERT(inode && inode->i_private);
@@ -4915,6 +6374,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
+	smart_semtake(dev);
+
 	/* Process the ioctl's we care about first, pass any we don't respond
 	 * to directly to the underlying MTD device.
 	 */
@@ -4929,7 +6390,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #ifdef CONFIG_DEBUG
 		if (arg == 0) {
 			fdbg("ERROR: BIOC_XIPBASE argument is NULL\n");
-			return -EINVAL;
+			ret = -EINVAL;
+			goto ok_out;
 		}
 #endif
 
@@ -4991,6 +6453,14 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 		}
 #endif
 
+#ifdef CONFIG_MTD_WRITE_LATENCY
+		/* Record the time the caller waited, including the garbage
+		 * collection and the wait for the semaphore.
+		 */
+
+		mtd_write_latency(dev->mtd, (uint32_t)TICK2MSEC(clock_systimer() - start));
+#endif
+
 		goto ok_out;
 #endif							/* CONFIG_FS_WRITABLE */
 
@@ -5017,6 +6487,11 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 		procfs_data->formatsector = smart_cache_lookup(dev, 0);
 		procfs_data->dirsector = smart_cache_lookup(dev, 3);
 #endif
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+		procfs_data->mappages = dev->mappages;
+		procfs_data->mapslots = dev->mapslotcount;
+		procfs_data->mapmisses = dev->mapmisses;
+#endif
 
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 		procfs_data->neraseblocks = dev->geo.neraseblocks;
@@ -5061,6 +6536,19 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	}
 
 ok_out:
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+	dev->lastaccess = clock_systimer();
+	if (cmd == BIOC_WRITESECT || cmd == BIOC_FREESECT || cmd == BIOC_ALLOCSECT) {
+		smart_gc_schedule(dev);
+	}
+#endif
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	if (dev->ckptneeded) {
+		smart_ckpt_write(dev);
+	}
+#endif
+
+	smart_semgive(dev);
 	return ret;
 }
 
@@ -5130,6 +6618,12 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 			fdbg("MTD ioctl(MTDIOC_GEOMETRY) failed: %d\n", ret);
 			goto errout;
 		}
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+		/* Reserve the checkpoint slots at the end of the device */
+
+		smart_ckpt_initialize(dev);
+		dev->ckptdirty = NULL;
+#endif
 
 		/* Set the sector size to the default for now */
 
@@ -5140,8 +6634,12 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
 		dev->sMap = NULL;
+#else
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+		dev->mapslots = NULL;
 #else
 		dev->sCache = NULL;
+#endif
 		dev->sBitMap = NULL;
 #endif
 		dev->rwbuffer = NULL;
@@ -5154,6 +6652,12 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 #endif
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
 		dev->allocsector = NULL;
+#endif
+		dev->gcnext = NULL;
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+		sem_init(&dev->exclsem, 0, 1);
+		dev->gcwork.worker = NULL;
+		dev->lastaccess = 0;
 #endif
 		dev->sectorsize = 0;
 		ret = smart_setsectorsize(dev, CONFIG_MTD_SMART_SECTOR_SIZE);
@@ -5251,7 +6755,11 @@ errout:
 	}
 #else
 	smart_free(dev, dev->sBitMap);
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	smart_free(dev, dev->mapslots);
+#else
 	smart_free(dev, dev->sCache);
+#endif
 #endif
 	if (dev->rwbuffer != NULL) {
 		smart_free(dev, dev->rwbuffer);
@@ -5267,6 +6775,17 @@ errout:
 #endif
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 	smart_free(dev, dev->erasecounts);
+#endif
+	if (dev->gcnext != NULL) {
+		smart_free(dev, dev->gcnext);
+	}
+#ifdef CONFIG_MTD_SMART_FAST_MOUNT
+	if (dev->ckptdirty != NULL) {
+		smart_free(dev, dev->ckptdirty);
+	}
+#endif
+#ifdef CONFIG_MTD_SMART_BACKGROUND_GC
+	sem_destroy(&dev->exclsem);
 #endif
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
 	if (rootdirdev) {
@@ -5301,11 +6820,13 @@ int smart_validatesector(FAR struct inode *inode, uint16_t logsector, char *vali
 		return -EINVAL;
 	}
 
+	smart_semtake(dev);
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
 	physsector = dev->sMap[logsector];
 #else
 	physsector = smart_cache_lookup(dev, logsector);
 #endif
+	smart_semgive(dev);
 	if (physsector != 0xFFFF) {
 		SET_TO_TRUE(validsectors, physsector);
 		return OK;
@@ -5344,6 +6865,8 @@ int smart_recoversectors(FAR struct inode *inode, char *validsectors, int *nobso
 		smart_validatesector(inode, logicalsector, validsectors);
 	}
 
+	smart_semtake(dev);
+
 	for (sector = 1; sector < totalsectors; sector++) {
 		readaddress = sector * dev->mtdBlksPerSector * dev->geo.blocksize;
 		ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
@@ -5395,6 +6918,7 @@ int smart_recoversectors(FAR struct inode *inode, char *validsectors, int *nobso
 #else
 			dev->releasecount[block]++;
 #endif
+			smart_gc_update(dev, block);
 
 			/* if the mapping is sane, Unmap this logical->physicalsector map */
 			if (physsector == sector) {
@@ -5413,6 +6937,7 @@ int smart_recoversectors(FAR struct inode *inode, char *validsectors, int *nobso
 
 	ret = OK;
 err_out:
+	smart_semgive(dev);
 	return ret;
 }
 #endif
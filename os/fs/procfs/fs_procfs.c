@@ -96,6 +96,8 @@ extern const struct procfs_operations proc_operations;
 extern const struct procfs_operations cpuload_operations;
 extern const struct procfs_operations uptime_operations;
 extern const struct procfs_operations version_operations;
+extern const struct procfs_operations slab_operations;
+extern const struct procfs_operations mmtrace_operations;
 
 /* This is not good.  These are implemented in drivers/mtd.  Having to
  * deal with them here is not a good coupling.
@@ -131,6 +133,19 @@ static const struct procfs_entry_s g_procfsentries[] = {
 	{"fs/smartfs**", &smartfs_procfsoperations},
 #endif
 
+#if defined(CONFIG_MM_SLAB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SLAB)
+	{"slabinfo", &slab_operations},
+#endif
+
+#if defined(CONFIG_MM_TRACE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MMTRACE)
+#ifndef CONFIG_BUILD_PROTECTED
+	{"mmtrace", &mmtrace_operations},
+#endif
+#ifdef CONFIG_MM_KERNEL_HEAP
+	{"kmmtrace", &mmtrace_operations},
+#endif
+#endif
+
 #if defined(CONFIG_MTD) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MTD)
 	{"mtd", &mtd_procfsoperations},
 #endif
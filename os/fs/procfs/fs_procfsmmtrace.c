@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/procfs/fs_procfsmmtrace.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/mm/mm.h>
+#include <tinyara/mm/trace.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_MM_TRACE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MMTRACE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file".  The trace is copied out of
+ * the heap when the file is opened so that it does not change while it is
+ * read.
+ */
+
+struct mmtrace_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	size_t datalen;				/* Number of valid bytes in hdr and recs */
+	struct mm_tracehdr_s hdr;	/* The header of the trace */
+	struct mm_trace_s recs[1];	/* The records (variable size) */
+};
+
+#define SIZEOF_MMTRACE_FILE_S(n) \
+	(sizeof(struct mmtrace_file_s) + ((n) - 1) * sizeof(struct mm_trace_s))
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int mmtrace_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int mmtrace_close(FAR struct file *filep);
+static ssize_t mmtrace_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int mmtrace_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int mmtrace_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations mmtrace_operations = {
+	mmtrace_open,				/* open */
+	mmtrace_close,				/* close */
+	mmtrace_read,				/* read */
+	NULL,						/* write */
+
+	mmtrace_dup,				/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	mmtrace_stat				/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mmtrace_heap
+ *
+ * Description:
+ *   Map the relpath to the heap whose trace it shows.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_heap_s *mmtrace_heap(FAR const char *relpath)
+{
+#ifndef CONFIG_BUILD_PROTECTED
+	if (strcmp(relpath, "mmtrace") == 0) {
+		return &g_mmheap;
+	}
+#endif
+#ifdef CONFIG_MM_KERNEL_HEAP
+	if (strcmp(relpath, "kmmtrace") == 0) {
+		return &g_kmmheap;
+	}
+#endif
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: mmtrace_open
+ ****************************************************************************/
+
+static int mmtrace_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct mmtrace_file_s *attr;
+	FAR struct mm_heap_s *heap;
+	int nrecords;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	heap = mmtrace_heap(relpath);
+	if (heap == NULL) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* Allocate a container large enough for the whole ring */
+
+	attr = (FAR struct mmtrace_file_s *)kmm_zalloc(SIZEOF_MMTRACE_FILE_S(CONFIG_MM_TRACE_ENTRIES));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The header and the records are contiguous in the container */
+
+	DEBUGASSERT(offsetof(struct mmtrace_file_s, recs) == offsetof(struct mmtrace_file_s, hdr) + sizeof(struct mm_tracehdr_s));
+
+	nrecords = mm_trace_snapshot(heap, &attr->hdr, attr->recs, CONFIG_MM_TRACE_ENTRIES);
+	attr->datalen = sizeof(struct mm_tracehdr_s) + nrecords * sizeof(struct mm_trace_s);
+
+	/* Save the attributes as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: mmtrace_close
+ ****************************************************************************/
+
+static int mmtrace_close(FAR struct file *filep)
+{
+	FAR struct mmtrace_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct mmtrace_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: mmtrace_read
+ ****************************************************************************/
+
+static ssize_t mmtrace_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct mmtrace_file_s *attr;
+	off_t offset;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct mmtrace_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Transfer the binary trace to user receive buffer */
+
+	offset = filep->f_pos;
+	ret = procfs_memcpy((FAR const char *)&attr->hdr, attr->datalen, buffer, buflen, &offset);
+
+	/* Update the file offset */
+
+	if (ret > 0) {
+		filep->f_pos += ret;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: mmtrace_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int mmtrace_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct mmtrace_file_s *oldattr;
+	FAR struct mmtrace_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct mmtrace_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct mmtrace_file_s *)kmm_malloc(SIZEOF_MMTRACE_FILE_S(CONFIG_MM_TRACE_ENTRIES));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, SIZEOF_MMTRACE_FILE_S(CONFIG_MM_TRACE_ENTRIES));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: mmtrace_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int mmtrace_stat(const char *relpath, struct stat *buf)
+{
+	if (mmtrace_heap(relpath) == NULL) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* The trace is a read-only file */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif							/* CONFIG_MM_TRACE && !CONFIG_FS_PROCFS_EXCLUDE_MMTRACE */
+#endif							/* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
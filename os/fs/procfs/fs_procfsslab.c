@@ -0,0 +1,312 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/procfs/fs_procfsslab.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/mm/slab.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_MM_SLAB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SLAB)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Determines the size of the buffer reserved for each line of output:
+ * the header and one line per cache.
+ */
+
+#define SLAB_LINELEN 80
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file".  The whole text is generated
+ * when the file is opened so that it stays consistent across reads.
+ */
+
+struct slab_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	size_t buflen;				/* Size of the text buffer */
+	size_t textlen;				/* Number of valid characters in text[] */
+	char text[1];				/* Formatted statistics (variable size) */
+};
+
+#define SIZEOF_SLAB_FILE_S(n) (sizeof(struct slab_file_s) + (n) - 1)
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int slab_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int slab_close(FAR struct file *filep);
+static ssize_t slab_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int slab_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int slab_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations slab_operations = {
+	slab_open,					/* open */
+	slab_close,					/* close */
+	slab_read,					/* read */
+	NULL,						/* write */
+
+	slab_dup,					/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	slab_stat					/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_count
+ ****************************************************************************/
+
+static void slab_count(FAR const struct slabinfo_s *info, FAR void *arg)
+{
+	(*(FAR int *)arg)++;
+}
+
+/****************************************************************************
+ * Name: slab_format
+ ****************************************************************************/
+
+static void slab_format(FAR const struct slabinfo_s *info, FAR void *arg)
+{
+	FAR struct slab_file_s *attr = (FAR struct slab_file_s *)arg;
+	size_t remaining = attr->buflen - attr->textlen;
+	int len;
+
+	/* A cache created after the buffer was sized is not shown */
+
+	if (remaining <= 1) {
+		return;
+	}
+
+	len = snprintf(&attr->text[attr->textlen], remaining, "%-12.12s %7u %7u %6u %7u %7u %10lu %6lu\n", info->name, (unsigned int)info->objsize, (unsigned int)info->perslab, (unsigned int)info->nslabs, (unsigned int)info->inuse, (unsigned int)info->peak, (unsigned long)info->nallocs, (unsigned long)info->nfails);
+	if (len > 0) {
+		attr->textlen += ((size_t)len < remaining) ? (size_t)len : remaining - 1;
+	}
+}
+
+/****************************************************************************
+ * Name: slab_open
+ ****************************************************************************/
+
+static int slab_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct slab_file_s *attr;
+	size_t buflen;
+	int ncaches = 0;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	/* "slabinfo" is the only acceptable value for the relpath */
+
+	if (strcmp(relpath, "slabinfo") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* Allocate a container large enough for the header and all caches */
+
+	slab_foreach(slab_count, &ncaches);
+	buflen = (ncaches + 1) * SLAB_LINELEN;
+
+	attr = (FAR struct slab_file_s *)kmm_zalloc(SIZEOF_SLAB_FILE_S(buflen));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	attr->buflen = buflen;
+	attr->textlen = snprintf(attr->text, buflen, "%-12s %7s %7s %6s %7s %7s %10s %6s\n", "name", "objsize", "perslab", "slabs", "inuse", "peak", "allocs", "fails");
+	slab_foreach(slab_format, attr);
+
+	/* Save the attributes as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: slab_close
+ ****************************************************************************/
+
+static int slab_close(FAR struct file *filep)
+{
+	FAR struct slab_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct slab_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: slab_read
+ ****************************************************************************/
+
+static ssize_t slab_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct slab_file_s *attr;
+	off_t offset;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct slab_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Transfer the statistics to user receive buffer */
+
+	offset = filep->f_pos;
+	ret = procfs_memcpy(attr->text, attr->textlen, buffer, buflen, &offset);
+
+	/* Update the file offset */
+
+	if (ret > 0) {
+		filep->f_pos += ret;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: slab_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int slab_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct slab_file_s *oldattr;
+	FAR struct slab_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct slab_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct slab_file_s *)kmm_malloc(SIZEOF_SLAB_FILE_S(oldattr->buflen));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, SIZEOF_SLAB_FILE_S(oldattr->buflen));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: slab_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int slab_stat(const char *relpath, struct stat *buf)
+{
+	/* "slabinfo" is the only acceptable value for the relpath */
+
+	if (strcmp(relpath, "slabinfo") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* "slabinfo" is the name for a read-only file */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif							/* CONFIG_MM_SLAB && !CONFIG_FS_PROCFS_EXCLUDE_SLAB */
+#endif							/* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -349,6 +349,19 @@ struct smartfs_chain_header_s {
 };
 #endif
 
+/* This structure is one entry of the directory entry cache.  It gives the
+ * directory sector holding the entry with a name hashing to 'hash' in the
+ * directory starting at sector 'dir'.
+ */
+
+#ifdef CONFIG_SMARTFS_DIRCACHE
+struct smartfs_dircache_s {
+	uint16_t dir;				/* First sector of the parent directory */
+	uint16_t hash;				/* Hash of the entry name */
+	uint16_t sector;			/* Directory sector holding the entry */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -371,6 +384,19 @@ struct smartfs_ofile_s {
 								 * used field until the file is closed,
 								 * a seek, or more data is written that
 								 * causes the sector to change. */
+#ifdef CONFIG_SMARTFS_READAHEAD
+	uint8_t *rabuffer;			/* Sectors read ahead, one after the other */
+	uint16_t rasector[CONFIG_SMARTFS_READAHEAD_SECTORS];	/* Sector held by each
+								 * slot of rabuffer, 0xFFFF if none */
+	size_t rapos;				/* File position following the last read,
+								 * to detect sequential reads */
+#endif
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	uint16_t *sindex;			/* Sector of every SEEK_INDEX_INTERVAL sectors,
+								 * starting with the sector INTERVAL */
+	uint16_t nindex;			/* Number of valid entries in sindex */
+	uint16_t sindexsize;		/* Number of entries allocated for sindex */
+#endif
 };
 
 /* This structure represents the overall mountpoint state.  An instance of this
@@ -395,6 +421,9 @@ struct smartfs_mountpt_s {
 #endif
 #ifdef CONFIG_SMARTFS_JOURNALING
 	struct journal_transaction_manager_s *journal;
+#endif
+#ifdef CONFIG_SMARTFS_DIRCACHE
+	struct smartfs_dircache_s *fs_dircache;	/* Directory entry cache */
 #endif
 	uint8_t fs_rootsector;		/* Root directory sector num */
 };
@@ -537,6 +566,12 @@ void smartfs_wrle32(uint8_t *dest, uint32_t val);
 struct smartfs_mountpt_s *smartfs_get_first_mount(void);
 #endif
 
+#ifdef CONFIG_SMARTFS_DIRCACHE
+uint16_t smartfs_dircache_find(struct smartfs_mountpt_s *fs, uint16_t dir, const char *name);
+void smartfs_dircache_add(struct smartfs_mountpt_s *fs, uint16_t dir, const char *name, uint16_t sector);
+void smartfs_dircache_remove(struct smartfs_mountpt_s *fs, uint16_t dir, const char *name);
+#endif
+
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
 uint16_t get_leftover_used_byte_count(uint8_t *buffer, uint16_t base_index);
 uint16_t get_used_byte_count_from_end(uint8_t *buffer);
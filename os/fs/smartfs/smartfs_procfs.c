@@ -752,6 +752,11 @@ static size_t smartfs_status_read(FAR struct file *filep, FAR char *buffer, size
 		if (ret == OK) {
 			/* Format and return data in the buffer */
 			len = snprintf(buffer, buflen, "Total Sectors    %d\nFree Sectors     %d\n" "Released Sectors %d\n", procfs_data.totalsectors, procfs_data.freesectors, procfs_data.releasesectors);
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+			if (len < buflen) {
+				len += snprintf(&buffer[len], buflen - len, "Map Pages        %d/%d\nMap Misses       %d\n", procfs_data.mapslots, procfs_data.mappages, (int)procfs_data.mapmisses);
+			}
+#endif
 #ifdef CONFIG_DEBUG_FS
 			/* Calculate the sector utilization percentage */
 			if (procfs_data.blockerases == 0) {
@@ -82,6 +82,10 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Number of entries added to the seek index of a file when it is full */
+
+#define SMARTFS_SEEK_INDEX_GROW   8
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -115,6 +119,14 @@ static int smartfs_rename(struct inode *mountpt, const char *oldrelpath, const c
 static int smartfs_stat(struct inode *mountpt, const char *relpath, struct stat *buf);
 
 static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf, off_t offset, int whence);
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+static void smartfs_seekindex_add(struct smartfs_ofile_s *sf, uint32_t sectorno, uint16_t sector);
+#endif
+#ifdef CONFIG_SMARTFS_READAHEAD
+static int smartfs_readahead_find(struct smartfs_ofile_s *sf, uint16_t sector);
+static int smartfs_readahead(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf, bool sequential, uint8_t **data);
+static void smartfs_readahead_invalidate(struct smartfs_mountpt_s *fs, uint16_t firstsector);
+#endif
 
 /****************************************************************************
  * Private Variables
@@ -175,6 +187,9 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 	uint16_t parentdirsector;
 	const char *filename;
 	struct smartfs_ofile_s *sf;
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	struct smartfs_ofile_s *nextfile;
+#endif
 
 #ifdef CONFIG_SMARTFS_JOURNALING
 	int retj;
@@ -221,6 +236,17 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 	sf->bflags = 0;
 #endif							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
 
+#ifdef CONFIG_SMARTFS_READAHEAD
+	sf->rabuffer = NULL;
+	memset(sf->rasector, 0xff, sizeof(sf->rasector));
+	sf->rapos = 0;
+#endif
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	sf->sindex = NULL;
+	sf->nindex = 0;
+	sf->sindexsize = 0;
+#endif
+
 	sf->entry.name = NULL;
 	ret = smartfs_finddirentry(fs, &sf->entry, relpath, &parentdirsector, &filename);
 
@@ -263,6 +289,21 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 				if (ret < 0) {
 					goto errout_with_buffer;
 				}
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+
+				/* The sectors indexed by other opens of this file were
+				 * released, drop their index.
+				 */
+
+				for (nextfile = fs->fs_head; nextfile != NULL; nextfile = nextfile->fnext) {
+					if (nextfile->entry.firstsector == sf->entry.firstsector) {
+						nextfile->nindex = 0;
+					}
+				}
+#endif
+#ifdef CONFIG_SMARTFS_READAHEAD
+				smartfs_readahead_invalidate(fs, sf->entry.firstsector);
+#endif
 			}
 		}
 	} else if (ret == -ENOENT) {
@@ -443,6 +484,16 @@ static int smartfs_close(FAR struct file *filep)
 		kmm_free(sf->buffer);
 	}
 #endif
+#ifdef CONFIG_SMARTFS_READAHEAD
+	if (sf->rabuffer) {
+		kmm_free(sf->rabuffer);
+	}
+#endif
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	if (sf->sindex) {
+		kmm_free(sf->sindex);
+	}
+#endif
 
 	kmm_free(sf);
 
@@ -466,6 +517,12 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 	uint32_t bytesread;
 	uint16_t bytestoread;
 	uint16_t bytesinsector;
+	uint8_t *data;
+#ifdef CONFIG_SMARTFS_READAHEAD
+	uint8_t saved[sizeof(struct smartfs_chain_header_s)];
+	bool sequential;
+	bool direct;
+#endif
 
 	/* Sanity checks */
 
@@ -485,6 +542,9 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 
 	/* Loop until all byte read or error */
 
+#ifdef CONFIG_SMARTFS_READAHEAD
+	sequential = (sf->filepos == sf->rapos);
+#endif
 	bytesread = 0;
 	while (bytesread != buflen) {
 		/* Test if we are at the end of data */
@@ -495,6 +555,35 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 			break;
 		}
 
+#ifdef CONFIG_SMARTFS_READAHEAD
+		/* A whole sector which is not in the read-ahead buffer is read
+		 * straight into the user buffer, its chain header landing over
+		 * the end of the data already read, which is saved meanwhile.
+		 */
+
+		direct = (sf->curroffset == sizeof(struct smartfs_chain_header_s) && bytesread >= sizeof(struct smartfs_chain_header_s) && buflen - bytesread >= fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s) && smartfs_readahead_find(sf, sf->currsector) < 0);
+		if (direct) {
+			data = (uint8_t *)&buffer[bytesread - sizeof(struct smartfs_chain_header_s)];
+			memcpy(saved, data, sizeof(struct smartfs_chain_header_s));
+
+			readwrite.logsector = sf->currsector;
+			readwrite.offset = 0;
+			readwrite.buffer = data;
+			readwrite.count = fs->fs_llformat.availbytes;
+			ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+
+			memcpy(fs->fs_rwbuffer, data, sizeof(struct smartfs_chain_header_s));
+			memcpy(data, saved, sizeof(struct smartfs_chain_header_s));
+			data = (uint8_t *)fs->fs_rwbuffer;
+		} else {
+			ret = smartfs_readahead(fs, sf, sequential, &data);
+		}
+
+		if (ret < 0) {
+			fdbg("Error %d reading sector %d data\n", ret, sf->currsector);
+			goto errout_with_semaphore;
+		}
+#else
 		/* Read the curent sector into our buffer */
 
 		readwrite.logsector = sf->currsector;
@@ -507,13 +596,16 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 			goto errout_with_semaphore;
 		}
 
+		data = (uint8_t *)fs->fs_rwbuffer;
+#endif
+
 		/* Point header to the read data to get used byte count */
 
-		header = (struct smartfs_chain_header_s *)fs->fs_rwbuffer;
+		header = (struct smartfs_chain_header_s *)data;
 
 		/* Get number of used bytes in this sector */
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
-		bytesinsector = get_leftover_used_byte_count((uint8_t *)readwrite.buffer, get_used_byte_count((uint8_t *)header->used));
+		bytesinsector = get_leftover_used_byte_count(data, get_used_byte_count((uint8_t *)header->used));
 #else
 		bytesinsector = SMARTFS_USED(header);
 
@@ -537,7 +629,12 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 		if (bytestoread > 0) {
 			/* Do incremental copy from this sector */
 
-			memcpy(&buffer[bytesread], &fs->fs_rwbuffer[sf->curroffset], bytestoread);
+#ifdef CONFIG_SMARTFS_READAHEAD
+			if (!direct)
+#endif
+			{
+				memcpy(&buffer[bytesread], &data[sf->curroffset], bytestoread);
+			}
 			bytesread += bytestoread;
 			sf->filepos += bytestoread;
 			sf->curroffset += bytestoread;
@@ -558,11 +655,17 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 
 				break;
 			}
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+			smartfs_seekindex_add(sf, sf->filepos / (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s)), sf->currsector);
+#endif
 		}
 	}
 
 	/* Return the number of bytes we read */
 
+#ifdef CONFIG_SMARTFS_READAHEAD
+	sf->rapos = sf->filepos;
+#endif
 	ret = bytesread;
 
 errout_with_semaphore:
@@ -570,6 +673,114 @@ errout_with_semaphore:
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smartfs_readahead_find
+ *
+ * Description: Returns the slot of the read-ahead buffer holding a sector
+ *              or -1 if the sector is not in the buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_READAHEAD
+static int smartfs_readahead_find(struct smartfs_ofile_s *sf, uint16_t sector)
+{
+	int slot;
+
+	if (sf->rabuffer != NULL) {
+		for (slot = 0; slot < CONFIG_SMARTFS_READAHEAD_SECTORS; slot++) {
+			if (sf->rasector[slot] == sector) {
+				return slot;
+			}
+		}
+	}
+
+	return -1;
+}
+
+/****************************************************************************
+ * Name: smartfs_readahead
+ *
+ * Description: Returns in 'data' the content of the current sector of the
+ *              file, from the read-ahead buffer.  If the sector is not in
+ *              the buffer, the buffer is refilled with it and, when the
+ *              file is read sequentially, with the sectors following it in
+ *              the chain.  The mountpoint read/write buffer is used if the
+ *              read-ahead buffer can't be allocated.
+ *
+ ****************************************************************************/
+
+static int smartfs_readahead(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf, bool sequential, uint8_t **data)
+{
+	struct smart_read_write_s readwrite;
+	struct smartfs_chain_header_s *header;
+	uint16_t sector;
+	int slot;
+	int ret;
+
+	slot = smartfs_readahead_find(sf, sf->currsector);
+	if (slot >= 0) {
+		*data = &sf->rabuffer[slot * fs->fs_llformat.availbytes];
+		return OK;
+	}
+
+	if (sf->rabuffer == NULL) {
+		sf->rabuffer = (uint8_t *)kmm_malloc(CONFIG_SMARTFS_READAHEAD_SECTORS * fs->fs_llformat.availbytes);
+	}
+
+	readwrite.offset = 0;
+	readwrite.count = fs->fs_llformat.availbytes;
+	if (sf->rabuffer == NULL) {
+		readwrite.logsector = sf->currsector;
+		readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
+		*data = (uint8_t *)fs->fs_rwbuffer;
+		return FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+	}
+
+	memset(sf->rasector, 0xff, sizeof(sf->rasector));
+	sector = sf->currsector;
+	for (slot = 0; slot < (sequential ? CONFIG_SMARTFS_READAHEAD_SECTORS : 1) && sector != SMARTFS_ERASEDSTATE_16BIT; slot++) {
+		readwrite.logsector = sector;
+		readwrite.buffer = &sf->rabuffer[slot * fs->fs_llformat.availbytes];
+		ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+		if (ret < 0) {
+			/* Only an error on the current sector matters */
+
+			if (slot == 0) {
+				return ret;
+			}
+
+			break;
+		}
+
+		sf->rasector[slot] = sector;
+		header = (struct smartfs_chain_header_s *)readwrite.buffer;
+		sector = SMARTFS_NEXTSECTOR(header);
+	}
+
+	*data = sf->rabuffer;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: smartfs_readahead_invalidate
+ *
+ * Description: Empties the read-ahead buffer of every open of the file
+ *              starting at 'firstsector', as its sectors are modified.
+ *
+ ****************************************************************************/
+
+static void smartfs_readahead_invalidate(struct smartfs_mountpt_s *fs, uint16_t firstsector)
+{
+	struct smartfs_ofile_s *sf;
+
+	for (sf = fs->fs_head; sf != NULL; sf = sf->fnext) {
+		if (sf->entry.firstsector == firstsector) {
+			memset(sf->rasector, 0xff, sizeof(sf->rasector));
+		}
+	}
+}
+#endif
+
 /****************************************************************************
  * Name: smartfs_sync_internal
  *
@@ -637,6 +848,9 @@ static int smartfs_sync_internal(struct smartfs_mountpt_s *fs, struct smartfs_of
 
 	if (sf->byteswritten > 0) {
 		fvdbg("Syncing sector %d\n", sf->currsector);
+#ifdef CONFIG_SMARTFS_READAHEAD
+		smartfs_readahead_invalidate(fs, sf->entry.firstsector);
+#endif
 
 		/* Read the existing sector used bytes value */
 
@@ -719,6 +933,10 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 #ifdef CONFIG_SMARTFS_JOURNALING
 	int retj;
 	uint16_t t_sector, t_offset;
+#endif
+#if defined(CONFIG_SMARTFS_READAHEAD) && !defined(CONFIG_SMARTFS_JOURNALING)
+	uint16_t datasize;
+	uint16_t nextsector;
 #endif
 	/* Sanity checks.  I have seen the following assertion misfire if
 	 * CONFIG_DEBUG_MM is enabled while re-directing output to a
@@ -755,6 +973,12 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 		ret = -EACCES;
 		goto errout_with_semaphore;
 	}
+#ifdef CONFIG_SMARTFS_READAHEAD
+
+	/* The sectors read ahead by the opens of this file become stale */
+
+	smartfs_readahead_invalidate(fs, sf->entry.firstsector);
+#endif
 
 	/* First test if we are overwriting an existing location or writing to
 	 * a new one. */
@@ -821,9 +1045,12 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 			byteswritten += readwrite.count;
 		}
 
-		/* Test if we wrote to the end of the current sector */
+		/* Test if we wrote to the end of the current sector.  If that is
+		 * also the end of the file, there is no next sector and the data
+		 * appended below allocates it.
+		 */
 
-		if (sf->curroffset == fs->fs_llformat.availbytes) {
+		if (sf->curroffset == fs->fs_llformat.availbytes && sf->filepos < sf->entry.datlen) {
 			/* Wrote to the end of the sector.  Update to point to the
 			 * next sector for additional writes.  First read the sector
 			 * header to get the sector chain info.
@@ -842,6 +1069,9 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 
 			sf->curroffset = sizeof(struct smartfs_chain_header_s);
 			sf->currsector = SMARTFS_NEXTSECTOR(header);
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+			smartfs_seekindex_add(sf, sf->filepos / (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s)), sf->currsector);
+#endif
 		}
 	}
 
@@ -862,6 +1092,61 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 		sf->bflags |= SMARTFS_BFLAG_DIRTY;
 
 #else							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
+#if defined(CONFIG_SMARTFS_READAHEAD) && !defined(CONFIG_SMARTFS_JOURNALING)
+		/* A whole sector of data is written together with its chain header
+		 * at once, instead of writing the data, the used bytes and the next
+		 * sector separately.
+		 */
+
+		datasize = fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s);
+		if (sf->curroffset == sizeof(struct smartfs_chain_header_s) && sf->byteswritten == 0 && buflen >= datasize) {
+			nextsector = SMARTFS_ERASEDSTATE_16BIT;
+			if (buflen > datasize) {
+				ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xFFFF);
+				if (ret < 0) {
+					fdbg("Error %d allocating new sector\n", ret);
+					goto errout_with_semaphore;
+				}
+
+				nextsector = (uint16_t)ret;
+			}
+
+			header = (struct smartfs_chain_header_s *)fs->fs_rwbuffer;
+			header->nextsector[0] = (uint8_t)(nextsector & 0x00FF);
+			header->nextsector[1] = (uint8_t)(nextsector >> 8);
+			header->used[0] = (uint8_t)(datasize & 0x00FF);
+			header->used[1] = (uint8_t)(datasize >> 8);
+			memcpy(&fs->fs_rwbuffer[sizeof(struct smartfs_chain_header_s)], &buffer[byteswritten], datasize);
+
+			readwrite.logsector = sf->currsector;
+			readwrite.offset = offsetof(struct smartfs_chain_header_s, nextsector);
+			readwrite.buffer = (uint8_t *)&fs->fs_rwbuffer[readwrite.offset];
+			readwrite.count = fs->fs_llformat.availbytes - readwrite.offset;
+			ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long)&readwrite);
+			if (ret < 0) {
+				fdbg("Error %d writing sector %d data\n", ret, sf->currsector);
+				goto errout_with_semaphore;
+			}
+
+			sf->entry.datlen += datasize;
+			sf->filepos += datasize;
+			buflen -= datasize;
+			byteswritten += datasize;
+
+			if (nextsector != SMARTFS_ERASEDSTATE_16BIT) {
+				sf->currsector = nextsector;
+				sf->curroffset = sizeof(struct smartfs_chain_header_s);
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+				smartfs_seekindex_add(sf, sf->filepos / datasize, sf->currsector);
+#endif
+			} else {
+				sf->curroffset = fs->fs_llformat.availbytes;
+			}
+
+			continue;
+		}
+
+#endif
 		readwrite.offset = sf->curroffset;
 		readwrite.logsector = sf->currsector;
 		readwrite.buffer = (uint8_t *)&buffer[byteswritten];
@@ -939,6 +1224,9 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 			sf->curroffset = sizeof(struct smartfs_chain_header_s);
 			memset(sf->buffer, CONFIG_SMARTFS_ERASEDSTATE, fs->fs_llformat.availbytes);
 			header->type = SMARTFS_DIRENT_TYPE_FILE;
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+			smartfs_seekindex_add(sf, sf->filepos / (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s)), sf->currsector);
+#endif
 		}
 #else							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
 
@@ -1004,6 +1292,9 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 
 				sf->currsector = SMARTFS_NEXTSECTOR(header);
 				sf->curroffset = sizeof(struct smartfs_chain_header_s);
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+				smartfs_seekindex_add(sf, sf->filepos / (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s)), sf->currsector);
+#endif
 			}
 		}
 #endif							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
@@ -1016,6 +1307,47 @@ errout_with_semaphore:
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smartfs_seekindex_add
+ *
+ * Description: Records the logical sector of the sector number 'sectorno'
+ *              of the file in its seek index if it is the next one to be
+ *              indexed.  The index is left as it is if no memory is left,
+ *              seeks then walk the chain from the last indexed sector.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+static void smartfs_seekindex_add(struct smartfs_ofile_s *sf, uint32_t sectorno, uint16_t sector)
+{
+	uint16_t *sindex;
+
+	/* Only the entry following the last one is added so that the index
+	 * never has holes.
+	 */
+
+	if (sector == SMARTFS_ERASEDSTATE_16BIT || sectorno != (uint32_t)(sf->nindex + 1) * CONFIG_SMARTFS_SEEK_INDEX_INTERVAL) {
+		return;
+	}
+
+	if (sf->nindex == sf->sindexsize) {
+		if (sf->sindexsize > UINT16_MAX - SMARTFS_SEEK_INDEX_GROW) {
+			return;
+		}
+
+		sindex = (uint16_t *)kmm_realloc(sf->sindex, (sf->sindexsize + SMARTFS_SEEK_INDEX_GROW) * sizeof(uint16_t));
+		if (sindex == NULL) {
+			return;
+		}
+
+		sf->sindex = sindex;
+		sf->sindexsize += SMARTFS_SEEK_INDEX_GROW;
+	}
+
+	sf->sindex[sf->nindex++] = sector;
+}
+#endif
+
 /****************************************************************************
  * Name: smartfs_seek_internal
  *
@@ -1033,6 +1365,11 @@ static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_
 	int ret;
 	off_t newpos;
 	off_t sectorstartpos;
+	uint16_t datasize;
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	uint32_t sectorno;
+	uint16_t entry;
+#endif
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
 	int sector_used = 0;
 #endif
@@ -1078,11 +1415,13 @@ static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_
 	}
 
 	/* Now perform the seek.  Test if we are seeking within the current
-	 * sector and can skip the search to save time.
+	 * sector and can skip the search to save time.  A read up to the end
+	 * of the file leaves no current sector.
 	 */
 
+	datasize = fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s);
 	sectorstartpos = sf->filepos - (sf->curroffset - sizeof(struct smartfs_chain_header_s));
-	if (newpos >= sectorstartpos && newpos < sectorstartpos + fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s)) {
+	if (sf->currsector != SMARTFS_ERASEDSTATE_16BIT && newpos >= sectorstartpos && newpos < sectorstartpos + datasize) {
 		/* Seeking within the current sector.  Just update the offset */
 
 		sf->curroffset = sizeof(struct smartfs_chain_header_s) + newpos - sectorstartpos;
@@ -1096,15 +1435,40 @@ static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_
 	 * sector, otherwise we have to start from the beginning of the file.
 	 */
 
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	/* Every sector but the last one of the chain is full, so the sector
+	 * holding newpos is known.  Start from the last indexed sector before
+	 * it, or from the current sector if that one is nearer.
+	 */
+
+	sectorno = (newpos > 0) ? (newpos - 1) / datasize : 0;
+	entry = sectorno / CONFIG_SMARTFS_SEEK_INDEX_INTERVAL;
+	if (entry > sf->nindex) {
+		entry = sf->nindex;
+	}
+
+	sectorno = (uint32_t)entry * CONFIG_SMARTFS_SEEK_INDEX_INTERVAL;
+	if (newpos > sf->filepos && sectorstartpos >= (off_t)sectorno * datasize) {
+		sf->filepos = sectorstartpos;
+		sectorno = sectorstartpos / datasize;
+	} else {
+		sf->currsector = (entry > 0) ? sf->sindex[entry - 1] : sf->entry.firstsector;
+		sf->filepos = sectorno * datasize;
+	}
+#else
 	if (newpos > sf->filepos) {
 		sf->filepos = sectorstartpos;
 	} else {
 		sf->currsector = sf->entry.firstsector;
 		sf->filepos = 0;
 	}
+#endif
+#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
+	sector_used = sf->filepos / datasize;
+#endif
 
 	header = (struct smartfs_chain_header_s *)fs->fs_rwbuffer;
-	while ((sf->currsector != SMARTFS_ERASEDSTATE_16BIT) && (sf->filepos + fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s) < newpos)) {
+	while ((sf->currsector != SMARTFS_ERASEDSTATE_16BIT) && (sf->filepos + datasize < newpos)) {
 		/* Read the sector's header */
 
 		readwrite.logsector = sf->currsector;
@@ -1118,15 +1482,18 @@ static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_
 		}
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
 		if (SMARTFS_NEXTSECTOR(header) == SMARTFS_ERASEDSTATE_16BIT) {
-			sf->filepos += (sf->entry.datlen - (sector_used * (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s))));
+			sf->filepos += (sf->entry.datlen - (sector_used * datasize));
 		} else {
-			sf->filepos += (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s));
+			sf->filepos += datasize;
 		}
 		sector_used++;
 #else
 		sf->filepos += SMARTFS_USED(header);
 #endif
 		sf->currsector = SMARTFS_NEXTSECTOR(header);
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+		smartfs_seekindex_add(sf, ++sectorno, sf->currsector);
+#endif
 	}
 
 #ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
@@ -2067,6 +2434,9 @@ int smartfs_rename(struct inode *mountpt, const char *oldrelpath, const char *ne
 #endif
 		tmp_pntr[0] = (uint8_t)(tmp_flag & 0x00FF);
 		tmp_pntr[1] = (uint8_t)((tmp_flag >> 8) & 0x00FF);
+#ifdef CONFIG_SMARTFS_DIRCACHE
+		smartfs_dircache_remove(fs, oldentry.dfirst, oldfilename);
+#endif
 
 		/* Now write the updated flags back to the device */
 
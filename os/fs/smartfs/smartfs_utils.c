@@ -599,6 +599,17 @@ int smartfs_mount(struct smartfs_mountpt_s *fs, bool writeable)
 	fs->fs_workbuffer = (char *)kmm_malloc(256);
 	fs->fs_rootsector = SMARTFS_ROOT_DIR_SECTOR;
 
+#ifdef CONFIG_SMARTFS_DIRCACHE
+	/* Allocate the directory entry cache.  Lookups just search the
+	 * directories if there is no memory for it.
+	 */
+
+	fs->fs_dircache = (struct smartfs_dircache_s *)kmm_malloc(CONFIG_SMARTFS_DIRCACHE_ENTRIES * sizeof(struct smartfs_dircache_s));
+	if (fs->fs_dircache != NULL) {
+		memset(fs->fs_dircache, 0xff, CONFIG_SMARTFS_DIRCACHE_ENTRIES * sizeof(struct smartfs_dircache_s));
+	}
+#endif
+
 	/* We did it! */
 
 	fs->fs_mounted = TRUE;
@@ -742,9 +753,129 @@ int smartfs_unmount(struct smartfs_mountpt_s *fs)
 	kmm_free(fs->fs_workbuffer);
 #endif
 
+#ifdef CONFIG_SMARTFS_DIRCACHE
+	if (fs->fs_dircache != NULL) {
+		kmm_free(fs->fs_dircache);
+		fs->fs_dircache = NULL;
+	}
+#endif
+
 	return ret;
 }
 
+#ifdef CONFIG_SMARTFS_DIRCACHE
+/****************************************************************************
+ * Name: smartfs_dircache_hash
+ *
+ * Description: Returns the hash of an entry name, of which at most namesize
+ *              characters are significant.
+ *
+ ****************************************************************************/
+
+static uint16_t smartfs_dircache_hash(struct smartfs_mountpt_s *fs, const char *name)
+{
+	uint32_t hash = 2166136261u;
+	uint16_t x;
+
+	for (x = 0; x < fs->fs_llformat.namesize && name[x] != '\0'; x++) {
+		hash = (hash ^ (uint8_t)name[x]) * 16777619u;
+	}
+
+	return (uint16_t)(hash ^ (hash >> 16));
+}
+
+/****************************************************************************
+ * Name: smartfs_dircache_slot
+ *
+ * Description: Returns the cache entry for a name hash in a directory.
+ *
+ ****************************************************************************/
+
+static struct smartfs_dircache_s *smartfs_dircache_slot(struct smartfs_mountpt_s *fs, uint16_t dir, uint16_t hash)
+{
+	return &fs->fs_dircache[((uint32_t)hash + dir * 31u) % CONFIG_SMARTFS_DIRCACHE_ENTRIES];
+}
+
+/****************************************************************************
+ * Name: smartfs_dircache_find
+ *
+ * Description: Returns the sector of the directory starting at sector 'dir'
+ *              which may hold the entry 'name', or 0xFFFF if the cache does
+ *              not know it.  The caller must still check the entry is
+ *              there, as different names may have the same hash.
+ *
+ ****************************************************************************/
+
+uint16_t smartfs_dircache_find(struct smartfs_mountpt_s *fs, uint16_t dir, const char *name)
+{
+	struct smartfs_dircache_s *slot;
+	uint16_t hash;
+
+	if (fs->fs_dircache == NULL) {
+		return 0xFFFF;
+	}
+
+	hash = smartfs_dircache_hash(fs, name);
+	slot = smartfs_dircache_slot(fs, dir, hash);
+	if (slot->dir != dir || slot->hash != hash) {
+		return 0xFFFF;
+	}
+
+	return slot->sector;
+}
+
+/****************************************************************************
+ * Name: smartfs_dircache_add
+ *
+ * Description: Records that the entry 'name' of the directory starting at
+ *              sector 'dir' is in the directory sector 'sector', replacing
+ *              the entry previously cached in the same slot.
+ *
+ ****************************************************************************/
+
+void smartfs_dircache_add(struct smartfs_mountpt_s *fs, uint16_t dir, const char *name, uint16_t sector)
+{
+	struct smartfs_dircache_s *slot;
+	uint16_t hash;
+
+	if (fs->fs_dircache == NULL) {
+		return;
+	}
+
+	hash = smartfs_dircache_hash(fs, name);
+	slot = smartfs_dircache_slot(fs, dir, hash);
+	slot->dir = dir;
+	slot->hash = hash;
+	slot->sector = sector;
+}
+
+/****************************************************************************
+ * Name: smartfs_dircache_remove
+ *
+ * Description: Forgets the entry 'name' of the directory starting at sector
+ *              'dir'.  This must be done before its directory sector can be
+ *              released, so that a lookup never searches a sector reused by
+ *              another directory.
+ *
+ ****************************************************************************/
+
+void smartfs_dircache_remove(struct smartfs_mountpt_s *fs, uint16_t dir, const char *name)
+{
+	struct smartfs_dircache_s *slot;
+	uint16_t hash;
+
+	if (fs->fs_dircache == NULL) {
+		return;
+	}
+
+	hash = smartfs_dircache_hash(fs, name);
+	slot = smartfs_dircache_slot(fs, dir, hash);
+	if (slot->dir == dir && slot->hash == hash) {
+		memset(slot, 0xff, sizeof(struct smartfs_dircache_s));
+	}
+}
+#endif
+
 /****************************************************************************
  * Name: smartfs_finddirentry
  *
@@ -778,6 +909,9 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
 	int used_value;
 #endif
+#ifdef CONFIG_SMARTFS_DIRCACHE
+	uint16_t cachedsector;
+#endif
 
 	/* Initialize directory level zero as the root sector */
 
@@ -849,6 +983,17 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 			/* Search for the entry in the current directory */
 
 			dirsector = dirstack[depth];
+#ifdef CONFIG_SMARTFS_DIRCACHE
+
+			/* If the cache knows the sector holding the entry, search that
+			 * sector alone first.
+			 */
+
+			cachedsector = smartfs_dircache_find(fs, dirsector, fs->fs_workbuffer);
+			if (cachedsector != 0xFFFF) {
+				dirsector = cachedsector;
+			}
+#endif
 
 			/* Read the directory */
 
@@ -893,6 +1038,14 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 						continue;
 					}
 
+#ifdef CONFIG_SMARTFS_DIRCACHE
+					/* Cache the entries met while searching the directory */
+
+					if (cachedsector == 0xFFFF) {
+						smartfs_dircache_add(fs, dirstack[depth], entry->name, readwrite.logsector);
+					}
+#endif
+
 					/* Test if the name matches */
 
 					if (strncmp(entry->name, fs->fs_workbuffer, fs->fs_llformat.namesize) == 0) {
@@ -1031,6 +1184,17 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 				if (offset < readwrite.count) {
 					break;
 				}
+#ifdef CONFIG_SMARTFS_DIRCACHE
+
+				/* The cached sector does not hold the entry anymore.  Search
+				 * the whole directory.
+				 */
+
+				if (cachedsector != 0xFFFF) {
+					cachedsector = 0xFFFF;
+					dirsector = dirstack[depth];
+				}
+#endif
 			}
 
 			/* If we found a dir entry, then continue searching */
@@ -1300,6 +1464,9 @@ int smartfs_createentry(struct smartfs_mountpt_s *fs, uint16_t parentdirsector,
 
 	memset(direntry->name, 0, fs->fs_llformat.namesize + 1);
 	strncpy(direntry->name, filename, fs->fs_llformat.namesize);
+#ifdef CONFIG_SMARTFS_DIRCACHE
+	smartfs_dircache_add(fs, parentdirsector, filename, psector);
+#endif
 
 	ret = OK;
 
@@ -1397,6 +1564,9 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *en
 	direntry->flags |= SMARTFS_DIRENT_ACTIVE;
 #endif
 #endif							/* CONFIG_SMARTFS_ERASEDSTATE == 0xFF */
+#ifdef CONFIG_SMARTFS_DIRCACHE
+	smartfs_dircache_remove(fs, entry->dfirst, direntry->name);
+#endif
 
 	/* Write the updated flags back to the sector */
 
@@ -2528,6 +2698,16 @@ static int smartfs_redo_rename(struct smartfs_mountpt_s *fs)
 	oldflags |= SMARTFS_DIRENT_ACTIVE;
 #endif
 	direntry->flags = oldflags;
+#ifdef CONFIG_SMARTFS_DIRCACHE
+
+	/* The directory of the old entry is not known here, forget all the
+	 * cached entries.
+	 */
+
+	if (fs->fs_dircache != NULL) {
+		memset(fs->fs_dircache, 0xff, CONFIG_SMARTFS_DIRCACHE_ENTRIES * sizeof(struct smartfs_dircache_s));
+	}
+#endif
 
 	req.offset = oldoffset + offsetof(struct smartfs_entry_header_s, flags);
 	req.count = sizeof(direntry->flags);
@@ -43,15 +43,26 @@ struct sys_mbox {
 	u8_t is_valid;
 	u8_t id;
 	u32_t queue_size;
-	u32_t wait_send;
-	u32_t wait_fetch;
+	u32_t wait_send;			/* Posters waiting for space */
+	u32_t wait_fetch;			/* Fetchers waiting for mail */
 	u32_t front;
 	u32_t rear;
 	void *msgs[SYS_MBOX_MAXSIZE];
 	sys_sem_t mail;
-	sys_sem_t mutex;
+	sys_sem_t space;
 };
 
 typedef struct sys_mbox sys_mbox_t;
 
+u32_t sys_arch_mbox_tryfetch_batch(sys_mbox_t *mbox, void **msgs, u32_t max);
+
+#if LWIP_TCPIP_CORE_LOCKING
+// === CORE LOCK ===
+
+void sys_arch_core_lock(void);
+void sys_arch_core_unlock(void);
+u32_t sys_arch_core_release(void);
+void sys_arch_core_restore(u32_t depth);
+#endif
+
 #endif							/* __ARCH_SYS_ARCH_H__ */
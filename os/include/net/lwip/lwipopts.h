@@ -243,6 +243,20 @@
 #define LWIP_TCP_KEEPALIVE              CONFIG_NET_TCP_KEEPALIVE
 #endif
 
+#ifdef CONFIG_NET_TCP_PCB_HASH_SIZE
+#define TCP_PCB_HASH_SIZE	CONFIG_NET_TCP_PCB_HASH_SIZE
+#endif
+
+#ifdef CONFIG_NET_TCP_WND_SCALE
+#define LWIP_WND_SCALE	1
+#define TCP_RCV_SCALE	CONFIG_NET_TCP_RCV_SCALE
+#endif
+
+#ifdef CONFIG_NET_TCP_SACK
+#define LWIP_TCP_SACK	1
+#define LWIP_TCP_MAX_SACK_NUM	CONFIG_NET_TCP_MAX_SACK_NUM
+#endif
+
 #ifdef CONFIG_NET_TCP_WND_UPDATE_THREASHOLD
 #define TCP_WND_UPDATE_THREASHOLD	CONFIG_NET_TCP_WND_UPDATE_THREASHOLD
 #endif
@@ -269,6 +283,10 @@
 #define LWIP_NETBUF_RECVINFO	CONFIG_NET_NETBUF_RECVINFO
 #endif
 
+#ifdef CONFIG_NET_UDP_PCB_HASH_SIZE
+#define UDP_PCB_HASH_SIZE	CONFIG_NET_UDP_PCB_HASH_SIZE
+#endif
+
 /* ---------- UDP options ---------- */
 
 
@@ -586,11 +604,11 @@
 #define LWIP_RAND() rand()
 
 #ifdef CONFIG_NET_TCPIP_CORE_LOCKING
-#define TCPIP_CORE_LOCKING	CONFIG_NET_TCPIP_CORE_LOCKING
+#define LWIP_TCPIP_CORE_LOCKING	CONFIG_NET_TCPIP_CORE_LOCKING
 #endif
 
 #ifdef CONFIG_NET_TCPIP_CORE_LOCKING_INPUT
-#define TCPIP_CORE_LOCKING_INPUT	CONFIG_NET_TCPIP_CORE_LOCKING_INPUT
+#define LWIP_TCPIP_CORE_LOCKING_INPUT	CONFIG_NET_TCPIP_CORE_LOCKING_INPUT
 #endif
 
 #ifdef CONFIG_NET_TCPIP_THREAD_NAME
@@ -648,6 +666,10 @@
 #define TCPIP_MBOX_SIZE	CONFIG_NET_TCPIP_MBOX_SIZE
 #endif
 
+#ifdef CONFIG_NET_TCPIP_MBOX_BATCH
+#define TCPIP_MBOX_BATCH	CONFIG_NET_TCPIP_MBOX_BATCH
+#endif
+
 /* ---------- Mailbox options ---------- */
 
 
@@ -316,6 +316,13 @@ struct netif {
 	int (*d_ifstate)(FAR struct netif *dev);
 	int (*d_txavail)(FAR struct netif *dev);
 	int (*d_txpoll)(FAR struct netif *dev);
+#ifdef CONFIG_NET_ZEROCOPY
+	/* Scatter-gather transmit of a pbuf chain, used instead of d_buf and
+	 * d_txavail when set.  The chain is only valid until the call returns
+	 * unless the driver takes a reference with pbuf_ref().
+	 */
+	int (*d_txpbuf)(FAR struct netif *dev, FAR struct pbuf *p);
+#endif
 	/* Drivers may attached device-specific, private information */
 	void *d_private;
 #ifdef CONFIG_NET_MULTIBUFFER
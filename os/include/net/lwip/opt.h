@@ -853,6 +853,14 @@
 #define UDP_TTL                         (IP_DEFAULT_TTL)
 #endif
 
+/**
+ * UDP_PCB_HASH_SIZE: Number of buckets of the hash table of UDP PCBs,
+ * by local port, searched by udp_input(). Must be a power of 2.
+ */
+#ifndef UDP_PCB_HASH_SIZE
+#define UDP_PCB_HASH_SIZE               16
+#endif
+
 /**
  * LWIP_NETBUF_RECVINFO==1: append destination addr and port to every netbuf.
  */
@@ -998,6 +1006,15 @@
 #define TCP_DEFAULT_LISTEN_BACKLOG      0xff
 #endif
 
+/**
+ * TCP_PCB_HASH_SIZE: Number of buckets of the hash tables of the active,
+ * TIME-WAIT and listening TCP PCBs, searched by tcp_input(). Must be a
+ * power of 2.
+ */
+#ifndef TCP_PCB_HASH_SIZE
+#define TCP_PCB_HASH_SIZE               16
+#endif
+
 /**
  * TCP_OVERSIZE: The maximum number of bytes that tcp_write may
  * allocate ahead of time in an attempt to create shorter pbuf chains
@@ -1023,6 +1040,39 @@
 #define LWIP_TCP_TIMESTAMPS             0
 #endif
 
+/**
+ * LWIP_WND_SCALE and TCP_RCV_SCALE:
+ * Set LWIP_WND_SCALE to 1 to enable window scaling (RFC 7323), so that
+ * TCP_WND may be larger than 0xffff. TCP_RCV_SCALE is the scale factor
+ * announced for our receive window (0..14). TCP_WND must not exceed
+ * (0xffff << TCP_RCV_SCALE) and (TCP_WND >> TCP_RCV_SCALE) must not be 0.
+ */
+#ifndef LWIP_WND_SCALE
+#define LWIP_WND_SCALE                  0
+#endif
+#ifndef TCP_RCV_SCALE
+#define TCP_RCV_SCALE                   0
+#endif
+
+/**
+ * LWIP_TCP_SACK==1: support selective acknowledgements (RFC 2018).
+ * Out-of-order data queued on ooseq is reported to the peer in SACK
+ * blocks, and the holes reported by the peer are retransmitted during
+ * fast recovery without waiting for the retransmission timeout.
+ * Needs TCP_QUEUE_OOSEQ to report anything.
+ */
+#ifndef LWIP_TCP_SACK
+#define LWIP_TCP_SACK                   0
+#endif
+
+/**
+ * LWIP_TCP_MAX_SACK_NUM: The maximum number of SACK blocks sent in one
+ * ACK (1..4). Only 3 blocks fit when the timestamp option is used.
+ */
+#ifndef LWIP_TCP_MAX_SACK_NUM
+#define LWIP_TCP_MAX_SACK_NUM           4
+#endif
+
 /**
  * TCP_WND_UPDATE_THRESHOLD: difference in window to trigger an
  * explicit window update
@@ -1230,6 +1280,15 @@
 #define TCPIP_MBOX_SIZE                 0
 #endif
 
+/**
+ * TCPIP_MBOX_BATCH: The number of messages the tcpip thread takes from its
+ * mailbox at once, after waking up for one message. 1 takes one message per
+ * wakeup. Needs sys_arch_mbox_tryfetch_batch() from the port.
+ */
+#ifndef TCPIP_MBOX_BATCH
+#define TCPIP_MBOX_BATCH                1
+#endif
+
 /**
  * SLIPIF_THREAD_NAME: The name assigned to the slipif_loop thread.
  */
@@ -135,6 +135,9 @@ struct pbuf_custom {
 	struct pbuf pbuf;
 	/** This function is called when pbuf_free deallocates this pbuf(_custom) */
 	pbuf_free_custom_fn custom_free_function;
+	/** Start of the buffer holding the payload, pbuf_header() can move the
+	    payload back up to it to show headers hidden before */
+	void *payload_mem;
 };
 #endif							/* LWIP_SUPPORT_CUSTOM_PBUF */
 
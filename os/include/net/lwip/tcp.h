@@ -165,11 +165,26 @@ enum tcp_state {
 #define DEF_ACCEPT_CALLBACK
 #endif							/* LWIP_CALLBACK_API */
 
+#if LWIP_WND_SCALE
+typedef u32_t tcpwnd_size_t;
+#define TCPWNDSIZE_F U32_F
+#else
+typedef u16_t tcpwnd_size_t;
+#define TCPWNDSIZE_F U16_F
+#endif
+
+#if LWIP_WND_SCALE || LWIP_TCP_SACK
+typedef u16_t tcpflags_t;
+#else
+typedef u8_t tcpflags_t;
+#endif
+
 /**
  * members common to struct tcp_pcb and struct tcp_listen_pcb
  */
 #define TCP_PCB_COMMON(type) \
 	type *next; /* for the linked list */ \
+	type *hash_next; /* for the hash table of the list */ \
 	void *callback_arg; \
 	/* the accept callback for listen- and normal pcbs, if LWIP_CALLBACK_API */ \
 	DEF_ACCEPT_CALLBACK \
@@ -188,7 +203,7 @@ struct tcp_pcb {
 	/* ports are in host byte order */
 	u16_t remote_port;
 
-	u8_t flags;
+	tcpflags_t flags;
 #define TF_ACK_DELAY   ((u8_t)0x01U)	/* Delayed ACK. */
 #define TF_ACK_NOW     ((u8_t)0x02U)	/* Immediate ACK. */
 #define TF_INFR        ((u8_t)0x04U)	/* In fast recovery. */
@@ -197,6 +212,12 @@ struct tcp_pcb {
 #define TF_FIN         ((u8_t)0x20U)	/* Connection was closed locally (FIN segment enqueued). */
 #define TF_NODELAY     ((u8_t)0x40U)	/* Disable Nagle algorithm */
 #define TF_NAGLEMEMERR ((u8_t)0x80U)	/* nagle enabled, memerr, try to output to prevent delayed ACK to happen */
+#if LWIP_WND_SCALE
+#define TF_WND_SCALE   ((tcpflags_t)0x0100U)	/* Window Scale option enabled */
+#endif
+#if LWIP_TCP_SACK
+#define TF_SACK        ((tcpflags_t)0x0200U)	/* Selective ACK option enabled */
+#endif
 
 	/* the rest of the fields are in host byte order
 	   as we have to do some math with them */
@@ -208,9 +229,12 @@ struct tcp_pcb {
 
 	/* receiver variables */
 	u32_t rcv_nxt;			/* next seqno expected */
-	u16_t rcv_wnd;			/* receiver window available */
-	u16_t rcv_ann_wnd;		/* receiver window to announce */
+	tcpwnd_size_t rcv_wnd;	/* receiver window available */
+	tcpwnd_size_t rcv_ann_wnd;	/* receiver window to announce */
 	u32_t rcv_ann_right_edge;	/* announced right edge of window */
+#if LWIP_TCP_SACK
+	u32_t rcv_sack_seqno;	/* seqno of the latest out-of-order segment, reported first */
+#endif							/* LWIP_TCP_SACK */
 
 	/* Retransmission timer. */
 	s16_t rtime;
@@ -228,18 +252,22 @@ struct tcp_pcb {
 	/* fast retransmit/recovery */
 	u8_t dupacks;
 	u32_t lastack;			/* Highest acknowledged seqno. */
+#if LWIP_TCP_SACK
+	u32_t recover;			/* snd_nxt when fast recovery was entered */
+	u32_t high_rxt;			/* end of the last hole retransmitted in fast recovery */
+#endif							/* LWIP_TCP_SACK */
 
 	/* congestion avoidance/control variables */
-	u16_t cwnd;
-	u16_t ssthresh;
+	tcpwnd_size_t cwnd;
+	tcpwnd_size_t ssthresh;
 
 	/* sender variables */
 	u32_t snd_nxt;			/* next new seqno to be sent */
 	u32_t snd_wl1, snd_wl2;	/* Sequence and acknowledgement numbers of last
 								   window update. */
 	u32_t snd_lbb;			/* Sequence number of next byte to be buffered. */
-	u16_t snd_wnd;			/* sender window */
-	u16_t snd_wnd_max;		/* the maximum sender window announced by the remote host */
+	tcpwnd_size_t snd_wnd;	/* sender window */
+	tcpwnd_size_t snd_wnd_max;	/* the maximum sender window announced by the remote host */
 
 	u16_t acked;
 
@@ -294,6 +322,11 @@ struct tcp_pcb {
 
 	/* KEEPALIVE counter */
 	u8_t keep_cnt_sent;
+
+#if LWIP_WND_SCALE
+	u8_t snd_scale;			/* shift count of the windows announced by the remote host */
+	u8_t rcv_scale;			/* shift count of the windows we announce */
+#endif							/* LWIP_WND_SCALE */
 };
 
 struct tcp_pcb_listen {
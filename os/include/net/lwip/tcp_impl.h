@@ -85,6 +85,9 @@ err_t tcp_send_empty_ack(struct tcp_pcb *pcb);
 void tcp_rexmit(struct tcp_pcb *pcb);
 void tcp_rexmit_rto(struct tcp_pcb *pcb);
 void tcp_rexmit_fast(struct tcp_pcb *pcb);
+#if LWIP_TCP_SACK
+void tcp_rexmit_sack(struct tcp_pcb *pcb);
+#endif
 u32_t tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb);
 err_t tcp_process_refused_data(struct tcp_pcb *pcb);
 
@@ -296,16 +299,39 @@ struct tcp_seg {
 #define TF_SEG_OPTS_TS          (u8_t)0x02U	/* Include timestamp option. */
 #define TF_SEG_DATA_CHECKSUMMED (u8_t)0x04U	/* ALL data (not the header) is
 											   checksummed into 'chksum' */
+#define TF_SEG_OPTS_WND_SCALE   (u8_t)0x08U	/* Include window scaling option. */
+#define TF_SEG_OPTS_SACK_PERM   (u8_t)0x10U	/* Include SACK permitted option. */
+#define TF_SEG_SACKED           (u8_t)0x20U	/* Reported received by a SACK
+											   block of the remote host */
 	struct tcp_hdr *tcphdr;	/* the TCP header */
 };
 
 #define LWIP_TCP_OPT_LENGTH(flags)              \
 	(flags & TF_SEG_OPTS_MSS ? 4  : 0) +        \
-	(flags & TF_SEG_OPTS_TS  ? 12 : 0)
+	(flags & TF_SEG_OPTS_TS  ? 12 : 0) +        \
+	(flags & TF_SEG_OPTS_WND_SCALE ? 4 : 0) +   \
+	(flags & TF_SEG_OPTS_SACK_PERM ? 4 : 0)
 
 /** This returns a TCP header option for MSS in an u32_t */
 #define TCP_BUILD_MSS_OPTION(mss) htonl(0x02040000 | ((mss) & 0xFFFF))
 
+/** Length of a SACK option (padded with two NOPs) carrying n blocks */
+#define LWIP_TCP_SACK_OPT_LENGTH(n) ((n) > 0 ? 4 + 8 * (n) : 0)
+
+#if LWIP_WND_SCALE
+#define RCV_WND_SCALE(pcb, wnd) (((wnd) >> (pcb)->rcv_scale))
+#define SND_WND_SCALE(pcb, wnd) (((wnd) << (pcb)->snd_scale))
+#define TCPWND16(x)             ((u16_t)LWIP_MIN((x), 0xFFFF))
+#define TCP_WND_MAX(pcb)        ((tcpwnd_size_t)(((pcb)->flags & TF_WND_SCALE) ? TCP_WND : TCPWND16(TCP_WND)))
+#else
+#define RCV_WND_SCALE(pcb, wnd) (wnd)
+#define SND_WND_SCALE(pcb, wnd) (wnd)
+#define TCPWND16(x)             (x)
+#define TCP_WND_MAX(pcb)        TCP_WND
+#endif
+/** The receive window announced before window scaling is negotiated */
+#define TCPWND_MIN16(x)         ((u16_t)LWIP_MIN((x), 0xFFFF))
+
 /* Global variables: */
 extern struct tcp_pcb *tcp_input_pcb;
 extern u32_t tcp_ticks;
@@ -326,6 +352,21 @@ extern struct tcp_pcb
 
 extern struct tcp_pcb *tcp_tmp_pcb;	/* Only used for temporary storage. */
 
+/* Hash tables of the active, TIME-WAIT and listening PCBs, kept along with
+   the lists by TCP_REG and TCP_RMV so that tcp_input() does not walk the
+   lists. The connections are hashed on their remote address and port and
+   local port (see tcp_pcb_hash()), the listening PCBs on their local port.
+   The local address is left out, netif_set_ipaddr() may change it. */
+extern struct tcp_pcb *tcp_active_hash[TCP_PCB_HASH_SIZE];
+extern struct tcp_pcb *tcp_tw_hash[TCP_PCB_HASH_SIZE];
+extern struct tcp_pcb *tcp_listen_hash[TCP_PCB_HASH_SIZE];
+
+#define TCP_LISTEN_HASH(port) ((port) & (TCP_PCB_HASH_SIZE - 1))
+
+u16_t tcp_pcb_hash(ip_addr_t *remote_ip, u16_t remote_port, u16_t local_port);
+void tcp_pcb_hash_add(struct tcp_pcb **pcbs, struct tcp_pcb *pcb);
+void tcp_pcb_hash_remove(struct tcp_pcb **pcbs, struct tcp_pcb *pcb);
+
 /* Axioms about the above lists:
    1) Every TCP PCB that is not CLOSED is in one of the lists.
    2) A PCB is only in one of the lists.
@@ -350,6 +391,7 @@ extern struct tcp_pcb *tcp_tmp_pcb;	/* Only used for temporary storage. */
 		(npcb)->next = *(pcbs); \
 		LWIP_ASSERT("TCP_REG: npcb->next != npcb", (npcb)->next != (npcb)); \
 		*(pcbs) = (npcb); \
+		tcp_pcb_hash_add((pcbs), (npcb)); \
 		LWIP_ASSERT("TCP_RMV: tcp_pcbs sane", tcp_pcbs_sane()); \
 		tcp_timer_needed(); \
 	} while (0)
@@ -357,6 +399,7 @@ extern struct tcp_pcb *tcp_tmp_pcb;	/* Only used for temporary storage. */
 	do { \
 		LWIP_ASSERT("TCP_RMV: pcbs != NULL", *(pcbs) != NULL); \
 		LWIP_DEBUGF(TCP_DEBUG, ("TCP_RMV: removing %p from %p\n", (npcb), *(pcbs))); \
+		tcp_pcb_hash_remove((pcbs), (npcb)); \
 		if (*(pcbs) == (npcb)) { \
 			*(pcbs) = (*pcbs)->next; \
 		} else { \
@@ -378,11 +421,13 @@ extern struct tcp_pcb *tcp_tmp_pcb;	/* Only used for temporary storage. */
 	do {                                           \
 		(npcb)->next = *pcbs;                      \
 		*(pcbs) = (npcb);                          \
+		tcp_pcb_hash_add((pcbs), (npcb));          \
 		tcp_timer_needed();                        \
 	} while (0)
 
 #define TCP_RMV(pcbs, npcb)                            \
 	do {                                               \
+		tcp_pcb_hash_remove((pcbs), (npcb));           \
 		if (*(pcbs) == (npcb)) {                       \
 			(*(pcbs)) = (*pcbs)->next;                 \
 		} else {                                       \
@@ -72,10 +72,9 @@ extern "C" {
 #endif
 
 #if LWIP_TCPIP_CORE_LOCKING
-/** The global semaphore to lock the stack. */
-extern sys_mutex_t lock_tcpip_core;
-#define LOCK_TCPIP_CORE()     sys_mutex_lock(&lock_tcpip_core)
-#define UNLOCK_TCPIP_CORE()   sys_mutex_unlock(&lock_tcpip_core)
+/** The global lock of the stack, provided by sys_arch and shared with net_lock(). */
+#define LOCK_TCPIP_CORE()     sys_arch_core_lock()
+#define UNLOCK_TCPIP_CORE()   sys_arch_core_unlock()
 #define TCPIP_APIMSG(m)       tcpip_apimsg_lock(m)
 #define TCPIP_APIMSG_ACK(m)
 #define TCPIP_NETIFAPI(m)     tcpip_netifapi_lock(m)
@@ -108,6 +108,8 @@ struct udp_pcb {
 	/* Protocol specific PCB members */
 
 	struct udp_pcb *next;
+	/* for the hash table of the local ports */
+	struct udp_pcb *hash_next;
 
 	u8_t flags;
 	/** ports are in host byte order */
@@ -119,6 +119,12 @@ struct mallinfo {
 								 * chunks handed out by malloc. */
 	int fordblks;				/* This is the total size of memory occupied
 								 * by free (not in use) chunks.*/
+#ifdef CONFIG_MM_FASTBINS
+	int smblks;					/* Number of free chunks cached in the fast bins */
+	int fsmblks;				/* Space held by the chunks in the fast bins */
+	int fbhits;					/* Small requests served from a fast bin */
+	int fbmisses;				/* Small requests that found their bin empty */
+#endif
 };
 
 /* Structure type returned by the div() function. */
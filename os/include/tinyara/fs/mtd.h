@@ -79,6 +79,15 @@
 #define CONFIG_MTD_REGISTRATION   1
 #endif
 
+/* Number of buckets in the write latency histogram.  Bucket n counts the
+ * writes which took less than 2^n milliseconds, the last bucket counts all
+ * of the longer ones.
+ */
+
+#ifdef CONFIG_MTD_WRITE_LATENCY
+#define MTD_WRITE_LATENCY_BUCKETS 12
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -159,6 +168,11 @@ struct mtd_dev_s {
 	/* Name of this MTD device */
 
 	FAR const char *name;
+#ifdef CONFIG_MTD_WRITE_LATENCY
+	/* Histogram of the write latency, see mtd_write_latency() */
+
+	uint32_t wrlatency[MTD_WRITE_LATENCY_BUCKETS];
+#endif
 #endif
 };
 
@@ -347,6 +361,20 @@ FAR struct mtd_dev_s *progmem_initialize(void);
 int mtd_register(FAR struct mtd_dev_s *mtd, FAR const char *name);
 #endif
 
+/****************************************************************************
+ * Name: mtd_write_latency
+ *
+ * Description:
+ *   Adds the latency of one write to the histogram of an MTD device, which
+ *   is reported by the procfs file system.  Called by the drivers layered
+ *   on the MTD device, with the time the caller of the write waited.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_WRITE_LATENCY
+void mtd_write_latency(FAR struct mtd_dev_s *mtd, uint32_t msec);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -111,6 +111,11 @@ struct mtd_smart_procfs_data_s {
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 	uint32_t uneven_wearcount;	/* Number of uneven block erases */
 #endif
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	uint16_t mappages;			/* Number of pages of the sector map */
+	uint16_t mapslots;			/* Number of map pages kept in RAM */
+	uint32_t mapmisses;			/* Number of map pages rebuilt from flash */
+#endif
 };
 
 /* The following defines debug command data passed from the procfs layer to
@@ -62,6 +62,8 @@
 #include <stdbool.h>
 #include <semaphore.h>
 
+#include <tinyara/mm/trace.h>
+
 /****************************************************************************
  * Pre-Processor Definitions
  ****************************************************************************/
@@ -176,6 +178,23 @@
 #define MM_MAX_CHUNK     (1 << MM_MAX_SHIFT)
 #define MM_NNODES        (MM_MAX_SHIFT - MM_MIN_SHIFT + 1)
 
+/* With the TLSF allocator, free chunks are kept in MM_TLSF_FLCOUNT first-
+ * level classes (powers of two) that are each split into MM_TLSF_SLCOUNT
+ * second-level lists.  Chunks smaller than 1 << MM_TLSF_FLSHIFT all fall in
+ * first-level class 0, where each list holds a single chunk size.  The last
+ * first-level class holds the chunks of MM_MAX_CHUNK bytes or more.
+ */
+
+#ifdef CONFIG_MM_TLSF
+#ifndef CONFIG_MM_TLSF_SLI
+#define CONFIG_MM_TLSF_SLI 4
+#endif
+
+#define MM_TLSF_SLCOUNT  (1 << CONFIG_MM_TLSF_SLI)
+#define MM_TLSF_FLSHIFT  (CONFIG_MM_TLSF_SLI + MM_MIN_SHIFT)
+#define MM_TLSF_FLCOUNT  (MM_MAX_SHIFT - MM_TLSF_FLSHIFT + 2)
+#endif
+
 #define MM_GRAN_MASK     (MM_MIN_CHUNK-1)
 #define MM_ALIGN_UP(a)   (((a) + MM_GRAN_MASK) & ~MM_GRAN_MASK)
 #define MM_ALIGN_DOWN(a) ((a) & ~MM_GRAN_MASK)
@@ -229,6 +248,9 @@ typedef size_t mmaddress_t;		/* 32 bit address space */
 	do { \
 		asm volatile ("mov %0,lr\n" : "=r" (retaddr));\
 	} while (0);
+#elif (CONFIG_ARCH_SIM)
+#define ARCH_GET_RET_ADDRESS \
+	mmaddress_t retaddr = (mmaddress_t)__builtin_return_address(0);
 
 #else
 #error Unknown CONFIG_ARCH option, malloc debug feature wont work.
@@ -301,6 +323,32 @@ struct mm_freenode_s {
 #define CHECK_FREENODE_SIZE \
 	DEBUGASSERT(sizeof(struct mm_freenode_s) == SIZEOF_MM_FREENODE)
 
+/* Fast bins.  Freed chunks of up to MM_FASTBIN_MAXCHUNK bytes (including
+ * the allocation header) are kept on a per-size singly linked list.  The
+ * link is stored in the first word of the user data, so a cached chunk keeps
+ * its allocated header and is never coalesced while it is in a bin.
+ */
+
+#ifdef CONFIG_MM_FASTBINS
+#ifndef CONFIG_MM_FASTBIN_MAXSIZE
+#define CONFIG_MM_FASTBIN_MAXSIZE 128
+#endif
+
+#ifndef CONFIG_MM_FASTBIN_DEPTH
+#define CONFIG_MM_FASTBIN_DEPTH 8
+#endif
+
+#define MM_FASTBIN_MAXCHUNK  MM_ALIGN_UP(CONFIG_MM_FASTBIN_MAXSIZE + SIZEOF_MM_ALLOCNODE)
+#define MM_NFASTBINS         (MM_FASTBIN_MAXCHUNK >> MM_MIN_SHIFT)
+#define MM_FASTBIN_NDX(s)    (((s) >> MM_MIN_SHIFT) - 1)
+#define MM_FASTBIN_LINK(n) \
+	(*(FAR struct mm_allocnode_s **)((FAR char *)(n) + SIZEOF_MM_ALLOCNODE))
+
+/* Owner recorded in the heapinfo header of a chunk that sits in a fast bin */
+
+#define HEAPINFO_FASTBIN -4
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s {
@@ -329,12 +377,44 @@ struct mm_heap_s {
 	int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_TLSF
+	/* Free nodes are kept in segregated, doubly linked lists.  A bit is set
+	 * in mm_flbitmap for each first-level class with a non-empty list, and
+	 * in mm_slbitmap[fl] for each non-empty second-level list of that class.
+	 */
+
+	uint32_t mm_flbitmap;
+	uint32_t mm_slbitmap[MM_TLSF_FLCOUNT];
+	FAR struct mm_freenode_s *mm_tlsf[MM_TLSF_FLCOUNT][MM_TLSF_SLCOUNT];
+#else
 	/* All free nodes are maintained in a doubly linked list.  This
 	 * array provides some hooks into the list at various points to
 	 * speed searches for free nodes.
 	 */
 
 	struct mm_freenode_s mm_nodelist[MM_NNODES];
+#endif
+
+#ifdef CONFIG_MM_FASTBINS
+	/* Recently freed small chunks, one LIFO list per chunk size, and the
+	 * number of small requests that did or did not find a cached chunk.
+	 */
+
+	FAR struct mm_allocnode_s *mm_fastbin[MM_NFASTBINS];
+	uint8_t mm_fastcount[MM_NFASTBINS];
+	size_t mm_fasthits;
+	size_t mm_fastmisses;
+#endif
+
+#ifdef CONFIG_MM_TRACE
+	/* Ring buffer of recorded heap calls, the slot for the next record and
+	 * the number of calls recorded.
+	 */
+
+	struct mm_trace_s mm_trace[CONFIG_MM_TRACE_ENTRIES];
+	uint16_t mm_tracenext;
+	uint32_t mm_tracecount;
+#endif
 };
 
 /****************************************************************************
@@ -444,6 +524,8 @@ FAR void *kmm_malloc(size_t size);
 
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
 
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+
 /* Functions contained in kmm_free.c ****************************************/
 
 #ifdef CONFIG_MM_KERNEL_HEAP
@@ -591,13 +673,37 @@ int kmm_mallinfo(struct mallinfo *info);
 
 void mm_shrinkchunk(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node, size_t size);
 
-/* Functions contained in mm_addfreechunk.c *********************************/
+/* Functions contained in mm_addfreechunk.c or mm_tlsf.c *******************/
 
 void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
 
+/* Functions contained in mm_delfreechunk.c or mm_tlsf.c *******************/
+
+void mm_delfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+
+/* Functions contained in mm_findfreechunk.c or mm_tlsf.c ******************/
+
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap, size_t size);
+
+/* Functions contained in mm_tlsf.c *****************************************/
+
+#ifdef CONFIG_MM_TLSF
+void mm_tlsf_initialize(FAR struct mm_heap_s *heap);
+#endif
+
+/* Functions contained in mm_fastbin.c **************************************/
+
+#ifdef CONFIG_MM_FASTBINS
+FAR struct mm_allocnode_s *mm_fastbin_remove(FAR struct mm_heap_s *heap, size_t size);
+bool mm_fastbin_insert(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node);
+int mm_fastbin_flush(FAR struct mm_heap_s *heap);
+#endif
+
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
+#ifndef CONFIG_MM_TLSF
 int mm_size2ndx(size_t size);
+#endif
 
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 /* Functions contained in kmm_mallinfo.c . Used to display memory allocation details */
@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * include/tinyara/mm/slab.h
+ *
+ * Object caches for fixed-size kernel objects.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_MM_SLAB_H
+#define __INCLUDE_MM_SLAB_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+/* CONFIG_MM_SLAB - Enable the object cache allocator
+ * CONFIG_MM_SLAB_SIZE - The size of one slab.  Slabs are carved from the
+ *   kernel heap aligned to their own size so that the slab owning an object
+ *   can be found by masking the object address.  Must be a power of two.
+ */
+
+#ifndef CONFIG_MM_SLAB_SIZE
+#define CONFIG_MM_SLAB_SIZE 1024
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Called on each object as it is handed out by slab_cache_alloc() */
+
+typedef CODE void (*slab_ctor_t)(FAR void *obj);
+
+/* One object cache.  The structure is public so that caches for kernel
+ * objects can be statically allocated and set up with
+ * slab_cache_initialize() before the heap is needed; the fields are private
+ * to the slab allocator.
+ */
+
+struct slab_cache_s {
+	FAR struct slab_cache_s *flink;	/* Link in the list of all caches */
+	FAR const char *name;		/* Name shown in /proc/slabinfo */
+	slab_ctor_t ctor;			/* Object constructor (may be NULL) */
+	uint16_t objsize;			/* Object size, rounded up to the alignment */
+	uint16_t offset;			/* Offset of the first object in a slab */
+	uint16_t perslab;			/* Number of objects in one slab */
+	bool dynamic;				/* Allocated by slab_cache_create() */
+	dq_queue_t partial;			/* Slabs with at least one free object */
+
+	/* Statistics */
+
+	size_t nslabs;				/* Number of slabs held by the cache */
+	size_t nfree;				/* Free objects in those slabs */
+	size_t inuse;				/* Objects handed out */
+	size_t peak;				/* High-water mark of inuse */
+	uint32_t nallocs;			/* Successful allocations */
+	uint32_t nfails;			/* Failed allocations */
+};
+
+/* A snapshot of the statistics of one cache, see slab_foreach() */
+
+struct slabinfo_s {
+	FAR const char *name;		/* Name of the cache */
+	size_t objsize;				/* Object size, including alignment padding */
+	size_t perslab;				/* Number of objects in one slab */
+	size_t nslabs;				/* Number of slabs held by the cache */
+	size_t inuse;				/* Objects handed out */
+	size_t peak;				/* High-water mark of inuse */
+	uint32_t nallocs;			/* Successful allocations */
+	uint32_t nfails;			/* Failed allocations */
+};
+
+typedef CODE void (*slab_handler_t)(FAR const struct slabinfo_s *info, FAR void *arg);
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: slab_cache_initialize
+ *
+ * Description:
+ *   Set up a caller-provided cache for objects of 'objsize' bytes aligned to
+ *   'align' bytes (0 selects pointer alignment).  No memory is allocated
+ *   until the first object is requested, so this may be called from early
+ *   OS initialization.
+ *
+ * Input Parameters:
+ *   cache   - The cache to set up
+ *   name    - A name for the cache.  The string is not copied.
+ *   objsize - The size of one object
+ *   align   - The required object alignment, a power of two or zero
+ *   ctor    - Called on each object by slab_cache_alloc(), or NULL
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -EINVAL if the alignment is not a power of two or
+ *   an object does not fit in a slab.
+ *
+ ****************************************************************************/
+
+int slab_cache_initialize(FAR struct slab_cache_s *cache, FAR const char *name, size_t objsize, size_t align, slab_ctor_t ctor);
+
+/****************************************************************************
+ * Name: slab_cache_create
+ *
+ * Description:
+ *   Like slab_cache_initialize() but the cache structure is allocated from
+ *   the kernel heap.  Returns NULL on failure.
+ *
+ ****************************************************************************/
+
+FAR struct slab_cache_s *slab_cache_create(FAR const char *name, size_t objsize, size_t align, slab_ctor_t ctor);
+
+/****************************************************************************
+ * Name: slab_cache_destroy
+ *
+ * Description:
+ *   Release all slabs of a cache and remove it from the list of caches.  A
+ *   cache created with slab_cache_create() is freed as well.  Returns
+ *   -EBUSY if objects are still allocated from the cache.
+ *
+ ****************************************************************************/
+
+int slab_cache_destroy(FAR struct slab_cache_s *cache);
+
+/****************************************************************************
+ * Name: slab_cache_alloc
+ *
+ * Description:
+ *   Allocate one object from the cache.  Objects are taken from the cache
+ *   with interrupts disabled for a few instructions and never take the heap
+ *   semaphore unless the cache has to grow by a slab.  This may be called
+ *   from interrupt handlers, but there the cache cannot grow and NULL is
+ *   returned when it is empty.
+ *
+ ****************************************************************************/
+
+FAR void *slab_cache_alloc(FAR struct slab_cache_s *cache);
+
+/****************************************************************************
+ * Name: slab_cache_free
+ *
+ * Description:
+ *   Return an object to the cache it was allocated from.  This may be
+ *   called from interrupt handlers.
+ *
+ ****************************************************************************/
+
+void slab_cache_free(FAR struct slab_cache_s *cache, FAR void *obj);
+
+/****************************************************************************
+ * Name: slab_cache_shrink
+ *
+ * Description:
+ *   Give every slab without allocated objects back to the kernel heap.
+ *   Returns the number of slabs released.  Must not be called from
+ *   interrupt handlers.
+ *
+ ****************************************************************************/
+
+int slab_cache_shrink(FAR struct slab_cache_s *cache);
+
+/****************************************************************************
+ * Name: slab_foreach
+ *
+ * Description:
+ *   Call 'handler' with a statistics snapshot of every cache.  Caches must
+ *   not be destroyed while they are being enumerated.
+ *
+ ****************************************************************************/
+
+void slab_foreach(slab_handler_t handler, FAR void *arg);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif							/* CONFIG_MM_SLAB */
+#endif							/* __INCLUDE_MM_SLAB_H */
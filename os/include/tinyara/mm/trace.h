@@ -0,0 +1,155 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * include/tinyara/mm/trace.h
+ *
+ * Heap allocation trace.  Every call to the heap interfaces is recorded in
+ * a ring buffer in the heap structure.  /proc/mmtrace reads a snapshot of
+ * the ring: a struct mm_tracehdr_s followed by the records, oldest first.
+ * The layout uses fixed-size fields in target byte order so that a trace
+ * can be replayed on the host with tools/mmbench.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_MM_TRACE_H
+#define __INCLUDE_MM_TRACE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+#define MM_TRACE_MAGIC    0x52544d4d	/* "MMTR" */
+#define MM_TRACE_VERSION  1
+
+/* Event types.  These are the letters used by the text trace format of
+ * tools/mmbench.
+ */
+
+#define MM_TRACE_MALLOC   'm'		/* malloc(size) returned mem */
+#define MM_TRACE_ZALLOC   'z'		/* zalloc/calloc(size) returned mem */
+#define MM_TRACE_MEMALIGN 'a'		/* memalign(arg, size) returned mem */
+#define MM_TRACE_REALLOC  'r'		/* realloc(arg, size) returned mem */
+#define MM_TRACE_FREE     'f'		/* free(mem) */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One recorded call */
+
+struct mm_trace_s {
+	uint32_t time;				/* System time of the call in ticks */
+	uint32_t mem;				/* Block returned by the call, or freed */
+	uint32_t arg;				/* realloc: old block, memalign: alignment */
+	uint32_t size;				/* Requested size */
+	uint32_t caller;			/* Return address of the call */
+	int16_t pid;				/* Calling task */
+	uint8_t op;					/* MM_TRACE_* */
+	uint8_t reserved;
+};
+
+/* The header in front of the records read from /proc/mmtrace */
+
+struct mm_tracehdr_s {
+	uint32_t magic;				/* MM_TRACE_MAGIC */
+	uint16_t version;			/* MM_TRACE_VERSION */
+	uint16_t recsize;			/* sizeof(struct mm_trace_s) */
+	uint32_t nrecords;			/* Number of records that follow */
+	uint32_t nlost;				/* Older records overwritten in the ring */
+	uint32_t usecpertick;		/* Unit of mm_trace_s::time */
+};
+
+#ifdef CONFIG_MM_TRACE
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+struct mm_heap_s;				/* Forward reference */
+
+/****************************************************************************
+ * Name: mm_trace_record
+ *
+ * Description:
+ *   Append one event to the trace of a heap.
+ *
+ ****************************************************************************/
+
+void mm_trace_record(FAR struct mm_heap_s *heap, uint8_t op, FAR void *mem, uintptr_t arg, size_t size, uintptr_t caller);
+
+/****************************************************************************
+ * Name: mm_trace_alloc, mm_trace_free, mm_trace_realloc
+ *
+ * Description:
+ *   Used by the heap interfaces (malloc(), kmm_malloc(), ...) rather than by
+ *   the allocator itself, so that an event is recorded once per call even
+ *   when the allocator uses other heap functions internally.
+ *
+ *   mm_trace_alloc() records an allocation that has been made and returns
+ *   the block.  mm_trace_free() records a free before the block is
+ *   released.  mm_trace_realloc() performs and records a realloc with the
+ *   heap held, so that the old block cannot be handed out again before the
+ *   event is recorded.  The order of the events is thus a valid replay
+ *   order.
+ *
+ ****************************************************************************/
+
+FAR void *mm_trace_alloc(FAR struct mm_heap_s *heap, uint8_t op, FAR void *mem, uintptr_t arg, size_t size, uintptr_t caller);
+void mm_trace_free(FAR struct mm_heap_s *heap, FAR void *mem, uintptr_t caller);
+FAR void *mm_trace_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem, size_t size, uintptr_t caller);
+
+/****************************************************************************
+ * Name: mm_trace_snapshot
+ *
+ * Description:
+ *   Copy up to 'nrecords' of the most recent events of a heap to 'buffer',
+ *   oldest first, and fill in 'hdr'.  Returns the number of records copied.
+ *
+ ****************************************************************************/
+
+int mm_trace_snapshot(FAR struct mm_heap_s *heap, FAR struct mm_tracehdr_s *hdr, FAR struct mm_trace_s *buffer, int nrecords);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#else							/* CONFIG_MM_TRACE */
+
+#define mm_trace_alloc(heap, op, mem, arg, size, caller) (mem)
+#define mm_trace_free(heap, mem, caller)
+#define mm_trace_realloc(heap, oldmem, size, caller) mm_realloc(heap, oldmem, size, caller)
+
+#endif							/* CONFIG_MM_TRACE */
+#endif							/* __INCLUDE_MM_TRACE_H */
@@ -97,6 +97,9 @@ struct eth_hdr_s {
 void ethernetif_status_callback(struct netif *netif);
 err_t ethernetif_init(struct netif *netif);
 int ethernetif_input(struct netif *netif);
+#ifdef CONFIG_NET_ZEROCOPY
+int ethernetif_input_pbuf(struct netif *netif, struct pbuf_custom *p, u8_t *frame, u16_t len, u16_t buflen);
+#endif
 
 #ifdef __cplusplus
 #define EXTERN extern "C"
@@ -101,6 +101,12 @@ sq_queue_t g_msgfreeirq;
 
 sq_queue_t g_desfree;
 
+#ifdef CONFIG_MM_SLAB
+/* Messages needed beyond the pre-allocated pool come from this cache */
+
+struct slab_cache_s g_msgcache;
+#endif
+
 /************************************************************************
  * Private Variables
  ************************************************************************/
@@ -197,6 +203,10 @@ void mq_initialize(void)
 
 	g_msgfreeirqalloc = mq_msgblockalloc(&g_msgfreeirq, NUM_INTERRUPT_MSGS, MQ_ALLOC_IRQ);
 
+#ifdef CONFIG_MM_SLAB
+	(void)slab_cache_initialize(&g_msgcache, "mqmsg", sizeof(struct mqueue_msg_s), 0, NULL);
+#endif
+
 	/* Allocate a block of message queue descriptors */
 
 	mq_desblockalloc();
@@ -141,7 +141,11 @@ void mq_msgfree(FAR struct mqueue_msg_s *mqmsg)
 	 */
 
 	else if (mqmsg->type == MQ_ALLOC_DYN) {
+#ifdef CONFIG_MM_SLAB
+		slab_cache_free(&g_msgcache, mqmsg);
+#else
 		sched_kfree(mqmsg);
+#endif
 	} else {
 		PANIC();
 	}
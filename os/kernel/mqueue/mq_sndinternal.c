@@ -211,7 +211,11 @@ FAR struct mqueue_msg_s *mq_msgalloc(void)
 		/* If we cannot a message from the free list, then we will have to allocate one. */
 
 		if (!mqmsg) {
+#ifdef CONFIG_MM_SLAB
+			mqmsg = (FAR struct mqueue_msg_s *)slab_cache_alloc(&g_msgcache);
+#else
 			mqmsg = (FAR struct mqueue_msg_s *)kmm_malloc((sizeof(struct mqueue_msg_s)));
+#endif
 
 			/* Check if we got an allocated message */
 
@@ -69,6 +69,7 @@
 #include <signal.h>
 
 #include <tinyara/mqueue.h>
+#include <tinyara/mm/slab.h>
 
 #if !defined(CONFIG_DISABLE_MQUEUE) && CONFIG_MQ_MAXMSGSIZE > 0
 
@@ -146,6 +147,12 @@ EXTERN sq_queue_t g_msgfreeirq;
 
 EXTERN sq_queue_t g_desfree;
 
+#ifdef CONFIG_MM_SLAB
+/* Messages needed beyond the pre-allocated pool come from this cache */
+
+EXTERN struct slab_cache_s g_msgcache;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -66,11 +66,25 @@
 #include <sched.h>
 
 #include <tinyara/compiler.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/mm/slab.h>
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Allocate and free the join structure of a pthread.  The structure is
+ * returned zeroed.
+ */
+
+#ifdef CONFIG_MM_SLAB
+#define pthread_joinalloc()  ((FAR struct join_s *)slab_cache_alloc(&g_joincache))
+#define pthread_joinfree(j)  slab_cache_free(&g_joincache, (j))
+#else
+#define pthread_joinalloc()  ((FAR struct join_s *)kmm_zalloc(sizeof(struct join_s)))
+#define pthread_joinfree(j)  sched_kfree(j)
+#endif
+
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
@@ -105,6 +119,12 @@ extern "C" {
 #define EXTERN extern
 #endif
 
+#ifdef CONFIG_MM_SLAB
+/* Join structures are allocated from this cache */
+
+EXTERN struct slab_cache_s g_joincache;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -290,7 +290,7 @@ int pthread_create(FAR pthread_t *thread, FAR const pthread_attr_t *attr, pthrea
 
 	/* Allocate a detachable structure to support pthread_join logic */
 
-	pjoin = (FAR struct join_s *)kmm_zalloc(sizeof(struct join_s));
+	pjoin = pthread_joinalloc();
 	if (!pjoin) {
 		sdbg("ERROR: Failed to allocate join\n");
 		errcode = ENOMEM;
@@ -457,7 +457,7 @@ int pthread_create(FAR pthread_t *thread, FAR const pthread_attr_t *attr, pthrea
 	return ret;
 
 errout_with_join:
-	sched_kfree(pjoin);
+	pthread_joinfree(pjoin);
 	ptcb->joininfo = NULL;
 
 errout_with_tcb:
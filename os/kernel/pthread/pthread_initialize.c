@@ -60,6 +60,7 @@
 #include <stdbool.h>
 #include <semaphore.h>
 #include <assert.h>
+#include <string.h>
 #include <errno.h>
 
 #include "pthread/pthread.h"
@@ -77,6 +78,12 @@
  * Global Variables
  ****************************************************************************/
 
+#ifdef CONFIG_MM_SLAB
+/* Join structures are allocated from this cache */
+
+struct slab_cache_s g_joincache;
+#endif
+
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
@@ -85,6 +92,21 @@
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_MM_SLAB
+/****************************************************************************
+ * Name: pthread_joinctor
+ *
+ * Description:
+ *   Join structures are handed out zeroed, like kmm_zalloc() did.
+ *
+ ****************************************************************************/
+
+static void pthread_joinctor(FAR void *obj)
+{
+	memset(obj, 0, sizeof(struct join_s));
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -93,9 +115,9 @@
  * Name: pthread_initialize
  *
  * Description:
- *   This is an internal OS function called only at power-up boot time.  It
- *   no longer does anything since all of the pthread data structures have
- *   been moved into the "task group"
+ *   This is an internal OS function called only at power-up boot time.
+ *   Most pthread data structures live in the "task group"; only the cache
+ *   of join structures is set up here.
  *
  * Parameters:
  *   None
@@ -109,6 +131,9 @@
 
 void pthread_initialize(void)
 {
+#ifdef CONFIG_MM_SLAB
+	(void)slab_cache_initialize(&g_joincache, "pthread_join", sizeof(struct join_s), 0, pthread_joinctor);
+#endif
 }
 
 /****************************************************************************
@@ -130,7 +130,7 @@ void pthread_release(FAR struct task_group_s *group)
 
 		/* And deallocate the join structure */
 
-		sched_kfree(join);
+		pthread_joinfree(join);
 	}
 
 	/* Destroy the join list semaphore */
@@ -191,7 +191,11 @@ static FAR sigpendq_t *sig_allocatependingsignal(void)
 			/* No... Allocate the pending signal */
 
 			if (!sigpend) {
+#ifdef CONFIG_MM_SLAB
+				sigpend = (FAR sigpendq_t *)slab_cache_alloc(&g_sigpendingcache);
+#else
 				sigpend = (FAR sigpendq_t *)kmm_malloc((sizeof(sigpendq_t)));
+#endif
 			}
 
 			/* Check if we got an allocated message */
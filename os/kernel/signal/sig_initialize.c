@@ -105,6 +105,14 @@ sq_queue_t g_sigpendingsignal;
 
 sq_queue_t g_sigpendingirqsignal;
 
+#ifdef CONFIG_MM_SLAB
+/* Pending signal structures needed beyond the pre-allocated pool come from
+ * this cache.
+ */
+
+struct slab_cache_s g_sigpendingcache;
+#endif
+
 /************************************************************************
  * Private Variables
  ************************************************************************/
@@ -239,6 +247,10 @@ void sig_initialize(void)
 	g_sigpendingsignalalloc = sig_allocatependingsignalblock(&g_sigpendingsignal, NUM_SIGNALS_PENDING, SIG_ALLOC_FIXED);
 
 	g_sigpendingirqsignalalloc = sig_allocatependingsignalblock(&g_sigpendingirqsignal, NUM_INT_SIGNALS_PENDING, SIG_ALLOC_IRQ);
+
+#ifdef CONFIG_MM_SLAB
+	(void)slab_cache_initialize(&g_sigpendingcache, "sigpend", sizeof(sigpendq_t), 0, NULL);
+#endif
 }
 
 /************************************************************************
@@ -139,6 +139,10 @@ void sig_releasependingsignal(FAR sigpendq_t *sigpend)
 	 */
 
 	else if (sigpend->type == SIG_ALLOC_DYN) {
+#ifdef CONFIG_MM_SLAB
+		slab_cache_free(&g_sigpendingcache, sigpend);
+#else
 		sched_kfree(sigpend);
+#endif
 	}
 }
@@ -64,6 +64,7 @@
 #include <sched.h>
 
 #include <tinyara/kmalloc.h>
+#include <tinyara/mm/slab.h>
 
 /****************************************************************************
  * Definitions
@@ -162,6 +163,14 @@ extern sq_queue_t g_sigpendingsignal;
 
 extern sq_queue_t g_sigpendingirqsignal;
 
+#ifdef CONFIG_MM_SLAB
+/* Pending signal structures needed beyond the pre-allocated pool come from
+ * this cache.
+ */
+
+extern struct slab_cache_s g_sigpendingcache;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
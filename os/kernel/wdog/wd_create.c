@@ -158,7 +158,11 @@ WDOG_ID wd_create(void)
 		/* We do not require that interrupts be disabled to do this. */
 
 		irqrestore(state);
+#ifdef CONFIG_MM_SLAB
+		wdog = (FAR struct wdog_s *)slab_cache_alloc(&g_wdcache);
+#else
 		wdog = (FAR struct wdog_s *)kmm_malloc(sizeof(struct wdog_s));
+#endif
 
 		/* Did we get one? */
 
@@ -138,13 +138,18 @@ int wd_delete(WDOG_ID wdog)
 		/* It was allocated from the heap.  Use sched_kfree() to release the
 		 * memory.  If the timer was released from an interrupt handler,
 		 * sched_kfree() will defer the actual deallocation of the memory
-		 * until a more appropriate time.
+		 * until a more appropriate time.  The watchdog cache can take it
+		 * back directly, even from an interrupt handler.
 		 *
 		 * We don't need interrupts disabled to do this.
 		 */
 
 		irqrestore(state);
+#ifdef CONFIG_MM_SLAB
+		slab_cache_free(&g_wdcache, wdog);
+#else
 		sched_kfree(wdog);
+#endif
 	}
 
 	/* This was a pre-allocated timer.  This function should not be called for
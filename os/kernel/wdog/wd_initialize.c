@@ -92,6 +92,12 @@ sq_queue_t g_wdactivelist;
 
 uint16_t g_wdnfree;
 
+#ifdef CONFIG_MM_SLAB
+/* Watchdogs needed beyond the pre-allocated pool come from this cache */
+
+struct slab_cache_s g_wdcache;
+#endif
+
 /************************************************************************
  * Private Data
  ************************************************************************/
@@ -150,4 +156,8 @@ void wd_initialize(void)
 	/* All watchdogs are free */
 
 	g_wdnfree = CONFIG_PREALLOC_WDOGS;
+
+#ifdef CONFIG_MM_SLAB
+	(void)slab_cache_initialize(&g_wdcache, "wdog", sizeof(struct wdog_s), 0, NULL);
+#endif
 }
@@ -64,6 +64,7 @@
 
 #include <tinyara/compiler.h>
 #include <tinyara/wdog.h>
+#include <tinyara/mm/slab.h>
 
 /************************************************************************
  * Pre-processor Definitions
@@ -104,6 +105,12 @@ extern sq_queue_t g_wdactivelist;
 
 extern uint16_t g_wdnfree;
 
+#ifdef CONFIG_MM_SLAB
+/* Watchdogs needed beyond the pre-allocated pool come from this cache */
+
+extern struct slab_cache_s g_wdcache;
+#endif
+
 /************************************************************************
  * Public Function Prototypes
  ************************************************************************/
@@ -79,7 +79,7 @@
 FAR void *kmm_calloc(size_t n, size_t elem_size)
 {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
-	return mm_calloc(&g_kmmheap, n, elem_size, __builtin_return_address(0));
+	return mm_trace_alloc(&g_kmmheap, MM_TRACE_ZALLOC, mm_calloc(&g_kmmheap, n, elem_size, __builtin_return_address(0)), 0, n * elem_size, (uintptr_t)__builtin_return_address(0));
 #else
 	return mm_calloc(&g_kmmheap, n, elem_size);
 #endif
@@ -93,6 +93,9 @@
 void kmm_free(FAR void *mem)
 {
 	DEBUGASSERT(kmm_heapmember(mem));
+#ifdef CONFIG_MM_TRACE
+	mm_trace_free(&g_kmmheap, mem, (uintptr_t)__builtin_return_address(0));
+#endif
 	mm_free(&g_kmmheap, mem);
 }
 
@@ -101,7 +101,7 @@
 FAR void *kmm_malloc(size_t size)
 {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
-	return mm_malloc(&g_kmmheap, size, __builtin_return_address(0));
+	return mm_trace_alloc(&g_kmmheap, MM_TRACE_MALLOC, mm_malloc(&g_kmmheap, size, __builtin_return_address(0)), 0, size, (uintptr_t)__builtin_return_address(0));
 #else
 	return mm_malloc(&g_kmmheap, size);
 #endif
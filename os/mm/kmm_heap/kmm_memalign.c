@@ -92,7 +92,7 @@
 FAR void *kmm_memalign(size_t alignment, size_t size)
 {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
-	return mm_memalign(&g_kmmheap, alignment, size, __builtin_return_address(0));
+	return mm_trace_alloc(&g_kmmheap, MM_TRACE_MEMALIGN, mm_memalign(&g_kmmheap, alignment, size, __builtin_return_address(0)), alignment, size, (uintptr_t)__builtin_return_address(0));
 #else
 	return mm_memalign(&g_kmmheap, alignment, size);
 #endif
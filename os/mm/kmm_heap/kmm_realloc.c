@@ -90,7 +90,7 @@
 FAR void *kmm_realloc(FAR void *oldmem, size_t newsize)
 {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
-	return mm_realloc(&g_kmmheap, oldmem, newsize, __builtin_return_address(0));
+	return mm_trace_realloc(&g_kmmheap, oldmem, newsize, (uintptr_t)__builtin_return_address(0));
 #else
 	return mm_realloc(&g_kmmheap, oldmem, newsize);
 #endif
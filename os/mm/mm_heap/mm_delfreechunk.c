@@ -0,0 +1,55 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_heap/mm_delfreechunk.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <assert.h>
+
+#include <tinyara/mm/mm.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_delfreechunk
+ *
+ * Description:
+ *   Remove a free chunk from the nodelist.  The chunk size must not have
+ *   been changed since the chunk was added.  It is assumed that the caller
+ *   holds the mm semaphore.
+ *
+ ****************************************************************************/
+
+void mm_delfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+	/* There must be a predecessor, but there may not be a successor node */
+
+	DEBUGASSERT(node->blink);
+	node->blink->flink = node->flink;
+	if (node->flink) {
+		node->flink->blink = node->blink;
+	}
+}
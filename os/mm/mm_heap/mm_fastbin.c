@@ -0,0 +1,146 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_heap/mm_fastbin.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/mm/mm.h>
+
+#ifdef CONFIG_MM_FASTBINS
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fastbin_remove
+ *
+ * Description:
+ *   Take a cached chunk of exactly 'size' bytes (a chunk size, including
+ *   SIZEOF_MM_ALLOCNODE) from the fast bins.  The chunk is returned with its
+ *   allocated header intact.  Returns NULL if the size is not served by the
+ *   fast bins or if the bin is empty.  The caller must hold the MM
+ *   semaphore.
+ *
+ ****************************************************************************/
+
+FAR struct mm_allocnode_s *mm_fastbin_remove(FAR struct mm_heap_s *heap, size_t size)
+{
+	FAR struct mm_allocnode_s *node;
+	int ndx;
+
+	if (size > MM_FASTBIN_MAXCHUNK) {
+		return NULL;
+	}
+
+	ndx = MM_FASTBIN_NDX(size);
+	node = heap->mm_fastbin[ndx];
+	if (node == NULL) {
+		heap->mm_fastmisses++;
+		return NULL;
+	}
+
+	DEBUGASSERT(node->size == size && (node->preceding & MM_ALLOC_BIT) != 0);
+
+	heap->mm_fastbin[ndx] = MM_FASTBIN_LINK(node);
+	heap->mm_fastcount[ndx]--;
+	heap->mm_fasthits++;
+	return node;
+}
+
+/****************************************************************************
+ * Name: mm_fastbin_insert
+ *
+ * Description:
+ *   Park a chunk that is being freed in the fast bin for its size.  Returns
+ *   false if the chunk does not fit any bin or if its bin is already full;
+ *   the caller must then return it to the nodelist.  The
+ *   caller must hold the MM semaphore.
+ *
+ ****************************************************************************/
+
+bool mm_fastbin_insert(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node)
+{
+	int ndx;
+
+	/* mm_memalign() can leave chunks whose size is not a multiple of the
+	 * granule; those do not belong to any bin.
+	 */
+
+	if (node->size > MM_FASTBIN_MAXCHUNK || (node->size & MM_GRAN_MASK) != 0) {
+		return false;
+	}
+
+	ndx = MM_FASTBIN_NDX(node->size);
+	if (heap->mm_fastcount[ndx] >= CONFIG_MM_FASTBIN_DEPTH) {
+		return false;
+	}
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	/* Let the heap walker tell cached chunks from live allocations */
+
+	node->pid = HEAPINFO_FASTBIN;
+#endif
+
+	MM_FASTBIN_LINK(node) = heap->mm_fastbin[ndx];
+	heap->mm_fastbin[ndx] = node;
+	heap->mm_fastcount[ndx]++;
+	return true;
+}
+
+/****************************************************************************
+ * Name: mm_fastbin_flush
+ *
+ * Description:
+ *   Return every cached chunk to the nodelist, coalescing it with its free
+ *   neighbours.  Returns the number of chunks released.  The caller must
+ *   hold the MM semaphore.
+ *
+ ****************************************************************************/
+
+int mm_fastbin_flush(FAR struct mm_heap_s *heap)
+{
+	FAR struct mm_allocnode_s *node;
+	int nflushed = 0;
+	int ndx;
+
+	for (ndx = 0; ndx < MM_NFASTBINS; ndx++) {
+		while ((node = heap->mm_fastbin[ndx]) != NULL) {
+			heap->mm_fastbin[ndx] = MM_FASTBIN_LINK(node);
+			mm_freechunk(heap, (FAR struct mm_freenode_s *)node);
+			nflushed++;
+		}
+
+		heap->mm_fastcount[ndx] = 0;
+	}
+
+	mvdbg("Flushed %d chunks\n", nflushed);
+	return nflushed;
+}
+
+#endif							/* CONFIG_MM_FASTBINS */
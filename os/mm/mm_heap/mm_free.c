@@ -77,47 +77,18 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: mm_free
+ * Name: mm_freechunk
  *
  * Description:
- *   Returns a chunk of memory to the list of free nodes,  merging with
- *   adjacent free chunks if possible.
+ *   Returns a chunk to the list of free nodes, merging it with adjacent free
+ *   chunks if possible.  The caller must hold the MM semaphore.
  *
  ****************************************************************************/
-void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 {
-	FAR struct mm_freenode_s *node;
 	FAR struct mm_freenode_s *prev;
 	FAR struct mm_freenode_s *next;
-#ifdef CONFIG_DEBUG_MM_HEAPINFO
-	struct mm_allocnode_s *alloc_node;
-#endif
-
-	mvdbg("Freeing %p\n", mem);
-
-	/* Protect against attempts to free a NULL reference */
-
-	if (!mem) {
-		return;
-	}
-
-	/* We need to hold the MM semaphore while we muck with the
-	 * nodelist.
-	 */
-
-	mm_takesemaphore(heap);
-
-	/* Map the memory chunk into a free node */
 
-	node = (FAR struct mm_freenode_s *)((char *)mem - SIZEOF_MM_ALLOCNODE);
-#ifdef CONFIG_DEBUG_MM_HEAPINFO
-	alloc_node = (struct mm_allocnode_s *)node;
-
-	if ((alloc_node->preceding & MM_ALLOC_BIT) != 0) {
-		heapinfo_subtract_size(alloc_node->pid, alloc_node->size);
-		heapinfo_update_total_size(heap, ((-1) * alloc_node->size));
-	}
-#endif
 	node->preceding &= ~MM_ALLOC_BIT;
 
 	/* Check if the following node is free and, if so, merge it */
@@ -133,15 +104,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 
 		andbeyond = (FAR struct mm_allocnode_s *)((char *)next + next->size);
 
-		/* Remove the next node.  There must be a predecessor,
-		 * but there may not be a successor node.
-		 */
+		/* Remove the next node from the nodelist */
 
-		DEBUGASSERT(next->blink);
-		next->blink->flink = next->flink;
-		if (next->flink) {
-			next->flink->blink = next->blink;
-		}
+		mm_delfreechunk(heap, next);
 
 		/* Then merge the two chunks */
 
@@ -156,15 +121,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 
 	prev = (FAR struct mm_freenode_s *)((char *)node - node->preceding);
 	if ((prev->preceding & MM_ALLOC_BIT) == 0) {
-		/* Remove the node.  There must be a predecessor, but there may
-		 * not be a successor node.
-		 */
+		/* Remove the preceding node from the nodelist */
 
-		DEBUGASSERT(prev->blink);
-		prev->blink->flink = prev->flink;
-		if (prev->flink) {
-			prev->flink->blink = prev->blink;
-		}
+		mm_delfreechunk(heap, prev);
 
 		/* Then merge the two chunks */
 
@@ -176,5 +135,60 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 	/* Add the merged node to the nodelist */
 
 	mm_addfreechunk(heap, node);
+}
+
+/****************************************************************************
+ * Name: mm_free
+ *
+ * Description:
+ *   Returns a chunk of memory to the list of free nodes,  merging with
+ *   adjacent free chunks if possible.
+ *
+ ****************************************************************************/
+void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+	FAR struct mm_freenode_s *node;
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	struct mm_allocnode_s *alloc_node;
+#endif
+
+	mvdbg("Freeing %p\n", mem);
+
+	/* Protect against attempts to free a NULL reference */
+
+	if (!mem) {
+		return;
+	}
+
+	/* We need to hold the MM semaphore while we muck with the
+	 * nodelist.
+	 */
+
+	mm_takesemaphore(heap);
+
+	/* Map the memory chunk into a free node */
+
+	node = (FAR struct mm_freenode_s *)((char *)mem - SIZEOF_MM_ALLOCNODE);
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	alloc_node = (struct mm_allocnode_s *)node;
+
+	if ((alloc_node->preceding & MM_ALLOC_BIT) != 0) {
+		heapinfo_subtract_size(alloc_node->pid, alloc_node->size);
+		heapinfo_update_total_size(heap, ((-1) * alloc_node->size));
+	}
+#endif
+
+#ifdef CONFIG_MM_FASTBINS
+	/* Small chunks are parked in their fast bin, if it has room, and are
+	 * only merged with their neighbours when the bins are flushed.
+	 */
+
+	if (mm_fastbin_insert(heap, (FAR struct mm_allocnode_s *)node)) {
+		mm_givesemaphore(heap);
+		return;
+	}
+#endif
+
+	mm_freechunk(heap, node);
 	mm_givesemaphore(heap);
 }
@@ -134,6 +134,18 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 		for (node = heap->mm_heapstart[region]; node < heap->mm_heapend[region]; node = (struct mm_allocnode_s *)((char *)node + node->size)) {
 
 			/* Check if the node corresponds to an allocated memory chunk */
+#ifdef CONFIG_MM_FASTBINS
+			/* Chunks cached in a fast bin are reported as free */
+
+			if ((node->preceding & MM_ALLOC_BIT) != 0 && node->pid == HEAPINFO_FASTBIN) {
+				ordblks++;
+				fordblks += node->size;
+				if (mode == HEAPINFO_DETAIL_ALL || mode == HEAPINFO_DETAIL_FREE) {
+					printf("0x%x | %8d |   %c    |           |     |\n", node, node->size, 'C');
+				}
+				continue;
+			}
+#endif
 			if ((pid == HEAPINFO_PID_NOTNEEDED || node->pid == pid) && (node->preceding & MM_ALLOC_BIT) != 0) {
 				if (mode == HEAPINFO_DETAIL_ALL || mode == HEAPINFO_DETAIL_PID) {
 					printf("0x%x | %8d |   %c    | 0x%x | %3d |\n", node, node->size, 'A', node->alloc_call_addr, node->pid);
@@ -177,6 +189,9 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 	printf("Free Size                      : %d\n", fordblks);
 	printf("Largest Free Node Size         : %d\n", mxordblk);
 	printf("Number of Free Node            : %d\n", ordblks);
+#ifdef CONFIG_MM_FASTBINS
+	printf("Fast Bin Hits / Misses         : %u / %u\n", heap->mm_fasthits, heap->mm_fastmisses);
+#endif
 	printf("\nStack Resources                : %d", stack_resource);
 
 	printf("\nNon Scheduled Task Resources   : %d\n", nonsched_resource);
@@ -190,7 +190,9 @@ void mm_addregion(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heapsi
 
 void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heapsize)
 {
+#ifndef CONFIG_MM_TLSF
 	int i;
+#endif
 
 	mlldbg("Heap: start=%p size=%u\n", heapstart, heapsize);
 
@@ -212,6 +214,11 @@ void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heaps
 	heap->mm_nregions = 0;
 #endif
 
+#ifdef CONFIG_MM_TLSF
+	/* Initialize the segregated free lists */
+
+	mm_tlsf_initialize(heap);
+#else
 	/* Initialize the node array */
 
 	memset(heap->mm_nodelist, 0, sizeof(struct mm_freenode_s) * MM_NNODES);
@@ -219,6 +226,21 @@ void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heaps
 		heap->mm_nodelist[i - 1].flink = &heap->mm_nodelist[i];
 		heap->mm_nodelist[i].blink = &heap->mm_nodelist[i - 1];
 	}
+#endif
+
+#ifdef CONFIG_MM_FASTBINS
+	/* All fast bins start out empty */
+
+	memset(heap->mm_fastbin, 0, sizeof(heap->mm_fastbin));
+	memset(heap->mm_fastcount, 0, sizeof(heap->mm_fastcount));
+	heap->mm_fasthits = 0;
+	heap->mm_fastmisses = 0;
+#endif
+
+#ifdef CONFIG_MM_TRACE
+	heap->mm_tracenext = 0;
+	heap->mm_tracecount = 0;
+#endif
 
 	/* Initialize the malloc semaphore to one (to support one-at-
 	 * a-time access to private data sets).
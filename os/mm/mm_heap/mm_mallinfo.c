@@ -90,6 +90,11 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
 	int    ordblks  = 0;		/* Number of non-inuse chunks */
 	size_t uordblks = 0;		/* Total allocated space */
 	size_t fordblks = 0;		/* Total non-inuse space */
+#ifdef CONFIG_MM_FASTBINS
+	int    smblks   = 0;		/* Number of chunks in the fast bins */
+	size_t fsmblks  = 0;		/* Space held by the fast bins */
+	int ndx;
+#endif
 #if CONFIG_MM_REGIONS > 1
 	int region;
 #else
@@ -136,6 +141,28 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
 
 	DEBUGASSERT(uordblks + fordblks == heap->mm_heapsize);
 
+#ifdef CONFIG_MM_FASTBINS
+	/* Chunks cached in the fast bins look allocated to the heap walk above,
+	 * but they are free memory as far as the caller is concerned.
+	 */
+
+	mm_takesemaphore(heap);
+	for (ndx = 0; ndx < MM_NFASTBINS; ndx++) {
+		smblks  += heap->mm_fastcount[ndx];
+		fsmblks += heap->mm_fastcount[ndx] * ((ndx + 1) << MM_MIN_SHIFT);
+	}
+
+	info->smblks   = smblks;
+	info->fsmblks  = fsmblks;
+	info->fbhits   = heap->mm_fasthits;
+	info->fbmisses = heap->mm_fastmisses;
+	mm_givesemaphore(heap);
+
+	ordblks  += smblks;
+	uordblks -= fsmblks;
+	fordblks += fsmblks;
+#endif
+
 	info->arena    = heap->mm_heapsize;
 	info->ordblks  = ordblks;
 	info->mxordblk = mxordblk;
@@ -96,7 +96,7 @@
  * Name: mm_malloc
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  Find a free chunk that satisfies the request. Take the memory from
  *  that chunk, save the remaining, smaller chunk (if any).
  *
  *  8-byte alignment of the allocated data is assured.
@@ -110,7 +110,6 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 {
 	FAR struct mm_freenode_s *node;
 	void *ret = NULL;
-	int ndx;
 
 	/* Handle bad sizes */
 
@@ -128,44 +127,41 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
 	mm_takesemaphore(heap);
 
-	/* Get the location in the node list to start the search. Special case
-	 * really big allocations
+#ifdef CONFIG_MM_FASTBINS
+	/* Small requests are served from the fast bins when the bin for this
+	 * chunk size is not empty.  The cached chunk is already marked allocated.
 	 */
 
-	if (size >= MM_MAX_CHUNK) {
-		ndx = MM_NNODES - 1;
-	} else {
-		/* Convert the request size into a nodelist index */
-
-		ndx = mm_size2ndx(size);
+	node = (FAR struct mm_freenode_s *)mm_fastbin_remove(heap, size);
+	if (node) {
+		goto found;
 	}
+#endif
 
-	/* Search for a large enough chunk in the list of nodes. This list is
-	 * ordered by size, but will have occasional zero sized nodes as we visit
-	 * other mm_nodelist[] entries.
-	 */
+	/* Find a free chunk that is large enough */
 
-	for (node = heap->mm_nodelist[ndx].flink; node && node->size < size; node = node->flink) ;
+	node = mm_findfreechunk(heap, size);
 
-	/* If we found a node with non-zero size, then this is one to use. Since
-	 * the list is ordered, we know that is must be best fitting chunk
-	 * available.
+#ifdef CONFIG_MM_FASTBINS
+	/* Nothing fits.  The chunks cached in the fast bins may be fragmenting
+	 * the heap, so give them back to the nodelist and search once more.
 	 */
 
+	if (!node && mm_fastbin_flush(heap) > 0) {
+		node = mm_findfreechunk(heap, size);
+	}
+#endif
+
+	/* If we found a node, then this is the one to use */
+
 	if (node) {
 		FAR struct mm_freenode_s *remainder;
 		FAR struct mm_freenode_s *next;
 		size_t remaining;
 
-		/* Remove the node.  There must be a predecessor, but there may not be
-		 * a successor node.
-		 */
+		/* Remove the node from the nodelist */
 
-		DEBUGASSERT(node->blink);
-		node->blink->flink = node->flink;
-		if (node->flink) {
-			node->flink->blink = node->blink;
-		}
+		mm_delfreechunk(heap, node);
 
 		/* Check if we have to split the free node into one of the allocated
 		 * size and another smaller freenode.  In some cases, the remaining
@@ -204,7 +200,12 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 		/* Handle the case of an exact size match */
 
 		node->preceding |= MM_ALLOC_BIT;
+	}
 
+#ifdef CONFIG_MM_FASTBINS
+found:
+#endif
+	if (node) {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 		heapinfo_update_node((struct mm_allocnode_s *)node, caller_retaddr);
 		heapinfo_add_size(((struct mm_allocnode_s *)node)->pid, node->size);
@@ -64,6 +64,15 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Chunks start on an MM_MIN_CHUNK boundary, so the memory returned by
+ * malloc is aligned to the largest power of two that divides the chunk
+ * header size, up to MM_MIN_CHUNK.
+ */
+
+#define MM_LOWBIT(n)        ((n) & -(n))
+#define MM_NATURAL_ALIGN \
+	(MM_LOWBIT(SIZEOF_MM_ALLOCNODE) < MM_MIN_CHUNK ? MM_LOWBIT(SIZEOF_MM_ALLOCNODE) : MM_MIN_CHUNK)
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -100,7 +109,7 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment, size_t size)
 	 * of malloc, then just let malloc do the work.
 	 */
 
-	if (alignment <= MM_MIN_CHUNK) {
+	if (alignment <= MM_NATURAL_ALIGN) {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 		return mm_malloc(heap, size, caller_retaddr);
 #else
@@ -214,9 +223,12 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment, size_t size)
 
 		allocsize = newnode->size - SIZEOF_MM_ALLOCNODE;
 
-		/* Add the original, newly freed node to the free nodelist */
+		/* Return the original, newly freed node to the free nodelist.  The
+		 * chunk before it is not necessarily allocated (a chunk taken from a
+		 * fast bin may follow a free one), so merge with it if possible.
+		 */
 
-		mm_addfreechunk(heap, (FAR struct mm_freenode_s *)node);
+		mm_freechunk(heap, (FAR struct mm_freenode_s *)node);
 
 		/* Replace the original node with the newlay realloaced,
 		 * aligned node
@@ -259,15 +259,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem, size_t size)
 		if (takeprev) {
 			FAR struct mm_allocnode_s *newnode;
 
-			/* Remove the previous node.  There must be a predecessor, but
-			 * there may not be a successor node.
-			 */
+			/* Remove the previous node from the nodelist */
 
-			DEBUGASSERT(prev->blink);
-			prev->blink->flink = prev->flink;
-			if (prev->flink) {
-				prev->flink->blink = prev->blink;
-			}
+			mm_delfreechunk(heap, prev);
 
 			/* Extend the node into the previous free chunk */
 			/* Did we consume the entire preceding chunk? */
@@ -317,15 +311,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem, size_t size)
 
 			andbeyond = (FAR struct mm_allocnode_s *)((char *)next + nextsize);
 
-			/* Remove the next node.  There must be a predecessor, but there
-			 * may not be a successor node.
-			 */
+			/* Remove the next node from the nodelist */
 
-			DEBUGASSERT(next->blink);
-			next->blink->flink = next->flink;
-			if (next->flink) {
-				next->flink->blink = next->blink;
-			}
+			mm_delfreechunk(heap, next);
 
 			/* Extend the node into the next chunk */
 			/* Did we consume the entire preceding chunk? */
@@ -101,15 +101,9 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node,
 
 		andbeyond = (FAR struct mm_allocnode_s *)((char *)next + next->size);
 
-		/* Remove the next node.  There must be a predecessor, but there may
-		 * not be a successor node.
-		 */
+		/* Remove the next node from the nodelist */
 
-		DEBUGASSERT(next->blink);
-		next->blink->flink = next->flink;
-		if (next->flink) {
-			next->flink->blink = next->blink;
-		}
+		mm_delfreechunk(heap, next);
 
 		/* Create a new chunk that will hold both the next chunk and the
 		 * tailing memory from the aligned chunk.
@@ -0,0 +1,243 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_heap/mm_tlsf.c
+ *
+ * Two-Level Segregated Fit free lists.  This replaces the size-ordered
+ * nodelist (mm_addfreechunk.c, mm_delfreechunk.c and mm_findfreechunk.c)
+ * when CONFIG_MM_TLSF is selected.  The chunk layout, splitting and
+ * coalescing logic are shared with the best-fit allocator; only the way
+ * free chunks are indexed differs.  Every operation below runs in constant
+ * time, except for requests of MM_MAX_CHUNK bytes or more, which are served
+ * first-fit from the single list that holds the very large chunks.
+ *
+ * Reference: M. Masmano, I. Ripoll, A. Crespo and J. Real, "TLSF: a New
+ * Dynamic Memory Allocator for Real-Time Systems", ECRTS 2004.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include <tinyara/mm/mm.h>
+
+#ifdef CONFIG_MM_TLSF
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if MM_TLSF_SLCOUNT > 32 || MM_TLSF_FLCOUNT > 32
+#error The TLSF bitmaps are limited to 32 lists per level
+#endif
+
+#define MM_TLSF_SMALLCHUNK  (1 << MM_TLSF_FLSHIFT)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Index of the most and least significant set bit of a non-zero word */
+
+static inline int mm_tlsf_fls(uint32_t word)
+{
+	return 31 - __builtin_clz(word);
+}
+
+static inline int mm_tlsf_ffs(uint32_t word)
+{
+	return __builtin_ctz(word);
+}
+
+/****************************************************************************
+ * Name: mm_tlsf_mapping
+ *
+ * Description:
+ *   Return the first- and second-level indices of the list that holds free
+ *   chunks of 'size' bytes.
+ *
+ ****************************************************************************/
+
+static void mm_tlsf_mapping(size_t size, FAR int *fl, FAR int *sl)
+{
+	int msb;
+
+	if (size < MM_TLSF_SMALLCHUNK) {
+		*fl = 0;
+		*sl = size >> MM_MIN_SHIFT;
+	} else if (size >= MM_MAX_CHUNK) {
+		*fl = MM_TLSF_FLCOUNT - 1;
+		*sl = 0;
+	} else {
+		msb = mm_tlsf_fls(size);
+		*fl = msb - MM_TLSF_FLSHIFT + 1;
+		*sl = (size >> (msb - CONFIG_MM_TLSF_SLI)) - MM_TLSF_SLCOUNT;
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tlsf_initialize
+ *
+ * Description:
+ *   Empty all of the free lists of the heap.
+ *
+ ****************************************************************************/
+
+void mm_tlsf_initialize(FAR struct mm_heap_s *heap)
+{
+	heap->mm_flbitmap = 0;
+	memset(heap->mm_slbitmap, 0, sizeof(heap->mm_slbitmap));
+	memset(heap->mm_tlsf, 0, sizeof(heap->mm_tlsf));
+}
+
+/****************************************************************************
+ * Name: mm_addfreechunk
+ *
+ * Description:
+ *   Add a free chunk to the head of its list.  It is assumed that the
+ *   caller holds the mm semaphore.
+ *
+ ****************************************************************************/
+
+void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+	FAR struct mm_freenode_s *head;
+	int fl;
+	int sl;
+
+	mm_tlsf_mapping(node->size, &fl, &sl);
+
+	head = heap->mm_tlsf[fl][sl];
+	node->blink = NULL;
+	node->flink = head;
+	if (head) {
+		head->blink = node;
+	}
+
+	heap->mm_tlsf[fl][sl] = node;
+	heap->mm_flbitmap |= (uint32_t)1 << fl;
+	heap->mm_slbitmap[fl] |= (uint32_t)1 << sl;
+}
+
+/****************************************************************************
+ * Name: mm_delfreechunk
+ *
+ * Description:
+ *   Remove a free chunk from its list.  The chunk size must not have been
+ *   changed since the chunk was added.  It is assumed that the caller holds
+ *   the mm semaphore.
+ *
+ ****************************************************************************/
+
+void mm_delfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+	int fl;
+	int sl;
+
+	if (node->flink) {
+		node->flink->blink = node->blink;
+	}
+
+	if (node->blink) {
+		node->blink->flink = node->flink;
+		return;
+	}
+
+	/* The node was the head of its list */
+
+	mm_tlsf_mapping(node->size, &fl, &sl);
+	DEBUGASSERT(heap->mm_tlsf[fl][sl] == node);
+
+	heap->mm_tlsf[fl][sl] = node->flink;
+	if (node->flink == NULL) {
+		heap->mm_slbitmap[fl] &= ~((uint32_t)1 << sl);
+		if (heap->mm_slbitmap[fl] == 0) {
+			heap->mm_flbitmap &= ~((uint32_t)1 << fl);
+		}
+	}
+}
+
+/****************************************************************************
+ * Name: mm_findfreechunk
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes.  The request is rounded up
+ *   to the next list boundary so that the head of the first non-empty list
+ *   at or above that boundary always fits; no list is searched.  The chunk
+ *   is left in its list.  Returns NULL if there is no such chunk.  It is
+ *   assumed that the caller holds the mm semaphore.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap, size_t size)
+{
+	FAR struct mm_freenode_s *node;
+	size_t rounded = size;
+	uint32_t map;
+	int fl;
+	int sl;
+
+	if (size >= MM_TLSF_SMALLCHUNK && size < MM_MAX_CHUNK) {
+		rounded += ((size_t)1 << (mm_tlsf_fls(size) - CONFIG_MM_TLSF_SLI)) - 1;
+	}
+
+	mm_tlsf_mapping(rounded, &fl, &sl);
+
+	/* Look for a non-empty list in the same class first, then in the next
+	 * non-empty class.
+	 */
+
+	map = heap->mm_slbitmap[fl] & (~(uint32_t)0 << sl);
+	if (map == 0) {
+		map = heap->mm_flbitmap & (~(uint32_t)0 << (fl + 1));
+		if (map == 0) {
+			return NULL;
+		}
+
+		fl = mm_tlsf_ffs(map);
+		map = heap->mm_slbitmap[fl];
+	}
+
+	sl = mm_tlsf_ffs(map);
+	node = heap->mm_tlsf[fl][sl];
+	DEBUGASSERT(node != NULL);
+
+	/* Only the last class mixes chunk sizes freely, so a very large request
+	 * may have to look past the head of that list.
+	 */
+
+	if (fl == MM_TLSF_FLCOUNT - 1) {
+		while (node && node->size < size) {
+			node = node->flink;
+		}
+	}
+
+	return node;
+}
+
+#endif							/* CONFIG_MM_TLSF */
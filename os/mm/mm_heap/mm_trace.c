@@ -0,0 +1,184 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_heap/mm_trace.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/clock.h>
+#include <tinyara/mm/mm.h>
+#include <tinyara/mm/trace.h>
+
+#ifdef CONFIG_MM_TRACE
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_trace_record
+ *
+ * Description:
+ *   Append one event to the trace ring of a heap.  Only a slot is claimed
+ *   and filled with interrupts disabled; the heap semaphore is not taken.
+ *
+ ****************************************************************************/
+
+void mm_trace_record(FAR struct mm_heap_s *heap, uint8_t op, FAR void *mem, uintptr_t arg, size_t size, uintptr_t caller)
+{
+	FAR struct mm_trace_s *rec;
+	uint32_t now = (uint32_t)clock_systimer();
+	pid_t pid = getpid();
+	irqstate_t flags;
+
+	flags = irqsave();
+
+	rec = &heap->mm_trace[heap->mm_tracenext];
+	if (++heap->mm_tracenext >= CONFIG_MM_TRACE_ENTRIES) {
+		heap->mm_tracenext = 0;
+	}
+
+	heap->mm_tracecount++;
+
+	rec->time = now;
+	rec->mem = (uint32_t)(uintptr_t)mem;
+	rec->arg = (uint32_t)arg;
+	rec->size = (uint32_t)size;
+	rec->caller = (uint32_t)caller;
+	rec->pid = (int16_t)pid;
+	rec->op = op;
+	rec->reserved = 0;
+
+	irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: mm_trace_alloc
+ *
+ * Description:
+ *   Record an allocation that has been made and return the block.
+ *
+ ****************************************************************************/
+
+FAR void *mm_trace_alloc(FAR struct mm_heap_s *heap, uint8_t op, FAR void *mem, uintptr_t arg, size_t size, uintptr_t caller)
+{
+	mm_trace_record(heap, op, mem, arg, size, caller);
+	return mem;
+}
+
+/****************************************************************************
+ * Name: mm_trace_free
+ *
+ * Description:
+ *   Record a free.  This must be called before the block is released.
+ *
+ ****************************************************************************/
+
+void mm_trace_free(FAR struct mm_heap_s *heap, FAR void *mem, uintptr_t caller)
+{
+	if (mem != NULL) {
+		mm_trace_record(heap, MM_TRACE_FREE, mem, 0, 0, caller);
+	}
+}
+
+/****************************************************************************
+ * Name: mm_trace_realloc
+ *
+ * Description:
+ *   Reallocate a block and record the event.  mm_realloc() may release the
+ *   old block; the heap semaphore (which may be taken recursively) is held
+ *   until the event is recorded so that no other task can be given the old
+ *   block first.
+ *
+ ****************************************************************************/
+
+FAR void *mm_trace_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem, size_t size, uintptr_t caller)
+{
+	FAR void *mem;
+
+	mm_takesemaphore(heap);
+	mem = mm_realloc(heap, oldmem, size, caller);
+	mm_trace_record(heap, MM_TRACE_REALLOC, mem, (uintptr_t)oldmem, size, caller);
+	mm_givesemaphore(heap);
+
+	return mem;
+}
+
+/****************************************************************************
+ * Name: mm_trace_snapshot
+ *
+ * Description:
+ *   Copy the most recent events of a heap, oldest first.  Events are only
+ *   recorded by tasks (the heap cannot be used from interrupt handlers),
+ *   so locking the scheduler keeps the ring stable while it is copied
+ *   without disabling interrupts for the length of the copy.
+ *
+ ****************************************************************************/
+
+int mm_trace_snapshot(FAR struct mm_heap_s *heap, FAR struct mm_tracehdr_s *hdr, FAR struct mm_trace_s *buffer, int nrecords)
+{
+	uint32_t count;
+	int first;
+	int n;
+
+	DEBUGASSERT(heap != NULL && hdr != NULL && (buffer != NULL || nrecords == 0));
+
+	sched_lock();
+
+	count = heap->mm_tracecount;
+	n = count < CONFIG_MM_TRACE_ENTRIES ? (int)count : CONFIG_MM_TRACE_ENTRIES;
+	if (n > nrecords) {
+		n = nrecords;
+	}
+
+	/* The records are copied in up to two pieces: from the oldest wanted
+	 * record to the end of the ring, then from the start of the ring.
+	 */
+
+	first = heap->mm_tracenext - n;
+	if (first < 0) {
+		first += CONFIG_MM_TRACE_ENTRIES;
+		memcpy(buffer, &heap->mm_trace[first], (CONFIG_MM_TRACE_ENTRIES - first) * sizeof(struct mm_trace_s));
+		memcpy(&buffer[CONFIG_MM_TRACE_ENTRIES - first], heap->mm_trace, heap->mm_tracenext * sizeof(struct mm_trace_s));
+	} else {
+		memcpy(buffer, &heap->mm_trace[first], n * sizeof(struct mm_trace_s));
+	}
+
+	sched_unlock();
+
+	hdr->magic = MM_TRACE_MAGIC;
+	hdr->version = MM_TRACE_VERSION;
+	hdr->recsize = sizeof(struct mm_trace_s);
+	hdr->nrecords = n;
+	hdr->nlost = count - n;
+	hdr->usecpertick = USEC_PER_TICK;
+	return n;
+}
+
+#endif							/* CONFIG_MM_TRACE */
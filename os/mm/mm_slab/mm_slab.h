@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_slab/mm_slab.h
+ ****************************************************************************/
+
+#ifndef __MM_MM_SLAB_MM_SLAB_H
+#define __MM_MM_SLAB_MM_SLAB_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <queue.h>
+
+#include <tinyara/mm/slab.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SLAB_SIZE       CONFIG_MM_SLAB_SIZE
+#define SLAB_MASK       (~((uintptr_t)SLAB_SIZE - 1))
+
+/* Map an object to the slab that holds it */
+
+#define SLAB_OF(obj)    ((FAR struct mm_slab_s *)((uintptr_t)(obj) & SLAB_MASK))
+
+/* A free object holds the link to the next free object of its slab */
+
+#define SLAB_LINK(obj)  (*(FAR void **)(obj))
+
+#if (SLAB_SIZE & (SLAB_SIZE - 1)) != 0
+#error CONFIG_MM_SLAB_SIZE must be a power of two
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The header at the start of each slab.  The objects follow it, beginning
+ * at cache->offset.
+ */
+
+struct mm_slab_s {
+	dq_entry_t link;			/* Link in cache->partial */
+	FAR struct slab_cache_s *cache;	/* The cache owning this slab */
+	FAR void *freelist;			/* First free object in this slab */
+	uint16_t inuse;				/* Number of allocated objects */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The list of all caches */
+
+extern sq_queue_t g_slabcaches;
+
+#endif							/* __MM_MM_SLAB_MM_SLAB_H */
@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_slab/mm_slaballoc.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/mm/slab.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_grow
+ *
+ * Description:
+ *   Allocate a new slab from the kernel heap and thread all of its objects
+ *   onto the slab free list.  The slab is not yet linked into the cache.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_slab_s *slab_grow(FAR struct slab_cache_s *cache)
+{
+	FAR struct mm_slab_s *slab;
+	FAR uint8_t *obj;
+	int i;
+
+	slab = (FAR struct mm_slab_s *)kmm_memalign(SLAB_SIZE, SLAB_SIZE);
+	if (slab == NULL) {
+		mdbg("ERROR: %s: no memory for a new slab\n", cache->name);
+		return NULL;
+	}
+
+	slab->cache = cache;
+	slab->inuse = 0;
+	slab->freelist = NULL;
+
+	/* Thread the objects in reverse so that they are handed out in address
+	 * order.
+	 */
+
+	obj = (FAR uint8_t *)slab + cache->offset + (cache->perslab - 1) * cache->objsize;
+	for (i = 0; i < cache->perslab; i++) {
+		SLAB_LINK(obj) = slab->freelist;
+		slab->freelist = obj;
+		obj -= cache->objsize;
+	}
+
+	return slab;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_cache_alloc
+ *
+ * Description:
+ *   Allocate one object from the cache.  See include/tinyara/mm/slab.h.
+ *
+ ****************************************************************************/
+
+FAR void *slab_cache_alloc(FAR struct slab_cache_s *cache)
+{
+	FAR struct mm_slab_s *slab;
+	FAR void *obj;
+	irqstate_t flags;
+
+	DEBUGASSERT(cache != NULL && cache->perslab > 0);
+
+	flags = irqsave();
+	if (dq_peek(&cache->partial) == NULL) {
+		/* The cache is exhausted.  Growing it needs the heap, which cannot
+		 * be used at interrupt level.  The heap is used with interrupts
+		 * enabled; another thread may refill the cache meanwhile, in which
+		 * case the cache simply ends up with a spare slab.
+		 */
+
+		if (!up_interrupt_context()) {
+			irqrestore(flags);
+			slab = slab_grow(cache);
+			flags = irqsave();
+
+			if (slab != NULL) {
+				dq_addlast(&slab->link, &cache->partial);
+				cache->nslabs++;
+				cache->nfree += cache->perslab;
+			}
+		}
+
+		if (dq_peek(&cache->partial) == NULL) {
+			cache->nfails++;
+			irqrestore(flags);
+			return NULL;
+		}
+	}
+
+	/* Take the first free object of the first slab that has one */
+
+	slab = (FAR struct mm_slab_s *)dq_peek(&cache->partial);
+	obj = slab->freelist;
+	slab->freelist = SLAB_LINK(obj);
+	if (++slab->inuse == cache->perslab) {
+		dq_rem(&slab->link, &cache->partial);
+	}
+
+	cache->nfree--;
+	cache->nallocs++;
+	if (++cache->inuse > cache->peak) {
+		cache->peak = cache->inuse;
+	}
+
+	irqrestore(flags);
+
+	if (cache->ctor != NULL) {
+		cache->ctor(obj);
+	}
+
+	return obj;
+}
+
+#endif							/* CONFIG_MM_SLAB */
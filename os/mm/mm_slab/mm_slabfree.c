@@ -0,0 +1,141 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_slab/mm_slabfree.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/mm/slab.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_cache_free
+ *
+ * Description:
+ *   Return an object to its cache.  See include/tinyara/mm/slab.h.
+ *
+ ****************************************************************************/
+
+void slab_cache_free(FAR struct slab_cache_s *cache, FAR void *obj)
+{
+	FAR struct mm_slab_s *slab;
+	irqstate_t flags;
+
+	if (obj == NULL) {
+		return;
+	}
+
+	slab = SLAB_OF(obj);
+	DEBUGASSERT(slab->cache == cache && slab->inuse > 0);
+
+	flags = irqsave();
+
+	SLAB_LINK(obj) = slab->freelist;
+	slab->freelist = obj;
+
+	/* A full slab is not on the partial list; it is again now */
+
+	if (slab->inuse-- == cache->perslab) {
+		dq_addlast(&slab->link, &cache->partial);
+	}
+
+	cache->nfree++;
+	cache->inuse--;
+
+	/* Give an empty slab back to the heap, but only if the cache keeps at
+	 * least one more slab's worth of free objects so that an allocation
+	 * pattern oscillating around a slab boundary does not go to the heap
+	 * every time.  The heap cannot be used at interrupt level; an empty slab
+	 * left behind there is reused or released later.
+	 */
+
+	if (slab->inuse == 0 && cache->nfree >= 2 * cache->perslab && !up_interrupt_context()) {
+		dq_rem(&slab->link, &cache->partial);
+		cache->nslabs--;
+		cache->nfree -= cache->perslab;
+		irqrestore(flags);
+
+		kmm_free(slab);
+		return;
+	}
+
+	irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: slab_cache_shrink
+ *
+ * Description:
+ *   Release all empty slabs.  See include/tinyara/mm/slab.h.
+ *
+ ****************************************************************************/
+
+int slab_cache_shrink(FAR struct slab_cache_s *cache)
+{
+	FAR struct mm_slab_s *slab;
+	irqstate_t flags;
+	int nreleased = 0;
+
+	DEBUGASSERT(cache != NULL && !up_interrupt_context());
+
+	for (;;) {
+		/* Find an empty slab and unlink it with interrupts disabled, then
+		 * free it with interrupts enabled.
+		 */
+
+		flags = irqsave();
+		for (slab = (FAR struct mm_slab_s *)dq_peek(&cache->partial); slab != NULL; slab = (FAR struct mm_slab_s *)dq_next(&slab->link)) {
+			if (slab->inuse == 0) {
+				dq_rem(&slab->link, &cache->partial);
+				cache->nslabs--;
+				cache->nfree -= cache->perslab;
+				break;
+			}
+		}
+
+		irqrestore(flags);
+
+		if (slab == NULL) {
+			break;
+		}
+
+		kmm_free(slab);
+		nreleased++;
+	}
+
+	return nreleased;
+}
+
+#endif							/* CONFIG_MM_SLAB */
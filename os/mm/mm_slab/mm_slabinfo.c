@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_slab/mm_slabinfo.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <assert.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/mm/slab.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_foreach
+ *
+ * Description:
+ *   Report the statistics of every cache.  See include/tinyara/mm/slab.h.
+ *
+ ****************************************************************************/
+
+void slab_foreach(slab_handler_t handler, FAR void *arg)
+{
+	FAR struct slab_cache_s *cache;
+	struct slabinfo_s info;
+	irqstate_t flags;
+
+	DEBUGASSERT(handler != NULL);
+
+	flags = irqsave();
+	cache = (FAR struct slab_cache_s *)sq_peek(&g_slabcaches);
+
+	while (cache != NULL) {
+		/* Take a consistent snapshot, then call the handler with interrupts
+		 * enabled.
+		 */
+
+		info.name = cache->name;
+		info.objsize = cache->objsize;
+		info.perslab = cache->perslab;
+		info.nslabs = cache->nslabs;
+		info.inuse = cache->inuse;
+		info.peak = cache->peak;
+		info.nallocs = cache->nallocs;
+		info.nfails = cache->nfails;
+		irqrestore(flags);
+
+		handler(&info, arg);
+
+		flags = irqsave();
+		cache = cache->flink;
+	}
+
+	irqrestore(flags);
+}
+
+#endif							/* CONFIG_MM_SLAB */
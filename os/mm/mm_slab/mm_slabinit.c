@@ -0,0 +1,166 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_slab/mm_slabinit.c
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/mm/slab.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SLAB_ALIGN_UP(a, b)  (((a) + (b) - 1) & ~((b) - 1))
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The list of all caches */
+
+sq_queue_t g_slabcaches;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_cache_initialize
+ *
+ * Description:
+ *   Set up a caller-provided cache.  See include/tinyara/mm/slab.h.
+ *
+ ****************************************************************************/
+
+int slab_cache_initialize(FAR struct slab_cache_s *cache, FAR const char *name, size_t objsize, size_t align, slab_ctor_t ctor)
+{
+	irqstate_t flags;
+	size_t offset;
+
+	DEBUGASSERT(cache != NULL && name != NULL);
+
+	/* Every object must be able to hold the free list link */
+
+	if (align < sizeof(FAR void *)) {
+		align = sizeof(FAR void *);
+	}
+
+	if ((align & (align - 1)) != 0 || align >= SLAB_SIZE) {
+		return -EINVAL;
+	}
+
+	objsize = SLAB_ALIGN_UP(objsize < sizeof(FAR void *) ? sizeof(FAR void *) : objsize, align);
+	offset = SLAB_ALIGN_UP(sizeof(struct mm_slab_s), align);
+	if (offset + objsize > SLAB_SIZE) {
+		mdbg("ERROR: %s: %u byte objects do not fit in a slab\n", name, (unsigned int)objsize);
+		return -EINVAL;
+	}
+
+	memset(cache, 0, sizeof(struct slab_cache_s));
+	cache->name = name;
+	cache->ctor = ctor;
+	cache->objsize = (uint16_t)objsize;
+	cache->offset = (uint16_t)offset;
+	cache->perslab = (uint16_t)((SLAB_SIZE - offset) / objsize);
+	dq_init(&cache->partial);
+
+	flags = irqsave();
+	sq_addlast((FAR sq_entry_t *)cache, &g_slabcaches);
+	irqrestore(flags);
+
+	mvdbg("%s: objsize=%u perslab=%u\n", name, cache->objsize, cache->perslab);
+	return OK;
+}
+
+/****************************************************************************
+ * Name: slab_cache_create
+ *
+ * Description:
+ *   Allocate and set up a cache.  See include/tinyara/mm/slab.h.
+ *
+ ****************************************************************************/
+
+FAR struct slab_cache_s *slab_cache_create(FAR const char *name, size_t objsize, size_t align, slab_ctor_t ctor)
+{
+	FAR struct slab_cache_s *cache;
+
+	cache = (FAR struct slab_cache_s *)kmm_malloc(sizeof(struct slab_cache_s));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	if (slab_cache_initialize(cache, name, objsize, align, ctor) < 0) {
+		kmm_free(cache);
+		return NULL;
+	}
+
+	cache->dynamic = true;
+	return cache;
+}
+
+/****************************************************************************
+ * Name: slab_cache_destroy
+ *
+ * Description:
+ *   Release a cache and all of its slabs.  See include/tinyara/mm/slab.h.
+ *
+ ****************************************************************************/
+
+int slab_cache_destroy(FAR struct slab_cache_s *cache)
+{
+	irqstate_t flags;
+
+	DEBUGASSERT(cache != NULL && !up_interrupt_context());
+
+	flags = irqsave();
+	if (cache->inuse != 0) {
+		irqrestore(flags);
+		return -EBUSY;
+	}
+
+	sq_rem((FAR sq_entry_t *)cache, &g_slabcaches);
+	irqrestore(flags);
+
+	(void)slab_cache_shrink(cache);
+	DEBUGASSERT(cache->nslabs == 0);
+
+	if (cache->dynamic) {
+		kmm_free(cache);
+	}
+
+	return OK;
+}
+
+#endif							/* CONFIG_MM_SLAB */
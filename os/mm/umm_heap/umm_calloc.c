@@ -99,7 +99,7 @@ FAR void *calloc(size_t n, size_t elem_size)
 {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 	ARCH_GET_RET_ADDRESS
-	return mm_calloc(USR_HEAP, n, elem_size, retaddr);
+	return mm_trace_alloc(USR_HEAP, MM_TRACE_ZALLOC, mm_calloc(USR_HEAP, n, elem_size, retaddr), 0, n * elem_size, retaddr);
 #else
 	return mm_calloc(USR_HEAP, n, elem_size);
 #endif
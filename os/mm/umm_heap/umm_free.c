@@ -102,6 +102,10 @@
 
 void free(FAR void *mem)
 {
+#ifdef CONFIG_MM_TRACE
+	ARCH_GET_RET_ADDRESS
+	mm_trace_free(USR_HEAP, mem, retaddr);
+#endif
 	mm_free(USR_HEAP, mem);
 }
 
@@ -149,7 +149,7 @@ FAR void *malloc(size_t size)
 #else
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 	ARCH_GET_RET_ADDRESS
-	return mm_malloc(USR_HEAP, size, retaddr);
+	return mm_trace_alloc(USR_HEAP, MM_TRACE_MALLOC, mm_malloc(USR_HEAP, size, retaddr), 0, size, retaddr);
 #else
 	return mm_malloc(USR_HEAP, size);
 #endif
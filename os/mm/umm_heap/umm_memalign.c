@@ -108,7 +108,7 @@ FAR void *memalign(size_t alignment, size_t size)
 {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 	ARCH_GET_RET_ADDRESS
-	return mm_memalign(USR_HEAP, alignment, size, retaddr);
+	return mm_trace_alloc(USR_HEAP, MM_TRACE_MEMALIGN, mm_memalign(USR_HEAP, alignment, size, retaddr), alignment, size, retaddr);
 #else
 	return mm_memalign(USR_HEAP, alignment, size);
 #endif
@@ -110,7 +110,7 @@ FAR void *realloc(FAR void *oldmem, size_t size)
 {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 	ARCH_GET_RET_ADDRESS
-	return mm_realloc(USR_HEAP, oldmem, size, retaddr);
+	return mm_trace_realloc(USR_HEAP, oldmem, size, retaddr);
 #else
 	return mm_realloc(USR_HEAP, oldmem, size);
 #endif
@@ -118,7 +118,7 @@ FAR void *zalloc(size_t size)
 	/* Use mm_zalloc() becuase it implements the clear */
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 	ARCH_GET_RET_ADDRESS
-	return mm_zalloc(USR_HEAP, size, retaddr);
+	return mm_trace_alloc(USR_HEAP, MM_TRACE_ZALLOC, mm_zalloc(USR_HEAP, size, retaddr), 0, size, retaddr);
 #else
 	return mm_zalloc(USR_HEAP, size);
 #endif
@@ -1352,10 +1352,13 @@ void do_write(struct api_msg_msg *msg)
 #if LWIP_TCPIP_CORE_LOCKING
 				msg->conn->flags &= ~NETCONN_FLAG_WRITE_DELAYED;
 				if (do_writemore(msg->conn) != ERR_OK) {
+					/* release the core as many times as this thread took it
+					   (net_lock()), tcpip_thread finishes the write */
+					u32_t depth;
 					LWIP_ASSERT("state!", msg->conn->state == NETCONN_WRITE);
-					UNLOCK_TCPIP_CORE();
+					depth = sys_arch_core_release();
 					sys_arch_sem_wait(&msg->conn->op_completed, 0);
-					LOCK_TCPIP_CORE();
+					sys_arch_core_restore(depth);
 					LWIP_ASSERT("state!", msg->conn->state == NETCONN_NONE);
 				}
 #else							/* LWIP_TCPIP_CORE_LOCKING */
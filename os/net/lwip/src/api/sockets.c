@@ -67,6 +67,12 @@
 #else
 #define NET_DEVNAME "wl0"
 #endif
+#elif defined(CONFIG_ARCH_SIM)
+#if LWIP_HAVE_LOOPIF
+#define NET_DEVNAME "en1"
+#else
+#define NET_DEVNAME "en0"
+#endif
 #else
 #error "undefined CONFIG_NET_<type>, check your .config"
 #endif
@@ -867,9 +873,7 @@ int lwip_sendto(int s, const void *data, size_t size, int flags, const struct so
 	u16_t short_size;
 	const struct sockaddr_in *to_in;
 	u16_t remote_port;
-#if !LWIP_TCPIP_CORE_LOCKING
 	struct netbuf buf;
-#endif
 
 	sock = get_socket(s);
 	if (!sock) {
@@ -891,73 +895,6 @@ int lwip_sendto(int s, const void *data, size_t size, int flags, const struct so
 	LWIP_ERROR("lwip_sendto: invalid address", (((to == NULL) && (tolen == 0)) || ((tolen == sizeof(struct sockaddr_in)) && ((to->sa_family) == AF_INET) && ((((mem_ptr_t)to) % 4) == 0))), sock_set_errno(sock, err_to_errno(ERR_ARG)); return -1;);
 	to_in = (const struct sockaddr_in *)(void *)to;
 
-#if LWIP_TCPIP_CORE_LOCKING
-	/* Should only be consider like a sample or a simple way to experiment this option (no check of "to" field...) */
-	{
-		struct pbuf *p;
-		ip_addr_t *remote_addr;
-
-#if LWIP_NETIF_TX_SINGLE_PBUF
-		p = pbuf_alloc(PBUF_TRANSPORT, short_size, PBUF_RAM);
-		if (p != NULL) {
-#if LWIP_CHECKSUM_ON_COPY
-			u16_t chksum = 0;
-			if (sock->conn->type != NETCONN_RAW) {
-				chksum = LWIP_CHKSUM_COPY(p->payload, data, short_size);
-			} else
-#endif							/* LWIP_CHECKSUM_ON_COPY */
-				MEMCPY(p->payload, data, size);
-#else							/* LWIP_NETIF_TX_SINGLE_PBUF */
-		p = pbuf_alloc(PBUF_TRANSPORT, short_size, PBUF_REF);
-		if (p != NULL) {
-			p->payload = (void *)data;
-#endif							/* LWIP_NETIF_TX_SINGLE_PBUF */
-
-			if (to_in != NULL) {
-				inet_addr_to_ipaddr_p(remote_addr, &to_in->sin_addr);
-				remote_port = ntohs(to_in->sin_port);
-			} else {
-				remote_addr = &sock->conn->pcb.ip->remote_ip;
-#if LWIP_UDP
-				if (NETCONNTYPE_GROUP(sock->conn->type) == NETCONN_UDP) {
-					remote_port = sock->conn->pcb.udp->remote_port;
-				} else
-#endif							/* LWIP_UDP */
-				{
-					remote_port = 0;
-				}
-			}
-
-			LOCK_TCPIP_CORE();
-			if (netconn_type(sock->conn) == NETCONN_RAW) {
-#if LWIP_RAW
-				err = sock->conn->last_err = raw_sendto(sock->conn->pcb.raw, p, remote_addr);
-#else							/* LWIP_RAW */
-				err = ERR_ARG;
-#endif							/* LWIP_RAW */
-			}
-#if LWIP_UDP && LWIP_RAW
-			else
-#endif							/* LWIP_UDP && LWIP_RAW */
-			{
-#if LWIP_UDP
-#if LWIP_CHECKSUM_ON_COPY && LWIP_NETIF_TX_SINGLE_PBUF
-				err = sock->conn->last_err = udp_sendto_chksum(sock->conn->pcb.udp, p, remote_addr, remote_port, 1, chksum);
-#else							/* LWIP_CHECKSUM_ON_COPY && LWIP_NETIF_TX_SINGLE_PBUF */
-				err = sock->conn->last_err = udp_sendto(sock->conn->pcb.udp, p, remote_addr, remote_port);
-#endif							/* LWIP_CHECKSUM_ON_COPY && LWIP_NETIF_TX_SINGLE_PBUF */
-#else							/* LWIP_UDP */
-				err = ERR_ARG;
-#endif							/* LWIP_UDP */
-			}
-			UNLOCK_TCPIP_CORE();
-
-			pbuf_free(p);
-		} else {
-			err = ERR_MEM;
-		}
-	}
-#else							/* LWIP_TCPIP_CORE_LOCKING */
 	/* initialize a buffer */
 	buf.p = buf.ptr = NULL;
 #if LWIP_CHECKSUM_ON_COPY
@@ -1004,7 +941,6 @@ int lwip_sendto(int s, const void *data, size_t size, int flags, const struct so
 
 	/* deallocated the buffer */
 	netbuf_free(&buf);
-#endif							/* LWIP_TCPIP_CORE_LOCKING */
 	sock_set_errno(sock, err_to_errno(err));
 	return (err == ERR_OK ? short_size : -1);
 }
@@ -1978,7 +1914,14 @@ int lwip_getsockopt(int s, int level, int optname, void * optval, socklen_t * op
 	data.optval = optval;
 	data.optlen = optlen;
 	data.err = err;
+#if LWIP_TCPIP_CORE_LOCKING
+	LOCK_TCPIP_CORE();
+	lwip_getsockopt_internal(&data);
+	UNLOCK_TCPIP_CORE();
+#else
 	tcpip_callback(lwip_getsockopt_internal, &data);
+#endif
+	/* lwip_getsockopt_internal signals op_completed when done */
 	sys_arch_sem_wait(&sock->conn->op_completed, 0);
 	/* maybe lwip_getsockopt_internal has changed err */
 	err = data.err;
@@ -2376,7 +2319,14 @@ int lwip_setsockopt(int s, int level, int optname, const void * optval, socklen_
 	data.optval = (void *)optval;
 	data.optlen = &optlen;
 	data.err = err;
+#if LWIP_TCPIP_CORE_LOCKING
+	LOCK_TCPIP_CORE();
+	lwip_setsockopt_internal(&data);
+	UNLOCK_TCPIP_CORE();
+#else
 	tcpip_callback(lwip_setsockopt_internal, &data);
+#endif
+	/* lwip_setsockopt_internal signals op_completed when done */
 	sys_arch_sem_wait(&sock->conn->op_completed, 0);
 	/* maybe lwip_setsockopt_internal has changed err */
 	err = data.err;
@@ -73,10 +73,79 @@ static tcpip_init_done_fn tcpip_init_done;
 static void *tcpip_init_done_arg;
 static sys_mbox_t mbox;
 
-#if LWIP_TCPIP_CORE_LOCKING
-/** The global semaphore to lock the stack. */
-sys_mutex_t lock_tcpip_core;
-#endif							/* LWIP_TCPIP_CORE_LOCKING */
+/**
+ * Handle one message posted to tcpip_thread. The lwIP core is locked.
+ *
+ * @param msg the message to handle
+ */
+static void tcpip_thread_handle_msg(struct tcpip_msg *msg)
+{
+	if (msg == NULL) {
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: invalid message: NULL\n"));
+		LWIP_ASSERT("tcpip_thread: invalid message", 0);
+		return;
+	}
+
+	switch (msg->type) {
+#if LWIP_NETCONN
+	case TCPIP_MSG_API:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: API message %p\n", (void *)msg));
+		msg->msg.apimsg->function(&(msg->msg.apimsg->msg));
+		break;
+#endif							/* LWIP_NETCONN */
+
+#if !LWIP_TCPIP_CORE_LOCKING_INPUT
+	case TCPIP_MSG_INPKT:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: PACKET %p\n", (void *)msg));
+#if LWIP_ETHERNET
+		if (msg->msg.inp.netif->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET)) {
+			ethernet_input(msg->msg.inp.p, msg->msg.inp.netif);
+		} else
+#endif							/* LWIP_ETHERNET */
+		{
+			ip_input(msg->msg.inp.p, msg->msg.inp.netif);
+		}
+		memp_free(MEMP_TCPIP_MSG_INPKT, msg);
+		break;
+#endif							/* LWIP_TCPIP_CORE_LOCKING_INPUT */
+
+#if LWIP_NETIF_API
+	case TCPIP_MSG_NETIFAPI:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: Netif API message %p\n", (void *)msg));
+		msg->msg.netifapimsg->function(&(msg->msg.netifapimsg->msg));
+		break;
+#endif							/* LWIP_NETIF_API */
+
+#if LWIP_TCPIP_TIMEOUT
+	case TCPIP_MSG_TIMEOUT:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: TIMEOUT %p\n", (void *)msg));
+		sys_timeout(msg->msg.tmo.msecs, msg->msg.tmo.h, msg->msg.tmo.arg);
+		memp_free(MEMP_TCPIP_MSG_API, msg);
+		break;
+	case TCPIP_MSG_UNTIMEOUT:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: UNTIMEOUT %p\n", (void *)msg));
+		sys_untimeout(msg->msg.tmo.h, msg->msg.tmo.arg);
+		memp_free(MEMP_TCPIP_MSG_API, msg);
+		break;
+#endif							/* LWIP_TCPIP_TIMEOUT */
+
+	case TCPIP_MSG_CALLBACK:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: CALLBACK %p\n", (void *)msg));
+		msg->msg.cb.function(msg->msg.cb.ctx);
+		memp_free(MEMP_TCPIP_MSG_API, msg);
+		break;
+
+	case TCPIP_MSG_CALLBACK_STATIC:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: CALLBACK_STATIC %p\n", (void *)msg));
+		msg->msg.cb.function(msg->msg.cb.ctx);
+		break;
+
+	default:
+		LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: invalid message: %d\n", msg->type));
+		LWIP_ASSERT("tcpip_thread: invalid message", 0);
+		break;
+	}
+}
 
 /**
  * The main lwIP thread. This thread has exclusive access to lwIP core functions
@@ -92,6 +161,11 @@ static void tcpip_thread(void *arg)
 {
 
 	struct tcpip_msg *msg = NULL;
+#if TCPIP_MBOX_BATCH > 1
+	struct tcpip_msg *batch[TCPIP_MBOX_BATCH];
+	u32_t nbatch;
+	u32_t i;
+#endif
 	LWIP_DEBUGF(TCPIP_DEBUG, ("NULL == msg %d \n", NULL == msg));
 	LWIP_UNUSED_ARG(arg);
 	//LWIP_DEBUGF(TCPIP_DEBUG,("Entry \n"));
@@ -107,72 +181,16 @@ static void tcpip_thread(void *arg)
 		sys_timeouts_mbox_fetch(&mbox, (void **)&msg);
 
 		LOCK_TCPIP_CORE();
-
-		if (msg == NULL) {
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: invalid message: NULL\n"));
-			LWIP_ASSERT("tcpip_thread: invalid message", 0);
-			continue;
-		}
-
-		switch (msg->type) {
-#if LWIP_NETCONN
-		case TCPIP_MSG_API:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: API message %p\n", (void *)msg));
-			msg->msg.apimsg->function(&(msg->msg.apimsg->msg));
-			break;
-#endif							/* LWIP_NETCONN */
-
-#if !LWIP_TCPIP_CORE_LOCKING_INPUT
-		case TCPIP_MSG_INPKT:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: PACKET %p\n", (void *)msg));
-#if LWIP_ETHERNET
-			if (msg->msg.inp.netif->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET)) {
-				ethernet_input(msg->msg.inp.p, msg->msg.inp.netif);
-			} else
-#endif							/* LWIP_ETHERNET */
-			{
-				ip_input(msg->msg.inp.p, msg->msg.inp.netif);
-			}
-			memp_free(MEMP_TCPIP_MSG_INPKT, msg);
-			break;
-#endif							/* LWIP_TCPIP_CORE_LOCKING_INPUT */
-
-#if LWIP_NETIF_API
-		case TCPIP_MSG_NETIFAPI:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: Netif API message %p\n", (void *)msg));
-			msg->msg.netifapimsg->function(&(msg->msg.netifapimsg->msg));
-			break;
-#endif							/* LWIP_NETIF_API */
-
-#if LWIP_TCPIP_TIMEOUT
-		case TCPIP_MSG_TIMEOUT:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: TIMEOUT %p\n", (void *)msg));
-			sys_timeout(msg->msg.tmo.msecs, msg->msg.tmo.h, msg->msg.tmo.arg);
-			memp_free(MEMP_TCPIP_MSG_API, msg);
-			break;
-		case TCPIP_MSG_UNTIMEOUT:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: UNTIMEOUT %p\n", (void *)msg));
-			sys_untimeout(msg->msg.tmo.h, msg->msg.tmo.arg);
-			memp_free(MEMP_TCPIP_MSG_API, msg);
-			break;
-#endif							/* LWIP_TCPIP_TIMEOUT */
-
-		case TCPIP_MSG_CALLBACK:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: CALLBACK %p\n", (void *)msg));
-			msg->msg.cb.function(msg->msg.cb.ctx);
-			memp_free(MEMP_TCPIP_MSG_API, msg);
-			break;
-
-		case TCPIP_MSG_CALLBACK_STATIC:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: CALLBACK_STATIC %p\n", (void *)msg));
-			msg->msg.cb.function(msg->msg.cb.ctx);
-			break;
-
-		default:
-			LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: invalid message: %d\n", msg->type));
-			LWIP_ASSERT("tcpip_thread: invalid message", 0);
-			break;
+		tcpip_thread_handle_msg(msg);
+
+#if TCPIP_MBOX_BATCH > 1
+		/* handle the messages posted meanwhile without sleeping again,
+		   the timeouts are checked before the next batch */
+		nbatch = sys_arch_mbox_tryfetch_batch(&mbox, (void **)batch, TCPIP_MBOX_BATCH);
+		for (i = 0; i < nbatch; i++) {
+			tcpip_thread_handle_msg(batch[i]);
 		}
+#endif
 	}
 }
 
@@ -327,18 +345,36 @@ err_t tcpip_untimeout(sys_timeout_handler h, void *arg)
  * This function is then running in the thread context
  * of tcpip_thread and has exclusive access to lwIP core code.
  *
+ * With LWIP_TCPIP_CORE_LOCKING, the function is called in the calling thread
+ * with the core locked instead. It signals op_completed when the operation
+ * is done, maybe later from tcpip_thread, which is waited for with the core
+ * unlocked.
+ *
  * @param apimsg a struct containing the function to call and its parameters
  * @return ERR_OK if the function was called, another err_t if not
  */
 err_t tcpip_apimsg(struct api_msg *apimsg)
 {
 	//LWIP_DEBUGF(TCPIP_DEBUG, ("Entry"));
+#if LWIP_TCPIP_CORE_LOCKING
+	u32_t depth;
+#else
 	struct tcpip_msg msg;
+#endif
 #ifdef LWIP_DEBUG
 	/* catch functions that don't set err */
 	apimsg->msg.err = ERR_VAL;
 #endif
 
+#if LWIP_TCPIP_CORE_LOCKING
+	LOCK_TCPIP_CORE();
+	apimsg->function(&(apimsg->msg));
+	depth = sys_arch_core_release();
+	sys_arch_sem_wait(&apimsg->msg.conn->op_completed, 0);
+	sys_arch_core_restore(depth);
+	UNLOCK_TCPIP_CORE();
+	return apimsg->msg.err;
+#else
 	if (sys_mbox_valid(&mbox)) {
 		msg.type = TCPIP_MSG_API;
 		msg.msg.apimsg = apimsg;
@@ -349,6 +385,7 @@ err_t tcpip_apimsg(struct api_msg *apimsg)
 	}
 	//LWIP_DEBUGF(TCPIP_DEBUG, ("Exit Fail"));
 	return ERR_VAL;
+#endif							/* LWIP_TCPIP_CORE_LOCKING */
 }
 
 #if LWIP_TCPIP_CORE_LOCKING
@@ -487,11 +524,6 @@ void tcpip_init(tcpip_init_done_fn initfunc, void *arg)
 		LWIP_ASSERT("failed to create tcpip_thread mbox", 0);
 	}
 	//LWIP_DEBUGF(TCPIP_DEBUG, ("mbox created"));
-#if LWIP_TCPIP_CORE_LOCKING
-	if (sys_mutex_new(&lock_tcpip_core) != ERR_OK) {
-		LWIP_ASSERT("failed to create lock_tcpip_core", 0);
-	}
-#endif							/* LWIP_TCPIP_CORE_LOCKING */
 	//LWIP_DEBUGF(TCPIP_DEBUG, ("creating new thread for tcpip"));
 	sys_kernel_thread_new(TCPIP_THREAD_NAME, tcpip_thread, NULL, TCPIP_THREAD_STACKSIZE, TCPIP_THREAD_PRIO);
 	//LWIP_DEBUGF(TCPIP_DEBUG, ("Exit"));
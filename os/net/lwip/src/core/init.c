@@ -125,8 +125,17 @@
 #error "MEMP_NUM_REASSDATA > IP_REASS_MAX_PBUFS doesn't make sense since each struct ip_reassdata must hold 2 pbufs at least!"
 #endif
 #endif							/* !MEMP_MEM_MALLOC */
-#if (LWIP_TCP && (TCP_WND > 0xffff))
-#error "If you want to use TCP, TCP_WND must fit in an u16_t, so, you have to reduce it in your lwipopts.h"
+#if (LWIP_TCP && !LWIP_WND_SCALE && (TCP_WND > 0xffff))
+#error "If you want to use TCP, TCP_WND must fit in an u16_t, so, you have to reduce it in your lwipopts.h (or enable LWIP_WND_SCALE)"
+#endif
+#if (LWIP_TCP && LWIP_WND_SCALE && ((TCP_RCV_SCALE > 14) || (TCP_WND > (0xffffUL << TCP_RCV_SCALE)) || ((TCP_WND >> TCP_RCV_SCALE) == 0)))
+#error "TCP_RCV_SCALE must be 0..14, TCP_WND must not exceed (0xffff << TCP_RCV_SCALE) and must be at least (1 << TCP_RCV_SCALE)"
+#endif
+#if (LWIP_TCP && (TCP_SND_BUF > 0xffff))
+#error "If you want to use TCP, TCP_SND_BUF must fit in an u16_t, so, you have to reduce it in your lwipopts.h"
+#endif
+#if (LWIP_TCP && LWIP_TCP_SACK && ((LWIP_TCP_MAX_SACK_NUM < 1) || (LWIP_TCP_MAX_SACK_NUM > 4)))
+#error "LWIP_TCP_MAX_SACK_NUM must be 1..4"
 #endif
 #if (LWIP_TCP && (TCP_SND_QUEUELEN > 0xffff))
 #error "If you want to use TCP, TCP_SND_QUEUELEN must fit in an u16_t, so, you have to reduce it in your lwipopts.h"
@@ -140,6 +149,12 @@
 #if (LWIP_TCP && TCP_LISTEN_BACKLOG && (TCP_DEFAULT_LISTEN_BACKLOG < 0) || (TCP_DEFAULT_LISTEN_BACKLOG > 0xff))
 #error "If you want to use TCP backlog, TCP_DEFAULT_LISTEN_BACKLOG must fit into an u8_t"
 #endif
+#if (LWIP_TCP && ((TCP_PCB_HASH_SIZE < 1) || (TCP_PCB_HASH_SIZE & (TCP_PCB_HASH_SIZE - 1))))
+#error "TCP_PCB_HASH_SIZE must be a power of 2"
+#endif
+#if (LWIP_UDP && ((UDP_PCB_HASH_SIZE < 1) || (UDP_PCB_HASH_SIZE & (UDP_PCB_HASH_SIZE - 1))))
+#error "UDP_PCB_HASH_SIZE must be a power of 2"
+#endif
 #if (LWIP_NETIF_API && (NO_SYS == 1))
 #error "If you want to use NETIF API, you have to define NO_SYS=0 in your lwipopts.h"
 #endif
@@ -404,6 +404,7 @@ struct pbuf *pbuf_alloced_custom(pbuf_layer l, u16_t length, pbuf_type type, str
 	} else {
 		p->pbuf.payload = NULL;
 	}
+	p->payload_mem = payload_mem;
 	p->pbuf.flags = PBUF_FLAG_IS_CUSTOM;
 	p->pbuf.len = p->pbuf.tot_len = length;
 	p->pbuf.type = type;
@@ -553,6 +554,12 @@ u8_t pbuf_header(struct pbuf *p, s16_t header_size_increment)
 		if ((header_size_increment < 0) && (increment_magnitude <= p->len)) {
 			/* increase payload pointer */
 			p->payload = (u8_t *)p->payload - header_size_increment;
+#if LWIP_SUPPORT_CUSTOM_PBUF
+		} else if ((header_size_increment > 0) && ((p->flags & PBUF_FLAG_IS_CUSTOM) != 0) && (((struct pbuf_custom *)p)->payload_mem != NULL) && (increment_magnitude <= (u8_t *)p->payload - (u8_t *)((struct pbuf_custom *)p)->payload_mem)) {
+			/* show a header hidden in the buffer of a custom pbuf,
+			 * e.g. a frame received in a driver buffer */
+			p->payload = (u8_t *)p->payload - header_size_increment;
+#endif							/* LWIP_SUPPORT_CUSTOM_PBUF */
 		} else {
 			/* cannot expand payload to front (yet!)
 			 * bail out unsuccesfully */
@@ -131,6 +131,11 @@ struct tcp_pcb **const tcp_pcb_lists[] = { &tcp_listen_pcbs.pcbs, &tcp_bound_pcb
 		   &tcp_active_pcbs, &tcp_tw_pcbs
 };
 
+/** Hash tables of the PCBs in tcp_active_pcbs, tcp_tw_pcbs and tcp_listen_pcbs */
+struct tcp_pcb *tcp_active_hash[TCP_PCB_HASH_SIZE];
+struct tcp_pcb *tcp_tw_hash[TCP_PCB_HASH_SIZE];
+struct tcp_pcb *tcp_listen_hash[TCP_PCB_HASH_SIZE];
+
 /** Only used for temporary storage. */
 struct tcp_pcb *tcp_tmp_pcb;
 
@@ -187,7 +192,7 @@ static err_t tcp_close_shutdown(struct tcp_pcb *pcb, u8_t rst_on_unacked_data)
 	err_t err;
 
 	if (rst_on_unacked_data && ((pcb->state == ESTABLISHED) || (pcb->state == CLOSE_WAIT))) {
-		if ((pcb->refused_data != NULL) || (pcb->rcv_wnd != TCP_WND)) {
+		if ((pcb->refused_data != NULL) || (pcb->rcv_wnd != TCP_WND_MAX(pcb))) {
 			/* Not all data received by application, send RST to tell the remote
 			   side about this. */
 			LWIP_ASSERT("pcb->flags & TF_RXCLOSED", pcb->flags & TF_RXCLOSED);
@@ -596,8 +601,10 @@ u32_t tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb)
 		} else {
 			/* keep the right edge of window constant */
 			u32_t new_rcv_ann_wnd = pcb->rcv_ann_right_edge - pcb->rcv_nxt;
+#if !LWIP_WND_SCALE
 			LWIP_ASSERT("new_rcv_ann_wnd <= 0xffff", new_rcv_ann_wnd <= 0xffff);
-			pcb->rcv_ann_wnd = (u16_t)new_rcv_ann_wnd;
+#endif
+			pcb->rcv_ann_wnd = (tcpwnd_size_t)new_rcv_ann_wnd;
 		}
 		return 0;
 	}
@@ -617,11 +624,13 @@ void tcp_recved(struct tcp_pcb *pcb, u16_t len)
 
 	/* pcb->state LISTEN not allowed here */
 	LWIP_ASSERT("don't call tcp_recved for listen-pcbs", pcb->state != LISTEN);
+#if !LWIP_WND_SCALE
 	LWIP_ASSERT("tcp_recved: len would wrap rcv_wnd\n", len <= 0xffff - pcb->rcv_wnd);
+#endif
 
 	pcb->rcv_wnd += len;
-	if (pcb->rcv_wnd > TCP_WND) {
-		pcb->rcv_wnd = TCP_WND;
+	if (pcb->rcv_wnd > TCP_WND_MAX(pcb)) {
+		pcb->rcv_wnd = TCP_WND_MAX(pcb);
 	}
 
 	wnd_inflation = tcp_update_rcv_ann_wnd(pcb);
@@ -635,7 +644,7 @@ void tcp_recved(struct tcp_pcb *pcb, u16_t len)
 		tcp_output(pcb);
 	}
 
-	LWIP_DEBUGF(TCP_DEBUG, ("tcp_recved: recveived %" U16_F " bytes, wnd %" U16_F " (%" U16_F ").\n", len, pcb->rcv_wnd, TCP_WND - pcb->rcv_wnd));
+	LWIP_DEBUGF(TCP_DEBUG, ("tcp_recved: recveived %" U16_F " bytes, wnd %" TCPWNDSIZE_F " (%" TCPWNDSIZE_F ").\n", len, pcb->rcv_wnd, (tcpwnd_size_t)(TCP_WND_MAX(pcb) - pcb->rcv_wnd)));
 }
 
 /**
@@ -737,8 +746,8 @@ err_t tcp_connect(struct tcp_pcb *pcb, ip_addr_t *ipaddr, u16_t port, tcp_connec
 	pcb->snd_nxt = iss;
 	pcb->lastack = iss - 1;
 	pcb->snd_lbb = iss - 1;
-	pcb->rcv_wnd = TCP_WND;
-	pcb->rcv_ann_wnd = TCP_WND;
+	pcb->rcv_wnd = TCPWND_MIN16(TCP_WND);
+	pcb->rcv_ann_wnd = TCPWND_MIN16(TCP_WND);
 	pcb->rcv_ann_right_edge = pcb->rcv_nxt;
 	pcb->snd_wnd = TCP_WND;
 	/* As initial send MSS, we use TCP_MSS but limit it to 536.
@@ -781,7 +790,7 @@ err_t tcp_connect(struct tcp_pcb *pcb, ip_addr_t *ipaddr, u16_t port, tcp_connec
 void tcp_slowtmr(void)
 {
 	struct tcp_pcb *pcb, *prev;
-	u16_t eff_wnd;
+	tcpwnd_size_t eff_wnd;
 	u8_t pcb_remove;			/* flag if a PCB should be removed */
 	u8_t pcb_reset;				/* flag if a RST should be sent when removing */
 	err_t err;
@@ -857,7 +866,7 @@ tcp_slowtmr_start:
 						pcb->ssthresh = (pcb->mss << 1);
 					}
 					pcb->cwnd = pcb->mss;
-					LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: cwnd %" U16_F " ssthresh %" U16_F "\n", pcb->cwnd, pcb->ssthresh));
+					LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: cwnd %" TCPWNDSIZE_F " ssthresh %" TCPWNDSIZE_F "\n", pcb->cwnd, pcb->ssthresh));
 
 					/* The following needs to be called AFTER cwnd is set to one
 					   mss - STJ */
@@ -925,6 +934,7 @@ tcp_slowtmr_start:
 			tcp_err_fn err_fn;
 			void *err_arg;
 			tcp_pcb_purge(pcb);
+			tcp_pcb_hash_remove(&tcp_active_pcbs, pcb);
 			/* Remove PCB from tcp_active_pcbs list. */
 			if (prev != NULL) {
 				LWIP_ASSERT("tcp_slowtmr: middle tcp != tcp_active_pcbs", pcb != tcp_active_pcbs);
@@ -989,6 +999,7 @@ tcp_slowtmr_start:
 		if (pcb_remove) {
 			struct tcp_pcb *pcb2;
 			tcp_pcb_purge(pcb);
+			tcp_pcb_hash_remove(&tcp_tw_pcbs, pcb);
 			/* Remove PCB from tcp_tw_pcbs list. */
 			if (prev != NULL) {
 				LWIP_ASSERT("tcp_slowtmr: middle tcp != tcp_tw_pcbs", pcb != tcp_tw_pcbs);
@@ -1068,7 +1079,7 @@ err_t tcp_process_refused_data(struct tcp_pcb *pcb)
 		if (refused_flags & PBUF_FLAG_TCP_FIN) {
 			/* correct rcv_wnd as the application won't call tcp_recved()
 			   for the FIN's seqno */
-			if (pcb->rcv_wnd != TCP_WND) {
+			if (pcb->rcv_wnd != TCP_WND_MAX(pcb)) {
 				pcb->rcv_wnd++;
 			}
 			TCP_EVENT_CLOSED(pcb, err);
@@ -1265,8 +1276,10 @@ struct tcp_pcb *tcp_alloc(u8_t prio)
 		pcb->prio = prio;
 		pcb->snd_buf = TCP_SND_BUF;
 		pcb->snd_queuelen = 0;
-		pcb->rcv_wnd = TCP_WND;
-		pcb->rcv_ann_wnd = TCP_WND;
+		/* Until window scaling is negotiated, the receive window must
+		   fit in the 16-bit window field */
+		pcb->rcv_wnd = TCPWND_MIN16(TCP_WND);
+		pcb->rcv_ann_wnd = TCPWND_MIN16(TCP_WND);
 		pcb->tos = 0;
 		pcb->ttl = TCP_TTL;
 		/* As initial send MSS, we use TCP_MSS but limit it to 536.
@@ -1501,6 +1514,79 @@ void tcp_pcb_remove(struct tcp_pcb **pcblist, struct tcp_pcb *pcb)
 	LWIP_ASSERT("tcp_pcb_remove: tcp_pcbs_sane()", tcp_pcbs_sane());
 }
 
+/**
+ * Calculates the bucket of a connection in tcp_active_hash and tcp_tw_hash.
+ *
+ * @param remote_ip remote IP address of the connection
+ * @param remote_port remote port of the connection
+ * @param local_port local port of the connection
+ * @return index of the bucket
+ */
+u16_t tcp_pcb_hash(ip_addr_t *remote_ip, u16_t remote_port, u16_t local_port)
+{
+	u32_t h;
+
+	h = ip4_addr_get_u32(remote_ip) ^ (((u32_t)remote_port << 16) | local_port);
+	h ^= h >> 16;
+	h ^= h >> 8;
+	return (u16_t)(h & (TCP_PCB_HASH_SIZE - 1));
+}
+
+/**
+ * Returns the bucket of the hash table of a PCB list that pcb belongs in,
+ * or NULL if the list is not hashed.
+ */
+static struct tcp_pcb **tcp_pcb_hash_bucket(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+	if (pcbs == &tcp_active_pcbs) {
+		return &tcp_active_hash[tcp_pcb_hash(&pcb->remote_ip, pcb->remote_port, pcb->local_port)];
+	} else if (pcbs == &tcp_tw_pcbs) {
+		return &tcp_tw_hash[tcp_pcb_hash(&pcb->remote_ip, pcb->remote_port, pcb->local_port)];
+	} else if (pcbs == &tcp_listen_pcbs.pcbs) {
+		return &tcp_listen_hash[TCP_LISTEN_HASH(pcb->local_port)];
+	}
+	return NULL;
+}
+
+/**
+ * Adds a PCB to the hash table of the list it has just been added to.
+ * Called by TCP_REG, the local and remote addresses and ports must be set.
+ *
+ * @param pcbs PCB list the pcb has been added to
+ * @param pcb tcp_pcb to add
+ */
+void tcp_pcb_hash_add(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+	struct tcp_pcb **bucket = tcp_pcb_hash_bucket(pcbs, pcb);
+
+	if (bucket != NULL) {
+		pcb->hash_next = *bucket;
+		*bucket = pcb;
+	}
+}
+
+/**
+ * Removes a PCB from the hash table of the list it is removed from.
+ *
+ * @param pcbs PCB list the pcb is removed from
+ * @param pcb tcp_pcb to remove
+ */
+void tcp_pcb_hash_remove(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+	struct tcp_pcb **bucket = tcp_pcb_hash_bucket(pcbs, pcb);
+
+	if (bucket == NULL) {
+		return;
+	}
+	for (; *bucket != NULL; bucket = &(*bucket)->hash_next) {
+		if (*bucket == pcb) {
+			*bucket = pcb->hash_next;
+			pcb->hash_next = NULL;
+			return;
+		}
+	}
+}
+
 /**
  * Calculates a new initial sequence number for new connections.
  *
@@ -86,12 +86,23 @@ static u16_t tcplen;
 static u8_t recv_flags;
 static struct pbuf *recv_data;
 
+#if LWIP_TCP_SACK
+/* SACK blocks of the incoming segment, set by tcp_parseopt() */
+#define TCP_SACK_MAX_BLOCKS 4
+static u32_t sack_left[TCP_SACK_MAX_BLOCKS];
+static u32_t sack_right[TCP_SACK_MAX_BLOCKS];
+static u8_t sack_num;
+#endif							/* LWIP_TCP_SACK */
+
 struct tcp_pcb *tcp_input_pcb;
 
 /* Forward declarations. */
 static err_t tcp_process(struct tcp_pcb *pcb);
 static void tcp_receive(struct tcp_pcb *pcb);
 static void tcp_parseopt(struct tcp_pcb *pcb);
+#if LWIP_TCP_SACK
+static void tcp_sack_mark(struct tcp_pcb *pcb);
+#endif
 
 static err_t tcp_listen_input(struct tcp_pcb_listen *pcb);
 static err_t tcp_timewait_input(struct tcp_pcb *pcb);
@@ -107,12 +118,12 @@ static err_t tcp_timewait_input(struct tcp_pcb *pcb);
  */
 void tcp_input(struct pbuf *p, struct netif *inp)
 {
-	struct tcp_pcb *pcb, *prev;
+	struct tcp_pcb *pcb;
 	struct tcp_pcb_listen *lpcb;
 #if SO_REUSE
-	struct tcp_pcb *lpcb_prev = NULL;
 	struct tcp_pcb_listen *lpcb_any = NULL;
 #endif							/* SO_REUSE */
+	u16_t hash;
 	u8_t hdrlen;
 	err_t err;
 
@@ -178,39 +189,26 @@ void tcp_input(struct pbuf *p, struct netif *inp)
 	tcplen = p->tot_len + ((flags & (TCP_FIN | TCP_SYN)) ? 1 : 0);
 
 	/* Demultiplex an incoming segment. First, we check if it is destined
-	   for an active connection. */
-	prev = NULL;
+	   for an active connection. Only the PCBs of the bucket of the
+	   connection in the hash tables are looked at. */
+	hash = tcp_pcb_hash(&current_iphdr_src, tcphdr->src, tcphdr->dest);
 
-	for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+	for (pcb = tcp_active_hash[hash]; pcb != NULL; pcb = pcb->hash_next) {
 		LWIP_ASSERT("tcp_input: active pcb->state != CLOSED", pcb->state != CLOSED);
 		LWIP_ASSERT("tcp_input: active pcb->state != TIME-WAIT", pcb->state != TIME_WAIT);
 		LWIP_ASSERT("tcp_input: active pcb->state != LISTEN", pcb->state != LISTEN);
 		if (pcb->remote_port == tcphdr->src && pcb->local_port == tcphdr->dest && ip_addr_cmp(&(pcb->remote_ip), &current_iphdr_src) && ip_addr_cmp(&(pcb->local_ip), &current_iphdr_dest)) {
-
-			/* Move this PCB to the front of the list so that subsequent
-			   lookups will be faster (we exploit locality in TCP segment
-			   arrivals). */
-			LWIP_ASSERT("tcp_input: pcb->next != pcb (before cache)", pcb->next != pcb);
-			if (prev != NULL) {
-				prev->next = pcb->next;
-				pcb->next = tcp_active_pcbs;
-				tcp_active_pcbs = pcb;
-			}
-			LWIP_ASSERT("tcp_input: pcb->next != pcb (after cache)", pcb->next != pcb);
+			LWIP_ASSERT("tcp_input: pcb->hash_next != pcb", pcb->hash_next != pcb);
 			break;
 		}
-		prev = pcb;
 	}
 
 	if (pcb == NULL) {
 		/* If it did not go to an active connection, we check the connections
 		   in the TIME-WAIT state. */
-		for (pcb = tcp_tw_pcbs; pcb != NULL; pcb = pcb->next) {
+		for (pcb = tcp_tw_hash[hash]; pcb != NULL; pcb = pcb->hash_next) {
 			LWIP_ASSERT("tcp_input: TIME-WAIT pcb->state == TIME-WAIT", pcb->state == TIME_WAIT);
 			if (pcb->remote_port == tcphdr->src && pcb->local_port == tcphdr->dest && ip_addr_cmp(&(pcb->remote_ip), &current_iphdr_src) && ip_addr_cmp(&(pcb->local_ip), &current_iphdr_dest)) {
-				/* We don't really care enough to move this PCB to the front
-				   of the list since we are not very likely to receive that
-				   many segments for connections in TIME-WAIT. */
 				LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for TIME_WAITing connection.\n"));
 				tcp_timewait_input(pcb);
 				pbuf_free(p);
@@ -218,10 +216,9 @@ void tcp_input(struct pbuf *p, struct netif *inp)
 			}
 		}
 
-		/* Finally, if we still did not get a match, we check all PCBs that
-		   are LISTENing for incoming connections. */
-		prev = NULL;
-		for (lpcb = tcp_listen_pcbs.listen_pcbs; lpcb != NULL; lpcb = lpcb->next) {
+		/* Finally, if we still did not get a match, we check the PCBs that
+		   are LISTENing for incoming connections on the destination port. */
+		for (lpcb = (struct tcp_pcb_listen *)tcp_listen_hash[TCP_LISTEN_HASH(tcphdr->dest)]; lpcb != NULL; lpcb = lpcb->hash_next) {
 			if (lpcb->local_port == tcphdr->dest) {
 #if SO_REUSE
 				if (ip_addr_cmp(&(lpcb->local_ip), &current_iphdr_dest)) {
@@ -230,7 +227,6 @@ void tcp_input(struct pbuf *p, struct netif *inp)
 				} else if (ip_addr_isany(&(lpcb->local_ip))) {
 					/* found an ANY-match */
 					lpcb_any = lpcb;
-					lpcb_prev = prev;
 				}
 #else							/* SO_REUSE */
 				if (ip_addr_cmp(&(lpcb->local_ip), &current_iphdr_dest) || ip_addr_isany(&(lpcb->local_ip))) {
@@ -239,28 +235,15 @@ void tcp_input(struct pbuf *p, struct netif *inp)
 				}
 #endif							/* SO_REUSE */
 			}
-			prev = (struct tcp_pcb *)lpcb;
 		}
 #if SO_REUSE
 		/* first try specific local IP */
 		if (lpcb == NULL) {
 			/* only pass to ANY if no specific local IP has been found */
 			lpcb = lpcb_any;
-			prev = lpcb_prev;
 		}
 #endif							/* SO_REUSE */
 		if (lpcb != NULL) {
-			/* Move this PCB to the front of the list so that subsequent
-			   lookups will be faster (we exploit locality in TCP segment
-			   arrivals). */
-			if (prev != NULL) {
-				((struct tcp_pcb_listen *)prev)->next = lpcb->next;
-				/* our successor is the remainder of the listening list */
-				lpcb->next = tcp_listen_pcbs.listen_pcbs;
-				/* put this listening pcb at the head of the listening list */
-				tcp_listen_pcbs.listen_pcbs = lpcb;
-			}
-
 			LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for LISTENing connection.\n"));
 			tcp_listen_input(lpcb);
 			pbuf_free(p);
@@ -372,7 +355,7 @@ void tcp_input(struct pbuf *p, struct netif *inp)
 					} else {
 						/* correct rcv_wnd as the application won't call tcp_recved()
 						   for the FIN's seqno */
-						if (pcb->rcv_wnd != TCP_WND) {
+						if (pcb->rcv_wnd != TCP_WND_MAX(pcb)) {
 							pcb->rcv_wnd++;
 						}
 						TCP_EVENT_CLOSED(pcb, err);
@@ -850,12 +833,12 @@ static void tcp_receive(struct tcp_pcb *pcb)
 		right_wnd_edge = pcb->snd_wnd + pcb->snd_wl2;
 
 		/* Update window. */
-		if (TCP_SEQ_LT(pcb->snd_wl1, seqno) || (pcb->snd_wl1 == seqno && TCP_SEQ_LT(pcb->snd_wl2, ackno)) || (pcb->snd_wl2 == ackno && tcphdr->wnd > pcb->snd_wnd)) {
-			pcb->snd_wnd = tcphdr->wnd;
+		if (TCP_SEQ_LT(pcb->snd_wl1, seqno) || (pcb->snd_wl1 == seqno && TCP_SEQ_LT(pcb->snd_wl2, ackno)) || (pcb->snd_wl2 == ackno && (u32_t)SND_WND_SCALE(pcb, tcphdr->wnd) > pcb->snd_wnd)) {
+			pcb->snd_wnd = SND_WND_SCALE(pcb, tcphdr->wnd);
 			/* keep track of the biggest window announced by the remote host to calculate
 			   the maximum segment size */
-			if (pcb->snd_wnd_max < tcphdr->wnd) {
-				pcb->snd_wnd_max = tcphdr->wnd;
+			if (pcb->snd_wnd_max < pcb->snd_wnd) {
+				pcb->snd_wnd_max = pcb->snd_wnd;
 			}
 			pcb->snd_wl1 = seqno;
 			pcb->snd_wl2 = ackno;
@@ -869,15 +852,21 @@ static void tcp_receive(struct tcp_pcb *pcb)
 				/* stop persist timer */
 				pcb->persist_backoff = 0;
 			}
-			LWIP_DEBUGF(TCP_WND_DEBUG, ("tcp_receive: window update %" U16_F "\n", pcb->snd_wnd));
+			LWIP_DEBUGF(TCP_WND_DEBUG, ("tcp_receive: window update %" TCPWNDSIZE_F "\n", pcb->snd_wnd));
 #if TCP_WND_DEBUG
 		} else {
-			if (pcb->snd_wnd != tcphdr->wnd) {
+			if (pcb->snd_wnd != (tcpwnd_size_t)SND_WND_SCALE(pcb, tcphdr->wnd)) {
 				LWIP_DEBUGF(TCP_WND_DEBUG, ("tcp_receive: no window update lastack %" U32_F " ackno %" U32_F " wl1 %" U32_F " seqno %" U32_F " wl2 %" U32_F "\n", pcb->lastack, ackno, pcb->snd_wl1, seqno, pcb->snd_wl2));
 			}
 #endif							/* TCP_WND_DEBUG */
 		}
 
+#if LWIP_TCP_SACK
+		if (sack_num > 0) {
+			tcp_sack_mark(pcb);
+		}
+#endif							/* LWIP_TCP_SACK */
+
 		/* (From Stevens TCP/IP Illustrated Vol II, p970.) Its only a
 		 * duplicate ack if:
 		 * 1) It doesn't ACK new data
@@ -916,13 +905,20 @@ static void tcp_receive(struct tcp_pcb *pcb)
 							if (pcb->dupacks > 3) {
 								/* Inflate the congestion window, but not if it means that
 								   the value overflows. */
-								if ((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+								if ((tcpwnd_size_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
 									pcb->cwnd += pcb->mss;
 								}
 							} else if (pcb->dupacks == 3) {
 								/* Do fast retransmit */
 								tcp_rexmit_fast(pcb);
 							}
+#if LWIP_TCP_SACK
+							if (pcb->dupacks != 3) {
+								/* In SACK recovery, every further dupack lets
+								   the next hole go out */
+								tcp_rexmit_sack(pcb);
+							}
+#endif							/* LWIP_TCP_SACK */
 						}
 					}
 				}
@@ -937,10 +933,16 @@ static void tcp_receive(struct tcp_pcb *pcb)
 
 			/* Reset the "IN Fast Retransmit" flag, since we are no longer
 			   in fast retransmit. Also reset the congestion window to the
-			   slow start threshold. */
+			   slow start threshold. With SACK, a partial ACK (below the
+			   recovery point) keeps us in fast recovery. */
 			if (pcb->flags & TF_INFR) {
-				pcb->flags &= ~TF_INFR;
-				pcb->cwnd = pcb->ssthresh;
+#if LWIP_TCP_SACK
+				if (!(pcb->flags & TF_SACK) || TCP_SEQ_GEQ(ackno, pcb->recover))
+#endif							/* LWIP_TCP_SACK */
+				{
+					pcb->flags &= ~TF_INFR;
+					pcb->cwnd = pcb->ssthresh;
+				}
 			}
 
 			/* Reset the number of retransmissions. */
@@ -961,17 +963,31 @@ static void tcp_receive(struct tcp_pcb *pcb)
 			/* Update the congestion control variables (cwnd and
 			   ssthresh). */
 			if (pcb->state >= ESTABLISHED) {
+#if LWIP_TCP_SACK
+				if (pcb->flags & TF_INFR) {
+					/* Partial ACK: deflate the window by the amount of new
+					   data acknowledged, and add back one MSS (RFC 6582) */
+					pcb->cwnd = (pcb->cwnd > pcb->acked) ? (pcb->cwnd - pcb->acked) : 0;
+					if (pcb->acked >= pcb->mss) {
+						pcb->cwnd += pcb->mss;
+					}
+					if (pcb->cwnd < pcb->mss) {
+						pcb->cwnd = pcb->mss;
+					}
+					LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: partial ACK cwnd %" TCPWNDSIZE_F "\n", pcb->cwnd));
+				} else
+#endif							/* LWIP_TCP_SACK */
 				if (pcb->cwnd < pcb->ssthresh) {
-					if ((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+					if ((tcpwnd_size_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
 						pcb->cwnd += pcb->mss;
 					}
-					LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: slow start cwnd %" U16_F "\n", pcb->cwnd));
+					LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: slow start cwnd %" TCPWNDSIZE_F "\n", pcb->cwnd));
 				} else {
-					u16_t new_cwnd = (pcb->cwnd + pcb->mss * pcb->mss / pcb->cwnd);
+					tcpwnd_size_t new_cwnd = (pcb->cwnd + pcb->mss * pcb->mss / pcb->cwnd);
 					if (new_cwnd > pcb->cwnd) {
 						pcb->cwnd = new_cwnd;
 					}
-					LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: congestion avoidance cwnd %" U16_F "\n", pcb->cwnd));
+					LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: congestion avoidance cwnd %" TCPWNDSIZE_F "\n", pcb->cwnd));
 				}
 			}
 			LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: ACK for %" U32_F ", unacked->seqno %" U32_F ":%" U32_F "\n", ackno, pcb->unacked != NULL ? ntohl(pcb->unacked->tcphdr->seqno) : 0, pcb->unacked != NULL ? ntohl(pcb->unacked->tcphdr->seqno) + TCP_TCPLEN(pcb->unacked) : 0));
@@ -1008,6 +1024,11 @@ static void tcp_receive(struct tcp_pcb *pcb)
 				pcb->rtime = 0;
 			}
 
+#if LWIP_TCP_SACK
+			/* A partial ACK in SACK recovery lets the next hole go out */
+			tcp_rexmit_sack(pcb);
+#endif							/* LWIP_TCP_SACK */
+
 			pcb->polltmr = 0;
 		} else {
 			/* Fix bug bug #21582: out of sequence ACK, didn't really ack anything */
@@ -1309,8 +1330,11 @@ static void tcp_receive(struct tcp_pcb *pcb)
 
 			} else {
 				/* We get here if the incoming segment is out-of-sequence. */
-				tcp_send_empty_ack(pcb);
 #if TCP_QUEUE_OOSEQ
+#if LWIP_TCP_SACK
+				/* Report the block of this segment first in our SACK option */
+				pcb->rcv_sack_seqno = seqno;
+#endif							/* LWIP_TCP_SACK */
 				/* We queue the segment on the ->ooseq queue. */
 				if (pcb->ooseq == NULL) {
 					pcb->ooseq = tcp_seg_copy(&inseg);
@@ -1451,6 +1475,10 @@ static void tcp_receive(struct tcp_pcb *pcb)
 				}
 #endif							/* TCP_OOSEQ_MAX_BYTES || TCP_OOSEQ_MAX_PBUFS */
 #endif							/* TCP_QUEUE_OOSEQ */
+
+				/* Send the (duplicate) ACK now that the segment is queued,
+				   so that its SACK option can report the segment */
+				tcp_send_empty_ack(pcb);
 			}
 		} else {
 			/* The incoming segment is not withing the window. */
@@ -1471,7 +1499,7 @@ static void tcp_receive(struct tcp_pcb *pcb)
  * Parses the options contained in the incoming segment.
  *
  * Called from tcp_listen_input() and tcp_process().
- * Currently, only the MSS option is supported!
+ * Currently, the MSS, timestamp, window scale and SACK options are supported.
  *
  * @param pcb the tcp_pcb for which a segment arrived
  */
@@ -1483,6 +1511,11 @@ static void tcp_parseopt(struct tcp_pcb *pcb)
 #if LWIP_TCP_TIMESTAMPS
 	u32_t tsval;
 #endif
+#if LWIP_TCP_SACK
+	u8_t i;
+
+	sack_num = 0;
+#endif
 
 	opts = (u8_t *)tcphdr + TCP_HLEN;
 
@@ -1515,6 +1548,65 @@ static void tcp_parseopt(struct tcp_pcb *pcb)
 				/* Advance to next option */
 				c += 0x04;
 				break;
+#if LWIP_WND_SCALE
+			case 0x03:
+				LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: WND_SCALE\n"));
+				if (opts[c + 1] != 0x03 || c + 0x03 > max_c) {
+					/* Bad length */
+					LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+					return;
+				}
+				/* The option is only valid on SYNs, and a retransmitted SYN
+				   must not change the scale again */
+				if ((flags & TCP_SYN) && !(pcb->flags & TF_WND_SCALE)) {
+					pcb->snd_scale = opts[c + 2];
+					if (pcb->snd_scale > 14U) {
+						pcb->snd_scale = 14U;
+					}
+					pcb->rcv_scale = TCP_RCV_SCALE;
+					pcb->flags |= TF_WND_SCALE;
+					/* window scaling is enabled, we can use the full receive window */
+					LWIP_ASSERT("window not at default value", pcb->rcv_wnd == TCPWND_MIN16(TCP_WND));
+					LWIP_ASSERT("window not at default value", pcb->rcv_ann_wnd == TCPWND_MIN16(TCP_WND));
+					pcb->rcv_wnd = pcb->rcv_ann_wnd = TCP_WND;
+				}
+				/* Advance to next option */
+				c += 0x03;
+				break;
+#endif							/* LWIP_WND_SCALE */
+#if LWIP_TCP_SACK
+			case 0x04:
+				LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: SACK_PERM\n"));
+				if (opts[c + 1] != 0x02 || c + 0x02 > max_c) {
+					/* Bad length */
+					LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+					return;
+				}
+				if (flags & TCP_SYN) {
+					pcb->flags |= TF_SACK;
+				}
+				/* Advance to next option */
+				c += 0x02;
+				break;
+			case 0x05:
+				LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: SACK\n"));
+				if (opts[c + 1] < 0x0A || ((opts[c + 1] - 2) & 0x07) != 0 || c + opts[c + 1] > max_c) {
+					/* Bad length */
+					LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+					return;
+				}
+				if (pcb->flags & TF_SACK) {
+					/* The edges are not aligned, read them bytewise */
+					for (i = 2; i < opts[c + 1] && sack_num < TCP_SACK_MAX_BLOCKS; i += 8) {
+						sack_left[sack_num] = ((u32_t)opts[c + i] << 24) | ((u32_t)opts[c + i + 1] << 16) | ((u32_t)opts[c + i + 2] << 8) | opts[c + i + 3];
+						sack_right[sack_num] = ((u32_t)opts[c + i + 4] << 24) | ((u32_t)opts[c + i + 5] << 16) | ((u32_t)opts[c + i + 6] << 8) | opts[c + i + 7];
+						sack_num++;
+					}
+				}
+				/* Advance to next option */
+				c += opts[c + 1];
+				break;
+#endif							/* LWIP_TCP_SACK */
 #if LWIP_TCP_TIMESTAMPS
 			case 0x08:
 				LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: TS\n"));
@@ -1551,4 +1643,38 @@ static void tcp_parseopt(struct tcp_pcb *pcb)
 	}
 }
 
+#if LWIP_TCP_SACK
+/**
+ * Marks the segments on the unacked queue that the SACK blocks of the
+ * incoming segment report as received, so that tcp_rexmit_sack() only
+ * retransmits the holes between them.
+ *
+ * Called from tcp_receive().
+ *
+ * @param pcb the tcp_pcb for which a segment arrived
+ */
+static void tcp_sack_mark(struct tcp_pcb *pcb)
+{
+	struct tcp_seg *seg;
+	u32_t seg_seqno;
+	u8_t i;
+
+	for (i = 0; i < sack_num; i++) {
+		/* Ignore D-SACKs and blocks outside of the outstanding data */
+		if (!TCP_SEQ_LT(sack_left[i], sack_right[i]) || TCP_SEQ_LEQ(sack_right[i], ackno) || TCP_SEQ_GT(sack_right[i], pcb->snd_nxt)) {
+			continue;
+		}
+		for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+			seg_seqno = ntohl(seg->tcphdr->seqno);
+			if (TCP_SEQ_GEQ(seg_seqno, sack_right[i])) {
+				break;
+			}
+			if (TCP_SEQ_GEQ(seg_seqno, sack_left[i]) && TCP_SEQ_LEQ(seg_seqno + TCP_TCPLEN(seg), sack_right[i])) {
+				seg->flags |= TF_SEG_SACKED;
+			}
+		}
+	}
+}
+#endif							/* LWIP_TCP_SACK */
+
 #endif							/* LWIP_TCP */
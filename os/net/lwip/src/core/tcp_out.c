@@ -119,7 +119,7 @@ static struct pbuf *tcp_output_alloc_header(struct tcp_pcb *pcb, u16_t optlen, u
 		tcphdr->seqno = seqno_be;
 		tcphdr->ackno = htonl(pcb->rcv_nxt);
 		TCPH_HDRLEN_FLAGS_SET(tcphdr, (5 + optlen / 4), TCP_ACK);
-		tcphdr->wnd = htons(pcb->rcv_ann_wnd);
+		tcphdr->wnd = htons(TCPWND16(RCV_WND_SCALE(pcb, pcb->rcv_ann_wnd)));
 		tcphdr->chksum = 0;
 		tcphdr->urgp = 0;
 
@@ -712,6 +712,18 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
 
 	if (flags & TCP_SYN) {
 		optflags = TF_SEG_OPTS_MSS;
+#if LWIP_WND_SCALE
+		/* Offer window scaling in our SYN, but only answer a SYN with it
+		   if the remote host offered it too */
+		if ((pcb->state != SYN_RCVD) || (pcb->flags & TF_WND_SCALE)) {
+			optflags |= TF_SEG_OPTS_WND_SCALE;
+		}
+#endif							/* LWIP_WND_SCALE */
+#if LWIP_TCP_SACK
+		if ((pcb->state != SYN_RCVD) || (pcb->flags & TF_SACK)) {
+			optflags |= TF_SEG_OPTS_SACK_PERM;
+		}
+#endif							/* LWIP_TCP_SACK */
 	}
 #if LWIP_TCP_TIMESTAMPS
 	if ((pcb->flags & TF_TIMESTAMP)) {
@@ -797,6 +809,61 @@ static void tcp_build_timestamp_option(struct tcp_pcb *pcb, u32_t *opts)
 }
 #endif
 
+#if LWIP_TCP_SACK && TCP_QUEUE_OOSEQ
+/* Collect the SACK blocks (RFC 2018) of the data queued on ooseq:
+ * contiguous segments make up one block. The block holding the latest
+ * out-of-order segment comes first, the others follow in sequence order.
+ *
+ * @param pcb tcp_pcb
+ * @param edges where to store the left and right edge of each block
+ * @param max maximum number of blocks
+ * @return number of blocks stored
+ */
+static u8_t tcp_get_sack_blocks(struct tcp_pcb *pcb, u32_t *edges, u8_t max)
+{
+	struct tcp_seg *seg;
+	u32_t left, right;
+	u8_t num = 0;
+	u8_t pass;
+
+	/* First pass: the latest block only, second pass: all others */
+	for (pass = 0; pass < 2; pass++) {
+		seg = pcb->ooseq;
+		while (seg != NULL && num < max) {
+			/* the headers of ooseq segments were converted to host byte order */
+			left = seg->tcphdr->seqno;
+			right = left + TCP_TCPLEN(seg);
+			for (seg = seg->next; seg != NULL && seg->tcphdr->seqno == right; seg = seg->next) {
+				right += TCP_TCPLEN(seg);
+			}
+			if (TCP_SEQ_BETWEEN(pcb->rcv_sack_seqno, left, right - 1) == (pass == 0)) {
+				edges[2 * num] = left;
+				edges[2 * num + 1] = right;
+				num++;
+			}
+		}
+	}
+	return num;
+}
+
+/* Build a SACK option (4 + 8 * num bytes long) at the specified options pointer
+ *
+ * @param opts option pointer where to store the SACK option
+ * @param edges the blocks returned by tcp_get_sack_blocks()
+ * @param num number of blocks
+ */
+static void tcp_build_sack_option(u32_t *opts, const u32_t *edges, u8_t num)
+{
+	u8_t i;
+
+	/* Pad with two NOP options to make everything nicely aligned */
+	opts[0] = htonl(0x01010500 | (2 + 8 * num));
+	for (i = 0; i < 2 * num; i++) {
+		opts[1 + i] = htonl(edges[i]);
+	}
+}
+#endif							/* LWIP_TCP_SACK && TCP_QUEUE_OOSEQ */
+
 /** Send an ACK without data.
  *
  * @param pcb Protocol control block for the TCP connection to send the ACK
@@ -806,12 +873,23 @@ err_t tcp_send_empty_ack(struct tcp_pcb *pcb)
 	struct pbuf *p;
 	struct tcp_hdr *tcphdr;
 	u8_t optlen = 0;
+#if LWIP_TCP_SACK && TCP_QUEUE_OOSEQ
+	u32_t sack_edges[2 * LWIP_TCP_MAX_SACK_NUM];
+	u8_t sack_num = 0;
+#endif
 
 #if LWIP_TCP_TIMESTAMPS
 	if (pcb->flags & TF_TIMESTAMP) {
 		optlen = LWIP_TCP_OPT_LENGTH(TF_SEG_OPTS_TS);
 	}
 #endif
+#if LWIP_TCP_SACK && TCP_QUEUE_OOSEQ
+	if ((pcb->flags & TF_SACK) && pcb->ooseq != NULL) {
+		/* Only 3 blocks fit in the option space next to a timestamp */
+		sack_num = tcp_get_sack_blocks(pcb, sack_edges, (optlen > 0) ? LWIP_MIN(LWIP_TCP_MAX_SACK_NUM, 3) : LWIP_TCP_MAX_SACK_NUM);
+		optlen += LWIP_TCP_SACK_OPT_LENGTH(sack_num);
+	}
+#endif
 
 	p = tcp_output_alloc_header(pcb, optlen, 0, htonl(pcb->snd_nxt));
 	if (p == NULL) {
@@ -831,6 +909,11 @@ err_t tcp_send_empty_ack(struct tcp_pcb *pcb)
 		tcp_build_timestamp_option(pcb, (u32_t *)(tcphdr + 1));
 	}
 #endif
+#if LWIP_TCP_SACK && TCP_QUEUE_OOSEQ
+	if (sack_num > 0) {
+		tcp_build_sack_option((u32_t *)((u8_t *)(tcphdr + 1) + optlen - LWIP_TCP_SACK_OPT_LENGTH(sack_num)), sack_edges, sack_num);
+	}
+#endif
 
 #if CHECKSUM_GEN_TCP
 	tcphdr->chksum = inet_chksum_pseudo(p, &(pcb->local_ip), &(pcb->remote_ip), IP_PROTO_TCP, p->tot_len);
@@ -897,9 +980,9 @@ err_t tcp_output(struct tcp_pcb *pcb)
 #endif							/* TCP_OUTPUT_DEBUG */
 #if TCP_CWND_DEBUG
 	if (seg == NULL) {
-		LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_output: snd_wnd %" U16_F ", cwnd %" U16_F ", wnd %" U32_F ", seg == NULL, ack %" U32_F "\n", pcb->snd_wnd, pcb->cwnd, wnd, pcb->lastack));
+		LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_output: snd_wnd %" TCPWNDSIZE_F ", cwnd %" TCPWNDSIZE_F ", wnd %" U32_F ", seg == NULL, ack %" U32_F "\n", pcb->snd_wnd, pcb->cwnd, wnd, pcb->lastack));
 	} else {
-		LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_output: snd_wnd %" U16_F ", cwnd %" U16_F ", wnd %" U32_F ", effwnd %" U32_F ", seq %" U32_F ", ack %" U32_F "\n", pcb->snd_wnd, pcb->cwnd, wnd, ntohl(seg->tcphdr->seqno) - pcb->lastack + seg->len, ntohl(seg->tcphdr->seqno), pcb->lastack));
+		LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_output: snd_wnd %" TCPWNDSIZE_F ", cwnd %" TCPWNDSIZE_F ", wnd %" U32_F ", effwnd %" U32_F ", seq %" U32_F ", ack %" U32_F "\n", pcb->snd_wnd, pcb->cwnd, wnd, ntohl(seg->tcphdr->seqno) - pcb->lastack + seg->len, ntohl(seg->tcphdr->seqno), pcb->lastack));
 	}
 #endif							/* TCP_CWND_DEBUG */
 	/* data available and window allows it to be sent? */
@@ -916,7 +999,7 @@ err_t tcp_output(struct tcp_pcb *pcb)
 			break;
 		}
 #if TCP_CWND_DEBUG
-		LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_output: snd_wnd %" U16_F ", cwnd %" U16_F ", wnd %" U32_F ", effwnd %" U32_F ", seq %" U32_F ", ack %" U32_F ", i %" S16_F "\n", pcb->snd_wnd, pcb->cwnd, wnd, ntohl(seg->tcphdr->seqno) + seg->len - pcb->lastack, ntohl(seg->tcphdr->seqno), pcb->lastack, i));
+		LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_output: snd_wnd %" TCPWNDSIZE_F ", cwnd %" TCPWNDSIZE_F ", wnd %" U32_F ", effwnd %" U32_F ", seq %" U32_F ", ack %" U32_F ", i %" S16_F "\n", pcb->snd_wnd, pcb->cwnd, wnd, ntohl(seg->tcphdr->seqno) + seg->len - pcb->lastack, ntohl(seg->tcphdr->seqno), pcb->lastack, i));
 		++i;
 #endif							/* TCP_CWND_DEBUG */
 
@@ -994,8 +1077,14 @@ static void tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
 	   wnd fields remain. */
 	seg->tcphdr->ackno = htonl(pcb->rcv_nxt);
 
-	/* advertise our receive window size in this TCP segment */
-	seg->tcphdr->wnd = htons(pcb->rcv_ann_wnd);
+	if (TCPH_FLAGS(seg->tcphdr) & TCP_SYN) {
+		/* The window field of a SYN (the only segment carrying the
+		   window scale option) is never scaled */
+		seg->tcphdr->wnd = htons(TCPWND_MIN16(pcb->rcv_ann_wnd));
+	} else {
+		/* advertise our receive window size in this TCP segment */
+		seg->tcphdr->wnd = htons(TCPWND16(RCV_WND_SCALE(pcb, pcb->rcv_ann_wnd)));
+	}
 
 	pcb->rcv_ann_right_edge = pcb->rcv_nxt + pcb->rcv_ann_wnd;
 
@@ -1012,6 +1101,20 @@ static void tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
 		*opts = TCP_BUILD_MSS_OPTION(mss);
 		opts += 1;
 	}
+#if LWIP_WND_SCALE
+	if (seg->flags & TF_SEG_OPTS_WND_SCALE) {
+		/* Pad with one NOP option to make everything nicely aligned */
+		*opts = PP_HTONL(0x01030300 | TCP_RCV_SCALE);
+		opts += 1;
+	}
+#endif
+#if LWIP_TCP_SACK
+	if (seg->flags & TF_SEG_OPTS_SACK_PERM) {
+		/* Pad with two NOP options to make everything nicely aligned */
+		*opts = PP_HTONL(0x01010402);
+		opts += 1;
+	}
+#endif
 #if LWIP_TCP_TIMESTAMPS
 	pcb->ts_lastacksent = pcb->rcv_nxt;
 
@@ -1132,7 +1235,7 @@ void tcp_rst(u32_t seqno, u32_t ackno, ip_addr_t *local_ip, ip_addr_t *remote_ip
 	tcphdr->seqno = htonl(seqno);
 	tcphdr->ackno = htonl(ackno);
 	TCPH_HDRLEN_FLAGS_SET(tcphdr, TCP_HLEN / 4, TCP_RST | TCP_ACK);
-	tcphdr->wnd = PP_HTONS(TCP_WND);
+	tcphdr->wnd = PP_HTONS(TCPWND_MIN16(TCP_WND));
 	tcphdr->chksum = 0;
 	tcphdr->urgp = 0;
 
@@ -1162,6 +1265,15 @@ void tcp_rexmit_rto(struct tcp_pcb *pcb)
 		return;
 	}
 
+#if LWIP_TCP_SACK
+	/* The remote host may drop data it has SACKed (RFC 2018), so forget
+	   the SACKs; the timeout also ends fast recovery */
+	for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+		seg->flags &= ~TF_SEG_SACKED;
+	}
+	pcb->flags &= ~TF_INFR;
+#endif							/* LWIP_TCP_SACK */
+
 	/* Move all unacked segments to the head of the unsent queue */
 	for (seg = pcb->unacked; seg->next != NULL; seg = seg->next) ;
 	/* concatenate unsent queue after unacked queue */
@@ -1237,6 +1349,14 @@ void tcp_rexmit_fast(struct tcp_pcb *pcb)
 	if (pcb->unacked != NULL && !(pcb->flags & TF_INFR)) {
 		/* This is fast retransmit. Retransmit the first unacked segment. */
 		LWIP_DEBUGF(TCP_FR_DEBUG, ("tcp_receive: dupacks %" U16_F " (%" U32_F "), fast retransmit %" U32_F "\n", (u16_t)pcb->dupacks, pcb->lastack, ntohl(pcb->unacked->tcphdr->seqno)));
+#if LWIP_TCP_SACK
+		if (pcb->flags & TF_SACK) {
+			/* Stay in recovery until everything sent so far is acknowledged,
+			   retransmitting the holes reported by SACK one by one */
+			pcb->recover = pcb->snd_nxt;
+			pcb->high_rxt = pcb->lastack;
+		} else
+#endif							/* LWIP_TCP_SACK */
 		tcp_rexmit(pcb);
 
 		/* Set ssthresh to half of the minimum of the current
@@ -1249,14 +1369,74 @@ void tcp_rexmit_fast(struct tcp_pcb *pcb)
 
 		/* The minimum value for ssthresh should be 2 MSS */
 		if (pcb->ssthresh < 2 * pcb->mss) {
-			LWIP_DEBUGF(TCP_FR_DEBUG, ("tcp_receive: The minimum value for ssthresh %" U16_F " should be min 2 mss %" U16_F "...\n", pcb->ssthresh, 2 * pcb->mss));
+			LWIP_DEBUGF(TCP_FR_DEBUG, ("tcp_receive: The minimum value for ssthresh %" TCPWNDSIZE_F " should be min 2 mss %" U16_F "...\n", pcb->ssthresh, 2 * pcb->mss));
 			pcb->ssthresh = 2 * pcb->mss;
 		}
 
 		pcb->cwnd = pcb->ssthresh + 3 * pcb->mss;
 		pcb->flags |= TF_INFR;
+#if LWIP_TCP_SACK
+		/* Retransmit the first hole (needs TF_INFR) */
+		tcp_rexmit_sack(pcb);
+	} else {
+		/* The dupacks restarted counting after a partial ACK */
+		tcp_rexmit_sack(pcb);
+#endif							/* LWIP_TCP_SACK */
+	}
+}
+
+#if LWIP_TCP_SACK
+/**
+ * Retransmit the next hole during SACK-based fast recovery: the first
+ * unacked segment that is neither SACKed nor already retransmitted in
+ * this recovery, provided the remote host has SACKed data above it (the
+ * segment at lastack is always lost, the dupacks or partial ACK say so).
+ *
+ * Called by tcp_receive() for every dupack and partial ACK. The segment
+ * is sent directly from the unacked queue, without moving it to unsent
+ * like tcp_rexmit() does, so that the window check of tcp_output() cannot
+ * hold it back.
+ *
+ * @param pcb the tcp_pcb for which to retransmit the next hole
+ */
+void tcp_rexmit_sack(struct tcp_pcb *pcb)
+{
+	struct tcp_seg *seg;
+	struct tcp_seg *hole = NULL;
+
+	if ((pcb->flags & (TF_SACK | TF_INFR)) != (TF_SACK | TF_INFR)) {
+		return;
 	}
+
+	for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+		if (seg->flags & TF_SEG_SACKED) {
+			if (hole != NULL) {
+				break;
+			}
+		} else if (hole == NULL && TCP_SEQ_GEQ(ntohl(seg->tcphdr->seqno), pcb->high_rxt)) {
+			hole = seg;
+			if (seg == pcb->unacked) {
+				break;
+			}
+		}
+	}
+	if (seg == NULL) {
+		/* No hole below SACKed data left: new data goes out by tcp_output() */
+		return;
+	}
+
+	LWIP_DEBUGF(TCP_FR_DEBUG, ("tcp_rexmit_sack: retransmit %" U32_F "\n", ntohl(hole->tcphdr->seqno)));
+	pcb->high_rxt = ntohl(hole->tcphdr->seqno) + TCP_TCPLEN(hole);
+
+	++pcb->nrtx;
+
+	snmp_inc_tcpretranssegs();
+	tcp_output_segment(hole, pcb);
+
+	/* Don't take any rtt measurements after retransmitting. */
+	pcb->rttest = 0;
 }
+#endif							/* LWIP_TCP_SACK */
 
 /**
  * Send keepalive packets to keep a connection active although
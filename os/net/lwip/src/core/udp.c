@@ -95,6 +95,38 @@ static u16_t udp_port = UDP_LOCAL_PORT_RANGE_START;
 /* exported in udp.h (was static) */
 struct udp_pcb *udp_pcbs;
 
+#define UDP_HASH(port) ((port) & (UDP_PCB_HASH_SIZE - 1))
+
+/* The PCBs of udp_pcbs hashed on their local port, for udp_input() */
+static struct udp_pcb *udp_hash[UDP_PCB_HASH_SIZE];
+
+/**
+ * Add a PCB to the bucket of its local port in udp_hash.
+ */
+static void udp_hash_add(struct udp_pcb *pcb)
+{
+	struct udp_pcb **bucket = &udp_hash[UDP_HASH(pcb->local_port)];
+
+	pcb->hash_next = *bucket;
+	*bucket = pcb;
+}
+
+/**
+ * Remove a PCB from the bucket of its local port in udp_hash, if it is there.
+ */
+static void udp_hash_remove(struct udp_pcb *pcb)
+{
+	struct udp_pcb **bucket;
+
+	for (bucket = &udp_hash[UDP_HASH(pcb->local_port)]; *bucket != NULL; bucket = &(*bucket)->hash_next) {
+		if (*bucket == pcb) {
+			*bucket = pcb->hash_next;
+			pcb->hash_next = NULL;
+			return;
+		}
+	}
+}
+
 /**
  * Initialize this module.
  */
@@ -119,8 +151,8 @@ again:
 	if (udp_port++ == UDP_LOCAL_PORT_RANGE_END) {
 		udp_port = UDP_LOCAL_PORT_RANGE_START;
 	}
-	/* Check all PCBs. */
-	for (pcb = udp_pcbs; pcb != NULL; pcb = pcb->next) {
+	/* Check all PCBs bound to the port. */
+	for (pcb = udp_hash[UDP_HASH(udp_port)]; pcb != NULL; pcb = pcb->hash_next) {
 		if (pcb->local_port == udp_port) {
 			if (++n > (UDP_LOCAL_PORT_RANGE_END - UDP_LOCAL_PORT_RANGE_START)) {
 				return 0;
@@ -164,7 +196,7 @@ again:
 void udp_input(struct pbuf *p, struct netif *inp)
 {
 	struct udp_hdr *udphdr;
-	struct udp_pcb *pcb, *prev;
+	struct udp_pcb *pcb;
 	struct udp_pcb *uncon_pcb;
 	struct ip_hdr *iphdr;
 	u16_t src, dest;
@@ -224,14 +256,14 @@ void udp_input(struct pbuf *p, struct netif *inp)
 	} else
 #endif							/* LWIP_DHCP */
 	{
-		prev = NULL;
 		local_match = 0;
 		uncon_pcb = NULL;
-		/* Iterate through the UDP pcb list for a matching pcb.
-		 * 'Perfect match' pcbs (connected to the remote port & ip address) are
-		 * preferred. If no perfect match is found, the first unconnected pcb that
-		 * matches the local port and ip address gets the datagram. */
-		for (pcb = udp_pcbs; pcb != NULL; pcb = pcb->next) {
+		/* Iterate through the UDP pcbs bound to the destination port for a
+		 * matching pcb. 'Perfect match' pcbs (connected to the remote port & ip
+		 * address) are preferred. If no perfect match is found, the first
+		 * unconnected pcb that matches the local port and ip address gets the
+		 * datagram. */
+		for (pcb = udp_hash[UDP_HASH(dest)]; pcb != NULL; pcb = pcb->hash_next) {
 			local_match = 0;
 			/* print the PCB local and remote address */
 			LWIP_DEBUGF(UDP_DEBUG, ("pcb (%" U16_F ".%" U16_F ".%" U16_F ".%" U16_F ", %" U16_F ") --- " "(%" U16_F ".%" U16_F ".%" U16_F ".%" U16_F ", %" U16_F ")\n", ip4_addr1_16(&pcb->local_ip), ip4_addr2_16(&pcb->local_ip), ip4_addr3_16(&pcb->local_ip), ip4_addr4_16(&pcb->local_ip), pcb->local_port, ip4_addr1_16(&pcb->remote_ip), ip4_addr2_16(&pcb->remote_ip), ip4_addr3_16(&pcb->remote_ip), ip4_addr4_16(&pcb->remote_ip), pcb->remote_port));
@@ -257,18 +289,8 @@ void udp_input(struct pbuf *p, struct netif *inp)
 			/* compare PCB remote addr+port to UDP source addr+port */
 			if ((local_match != 0) && (pcb->remote_port == src) && (ip_addr_isany(&pcb->remote_ip) || ip_addr_cmp(&(pcb->remote_ip), &current_iphdr_src))) {
 				/* the first fully matching PCB */
-				if (prev != NULL) {
-					/* move the pcb to the front of udp_pcbs so that is
-					   found faster next time */
-					prev->next = pcb->next;
-					pcb->next = udp_pcbs;
-					udp_pcbs = pcb;
-				} else {
-					UDP_STATS_INC(udp.cachehit);
-				}
 				break;
 			}
-			prev = pcb;
 		}
 		/* no fully matching pcb found? then look for an unconnected pcb */
 		if (pcb == NULL) {
@@ -340,7 +362,7 @@ void udp_input(struct pbuf *p, struct netif *inp)
 				   if SOF_REUSEADDR is set on the first match */
 				struct udp_pcb *mpcb;
 				u8_t p_header_changed = 0;
-				for (mpcb = udp_pcbs; mpcb != NULL; mpcb = mpcb->next) {
+				for (mpcb = udp_hash[UDP_HASH(dest)]; mpcb != NULL; mpcb = mpcb->hash_next) {
 					if (mpcb != pcb) {
 						/* compare PCB local addr+port to UDP destination addr+port */
 						if ((mpcb->local_port == dest) && ((!broadcast && ip_addr_isany(&mpcb->local_ip)) || ip_addr_cmp(&(mpcb->local_ip), &current_iphdr_dest) ||
@@ -774,6 +796,10 @@ err_t udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
 			return ERR_USE;
 		}
 	}
+	if (rebind) {
+		/* the bucket depends on the port, take the PCB out of its old one */
+		udp_hash_remove(pcb);
+	}
 	pcb->local_port = port;
 	snmp_insert_udpidx_tree(pcb);
 	/* pcb not active yet? */
@@ -782,6 +808,7 @@ err_t udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
 		pcb->next = udp_pcbs;
 		udp_pcbs = pcb;
 	}
+	udp_hash_add(pcb);
 	LWIP_DEBUGF(UDP_DEBUG | LWIP_DBG_TRACE | LWIP_DBG_STATE, ("udp_bind: bound to %" U16_F ".%" U16_F ".%" U16_F ".%" U16_F ", port %" U16_F "\n", ip4_addr1_16(&pcb->local_ip), ip4_addr2_16(&pcb->local_ip), ip4_addr3_16(&pcb->local_ip), ip4_addr4_16(&pcb->local_ip), pcb->local_port));
 	return ERR_OK;
 }
@@ -849,6 +876,7 @@ err_t udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
 	/* PCB not yet on the list, add PCB now */
 	pcb->next = udp_pcbs;
 	udp_pcbs = pcb;
+	udp_hash_add(pcb);
 	return ERR_OK;
 }
 
@@ -895,6 +923,7 @@ void udp_remove(struct udp_pcb *pcb)
 	struct udp_pcb *pcb2;
 
 	snmp_delete_udpidx_tree(pcb);
+	udp_hash_remove(pcb);
 	/* pcb to be removed is first in list? */
 	if (udp_pcbs == pcb) {
 		/* make list start at 2nd pcb */
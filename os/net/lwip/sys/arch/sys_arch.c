@@ -19,15 +19,18 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
 /* tinyara includes */
 #include <errno.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <time.h>
 #include <assert.h>
 #include <errno.h>
 #include <tinyara/clock.h>
 #include <tinyara/arch.h>
+#include <tinyara/irq.h>
 #include <tinyara/cancelpt.h>
 #include <tinyara/kthread.h>
 #include <sys/types.h>
@@ -51,6 +54,113 @@
 
 static u16_t s_nextthread = 0;
 
+/*---------------------------------------------------------------------------*
+ * Mailboxes
+ *---------------------------------------------------------------------------*
+ * A mailbox is a ring of message pointers.  The ring is only touched with
+ * the interrupts disabled, for a few instructions, so posting a message to
+ * a mailbox or fetching one never takes a semaphore unless the caller has
+ * to block.  A fetcher finding the ring empty registers in wait_fetch and
+ * waits on "mail", which the next post signals; a poster finding it full
+ * registers in wait_send and waits on "space".
+ *---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*
+ * Routine:  mbox_put
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Puts the "msg" in the ring and wakes up a blocked fetcher.  If the
+ *      ring is full and "wait" is set, the caller is registered to be woken
+ *      up by the next fetch.
+ * Outputs:
+ *      err_t                   -- ERR_OK if message posted, else ERR_MEM
+ *---------------------------------------------------------------------------*/
+static err_t mbox_put(sys_mbox_t *mbox, void *msg, bool wait)
+{
+	irqstate_t flags;
+	bool wake = false;
+	u32_t next;
+
+	flags = irqsave();
+	next = (mbox->rear + 1) % mbox->queue_size;
+	if (next == mbox->front) {
+		if (wait) {
+			mbox->wait_send++;
+		}
+		irqrestore(flags);
+		return ERR_MEM;
+	}
+
+	mbox->msgs[mbox->rear] = msg;
+	mbox->rear = next;
+	if (mbox->wait_fetch > 0) {
+		mbox->wait_fetch--;
+		wake = true;
+	}
+	irqrestore(flags);
+
+	if (wake) {
+		sys_sem_signal(&(mbox->mail));
+	}
+
+	return ERR_OK;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  mbox_get
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Takes up to "max" messages from the ring and wakes up as many
+ *      blocked posters.  If the ring is empty and "wait" is set, the caller
+ *      is registered to be woken up by the next post.
+ * Outputs:
+ *      u32_t                   -- Number of messages taken
+ *---------------------------------------------------------------------------*/
+static u32_t mbox_get(sys_mbox_t *mbox, void **msgs, u32_t max, bool wait)
+{
+	irqstate_t flags;
+	u32_t wake;
+	u32_t n = 0;
+
+	flags = irqsave();
+	while (n < max && mbox->front != mbox->rear) {
+		msgs[n++] = mbox->msgs[mbox->front];
+		mbox->front = (mbox->front + 1) % mbox->queue_size;
+	}
+
+	if (n == 0 && wait) {
+		mbox->wait_fetch++;
+	}
+
+	wake = n < mbox->wait_send ? n : mbox->wait_send;
+	mbox->wait_send -= wake;
+	irqrestore(flags);
+
+	while (wake-- > 0) {
+		sys_sem_signal(&(mbox->space));
+	}
+
+	return n;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  mbox_unwait
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Removes a caller which stopped waiting on "sem" from the "waiters"
+ *      count, unless a wake up was already sent for it, which is consumed.
+ *---------------------------------------------------------------------------*/
+static void mbox_unwait(sys_sem_t *sem, u32_t *waiters)
+{
+	irqstate_t flags;
+
+	flags = irqsave();
+	if (sem_trywait(sem) != OK) {
+		(*waiters)--;
+	}
+	irqrestore(flags);
+}
+
 /*---------------------------------------------------------------------------*
  * Routine:  sys_mbox_new
  *---------------------------------------------------------------------------*
@@ -68,12 +178,15 @@ err_t sys_mbox_new(sys_mbox_t *mbox, int queue_sz)
 	err_t err = ERR_OK;
 	mbox->is_valid = 1;
 	mbox->id = lwip_stats.sys.mbox.used + 1;
+	if (queue_sz <= 0 || queue_sz > SYS_MBOX_MAXSIZE) {
+		queue_sz = SYS_MBOX_MAXSIZE;
+	}
 	mbox->queue_size = queue_sz;
 	mbox->wait_send = 0;
 	mbox->wait_fetch = 0;
 	mbox->front = mbox->rear = 0;
 	sys_sem_new(&(mbox->mail), 0);
-	sys_sem_new(&(mbox->mutex), 1);
+	sys_sem_new(&(mbox->space), 0);
 
 #if SYS_STATS
 	SYS_STATS_INC_USED(mbox);
@@ -105,7 +218,7 @@ void sys_mbox_free(sys_mbox_t *mbox)
 		mbox->wait_send = 0;
 		mbox->wait_fetch = 0;
 		sys_sem_free(&(mbox->mail));
-		sys_sem_free(&(mbox->mutex));
+		sys_sem_free(&(mbox->space));
 
 		LWIP_DEBUGF(SYS_DEBUG, ("Succesfully deleted MBOX with id %d", mbox->id));
 #if SYS_STATS
@@ -127,47 +240,18 @@ void sys_mbox_free(sys_mbox_t *mbox)
  *---------------------------------------------------------------------------*/
 void sys_mbox_post(sys_mbox_t *mbox, void *msg)
 {
-	u8_t first_msg = 0;
-	u32_t tmp = 0;
-	u32_t status = OK;
-	status = sys_arch_sem_wait(&(mbox->mutex), 0);
-	if (status == SYS_ARCH_CANCELED) {
-		return;
-	}
 	LWIP_DEBUGF(SYS_DEBUG, ("mbox %p msg %p\n", (void *)mbox, (void *)msg));
+
 	/* Wait while the queue is full */
-	tmp = (mbox->rear + 1) % mbox->queue_size;
-	if (tmp == mbox->front) {
+	while (mbox_put(mbox, msg, true) != ERR_OK) {
 		LWIP_DEBUGF(SYS_DEBUG, ("Queue Full, Wait until gets free\n"));
-	}
-	while (tmp == mbox->front) {
-		mbox->wait_send++;
-		sys_sem_signal(&(mbox->mutex));
-		sys_arch_sem_wait(&(mbox->mail), 0);
-		status = sys_arch_sem_wait(&(mbox->mutex), 0);
-		mbox->wait_send--;
-		if (status == SYS_ARCH_CANCELED) {
+		if (sys_arch_sem_wait(&(mbox->space), 0) == SYS_ARCH_CANCELED) {
+			mbox_unwait(&(mbox->space), &(mbox->wait_send));
 			return;
 		}
 	}
 
-	mbox->msgs[mbox->rear] = msg;
 	LWIP_DEBUGF(SYS_DEBUG, ("Post SUCCESS\n"));
-	if (mbox->rear == mbox->front) {
-		first_msg = 1;
-	} else {
-		first_msg = 0;
-	}
-
-	mbox->rear = tmp;
-
-	/* If msg was posted to an empty queue, Release semaphore for
-	   some fetch api blocked on this sem due to Empty queue. */
-	if (first_msg && mbox->wait_fetch) {
-		sys_sem_signal(&(mbox->mail));
-	}
-
-	sys_sem_signal(&(mbox->mutex));
 	return;
 }
 
@@ -186,39 +270,14 @@ void sys_mbox_post(sys_mbox_t *mbox, void *msg)
  *---------------------------------------------------------------------------*/
 err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
 {
-	err_t err = ERR_OK;
-	u8_t first_msg = 0;
-	u32_t tmp = 0;
-	sys_arch_sem_wait(&(mbox->mutex), 0);
+	err_t err;
 
 	LWIP_DEBUGF(SYS_DEBUG, ("mbox %p msg %p\n", (void *)mbox, (void *)msg));
-	/* Check if the queue is full */
-	tmp = (mbox->rear + 1) % mbox->queue_size;
-	if (tmp == mbox->front) {
+	err = mbox_put(mbox, msg, false);
+	if (err != ERR_OK) {
 		LWIP_DEBUGF(SYS_DEBUG, ("Queue Full, returning error\n"));
-		err = ERR_MEM;
-		goto errout_with_mutex;
-	}
-
-	mbox->msgs[mbox->rear] = msg;
-	LWIP_DEBUGF(SYS_DEBUG, ("Post SUCCESS\n"));
-	if (mbox->rear == mbox->front) {
-		first_msg = 1;
-	} else {
-		first_msg = 0;
-	}
-
-	mbox->rear = tmp;
-
-	/* If msg was posted to an empty queue, Release semaphore for
-	   some fetch api blocked on this sem due to Empty queue. */
-	if (first_msg && mbox->wait_fetch) {
-		sys_sem_signal(&(mbox->mail));
 	}
 
-errout_with_mutex:
-	sys_sem_signal(&(mbox->mutex));
-
 	return err;
 }
 
@@ -250,61 +309,39 @@ errout_with_mutex:
  *---------------------------------------------------------------------------*/
 u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
 {
-	u32_t time = 0;
-	u32_t status = OK;
+	systime_t start = clock_systimer();
+	u32_t elapsed = 0;
+	u32_t status;
+	void *dropped;
 
-	/* The mutex lock is quick so we don't bother with the timeout
-	   stuff here. */
-	status = sys_arch_sem_wait(&(mbox->mutex), 0);
-	if (status == SYS_ARCH_CANCELED) {
-		return SYS_ARCH_CANCELED;
+	if (msg == NULL) {
+		msg = &dropped;
 	}
 
 	/* wait while the queue is empty */
-	while (mbox->front == mbox->rear) {
-		mbox->wait_fetch++;
-		sys_sem_signal(&(mbox->mutex));
-
+	while (mbox_get(mbox, msg, 1, true) == 0) {
 		/* We block while waiting for a mail to arrive in the mailbox. We
 		   must be prepared to timeout. */
 		if (timeout != 0) {
-			time = sys_arch_sem_wait(&(mbox->mail), timeout);
-
-			if (time == SYS_ARCH_TIMEOUT) {
-				sys_arch_sem_wait(&(mbox->mutex), 0);
-				mbox->wait_fetch--;
-				sys_sem_signal(&(mbox->mutex));
-				return SYS_ARCH_TIMEOUT;
-			}
+			status = elapsed < timeout ? sys_arch_sem_wait(&(mbox->mail), timeout - elapsed) : SYS_ARCH_TIMEOUT;
 		} else {
-			sys_arch_sem_wait(&(mbox->mail), 0);
+			status = sys_arch_sem_wait(&(mbox->mail), 0);
 		}
 
-		status = sys_arch_sem_wait(&(mbox->mutex), 0);
-		mbox->wait_fetch--;
-		if (status == SYS_ARCH_CANCELED) {
-			return SYS_ARCH_CANCELED;
-		}		
-	}
-
-	if (msg != NULL) {
-		*msg = mbox->msgs[mbox->front];
-		LWIP_DEBUGF(SYS_DEBUG, (" mbox %p msg %p\n", (void *)mbox, *msg));
-	} else {
-		LWIP_DEBUGF(SYS_DEBUG, (" mbox %p, null msg\n", (void *)mbox));
-	}
-
-	mbox->front = (mbox->front + 1) % mbox->queue_size;
+		if (status == SYS_ARCH_TIMEOUT || status == SYS_ARCH_CANCELED) {
+			mbox_unwait(&(mbox->mail), &(mbox->wait_fetch));
+			if (status == SYS_ARCH_CANCELED || mbox_get(mbox, msg, 1, false) == 0) {
+				return status;
+			}
+			break;
+		}
 
-	/* We just fetched a msg, Release semaphore for
-	   some post api blocked on this sem due to queue full. */
-	if (mbox->wait_send) {
-		sys_sem_signal(&(mbox->mail));
+		/* Another fetcher may have taken the message */
+		elapsed = TICK2MSEC(clock_systimer() - start);
 	}
 
-	sys_sem_signal(&(mbox->mutex));
-
-	return time;
+	LWIP_DEBUGF(SYS_DEBUG, (" mbox %p msg %p\n", (void *)mbox, *msg));
+	return TICK2MSEC(clock_systimer() - start);
 }
 
 /*---------------------------------------------------------------------------*
@@ -323,36 +360,34 @@ u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
  *---------------------------------------------------------------------------*/
 u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
 {
-	u32_t err = ERR_OK;
-	/* The mutex lock is quick so we don't bother with the timeout
-	   stuff here. */
-	sys_arch_sem_wait(&(mbox->mutex), 0);
+	void *dropped;
 
-	/* check if the queue is empty */
-	if (mbox->front == mbox->rear) {
+	if (mbox_get(mbox, msg != NULL ? msg : &dropped, 1, false) == 0) {
 		LWIP_DEBUGF(SYS_DEBUG, ("SYS_MBOX_EMPTY , returning\n"));
-		err = SYS_MBOX_EMPTY;
-		goto errout_with_mutex;
+		return SYS_MBOX_EMPTY;
 	}
 
-	if (msg != NULL) {
-		LWIP_DEBUGF(SYS_DEBUG, ("mbox %p msg %p\n", (void *)mbox, *msg));
-		*msg = mbox->msgs[mbox->front];
-	} else {
-		LWIP_DEBUGF(SYS_DEBUG, ("mbox %p, null msg\n", (void *)mbox));
-	}
-
-	mbox->front = (mbox->front + 1) % mbox->queue_size;
-
-	/* We just fetched a msg, Release semaphore for
-	   some post api blocked on this sem due to queue full. */
-	if (mbox->wait_send) {
-		sys_sem_signal(&(mbox->mail));
-	}
+	LWIP_DEBUGF(SYS_DEBUG, ("mbox %p msg %p\n", (void *)mbox, msg != NULL ? *msg : NULL));
+	return ERR_OK;
+}
 
-errout_with_mutex:
-	sys_sem_signal(&(mbox->mutex));
-	return err;
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_tryfetch_batch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Takes the messages ready in the mailbox, up to "max", without
+ *      blocking, so that a thread woken up by one message can also handle
+ *      the messages posted meanwhile.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void **msgs             -- Array receiving the messages
+ *      u32_t max               -- Size of the array
+ * Outputs:
+ *      u32_t                   -- Number of messages received
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_tryfetch_batch(sys_mbox_t *mbox, void **msgs, u32_t max)
+{
+	return mbox_get(mbox, msgs, max, false);
 }
 
 /*---------------------------------------------------------------------------*
@@ -629,6 +664,77 @@ void sys_mutex_unlock(sys_mutex_t *mutex)
 #endif							/*LWIP_COMPAT_MUTEX */
 /*-----------------------------------------------------------------------------------*/
 
+#if LWIP_TCPIP_CORE_LOCKING
+/*---------------------------------------------------------------------------*
+ * Core lock
+ *---------------------------------------------------------------------------*
+ * LOCK_TCPIP_CORE() and net_lock() take the same lock, so the socket calls
+ * run the stack code in the calling thread.  The lock is recursive, a thread
+ * holding net_lock() can call the socket layer, and its semaphore inherits
+ * the priority of the waiters, a low priority thread holding the core does
+ * not hold back tcpip_thread longer than needed.
+ *---------------------------------------------------------------------------*/
+#define CORE_NO_HOLDER ((pid_t)-1)
+
+static sem_t g_core_sem = SEM_INITIALIZER(1);
+static pid_t g_core_holder = CORE_NO_HOLDER;
+static u32_t g_core_depth;
+
+void sys_arch_core_lock(void)
+{
+	pid_t me = getpid();
+
+	if (g_core_holder == me) {
+		g_core_depth++;
+		return;
+	}
+
+	while (sem_wait(&g_core_sem) != OK) {
+		/* only a signal can wake us up early */
+		LWIP_ASSERT("sys_arch_core_lock: sem_wait failed", errno == EINTR);
+	}
+	g_core_holder = me;
+	g_core_depth = 1;
+}
+
+void sys_arch_core_unlock(void)
+{
+	LWIP_ASSERT("sys_arch_core_unlock: not the holder", g_core_holder == getpid() && g_core_depth > 0);
+
+	if (--g_core_depth == 0) {
+		g_core_holder = CORE_NO_HOLDER;
+		sem_post(&g_core_sem);
+	}
+}
+
+/* Releases the core lock however many times the calling thread took it,
+ * before it waits for the stack.  Returns the depth to pass to
+ * sys_arch_core_restore(), 0 if the thread did not hold the lock.
+ */
+u32_t sys_arch_core_release(void)
+{
+	u32_t depth;
+
+	if (g_core_holder != getpid()) {
+		return 0;
+	}
+
+	depth = g_core_depth;
+	g_core_holder = CORE_NO_HOLDER;
+	g_core_depth = 0;
+	sem_post(&g_core_sem);
+	return depth;
+}
+
+void sys_arch_core_restore(u32_t depth)
+{
+	if (depth > 0) {
+		sys_arch_core_lock();
+		g_core_depth = depth;
+	}
+}
+#endif							/* LWIP_TCPIP_CORE_LOCKING */
+
 systime_t sys_now(void)
 {
 	return TICK2MSEC(clock_systimer());
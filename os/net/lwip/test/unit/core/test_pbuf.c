@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "test_pbuf.h"
+
+#include <net/lwip/pbuf.h>
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "This tests needs custom pbufs enabled"
+#endif
+
+static int custom_freed;
+
+static void custom_free(struct pbuf *p)
+{
+	LWIP_UNUSED_ARG(p);
+	custom_freed++;
+}
+
+/* Setups/teardown functions */
+
+static void pbuf_setup(void)
+{
+	custom_freed = 0;
+}
+
+static void pbuf_teardown(void)
+{
+}
+
+/* Test functions */
+
+/** A custom pbuf wrapping a received frame can show the headers hidden
+ * in its buffer again, but not move before the buffer, and gives the
+ * buffer back through its free function */
+START_TEST(test_pbuf_custom_header)
+{
+#define FRAME_LEN 64
+#define LINK_HLEN 14
+	u8_t frame[FRAME_LEN];
+	struct pbuf_custom pc;
+	struct pbuf *p;
+	LWIP_UNUSED_ARG(_i);
+
+	pc.custom_free_function = custom_free;
+	p = pbuf_alloced_custom(PBUF_RAW, FRAME_LEN, PBUF_REF, &pc, frame, sizeof(frame));
+	fail_unless(p == &pc.pbuf);
+	fail_unless(p->payload == frame);
+
+	fail_unless(pbuf_header(p, 1) != 0);
+
+	fail_unless(pbuf_header(p, -LINK_HLEN) == 0);
+	fail_unless(p->payload == &frame[LINK_HLEN]);
+	fail_unless(p->len == FRAME_LEN - LINK_HLEN);
+
+	fail_unless(pbuf_header(p, LINK_HLEN + 1) != 0);
+	fail_unless(p->payload == &frame[LINK_HLEN]);
+
+	fail_unless(pbuf_header(p, LINK_HLEN) == 0);
+	fail_unless(p->payload == frame);
+	fail_unless(p->tot_len == FRAME_LEN);
+
+	fail_unless(pbuf_free(p) == 1);
+	fail_unless(custom_freed == 1);
+}
+
+END_TEST
+/** Create the suite including all tests for this module */
+Suite *pbuf_suite(void)
+{
+	TFun tests[] = {
+		test_pbuf_custom_header
+	};
+	return create_suite("PBUF", tests, sizeof(tests) / sizeof(TFun), pbuf_setup, pbuf_teardown);
+}
@@ -62,6 +62,14 @@
 #define TCP_SND_BUF                     (12 * TCP_MSS)
 #define TCP_WND                         (10 * TCP_MSS)
 
+/* Minimal changes to opt.h required for tcp demux unit tests: */
+#define MEMP_NUM_TCP_PCB                256
+
+/* Minimal changes to opt.h required for tcp sack unit tests: */
+#define LWIP_WND_SCALE                  1
+#define TCP_RCV_SCALE                   2
+#define LWIP_TCP_SACK                   1
+
 /* Minimal changes to opt.h required for etharp unit tests: */
 #define ETHARP_SUPPORT_STATIC_ENTRIES   1
 
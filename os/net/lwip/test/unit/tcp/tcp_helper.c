@@ -52,21 +52,24 @@ void tcp_remove_all(void)
 	fail_unless(lwip_stats.memp[MEMP_PBUF_POOL].used == 0);
 }
 
-/** Create a TCP segment usable for passing to tcp_input */
-static struct pbuf *tcp_create_segment_wnd(ip_addr_t *src_ip, ip_addr_t *dst_ip, u16_t src_port, u16_t dst_port, void *data, size_t data_len, u32_t seqno, u32_t ackno, u8_t headerflags, u16_t wnd)
+/** Create a TCP segment with header options usable for passing to tcp_input
+ * - optlen must be a multiple of 4
+ */
+struct pbuf *tcp_create_segment_opts(ip_addr_t *src_ip, ip_addr_t *dst_ip, u16_t src_port, u16_t dst_port, void *data, size_t data_len, u32_t seqno, u32_t ackno, u8_t headerflags, u16_t wnd, u8_t *opts, u8_t optlen)
 {
 	struct pbuf *p, *q;
 	struct ip_hdr *iphdr;
 	struct tcp_hdr *tcphdr;
-	u16_t pbuf_len = (u16_t)(sizeof(struct ip_hdr) + sizeof(struct tcp_hdr) + data_len);
+	u16_t pbuf_len = (u16_t)(sizeof(struct ip_hdr) + sizeof(struct tcp_hdr) + optlen + data_len);
 
+	EXPECT_RETNULL((optlen & 3) == 0);
 	p = pbuf_alloc(PBUF_RAW, pbuf_len, PBUF_POOL);
 	EXPECT_RETNULL(p != NULL);
 	/* first pbuf must be big enough to hold the headers */
-	EXPECT_RETNULL(p->len >= (sizeof(struct ip_hdr) + sizeof(struct tcp_hdr)));
+	EXPECT_RETNULL(p->len >= (sizeof(struct ip_hdr) + sizeof(struct tcp_hdr) + optlen));
 	if (data_len > 0) {
 		/* first pbuf must be big enough to hold at least 1 data byte, too */
-		EXPECT_RETNULL(p->len > (sizeof(struct ip_hdr) + sizeof(struct tcp_hdr)));
+		EXPECT_RETNULL(p->len > (sizeof(struct ip_hdr) + sizeof(struct tcp_hdr) + optlen));
 	}
 
 	for (q = p; q != NULL; q = q->next) {
@@ -90,17 +93,20 @@ static struct pbuf *tcp_create_segment_wnd(ip_addr_t *src_ip, ip_addr_t *dst_ip,
 	tcphdr->dest = htons(dst_port);
 	tcphdr->seqno = htonl(seqno);
 	tcphdr->ackno = htonl(ackno);
-	TCPH_HDRLEN_SET(tcphdr, sizeof(struct tcp_hdr) / 4);
+	TCPH_HDRLEN_SET(tcphdr, (sizeof(struct tcp_hdr) + optlen) / 4);
 	TCPH_FLAGS_SET(tcphdr, headerflags);
 	tcphdr->wnd = htons(wnd);
+	if (optlen > 0) {
+		memcpy(tcphdr + 1, opts, optlen);
+	}
 
 	if (data_len > 0) {
 		/* let p point to TCP data */
-		pbuf_header(p, -(s16_t)sizeof(struct tcp_hdr));
+		pbuf_header(p, -(s16_t)(sizeof(struct tcp_hdr) + optlen));
 		/* copy data */
 		pbuf_take(p, data, data_len);
 		/* let p point to TCP header again */
-		pbuf_header(p, sizeof(struct tcp_hdr));
+		pbuf_header(p, sizeof(struct tcp_hdr) + optlen);
 	}
 
 	/* calculate checksum */
@@ -115,7 +121,7 @@ static struct pbuf *tcp_create_segment_wnd(ip_addr_t *src_ip, ip_addr_t *dst_ip,
 /** Create a TCP segment usable for passing to tcp_input */
 struct pbuf *tcp_create_segment(ip_addr_t *src_ip, ip_addr_t *dst_ip, u16_t src_port, u16_t dst_port, void *data, size_t data_len, u32_t seqno, u32_t ackno, u8_t headerflags)
 {
-	return tcp_create_segment_wnd(src_ip, dst_ip, src_port, dst_port, data, data_len, seqno, ackno, headerflags, TCP_WND);
+	return tcp_create_segment_opts(src_ip, dst_ip, src_port, dst_port, data, data_len, seqno, ackno, headerflags, TCP_WND, NULL, 0);
 }
 
 /** Create a TCP segment usable for passing to tcp_input
@@ -134,7 +140,17 @@ struct pbuf *tcp_create_rx_segment(struct tcp_pcb *pcb, void *data, size_t data_
  */
 struct pbuf *tcp_create_rx_segment_wnd(struct tcp_pcb *pcb, void *data, size_t data_len, u32_t seqno_offset, u32_t ackno_offset, u8_t headerflags, u16_t wnd)
 {
-	return tcp_create_segment_wnd(&pcb->remote_ip, &pcb->local_ip, pcb->remote_port, pcb->local_port, data, data_len, pcb->rcv_nxt + seqno_offset, pcb->lastack + ackno_offset, headerflags, wnd);
+	return tcp_create_segment_opts(&pcb->remote_ip, &pcb->local_ip, pcb->remote_port, pcb->local_port, data, data_len, pcb->rcv_nxt + seqno_offset, pcb->lastack + ackno_offset, headerflags, wnd, NULL, 0);
+}
+
+/** Create a TCP segment usable for passing to tcp_input
+ * - IP-addresses, ports, seqno and ackno are taken from pcb
+ * - seqno and ackno can be altered with an offset
+ * - TCP window and header options can be adjusted
+ */
+struct pbuf *tcp_create_rx_segment_opts(struct tcp_pcb *pcb, void *data, size_t data_len, u32_t seqno_offset, u32_t ackno_offset, u8_t headerflags, u16_t wnd, u8_t *opts, u8_t optlen)
+{
+	return tcp_create_segment_opts(&pcb->remote_ip, &pcb->local_ip, pcb->remote_port, pcb->local_port, data, data_len, pcb->rcv_nxt + seqno_offset, pcb->lastack + ackno_offset, headerflags, wnd, opts, optlen);
 }
 
 /** Safely bring a tcp_pcb into the requested state */
@@ -143,22 +159,23 @@ void tcp_set_state(struct tcp_pcb *pcb, enum tcp_state state, ip_addr_t *local_i
 	/* @todo: are these all states? */
 	/* @todo: remove from previous list */
 	pcb->state = state;
+	/* the addresses and ports are set first, TCP_REG hashes the pcb on them */
 	if (state == ESTABLISHED) {
-		TCP_REG(&tcp_active_pcbs, pcb);
 		pcb->local_ip.addr = local_ip->addr;
 		pcb->local_port = local_port;
 		pcb->remote_ip.addr = remote_ip->addr;
 		pcb->remote_port = remote_port;
+		TCP_REG(&tcp_active_pcbs, pcb);
 	} else if (state == LISTEN) {
-		TCP_REG(&tcp_listen_pcbs.pcbs, pcb);
 		pcb->local_ip.addr = local_ip->addr;
 		pcb->local_port = local_port;
+		TCP_REG(&tcp_listen_pcbs.pcbs, pcb);
 	} else if (state == TIME_WAIT) {
-		TCP_REG(&tcp_tw_pcbs, pcb);
 		pcb->local_ip.addr = local_ip->addr;
 		pcb->local_port = local_port;
 		pcb->remote_ip.addr = remote_ip->addr;
 		pcb->remote_port = remote_port;
+		TCP_REG(&tcp_tw_pcbs, pcb);
 	} else {
 		fail();
 	}
@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "test_tcp_demux.h"
+
+#include <net/lwip/tcp_impl.h>
+#include <net/lwip/stats.h>
+#include "tcp_helper.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#if !LWIP_STATS || !TCP_STATS || !MEMP_STATS
+#error "This tests needs TCP- and MEMP-statistics enabled"
+#endif
+
+/* number of segments passed to tcp_input per round of test_tcp_demux_cost */
+#define TEST_TCP_DEMUX_SEGMENTS 4096
+
+static struct tcp_pcb *test_pcbs[MEMP_NUM_TCP_PCB];
+static struct test_tcp_counters test_counters[MEMP_NUM_TCP_PCB];
+
+/* Setups/teardown functions */
+
+static void tcp_demux_setup(void)
+{
+	tcp_ticks = 0;
+	tcp_remove_all();
+}
+
+static void tcp_demux_teardown(void)
+{
+	netif_list = NULL;
+	tcp_remove_all();
+}
+
+/* Helper functions */
+
+/** Create num ESTABLISHED pcbs on local_port, one per remote port starting at
+ * remote_port, so that they spread over the buckets of tcp_active_hash */
+static void test_tcp_demux_connect(int num, ip_addr_t *local_ip, ip_addr_t *remote_ip, u16_t local_port, u16_t remote_port)
+{
+	int i;
+
+	memset(test_counters, 0, sizeof(test_counters));
+	for (i = 0; i < num; i++) {
+		test_pcbs[i] = test_tcp_new_counters_pcb(&test_counters[i]);
+		EXPECT_RET(test_pcbs[i] != NULL);
+		tcp_set_state(test_pcbs[i], ESTABLISHED, local_ip, remote_ip, local_port, (u16_t)(remote_port + i));
+	}
+}
+
+/* Test functions */
+
+/** Pass a segment to each of many ESTABLISHED pcbs and check that every pcb
+ * received exactly its own segment */
+START_TEST(test_tcp_demux_active)
+{
+	char data[] = { 1, 2, 3, 4 };
+	ip_addr_t remote_ip, local_ip;
+	struct netif netif;
+	struct pbuf *p;
+	int num = MEMP_NUM_TCP_PCB;
+	int i;
+	LWIP_UNUSED_ARG(_i);
+
+	memset(&netif, 0, sizeof(netif));
+	IP4_ADDR(&local_ip, 192, 168, 1, 1);
+	IP4_ADDR(&remote_ip, 192, 168, 1, 2);
+	test_tcp_demux_connect(num, &local_ip, &remote_ip, 80, 0x1000);
+	EXPECT_RET(lwip_stats.memp[MEMP_TCP_PCB].used == num);
+
+	/* the last pcb created is at the head of tcp_active_pcbs, start at the other end */
+	for (i = 0; i < num; i++) {
+		p = tcp_create_rx_segment(test_pcbs[i], data, sizeof(data), 0, 0, 0);
+		EXPECT_RET(p != NULL);
+		test_tcp_input(p, &netif);
+	}
+	for (i = 0; i < num; i++) {
+		EXPECT(test_counters[i].recv_calls == 1);
+		EXPECT(test_counters[i].recved_bytes == sizeof(data));
+		EXPECT(test_counters[i].err_calls == 0);
+	}
+	/* a segment for a port no pcb is connected to is refused */
+	i = lwip_stats.tcp.proterr;
+	p = tcp_create_segment(&remote_ip, &local_ip, (u16_t)(0x1000 + num), 80, data, sizeof(data), 0, 0, TCP_ACK);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &netif);
+	EXPECT(lwip_stats.tcp.proterr == i + 1);
+	EXPECT(lwip_stats.memp[MEMP_PBUF_POOL].used == 0);
+}
+
+END_TEST
+/** Check that segments reach TIME-WAIT and LISTENing pcbs, and that a SYN
+ * of an accepted connection goes to the new pcb instead of the listener */
+START_TEST(test_tcp_demux_tw_listen)
+{
+	struct tcp_pcb *pcb, *tw_pcb;
+	struct tcp_pcb_listen *lpcb;
+	ip_addr_t remote_ip, local_ip;
+	struct netif netif;
+	struct pbuf *p;
+	err_t err;
+	u16_t tw_port = 0x2000;
+	u16_t syn_port = tw_port + TCP_PCB_HASH_SIZE;
+	LWIP_UNUSED_ARG(_i);
+
+	memset(&netif, 0, sizeof(netif));
+	IP4_ADDR(&local_ip, 192, 168, 1, 1);
+	IP4_ADDR(&remote_ip, 192, 168, 1, 2);
+
+	/* a listener and a TIME-WAIT connection on the same local port */
+	pcb = tcp_new();
+	EXPECT_RET(pcb != NULL);
+	err = tcp_bind(pcb, &local_ip, 80);
+	EXPECT_RET(err == ERR_OK);
+	lpcb = (struct tcp_pcb_listen *)tcp_listen(pcb);
+	EXPECT_RET(lpcb != NULL);
+	tw_pcb = tcp_new();
+	EXPECT_RET(tw_pcb != NULL);
+	tcp_set_state(tw_pcb, TIME_WAIT, &local_ip, &remote_ip, 80, tw_port);
+
+	/* a FIN of the TIME-WAIT connection restarts its timer */
+	tcp_ticks = 100;
+	p = tcp_create_rx_segment(tw_pcb, NULL, 0, 0, 0, TCP_FIN | TCP_ACK);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &netif);
+	EXPECT(tw_pcb->tmr == 100);
+	EXPECT(lwip_stats.memp[MEMP_TCP_PCB].used == 1);
+
+	/* a SYN from another port is accepted by the listener */
+	p = tcp_create_segment(&remote_ip, &local_ip, syn_port, 80, NULL, 0, 1000, 0, TCP_SYN);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &netif);
+	EXPECT_RET(lwip_stats.memp[MEMP_TCP_PCB].used == 2);
+	EXPECT_RET(tcp_active_pcbs != NULL);
+	EXPECT(tcp_active_pcbs->state == SYN_RCVD);
+	EXPECT(tcp_active_pcbs->remote_port == syn_port);
+
+	/* its retransmission goes to the new pcb, not to the listener again */
+	p = tcp_create_segment(&remote_ip, &local_ip, syn_port, 80, NULL, 0, 1000, 0, TCP_SYN);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &netif);
+	EXPECT(lwip_stats.memp[MEMP_TCP_PCB].used == 2);
+#if TCP_LISTEN_BACKLOG
+	EXPECT(lpcb->accepts_pending == 1);
+#endif
+
+	/* the new pcb refers to the listener when it is purged, remove it first */
+	tcp_abort(tcp_active_pcbs);
+	err = tcp_close((struct tcp_pcb *)lpcb);
+	EXPECT(err == ERR_OK);
+}
+
+END_TEST
+/** Measure the cost of tcp_input per segment against the number of
+ * connections. With the hash tables it should stay about the same. */
+START_TEST(test_tcp_demux_cost)
+{
+	char data[] = { 1, 2, 3, 4 };
+	ip_addr_t remote_ip, local_ip;
+	struct netif netif;
+	struct pbuf *p;
+	clock_t start, elapsed;
+	int num, i;
+	LWIP_UNUSED_ARG(_i);
+
+	memset(&netif, 0, sizeof(netif));
+	IP4_ADDR(&local_ip, 192, 168, 1, 1);
+	IP4_ADDR(&remote_ip, 192, 168, 1, 2);
+
+	for (num = 1; num <= MEMP_NUM_TCP_PCB; num *= 4) {
+		test_tcp_demux_connect(num, &local_ip, &remote_ip, 80, 0x1000);
+		EXPECT_RET(lwip_stats.memp[MEMP_TCP_PCB].used == num);
+
+		elapsed = 0;
+		for (i = 0; i < TEST_TCP_DEMUX_SEGMENTS; i++) {
+			struct tcp_pcb *pcb = test_pcbs[i % num];
+			p = tcp_create_rx_segment(pcb, data, sizeof(data), 0, 0, 0);
+			EXPECT_RET(p != NULL);
+			start = clock();
+			test_tcp_input(p, &netif);
+			elapsed += clock() - start;
+			tcp_recved(pcb, sizeof(data));
+		}
+		for (i = 0; i < num; i++) {
+			EXPECT(test_counters[i].recved_bytes == (TEST_TCP_DEMUX_SEGMENTS / num) * sizeof(data));
+		}
+		printf("tcp_input: %3d connections, %lu ns per segment\n", num, (unsigned long)((double)elapsed * 1000000000.0 / CLOCKS_PER_SEC / TEST_TCP_DEMUX_SEGMENTS));
+
+		tcp_remove_all();
+	}
+}
+
+END_TEST
+/** Create the suite including all tests for this module */
+Suite *tcp_demux_suite(void)
+{
+	TFun tests[] = {
+		test_tcp_demux_active,
+		test_tcp_demux_tw_listen,
+		test_tcp_demux_cost
+	};
+	return create_suite("TCP_DEMUX", tests, sizeof(tests) / sizeof(TFun), tcp_demux_setup, tcp_demux_teardown);
+}
@@ -0,0 +1,590 @@
+/****************************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "test_tcp_sack.h"
+
+#include <net/lwip/tcp_impl.h>
+#include <net/lwip/stats.h>
+#include "tcp_helper.h"
+
+#if !LWIP_STATS || !TCP_STATS || !MEMP_STATS
+#error "This tests needs TCP- and MEMP-statistics enabled"
+#endif
+#if !LWIP_WND_SCALE || !LWIP_TCP_SACK
+#error "This tests needs LWIP_WND_SCALE and LWIP_TCP_SACK enabled"
+#endif
+
+/* number of mss-sized segments the sender tests can write */
+#define TEST_TCP_SACK_SEGS 8
+/* length of the segments passed to the receiver in test_tcp_sack_rx_blocks */
+#define TEST_TCP_SACK_LEN  100
+
+static char test_data[TEST_TCP_SACK_SEGS * TCP_MSS];
+/* sequence number of the first data byte, SACK edges are relative to it */
+static u32_t test_base;
+
+static struct netif test_netif;
+static struct test_tcp_txcounters test_txcounters;
+static ip_addr_t test_local_ip, test_remote_ip, test_netmask;
+static const u16_t test_local_port = 0x101, test_remote_port = 0x100;
+
+/* Helper functions */
+
+/** Free the copies of the packets sent so far and reset the tx counters */
+static void test_tcp_sack_reset_tx(void)
+{
+	if (test_txcounters.tx_packets != NULL) {
+		pbuf_free(test_txcounters.tx_packets);
+	}
+	memset(&test_txcounters, 0, sizeof(test_txcounters));
+	test_txcounters.copy_tx_packets = 1;
+}
+
+/** Get the TCP header of the n-th packet sent since the last reset */
+static struct tcp_hdr *test_tcp_sack_tx_hdr(u16_t n)
+{
+	struct pbuf *q = test_txcounters.tx_packets;
+
+	for (; (q != NULL) && (n > 0); n--) {
+		q = q->next;
+	}
+	if (q == NULL) {
+		return NULL;
+	}
+	return (struct tcp_hdr *)((u8_t *)q->payload + IP_HLEN);
+}
+
+/** Find the option of the given kind in a TCP header */
+static u8_t *test_tcp_sack_get_opt(struct tcp_hdr *tcphdr, u8_t kind)
+{
+	u8_t *opts = (u8_t *)tcphdr + TCP_HLEN;
+	u16_t optlen = TCPH_HDRLEN(tcphdr) * 4 - TCP_HLEN;
+	u16_t c = 0;
+
+	while ((c < optlen) && (opts[c] != 0x00)) {
+		if (opts[c] == 0x01) {
+			c++;
+			continue;
+		}
+		if (opts[c] == kind) {
+			return &opts[c];
+		}
+		if ((c + 1 >= optlen) || (opts[c + 1] == 0)) {
+			break;
+		}
+		c += opts[c + 1];
+	}
+	return NULL;
+}
+
+static u32_t test_tcp_sack_get_u32(u8_t *p)
+{
+	return ((u32_t)p[0] << 24) | ((u32_t)p[1] << 16) | ((u32_t)p[2] << 8) | p[3];
+}
+
+static void test_tcp_sack_put_u32(u8_t *p, u32_t val)
+{
+	p[0] = (u8_t)(val >> 24);
+	p[1] = (u8_t)(val >> 16);
+	p[2] = (u8_t)(val >> 8);
+	p[3] = (u8_t)val;
+}
+
+/** Check that exactly one ACK for ackno was sent, carrying the num SACK
+ * blocks in edges (all relative to test_base) */
+static void test_tcp_sack_expect_ack(u32_t ackno, const u32_t *edges, u8_t num)
+{
+	struct tcp_hdr *tcphdr = test_tcp_sack_tx_hdr(0);
+	u8_t *opt;
+	u8_t i;
+
+	EXPECT(test_txcounters.num_tx_calls == 1);
+	EXPECT_RET(tcphdr != NULL);
+	EXPECT(ntohl(tcphdr->ackno) == test_base + ackno);
+	opt = test_tcp_sack_get_opt(tcphdr, 0x05);
+	if (num == 0) {
+		EXPECT(opt == NULL);
+	} else {
+		EXPECT_RET(opt != NULL);
+		EXPECT_RET(opt[1] == LWIP_TCP_SACK_OPT_LENGTH(num) - 2);
+		for (i = 0; i < 2 * num; i++) {
+			EXPECT(test_tcp_sack_get_u32(&opt[2 + 4 * i]) == test_base + edges[i]);
+		}
+	}
+	test_tcp_sack_reset_tx();
+}
+
+/** Check that exactly the mss-sized segment seg was (re)transmitted */
+static void test_tcp_sack_expect_tx(u8_t seg)
+{
+	struct tcp_hdr *tcphdr = test_tcp_sack_tx_hdr(0);
+
+	EXPECT(test_txcounters.num_tx_calls == 1);
+	EXPECT(tcphdr != NULL);
+	if (tcphdr != NULL) {
+		EXPECT(ntohl(tcphdr->seqno) == test_base + seg * TCP_MSS);
+	}
+	test_tcp_sack_reset_tx();
+}
+
+/** Pass TEST_TCP_SACK_LEN bytes of data at offset off to pcb */
+static void test_tcp_sack_rx_data(struct tcp_pcb *pcb, u32_t off)
+{
+	struct pbuf *p;
+
+	p = tcp_create_rx_segment(pcb, &test_data[off], TEST_TCP_SACK_LEN, test_base + off - pcb->rcv_nxt, 0, TCP_ACK);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &test_netif);
+}
+
+/** Pass an ACK up to the mss-sized segment ackseg to pcb, with SACK blocks
+ * for the num segment ranges [segs[2i], segs[2i+1]) */
+static void test_tcp_sack_rx_ack(struct tcp_pcb *pcb, u8_t ackseg, const u8_t *segs, u8_t num)
+{
+	u8_t opts[LWIP_TCP_SACK_OPT_LENGTH(4)];
+	struct pbuf *p;
+	u8_t i;
+
+	opts[0] = 0x01;
+	opts[1] = 0x01;
+	opts[2] = 0x05;
+	opts[3] = LWIP_TCP_SACK_OPT_LENGTH(num) - 2;
+	for (i = 0; i < 2 * num; i++) {
+		test_tcp_sack_put_u32(&opts[4 + 4 * i], test_base + segs[i] * TCP_MSS);
+	}
+	p = tcp_create_rx_segment_opts(pcb, NULL, 0, 0, test_base + ackseg * TCP_MSS - pcb->lastack, TCP_ACK, TCP_WND, opts, (num > 0) ? LWIP_TCP_SACK_OPT_LENGTH(num) : 0);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &test_netif);
+}
+
+/** Create an ESTABLISHED pcb that negotiated SACK and send num mss-sized
+ * segments from it */
+static struct tcp_pcb *test_tcp_sack_sender(struct test_tcp_counters *counters, u8_t num)
+{
+	struct tcp_pcb *pcb;
+	err_t err;
+	u8_t i;
+
+	memset(counters, 0, sizeof(*counters));
+	pcb = test_tcp_new_counters_pcb(counters);
+	EXPECT_RETNULL(pcb != NULL);
+	tcp_set_state(pcb, ESTABLISHED, &test_local_ip, &test_remote_ip, test_local_port, test_remote_port);
+	pcb->mss = TCP_MSS;
+	pcb->flags |= TF_SACK;
+	/* let the whole flight go out at once */
+	pcb->cwnd = num * TCP_MSS;
+	test_base = pcb->snd_nxt;
+
+	for (i = 0; i < num; i++) {
+		err = tcp_write(pcb, &test_data[i * TCP_MSS], TCP_MSS, TCP_WRITE_FLAG_COPY);
+		EXPECT_RETNULL(err == ERR_OK);
+	}
+	err = tcp_output(pcb);
+	EXPECT_RETNULL(err == ERR_OK);
+	EXPECT(test_txcounters.num_tx_calls == num);
+	test_tcp_sack_reset_tx();
+	return pcb;
+}
+
+static err_t test_tcp_sack_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+	LWIP_UNUSED_ARG(arg);
+	LWIP_UNUSED_ARG(pcb);
+	LWIP_UNUSED_ARG(err);
+	return ERR_OK;
+}
+
+/** Open a connection to a peer that answers with or without the options */
+static void test_tcp_wnd_scale_connect(u8_t peer_opts)
+{
+	/* NOP, window scale 5, NOP, NOP, SACK permitted */
+	u8_t synack_opts[] = { 0x01, 0x03, 0x03, 0x05, 0x01, 0x01, 0x04, 0x02 };
+	struct test_tcp_counters counters;
+	struct tcp_pcb *pcb;
+	struct tcp_hdr *tcphdr;
+	struct pbuf *p;
+	u8_t *opt;
+	err_t err;
+
+	memset(&counters, 0, sizeof(counters));
+	pcb = test_tcp_new_counters_pcb(&counters);
+	EXPECT_RET(pcb != NULL);
+	err = tcp_connect(pcb, &test_remote_ip, test_remote_port, NULL);
+	EXPECT_RET(err == ERR_OK);
+
+	/* the SYN offers both options, its own window is never scaled */
+	EXPECT_RET(test_txcounters.num_tx_calls == 1);
+	tcphdr = test_tcp_sack_tx_hdr(0);
+	EXPECT_RET(tcphdr != NULL);
+	EXPECT(TCPH_FLAGS(tcphdr) == TCP_SYN);
+	EXPECT(ntohs(tcphdr->wnd) == TCPWND_MIN16(TCP_WND));
+	opt = test_tcp_sack_get_opt(tcphdr, 0x03);
+	EXPECT(opt != NULL && opt[1] == 3 && opt[2] == TCP_RCV_SCALE);
+	EXPECT(test_tcp_sack_get_opt(tcphdr, 0x04) != NULL);
+	EXPECT(test_tcp_sack_get_opt(tcphdr, 0x02) != NULL);
+	test_tcp_sack_reset_tx();
+
+	p = tcp_create_rx_segment_opts(pcb, NULL, 0, 0, 1, TCP_SYN | TCP_ACK, 1000, synack_opts, peer_opts ? sizeof(synack_opts) : 0);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &test_netif);
+	EXPECT_RET(pcb->state == ESTABLISHED);
+	EXPECT(pcb->snd_wnd == 1000);
+
+	/* the ACK of the SYN|ACK announces our window scaled (or not) */
+	EXPECT_RET(test_txcounters.num_tx_calls == 1);
+	tcphdr = test_tcp_sack_tx_hdr(0);
+	EXPECT_RET(tcphdr != NULL);
+	if (peer_opts) {
+		EXPECT(pcb->flags & TF_WND_SCALE);
+		EXPECT(pcb->flags & TF_SACK);
+		EXPECT(pcb->snd_scale == 5);
+		EXPECT(pcb->rcv_scale == TCP_RCV_SCALE);
+		EXPECT(pcb->rcv_wnd == TCP_WND);
+		EXPECT(ntohs(tcphdr->wnd) == TCPWND16(TCP_WND >> TCP_RCV_SCALE));
+	} else {
+		EXPECT(!(pcb->flags & TF_WND_SCALE));
+		EXPECT(!(pcb->flags & TF_SACK));
+		EXPECT(pcb->snd_scale == 0);
+		EXPECT(pcb->rcv_scale == 0);
+		EXPECT(pcb->rcv_wnd == TCPWND_MIN16(TCP_WND));
+		EXPECT(ntohs(tcphdr->wnd) == TCPWND_MIN16(TCP_WND));
+	}
+	test_tcp_sack_reset_tx();
+
+	/* window updates of the peer are scaled from now on */
+	p = tcp_create_rx_segment_wnd(pcb, NULL, 0, 0, 0, TCP_ACK, 1000);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &test_netif);
+	EXPECT(pcb->snd_wnd == (peer_opts ? (1000UL << 5) : 1000UL));
+	EXPECT(test_txcounters.num_tx_calls == 0);
+
+	tcp_abort(pcb);
+	EXPECT(lwip_stats.memp[MEMP_TCP_PCB].used == 0);
+}
+
+/* Setups/teardown functions */
+
+static void tcp_sack_setup(void)
+{
+	u32_t i;
+
+	tcp_ticks = 0;
+	tcp_remove_all();
+	for (i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = (char)i;
+	}
+	IP4_ADDR(&test_local_ip, 192, 168, 1, 1);
+	IP4_ADDR(&test_remote_ip, 192, 168, 1, 2);
+	IP4_ADDR(&test_netmask, 255, 255, 255, 0);
+	test_tcp_init_netif(&test_netif, &test_txcounters, &test_local_ip, &test_netmask);
+	test_txcounters.copy_tx_packets = 1;
+}
+
+static void tcp_sack_teardown(void)
+{
+	test_tcp_sack_reset_tx();
+	netif_list = NULL;
+	tcp_remove_all();
+}
+
+/* Test functions */
+
+/** Pass a SYN with window scale and SACK permitted options to a listening pcb
+ * and check that both are negotiated and the windows are scaled */
+START_TEST(test_tcp_wnd_scale_listen)
+{
+	/* NOP, window scale 3, NOP, NOP, SACK permitted */
+	u8_t syn_opts[] = { 0x01, 0x03, 0x03, 0x03, 0x01, 0x01, 0x04, 0x02 };
+	struct tcp_pcb *lpcb, *pcb;
+	struct tcp_hdr *tcphdr;
+	struct pbuf *p;
+	u8_t *opt;
+	err_t err;
+	LWIP_UNUSED_ARG(_i);
+
+	pcb = tcp_new();
+	EXPECT_RET(pcb != NULL);
+	err = tcp_bind(pcb, &test_local_ip, test_local_port);
+	EXPECT_RET(err == ERR_OK);
+	lpcb = tcp_listen(pcb);
+	EXPECT_RET(lpcb != NULL);
+	tcp_accept(lpcb, test_tcp_sack_accept);
+
+	p = tcp_create_segment_opts(&test_remote_ip, &test_local_ip, test_remote_port, test_local_port, NULL, 0, 1000, 0, TCP_SYN, 1000, syn_opts, sizeof(syn_opts));
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &test_netif);
+
+	pcb = tcp_active_pcbs;
+	EXPECT_RET(pcb != NULL);
+	EXPECT_RET(pcb->state == SYN_RCVD);
+	EXPECT(pcb->flags & TF_WND_SCALE);
+	EXPECT(pcb->flags & TF_SACK);
+	EXPECT(pcb->snd_scale == 3);
+	EXPECT(pcb->rcv_scale == TCP_RCV_SCALE);
+	EXPECT(pcb->rcv_wnd == TCP_WND);
+	/* the window of a SYN is never scaled */
+	EXPECT(pcb->snd_wnd == 1000);
+
+	/* the SYN|ACK confirms both options with an unscaled window */
+	EXPECT_RET(test_txcounters.num_tx_calls == 1);
+	tcphdr = test_tcp_sack_tx_hdr(0);
+	EXPECT_RET(tcphdr != NULL);
+	EXPECT(TCPH_FLAGS(tcphdr) == (TCP_SYN | TCP_ACK));
+	EXPECT(ntohs(tcphdr->wnd) == TCPWND_MIN16(TCP_WND));
+	opt = test_tcp_sack_get_opt(tcphdr, 0x03);
+	EXPECT(opt != NULL && opt[1] == 3 && opt[2] == TCP_RCV_SCALE);
+	EXPECT(test_tcp_sack_get_opt(tcphdr, 0x04) != NULL);
+	test_tcp_sack_reset_tx();
+
+	/* the window of the ACK is scaled beyond 64 KiB */
+	p = tcp_create_rx_segment_wnd(pcb, NULL, 0, 0, 1, TCP_ACK, 0xffff);
+	EXPECT_RET(p != NULL);
+	test_tcp_input(p, &test_netif);
+	EXPECT_RET(pcb->state == ESTABLISHED);
+	EXPECT(pcb->snd_wnd == (0xffffUL << 3));
+	EXPECT(pcb->snd_wnd_max == (0xffffUL << 3));
+
+	/* and our own window is announced scaled down */
+	tcp_ack_now(pcb);
+	tcp_output(pcb);
+	EXPECT_RET(test_txcounters.num_tx_calls == 1);
+	tcphdr = test_tcp_sack_tx_hdr(0);
+	EXPECT_RET(tcphdr != NULL);
+	EXPECT(ntohs(tcphdr->wnd) == TCPWND16(pcb->rcv_ann_wnd >> TCP_RCV_SCALE));
+	EXPECT(test_tcp_sack_get_opt(tcphdr, 0x03) == NULL);
+
+	tcp_abort(pcb);
+	err = tcp_close(lpcb);
+	EXPECT(err == ERR_OK);
+}
+
+END_TEST
+/** Check the options of an active open, with a peer that supports them */
+START_TEST(test_tcp_wnd_scale_connect_opts)
+{
+	LWIP_UNUSED_ARG(_i);
+	test_tcp_wnd_scale_connect(1);
+}
+
+END_TEST
+/** Check that nothing is scaled if the peer does not answer the options */
+START_TEST(test_tcp_wnd_scale_connect_noopts)
+{
+	LWIP_UNUSED_ARG(_i);
+	test_tcp_wnd_scale_connect(0);
+}
+
+END_TEST
+/** Pass out-of-sequence segments to a receiver and check the SACK blocks of
+ * the ACKs it sends: most recent block first, adjacent blocks merged and at
+ * most LWIP_TCP_MAX_SACK_NUM blocks */
+START_TEST(test_tcp_sack_rx_blocks)
+{
+	const u32_t blocks1[] = { 100, 200 };
+	const u32_t blocks2[] = { 300, 400, 100, 200 };
+	const u32_t blocks3[] = { 100, 400 };
+	const u32_t blocks4[] = { 1100, 1200, 100, 400, 500, 600, 700, 800 };
+	const u32_t blocks5[] = { 1100, 1200, 500, 600, 700, 800, 900, 1000 };
+	struct test_tcp_counters counters;
+	struct tcp_pcb *pcb;
+	LWIP_UNUSED_ARG(_i);
+
+	memset(&counters, 0, sizeof(counters));
+	counters.expected_data = test_data;
+	counters.expected_data_len = sizeof(test_data);
+	pcb = test_tcp_new_counters_pcb(&counters);
+	EXPECT_RET(pcb != NULL);
+	tcp_set_state(pcb, ESTABLISHED, &test_local_ip, &test_remote_ip, test_local_port, test_remote_port);
+	pcb->flags |= TF_SACK;
+	test_base = pcb->rcv_nxt;
+
+	/* every out-of-sequence segment is acknowledged at once */
+	test_tcp_sack_rx_data(pcb, 100);
+	test_tcp_sack_expect_ack(0, blocks1, 1);
+	test_tcp_sack_rx_data(pcb, 300);
+	test_tcp_sack_expect_ack(0, blocks2, 2);
+	/* filling the hole between two blocks merges them */
+	test_tcp_sack_rx_data(pcb, 200);
+	test_tcp_sack_expect_ack(0, blocks3, 1);
+
+	/* five blocks do not fit, the oldest one is left out */
+	test_tcp_sack_rx_data(pcb, 500);
+	test_tcp_sack_rx_data(pcb, 700);
+	test_tcp_sack_rx_data(pcb, 900);
+	test_tcp_sack_reset_tx();
+	test_tcp_sack_rx_data(pcb, 1100);
+	test_tcp_sack_expect_ack(0, blocks4, LWIP_TCP_MAX_SACK_NUM);
+	EXPECT(counters.recv_calls == 0);
+
+	/* the missing segment delivers the first block, the delayed ACK reports
+	 * the remaining ones */
+	test_tcp_sack_rx_data(pcb, 0);
+	EXPECT(counters.recved_bytes == 400);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+	tcp_fasttmr();
+	test_tcp_sack_expect_ack(400, blocks5, LWIP_TCP_MAX_SACK_NUM);
+
+	tcp_abort(pcb);
+	EXPECT(lwip_stats.memp[MEMP_TCP_PCB].used == 0);
+}
+
+END_TEST
+/** A single segment is lost: it is retransmitted on the third SACK dupack,
+ * and a timeout while recovering forgets everything the peer SACKed */
+START_TEST(test_tcp_sack_rexmit_single)
+{
+	const u8_t sack2_3[] = { 2, 3 };
+	const u8_t sack2_4[] = { 2, 4 };
+	const u8_t sack2_5[] = { 2, 5 };
+	const u8_t sack2_6[] = { 2, 6 };
+	struct test_tcp_counters counters;
+	struct tcp_pcb *pcb;
+	struct tcp_seg *seg;
+	LWIP_UNUSED_ARG(_i);
+
+	pcb = test_tcp_sack_sender(&counters, 6);
+	EXPECT_RET(pcb != NULL);
+
+	/* segment 1 is lost */
+	test_tcp_sack_rx_ack(pcb, 1, NULL, 0);
+	test_tcp_sack_rx_ack(pcb, 1, sack2_3, 1);
+	test_tcp_sack_rx_ack(pcb, 1, sack2_4, 1);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+	test_tcp_sack_rx_ack(pcb, 1, sack2_5, 1);
+	test_tcp_sack_expect_tx(1);
+	EXPECT(pcb->flags & TF_INFR);
+	for (seg = pcb->unacked->next; seg != NULL; seg = seg->next) {
+		EXPECT((seg->flags & TF_SEG_SACKED) == ((ntohl(seg->tcphdr->seqno) < test_base + 5 * TCP_MSS) ? TF_SEG_SACKED : 0));
+	}
+
+	/* everything else arrived, there is no hole left to fill */
+	test_tcp_sack_rx_ack(pcb, 1, sack2_6, 1);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+
+	/* the retransmission is lost too: the timeout starts over from segment 1 */
+	pcb->rtime = pcb->rto;
+	tcp_slowtmr();
+	test_tcp_sack_expect_tx(1);
+	EXPECT(!(pcb->flags & TF_INFR));
+	for (seg = pcb->unsent; seg != NULL; seg = seg->next) {
+		EXPECT(!(seg->flags & TF_SEG_SACKED));
+	}
+
+	test_tcp_sack_rx_ack(pcb, 6, NULL, 0);
+	EXPECT(pcb->unacked == NULL);
+	EXPECT(pcb->unsent == NULL);
+
+	tcp_abort(pcb);
+	EXPECT(lwip_stats.memp[MEMP_TCP_PCB].used == 0);
+}
+
+END_TEST
+/** Two consecutive segments are lost: the second one is retransmitted on the
+ * next dupack, without waiting for the retransmission timeout */
+START_TEST(test_tcp_sack_rexmit_burst)
+{
+	const u8_t sack3_4[] = { 3, 4 };
+	const u8_t sack3_5[] = { 3, 5 };
+	const u8_t sack3_6[] = { 3, 6 };
+	const u8_t sack3_7[] = { 3, 7 };
+	const u8_t sack3_8[] = { 3, 8 };
+	struct test_tcp_counters counters;
+	struct tcp_pcb *pcb;
+	LWIP_UNUSED_ARG(_i);
+
+	pcb = test_tcp_sack_sender(&counters, 8);
+	EXPECT_RET(pcb != NULL);
+
+	/* segments 1 and 2 are lost */
+	test_tcp_sack_rx_ack(pcb, 1, NULL, 0);
+	test_tcp_sack_rx_ack(pcb, 1, sack3_4, 1);
+	test_tcp_sack_rx_ack(pcb, 1, sack3_5, 1);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+	test_tcp_sack_rx_ack(pcb, 1, sack3_6, 1);
+	test_tcp_sack_expect_tx(1);
+	test_tcp_sack_rx_ack(pcb, 1, sack3_7, 1);
+	test_tcp_sack_expect_tx(2);
+	test_tcp_sack_rx_ack(pcb, 1, sack3_8, 1);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+	EXPECT(pcb->flags & TF_INFR);
+
+	/* both retransmissions arrived, recovery is over */
+	test_tcp_sack_rx_ack(pcb, 8, NULL, 0);
+	EXPECT(!(pcb->flags & TF_INFR));
+	/* cwnd is reset to ssthresh, then grows by this ACK in congestion avoidance */
+	EXPECT(pcb->cwnd == pcb->ssthresh + pcb->mss * pcb->mss / pcb->ssthresh);
+	EXPECT(pcb->unacked == NULL);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+
+	tcp_abort(pcb);
+	EXPECT(lwip_stats.memp[MEMP_TCP_PCB].used == 0);
+}
+
+END_TEST
+/** Two segments with a gap in between are lost: the partial ACK for the
+ * first retransmission triggers the retransmission of the second one */
+START_TEST(test_tcp_sack_rexmit_partial_ack)
+{
+	const u8_t sack2_3[] = { 2, 3 };
+	const u8_t sack2_4[] = { 2, 4 };
+	/* [5,6) is the most recent block */
+	const u8_t sack5_6_2_4[] = { 5, 6, 2, 4 };
+	struct test_tcp_counters counters;
+	struct tcp_pcb *pcb;
+	LWIP_UNUSED_ARG(_i);
+
+	pcb = test_tcp_sack_sender(&counters, 6);
+	EXPECT_RET(pcb != NULL);
+
+	/* segments 1 and 4 are lost */
+	test_tcp_sack_rx_ack(pcb, 1, NULL, 0);
+	test_tcp_sack_rx_ack(pcb, 1, sack2_3, 1);
+	test_tcp_sack_rx_ack(pcb, 1, sack2_4, 1);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+	test_tcp_sack_rx_ack(pcb, 1, sack5_6_2_4, 2);
+	test_tcp_sack_expect_tx(1);
+
+	/* the retransmission of segment 1 arrived */
+	test_tcp_sack_rx_ack(pcb, 4, sack5_6_2_4, 1);
+	test_tcp_sack_expect_tx(4);
+	EXPECT(pcb->flags & TF_INFR);
+
+	test_tcp_sack_rx_ack(pcb, 6, NULL, 0);
+	EXPECT(!(pcb->flags & TF_INFR));
+	EXPECT(pcb->unacked == NULL);
+	EXPECT(test_txcounters.num_tx_calls == 0);
+
+	tcp_abort(pcb);
+	EXPECT(lwip_stats.memp[MEMP_TCP_PCB].used == 0);
+}
+
+END_TEST
+/** Create the suite including all tests for this module */
+Suite *tcp_sack_suite(void)
+{
+	TFun tests[] = {
+		test_tcp_wnd_scale_listen,
+		test_tcp_wnd_scale_connect_opts,
+		test_tcp_wnd_scale_connect_noopts,
+		test_tcp_sack_rx_blocks,
+		test_tcp_sack_rexmit_single,
+		test_tcp_sack_rexmit_burst,
+		test_tcp_sack_rexmit_partial_ack
+	};
+	return create_suite("TCP_SACK", tests, sizeof(tests) / sizeof(TFun), tcp_sack_setup, tcp_sack_teardown);
+}
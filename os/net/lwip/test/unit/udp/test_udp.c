@@ -39,6 +39,52 @@ static void udp_remove_all(void)
 	fail_unless(lwip_stats.memp[MEMP_UDP_PCB].used == 0);
 }
 
+/** Count the datagrams received in the u32_t passed as recv_arg */
+static void udp_counter_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *addr, u16_t port)
+{
+	LWIP_UNUSED_ARG(pcb);
+	LWIP_UNUSED_ARG(addr);
+	LWIP_UNUSED_ARG(port);
+	(*(u32_t *)arg)++;
+	pbuf_free(p);
+}
+
+/** Create a datagram from src_port to dst_port and pass it to udp_input */
+static void udp_input_datagram(struct netif *netif, ip_addr_t *src_ip, u16_t src_port, u16_t dst_port)
+{
+	struct pbuf *p;
+	struct ip_hdr *iphdr;
+	struct udp_hdr *udphdr;
+	u16_t len = (u16_t)(sizeof(struct ip_hdr) + sizeof(struct udp_hdr) + 4);
+
+	p = pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
+	EXPECT_RET(p != NULL);
+	memset(p->payload, 0, len);
+
+	iphdr = p->payload;
+	iphdr->dest.addr = netif->ip_addr.addr;
+	iphdr->src.addr = src_ip->addr;
+	IPH_VHL_SET(iphdr, 4, IP_HLEN / 4);
+	IPH_LEN_SET(iphdr, htons(len));
+	IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+	udphdr = (struct udp_hdr *)(iphdr + 1);
+	udphdr->src = htons(src_port);
+	udphdr->dest = htons(dst_port);
+	udphdr->len = htons(len - sizeof(struct ip_hdr));
+
+	ip_addr_copy(current_iphdr_dest, iphdr->dest);
+	ip_addr_copy(current_iphdr_src, iphdr->src);
+	current_netif = netif;
+	current_header = iphdr;
+
+	udp_input(p, netif);
+
+	current_iphdr_dest.addr = 0;
+	current_iphdr_src.addr = 0;
+	current_netif = NULL;
+	current_header = NULL;
+}
+
 /* Setups/teardown functions */
 
 static void udp_setup(void)
@@ -69,12 +115,64 @@ START_TEST(test_udp_new_remove)
 	}
 }
 
+END_TEST
+/** Check that datagrams reach the pcb bound to their port, also when pcbs
+ * share a bucket of the hash table or are bound again to another port */
+START_TEST(test_udp_demux)
+{
+	struct udp_pcb *pcb[3];
+	u32_t counters[3];
+	ip_addr_t remote_ip;
+	struct netif netif;
+	u16_t port[3];
+	err_t err;
+	int i;
+	LWIP_UNUSED_ARG(_i);
+
+	memset(&netif, 0, sizeof(netif));
+	IP4_ADDR(&netif.ip_addr, 192, 168, 1, 1);
+	IP4_ADDR(&netif.netmask, 255, 255, 255, 0);
+	IP4_ADDR(&remote_ip, 192, 168, 1, 2);
+	memset(counters, 0, sizeof(counters));
+
+	/* the first two pcbs are in the same bucket */
+	port[0] = 0x1000;
+	port[1] = 0x1000 + UDP_PCB_HASH_SIZE;
+	port[2] = 0x1001;
+	for (i = 0; i < 3; i++) {
+		pcb[i] = udp_new();
+		EXPECT_RET(pcb[i] != NULL);
+		err = udp_bind(pcb[i], IP_ADDR_ANY, port[i]);
+		EXPECT_RET(err == ERR_OK);
+		udp_recv(pcb[i], udp_counter_recv, &counters[i]);
+	}
+	for (i = 0; i < 3; i++) {
+		udp_input_datagram(&netif, &remote_ip, 0x2000, port[i]);
+	}
+	EXPECT(counters[0] == 1 && counters[1] == 1 && counters[2] == 1);
+
+	/* after binding again, only the new port is delivered to */
+	err = udp_bind(pcb[2], IP_ADDR_ANY, 0x1002);
+	EXPECT_RET(err == ERR_OK);
+	udp_input_datagram(&netif, &remote_ip, 0x2000, port[2]);
+	EXPECT(counters[2] == 1);
+	udp_input_datagram(&netif, &remote_ip, 0x2000, 0x1002);
+	EXPECT(counters[2] == 2);
+
+	/* a removed pcb is not found anymore, the other one of its bucket is */
+	udp_remove(pcb[0]);
+	udp_input_datagram(&netif, &remote_ip, 0x2000, port[0]);
+	udp_input_datagram(&netif, &remote_ip, 0x2000, port[1]);
+	EXPECT(counters[0] == 1 && counters[1] == 2);
+}
+
 END_TEST
 /** Create the suite including all tests for this module */
 Suite *udp_suite(void)
 {
 	TFun tests[] = {
 		test_udp_new_remove,
+		test_udp_demux,
 	};
 	return create_suite("UDP", tests, sizeof(tests) / sizeof(TFun), udp_setup, udp_teardown);
 }
@@ -38,6 +38,10 @@
 
 #define ETHERNET_MTU 1500
 
+#if defined(CONFIG_NET_ZEROCOPY) && !LWIP_SUPPORT_CUSTOM_PBUF
+#error "CONFIG_NET_ZEROCOPY needs custom pbufs (IP_FRAG without IP_FRAG_USES_STATIC_BUF)"
+#endif
+
 /********************************************************************
  * Private Functions
  ********************************************************************/
@@ -97,6 +101,21 @@ static err_t ethernetif_output(struct netif *netif, struct pbuf *p)
 {
 	struct pbuf *q;
 
+#ifdef CONFIG_NET_ZEROCOPY
+	/* Hand the pbuf chain to a driver which can gather it itself */
+	if (netif->d_txpbuf != NULL) {
+		if (netif->d_txpbuf(netif, p) < 0) {
+			LWIP_DEBUGF(NETIF_DEBUG, ("driver transmit error\n"));
+			LINK_STATS_INC(link.err);
+			LINK_STATS_INC(link.drop);
+			return ERR_IF;
+		}
+
+		LINK_STATS_INC(link.xmit);
+		return ERR_OK;
+	}
+#endif
+
 	netif->d_len = 0;
 	q = p;
 	while (q) {
@@ -177,6 +196,50 @@ int ethernetif_input(struct netif *netif)
 	return 0;
 }
 
+#ifdef CONFIG_NET_ZEROCOPY
+/**
+ * This function should be called by drivers when a packet is received in
+ * one of their own buffers. The buffer is passed to LWIP layer without
+ * copying it, and is given back to the driver through the
+ * custom_free_function of the pbuf once LWIP is done with it. This may
+ * happen in the tcpip_thread or in the task reading the socket.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @param p the custom pbuf of the driver buffer, with custom_free_function set
+ * @param frame the received packet (including MAC header)
+ * @param len the length of the packet
+ * @param buflen the size of the driver buffer starting at frame
+ * @return 0 if the buffer was passed to LWIP layer
+ *         -1 if it couldn't be used, the driver still owns it then
+ */
+int ethernetif_input_pbuf(struct netif *netif, struct pbuf_custom *p, u8_t *frame, u16_t len, u16_t buflen)
+{
+	struct pbuf *q;
+
+	LWIP_DEBUGF(NETIF_DEBUG, ("passing driver buffer to LWIP layer, packet len %d \n", len));
+	LWIP_ASSERT("custom_free_function != NULL", (p->custom_free_function != NULL));
+
+	q = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, p, frame, buflen);
+	if (q == NULL) {
+		LWIP_DEBUGF(NETIF_DEBUG, ("bad driver buffer\n"));
+		LINK_STATS_INC(link.lenerr);
+		LINK_STATS_INC(link.drop);
+		return -1;
+	}
+
+	/* full packet send to tcpip_thread to process */
+	if (netif->input(q, netif) != ERR_OK) {
+		LWIP_DEBUGF(NETIF_DEBUG, ("input processing error\n"));
+		LINK_STATS_INC(link.err);
+		/* This gives the buffer back to the driver */
+		pbuf_free(q);
+	} else {
+		LINK_STATS_INC(link.recv);
+	}
+	return 0;
+}
+#endif
+
 /**
  * Should be called at the beginning of the program to set up the
  * network interface. It calls the function low_level_init() to do the
@@ -66,6 +66,10 @@
 #include <tinyara/arch.h>
 #include <tinyara/net/net.h>
 
+#ifdef CONFIG_NET_TCPIP_CORE_LOCKING
+#include <net/lwip/sys.h>
+#endif
+
 #include "utils/utils.h"
 
 #ifdef CONFIG_NET
@@ -74,6 +78,7 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_NET_TCPIP_CORE_LOCKING
 #define NO_HOLDER (pid_t)-1
 
 /****************************************************************************
@@ -106,11 +111,106 @@ static void _net_takesem(void)
 		ASSERT(errno == EINTR);
 	}
 }
+#endif							/* !CONFIG_NET_TCPIP_CORE_LOCKING */
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+#ifdef CONFIG_NET_TCPIP_CORE_LOCKING
+/* With the core locking of lwIP, the network is locked by the core lock of
+ * the stack (see sys_arch_core_lock()), so that net_lock() also keeps the
+ * socket calls of the other threads out of the stack.
+ */
+
+/****************************************************************************
+ * Function: net_lockinitialize
+ *
+ * Description:
+ *   Initialize the locking facility
+ *
+ ****************************************************************************/
+
+void net_lockinitialize(void)
+{
+	/* The core lock is statically initialized */
+}
+
+/****************************************************************************
+ * Function: net_lock
+ *
+ * Description:
+ *   Take the lock
+ *
+ ****************************************************************************/
+
+net_lock_t net_lock(void)
+{
+	sys_arch_core_lock();
+	return 0;
+}
+
+/****************************************************************************
+ * Function: net_unlock
+ *
+ * Description:
+ *   Release the lock.
+ *
+ ****************************************************************************/
+
+void net_unlock(net_lock_t flags)
+{
+	sys_arch_core_unlock();
+}
+
+/****************************************************************************
+ * Function: net_timedwait
+ *
+ * Description:
+ *   Atomically wait for sem (or a timeout( while temporarily releasing
+ *   the lock on the network.
+ *
+ * Input Parameters:
+ *   sem     - A reference to the semaphore to be taken.
+ *   abstime - The absolute time to wait until a timeout is declared.
+ *
+ * Returned value:
+ *   The returned value is the same as sem_wait() or sem_timedwait():  Zero
+ *   (OK) is returned on success; -1 (ERROR) is returned on a failure with
+ *   the errno value set appropriately.
+ *
+ ****************************************************************************/
+
+int net_timedwait(sem_t *sem, FAR const struct timespec *abstime)
+{
+	irqstate_t flags;
+	u32_t depth;
+	int ret;
+
+	flags = irqsave();			/* No interrupts */
+	sched_lock();				/* No context switches */
+
+	/* Release the core lock if held, remembering how many times */
+
+	depth = sys_arch_core_release();
+
+	if (abstime) {
+		ret = sem_timedwait(sem, abstime);
+	} else {
+		ret = sem_wait(sem);
+	}
+
+	/* Recover the core lock at the proper depth */
+
+	sys_arch_core_restore(depth);
+
+	sched_unlock();
+	irqrestore(flags);
+	return ret;
+}
+
+#else							/* CONFIG_NET_TCPIP_CORE_LOCKING */
+
 /****************************************************************************
  * Function: net_lockinitialize
  *
@@ -243,6 +343,7 @@ int net_timedwait(sem_t *sem, FAR const struct timespec *abstime)
 	irqrestore(flags);
 	return ret;
 }
+#endif							/* CONFIG_NET_TCPIP_CORE_LOCKING */
 
 /****************************************************************************
  * Function: net_lockedwait
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/mmbench/include/stdlib.h
+ *
+ * The host C library does not know the TinyAra struct mallinfo.  Pull in
+ * the host header and add the definition from include/stdlib.h.
+ ****************************************************************************/
+
+#ifndef __TOOLS_MMBENCH_INCLUDE_STDLIB_H
+#define __TOOLS_MMBENCH_INCLUDE_STDLIB_H
+
+#include_next <stdlib.h>
+
+struct mallinfo {
+	int arena;
+	int ordblks;
+	int mxordblk;
+	int uordblks;
+	int fordblks;
+#ifdef CONFIG_MM_FASTBINS
+	int smblks;
+	int fsmblks;
+	int fbhits;
+	int fbmisses;
+#endif
+};
+
+#endif							/* __TOOLS_MMBENCH_INCLUDE_STDLIB_H */
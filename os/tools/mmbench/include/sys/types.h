@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/mmbench/include/sys/types.h
+ *
+ * The TinyAra <sys/types.h> also provides the fixed-width integer types
+ * and NULL; the allocator sources rely on that.
+ ****************************************************************************/
+
+#ifndef __TOOLS_MMBENCH_INCLUDE_SYS_TYPES_H
+#define __TOOLS_MMBENCH_INCLUDE_SYS_TYPES_H
+
+#include_next <sys/types.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#endif							/* __TOOLS_MMBENCH_INCLUDE_SYS_TYPES_H */
@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/mmbench/include/tinyara/config.h
+ *
+ * Stand-in for the generated configuration header when the heap allocator
+ * is built as a host program.  Allocator options (CONFIG_MM_FASTBINS, ...)
+ * are passed on the compiler command line.
+ ****************************************************************************/
+
+#ifndef __TOOLS_MMBENCH_INCLUDE_TINYARA_CONFIG_H
+#define __TOOLS_MMBENCH_INCLUDE_TINYARA_CONFIG_H
+
+#define FAR
+#define NEAR
+#define CODE
+
+#define OK    0
+#define ERROR -1
+
+#define CONFIG_HAVE_LONG_LONG 1
+#define CONFIG_MM_REGIONS     1
+
+#endif							/* __TOOLS_MMBENCH_INCLUDE_TINYARA_CONFIG_H */
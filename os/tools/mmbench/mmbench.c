@@ -0,0 +1,1080 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/mmbench/mmbench.c
+ *
+ * Host benchmark for the heap allocator in mm/mm_heap.  The allocator
+ * sources are compiled into this program unchanged and driven either with
+ * a reproducible random workload or by replaying a recorded allocation
+ * trace.  The latency of every call is recorded and reported as a
+ * distribution, and the heap is sampled periodically for fragmentation.
+ * Every block is filled with a pattern that is verified before it is freed,
+ * so a run doubles as a consistency check of the allocator.
+ *
+ * Trace format: one event per line, numbers in C notation, '#' starts a
+ * comment and fields after the ones listed are ignored.
+ *
+ *   m <ptr> <size>              mm_malloc(size) returned ptr
+ *   z <ptr> <size>              mm_zalloc(size) returned ptr
+ *   a <ptr> <align> <size>      mm_memalign(align, size) returned ptr
+ *   r <ptr> <oldptr> <size>     mm_realloc(oldptr, size) returned ptr
+ *   f <ptr>                     mm_free(ptr)
+ *
+ * Pointers only identify blocks; a block is matched to its free by the
+ * address it had when the trace was recorded.
+ *
+ * A binary trace read from /proc/mmtrace or /proc/kmmtrace on a target
+ * built with CONFIG_MM_TRACE (see include/tinyara/mm/trace.h) is recognized
+ * by its magic number and can be replayed the same way.  It also carries
+ * the time, the task and the caller of every event, so for such a trace the
+ * allocation rate, the block lifetimes, the peak heap usage of each task and
+ * the busiest call sites are reported as well.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <tinyara/mm/mm.h>
+#include <tinyara/mm/trace.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DEFAULT_HEAPSIZE  (1024 * 1024)
+#define DEFAULT_NOPS      200000
+#define DEFAULT_NSLOTS    512
+#define DEFAULT_SEED      1
+#define DEFAULT_INTERVAL  1000
+
+#define PTRHASH_SIZE      4096
+#define NO_BLOCK          UINT32_MAX
+#define NTOPSITES         10
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum bench_op_e {
+	OP_MALLOC = 0,
+	OP_ZALLOC,
+	OP_MEMALIGN,
+	OP_REALLOC,
+	OP_FREE,
+	OP_NTYPES
+};
+
+struct event_s {
+	uint8_t op;
+	int16_t pid;				/* Task that made the call (binary traces) */
+	uint32_t id;				/* Block that is allocated, resized or freed */
+	uint32_t time;				/* Time of the call in ticks (binary traces) */
+	uint32_t caller;			/* Return address of the call (binary traces) */
+	size_t size;
+	size_t align;
+};
+
+struct block_s {
+	FAR uint8_t *mem;
+	size_t size;
+	size_t chunk;				/* Heap chunk size, header included */
+	int16_t pid;				/* Task that is charged for the chunk */
+	uint8_t fill;
+};
+
+struct task_s {
+	int16_t pid;
+	unsigned long nallocs;
+	long used;
+	long peak;
+};
+
+struct site_s {
+	uint32_t caller;
+	unsigned long count;
+	unsigned long long bytes;
+};
+
+struct latency_s {
+	const char *name;
+	uint32_t *samples;
+	size_t nsamples;
+};
+
+struct ptrmap_s {
+	struct ptrmap_s *next;
+	unsigned long ptr;
+	uint32_t id;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct mm_heap_s g_heap;
+static uint32_t g_seed;
+
+static struct event_s *g_events;
+static size_t g_nevents;
+static size_t g_maxevents;
+static uint32_t g_nblocks;
+
+static struct ptrmap_s *g_ptrhash[PTRHASH_SIZE];
+static unsigned long g_dropped;
+
+/* Binary traces only */
+
+static bool g_timed;
+static uint32_t g_usecpertick;
+static uint32_t g_nlost;
+
+static struct task_s *g_tasks;
+static size_t g_ntasks;
+
+static const char *g_opnames[OP_NTYPES] = {
+	"malloc", "zalloc", "memalign", "realloc", "free"
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void bench_fatal(const char *msg)
+{
+	fprintf(stderr, "mmbench: %s\n", msg);
+	exit(EXIT_FAILURE);
+}
+
+static uint32_t bench_rand(void)
+{
+	/* xorshift32: cheap and identical on every host */
+
+	g_seed ^= g_seed << 13;
+	g_seed ^= g_seed >> 17;
+	g_seed ^= g_seed << 5;
+	return g_seed;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static struct event_s *event_append(int op, uint32_t id, size_t size, size_t align)
+{
+	struct event_s *ev;
+
+	if (g_nevents == g_maxevents) {
+		g_maxevents = g_maxevents ? 2 * g_maxevents : 4096;
+		g_events = realloc(g_events, g_maxevents * sizeof(struct event_s));
+		if (!g_events) {
+			bench_fatal("out of host memory");
+		}
+	}
+
+	ev = &g_events[g_nevents++];
+	memset(ev, 0, sizeof(struct event_s));
+	ev->op = op;
+	ev->id = id;
+	ev->size = size;
+	ev->align = align;
+	return ev;
+}
+
+/* Map recorded block addresses to block ids while a trace is loaded */
+
+static void ptrmap_add(unsigned long ptr, uint32_t id)
+{
+	struct ptrmap_s *entry = malloc(sizeof(struct ptrmap_s));
+
+	if (!entry) {
+		bench_fatal("out of host memory");
+	}
+
+	entry->ptr = ptr;
+	entry->id = id;
+	entry->next = g_ptrhash[(ptr >> 4) % PTRHASH_SIZE];
+	g_ptrhash[(ptr >> 4) % PTRHASH_SIZE] = entry;
+}
+
+static uint32_t ptrmap_remove(unsigned long ptr)
+{
+	struct ptrmap_s **prev = &g_ptrhash[(ptr >> 4) % PTRHASH_SIZE];
+	struct ptrmap_s *entry;
+	uint32_t id;
+
+	for (entry = *prev; entry; prev = &entry->next, entry = entry->next) {
+		if (entry->ptr == ptr) {
+			*prev = entry->next;
+			id = entry->id;
+			free(entry);
+			return id;
+		}
+	}
+
+	return NO_BLOCK;
+}
+
+/****************************************************************************
+ * Name: trace_event
+ *
+ * Description:
+ *   Convert one recorded call to an event on block ids.  'arg' is the
+ *   alignment of a memalign and the old block of a realloc.  Returns NULL
+ *   if the event is dropped because it frees a block that was allocated
+ *   before recording started.
+ *
+ ****************************************************************************/
+
+static struct event_s *trace_event(int op, unsigned long ptr, unsigned long arg, unsigned long size)
+{
+	struct event_s *ev;
+	uint32_t id;
+
+	switch (op) {
+	case MM_TRACE_MALLOC:
+	case MM_TRACE_ZALLOC:
+	case MM_TRACE_MEMALIGN:
+		if (op == MM_TRACE_MEMALIGN) {
+			ev = event_append(OP_MEMALIGN, g_nblocks, size, arg);
+		} else {
+			ev = event_append(op == MM_TRACE_MALLOC ? OP_MALLOC : OP_ZALLOC, g_nblocks, size, 0);
+		}
+
+		if (ptr) {
+			ptrmap_add(ptr, g_nblocks);
+		}
+
+		g_nblocks++;
+		return ev;
+
+	case MM_TRACE_REALLOC:
+		/* A realloc of an unknown block is replayed as a malloc */
+
+		id = arg ? ptrmap_remove(arg) : NO_BLOCK;
+		if (id == NO_BLOCK) {
+			ev = event_append(OP_MALLOC, g_nblocks, size, 0);
+			id = g_nblocks++;
+		} else {
+			ev = event_append(OP_REALLOC, id, size, 0);
+		}
+
+		if (ptr) {
+			ptrmap_add(ptr, id);
+		} else if (size > 0 && arg) {
+			/* A failed realloc leaves the old block in place */
+
+			ptrmap_add(arg, id);
+		}
+		return ev;
+
+	default:
+		id = ptrmap_remove(ptr);
+		if (id == NO_BLOCK) {
+			g_dropped++;
+			return NULL;
+		}
+
+		return event_append(OP_FREE, id, 0, 0);
+	}
+}
+
+/****************************************************************************
+ * Name: trace_loadtext
+ *
+ * Description:
+ *   Read a trace in text format.
+ *
+ ****************************************************************************/
+
+static void trace_loadtext(const char *path, FILE *stream)
+{
+	char line[256];
+	unsigned long ptr;
+	unsigned long arg = 0;
+	unsigned long size = 0;
+	unsigned long lineno = 0;
+	char op;
+	int n;
+
+	while (fgets(line, sizeof(line), stream)) {
+		lineno++;
+		if (sscanf(line, " %c", &op) != 1 || op == '#') {
+			continue;
+		}
+
+		switch (op) {
+		case MM_TRACE_MALLOC:
+		case MM_TRACE_ZALLOC:
+			n = sscanf(line, " %*c %li %li", &ptr, &size) - 2;
+			break;
+
+		case MM_TRACE_MEMALIGN:
+		case MM_TRACE_REALLOC:
+			n = sscanf(line, " %*c %li %li %li", &ptr, &arg, &size) - 3;
+			break;
+
+		case MM_TRACE_FREE:
+			n = sscanf(line, " %*c %li", &ptr) - 1;
+			break;
+
+		default:
+			n = -1;
+			break;
+		}
+
+		if (n != 0) {
+			fprintf(stderr, "mmbench: %s:%lu: malformed event\n", path, lineno);
+			exit(EXIT_FAILURE);
+		}
+
+		trace_event(op, ptr, arg, size);
+	}
+}
+
+/****************************************************************************
+ * Name: trace_loadbin
+ *
+ * Description:
+ *   Read a binary trace as produced by /proc/mmtrace.  The records are in
+ *   the byte order of the target, which is little endian on every board
+ *   that TinyAra supports, as it is on the hosts that run this tool.
+ *
+ ****************************************************************************/
+
+static void trace_loadbin(const char *path, FILE *stream)
+{
+	struct mm_tracehdr_s hdr;
+	struct mm_trace_s rec;
+	struct event_s *ev;
+	uint32_t i;
+
+	if (fread(&hdr, sizeof(hdr), 1, stream) != 1) {
+		bench_fatal("truncated trace header");
+	}
+
+	if (hdr.version != MM_TRACE_VERSION || hdr.recsize != sizeof(struct mm_trace_s)) {
+		fprintf(stderr, "mmbench: %s: unsupported trace version %u\n", path, hdr.version);
+		exit(EXIT_FAILURE);
+	}
+
+	g_timed = true;
+	g_usecpertick = hdr.usecpertick;
+	g_nlost = hdr.nlost;
+
+	for (i = 0; i < hdr.nrecords; i++) {
+		if (fread(&rec, sizeof(rec), 1, stream) != 1) {
+			fprintf(stderr, "mmbench: %s: truncated after %u of %u records\n", path, i, hdr.nrecords);
+			exit(EXIT_FAILURE);
+		}
+
+		ev = trace_event(rec.op, rec.mem, rec.arg, rec.size);
+		if (ev) {
+			ev->time = rec.time;
+			ev->pid = rec.pid;
+			ev->caller = rec.caller;
+		}
+	}
+}
+
+/****************************************************************************
+ * Name: trace_load
+ *
+ * Description:
+ *   Read a recorded trace, in text or binary format, and convert it to
+ *   events on block ids.  Frees of blocks that were allocated before
+ *   recording started are dropped.
+ *
+ ****************************************************************************/
+
+static void trace_load(const char *path)
+{
+	uint32_t magic = 0;
+	FILE *stream;
+
+	stream = fopen(path, "rb");
+	if (!stream) {
+		bench_fatal("cannot open trace");
+	}
+
+	if (fread(&magic, sizeof(magic), 1, stream) == 1 && magic == MM_TRACE_MAGIC) {
+		rewind(stream);
+		trace_loadbin(path, stream);
+	} else {
+		rewind(stream);
+		trace_loadtext(path, stream);
+	}
+
+	fclose(stream);
+	if (g_dropped) {
+		printf("trace: %lu frees of unknown blocks dropped\n", g_dropped);
+	}
+}
+
+/****************************************************************************
+ * Name: workload_generate
+ *
+ * Description:
+ *   Build a random workload: each step either frees a randomly chosen live
+ *   block or allocates a new one into an empty slot.  The size mix is
+ *   dominated by small objects (list nodes, timers, message buffers) with a
+ *   tail of larger buffers, which is what the heap of a typical TinyAra
+ *   application sees.
+ *
+ ****************************************************************************/
+
+static void workload_generate(unsigned long nops, unsigned long nslots)
+{
+	uint32_t *slots;
+	uint32_t *slot;
+	unsigned long op;
+	size_t size;
+	uint32_t r;
+
+	slots = malloc(nslots * sizeof(uint32_t));
+	if (!slots) {
+		bench_fatal("out of host memory");
+	}
+
+	memset(slots, 0xff, nslots * sizeof(uint32_t));
+	for (op = 0; op < nops; op++) {
+		slot = &slots[bench_rand() % nslots];
+		if (*slot != NO_BLOCK) {
+			event_append(OP_FREE, *slot, 0, 0);
+			*slot = NO_BLOCK;
+			continue;
+		}
+
+		r = bench_rand() % 100;
+		if (r < 80) {
+			size = 8 + bench_rand() % 121;
+		} else if (r < 95) {
+			size = 129 + bench_rand() % 896;
+		} else {
+			size = 1025 + bench_rand() % 7168;
+		}
+
+		event_append(OP_MALLOC, g_nblocks, size, 0);
+		*slot = g_nblocks++;
+	}
+
+	free(slots);
+}
+
+/****************************************************************************
+ * Name: workload_save
+ *
+ * Description:
+ *   Write the events in trace format so that exactly the same workload can
+ *   be replayed later or against a different allocator.
+ *
+ ****************************************************************************/
+
+static void workload_save(const char *path)
+{
+	FILE *stream;
+	size_t i;
+
+	stream = fopen(path, "w");
+	if (!stream) {
+		bench_fatal("cannot create trace");
+	}
+
+	fprintf(stream, "# mmbench workload, %zu events\n", g_nevents);
+	for (i = 0; i < g_nevents; i++) {
+		struct event_s *ev = &g_events[i];
+		unsigned long ptr = 0x10 * ((unsigned long)ev->id + 1);
+
+		switch (ev->op) {
+		case OP_MALLOC:
+			fprintf(stream, "m 0x%lx %zu\n", ptr, ev->size);
+			break;
+		case OP_ZALLOC:
+			fprintf(stream, "z 0x%lx %zu\n", ptr, ev->size);
+			break;
+		case OP_MEMALIGN:
+			fprintf(stream, "a 0x%lx %zu %zu\n", ptr, ev->align, ev->size);
+			break;
+		case OP_REALLOC:
+			fprintf(stream, "r 0x%lx 0x%lx %zu\n", ptr, ptr, ev->size);
+			break;
+		case OP_FREE:
+			fprintf(stream, "f 0x%lx\n", ptr);
+			break;
+		}
+	}
+
+	fclose(stream);
+}
+
+static void block_verify(struct block_s *block, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if (block->mem[i] != block->fill) {
+			fprintf(stderr, "mmbench: corrupted block %p (size %zu) at offset %zu\n", block->mem, block->size, i);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void bench_report(struct latency_s *lat)
+{
+	static const unsigned int pct[] = { 500, 900, 990, 999 };
+	uint32_t hist[16];
+	uint64_t total = 0;
+	size_t i;
+	int b;
+
+	if (lat->nsamples == 0) {
+		return;
+	}
+
+	qsort(lat->samples, lat->nsamples, sizeof(uint32_t), bench_compare);
+
+	memset(hist, 0, sizeof(hist));
+	for (i = 0; i < lat->nsamples; i++) {
+		uint32_t ns = lat->samples[i];
+
+		total += ns;
+		for (b = 0; b < 15 && ns >= (32u << b); b++) ;
+		hist[b]++;
+	}
+
+	printf("%s: %zu calls, mean %llu ns", lat->name, lat->nsamples, (unsigned long long)(total / lat->nsamples));
+	for (i = 0; i < sizeof(pct) / sizeof(pct[0]); i++) {
+		if (pct[i] % 10) {
+			printf(", p%u.%u %u", pct[i] / 10, pct[i] % 10, lat->samples[(lat->nsamples * pct[i]) / 1000]);
+		} else {
+			printf(", p%u %u", pct[i] / 10, lat->samples[(lat->nsamples * pct[i]) / 1000]);
+		}
+	}
+
+	printf(", max %u\n", lat->samples[lat->nsamples - 1]);
+
+	for (b = 0; b < 16; b++) {
+		if (hist[b] != 0) {
+			printf("  %s%7u ns : %8u (%5.1f%%)\n", b == 15 ? ">=" : " <", 32u << (b == 15 ? 14 : b), hist[b], 100.0 * hist[b] / lat->nsamples);
+		}
+	}
+}
+
+/****************************************************************************
+ * Name: task_charge
+ *
+ * Description:
+ *   Add 'size' bytes (which may be negative) to the heap usage of a task.
+ *
+ ****************************************************************************/
+
+static void task_charge(int16_t pid, long size)
+{
+	struct task_s *task;
+	size_t i;
+
+	for (i = 0; i < g_ntasks && g_tasks[i].pid != pid; i++) ;
+	if (i == g_ntasks) {
+		g_tasks = realloc(g_tasks, (g_ntasks + 1) * sizeof(struct task_s));
+		if (!g_tasks) {
+			bench_fatal("out of host memory");
+		}
+
+		memset(&g_tasks[i], 0, sizeof(struct task_s));
+		g_tasks[i].pid = pid;
+		g_ntasks++;
+	}
+
+	task = &g_tasks[i];
+	task->used += size;
+	if (size > 0) {
+		task->nallocs++;
+		if (task->used > task->peak) {
+			task->peak = task->used;
+		}
+	}
+}
+
+static int site_bycaller(const void *a, const void *b)
+{
+	uint32_t x = ((const struct site_s *)a)->caller;
+	uint32_t y = ((const struct site_s *)b)->caller;
+
+	return x < y ? -1 : x > y;
+}
+
+static int site_bycount(const void *a, const void *b)
+{
+	unsigned long x = ((const struct site_s *)a)->count;
+	unsigned long y = ((const struct site_s *)b)->count;
+
+	return x > y ? -1 : x < y;
+}
+
+static int site_bybytes(const void *a, const void *b)
+{
+	unsigned long long x = ((const struct site_s *)a)->bytes;
+	unsigned long long y = ((const struct site_s *)b)->bytes;
+
+	return x > y ? -1 : x < y;
+}
+
+/****************************************************************************
+ * Name: trace_report
+ *
+ * Description:
+ *   Report what the time, task and caller of the events of a binary trace
+ *   tell about the workload: the allocation rate, how long blocks live,
+ *   how much of the heap each task held at most and which call sites
+ *   allocate most often and most bytes.
+ *
+ ****************************************************************************/
+
+static void trace_report(void)
+{
+	struct site_s *sites;
+	uint32_t *births;
+	uint32_t *lifetimes;
+	size_t nlifetimes = 0;
+	size_t nsites = 0;
+	unsigned long nallocs = 0;
+	unsigned long nlive = 0;
+	double span;
+	size_t i;
+	size_t j;
+
+	if (g_nevents == 0) {
+		return;
+	}
+
+	births = calloc(g_nblocks + 1, sizeof(uint32_t));
+	lifetimes = malloc(g_nevents * sizeof(uint32_t));
+	sites = malloc(g_nevents * sizeof(struct site_s));
+	if (!births || !lifetimes || !sites) {
+		bench_fatal("out of host memory");
+	}
+
+	for (i = 0; i < g_nevents; i++) {
+		struct event_s *ev = &g_events[i];
+
+		if (ev->op == OP_FREE) {
+			lifetimes[nlifetimes++] = ev->time - births[ev->id];
+			continue;
+		}
+
+		if (ev->op != OP_REALLOC) {
+			births[ev->id] = ev->time;
+			nallocs++;
+			nlive++;
+		}
+
+		sites[nsites].caller = ev->caller;
+		sites[nsites].count = 1;
+		sites[nsites].bytes = ev->size;
+		nsites++;
+	}
+
+	nlive -= nlifetimes;
+
+	/* Rate over the time covered by the trace */
+
+	span = (double)(g_events[g_nevents - 1].time - g_events[0].time) * g_usecpertick / 1000000.0;
+	printf("trace: %lu allocations in %.3f s", nallocs, span);
+	if (span > 0.0) {
+		printf(", %.1f allocations/s", nallocs / span);
+	}
+
+	printf(", %u earlier events lost\n", g_nlost);
+
+	/* Lifetimes of the blocks that were freed within the trace */
+
+	if (nlifetimes > 0) {
+		qsort(lifetimes, nlifetimes, sizeof(uint32_t), bench_compare);
+		printf("lifetime (us): %zu blocks freed, p50 %llu, p90 %llu, p99 %llu, max %llu; %lu still live\n", nlifetimes,
+			   (unsigned long long)lifetimes[nlifetimes / 2] * g_usecpertick,
+			   (unsigned long long)lifetimes[(nlifetimes * 9) / 10] * g_usecpertick,
+			   (unsigned long long)lifetimes[(nlifetimes * 99) / 100] * g_usecpertick,
+			   (unsigned long long)lifetimes[nlifetimes - 1] * g_usecpertick, nlive);
+	}
+
+	/* Peak heap usage per task, from the replay */
+
+	for (i = 0; i < g_ntasks; i++) {
+		printf("task %d: %lu allocations, peak %ld bytes, %ld bytes at end\n", g_tasks[i].pid, g_tasks[i].nallocs, g_tasks[i].peak, g_tasks[i].used);
+	}
+
+	/* Merge the events of each call site */
+
+	qsort(sites, nsites, sizeof(struct site_s), site_bycaller);
+	for (i = 0, j = 0; i < nsites; i++) {
+		if (j > 0 && sites[j - 1].caller == sites[i].caller) {
+			sites[j - 1].count++;
+			sites[j - 1].bytes += sites[i].bytes;
+		} else {
+			sites[j++] = sites[i];
+		}
+	}
+
+	nsites = j;
+
+	qsort(sites, nsites, sizeof(struct site_s), site_bycount);
+	printf("top call sites by count:\n");
+	for (i = 0; i < nsites && i < NTOPSITES; i++) {
+		printf("  0x%08x : %8lu calls, %10llu bytes\n", sites[i].caller, sites[i].count, sites[i].bytes);
+	}
+
+	qsort(sites, nsites, sizeof(struct site_s), site_bybytes);
+	printf("top call sites by bytes:\n");
+	for (i = 0; i < nsites && i < NTOPSITES; i++) {
+		printf("  0x%08x : %10llu bytes, %8lu calls\n", sites[i].caller, sites[i].bytes, sites[i].count);
+	}
+
+	free(sites);
+	free(lifetimes);
+	free(births);
+}
+
+static void show_usage(const char *progname)
+{
+	fprintf(stderr, "USAGE: %s [-t <trace> | -n <ops> -l <live blocks> -s <seed>] [-H <heap size>] [-i <interval>] [-o <trace>] [-F <csv>]\n", progname);
+	fprintf(stderr, "  -t  replay a recorded allocation trace (text, or binary from /proc/mmtrace)\n");
+	fprintf(stderr, "      instead of the random workload\n");
+	fprintf(stderr, "  -i  sample fragmentation every <interval> events\n");
+	fprintf(stderr, "  -o  save the events that are run as a trace\n");
+	fprintf(stderr, "  -F  write every fragmentation sample to <csv>\n");
+	exit(EXIT_FAILURE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* The benchmark is single threaded, so the heap lock is not needed */
+
+void mm_seminitialize(FAR struct mm_heap_s *heap)
+{
+	heap->mm_holder = -1;
+	heap->mm_counts_held = 0;
+}
+
+void mm_takesemaphore(FAR struct mm_heap_s *heap)
+{
+	heap->mm_counts_held++;
+}
+
+int mm_trysemaphore(FAR struct mm_heap_s *heap)
+{
+	heap->mm_counts_held++;
+	return OK;
+}
+
+void mm_givesemaphore(FAR struct mm_heap_s *heap)
+{
+	heap->mm_counts_held--;
+}
+
+int main(int argc, char **argv)
+{
+	struct latency_s lat[OP_NTYPES];
+	struct mallinfo info;
+	struct block_s *blocks;
+	struct block_s *block;
+	FAR void *heapmem;
+	const char *tracein = NULL;
+	const char *traceout = NULL;
+	const char *fragout = NULL;
+	FILE *fragstream = NULL;
+	size_t heapsize = DEFAULT_HEAPSIZE;
+	unsigned long nops = DEFAULT_NOPS;
+	unsigned long nslots = DEFAULT_NSLOTS;
+	unsigned long seed = DEFAULT_SEED;
+	unsigned long interval = DEFAULT_INTERVAL;
+	unsigned long failed = 0;
+	unsigned long nfrag = 0;
+	double frag;
+	double maxfrag = 0.0;
+	double sumfrag = 0.0;
+	int peakused = 0;
+	uint64_t start;
+	uint32_t elapsed;
+	FAR void *mem;
+	size_t oldsize;
+	size_t i;
+	int option;
+	int op;
+
+	while ((option = getopt(argc, argv, "t:o:n:l:H:s:i:F:")) != -1) {
+		switch (option) {
+		case 't':
+			tracein = optarg;
+			break;
+		case 'o':
+			traceout = optarg;
+			break;
+		case 'n':
+			nops = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			nslots = strtoul(optarg, NULL, 0);
+			break;
+		case 'H':
+			heapsize = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 0);
+			break;
+		case 'i':
+			interval = strtoul(optarg, NULL, 0);
+			break;
+		case 'F':
+			fragout = optarg;
+			break;
+		default:
+			show_usage(argv[0]);
+		}
+	}
+
+	if (nops == 0 || nslots == 0 || seed == 0) {
+		show_usage(argv[0]);
+	}
+
+	if (tracein) {
+		trace_load(tracein);
+	} else {
+		g_seed = (uint32_t)seed;
+		workload_generate(nops, nslots);
+	}
+
+	if (traceout) {
+		workload_save(traceout);
+	}
+
+	heapmem = malloc(heapsize);
+	blocks = calloc(g_nblocks + 1, sizeof(struct block_s));
+	if (!heapmem || !blocks) {
+		bench_fatal("out of host memory");
+	}
+
+	for (op = 0; op < OP_NTYPES; op++) {
+		lat[op].name = g_opnames[op];
+		lat[op].nsamples = 0;
+		lat[op].samples = malloc((g_nevents + 1) * sizeof(uint32_t));
+		if (!lat[op].samples) {
+			bench_fatal("out of host memory");
+		}
+	}
+
+	if (fragout) {
+		fragstream = fopen(fragout, "w");
+		if (!fragstream) {
+			bench_fatal("cannot create fragmentation file");
+		}
+
+		fprintf(fragstream, "event,time_us,used,free,largest,frag\n");
+	}
+
+	g_seed = (uint32_t)seed;
+	mm_initialize(&g_heap, heapmem, heapsize);
+
+	for (i = 0; i < g_nevents; i++) {
+		struct event_s *ev = &g_events[i];
+
+		block = &blocks[ev->id];
+		oldsize = block->size;
+
+		switch (ev->op) {
+		case OP_MALLOC:
+			start = bench_nsec();
+			mem = mm_malloc(&g_heap, ev->size);
+			break;
+
+		case OP_ZALLOC:
+			start = bench_nsec();
+			mem = mm_zalloc(&g_heap, ev->size);
+			break;
+
+		case OP_MEMALIGN:
+			start = bench_nsec();
+			mem = mm_memalign(&g_heap, ev->align, ev->size);
+			break;
+
+		case OP_REALLOC:
+			block_verify(block, oldsize);
+			start = bench_nsec();
+			mem = mm_realloc(&g_heap, block->mem, ev->size);
+			break;
+
+		default:
+			block_verify(block, oldsize);
+			start = bench_nsec();
+			mm_free(&g_heap, block->mem);
+			mem = NULL;
+			break;
+		}
+
+		elapsed = (uint32_t)(bench_nsec() - start);
+		lat[ev->op].samples[lat[ev->op].nsamples++] = elapsed;
+
+		/* Charge the chunks to the tasks that allocated them */
+
+		if (block->chunk && (ev->op == OP_FREE || mem != NULL || ev->size == 0)) {
+			task_charge(block->pid, -(long)block->chunk);
+			block->chunk = 0;
+		}
+
+		if (mem != NULL) {
+			block->chunk = ((FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE))->size;
+			block->pid = ev->pid;
+			task_charge(block->pid, (long)block->chunk);
+		}
+
+		if (ev->op == OP_FREE) {
+			block->mem = NULL;
+			block->size = 0;
+		} else if (mem == NULL) {
+			/* A failed realloc keeps the old block */
+
+			if (ev->size > 0) {
+				failed++;
+			}
+
+			if (ev->op != OP_REALLOC || ev->size == 0) {
+				block->mem = NULL;
+				block->size = 0;
+			}
+		} else {
+			if (ev->op == OP_MEMALIGN && ((uintptr_t)mem & (ev->align - 1)) != 0) {
+				bench_fatal("misaligned memalign block");
+			}
+
+			block->mem = mem;
+			if (ev->op == OP_REALLOC) {
+				block_verify(block, oldsize < ev->size ? oldsize : ev->size);
+			}
+
+			block->size = ev->size;
+			block->fill = (uint8_t)bench_rand();
+			memset(block->mem, block->fill, block->size);
+		}
+
+		/* Sample the heap shape; the heap walk is not part of the timing */
+
+		if (interval && (i + 1) % interval == 0) {
+			mm_mallinfo(&g_heap, &info);
+			if (info.uordblks > peakused) {
+				peakused = info.uordblks;
+			}
+
+			frag = 0.0;
+			if (info.fordblks > 0) {
+				frag = 1.0 - (double)info.mxordblk / info.fordblks;
+				sumfrag += frag;
+				nfrag++;
+				if (frag > maxfrag) {
+					maxfrag = frag;
+				}
+			}
+
+			if (fragstream) {
+				fprintf(fragstream, "%zu,%llu,%d,%d,%d,%.4f\n", i + 1, (unsigned long long)ev->time * g_usecpertick, info.uordblks, info.fordblks, info.mxordblk, frag);
+			}
+		}
+	}
+
+	if (fragstream) {
+		fclose(fragstream);
+	}
+
+	mm_mallinfo(&g_heap, &info);
+
+	if (tracein) {
+		printf("heap %zu bytes, trace %s, %zu events, %u blocks\n", heapsize, tracein, g_nevents, g_nblocks);
+	} else {
+		printf("heap %zu bytes, %lu ops, %lu live slots, seed %lu\n", heapsize, nops, nslots, seed);
+	}
+
+#if defined(CONFIG_MM_TLSF)
+	printf("allocator: TLSF, %d second-level lists\n", MM_TLSF_SLCOUNT);
+#else
+	printf("allocator: best fit\n");
+#endif
+#ifdef CONFIG_MM_FASTBINS
+	printf("fast bins: up to %d bytes, depth %d\n", CONFIG_MM_FASTBIN_MAXSIZE, CONFIG_MM_FASTBIN_DEPTH);
+#endif
+
+	for (op = 0; op < OP_NTYPES; op++) {
+		bench_report(&lat[op]);
+	}
+
+	printf("failed allocations: %lu\n", failed);
+	if (nfrag > 0) {
+		printf("fragmentation (1 - largest free / total free): mean %.1f%%, max %.1f%%\n", 100.0 * sumfrag / nfrag, 100.0 * maxfrag);
+		printf("peak used: %d bytes\n", peakused);
+	}
+
+	printf("mallinfo: used %d, free %d, largest %d, free chunks %d\n", info.uordblks, info.fordblks, info.mxordblk, info.ordblks);
+#ifdef CONFIG_MM_FASTBINS
+	printf("fast bins: %d chunks, %d bytes, %d hits, %d misses\n", info.smblks, info.fsmblks, info.fbhits, info.fbmisses);
+#endif
+
+	if (g_timed) {
+		trace_report();
+	}
+
+	/* Release everything; the heap must coalesce back into a single chunk */
+
+	for (i = 0; i < g_nblocks; i++) {
+		if (blocks[i].mem) {
+			block_verify(&blocks[i], blocks[i].size);
+			mm_free(&g_heap, blocks[i].mem);
+		}
+	}
+
+#ifdef CONFIG_MM_FASTBINS
+	mm_fastbin_flush(&g_heap);
+#endif
+	mm_mallinfo(&g_heap, &info);
+	if (info.ordblks != 1 || info.uordblks != 2 * SIZEOF_MM_ALLOCNODE) {
+		fprintf(stderr, "mmbench: heap did not coalesce: %d free chunks, %d bytes in use\n", info.ordblks, info.uordblks);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}